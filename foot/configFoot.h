@@ -50,8 +50,12 @@
 #define OUTPUT_MODE OUTPUT_BASIC // output verbosity level
 #endif
 #ifndef RESULT_CSV_PATH
+#if HDC_PROFILE
+#define RESULT_CSV_PATH "analysis/results_profile.csv" // profile builds add per-stage columns, so they get their own CSV
+#else
 #define RESULT_CSV_PATH "analysis/results.csv" // results CSV output path
 #endif
+#endif
 #ifndef ITEM_MEM_SEED
 #define ITEM_MEM_SEED 1 // seed for deterministic item-memory initialization
 #endif
@@ -84,6 +88,45 @@
 #ifndef GA_DEFAULT_SEED
 #define GA_DEFAULT_SEED 45 // GA RNG seed
 #endif
+#ifndef GA_DEFAULT_RACING_RUNGS
+#define GA_DEFAULT_RACING_RUNGS 0 // GA racing: subset rungs before full evaluation (0 = off)
+#endif
+#ifndef GA_DEFAULT_RACING_MIN_FRACTION
+#define GA_DEFAULT_RACING_MIN_FRACTION 0.11 // GA racing: data fraction of the first rung
+#endif
+#ifndef GA_DEFAULT_RACING_KEEP_FRACTION
+#define GA_DEFAULT_RACING_KEEP_FRACTION 0.34 // GA racing: share of candidates promoted per rung
+#endif
+#ifndef GA_DEFAULT_SURROGATE_KEEP_FRACTION
+#define GA_DEFAULT_SURROGATE_KEEP_FRACTION 0.0 // GA surrogate: share of offspring fully scored after proxy screening (0 = off)
+#endif
+#ifndef GA_DEFAULT_SURROGATE_REFIT_EVERY
+#define GA_DEFAULT_SURROGATE_REFIT_EVERY 4 // GA surrogate: generations between proxy refits on real fitnesses
+#endif
+#ifndef GA_DEFAULT_WARM_START_GENERATIONS
+#define GA_DEFAULT_WARM_START_GENERATIONS 0 // GA warm start: generations of a run seeded from the GA_REFINED_BINNING preprocessing run (0 = GA_DEFAULT_GENERATIONS)
+#endif
+#ifndef GA_DEFAULT_ISLANDS
+#define GA_DEFAULT_ISLANDS 1 // GA island model: independent populations in the ring (1 = off)
+#endif
+#ifndef GA_DEFAULT_MIGRATION_INTERVAL
+#define GA_DEFAULT_MIGRATION_INTERVAL 8 // GA island model: generations between migrations
+#endif
+#ifndef GA_DEFAULT_MIGRANTS
+#define GA_DEFAULT_MIGRANTS 2 // GA island model: best genomes sent to the next island
+#endif
+#ifndef GA_ISLAND_DIR
+#define GA_ISLAND_DIR "ga_islands" // GA island model: shared directory for file-based migration
+#endif
+#ifndef GA_DEFAULT_CHECKPOINT_EVERY
+#define GA_DEFAULT_CHECKPOINT_EVERY 0 // GA checkpoint: generations between state snapshots (0 = off)
+#endif
+#ifndef GA_DEFAULT_RESUME
+#define GA_DEFAULT_RESUME 1 // GA checkpoint: continue from a matching snapshot when one exists
+#endif
+#ifndef GA_CHECKPOINT_DIR
+#define GA_CHECKPOINT_DIR "ga_checkpoints" // GA checkpoint: directory of the snapshots
+#endif
 #ifndef GA_MAX_FLIPS_CIM
 #define GA_MAX_FLIPS_CIM VECTOR_DIMENSION // CiM max flips budget
 #endif
@@ -115,6 +158,12 @@
 #ifndef GA_MUTATION_BETA
 #define GA_MUTATION_BETA 0 // schedule curvature for custom mutation step size
 #endif
+#ifndef FOOT_CSV_CACHE
+#define FOOT_CSV_CACHE 1 // cache parsed dataset CSVs as .hdcbin files next to them
+#endif
+#ifndef PARALLEL_DATASETS
+#define PARALLEL_DATASETS 0 // run the four datasets concurrently (ignored with USE_GENETIC_ITEM_MEMORY or PRECOMPUTED_ITEM_MEMORY=0)
+#endif
 
 extern int output_mode;
 
@@ -130,6 +179,7 @@ extern int output_mode;
 #define DECISION_TREE_1D_BINNING 3  // use per-feature supervised 1D decision-tree value-to-level mapping
 #define CHIMERGE_BINNING 4  // use per-feature supervised ChiMerge value-to-level mapping
 #define GA_REFINED_BINNING 5  // use one preprocessing GA run to refine per-feature thresholds
+#define KMEANS_1D_OPTIMAL_BINNING 6  // use per-feature globally optimal (dynamic-programming) 1D k-means mapping
 
 
 #define GA_SELECTION_PARETO 0   // GA selection: NSGA-II Pareto
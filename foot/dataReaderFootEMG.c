@@ -1,14 +1,385 @@
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
 #include "dataReaderFootEMG.h"
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 #include "../hdc_infrastructure/preprocessor.h"
 
-#define INITIAL_CAPACITY 1024
+/**
+ * @brief One parsed CSV file: EMG rows (`cols` floats each) or labels (one int per row).
+ *
+ * The values live in one block, which becomes the storage of the EMG sample matrix.
+ */
+struct csv_table {
+    size_t rows;
+    size_t cols;
+    void *values;      /**< rows * cols floats, or rows ints for labels. */
+    void *block;       /**< Allocation backing `values`. */
+};
 
-size_t countCSVRows(const char* filename);
-double** loadEMGData(char* filename, size_t rows, size_t cols);
-int* loadLabels(char* filename, size_t rows);
+enum foot_file {
+    TRAINING_EMG,
+    TRAINING_LABELS,
+    TESTING_EMG,
+    TESTING_LABELS,
+    FOOT_FILE_COUNT
+};
+
+/**
+ * @brief Binary cache of a parsed CSV ("<name>.hdcbin" next to "<name>.csv").
+ *
+ * The header records the size and modification time of the CSV it was built
+ * from; a cache that no longer matches its CSV is rebuilt. The values follow
+ * the header in host byte order.
+ */
+#define CSV_CACHE_MAGIC "HDCC"
+#define CSV_CACHE_VERSION 2
+
+struct csv_cache_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t element_bytes;
+    uint32_t cols;
+    uint64_t rows;
+    int64_t source_bytes;
+    int64_t source_mtime;
+};
+
+_Static_assert(sizeof(struct csv_cache_header) % sizeof(float) == 0, "cache values must stay aligned");
+
+static void get_file_paths(int dataset_id, char *training_emg_file, char *training_labels_file, char *testing_emg_file, char *testing_labels_file);
+
+static const double exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static int is_field_end(char c) {
+    return c == ',' || c == '\n' || c == '\r';
+}
+
+/**
+ * @brief Parses one decimal field, bit-identical to `atof`.
+ *
+ * Plain decimals with at most 19 significant digits and 22 fraction digits
+ * take the exact fast path: the digits form an integer below 2^53 and one
+ * division by an exactly representable power of ten rounds correctly.
+ * Anything else (exponents, long mantissas, inf/nan) falls back to `atof`.
+ */
+static double parse_double_field(const char *p, const char *end) {
+    const char *field = p;
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    int negative = 0;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int fraction_digits = 0;
+    int overflow = 0;
+    while (p < end && (unsigned)(*p - '0') < 10u) {
+        overflow |= mantissa > (UINT64_MAX - 9u) / 10u;
+        mantissa = mantissa * 10u + (uint64_t)(*p - '0');
+        digits++;
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && (unsigned)(*p - '0') < 10u) {
+            overflow |= mantissa > (UINT64_MAX - 9u) / 10u;
+            mantissa = mantissa * 10u + (uint64_t)(*p - '0');
+            digits++;
+            fraction_digits++;
+            p++;
+        }
+    }
+    if (digits > 0 && !overflow && mantissa <= (1ull << 53) && fraction_digits <= 22 &&
+        (p == end || is_field_end(*p))) {
+        double value = (double)mantissa / exact_powers_of_ten[fraction_digits];
+        return negative ? -value : value;
+    }
+
+    char buffer[128];
+    size_t length = 0;
+    while (field + length < end && !is_field_end(field[length]) && length + 1 < sizeof(buffer)) {
+        length++;
+    }
+    memcpy(buffer, field, length);
+    buffer[length] = '\0';
+    return atof(buffer);
+}
+
+static int parse_int_field(const char *p, const char *end) {
+    char buffer[32];
+    size_t length = 0;
+    while (p + length < end && !is_field_end(p[length]) && length + 1 < sizeof(buffer)) {
+        length++;
+    }
+    memcpy(buffer, p, length);
+    buffer[length] = '\0';
+    return atoi(buffer);
+}
+
+static const char *next_line(const char *p, const char *end) {
+    const char *newline = memchr(p, '\n', (size_t)(end - p));
+    return newline ? newline + 1 : end;
+}
+
+static void parse_emg_row(const char *p, const char *line_end, size_t cols, float *values) {
+    for (size_t col = 0; col < cols && p < line_end; col++) {
+        values[col] = (float)parse_double_field(p, line_end);
+        while (p < line_end && *p != ',') {
+            p++;
+        }
+        p += p < line_end;
+    }
+}
+
+#ifdef _WIN32
+static char *map_csv_file(const char *path, size_t *bytes) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        perror("Failed to open file");
+        exit(EXIT_FAILURE);
+    }
+    char *data = NULL;
+    *bytes = 0;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+        if (size > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data = (char *)malloc((size_t)size);
+            if (data && fread(data, 1, (size_t)size, file) != (size_t)size) {
+                free(data);
+                data = NULL;
+            }
+            *bytes = data ? (size_t)size : 0;
+        }
+    }
+    fclose(file);
+    return data;
+}
+
+static void unmap_csv_file(char *data, size_t bytes) {
+    (void)bytes;
+    free(data);
+}
+#else
+static char *map_csv_file(const char *path, size_t *bytes) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("Failed to open file");
+        exit(EXIT_FAILURE);
+    }
+    struct stat info;
+    char *data = NULL;
+    *bytes = 0;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void *mapped = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            data = (char *)mapped;
+            *bytes = (size_t)info.st_size;
+            madvise(mapped, *bytes, MADV_SEQUENTIAL);
+        }
+    }
+    close(fd);
+    return data;
+}
+
+static void unmap_csv_file(char *data, size_t bytes) {
+    if (data) {
+        munmap(data, bytes);
+    }
+}
+#endif
+
+/**
+ * @brief Parses a CSV (header row skipped) in a single pass over the mapped file.
+ *
+ * @param cols Values per row for EMG files, 0 for label files.
+ */
+static void parse_csv_table(const char *path, size_t cols, struct csv_table *table) {
+    size_t bytes = 0;
+    char *data = map_csv_file(path, &bytes);
+    const char *end = data + bytes;
+    const char *p = data ? next_line(data, end) : end;
+
+    size_t rows = 0;
+    for (const char *q = p; q < end; q = next_line(q, end)) {
+        rows++;
+    }
+    size_t element_bytes = cols > 0 ? sizeof(float) : sizeof(int);
+    size_t row_values = cols > 0 ? cols : 1;
+    table->rows = rows;
+    table->cols = cols;
+    table->block = calloc(rows > 0 ? rows * row_values : 1, element_bytes);
+    if (table->block == NULL) {
+        perror("Malloc failed for data");
+        exit(EXIT_FAILURE);
+    }
+    table->values = table->block;
+
+    for (size_t row = 0; row < rows; row++) {
+        const char *line_end = next_line(p, end);
+        if (cols == 0) {
+            ((int *)table->values)[row] = parse_int_field(p, line_end);
+        } else {
+            parse_emg_row(p, line_end, cols, (float *)table->values + row * cols);
+        }
+        p = line_end;
+    }
+    unmap_csv_file(data, bytes);
+}
+
+#if FOOT_CSV_CACHE
+static void csv_cache_path(const char *path, char *cache_path, size_t size) {
+    size_t length = strlen(path);
+    if (length >= 4 && strcmp(path + length - 4, ".csv") == 0) {
+        length -= 4;
+    }
+    snprintf(cache_path, size, "%.*s.hdcbin", (int)length, path);
+}
+
+/**
+ * @brief Opens a cache and checks it against its CSV.
+ *
+ * @return The file positioned at the first value, or NULL if the cache is missing or stale.
+ */
+static FILE *open_csv_cache(const char *cache_path, const struct stat *source, size_t cols, struct csv_cache_header *header) {
+    FILE *file = fopen(cache_path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    size_t element_bytes = cols > 0 ? sizeof(float) : sizeof(int);
+    if (fread(header, sizeof(*header), 1, file) != 1 ||
+        memcmp(header->magic, CSV_CACHE_MAGIC, 4) != 0 || header->version != CSV_CACHE_VERSION ||
+        header->element_bytes != element_bytes || header->cols != cols ||
+        header->source_bytes != (int64_t)source->st_size || header->source_mtime != (int64_t)source->st_mtime) {
+        fclose(file);
+        return NULL;
+    }
+    return file;
+}
+
+static int load_csv_cache(const char *cache_path, const struct stat *source, size_t cols, struct csv_table *table) {
+    struct csv_cache_header header;
+    FILE *file = open_csv_cache(cache_path, source, cols, &header);
+    if (!file) {
+        return -1;
+    }
+    size_t element_bytes = cols > 0 ? sizeof(float) : sizeof(int);
+    size_t count = (size_t)header.rows * (cols > 0 ? cols : 1);
+    void *block = malloc(count > 0 ? count * element_bytes : 1);
+    if (!block || fread(block, element_bytes, count, file) != count) {
+        free(block);
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+    table->rows = (size_t)header.rows;
+    table->cols = cols;
+    table->block = block;
+    table->values = block;
+    return 0;
+}
+
+static void store_csv_cache(const char *cache_path, const struct stat *source, const struct csv_table *table) {
+    struct csv_cache_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CSV_CACHE_MAGIC, 4);
+    header.version = CSV_CACHE_VERSION;
+    header.element_bytes = table->cols > 0 ? sizeof(float) : sizeof(int);
+    header.cols = (uint32_t)table->cols;
+    header.rows = table->rows;
+    header.source_bytes = (int64_t)source->st_size;
+    header.source_mtime = (int64_t)source->st_mtime;
+    size_t count = table->rows * (table->cols > 0 ? table->cols : 1);
+
+    // Write next to the final name and rename, so a concurrent run never reads a partial cache.
+    char temp_path[300];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", cache_path);
+    FILE *file = fopen(temp_path, "wb");
+    if (!file) {
+        return;
+    }
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(table->values, header.element_bytes, count, file) == count;
+    ok &= fclose(file) == 0;
+    if (!ok || rename(temp_path, cache_path) != 0) {
+        remove(temp_path);
+        if (output_mode >= OUTPUT_DEBUG) {
+            fprintf(stderr, "Could not write CSV cache %s.\n", cache_path);
+        }
+    }
+}
+
+#endif
+
+/**
+ * @brief Loads one CSV, from its binary cache when FOOT_CSV_CACHE is set and the cache is current.
+ */
+static void load_csv_table(const char *path, size_t cols, struct csv_table *table) {
+    memset(table, 0, sizeof(*table));
+#if FOOT_CSV_CACHE
+    struct stat source;
+    char cache_path[256];
+    int cacheable = stat(path, &source) == 0;
+    if (cacheable) {
+        csv_cache_path(path, cache_path, sizeof(cache_path));
+        cacheable = load_csv_cache(cache_path, &source, cols, table) != 0;
+    }
+    if (table->block == NULL) {
+        parse_csv_table(path, cols, table);
+        if (cacheable) {
+            store_csv_cache(cache_path, &source, table);
+        }
+    }
+#else
+    parse_csv_table(path, cols, table);
+#endif
+}
+
+static void free_csv_table(struct csv_table *table) {
+    free(table->block);
+    memset(table, 0, sizeof(*table));
+}
+
+/**
+ * @brief Loads the raw EMG and label files of a dataset, the files in parallel.
+ *
+ * @param with_training 0 loads only the testing files.
+ */
+static void load_dataset_tables(int dataset, int with_training, struct csv_table tables[FOOT_FILE_COUNT]) {
+    char paths[FOOT_FILE_COUNT][128];
+    get_file_paths(dataset, paths[TRAINING_EMG], paths[TRAINING_LABELS], paths[TESTING_EMG], paths[TESTING_LABELS]);
+    memset(tables, 0, FOOT_FILE_COUNT * sizeof(struct csv_table));
+    int first = with_training ? TRAINING_EMG : TESTING_EMG;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (int file = first; file < FOOT_FILE_COUNT; file++) {
+        int is_emg = file == TRAINING_EMG || file == TESTING_EMG;
+        load_csv_table(paths[file], is_emg ? NUM_FEATURES : 0, &tables[file]);
+    }
+    for (int file = first; file < FOOT_FILE_COUNT; file += 2) {
+        if (tables[file].rows != tables[file + 1].rows) {
+            fprintf(stderr, "Data and labels differ in length: %s has %zu rows, %s has %zu.\n",
+                    paths[file], tables[file].rows, paths[file + 1], tables[file + 1].rows);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
 
 static void get_file_paths(int dataset_id, char *training_emg_file, char *training_labels_file, char *testing_emg_file, char *testing_labels_file) {
     sprintf(training_emg_file, "foot/data/dataset%02d/training_emg.csv", dataset_id);
@@ -17,17 +388,57 @@ static void get_file_paths(int dataset_id, char *training_emg_file, char *traini
     sprintf(testing_labels_file, "foot/data/dataset%02d/testing_labels.csv", dataset_id);
 }
 
-void getDataWithValSet(int dataset,
-                       double*** trainingData,
-                       double*** validationData,
-                       double*** testingData,
-                       int** trainingLabels,
-                       int** validationLabels,
-                       int** testingLabels,
-                       int* trainingSamples,
-                       int* validationSamples,
-                       int* testingSamples,
-                       double validationRatio) {
+/**
+ * @brief Turns a raw EMG table into a downsampled matrix with its labels.
+ *
+ * With DOWNSAMPLE 1 the table's storage is handed over as is; otherwise the
+ * kept rows are compacted into a new matrix. The table gives up its block.
+ */
+static void take_downsampled_matrix(struct csv_table *emg, const struct csv_table *labels,
+                                    struct sample_matrix *out, int **out_labels) {
+    struct sample_matrix raw = {
+        (float *)emg->values, emg->rows, emg->cols, emg->cols, (float *)emg->block
+    };
+    emg->block = NULL;
+    emg->values = NULL;
+
+    struct sample_matrix view;
+    down_sample_matrix(&raw, (const int *)labels->values, &view, out_labels);
+    if (view.stride == view.cols) {
+        *out = raw;
+        out->rows = view.rows;
+        return;
+    }
+    if (init_sample_matrix(out, view.rows, view.cols) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    for (size_t row = 0; row < view.rows; row++) {
+        memcpy(sample_matrix_row(out, row), sample_matrix_row(&view, row), view.cols * sizeof(float));
+    }
+    free_sample_matrix(&raw);
+}
+
+static void free_dataset_tables(struct csv_table tables[FOOT_FILE_COUNT]) {
+    for (int file = 0; file < FOOT_FILE_COUNT; file++) {
+        free_csv_table(&tables[file]);
+    }
+}
+
+/**
+ * @brief Loads a dataset as float32 sample matrices with a class-stratified validation split.
+ *
+ * The first `validationRatio` share of every class (in time order) of the
+ * downsampled training recording becomes the validation set. Matrices are
+ * released with `free_sample_matrix`, labels with `freeCSVLabels`.
+ */
+void getDataMatricesWithValSet(int dataset,
+                               struct sample_matrix *trainingData,
+                               struct sample_matrix *validationData,
+                               struct sample_matrix *testingData,
+                               int** trainingLabels,
+                               int** validationLabels,
+                               int** testingLabels,
+                               double validationRatio) {
     if (output_mode >= OUTPUT_DETAILED) {
         printf("Reading data.\n");
     }
@@ -38,39 +449,15 @@ void getDataWithValSet(int dataset,
         validationRatio = 1.0;
     }
 
-    char training_emg_file_name[128], training_labels_file_name[128], testing_emg_file_name[128], testing_labels_file_name[128];
-    get_file_paths(dataset, training_emg_file_name, training_labels_file_name, testing_emg_file_name, testing_labels_file_name);
-    size_t trainingRows = countCSVRows(training_emg_file_name);
-    size_t testingRows = countCSVRows(testing_emg_file_name);
+    struct csv_table tables[FOOT_FILE_COUNT];
+    load_dataset_tables(dataset, 1, tables);
 
-    double** rawTrainingData = loadEMGData(training_emg_file_name, trainingRows, NUM_FEATURES);
-    int* rawTrainingLabels = loadLabels(training_labels_file_name, trainingRows);
-
-    double** rawTestingData = loadEMGData(testing_emg_file_name, testingRows, NUM_FEATURES);
-    int* rawTestingLabels = loadLabels(testing_labels_file_name, testingRows);
-
-    if (rawTestingData == NULL || rawTrainingLabels == NULL) {
-        fprintf(stderr, "Data or Labels loading failed\n");
-        exit(EXIT_FAILURE);
-    }
-
-    double** downSampledDataTrain = NULL;
+    struct sample_matrix downSampledDataTrain;
     int* downSampledLabelsTrain = NULL;
-    size_t downSampledSizeTrain = 0;
-    double** downSampledDataTest = NULL;
-    int* downSampledLabelsTest = NULL;
-    size_t downSampledSizeTest = 0;
-    down_sample(rawTrainingData, rawTrainingLabels, trainingRows, &downSampledDataTrain, &downSampledLabelsTrain, &downSampledSizeTrain);
-    down_sample(rawTestingData, rawTestingLabels, testingRows, &downSampledDataTest, &downSampledLabelsTest, &downSampledSizeTest);
-
-    if (downSampledDataTrain == NULL || downSampledLabelsTrain == NULL) {
-        fprintf(stderr, "Error: downSampleDataTrain.\n");
-        exit(EXIT_FAILURE);
-    }
-    if (downSampledDataTest == NULL || downSampledLabelsTest == NULL) {
-        fprintf(stderr, "Error: downSampleDataTest.\n");
-        exit(EXIT_FAILURE);
-    }
+    take_downsampled_matrix(&tables[TRAINING_EMG], &tables[TRAINING_LABELS], &downSampledDataTrain, &downSampledLabelsTrain);
+    take_downsampled_matrix(&tables[TESTING_EMG], &tables[TESTING_LABELS], testingData, testingLabels);
+    free_dataset_tables(tables);
+    size_t downSampledSizeTrain = downSampledDataTrain.rows;
 
     int class_counts[NUM_CLASSES];
     int class_targets[NUM_CLASSES];
@@ -99,32 +486,13 @@ void getDataWithValSet(int dataset,
     }
 
     size_t training_total = downSampledSizeTrain - validation_total;
-    *trainingSamples = (int)training_total;
-    *validationSamples = (int)validation_total;
-    *testingSamples = (int)downSampledSizeTest;
-
-    if (training_total > 0) {
-        *trainingData = (double**)malloc(training_total * sizeof(double*));
-        *trainingLabels = (int*)malloc(training_total * sizeof(int));
-        if (*trainingData == NULL || *trainingLabels == NULL) {
-            fprintf(stderr, "Malloc failed for training data.\n");
-            exit(EXIT_FAILURE);
-        }
-    } else {
-        *trainingData = NULL;
-        *trainingLabels = NULL;
-    }
-
-    if (validation_total > 0) {
-        *validationData = (double**)malloc(validation_total * sizeof(double*));
-        *validationLabels = (int*)malloc(validation_total * sizeof(int));
-        if (*validationData == NULL || *validationLabels == NULL) {
-            fprintf(stderr, "Malloc failed for validation data.\n");
-            exit(EXIT_FAILURE);
-        }
-    } else {
-        *validationData = NULL;
-        *validationLabels = NULL;
+    *trainingLabels = (int*)malloc((training_total > 0 ? training_total : 1) * sizeof(int));
+    *validationLabels = (int*)malloc((validation_total > 0 ? validation_total : 1) * sizeof(int));
+    if (*trainingLabels == NULL || *validationLabels == NULL ||
+        init_sample_matrix(trainingData, training_total, NUM_FEATURES) != 0 ||
+        init_sample_matrix(validationData, validation_total, NUM_FEATURES) != 0) {
+        fprintf(stderr, "Malloc failed for training/validation data.\n");
+        exit(EXIT_FAILURE);
     }
 
     size_t train_idx = 0;
@@ -136,242 +504,276 @@ void getDataWithValSet(int dataset,
             to_validation = 1;
         }
 
+        const float *row = sample_matrix_row(&downSampledDataTrain, i);
         if (to_validation) {
-            if (val_idx < validation_total) {
-                (*validationData)[val_idx] = (double*)malloc(NUM_FEATURES * sizeof(double));
-                if ((*validationData)[val_idx] == NULL) {
-                    fprintf(stderr, "Malloc failed for validation data row.\n");
-                    exit(EXIT_FAILURE);
-                }
-                memcpy((*validationData)[val_idx], downSampledDataTrain[i], NUM_FEATURES * sizeof(double));
-                (*validationLabels)[val_idx] = label;
-                class_assigned[label] += 1;
-                val_idx++;
-            }
+            memcpy(sample_matrix_row(validationData, val_idx), row, NUM_FEATURES * sizeof(float));
+            (*validationLabels)[val_idx] = label;
+            class_assigned[label] += 1;
+            val_idx++;
         } else {
-            if (train_idx < training_total) {
-                (*trainingData)[train_idx] = (double*)malloc(NUM_FEATURES * sizeof(double));
-                if ((*trainingData)[train_idx] == NULL) {
-                    fprintf(stderr, "Malloc failed for training data row.\n");
-                    exit(EXIT_FAILURE);
-                }
-                memcpy((*trainingData)[train_idx], downSampledDataTrain[i], NUM_FEATURES * sizeof(double));
-                (*trainingLabels)[train_idx] = label;
-                train_idx++;
-            }
+            memcpy(sample_matrix_row(trainingData, train_idx), row, NUM_FEATURES * sizeof(float));
+            (*trainingLabels)[train_idx] = label;
+            train_idx++;
         }
     }
 
-    *testingData = downSampledDataTest;
-    *testingLabels = downSampledLabelsTest;
-
     if (output_mode >= OUTPUT_DETAILED) {
-        printf("Loaded data: training %d x %d, validation %d x %d, testing %d x %d\n",
-               *trainingSamples,
+        printf("Loaded data: training %zu x %d, validation %zu x %d, testing %zu x %d\n",
+               trainingData->rows,
                NUM_FEATURES,
-               *validationSamples,
+               validationData->rows,
                NUM_FEATURES,
-               *testingSamples,
+               testingData->rows,
                NUM_FEATURES);
     }
 
-    freeData(downSampledDataTrain, downSampledSizeTrain);
+    free_sample_matrix(&downSampledDataTrain);
     freeCSVLabels(downSampledLabelsTrain);
-    freeData(rawTrainingData, trainingRows);
-    freeCSVLabels(rawTrainingLabels);
-    freeData(rawTestingData, testingRows);
-    freeCSVLabels(rawTestingLabels);
 }
-// Function to count rows in a CSV file
-size_t countCSVRows(const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        perror("Failed to open file");
-        exit(EXIT_FAILURE);
-    }
-
-    char line[1024];
-    size_t rows = 0;
-
-    // Skip the header row
-    if (!fgets(line, sizeof(line), file)) {
-        fclose(file);
+
+// Function to load ONLY the testing data as a sample matrix
+void getTestingDataMatrix(int dataset, struct sample_matrix *testingData, int** testingLabels) {
+    struct csv_table tables[FOOT_FILE_COUNT];
+    load_dataset_tables(dataset, 0, tables);
+    take_downsampled_matrix(&tables[TESTING_EMG], &tables[TESTING_LABELS], testingData, testingLabels);
+    free_dataset_tables(tables);
+}
+
+// Function to load training and testing data as sample matrices
+void getDataMatrices(int dataset, struct sample_matrix *trainingData, struct sample_matrix *testingData, int** trainingLabels, int** testingLabels) {
+    if (output_mode >= OUTPUT_DETAILED) {
+        printf("Reading data.\n");
+    }
+    struct csv_table tables[FOOT_FILE_COUNT];
+    load_dataset_tables(dataset, 1, tables);
+    take_downsampled_matrix(&tables[TRAINING_EMG], &tables[TRAINING_LABELS], trainingData, trainingLabels);
+    take_downsampled_matrix(&tables[TESTING_EMG], &tables[TESTING_LABELS], testingData, testingLabels);
+    free_dataset_tables(tables);
+    if (output_mode >= OUTPUT_DETAILED) {
+        printf("Loaded data: training %zu x %d, testing %zu x %d\n",
+               trainingData->rows,
+               NUM_FEATURES,
+               testingData->rows,
+               NUM_FEATURES);
+    }
+}
+
+/**
+ * @brief One file of a streamed dataset, read row by row from its cache or its CSV.
+ */
+struct foot_stream_file {
+    FILE *file;
+    size_t cols;          /**< NUM_FEATURES for EMG, 0 for labels. */
+    int cached;           /**< Reading binary values after a cache header. */
+    long data_offset;     /**< Offset of the first row, for rewinding. */
+};
+
+/**
+ * @brief Context of a foot dataset `sample_source`: EMG and labels in lockstep.
+ *
+ * DOWNSAMPLE is applied on the fly: the first row of every complete block is
+ * emitted once the block's last row has been read, matching `down_sample`.
+ */
+struct foot_stream {
+    struct foot_stream_file emg;
+    struct foot_stream_file labels;
+    size_t raw_row;
+    float pending[NUM_FEATURES];
+    int pending_label;
+};
+
+static int open_foot_stream_file(const char *path, size_t cols, struct foot_stream_file *stream_file) {
+    memset(stream_file, 0, sizeof(*stream_file));
+    stream_file->cols = cols;
+#if FOOT_CSV_CACHE
+    struct stat source;
+    if (stat(path, &source) == 0) {
+        char cache_path[256];
+        struct csv_cache_header header;
+        csv_cache_path(path, cache_path, sizeof(cache_path));
+        stream_file->file = open_csv_cache(cache_path, &source, cols, &header);
+        if (stream_file->file) {
+            stream_file->cached = 1;
+            stream_file->data_offset = (long)sizeof(header);
+            return 0;
+        }
+    }
+#endif
+    stream_file->file = fopen(path, "rb");
+    if (!stream_file->file) {
+        fprintf(stderr, "Error opening file %s\n", path);
+        return -1;
+    }
+    int c;
+    while ((c = fgetc(stream_file->file)) != EOF && c != '\n') {
+    }
+    stream_file->data_offset = ftell(stream_file->file);
+    return 0;
+}
+
+/**
+ * @brief Reads one row; returns 1 on success, 0 at the end of the file.
+ */
+static int read_foot_stream_row(struct foot_stream_file *stream_file, float *values, int *label) {
+    if (stream_file->cached) {
+        return stream_file->cols > 0 ? fread(values, sizeof(float), stream_file->cols, stream_file->file) == stream_file->cols
+                                     : fread(label, sizeof(int), 1, stream_file->file) == 1;
+    }
+    char line[1024];
+    if (!fgets(line, sizeof(line), stream_file->file)) {
         return 0;
     }
-
-    while (fgets(line, sizeof(line), file)) {
-        rows++;
-    }
-
-    fclose(file);
+    size_t length = strlen(line);
+    if (length > 0 && line[length - 1] != '\n') {
+        int c;
+        while ((c = fgetc(stream_file->file)) != EOF && c != '\n') {
+        }
+    }
+    if (stream_file->cols > 0) {
+        memset(values, 0, stream_file->cols * sizeof(float));
+        parse_emg_row(line, line + length, stream_file->cols, values);
+    } else {
+        *label = parse_int_field(line, line + length);
+    }
+    return 1;
+}
+
+static long read_foot_stream(void *context, float *samples, int *labels, size_t max_rows) {
+    struct foot_stream *stream = (struct foot_stream *)context;
+    size_t rows = 0;
+    float values[NUM_FEATURES];
+    while (rows < max_rows) {
+        int label = 0;
+        int has_values = read_foot_stream_row(&stream->emg, values, NULL);
+        int has_label = read_foot_stream_row(&stream->labels, NULL, &label);
+        if (has_values != has_label) {
+            fprintf(stderr, "Data and labels differ in length after %zu rows.\n", stream->raw_row);
+            return -1;
+        }
+        if (!has_values) {
+            break;
+        }
+        size_t phase = stream->raw_row++ % DOWNSAMPLE;
+        if (phase == 0) {
+            memcpy(stream->pending, values, sizeof(values));
+            stream->pending_label = label;
+        }
+        if (phase == DOWNSAMPLE - 1) {
+            memcpy(samples + rows * NUM_FEATURES, stream->pending, sizeof(values));
+            labels[rows] = stream->pending_label;
+            rows++;
+        }
+    }
+    return (long)rows;
+}
+
+static int rewind_foot_stream(void *context) {
+    struct foot_stream *stream = (struct foot_stream *)context;
+    stream->raw_row = 0;
+    return fseek(stream->emg.file, stream->emg.data_offset, SEEK_SET) == 0 &&
+           fseek(stream->labels.file, stream->labels.data_offset, SEEK_SET) == 0 ? 0 : -1;
+}
+
+static void close_foot_stream(void *context) {
+    struct foot_stream *stream = (struct foot_stream *)context;
+    if (stream->emg.file) {
+        fclose(stream->emg.file);
+    }
+    if (stream->labels.file) {
+        fclose(stream->labels.file);
+    }
+    free(stream);
+}
+
+/**
+ * @brief Opens the training or testing recording of a dataset as a `sample_source`.
+ *
+ * Rows are read incrementally (from the .hdcbin caches when they are current,
+ * otherwise from the CSVs) and downsampled as in `getDataMatrices`, so a
+ * `dataset_stream` over the source never holds the whole recording. There is
+ * no validation split.
+ *
+ * @param testing 0 for the training recording, 1 for the testing recording.
+ * @return 0 on success, -1 if a file cannot be opened.
+ */
+int openFootSampleSource(int dataset, int testing, struct sample_source *source) {
+    char paths[FOOT_FILE_COUNT][128];
+    get_file_paths(dataset, paths[TRAINING_EMG], paths[TRAINING_LABELS], paths[TESTING_EMG], paths[TESTING_LABELS]);
+    int emg_file = testing ? TESTING_EMG : TRAINING_EMG;
+
+    struct foot_stream *stream = (struct foot_stream *)calloc(1, sizeof(*stream));
+    if (!stream) {
+        perror("Malloc failed for sample source");
+        return -1;
+    }
+    if (open_foot_stream_file(paths[emg_file], NUM_FEATURES, &stream->emg) != 0 ||
+        open_foot_stream_file(paths[emg_file + 1], 0, &stream->labels) != 0) {
+        close_foot_stream(stream);
+        return -1;
+    }
+    source->context = stream;
+    source->cols = NUM_FEATURES;
+    source->read = read_foot_stream;
+    source->rewind = rewind_foot_stream;
+    source->close = close_foot_stream;
+    return 0;
+}
+
+/**
+ * @brief `double **` adapter: converts a matrix to separately allocated rows and frees it.
+ */
+static double **matrix_to_rows(struct sample_matrix *matrix, int *samples) {
+    *samples = (int)matrix->rows;
+    double **rows = NULL;
+    if (matrix->rows > 0) {
+        rows = sample_matrix_to_rows(matrix);
+        if (rows == NULL) {
+            exit(EXIT_FAILURE);
+        }
+    }
+    free_sample_matrix(matrix);
     return rows;
 }
 
-// Function to load EMG data from a CSV file
-double** loadEMGData(char* filename, size_t rows, size_t cols) {
-    double** data = (double**)malloc(rows * sizeof(double*));
-    if (data == NULL) {
-        perror("Malloc failed for data");
-        exit(EXIT_FAILURE);
-    }
-
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        perror("Failed to open file");
-        exit(EXIT_FAILURE);
-    }
-
-    char line[1024];
-
-    // Skip the header row
-    if (!fgets(line, sizeof(line), file)) {
-        fclose(file);
-        return data;
+void getDataWithValSet(int dataset,
+                       double*** trainingData,
+                       double*** validationData,
+                       double*** testingData,
+                       int** trainingLabels,
+                       int** validationLabels,
+                       int** testingLabels,
+                       int* trainingSamples,
+                       int* validationSamples,
+                       int* testingSamples,
+                       double validationRatio) {
+    struct sample_matrix training, validation, testing;
+    getDataMatricesWithValSet(dataset, &training, &validation, &testing,
+                              trainingLabels, validationLabels, testingLabels, validationRatio);
+    *trainingData = matrix_to_rows(&training, trainingSamples);
+    *validationData = matrix_to_rows(&validation, validationSamples);
+    *testingData = matrix_to_rows(&testing, testingSamples);
+    if (*trainingData == NULL) {
+        freeCSVLabels(*trainingLabels);
+        *trainingLabels = NULL;
     }
-
-    size_t row = 0;
-    while (fgets(line, sizeof(line), file)) {
-        data[row] = (double*)malloc(cols * sizeof(double));
-        if (data[row] == NULL) {
-            perror("Malloc failed for data[row]");
-            exit(EXIT_FAILURE);
-        }
-
-        char* token = strtok(line, ",");
-        size_t col = 0;
-        while (token != NULL && col < cols) {
-            data[row][col] = atof(token);
-            token = strtok(NULL, ",");
-            col++;
-        }
-        row++;
-    }
-
-    fclose(file);
-    return data;
-}
-
-// Function to load labels from a CSV file
-int* loadLabels(char* filename, size_t rows) {
-    int* labels = (int*)malloc(rows * sizeof(int));
-    if (labels == NULL) {
-        perror("Malloc failed for labels");
-        exit(EXIT_FAILURE);
-    }
-
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        perror("Failed to open file");
-        exit(EXIT_FAILURE);
-    }
-
-    char line[1024];
-
-    // Skip the header row
-    if (!fgets(line, sizeof(line), file)) {
-        fclose(file);
-        return labels;
+    if (*validationData == NULL) {
+        freeCSVLabels(*validationLabels);
+        *validationLabels = NULL;
     }
-
-    size_t row = 0;
-    while (fgets(line, sizeof(line), file)) {
-        labels[row] = atoi(line);
-        row++;
-    }
-
-    fclose(file);
-    return labels;
-}
-
+}
 
 // Function to ONLY testing data
 void getTestingData(int dataset, double*** testingData, int** testingLabels, int* testingSamples) {
-    char training_emg_file_name[128], training_labels_file_name[128], testing_emg_file_name[128], testing_labels_file_name[128];
-    get_file_paths(dataset,training_emg_file_name,training_labels_file_name,testing_emg_file_name,testing_labels_file_name);
-    size_t testingRows = countCSVRows(testing_emg_file_name);
-
-    double** rawTestingData = loadEMGData(testing_emg_file_name, testingRows, NUM_FEATURES);
-    int* rawTestingLabels = loadLabels(testing_labels_file_name, testingRows);
-
-    if (rawTestingData == NULL) {
-        fprintf(stderr, "Data or Labels loading failed\n");
-        exit(EXIT_FAILURE);
-    }
-    
-    // Downsample training and testing data
-    double** downSampledDataTest = NULL;
-    int* downSampledLabelsTest = NULL;
-    size_t downSampledSizeTest = 0;
-    down_sample(rawTestingData, rawTestingLabels, testingRows, &downSampledDataTest, &downSampledLabelsTest, &downSampledSizeTest);
-    *testingData = downSampledDataTest;
-    *testingLabels = downSampledLabelsTest;
-    *testingSamples = (int)downSampledSizeTest;
-    if (downSampledDataTest == NULL) {
-        fprintf(stderr, "Error: downSampleDataTest.\n");
-        exit(EXIT_FAILURE);
-    }
-    freeData(rawTestingData, testingRows);
-    freeCSVLabels(rawTestingLabels);
+    struct sample_matrix testing;
+    getTestingDataMatrix(dataset, &testing, testingLabels);
+    *testingData = matrix_to_rows(&testing, testingSamples);
 }
 // Function to get training and testing data
 void getData(int dataset,double*** trainingData, double*** testingData, int** trainingLabels, int** testingLabels, int* trainingSamples, int* testingSamples) {
-    if (output_mode >= OUTPUT_DETAILED) {
-        printf("Reading data.\n");
-    }
-    // Load raw training data
-    char training_emg_file_name[128], training_labels_file_name[128], testing_emg_file_name[128], testing_labels_file_name[128];
-    get_file_paths(dataset,training_emg_file_name,training_labels_file_name,testing_emg_file_name,testing_labels_file_name);
-    size_t trainingRows = countCSVRows(training_emg_file_name);
-    size_t testingRows = countCSVRows(testing_emg_file_name);
-
-    double** rawTrainingData = loadEMGData(training_emg_file_name, trainingRows, NUM_FEATURES);
-    int* rawTrainingLabels = loadLabels(training_labels_file_name, trainingRows);
-
-    double** rawTestingData = loadEMGData(testing_emg_file_name, testingRows, NUM_FEATURES);
-    int* rawTestingLabels = loadLabels(testing_labels_file_name, testingRows);
-
-    if (rawTestingData == NULL || rawTrainingLabels == NULL) {
-        fprintf(stderr, "Data or Labels loading failed\n");
-        exit(EXIT_FAILURE);
-    }
-    
-    // Downsample training and testing data
-    double** downSampledDataTrain = NULL;
-    int* downSampledLabelsTrain = NULL;
-    size_t downSampledSizeTrain = 0;
-    double** downSampledDataTest = NULL;
-    int* downSampledLabelsTest = NULL;
-    size_t downSampledSizeTest = 0;
-    down_sample(rawTrainingData, rawTrainingLabels, trainingRows, &downSampledDataTrain, &downSampledLabelsTrain, &downSampledSizeTrain);
-    down_sample(rawTestingData, rawTestingLabels, testingRows, &downSampledDataTest, &downSampledLabelsTest, &downSampledSizeTest);
-    *trainingData = downSampledDataTrain;
-    *trainingLabels = downSampledLabelsTrain;
-    *trainingSamples = (int)downSampledSizeTrain;
-
-    *testingData = downSampledDataTest;
-    *testingLabels = downSampledLabelsTest;
-    *testingSamples = (int)downSampledSizeTest;
-    if (downSampledDataTest == NULL) {
-        fprintf(stderr, "Error: downSampleDataTest.\n");
-        exit(EXIT_FAILURE);
-    }
-    if (*trainingData == NULL) {
-        fprintf(stderr, "Error: Downsampling training data failed. Data is NULL.\n");
-        exit(EXIT_FAILURE);
-    }
-    if (output_mode >= OUTPUT_DETAILED) {
-        printf("Loaded data: training %d x %d, testing %d x %d\n",
-               *trainingSamples,
-               NUM_FEATURES,
-               *testingSamples,
-               NUM_FEATURES);
-    }
-
-    // Free raw data
-    freeData(rawTrainingData, trainingRows);
-    freeCSVLabels(rawTrainingLabels);
-    freeData(rawTestingData, testingRows);
-    freeCSVLabels(rawTestingLabels);
+    struct sample_matrix training, testing;
+    getDataMatrices(dataset, &training, &testing, trainingLabels, testingLabels);
+    *trainingData = matrix_to_rows(&training, trainingSamples);
+    *testingData = matrix_to_rows(&testing, testingSamples);
 }
 
 // Function to free CSV data
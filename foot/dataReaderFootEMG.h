@@ -2,6 +2,8 @@
 #define DATAREADERFOOTEMG_H
 
 #include <stdlib.h>
+#include "../hdc_infrastructure/sample_matrix.h"
+#include "../hdc_infrastructure/sample_stream.h"
 
 void getData(int dataset,double*** trainingData, double*** testingData, int** trainingLabels, int** testingLabels, int* trainingSamples, int* testingSamples);
 void getDataWithValSet(int dataset,
@@ -16,6 +18,17 @@ void getDataWithValSet(int dataset,
                        int* testingSamples,
                        double validationRatio);
 void getTestingData(int dataset, double*** testingData, int** testingLabels, int* testingSamples);
+void getDataMatrices(int dataset, struct sample_matrix *trainingData, struct sample_matrix *testingData, int** trainingLabels, int** testingLabels);
+void getDataMatricesWithValSet(int dataset,
+                               struct sample_matrix *trainingData,
+                               struct sample_matrix *validationData,
+                               struct sample_matrix *testingData,
+                               int** trainingLabels,
+                               int** validationLabels,
+                               int** testingLabels,
+                               double validationRatio);
+void getTestingDataMatrix(int dataset, struct sample_matrix *testingData, int** testingLabels);
+int openFootSampleSource(int dataset, int testing, struct sample_source *source);
 void freeData(double** data, size_t rows);
 void freeCSVLabels(int* labels);
 
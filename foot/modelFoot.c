@@ -3,128 +3,234 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "../hdc_infrastructure/assoc_mem.h"
 #include "../hdc_infrastructure/item_mem.h"
 #include "../hdc_infrastructure/asymItemMemory.h"
 #include "../hdc_infrastructure/encoder.h"
 #include "../hdc_infrastructure/operations.h"
+#include "../hdc_infrastructure/profiler.h"
 #include "dataReaderFootEMG.h"
 #include "configFoot.h"
 #include "../hdc_infrastructure/evaluator.h"
+#include "../hdc_infrastructure/hdc_config.h"
 #include "../hdc_infrastructure/ResultManager.h"
 #include "../hdc_infrastructure/quantizer.h"
 #include "../hdc_infrastructure/vector.h"
 #include "../hdc_infrastructure/trainer.h"
+#include "../hdc_infrastructure/timestamp_cache.h"
+#include "../hdc_infrastructure/workspace.h"
 
 int output_mode = OUTPUT_MODE;
 
-int main(void) {
-    result_manager_init();
+/**
+ * @brief Quantizes a split and encodes (or maps) its timestamp cache; returns 0 on success.
+ */
+static int cache_split(struct encoder *enc, double **data, int samples,
+                       struct quantized_dataset *levels, struct timestamp_cache *cache) {
+    if (init_quantized_dataset_for(enc->quantizer, levels, data, samples, NUM_FEATURES) != 0) {
+        return -1;
+    }
+    if (build_timestamp_cache(cache, enc, levels) != 0) {
+        free_quantized_dataset(levels);
+        return -1;
+    }
+    if (output_mode >= OUTPUT_DETAILED) {
+        printf("Timestamp cache %016llx: %s\n", (unsigned long long)cache->fingerprint,
+               cache->reused ? "reused" : "encoded");
+    }
+    return 0;
+}
 
-    if (output_mode >= OUTPUT_BASIC) {
-        printf("\nHDC-classification for EMG-signals:\n");
+/**
+ * @brief Trains the model and evaluates it on the validation and testing data.
+ *
+ * With TIMESTAMP_CACHE_DIR set, the timestamps of every split go through a
+ * persistent timestamp cache, so later runs with the same item memory and
+ * quantizer (e.g. a sweep over N_GRAM_SIZE or WINDOW) skip encoding.
+ */
+static void train_and_evaluate(struct encoder *enc, struct associative_memory *assMem,
+                               double **trainingData, int *trainingLabels, int trainingSamples,
+                               double **validationData, int *validationLabels, int validationSamples,
+                               double **testingData, int *testingLabels, int testingSamples,
+                               struct timeseries_eval_result *eval_val, struct timeseries_eval_result *eval_test) {
+    int has_validation = validationData && validationLabels && validationSamples > 0;
+    if (TIMESTAMP_CACHE_DIR[0] != '\0') {
+        double **data[3] = {trainingData, validationData, testingData};
+        int samples[3] = {trainingSamples, has_validation ? validationSamples : 0, testingSamples};
+        struct quantized_dataset levels[3];
+        struct timestamp_cache caches[3];
+        int built = 0;
+        while (built < 3 && (samples[built] == 0 || cache_split(enc, data[built], samples[built], &levels[built], &caches[built]) == 0)) {
+            built++;
+        }
+        if (built == 3) {
+            struct hdc_workspace ws;
+            init_hdc_workspace(&ws);
+            train_model_timeseries_cached(&levels[0], &caches[0], trainingLabels, assMem, enc);
+            if (has_validation) {
+                *eval_val = evaluate_model_timeseries_direct_cached(enc, assMem, &ws, &levels[1], &caches[1], validationLabels);
+            }
+            *eval_test = evaluate_model_timeseries_direct_cached(enc, assMem, &ws, &levels[2], &caches[2], testingLabels);
+            free_hdc_workspace(&ws);
+        } else {
+            fprintf(stderr, "Warning: timestamp cache failed, encoding directly.\n");
+        }
+        for (int split = 0; split < built; split++) {
+            if (samples[split] > 0) {
+                free_timestamp_cache(&caches[split]);
+                free_quantized_dataset(&levels[split]);
+            }
+        }
+        if (built == 3) {
+            return;
+        }
     }
 
-    double mean_pre_val_accuracy = 0.0;
-    double mean_pre_test_accuracy = 0.0;
-#if USE_GENETIC_ITEM_MEMORY
-    double mean_post_val_accuracy = 0.0;
-    double mean_post_test_accuracy = 0.0;
-#endif
-    int processed_datasets = 0;
+    train_model_timeseries(trainingData, trainingLabels, trainingSamples, assMem, enc);
+    if (has_validation) {
+        *eval_val = evaluate_model_timeseries_direct(enc, assMem, validationData, validationLabels, validationSamples);
+    }
+    *eval_test = evaluate_model_timeseries_direct(enc, assMem, testingData, testingLabels, testingSamples);
+}
 
-    for (int dataset = 0; dataset < 4; dataset++) {
-        double **trainingData = NULL;
-        double **validationData = NULL;
-        double **testingData = NULL;
-        int *trainingLabels = NULL;
-        int *validationLabels = NULL;
-        int *testingLabels = NULL;
-        int trainingSamples = 0;
-        int validationSamples = 0;
-        int testingSamples = 0;
-        struct timeseries_eval_result eval_pre_val = {0};
-        struct timeseries_eval_result eval_pre_test = {0};
+#define NUM_FOOT_DATASETS 4
+
+// The GA parallelizes inside each dataset and refines the global quantizer, so
+// GA builds keep running the datasets one after another. The channel and level
+// memories of PRECOMPUTED_ITEM_MEMORY=0 are drawn from the global rand(), so
+// those builds do too.
+#define RUN_DATASETS_IN_PARALLEL (PARALLEL_DATASETS && PRECOMPUTED_ITEM_MEMORY && !USE_GENETIC_ITEM_MEMORY)
+
+/**
+ * @brief Results of one dataset, reported in dataset order once it finished.
+ */
+struct dataset_run {
+    int status;
+    int has_validation;
+    struct timeseries_eval_result pre_val;
+    struct timeseries_eval_result pre_test;
 #if USE_GENETIC_ITEM_MEMORY
-        struct timeseries_eval_result eval_post_val = {0};
-        struct timeseries_eval_result eval_post_test = {0};
+    struct timeseries_eval_result post_val;
+    struct timeseries_eval_result post_test;
 #endif
-        char result_info[160];
+};
 
-        quantizer_clear();
+#if PRECOMPUTED_ITEM_MEMORY
+// All datasets use the CiM of ITEM_MEM_SEED; it is built once and every dataset
+// attaches a view. The GA gives a dataset private rows instead.
+static struct shared_item_memory *shared_cim = NULL;
+#endif
 
-        if (output_mode >= OUTPUT_BASIC) {
-            printf("\n\nModel for dataset #%d\n", dataset);
-        }
+/**
+ * @brief Loads one dataset and trains and evaluates its model; all model state
+ * but the shared CiM is private to the call.
+ *
+ * Without the GA every dataset fits its own quantizer instance, so several
+ * datasets can run concurrently (PARALLEL_DATASETS).
+ */
+static void run_dataset(int dataset, struct dataset_run *run) {
+    double **trainingData = NULL;
+    double **validationData = NULL;
+    double **testingData = NULL;
+    int *trainingLabels = NULL;
+    int *validationLabels = NULL;
+    int *testingLabels = NULL;
+    int trainingSamples = 0;
+    int validationSamples = 0;
+    int testingSamples = 0;
+
+    memset(run, 0, sizeof(*run));
 
 #if PRECOMPUTED_ITEM_MEMORY
-        struct item_memory itemMem;
-        init_precomp_item_memory(&itemMem, NUM_LEVELS, NUM_FEATURES);
+    struct item_memory itemMem;
+    attach_shared_item_memory(shared_cim, &itemMem);
 
-        struct encoder enc;
-        init_encoder(&enc, &itemMem);
+    struct encoder enc;
+    init_encoder(&enc, &itemMem);
 #else
-        struct item_memory electrodes;
-        struct item_memory intensityLevels;
-        init_item_memory(&electrodes, NUM_FEATURES);
-        init_continuous_item_memory(&intensityLevels, NUM_LEVELS);
+    struct item_memory electrodes;
+    struct item_memory intensityLevels;
+    init_item_memory(&electrodes, NUM_FEATURES);
+    init_continuous_item_memory(&intensityLevels, NUM_LEVELS);
 
-        struct encoder enc;
-        init_encoder(&enc, &electrodes, &intensityLevels);
+    struct encoder enc;
+    init_encoder(&enc, &electrodes, &intensityLevels);
 #endif
 
-        struct associative_memory assMem;
-        init_assoc_mem(&assMem);
-
-        getDataWithValSet(dataset,
-                          &trainingData,
-                          &validationData,
-                          &testingData,
-                          &trainingLabels,
-                          &validationLabels,
-                          &testingLabels,
-                          &trainingSamples,
-                          &validationSamples,
-                          &testingSamples,
-                          VALIDATION_RATIO);
-
-        if (quantizer_fit_from_training(trainingData,
-                                        trainingLabels,
-                                        trainingSamples,
-                                        NUM_FEATURES,
-                                        NUM_LEVELS) != 0) {
-            fprintf(stderr, "Error: Failed to initialize quantizer for dataset %d.\n", dataset);
-            return EXIT_FAILURE;
-        }
-
-        train_model_timeseries(trainingData, trainingLabels, trainingSamples, &assMem, &enc);
+    struct associative_memory assMem;
+    init_assoc_mem(&assMem);
+
+    getDataWithValSet(dataset,
+                      &trainingData,
+                      &validationData,
+                      &testingData,
+                      &trainingLabels,
+                      &validationLabels,
+                      &testingLabels,
+                      &trainingSamples,
+                      &validationSamples,
+                      &testingSamples,
+                      VALIDATION_RATIO);
+    run->has_validation = validationData && validationLabels && validationSamples > 0;
 
-        if (validationData && validationLabels && validationSamples > 0) {
-            eval_pre_val = evaluate_model_timeseries_direct(&enc, &assMem, validationData, validationLabels, validationSamples);
+#if USE_GENETIC_ITEM_MEMORY
+    quantizer_clear();
+    if (quantizer_fit_from_training(trainingData,
+                                    trainingLabels,
+                                    trainingSamples,
+                                    NUM_FEATURES,
+                                    NUM_LEVELS) != 0) {
+        fprintf(stderr, "Error: Failed to initialize quantizer for dataset %d.\n", dataset);
+        run->status = -1;
+    }
+#if PRECOMPUTED_ITEM_MEMORY && BINNING_MODE == GA_REFINED_BINNING
+    // The preprocessing GA refines the cuts; its final population seeds the main GA.
+    struct ga_warm_start warm = {0};
+    if (run->status == 0) {
+        int genome_length = (NUM_LEVELS - 1) * NUM_FEATURES;
+        uint16_t *flipCounts = (uint16_t *)calloc((size_t)genome_length, sizeof(uint16_t));
+        if (!flipCounts ||
+            optimize_item_memory_get_flip_counts(trainingData,
+                                                 trainingLabels,
+                                                 trainingSamples,
+                                                 validationData,
+                                                 validationLabels,
+                                                 validationSamples,
+                                                 flipCounts,
+                                                 &warm) != 0 ||
+            quantizer_refine_from_flip_counts(flipCounts, genome_length) != 0) {
+            fprintf(stderr, "Error: Failed to refine quantizer for dataset %d.\n", dataset);
+            run->status = -1;
         }
-        eval_pre_test = evaluate_model_timeseries_direct(&enc, &assMem, testingData, testingLabels, testingSamples);
-
-        snprintf(result_info, sizeof(result_info), "model=mine,scope=dataset,dataset=%d,phase=preopt-validation", dataset);
-        addResult(&eval_pre_val, result_info);
-        snprintf(result_info, sizeof(result_info), "model=mine,scope=dataset,dataset=%d,phase=preopt-test", dataset);
-        addResult(&eval_pre_test, result_info);
-
-        mean_pre_val_accuracy += eval_pre_val.overall_accuracy;
-        mean_pre_test_accuracy += eval_pre_test.overall_accuracy;
+        free(flipCounts);
+    }
+#endif
+#else
+    struct quantizer *quantizer = quantizer_fit(trainingData, trainingLabels, trainingSamples, NUM_FEATURES, NUM_LEVELS);
+    if (!quantizer) {
+        fprintf(stderr, "Error: Failed to initialize quantizer for dataset %d.\n", dataset);
+        run->status = -1;
+    }
+    encoder_use_quantizer(&enc, quantizer);
+#endif
 
-        if (output_mode >= OUTPUT_BASIC) {
-            printf("  Pre-Optimization\n");
-            printf("    validation accuracy: ");
-            if (validationData && validationLabels && validationSamples > 0) {
-                printf("%.2f%%\n", eval_pre_val.overall_accuracy * 100.0);
-            } else {
-                printf("n/a\n");
-            }
-            printf("    test accuracy: %.2f%%\n", eval_pre_test.overall_accuracy * 100.0);
-        }
+    if (run->status == 0) {
+        train_and_evaluate(&enc, &assMem, trainingData, trainingLabels, trainingSamples,
+                           validationData, validationLabels, validationSamples,
+                           testingData, testingLabels, testingSamples, &run->pre_val, &run->pre_test);
 
 #if USE_GENETIC_ITEM_MEMORY
-#if PRECOMPUTED_ITEM_MEMORY
+#if PRECOMPUTED_ITEM_MEMORY && BINNING_MODE == GA_REFINED_BINNING
+        optimize_item_memory_warm(&itemMem,
+                                  trainingData,
+                                  trainingLabels,
+                                  trainingSamples,
+                                  validationData,
+                                  validationLabels,
+                                  validationSamples,
+                                  &warm);
+#elif PRECOMPUTED_ITEM_MEMORY
         optimize_item_memory(&itemMem,
                              trainingData,
                              trainingLabels,
@@ -145,51 +251,129 @@ int main(void) {
 
         free_assoc_mem(&assMem);
         init_assoc_mem(&assMem);
-        train_model_timeseries(trainingData, trainingLabels, trainingSamples, &assMem, &enc);
+        train_and_evaluate(&enc, &assMem, trainingData, trainingLabels, trainingSamples,
+                           validationData, validationLabels, validationSamples,
+                           testingData, testingLabels, testingSamples, &run->post_val, &run->post_test);
+#endif
+    }
 
-        if (validationData && validationLabels && validationSamples > 0) {
-            eval_post_val = evaluate_model_timeseries_direct(&enc, &assMem, validationData, validationLabels, validationSamples);
-        }
-        eval_post_test = evaluate_model_timeseries_direct(&enc, &assMem, testingData, testingLabels, testingSamples);
+#if !USE_GENETIC_ITEM_MEMORY
+    if (quantizer) {
+        free_quantizer(quantizer);
+    }
+#elif PRECOMPUTED_ITEM_MEMORY && BINNING_MODE == GA_REFINED_BINNING
+    free_ga_warm_start(&warm);
+#endif
+    free_assoc_mem(&assMem);
+#if PRECOMPUTED_ITEM_MEMORY
+    detach_shared_item_memory(shared_cim, &itemMem);
+#else
+    free_item_memory(&electrodes);
+    free_item_memory(&intensityLevels);
+#endif
+    freeData(trainingData, trainingSamples);
+    if (validationData != NULL) {
+        freeData(validationData, validationSamples);
+    }
+    freeData(testingData, testingSamples);
+    freeCSVLabels(trainingLabels);
+    if (validationLabels != NULL) {
+        freeCSVLabels(validationLabels);
+    }
+    freeCSVLabels(testingLabels);
+}
+
+static void print_phase(const char *phase, int has_validation, const struct timeseries_eval_result *val,
+                        const struct timeseries_eval_result *test) {
+    printf("  %s\n", phase);
+    printf("    validation accuracy: ");
+    if (has_validation) {
+        printf("%.2f%%\n", val->overall_accuracy * 100.0);
+    } else {
+        printf("n/a\n");
+    }
+    printf("    test accuracy: %.2f%%\n", test->overall_accuracy * 100.0);
+}
 
-        snprintf(result_info, sizeof(result_info), "model=mine,scope=dataset,dataset=%d,phase=postopt-validation", dataset);
-        addResult(&eval_post_val, result_info);
-        snprintf(result_info, sizeof(result_info), "model=mine,scope=dataset,dataset=%d,phase=postopt-test", dataset);
-        addResult(&eval_post_test, result_info);
+/**
+ * @brief Writes the result rows of one dataset and prints its accuracies.
+ */
+static void report_dataset(int dataset, const struct dataset_run *run) {
+    char result_info[160];
+    snprintf(result_info, sizeof(result_info), "model=mine,scope=dataset,dataset=%d,phase=preopt-validation", dataset);
+    addResult(&run->pre_val, result_info);
+    snprintf(result_info, sizeof(result_info), "model=mine,scope=dataset,dataset=%d,phase=preopt-test", dataset);
+    addResult(&run->pre_test, result_info);
+    if (output_mode >= OUTPUT_BASIC) {
+        print_phase("Pre-Optimization", run->has_validation, &run->pre_val, &run->pre_test);
+    }
+#if USE_GENETIC_ITEM_MEMORY
+    snprintf(result_info, sizeof(result_info), "model=mine,scope=dataset,dataset=%d,phase=postopt-validation", dataset);
+    addResult(&run->post_val, result_info);
+    snprintf(result_info, sizeof(result_info), "model=mine,scope=dataset,dataset=%d,phase=postopt-test", dataset);
+    addResult(&run->post_test, result_info);
+    if (output_mode >= OUTPUT_BASIC) {
+        print_phase("Post-Optimization", run->has_validation, &run->post_val, &run->post_test);
+    }
+#endif
+}
+
+int main(void) {
+    struct hdc_config requested;
+    if (hdc_config_from_env(&requested) != 0 || hdc_config_check(&requested) != 0) {
+        return EXIT_FAILURE;
+    }
+    result_manager_init();
+
+    if (output_mode >= OUTPUT_BASIC) {
+        printf("\nHDC-classification for EMG-signals:\n");
+    }
+
+    double mean_pre_val_accuracy = 0.0;
+    double mean_pre_test_accuracy = 0.0;
+#if USE_GENETIC_ITEM_MEMORY
+    double mean_post_val_accuracy = 0.0;
+    double mean_post_test_accuracy = 0.0;
+#endif
+    int processed_datasets = 0;
+    struct dataset_run runs[NUM_FOOT_DATASETS];
+#if PRECOMPUTED_ITEM_MEMORY
+    shared_cim = create_shared_precomp_item_memory(NUM_LEVELS, NUM_FEATURES, ITEM_MEM_SEED);
+#endif
 
-        mean_post_val_accuracy += eval_post_val.overall_accuracy;
-        mean_post_test_accuracy += eval_post_test.overall_accuracy;
+#if RUN_DATASETS_IN_PARALLEL
+    // Every dataset runs on its own thread; the results are reported in dataset order below.
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (int dataset = 0; dataset < NUM_FOOT_DATASETS; dataset++) {
+        run_dataset(dataset, &runs[dataset]);
+    }
+#endif
 
+    for (int dataset = 0; dataset < NUM_FOOT_DATASETS; dataset++) {
         if (output_mode >= OUTPUT_BASIC) {
-            printf("  Post-Optimization\n");
-            printf("    validation accuracy: ");
-            if (validationData && validationLabels && validationSamples > 0) {
-                printf("%.2f%%\n", eval_post_val.overall_accuracy * 100.0);
-            } else {
-                printf("n/a\n");
-            }
-            printf("    test accuracy: %.2f%%\n", eval_post_test.overall_accuracy * 100.0);
+            printf("\n\nModel for dataset #%d\n", dataset);
         }
+#if !RUN_DATASETS_IN_PARALLEL
+        run_dataset(dataset, &runs[dataset]);
 #endif
-
-        free_assoc_mem(&assMem);
+        if (runs[dataset].status != 0) {
+            // Write the rows of the datasets before it (the sweep exits its runs with _exit).
 #if PRECOMPUTED_ITEM_MEMORY
-        free_item_memory(&itemMem);
-#else
-        free_item_memory(&electrodes);
-        free_item_memory(&intensityLevels);
+            release_shared_item_memory(shared_cim);
 #endif
-        freeData(trainingData, trainingSamples);
-        if (validationData != NULL) {
-            freeData(validationData, validationSamples);
-        }
-        freeData(testingData, testingSamples);
-        freeCSVLabels(trainingLabels);
-        if (validationLabels != NULL) {
-            freeCSVLabels(validationLabels);
+            result_manager_close();
+            return EXIT_FAILURE;
         }
-        freeCSVLabels(testingLabels);
+        report_dataset(dataset, &runs[dataset]);
 
+        mean_pre_val_accuracy += runs[dataset].pre_val.overall_accuracy;
+        mean_pre_test_accuracy += runs[dataset].pre_test.overall_accuracy;
+#if USE_GENETIC_ITEM_MEMORY
+        mean_post_val_accuracy += runs[dataset].post_val.overall_accuracy;
+        mean_post_test_accuracy += runs[dataset].post_test.overall_accuracy;
+#endif
         processed_datasets++;
     }
 
@@ -232,6 +416,19 @@ int main(void) {
         }
     }
 
+#if HDC_PROFILE
+    if (output_mode >= OUTPUT_BASIC) {
+        hdc_profile_print(stdout);
+    }
+#endif
+#if HDC_COST_MODEL
+    if (output_mode >= OUTPUT_BASIC) {
+        hdc_cost_print(stdout);
+    }
+#endif
+#if PRECOMPUTED_ITEM_MEMORY
+    release_shared_item_memory(shared_cim);
+#endif
     result_manager_close();
     return 0;
 }
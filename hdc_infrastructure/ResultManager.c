@@ -1,119 +1,771 @@
+/**
+ * @file ResultManager.c
+ * @brief Buffered results sink shared by threads and processes.
+ *
+ * @details
+ * addResult only formats its row into an in-memory batch under a mutex, so
+ * parallel datasets and sweep jobs never wait on the disk. A background thread
+ * writes the batch every RESULT_FLUSH_INTERVAL_MS (earlier once
+ * RESULT_FLUSH_BYTES are pending), and result_manager_close() or process exit
+ * writes the rest. Every flush is one append to a file opened with O_APPEND
+ * while holding an exclusive fcntl lock, so several processes appending to one
+ * results file (e.g. concurrent sweeps) write whole batches, never torn rows,
+ * and exactly one of them writes the header. An existing CSV whose header
+ * differs (e.g. one written without HDC_PROFILE columns) is left untouched
+ * rather than mixed with rows of another width. With RESULT_BINARY_PATH defined
+ * the same rows also go to a compact binary file (ResultManager.h).
+ *
+ * Windows builds have no pthreads, fcntl locks or fork. There each row is
+ * appended to an unbuffered stream as it arrives, and nothing guards against
+ * other processes appending to the same file.
+ */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
 #include "ResultManager.h"
+#include "byte_order.h"
+#include "profiler.h"
+#include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
 
-static FILE *result_file = NULL;
-static int header_written = 0;
+#ifndef RESULT_CSV_PATH
+#define RESULT_CSV_PATH "analysis/results.csv"
+#endif
 
-static void write_csv_header(FILE *file) {
-    if (!file) {
-        return;
+#if HDC_PROFILE
+#define RESULT_PROFILE_STAGES HDC_NUM_STAGES
+#else
+#define RESULT_PROFILE_STAGES 0
+#endif
+
+struct byte_buffer {
+    char *data;
+    size_t length;
+    size_t capacity;
+};
+
+#ifndef _WIN32
+/**
+ * @brief An append-only results file and the rows not yet written to it.
+ *
+ * `pending` is filled by addResult under result_lock; a flush swaps it with
+ * `writing` and writes that under io_lock, so producers keep appending while
+ * the disk write runs.
+ */
+struct result_sink {
+    const char *path;
+    int fd;
+    struct byte_buffer pending;
+    struct byte_buffer writing;
+    uint32_t pending_rows;
+    uint32_t writing_rows;
+};
+
+static struct result_sink csv_sink = {RESULT_CSV_PATH, -1, {NULL, 0, 0}, {NULL, 0, 0}, 0, 0};
+#ifdef RESULT_BINARY_PATH
+static struct result_sink binary_sink = {RESULT_BINARY_PATH, -1, {NULL, 0, 0}, {NULL, 0, 0}, 0, 0};
+#endif
+
+// Guards the pending batches and the flush thread state.
+static pthread_mutex_t result_lock = PTHREAD_MUTEX_INITIALIZER;
+// Serializes flushes, so batches reach the files in the order they were taken.
+static pthread_mutex_t io_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t flush_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t flush_thread;
+static int flush_thread_running = 0;
+static int flush_requested = 0;
+static int stop_requested = 0;
+static int process_hooks_installed = 0;
+#endif
+
+static int buffer_reserve(struct byte_buffer *buffer, size_t extra) {
+    if (buffer->length + extra <= buffer->capacity) {
+        return 0;
     }
-    fprintf(file,
-            "num_levels,num_features,vector_dimension,binning_mode,bipolar_mode,precomputed_item_memory,"
-            "use_genetic_item_memory,ga_selection_mode,ga_mutation_rate,n_gram_size,window,downsample,validation_ratio,"
-            "overall_accuracy,class_average_accuracy,class_vector_similarity,correct,not_correct,transition_error,total,info\n");
+    size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (capacity < buffer->length + extra) {
+        capacity *= 2;
+    }
+    char *data = (char *)realloc(buffer->data, capacity);
+    if (!data) {
+        fprintf(stderr, "ResultManager: failed to grow the row buffer.\n");
+        return -1;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 0;
 }
 
-static void write_csv_escaped(FILE *file, const char *value) {
-    if (!file) {
+static void buffer_append(struct byte_buffer *buffer, const void *data, size_t length) {
+    if (buffer_reserve(buffer, length) == 0) {
+        memcpy(buffer->data + buffer->length, data, length);
+        buffer->length += length;
+    }
+}
+
+static void buffer_printf(struct byte_buffer *buffer, const char *format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (length < 0) {
         return;
     }
-    if (!value) {
-        fprintf(file, "\"");
-        fprintf(file, "\"");
+    if ((size_t)length < sizeof(line)) {
+        buffer_append(buffer, line, (size_t)length);
         return;
     }
-    fputc('"', file);
-    for (const char *p = value; *p; p++) {
+    if (buffer_reserve(buffer, (size_t)length + 1) != 0) {
+        return;
+    }
+    va_start(args, format);
+    vsnprintf(buffer->data + buffer->length, (size_t)length + 1, format, args);
+    va_end(args);
+    buffer->length += (size_t)length;
+}
+
+static void buffer_free(struct byte_buffer *buffer) {
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+static void write_csv_header(struct byte_buffer *out) {
+    buffer_printf(out,
+                  "%s",
+                  "num_levels,num_features,vector_dimension,binning_mode,bipolar_mode,precomputed_item_memory,"
+                  "use_genetic_item_memory,ga_selection_mode,ga_mutation_rate,n_gram_size,window,downsample,validation_ratio,"
+                  "overall_accuracy,class_average_accuracy,class_vector_similarity,correct,not_correct,transition_error,total,info");
+#if HDC_PROFILE
+    // Profile builds add columns, so their default RESULT_CSV_PATH is a separate file.
+    for (int stage = 0; stage < HDC_NUM_STAGES; stage++) {
+        const char *name = hdc_profile_stage_name((enum hdc_profile_stage)stage);
+        buffer_printf(out, ",%s_ns,%s_calls", name, name);
+    }
+#endif
+    buffer_append(out, "\n", 1);
+}
+
+static void write_csv_escaped(struct byte_buffer *out, const char *value) {
+    buffer_append(out, "\"", 1);
+    for (const char *p = value ? value : ""; *p; p++) {
         if (*p == '"') {
-            fputc('"', file);
+            buffer_append(out, "\"", 1);
         }
-        fputc(*p, file);
+        buffer_append(out, p, 1);
     }
-    fputc('"', file);
+    buffer_append(out, "\"", 1);
 }
 
-void result_manager_init(void) {
-    if (result_file) {
+static int result_ga_selection_mode(void) {
+#ifdef GA_SELECTION_MODE
+    return GA_SELECTION_MODE;
+#else
+    return -1;
+#endif
+}
+
+static double result_ga_mutation_rate(void) {
+#ifdef GA_DEFAULT_MUTATION_RATE
+    return (double)GA_DEFAULT_MUTATION_RATE;
+#else
+    return -1.0;
+#endif
+}
+
+static void write_csv_row(struct byte_buffer *out,
+                          const struct timeseries_eval_result *result,
+                          double validation_ratio,
+                          const char *info,
+                          const struct hdc_profile_totals *totals) {
+    buffer_printf(out,
+                  "%d,%d,%d,%d,%d,%d,%d,%d,%.6f,%d,%d,%d,%.6f,",
+                  NUM_LEVELS,
+                  NUM_FEATURES,
+                  VECTOR_DIMENSION,
+                  BINNING_MODE,
+                  BIPOLAR_MODE,
+                  PRECOMPUTED_ITEM_MEMORY,
+                  USE_GENETIC_ITEM_MEMORY,
+                  result_ga_selection_mode(),
+                  result_ga_mutation_rate(),
+                  N_GRAM_SIZE,
+                  WINDOW,
+                  DOWNSAMPLE,
+                  validation_ratio);
+    buffer_printf(out,
+                  "%.8f,%.8f,%.8f,%zu,%zu,%zu,%zu,",
+                  result->overall_accuracy,
+                  result->class_average_accuracy,
+                  result->class_vector_similarity,
+                  result->correct,
+                  result->not_correct,
+                  result->transition_error,
+                  result->total);
+    write_csv_escaped(out, info);
+#if HDC_PROFILE
+    // Stage counters accumulated by the process so far (all threads).
+    for (int stage = 0; stage < HDC_NUM_STAGES; stage++) {
+        buffer_printf(out, ",%.0f,%llu", totals->ns[stage], (unsigned long long)totals->calls[stage]);
+    }
+#else
+    (void)totals;
+#endif
+    buffer_append(out, "\n", 1);
+}
+
+#ifdef RESULT_BINARY_PATH
+static void buffer_put_u16(struct byte_buffer *out, uint16_t value) {
+    uint8_t bytes[2];
+    put_u16(bytes, value);
+    buffer_append(out, bytes, sizeof(bytes));
+}
+
+static void buffer_put_u32(struct byte_buffer *out, uint32_t value) {
+    uint8_t bytes[4];
+    put_u32(bytes, value);
+    buffer_append(out, bytes, sizeof(bytes));
+}
+
+static void buffer_put_u64(struct byte_buffer *out, uint64_t value) {
+    uint8_t bytes[8];
+    put_u64(bytes, value);
+    buffer_append(out, bytes, sizeof(bytes));
+}
+
+static void buffer_put_f64(struct byte_buffer *out, double value) {
+    uint8_t bytes[8];
+    put_f64(bytes, value);
+    buffer_append(out, bytes, sizeof(bytes));
+}
+
+static void write_binary_header(struct byte_buffer *out) {
+    buffer_append(out, RESULT_FILE_MAGIC, 4);
+    buffer_put_u16(out, RESULT_FILE_VERSION);
+    buffer_put_u16(out, 0);
+}
+
+static void write_binary_block_header(struct byte_buffer *out, uint32_t rows) {
+    const int32_t settings[] = {NUM_LEVELS,
+                                NUM_FEATURES,
+                                VECTOR_DIMENSION,
+                                BINNING_MODE,
+                                BIPOLAR_MODE,
+                                PRECOMPUTED_ITEM_MEMORY,
+                                USE_GENETIC_ITEM_MEMORY,
+                                result_ga_selection_mode(),
+                                N_GRAM_SIZE,
+                                WINDOW,
+                                DOWNSAMPLE};
+    buffer_put_u32(out, rows);
+    for (size_t i = 0; i < sizeof(settings) / sizeof(settings[0]); i++) {
+        buffer_put_u32(out, (uint32_t)settings[i]);
+    }
+    buffer_put_f64(out, result_ga_mutation_rate());
+    buffer_put_u16(out, RESULT_PROFILE_STAGES);
+}
+
+static void write_binary_row(struct byte_buffer *out,
+                             const struct timeseries_eval_result *result,
+                             double validation_ratio,
+                             const char *info,
+                             const struct hdc_profile_totals *totals) {
+    buffer_put_f64(out, validation_ratio);
+    buffer_put_f64(out, result->overall_accuracy);
+    buffer_put_f64(out, result->class_average_accuracy);
+    buffer_put_f64(out, result->class_vector_similarity);
+    buffer_put_u64(out, result->correct);
+    buffer_put_u64(out, result->not_correct);
+    buffer_put_u64(out, result->transition_error);
+    buffer_put_u64(out, result->total);
+#if HDC_PROFILE
+    for (int stage = 0; stage < HDC_NUM_STAGES; stage++) {
+        buffer_put_f64(out, totals->ns[stage]);
+        buffer_put_u64(out, totals->calls[stage]);
+    }
+#else
+    (void)totals;
+#endif
+    size_t length = info ? strlen(info) : 0;
+    length = length > UINT16_MAX ? UINT16_MAX : length;
+    buffer_put_u16(out, (uint16_t)length);
+    buffer_append(out, info ? info : "", length);
+}
+#endif
+
+#ifndef _WIN32
+static int write_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return 0;
+}
+
+static int lock_file(int fd, short type) {
+    struct flock lock;
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = type;
+    lock.l_whence = SEEK_SET;
+    while (fcntl(fd, F_SETLKW, &lock) != 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Appends the taken batch of @p sink under the file lock; an empty file gets the header first.
+ *
+ * Called with io_lock held.
+ */
+static void write_batch(struct result_sink *sink, int binary) {
+    if (sink->fd < 0 || sink->writing_rows == 0) {
+        sink->writing.length = 0;
+        sink->writing_rows = 0;
         return;
     }
+    struct byte_buffer prefix = {NULL, 0, 0};
+    if (lock_file(sink->fd, F_WRLCK) != 0) {
+        fprintf(stderr, "ResultManager: failed to lock %s\n", sink->path);
+    }
+    struct stat info;
+    if (fstat(sink->fd, &info) == 0 && info.st_size == 0) {
+#ifdef RESULT_BINARY_PATH
+        if (binary) {
+            write_binary_header(&prefix);
+        } else
+#endif
+        {
+            write_csv_header(&prefix);
+        }
+    }
+#ifdef RESULT_BINARY_PATH
+    if (binary) {
+        write_binary_block_header(&prefix, sink->writing_rows);
+    }
+#else
+    (void)binary;
+#endif
+    // One buffer, so the batch goes out in a single write() in the common case.
+    if (prefix.length > 0) {
+        buffer_append(&prefix, sink->writing.data, sink->writing.length);
+    }
+    const struct byte_buffer *batch = prefix.length > 0 ? &prefix : &sink->writing;
+    if (write_all(sink->fd, batch->data, batch->length) != 0) {
+        fprintf(stderr, "ResultManager: failed to write %s\n", sink->path);
+    }
+    lock_file(sink->fd, F_UNLCK);
+    buffer_free(&prefix);
+    sink->writing.length = 0;
+    sink->writing_rows = 0;
+}
 
-#ifndef RESULT_CSV_PATH
-#define RESULT_CSV_PATH "analysis/results.csv"
+static void take_batch(struct result_sink *sink) {
+    struct byte_buffer taken = sink->pending;
+    sink->pending = sink->writing;
+    sink->writing = taken;
+    sink->writing_rows = sink->pending_rows;
+    sink->pending_rows = 0;
+}
+
+/**
+ * @brief Writes every pending row; producers only wait while the batches are swapped.
+ */
+void result_manager_flush(void) {
+    pthread_mutex_lock(&io_lock);
+    pthread_mutex_lock(&result_lock);
+    take_batch(&csv_sink);
+#ifdef RESULT_BINARY_PATH
+    take_batch(&binary_sink);
 #endif
+    pthread_mutex_unlock(&result_lock);
+    write_batch(&csv_sink, 0);
+#ifdef RESULT_BINARY_PATH
+    write_batch(&binary_sink, 1);
+#endif
+    pthread_mutex_unlock(&io_lock);
+}
 
-    result_file = fopen(RESULT_CSV_PATH, "a+");
-    if (!result_file) {
-        fprintf(stderr, "ResultManager: failed to open %s\n", RESULT_CSV_PATH);
+#if RESULT_FLUSH_INTERVAL_MS > 0
+static void *flush_thread_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&result_lock);
+    while (!stop_requested) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += RESULT_FLUSH_INTERVAL_MS / 1000;
+        deadline.tv_nsec += (long)(RESULT_FLUSH_INTERVAL_MS % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (!stop_requested && !flush_requested &&
+               pthread_cond_timedwait(&flush_cond, &result_lock, &deadline) == 0) {
+        }
+        flush_requested = 0;
+        if (stop_requested) {
+            break;
+        }
+        pthread_mutex_unlock(&result_lock);
+        result_manager_flush();
+        pthread_mutex_lock(&result_lock);
+    }
+    pthread_mutex_unlock(&result_lock);
+    return NULL;
+}
+#endif
+
+static void prepare_fork(void) {
+    pthread_mutex_lock(&io_lock);
+    pthread_mutex_lock(&result_lock);
+}
+
+static void resume_after_fork(void) {
+    pthread_mutex_unlock(&result_lock);
+    pthread_mutex_unlock(&io_lock);
+}
+
+/**
+ * @brief A forked child owns none of the parent's rows and has no flush thread.
+ *
+ * Dropping the inherited batches keeps the child's exit from writing the
+ * parent's rows a second time; the child restarts its own thread on demand.
+ */
+static void reset_after_fork(void) {
+    csv_sink.pending.length = 0;
+    csv_sink.pending_rows = 0;
+#ifdef RESULT_BINARY_PATH
+    binary_sink.pending.length = 0;
+    binary_sink.pending_rows = 0;
+#endif
+    flush_thread_running = 0;
+    flush_requested = 0;
+    stop_requested = 0;
+    resume_after_fork();
+}
+
+// fd of a sink whose file was refused; open_sink does not retry it.
+#define SINK_REFUSED (-2)
+
+/**
+ * @brief Whether a non-empty CSV starts with the header this build writes.
+ */
+static int csv_header_matches(int fd) {
+    struct byte_buffer expected = {NULL, 0, 0};
+    write_csv_header(&expected);
+    char *found = (char *)malloc(expected.length);
+    ssize_t length = found ? pread(fd, found, expected.length, 0) : -1;
+    int matches = length == (ssize_t)expected.length && memcmp(found, expected.data, expected.length) == 0;
+    free(found);
+    buffer_free(&expected);
+    return matches;
+}
+
+static void open_sink(struct result_sink *sink, int binary) {
+    if (sink->fd >= 0 || sink->fd == SINK_REFUSED) {
+        return;
+    }
+    sink->fd = open(sink->path, O_RDWR | O_APPEND | O_CREAT, 0644);
+    if (sink->fd < 0) {
+        fprintf(stderr, "ResultManager: failed to open %s\n", sink->path);
         return;
     }
+    struct stat info;
+    if (!binary && fstat(sink->fd, &info) == 0 && info.st_size > 0 && !csv_header_matches(sink->fd)) {
+        fprintf(stderr, "ResultManager: %s has a different header (HDC_PROFILE build?); not appending to it.\n",
+                sink->path);
+        close(sink->fd);
+        sink->fd = SINK_REFUSED;
+    }
+}
 
-    if (!header_written) {
-        fseek(result_file, 0, SEEK_END);
-        long size = ftell(result_file);
-        if (size <= 0) {
-            write_csv_header(result_file);
+/**
+ * @brief Opens the result files and starts the flush thread; called with result_lock held.
+ */
+static void open_result_files(void) {
+    if (!process_hooks_installed) {
+        pthread_atfork(prepare_fork, resume_after_fork, reset_after_fork);
+        // Runs that exit early (exit(), return from main) still write their rows.
+        atexit(result_manager_close);
+        process_hooks_installed = 1;
+    }
+    open_sink(&csv_sink, 0);
+#ifdef RESULT_BINARY_PATH
+    open_sink(&binary_sink, 1);
+#endif
+#if RESULT_FLUSH_INTERVAL_MS > 0
+    if (!flush_thread_running && csv_sink.fd >= 0) {
+        stop_requested = 0;
+        flush_thread_running = pthread_create(&flush_thread, NULL, flush_thread_main, NULL) == 0;
+        if (!flush_thread_running) {
+            fprintf(stderr, "ResultManager: failed to start the flush thread; writing rows as they arrive.\n");
         }
-        header_written = 1;
     }
+#endif
+}
+
+void result_manager_init(void) {
+    pthread_mutex_lock(&result_lock);
+    open_result_files();
+    pthread_mutex_unlock(&result_lock);
 }
 
 void result_manager_close(void) {
-    if (result_file) {
-        fclose(result_file);
-        result_file = NULL;
-        header_written = 0;
+    pthread_mutex_lock(&result_lock);
+    int joining = flush_thread_running;
+    stop_requested = 1;
+    pthread_cond_signal(&flush_cond);
+    pthread_mutex_unlock(&result_lock);
+    if (joining) {
+        pthread_join(flush_thread, NULL);
+    }
+
+    result_manager_flush();
+
+    pthread_mutex_lock(&io_lock);
+    pthread_mutex_lock(&result_lock);
+    struct result_sink *sinks[] = {
+        &csv_sink,
+#ifdef RESULT_BINARY_PATH
+        &binary_sink,
+#endif
+    };
+    for (size_t i = 0; i < sizeof(sinks) / sizeof(sinks[0]); i++) {
+        if (sinks[i]->fd >= 0) {
+            close(sinks[i]->fd);
+            sinks[i]->fd = -1;
+        }
+        buffer_free(&sinks[i]->pending);
+        buffer_free(&sinks[i]->writing);
     }
+    flush_thread_running = 0;
+    stop_requested = 0;
+    pthread_mutex_unlock(&result_lock);
+    pthread_mutex_unlock(&io_lock);
 }
 
-void addResult(const struct timeseries_eval_result *result, const char *info) {
+/**
+ * @brief `addResult` for a run whose validation split differs from VALIDATION_RATIO (e.g. a sweep).
+ *
+ * Safe to call from any thread; the row reaches the file with the next flush.
+ */
+void addResultWithValidationRatio(const struct timeseries_eval_result *result, double validation_ratio,
+                                  const char *info) {
     if (!result) {
         return;
     }
-    if (!result_file) {
-        result_manager_init();
-    }
-    if (!result_file) {
+    struct hdc_profile_totals *totals = NULL;
+#if HDC_PROFILE
+    struct hdc_profile_totals snapshot;
+    hdc_profile_snapshot(&snapshot);
+    totals = &snapshot;
+#endif
+
+    pthread_mutex_lock(&result_lock);
+    open_result_files();
+    if (csv_sink.fd < 0) {
+        pthread_mutex_unlock(&result_lock);
         return;
     }
+    write_csv_row(&csv_sink.pending, result, validation_ratio, info, totals);
+    csv_sink.pending_rows++;
+#ifdef RESULT_BINARY_PATH
+    if (binary_sink.fd >= 0) {
+        write_binary_row(&binary_sink.pending, result, validation_ratio, info, totals);
+        binary_sink.pending_rows++;
+    }
+#endif
+    int flush_now = !flush_thread_running;
+    if (flush_thread_running && csv_sink.pending.length >= RESULT_FLUSH_BYTES) {
+        flush_requested = 1;
+        pthread_cond_signal(&flush_cond);
+    }
+    pthread_mutex_unlock(&result_lock);
 
-    fprintf(result_file,
-            "%d,%d,%d,%d,%d,%d,%d,%d,%.6f,%d,%d,%d,%.6f,",
-            NUM_LEVELS,
-            NUM_FEATURES,
-            VECTOR_DIMENSION,
-            BINNING_MODE,
-            BIPOLAR_MODE,
-            PRECOMPUTED_ITEM_MEMORY,
-            USE_GENETIC_ITEM_MEMORY,
-#ifdef GA_SELECTION_MODE
-            GA_SELECTION_MODE,
+    if (flush_now) {
+        result_manager_flush();
+    }
+}
 #else
-            -1,
+/**
+ * @brief An append-only results file opened unbuffered, so every row reaches it at once.
+ */
+struct result_stream {
+    const char *path;
+    FILE *file;
+    int refused;
+};
+
+static struct result_stream csv_stream = {RESULT_CSV_PATH, NULL, 0};
+#ifdef RESULT_BINARY_PATH
+static struct result_stream binary_stream = {RESULT_BINARY_PATH, NULL, 0};
 #endif
-#ifdef GA_DEFAULT_MUTATION_RATE
-            (double)GA_DEFAULT_MUTATION_RATE,
-#else
-            -1.0,
-#endif
-            N_GRAM_SIZE,
-            WINDOW,
-            DOWNSAMPLE,
-            (double)VALIDATION_RATIO);
-
-    fprintf(result_file,
-            "%.8f,%.8f,%.8f,%zu,%zu,%zu,%zu,",
-            result->overall_accuracy,
-            result->class_average_accuracy,
-            result->class_vector_similarity,
-            result->correct,
-            result->not_correct,
-            result->transition_error,
-            result->total);
-
-    write_csv_escaped(result_file, info);
-    fputc('\n', result_file);
-    fflush(result_file);
+
+static void write_stream(struct result_stream *stream, const struct byte_buffer *data) {
+    if (data->length > 0 && fwrite(data->data, 1, data->length, stream->file) != data->length) {
+        fprintf(stderr, "ResultManager: failed to write %s\n", stream->path);
+    }
+}
+
+/**
+ * @brief Whether a non-empty CSV starts with the header this build writes.
+ */
+static int csv_header_matches(const char *path) {
+    struct byte_buffer expected = {NULL, 0, 0};
+    write_csv_header(&expected);
+    char *found = (char *)malloc(expected.length);
+    FILE *file = found ? fopen(path, "rb") : NULL;
+    int matches = file && fread(found, 1, expected.length, file) == expected.length &&
+                  memcmp(found, expected.data, expected.length) == 0;
+    if (file) {
+        fclose(file);
+    }
+    free(found);
+    buffer_free(&expected);
+    return matches;
+}
+
+/**
+ * @brief Opens @p stream for appending; an empty file gets the header first.
+ *
+ * Called inside the result_manager critical section.
+ */
+static void open_stream(struct result_stream *stream, int binary) {
+    if (stream->file || stream->refused) {
+        return;
+    }
+    stream->file = fopen(stream->path, "ab");
+    if (!stream->file) {
+        fprintf(stderr, "ResultManager: failed to open %s\n", stream->path);
+        return;
+    }
+    setvbuf(stream->file, NULL, _IONBF, 0);
+    fseek(stream->file, 0, SEEK_END);
+    struct byte_buffer header = {NULL, 0, 0};
+    if (ftell(stream->file) == 0) {
+#ifdef RESULT_BINARY_PATH
+        if (binary) {
+            write_binary_header(&header);
+        } else
+#endif
+        {
+            write_csv_header(&header);
+        }
+    } else if (!binary && !csv_header_matches(stream->path)) {
+        fprintf(stderr, "ResultManager: %s has a different header (HDC_PROFILE build?); not appending to it.\n",
+                stream->path);
+        fclose(stream->file);
+        stream->file = NULL;
+        stream->refused = 1;
+        return;
+    }
+    write_stream(stream, &header);
+    buffer_free(&header);
+}
+
+static void close_stream(struct result_stream *stream) {
+    if (stream->file) {
+        fclose(stream->file);
+        stream->file = NULL;
+    }
+}
+
+void result_manager_init(void) {
+#ifdef _OPENMP
+#pragma omp critical(result_manager)
+#endif
+    {
+        open_stream(&csv_stream, 0);
+#ifdef RESULT_BINARY_PATH
+        open_stream(&binary_stream, 1);
+#endif
+    }
+}
+
+void result_manager_flush(void) {
+    // Rows are written by addResult as they arrive.
+}
+
+void result_manager_close(void) {
+#ifdef _OPENMP
+#pragma omp critical(result_manager)
+#endif
+    {
+        close_stream(&csv_stream);
+#ifdef RESULT_BINARY_PATH
+        close_stream(&binary_stream);
+#endif
+    }
+}
+
+/**
+ * @brief `addResult` for a run whose validation split differs from VALIDATION_RATIO (e.g. a sweep).
+ *
+ * Safe to call from any OpenMP thread; the row is written before it returns.
+ */
+void addResultWithValidationRatio(const struct timeseries_eval_result *result, double validation_ratio,
+                                  const char *info) {
+    if (!result) {
+        return;
+    }
+    struct hdc_profile_totals *totals = NULL;
+#if HDC_PROFILE
+    struct hdc_profile_totals snapshot;
+    hdc_profile_snapshot(&snapshot);
+    totals = &snapshot;
+#endif
+
+    struct byte_buffer row = {NULL, 0, 0};
+    write_csv_row(&row, result, validation_ratio, info, totals);
+#ifdef RESULT_BINARY_PATH
+    struct byte_buffer binary_row = {NULL, 0, 0};
+    write_binary_block_header(&binary_row, 1);
+    write_binary_row(&binary_row, result, validation_ratio, info, totals);
+#endif
+#ifdef _OPENMP
+#pragma omp critical(result_manager)
+#endif
+    {
+        open_stream(&csv_stream, 0);
+        if (csv_stream.file) {
+            write_stream(&csv_stream, &row);
+#ifdef RESULT_BINARY_PATH
+            open_stream(&binary_stream, 1);
+            if (binary_stream.file) {
+                write_stream(&binary_stream, &binary_row);
+            }
+#endif
+        }
+    }
+    buffer_free(&row);
+#ifdef RESULT_BINARY_PATH
+    buffer_free(&binary_row);
+#endif
+}
+#endif
+
+void addResult(const struct timeseries_eval_result *result, const char *info) {
+    addResultWithValidationRatio(result, (double)VALIDATION_RATIO, info);
 }
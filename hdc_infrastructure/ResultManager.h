@@ -13,8 +13,39 @@
 
 #include "evaluator.h"
 
+#ifndef RESULT_FLUSH_BYTES
+#define RESULT_FLUSH_BYTES 65536 // pending CSV bytes that wake the flush thread early
+#endif
+#ifndef RESULT_FLUSH_INTERVAL_MS
+#define RESULT_FLUSH_INTERVAL_MS 1000 // flush thread period; 0 writes every row from addResult (no thread)
+#endif
+
+/**
+ * @brief Binary result file written next to the CSV when RESULT_BINARY_PATH is defined.
+ *
+ * All fields are little endian. The file starts with magic "HDCR", uint16
+ * version and uint16 reserved. Every flush then appends one block:
+ * - uint32 row count, eleven int32 settings (num_levels, num_features,
+ *   vector_dimension, binning_mode, bipolar_mode, precomputed_item_memory,
+ *   use_genetic_item_memory, ga_selection_mode, n_gram_size, window,
+ *   downsample), float64 ga_mutation_rate and uint16 profile stage count;
+ * - per row float64 validation_ratio, overall_accuracy,
+ *   class_average_accuracy and class_vector_similarity, uint64 correct,
+ *   not_correct, transition_error and total, per profile stage float64 ns
+ *   and uint64 calls, then uint16 info length and the info bytes.
+ *
+ * The settings are stored once per block instead of once per row, because
+ * they are compile-time constants of the writing process.
+ */
+#define RESULT_FILE_MAGIC "HDCR"
+#define RESULT_FILE_VERSION 1
+#define RESULT_FILE_HEADER_BYTES 8
+
 void result_manager_init(void);
+void result_manager_flush(void);
 void result_manager_close(void);
 void addResult(const struct timeseries_eval_result *result, const char *info);
+void addResultWithValidationRatio(const struct timeseries_eval_result *result, double validation_ratio,
+                                  const char *info);
 
 #endif // RESULT_MANAGER_H
@@ -16,15 +16,55 @@
 #include <string.h>
 #include <math.h>
 #include <ctype.h>
+#include <limits.h>
 #include "operations.h"
 #include "vector.h"
+#include "profiler.h"
 #include <stdio.h>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#define ASSOC_MEM_COUNTER_TAG "HDCC" // marks the training counters in a binary associative memory file
+
+/**
+ * @brief Cost model: `class_reads` class vectors fetched and `words` of them compared to queries.
+ */
+static inline void count_distance_cost(uint64_t class_reads, uint64_t words) {
+#if HDC_COST_MODEL
+    HDC_COST_ADD(HDC_STAGE_CLASSIFY, HDC_COST_ASSOC_READS, class_reads);
+    HDC_COST_ADD(HDC_STAGE_CLASSIFY, HDC_COST_ASSOC_READ_BYTES, words * sizeof(vector_element));
+#if !BIPOLAR_MODE
+    HDC_COST_ADD(HDC_STAGE_CLASSIFY, HDC_COST_XOR_WORDS, words);
+    HDC_COST_ADD(HDC_STAGE_CLASSIFY, HDC_COST_POPCOUNT_WORDS, words);
+#endif
+#else
+    (void)class_reads;
+    (void)words;
+#endif
+}
+
+/**
+ * @brief Cost model: `votes` samples added to the class counters, `changed_words` class vector words rewritten.
+ */
+static inline void count_update_cost(uint64_t votes, uint64_t class_writes, uint64_t changed_words) {
+#if HDC_COST_MODEL
+    HDC_COST_ADD(HDC_STAGE_CLASS_UPDATE, HDC_COST_COUNTER_UPDATES, votes * VECTOR_DIMENSION);
+    HDC_COST_ADD(HDC_STAGE_CLASS_UPDATE, HDC_COST_ASSOC_WRITES, class_writes);
+    HDC_COST_ADD(HDC_STAGE_CLASS_UPDATE, HDC_COST_ASSOC_WRITE_BYTES, changed_words * sizeof(vector_element));
+#else
+    (void)votes;
+    (void)class_writes;
+    (void)changed_words;
+#endif
+}
 
 /**
  * @brief Initializes the associative memory structure.
  *
  * @details
- * Allocates memory for storing hypervectors for each class and initializes the vectors to zero.
+ * Allocates one contiguous slab holding the hypervectors of all classes and initializes the
+ * vectors to zero.
  * The memory structure also tracks the number of stored vectors per class.
  *
  * @param assoc_mem A pointer to the `associative_memory` structure to initialize.
@@ -34,18 +74,50 @@ void init_assoc_mem(struct associative_memory *assoc_mem) {
         printf("Initializing associative memory for %d classes.\n",NUM_CLASSES);
     }
     assoc_mem->num_classes = NUM_CLASSES;
-    assoc_mem->class_vectors = (Vector **)malloc(NUM_CLASSES *sizeof(Vector*));
-    assoc_mem->counts = (int*)malloc(NUM_CLASSES*sizeof(int));
-    if(assoc_mem->class_vectors==NULL||assoc_mem->counts ==NULL){
+    assoc_mem->class_vectors = create_vector_slab(NUM_CLASSES, &assoc_mem->storage);
+    assoc_mem->counts = (int*)calloc(NUM_CLASSES, sizeof(int));
+    if(assoc_mem->counts ==NULL){
         printf("Failed to allocate memory for data");
         exit(EXIT_FAILURE);
-    }
-    for (int i = 0; i < NUM_CLASSES; i++) {
-        assoc_mem->class_vectors[i] = create_vector();
-        vector_zero(assoc_mem->class_vectors[i]);
-        assoc_mem->counts[i] = 0;
     }
-}
+    assoc_mem->read_only = false;
+#if BIPOLAR_MODE
+    refresh_class_norms(assoc_mem);
+#else
+    assoc_mem->keep_counters = ASSOC_MEM_KEEP_COUNTERS;
+    assoc_mem->counters = NULL;
+    assoc_mem->counter_nbits = 0;
+    assoc_mem->prune_mask = NULL;
+    assoc_mem->pruned_vectors = NULL;
+    assoc_mem->pruned_storage = NULL;
+    assoc_mem->pruned_dims = 0;
+#endif
+}
+
+#if BIPOLAR_MODE
+/**
+ * @brief Recomputes the cached norm of one class vector.
+ */
+static void refresh_class_norm(struct associative_memory *assoc_mem, int class_id) {
+    Vector *class_hv = assoc_mem->class_vectors[class_id];
+    assoc_mem->norms_sq[class_id] = dot_product(class_hv, class_hv);
+    assoc_mem->norms[class_id] = sqrt((double)assoc_mem->norms_sq[class_id]);
+}
+
+/**
+ * @brief Recomputes the cached norms of all class vectors.
+ *
+ * Must be called after class vectors are written directly instead of through
+ * `add_to_assoc_mem` or `normalize` (e.g. after loading or clearing them).
+ *
+ * @param assoc_mem A pointer to the associative memory structure.
+ */
+void refresh_class_norms(struct associative_memory *assoc_mem) {
+    for (int i = 0; i < assoc_mem->num_classes; i++) {
+        refresh_class_norm(assoc_mem, i);
+    }
+}
+#endif
 
 /**
  * @brief Adds or sets a hypervector to the associative memory for a specific class.
@@ -66,6 +138,10 @@ void init_assoc_mem(struct associative_memory *assoc_mem) {
 int add_to_assoc_mem(struct associative_memory *assoc_mem, Vector *sample_hv, int class_id) {
     //Bipolar case: adds an encoded data sample to the associative memory
     //Binary case: sets a classvector in the associative memory
+    if (assoc_mem->read_only) {
+        fprintf(stderr, "AddToAssocMem: the associative memory is read-only\n");
+        exit(EXIT_FAILURE);
+    }
     if (class_id >= 0 && class_id < assoc_mem->num_classes) {
 
         #if BIPOLAR_MODE
@@ -75,6 +151,7 @@ int add_to_assoc_mem(struct associative_memory *assoc_mem, Vector *sample_hv, in
                     memory_hv->data[i] = sample_hv->data[i];
                 }
                 assoc_mem->counts[class_id]=1;
+                refresh_class_norm(assoc_mem, class_id);
                 return 1;
             }else{
                 double angle = similarity_check(memory_hv, sample_hv);
@@ -94,11 +171,13 @@ int add_to_assoc_mem(struct associative_memory *assoc_mem, Vector *sample_hv, in
                     }
                     free_vector(temp_vector);
                     assoc_mem->counts[class_id]++;
+                    refresh_class_norm(assoc_mem, class_id);
                     return 1;
                 }
                 else{return 0;}
             }
         #else
+            clear_assoc_mem_pruning(assoc_mem);
             vector_copy(assoc_mem->class_vectors[class_id], sample_hv);
             assoc_mem->counts[class_id]=1;
             return 1;
@@ -109,6 +188,530 @@ int add_to_assoc_mem(struct associative_memory *assoc_mem, Vector *sample_hv, in
     }
 }
 
+#if !BIPOLAR_MODE
+/**
+ * @brief Majority threshold of a class trained on `count` vectors (as in the trainer).
+ */
+static int class_threshold(int count) {
+    int threshold = count / 2;
+#if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN
+    threshold++; // KRISCHAN sets a bit only above half the votes
+#endif
+    return threshold;
+}
+
+/**
+ * @brief Copies `nbits` planes per word out of counters with `src_nbits` planes per word.
+ *
+ * The low planes are kept; missing high planes are zeroed, so this both trims
+ * and widens the counters of one class.
+ */
+static void copy_counter_planes(uint64_t *dst, int nbits, const uint64_t *src, int src_nbits) {
+    size_t words = vector_storage_count();
+    int common = nbits < src_nbits ? nbits : src_nbits;
+    for (size_t w = 0; w < words; w++) {
+        memcpy(dst + w * (size_t)nbits, src + w * (size_t)src_nbits, (size_t)common * sizeof(uint64_t));
+        for (int b = common; b < nbits; b++) {
+            dst[w * (size_t)nbits + b] = 0ull;
+        }
+    }
+}
+
+/**
+ * @brief Keeps the training counters of all classes if `keep_counters` is set.
+ *
+ * Called by the trainer right before it discards its counters. Only as many
+ * planes as the largest class count needs are kept; `update_assoc_mem` widens
+ * them when a class outgrows them.
+ *
+ * @param class_planes Counters of classes 0..NUM_CLASSES-1 back to back, `nbits` planes per word.
+ * @param nbits Planes per word of `class_planes`.
+ */
+void retain_assoc_mem_counters(struct associative_memory *assoc_mem, const uint64_t *class_planes, int nbits) {
+    if (!assoc_mem->keep_counters) {
+        return;
+    }
+    int max_count = 0;
+    for (int i = 0; i < assoc_mem->num_classes; i++) {
+        if (assoc_mem->counts[i] > max_count) {
+            max_count = assoc_mem->counts[i];
+        }
+    }
+    int kept_nbits = bit_counter_planes(max_count);
+    if (kept_nbits > nbits) {
+        kept_nbits = nbits;
+    }
+    size_t words = vector_storage_count();
+    uint64_t *counters = (uint64_t *)malloc((size_t)assoc_mem->num_classes * words * kept_nbits * sizeof(uint64_t));
+    if (counters == NULL) {
+        fprintf(stderr, "Failed to allocate associative memory counters.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < assoc_mem->num_classes; i++) {
+        copy_counter_planes(counters + (size_t)i * words * kept_nbits, kept_nbits,
+                            class_planes + (size_t)i * words * nbits, nbits);
+    }
+    free(assoc_mem->counters);
+    assoc_mem->counters = counters;
+    assoc_mem->counter_nbits = kept_nbits;
+}
+
+/**
+ * @brief Re-packs the kept counters with `nbits` planes per word.
+ */
+static int widen_counters(struct associative_memory *assoc_mem, int nbits) {
+    size_t words = vector_storage_count();
+    uint64_t *counters = (uint64_t *)malloc((size_t)assoc_mem->num_classes * words * nbits * sizeof(uint64_t));
+    if (counters == NULL) {
+        fprintf(stderr, "update_assoc_mem: failed to allocate counters.\n");
+        return -1;
+    }
+    for (int i = 0; i < assoc_mem->num_classes; i++) {
+        copy_counter_planes(counters + (size_t)i * words * nbits, nbits,
+                            assoc_mem->counters + (size_t)i * words * assoc_mem->counter_nbits,
+                            assoc_mem->counter_nbits);
+    }
+    free(assoc_mem->counters);
+    assoc_mem->counters = counters;
+    assoc_mem->counter_nbits = nbits;
+    return 0;
+}
+
+/**
+ * @brief Bits of storage word `w` that belong to the vector (all but the tail padding).
+ */
+static inline uint64_t word_mask(size_t w) {
+    int rest = VECTOR_DIMENSION & 63;
+    return (rest != 0 && w == VECTOR_WORD_COUNT - 1) ? (1ull << rest) - 1ull : ~0ull;
+}
+
+/**
+ * @brief Ripple-adds `weight` to the 64 counters of one word whose bit is set in `bits`.
+ */
+static inline void add_counter_word(uint64_t *word_planes, int nbits, uint64_t bits, int weight) {
+    uint64_t carry = 0ull;
+    for (int b = 0; b < nbits; b++) {
+        uint64_t a = word_planes[b];
+        uint64_t c = ((weight >> b) & 1) ? bits : 0ull;
+        word_planes[b] = a ^ c ^ carry;
+        carry = (a & c) | (carry & (a ^ c));
+    }
+}
+
+/**
+ * @brief Counters of one word at or above `threshold`, compared MSB first as in `bit_counter_threshold`.
+ */
+static inline uint64_t threshold_counter_word(const uint64_t *word_planes, int nbits, int threshold) {
+    uint64_t greater = 0ull;
+    uint64_t equal = ~0ull;
+    for (int b = nbits - 1; b >= 0; b--) {
+        if ((threshold >> b) & 1) {
+            equal &= word_planes[b];
+        } else {
+            greater |= equal & word_planes[b];
+            equal &= ~word_planes[b];
+        }
+    }
+    return greater | equal;
+}
+
+
+/**
+ * @brief Widens the kept counters so every class can count up to `max_count`.
+ */
+static int reserve_counters(struct associative_memory *assoc_mem, int max_count) {
+    if (assoc_mem->counters == NULL) {
+        fprintf(stderr, "update_assoc_mem: no training counters kept (set keep_counters before training)\n");
+        return -1;
+    }
+    int needed = bit_counter_planes(max_count);
+    if (needed > assoc_mem->counter_nbits) {
+        return widen_counters(assoc_mem, needed);
+    }
+    return 0;
+}
+#endif
+
+/**
+ * @brief Adapts one class to a new sample without retraining.
+ *
+ * @details
+ * A positive `weight` votes for the sample, a negative one against it (the
+ * bipolar sum of the class moves away from the sample).
+ * - In **binary mode** the sample (or, against it, its complement) is added
+ *   `|weight|` times to the class' kept counters (see `keep_counters`) and the
+ *   class vector is re-thresholded at the new majority. Each word is updated in
+ *   one pass over its planes; when the threshold did not move only the words
+ *   the sample changes are touched. The class vector is the one a full retrain
+ *   with the sample repeated `weight` times would produce.
+ * - In **bipolar mode** the class vector already is the vote sum, so
+ *   `weight` times the sample is added directly.
+ *
+ * @param assoc_mem A pointer to the associative memory structure.
+ * @param class_id The class to adapt.
+ * @param sample_hv The encoded sample.
+ * @param weight How many training samples this one counts as (non-zero, negative to vote against it).
+ * @return Number of class vector words that changed, or -1 on invalid
+ *         arguments or when no counters were kept.
+ */
+int update_assoc_mem(struct associative_memory *assoc_mem, int class_id, const Vector *sample_hv, int weight) {
+    if (assoc_mem->read_only) {
+        fprintf(stderr, "update_assoc_mem: the associative memory is read-only.\n");
+        return -1;
+    }
+    int votes = weight < 0 ? -weight : weight;
+    if (class_id < 0 || class_id >= assoc_mem->num_classes || sample_hv == NULL || weight == 0 ||
+        weight == INT_MIN || assoc_mem->counts[class_id] > INT_MAX - votes) {
+        fprintf(stderr, "update_assoc_mem: invalid class %d or weight %d\n", class_id, weight);
+        return -1;
+    }
+    HDC_PROFILE_BEGIN(HDC_STAGE_CLASS_UPDATE);
+    Vector *memory_hv = assoc_mem->class_vectors[class_id];
+    size_t words = vector_storage_count();
+    int changed = 0;
+#if BIPOLAR_MODE
+    for (size_t i = 0; i < words; i++) {
+        vector_element updated = memory_hv->data[i] + (vector_element)weight * sample_hv->data[i];
+        changed += updated != memory_hv->data[i];
+        memory_hv->data[i] = updated;
+    }
+    assoc_mem->counts[class_id] += votes;
+    refresh_class_norm(assoc_mem, class_id);
+#else
+    int count = assoc_mem->counts[class_id] + votes;
+    if (reserve_counters(assoc_mem, count) != 0) {
+        HDC_PROFILE_END(HDC_STAGE_CLASS_UPDATE, 0);
+        return -1;
+    }
+    int nbits = assoc_mem->counter_nbits;
+    int old_threshold = class_threshold(assoc_mem->counts[class_id]);
+    int threshold = class_threshold(count);
+    assoc_mem->counts[class_id] = count;
+    uint64_t *planes = assoc_mem->counters + (size_t)class_id * words * nbits;
+    for (size_t w = 0; w < words; w++) {
+        uint64_t bits = (weight > 0 ? sample_hv->data[w] : ~sample_hv->data[w]) & word_mask(w);
+        if (bits == 0ull && threshold == old_threshold) {
+            continue;
+        }
+        uint64_t *word_planes = planes + w * (size_t)nbits;
+        add_counter_word(word_planes, nbits, bits, votes);
+        uint64_t updated = threshold_counter_word(word_planes, nbits, threshold) & word_mask(w);
+        if (updated != memory_hv->data[w]) {
+            memory_hv->data[w] = updated;
+            changed++;
+        }
+    }
+    if (changed > 0 && assoc_mem->prune_mask != NULL) {
+        prune_assoc_mem(assoc_mem); // falls back to the full vectors if it fails
+    }
+#endif
+    count_update_cost(1, changed > 0, (uint64_t)changed);
+    HDC_PROFILE_END(HDC_STAGE_CLASS_UPDATE, 1);
+    return changed;
+}
+
+/**
+ * @brief Applies many `update_assoc_mem` votes at once.
+ *
+ * In binary mode all votes are added to the counters first and every touched
+ * class is re-thresholded once. The words are split into tiles of
+ * ASSOC_MEM_UPDATE_TILE_WORDS that run in parallel under OpenMP; a tile's
+ * counters stay in cache while all votes are added. The result equals calling
+ * `update_assoc_mem` for every vote.
+ *
+ * @param sample_hvs The encoded samples.
+ * @param class_ids Class of every vote.
+ * @param weights Weight of every vote (non-zero, negative to vote against the sample).
+ * @param n Number of votes.
+ * @return Number of class vector words that changed, or -1 on invalid arguments
+ *         or when no counters were kept (nothing is updated then).
+ */
+int update_assoc_mem_batch(struct associative_memory *assoc_mem, Vector *const *sample_hvs,
+                           const int *class_ids, const int *weights, int n) {
+    if (assoc_mem->read_only) {
+        fprintf(stderr, "update_assoc_mem_batch: the associative memory is read-only.\n");
+        return -1;
+    }
+#if BIPOLAR_MODE
+    int changed = 0;
+    for (int i = 0; i < n; i++) {
+        int result = update_assoc_mem(assoc_mem, class_ids[i], sample_hvs[i], weights[i]);
+        if (result < 0) {
+            return -1;
+        }
+        changed += result;
+    }
+    return changed;
+#else
+    long long counts[NUM_CLASSES];
+    int thresholds[NUM_CLASSES];
+    int touched[NUM_CLASSES] = {0};
+    long long max_count = 0;
+    for (int c = 0; c < assoc_mem->num_classes; c++) {
+        counts[c] = assoc_mem->counts[c];
+    }
+    for (int i = 0; i < n; i++) {
+        int c = class_ids[i];
+        if (c < 0 || c >= assoc_mem->num_classes || sample_hvs[i] == NULL || weights[i] == 0 || weights[i] == INT_MIN) {
+            fprintf(stderr, "update_assoc_mem_batch: invalid vote %d (class %d, weight %d)\n",
+                    i, c, weights[i]);
+            return -1;
+        }
+        counts[c] += weights[i] < 0 ? -(long long)weights[i] : weights[i];
+        touched[c] = 1;
+    }
+    for (int c = 0; c < assoc_mem->num_classes; c++) {
+        if (counts[c] > INT_MAX) {
+            fprintf(stderr, "update_assoc_mem_batch: class %d exceeds the counter range\n", c);
+            return -1;
+        }
+        if (counts[c] > max_count) {
+            max_count = counts[c];
+        }
+    }
+    if (reserve_counters(assoc_mem, (int)max_count) != 0) {
+        return -1;
+    }
+    HDC_PROFILE_BEGIN(HDC_STAGE_CLASS_UPDATE);
+    for (int c = 0; c < assoc_mem->num_classes; c++) {
+        thresholds[c] = class_threshold((int)counts[c]);
+        assoc_mem->counts[c] = (int)counts[c];
+    }
+
+    int nbits = assoc_mem->counter_nbits;
+    size_t words = vector_storage_count();
+    int tiles = (int)((words + ASSOC_MEM_UPDATE_TILE_WORDS - 1) / ASSOC_MEM_UPDATE_TILE_WORDS);
+    int changed = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(+ : changed) if ((long long)n * tiles > 4096)
+#endif
+    for (int tile = 0; tile < tiles; tile++) {
+        size_t begin = (size_t)tile * ASSOC_MEM_UPDATE_TILE_WORDS;
+        size_t end = begin + ASSOC_MEM_UPDATE_TILE_WORDS < words ? begin + ASSOC_MEM_UPDATE_TILE_WORDS : words;
+        for (int i = 0; i < n; i++) {
+            uint64_t *planes = assoc_mem->counters + (size_t)class_ids[i] * words * nbits;
+            const uint64_t *data = sample_hvs[i]->data;
+            int votes = weights[i] < 0 ? -weights[i] : weights[i];
+            for (size_t w = begin; w < end; w++) {
+                uint64_t bits = (weights[i] > 0 ? data[w] : ~data[w]) & word_mask(w);
+                add_counter_word(planes + w * (size_t)nbits, nbits, bits, votes);
+            }
+        }
+        for (int c = 0; c < assoc_mem->num_classes; c++) {
+            if (!touched[c]) {
+                continue;
+            }
+            const uint64_t *planes = assoc_mem->counters + (size_t)c * words * nbits;
+            uint64_t *class_data = assoc_mem->class_vectors[c]->data;
+            for (size_t w = begin; w < end; w++) {
+                uint64_t updated = threshold_counter_word(planes + w * (size_t)nbits, nbits, thresholds[c]) & word_mask(w);
+                if (updated != class_data[w]) {
+                    class_data[w] = updated;
+                    changed++;
+                }
+            }
+        }
+    }
+    if (changed > 0 && assoc_mem->prune_mask != NULL) {
+        prune_assoc_mem(assoc_mem);
+    }
+    int touched_classes = 0;
+    for (int c = 0; c < assoc_mem->num_classes; c++) {
+        touched_classes += touched[c];
+    }
+    count_update_cost((uint64_t)n, (uint64_t)touched_classes, (uint64_t)changed);
+    HDC_PROFILE_END(HDC_STAGE_CLASS_UPDATE, n);
+    return changed;
+#endif
+}
+
+#if !BIPOLAR_MODE
+/**
+ * @brief Packs the bits of `word` selected by `mask` into the low bits of the result.
+ */
+static inline uint64_t gather_bits(uint64_t word, uint64_t mask) {
+#if defined(__BMI2__)
+    return _pext_u64(word, mask);
+#else
+    uint64_t packed = 0;
+    for (uint64_t bit = 1; mask != 0; bit <<= 1) {
+        uint64_t lowest = mask & (~mask + 1ull);
+        if (word & lowest) {
+            packed |= bit;
+        }
+        mask ^= lowest;
+    }
+    return packed;
+#endif
+}
+
+static inline size_t pruned_words(const struct associative_memory *assoc_mem) {
+    return ((size_t)assoc_mem->pruned_dims + 63) / 64;
+}
+
+/**
+ * @brief Compacts `vec` to the retained dimensions of a pruned associative memory.
+ *
+ * Writes `pruned_words` words to `compact`.
+ */
+static void gather_pruned(const struct associative_memory *assoc_mem, const Vector *vec, uint64_t *compact) {
+    // The packed bits collect in a register and are stored a full word at a time.
+    uint64_t pending = 0;
+    int fill = 0;
+    size_t out = 0;
+    for (size_t w = 0; w < VECTOR_WORD_COUNT; w++) {
+        uint64_t mask = assoc_mem->prune_mask[w];
+        uint64_t bits = gather_bits(vec->data[w], mask);
+        int count = __builtin_popcountll(mask);
+        pending |= bits << fill;
+        fill += count;
+        if (fill >= 64) {
+            compact[out++] = pending;
+            fill -= 64;
+            pending = fill > 0 ? bits >> (count - fill) : 0;
+        }
+    }
+    if (fill > 0) {
+        compact[out] = pending;
+    }
+}
+
+/**
+ * @brief Drops the dimension pruning of `prune_assoc_mem`; classification uses the full vectors again.
+ */
+void clear_assoc_mem_pruning(struct associative_memory *assoc_mem) {
+    if (assoc_mem->prune_mask == NULL) {
+        return;
+    }
+    free_vector_slab(assoc_mem->pruned_vectors, assoc_mem->pruned_storage);
+    free(assoc_mem->prune_mask);
+    assoc_mem->prune_mask = NULL;
+    assoc_mem->pruned_vectors = NULL;
+    assoc_mem->pruned_storage = NULL;
+    assoc_mem->pruned_dims = 0;
+}
+
+/**
+ * @brief Restricts classification to the dimensions in which the classes disagree.
+ *
+ * @details
+ * A dimension that holds the same bit in every class vector adds the same amount
+ * to the distance of a query to every class, so it cannot change which class is
+ * nearest. This pass keeps the dimensions where at least two classes differ and
+ * compacts every class vector to them; `classify` and `classify_batch` (without
+ * raw distances) then gather those dimensions of the query and compare the
+ * compacted vectors only. Labels, ties and the `-1` case are unchanged: a query
+ * can only be at distance VECTOR_DIMENSION from every class when all classes are
+ * equal, and then nothing is pruned.
+ *
+ * Call it after training. `update_assoc_mem` and `update_assoc_mem_batch` prune
+ * a pruned memory again after changing it; `add_to_assoc_mem`, `normalize` and
+ * loading drop the pruning.
+ * `classify_topk` and raw distances always use the full vectors. Enabled after
+ * every binary training run with ASSOC_MEM_PRUNE_DIMENSIONS.
+ *
+ * @param assoc_mem A trained associative memory.
+ * @return Number of retained dimensions (0 when all classes are equal and
+ *         nothing is pruned), or -1 on allocation failure.
+ */
+int prune_assoc_mem(struct associative_memory *assoc_mem) {
+    clear_assoc_mem_pruning(assoc_mem);
+    uint64_t *mask = (uint64_t *)calloc(VECTOR_WORD_COUNT, sizeof(uint64_t));
+    if (mask == NULL) {
+        fprintf(stderr, "prune_assoc_mem: allocation failed.\n");
+        return -1;
+    }
+    int retained = 0;
+    const vector_element *first = assoc_mem->class_vectors[0]->data;
+    for (size_t w = 0; w < VECTOR_WORD_COUNT; w++) {
+        for (int c = 1; c < assoc_mem->num_classes; c++) {
+            mask[w] |= first[w] ^ assoc_mem->class_vectors[c]->data[w];
+        }
+        mask[w] &= word_mask(w);
+        retained += __builtin_popcountll(mask[w]);
+    }
+    if (retained == 0) {
+        free(mask);
+        return 0;
+    }
+
+    assoc_mem->prune_mask = mask;
+    assoc_mem->pruned_dims = retained;
+    assoc_mem->pruned_vectors = create_vector_slab(assoc_mem->num_classes, &assoc_mem->pruned_storage);
+    for (int c = 0; c < assoc_mem->num_classes; c++) {
+        gather_pruned(assoc_mem, assoc_mem->class_vectors[c], assoc_mem->pruned_vectors[c]->data);
+    }
+    if (output_mode >= OUTPUT_DETAILED) {
+        printf("Pruned associative memory to %d of %d dimensions.\n", retained, VECTOR_DIMENSION);
+    }
+    return retained;
+}
+
+/**
+ * @brief Nearest of `num_classes` rows to a query of `dimension` bits in `words` storage words.
+ *
+ * The distances are accumulated CLASSIFY_EXIT_WORDS words at a time, dropping
+ * the classes that can no longer win (see `classify`).
+ */
+static int nearest_class(Vector *sample_hv, Vector *const *class_vectors, int num_classes,
+                         size_t words, long dimension) {
+    Vector *active[NUM_CLASSES] = {NULL};
+    int ids[NUM_CLASSES];
+    int distances[NUM_CLASSES] = {0};
+    int num_active = num_classes;
+    for (int c = 0; c < num_active; c++) {
+        active[c] = class_vectors[c];
+        ids[c] = c;
+    }
+    count_distance_cost((uint64_t)num_classes, 0);
+
+    size_t offset = 0;
+    while (offset < words && num_active > 1) {
+        size_t block = words - offset < CLASSIFY_EXIT_WORDS ? words - offset : CLASSIFY_EXIT_WORDS;
+        hamming_distance_accumulate(sample_hv, active, num_active, offset, block, distances);
+        count_distance_cost(0, (uint64_t)block * num_active);
+        offset += block;
+
+        long remaining = dimension - (long)offset * 64;
+        if (remaining < 0) {
+            remaining = 0;
+        }
+        int leader = 0;
+        for (int a = 1; a < num_active; a++) {
+            if (distances[a] < distances[leader]) {
+                leader = a;
+            }
+        }
+        // Survivors keep their order, so the lowest class id still wins ties.
+        long bound = (long)distances[leader] + remaining;
+        int kept = 0;
+        for (int a = 0; a < num_active; a++) {
+            if (distances[a] > bound || (distances[a] == bound && a > leader)) {
+                continue;
+            }
+            active[kept] = active[a];
+            ids[kept] = ids[a];
+            distances[kept] = distances[a];
+            kept++;
+        }
+        num_active = kept;
+    }
+
+    int best = 0;
+    for (int a = 1; a < num_active; a++) {
+        if (distances[a] < distances[best]) {
+            best = a;
+        }
+    }
+    if (offset < words) {
+        // Only the leader is left: its full distance decides whether it is a valid match.
+        hamming_distance_accumulate(sample_hv, active, 1, offset, words - offset, distances);
+        count_distance_cost(0, words - offset);
+    }
+    return distances[best] < dimension ? ids[best] : -1;
+}
+#endif
+
 /**
  * @brief Classifies an input hypervector based on its similarity to stored class vectors.
  *
@@ -116,24 +719,194 @@ int add_to_assoc_mem(struct associative_memory *assoc_mem, Vector *sample_hv, in
  * Compares the input vector with each class vector in the associative memory using
  * cosine similarity (for bipolar mode) or Hamming distance (for binary mode).
  *
+ * In binary mode the distances are accumulated CLASSIFY_EXIT_WORDS storage words
+ * at a time. After every block, a class whose partial distance already exceeds
+ * the leader's distance plus every bit still to come can no longer win and is
+ * dropped; once only the leader is left the remaining bits are skipped. The
+ * result is the same as comparing the full vectors. After `prune_assoc_mem` the
+ * query is compacted first and only the retained dimensions are compared.
+ *
+ * In bipolar mode the class norms are cached, so each class costs one integer
+ * dot product: the sample norm is constant across classes, which leaves
+ * `dot / |class|` as the score to maximize, compared against `-|sample|` (a
+ * cosine similarity of -1).
+ *
  * @param assoc_mem A pointer to the associative memory structure.
  * @param hv The input hypervector to classify.
  * @return The predicted class label, or `-1` if no valid classification is possible.
  *
  */
 int classify(struct associative_memory *assoc_mem, Vector *sample_hv) {
+    HDC_PROFILE_BEGIN(HDC_STAGE_CLASSIFY);
+#if BIPOLAR_MODE
+    long long sample_norm_sq = dot_product(sample_hv, sample_hv);
+    if (sample_norm_sq == 0) {
+        HDC_PROFILE_END(HDC_STAGE_CLASSIFY, 1);
+        return -1;
+    }
     int best_class = -1;
-    double best_similarity = -1.0;
+    double best_score = -sqrt((double)sample_norm_sq);
 
     for (int i = 0; i < assoc_mem->num_classes; i++) {
-        double similarity = similarity_check(assoc_mem->class_vectors[i], sample_hv);
-        if (similarity > best_similarity) {
-            best_similarity = similarity;
+        if (assoc_mem->norms_sq[i] == 0) {
+            continue; // Zero class vectors never match, as in cosine_similarity.
+        }
+        double score = (double)dot_product(assoc_mem->class_vectors[i], sample_hv) / assoc_mem->norms[i];
+        count_distance_cost(1, vector_storage_count());
+        if (score > best_score) {
+            best_score = score;
             best_class = i;
         }
     }
 
+    HDC_PROFILE_END(HDC_STAGE_CLASSIFY, 1);
     return best_class;
+#else
+    int label;
+    if (assoc_mem->prune_mask != NULL) {
+        _Alignas(VECTOR_ALIGNMENT) vector_element compact_data[VECTOR_WORD_COUNT];
+        Vector compact = {compact_data};
+        gather_pruned(assoc_mem, sample_hv, compact_data);
+        label = nearest_class(&compact, assoc_mem->pruned_vectors, assoc_mem->num_classes,
+                              pruned_words(assoc_mem), assoc_mem->pruned_dims);
+    } else {
+        label = nearest_class(sample_hv, assoc_mem->class_vectors, assoc_mem->num_classes,
+                              vector_storage_count(), VECTOR_DIMENSION);
+    }
+    HDC_PROFILE_END(HDC_STAGE_CLASSIFY, 1);
+    return label;
+#endif
+}
+
+/**
+ * @brief Ranks the classes closest to an input hypervector.
+ *
+ * @details
+ * Computes the similarity of the input vector to every class vector (see
+ * `similarity_check`; in binary mode through the raw Hamming distances) and
+ * returns the best `k` classes in descending order of similarity, ties going to
+ * the lower class id. The margin of a prediction is
+ * `similarities_out[0] - similarities_out[1]`.
+ *
+ * @param assoc_mem A pointer to the associative memory structure.
+ * @param sample_hv The input hypervector to classify.
+ * @param k Number of classes to return.
+ * @param labels_out Receives up to `k` class labels, best first.
+ * @param similarities_out Receives the similarity of each returned class.
+ * @return Number of classes returned: `k`, capped at the number of classes.
+ *
+ * @note The first label is what `classify` returns, unless its similarity is
+ *       at most -1 (no valid match; -2 flags an invalid cosine similarity).
+ */
+int classify_topk(struct associative_memory *assoc_mem, Vector *sample_hv, int k,
+                  int *labels_out, double *similarities_out) {
+    HDC_PROFILE_BEGIN(HDC_STAGE_CLASSIFY);
+    int num_classes = assoc_mem->num_classes;
+    double similarities[NUM_CLASSES];
+#if BIPOLAR_MODE
+    for (int c = 0; c < num_classes; c++) {
+        similarities[c] = similarity_check(assoc_mem->class_vectors[c], sample_hv);
+    }
+    count_distance_cost((uint64_t)num_classes, (uint64_t)num_classes * vector_storage_count());
+#else
+    int distances[NUM_CLASSES];
+    hamming_distance_block(&sample_hv, 1, assoc_mem->class_vectors, num_classes, distances);
+    count_distance_cost((uint64_t)num_classes, (uint64_t)num_classes * vector_storage_count());
+    for (int c = 0; c < num_classes; c++) {
+        similarities[c] = hamming_similarity(distances[c]);
+    }
+#endif
+    if (k > num_classes) {
+        k = num_classes;
+    }
+    if (k < 0) {
+        k = 0;
+    }
+    bool taken[NUM_CLASSES] = {false};
+    for (int rank = 0; rank < k; rank++) {
+        int best = -1;
+        for (int c = 0; c < num_classes; c++) {
+            if (!taken[c] && (best < 0 || similarities[c] > similarities[best])) {
+                best = c;
+            }
+        }
+        taken[best] = true;
+        labels_out[rank] = best;
+        similarities_out[rank] = similarities[best];
+    }
+    HDC_PROFILE_END(HDC_STAGE_CLASSIFY, 1);
+    return k;
+}
+
+/**
+ * @brief Classifies a batch of hypervectors against all class vectors at once.
+ *
+ * @details
+ * In **binary mode** the raw Hamming distances of every query to every class are
+ * computed with the tiled `hamming_distance_block` kernel and the nearest class
+ * wins; ties go to the lower class id and a query at distance VECTOR_DIMENSION
+ * from every class gets `-1`, exactly as `classify` would decide. The distances
+ * are only converted to similarities by callers that ask for them
+ * (`hamming_similarity`).
+ * Without `distances_out`, a pruned memory (`prune_assoc_mem`) compares the
+ * compacted queries one by one, with the early exit of `classify`.
+ * In **bipolar mode** there are no Hamming distances; every query goes through
+ * `classify` and `distances_out` must be NULL.
+ *
+ * @param assoc_mem A pointer to the associative memory structure.
+ * @param queries The hypervectors to classify.
+ * @param n Number of queries.
+ * @param labels_out Receives the predicted class label (or `-1`) of every query.
+ * @param distances_out Optional (NULL): receives `n * num_classes` raw Hamming
+ *        distances, the distance of query `q` to class `c` at `[q * num_classes + c]`.
+ * @return 0 on success, -1 if `distances_out` is requested in bipolar mode.
+ */
+int classify_batch(struct associative_memory *assoc_mem, Vector *const *queries, int n,
+                   int *labels_out, int *distances_out) {
+#if BIPOLAR_MODE
+    if (distances_out != NULL) {
+        fprintf(stderr, "classify_batch: Hamming distances are not available in bipolar mode\n");
+        return -1;
+    }
+    for (int q = 0; q < n; q++) {
+        labels_out[q] = classify(assoc_mem, queries[q]);
+    }
+#else
+    HDC_PROFILE_BEGIN(HDC_STAGE_CLASSIFY);
+    int num_classes = assoc_mem->num_classes;
+    if (assoc_mem->prune_mask != NULL && distances_out == NULL) {
+        _Alignas(VECTOR_ALIGNMENT) vector_element compact_data[VECTOR_WORD_COUNT];
+        Vector compact = {compact_data};
+        for (int q = 0; q < n; q++) {
+            gather_pruned(assoc_mem, queries[q], compact_data);
+            labels_out[q] = nearest_class(&compact, assoc_mem->pruned_vectors, num_classes,
+                                          pruned_words(assoc_mem), assoc_mem->pruned_dims);
+        }
+        HDC_PROFILE_END(HDC_STAGE_CLASSIFY, n);
+        return 0;
+    }
+    int block_distances[HAMMING_QUERY_BLOCK * NUM_CLASSES];
+    for (int first = 0; first < n; first += HAMMING_QUERY_BLOCK) {
+        int count = n - first < HAMMING_QUERY_BLOCK ? n - first : HAMMING_QUERY_BLOCK;
+        int *distances = distances_out ? distances_out + (size_t)first * num_classes : block_distances;
+        hamming_distance_block(queries + first, count, assoc_mem->class_vectors, num_classes, distances);
+        count_distance_cost((uint64_t)count * num_classes, (uint64_t)count * num_classes * vector_storage_count());
+        for (int q = 0; q < count; q++) {
+            const int *row = distances + (size_t)q * num_classes;
+            int best_class = -1;
+            int best_distance = VECTOR_DIMENSION;
+            for (int c = 0; c < num_classes; c++) {
+                if (row[c] < best_distance) {
+                    best_distance = row[c];
+                    best_class = c;
+                }
+            }
+            labels_out[first + q] = best_class;
+        }
+    }
+    HDC_PROFILE_END(HDC_STAGE_CLASSIFY, n);
+#endif
+    return 0;
 }
 /**
  * @brief Retrieves the class vector for a given class ID.
@@ -159,18 +932,25 @@ Vector* get_class_vector(struct associative_memory *assoc_mem, int class_id) {
 /**
  * @brief Frees the memory allocated for associative memory.
  *
- * This function frees the memory allocated for the class vectors and count array in the associative memory.
+ * This function frees the slab holding the class vectors and the count array in the associative memory.
  *
  * @param assoc_mem A pointer to the associative memory structure to be freed.
  */
 
 // Free associative memory
 void free_assoc_mem(struct associative_memory *assoc_mem) {
-    for (int i = 0; i < NUM_CLASSES; i++) {
-        free_vector(assoc_mem->class_vectors[i]);
-    }
-    free(assoc_mem->class_vectors);
+    if (assoc_mem->read_only) {
+        fprintf(stderr, "free_assoc_mem: the associative memory is read-only; close its owner instead.\n");
+        return;
+    }
+    free_vector_slab(assoc_mem->class_vectors, assoc_mem->storage);
     free(assoc_mem->counts);
+#if !BIPOLAR_MODE
+    free(assoc_mem->counters);
+    assoc_mem->counters = NULL;
+    assoc_mem->counter_nbits = 0;
+    clear_assoc_mem_pruning(assoc_mem);
+#endif
 }
 
 /**
@@ -211,6 +991,9 @@ void normalize(struct associative_memory *assoc_mem) {
     if (output_mode >= OUTPUT_DETAILED) {
         printf("Normalizing associative memory\n");
     }
+#if !BIPOLAR_MODE
+    clear_assoc_mem_pruning(assoc_mem);
+#endif
     for (int i = 0; i < assoc_mem->num_classes; i++) {
         int count = assoc_mem->counts[i];
         if (count > 0) {
@@ -219,6 +1002,9 @@ void normalize(struct associative_memory *assoc_mem) {
             }
         }
     }
+#if BIPOLAR_MODE
+    refresh_class_norms(assoc_mem);
+#endif
 }
 
 /**
@@ -236,6 +1022,10 @@ void normalize(struct associative_memory *assoc_mem) {
  * The total size of the binary file will be:
  * `NUM_CLASSES * VECTOR_DIMENSION * sizeof(vector_element)`
  *
+ * In binary mode, kept training counters (see `update_assoc_mem`) follow the
+ * class vectors: the tag `ASSOC_MEM_COUNTER_TAG`, the plane count, the class
+ * counts and the counter planes. Files without counters keep the plain layout.
+ *
  * @param assoc_mem A pointer to the associative memory structure.
  * @param file_path The path to the binary file where the memory should be stored.
  *
@@ -255,6 +1045,21 @@ void store_assoc_mem_to_bin(struct associative_memory *assoc_mem, const char *fi
                vector_storage_count(),
                file);
     }
+#if !BIPOLAR_MODE
+    if (assoc_mem->counters != NULL) {
+        int32_t nbits = assoc_mem->counter_nbits;
+        fwrite(ASSOC_MEM_COUNTER_TAG, 1, 4, file);
+        fwrite(&nbits, sizeof(nbits), 1, file);
+        for (int i = 0; i < assoc_mem->num_classes; i++) {
+            int32_t count = assoc_mem->counts[i];
+            fwrite(&count, sizeof(count), 1, file);
+        }
+        fwrite(assoc_mem->counters,
+               sizeof(uint64_t),
+               (size_t)assoc_mem->num_classes * vector_storage_count() * (size_t)nbits,
+               file);
+    }
+#endif
 
     fclose(file);
     printf("Associative memory successfully stored to %s\n", file_path);
@@ -271,7 +1076,8 @@ void store_assoc_mem_to_bin(struct associative_memory *assoc_mem, const char *fi
  * - For **binary mode**:
  *   Each element of the class vector is read as an `bool` and is expected to be `0` or `1`.
  * 
- * The function allocates memory for the class vectors as needed.
+ * The function allocates memory for the class vectors as needed. Training counters
+ * stored after the class vectors are loaded as well and enable `update_assoc_mem`.
  *
  * @param assoc_mem A pointer to the associative memory structure.
  * @param filepath The path to the binary file from which to load the memory.
@@ -296,8 +1102,43 @@ void load_assoc_mem_from_bin(struct associative_memory *assoc_mem, const char *f
             exit(EXIT_FAILURE);
         }
     }
+#if !BIPOLAR_MODE
+    char tag[4];
+    size_t tag_bytes = fread(tag, 1, sizeof(tag), file);
+    if (tag_bytes > 0) {
+        int32_t nbits = 0;
+        if (tag_bytes != sizeof(tag) || memcmp(tag, ASSOC_MEM_COUNTER_TAG, sizeof(tag)) != 0 ||
+            fread(&nbits, sizeof(nbits), 1, file) != 1 || nbits < 1 || nbits > 31) {
+            fprintf(stderr, "Error: Unexpected data after the class vectors in %s\n", filepath);
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < NUM_CLASSES; i++) {
+            int32_t count = 0;
+            if (fread(&count, sizeof(count), 1, file) != 1) {
+                fprintf(stderr, "Error: Incomplete class counts in %s\n", filepath);
+                exit(EXIT_FAILURE);
+            }
+            assoc_mem->counts[i] = count;
+        }
+        size_t counter_words = (size_t)NUM_CLASSES * vector_storage_count() * (size_t)nbits;
+        assoc_mem->counters = (uint64_t *)malloc(counter_words * sizeof(uint64_t));
+        if (assoc_mem->counters == NULL) {
+            fprintf(stderr, "Failed to allocate associative memory counters.\n");
+            exit(EXIT_FAILURE);
+        }
+        if (fread(assoc_mem->counters, sizeof(uint64_t), counter_words, file) != counter_words) {
+            fprintf(stderr, "Error: Incomplete training counters in %s\n", filepath);
+            exit(EXIT_FAILURE);
+        }
+        assoc_mem->counter_nbits = nbits;
+        assoc_mem->keep_counters = true;
+    }
+#endif
 
     fclose(file);
+#if BIPOLAR_MODE
+    refresh_class_norms(assoc_mem);
+#endif
     printf("Associative memory successfully loaded from %s\n", filepath);
 }
 
@@ -466,5 +1307,8 @@ void load_assoc_mem_from_csv(struct associative_memory *assoc_mem, const char *f
     }
 
     fclose(file);
+#if BIPOLAR_MODE
+    refresh_class_norms(assoc_mem);
+#endif
     printf("Associative memory successfully loaded from %s\n", filepath);
 }
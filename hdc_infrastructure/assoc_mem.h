@@ -13,6 +13,19 @@
 
 #include <stdbool.h>
 #include "vector.h"
+
+#ifndef CLASSIFY_EXIT_WORDS
+#define CLASSIFY_EXIT_WORDS 16 // storage words classify compares before checking for an early exit
+#endif
+#ifndef ASSOC_MEM_KEEP_COUNTERS
+#define ASSOC_MEM_KEEP_COUNTERS 0 // keep the binary training counters so update_assoc_mem can adapt the classes
+#endif
+#ifndef ASSOC_MEM_PRUNE_DIMENSIONS
+#define ASSOC_MEM_PRUNE_DIMENSIONS 0 // after training, classify only on the dimensions where the classes disagree
+#endif
+#ifndef ASSOC_MEM_UPDATE_TILE_WORDS
+#define ASSOC_MEM_UPDATE_TILE_WORDS 8 // storage words per parallel tile of update_assoc_mem_batch
+#endif
 /**
  * @brief Represents the associative memory used for HDC.
  *
@@ -20,11 +33,40 @@
  * - **num_classes**: The total number of classes in the associative memory.
  * - **class_vectors**: Array of hypervectors, one for each class.
  * - **counts**: Array of integers tracking the number of samples per class.
+ * - **storage**: Contiguous aligned slab backing all class vectors.
+ * - **norms_sq**, **norms** (bipolar mode): Cached squared and plain Euclidean norm
+ *   of every class vector, refreshed whenever a class vector changes
+ *   (`refresh_class_norms`).
+ * - **keep_counters** (binary mode): Training retains its per-bit vote counters
+ *   in **counters** (initialized from ASSOC_MEM_KEEP_COUNTERS, may be set before training).
+ * - **counters**, **counter_nbits** (binary mode): Bit-sliced vote counters of every
+ *   class, `vector_storage_count() * counter_nbits` words per class in the layout of
+ *   `bit_counter_add`; NULL when not kept.
+ * - **prune_mask**, **pruned_vectors**, **pruned_storage**, **pruned_dims** (binary mode):
+ *   Set by `prune_assoc_mem`: the dimensions in which at least two class vectors
+ *   differ, and every class vector compacted to those dimensions (bit `i` of a
+ *   compacted vector is its `i`-th retained dimension). NULL / 0 when not pruned.
+ * - **read_only**: The class vectors and counts live in read-only storage (a mapped
+ *   model bundle or an exported model); training and `free_assoc_mem` refuse it.
  */
 struct associative_memory {
     int num_classes;
     Vector **class_vectors;
     int *counts;
+    vector_element *storage;
+    bool read_only;
+#if BIPOLAR_MODE
+    long long norms_sq[NUM_CLASSES];
+    double norms[NUM_CLASSES];
+#else
+    bool keep_counters;
+    uint64_t *counters;
+    int counter_nbits;
+    uint64_t *prune_mask;
+    Vector **pruned_vectors;
+    vector_element *pruned_storage;
+    int pruned_dims;
+#endif
 };
 
 // Initialize associative memory
@@ -36,10 +78,33 @@ int add_to_assoc_mem(struct associative_memory *assoc_mem, Vector *sample_hv, in
 // Classify a given hypervector
 int classify(struct associative_memory *assoc_mem, Vector *sample_hv);
 
+// Rank the k classes closest to a hypervector, with their similarities
+int classify_topk(struct associative_memory *assoc_mem, Vector *sample_hv, int k,
+                  int *labels_out, double *similarities_out);
+
+// Classify a batch of hypervectors, optionally returning raw Hamming distances
+int classify_batch(struct associative_memory *assoc_mem, Vector *const *queries, int n,
+                   int *labels_out, int *distances_out);
+
+// Adapt a class to a new sample hypervector, counting it `weight` times
+int update_assoc_mem(struct associative_memory *assoc_mem, int class_id, const Vector *sample_hv, int weight);
+int update_assoc_mem_batch(struct associative_memory *assoc_mem, Vector *const *sample_hvs,
+                           const int *class_ids, const int *weights, int n);
+#if !BIPOLAR_MODE
+void retain_assoc_mem_counters(struct associative_memory *assoc_mem, const uint64_t *class_planes, int nbits);
+
+// Restrict classify and classify_batch to the dimensions where the classes disagree
+int prune_assoc_mem(struct associative_memory *assoc_mem);
+void clear_assoc_mem_pruning(struct associative_memory *assoc_mem);
+#endif
+
 Vector* get_class_vector(struct associative_memory *assoc_mem, int class_id);
 void free_assoc_mem(struct associative_memory *assoc_mem);
 void print_class_vectors(struct associative_memory *assoc_mem);
 void normalize(struct associative_memory *assoc_mem);
+#if BIPOLAR_MODE
+void refresh_class_norms(struct associative_memory *assoc_mem);
+#endif
 void store_assoc_mem_to_bin(struct associative_memory *assoc_mem, const char *file_path);
 void load_assoc_mem_from_bin(struct associative_memory *assoc_mem, const char *filepath);
 void store_assoc_mem_to_csv(struct associative_memory *assoc_mem, const char *file_path);
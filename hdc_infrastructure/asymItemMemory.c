@@ -1,10 +1,19 @@
+#if GA_POOL_HUGE_PAGES && defined(__linux__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
 #include "asymItemMemory.h"
 #include "assoc_mem.h"
 #include "encoder.h"
 #include "evaluator.h"
+#include "ga_cim_export.h"
+#include "ga_island.h"
 #include "item_mem.h"
+#include "offload.h"
 #include "operations.h"
+#include "profiler.h"
 #include "trainer.h"
+#include "quantizer.h"
+#include "workspace.h"
 #include "vector.h"
 #include <stdlib.h>
 #include <string.h>
@@ -18,6 +27,9 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #endif
+#if GA_POOL_HUGE_PAGES && defined(__linux__)
+#include <sys/mman.h>
+#endif
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -25,10 +37,51 @@
 #ifndef GA_CIM_EXPORT_ENABLED
 #define GA_CIM_EXPORT_ENABLED 0
 #endif
+#define GA_CIM_EXPORT_CSV 0     // full item memory as text, final generation only
+#define GA_CIM_EXPORT_COMPACT 1 // genomes and scores of every generation (ga_cim_export.h)
+#ifndef GA_CIM_EXPORT_FORMAT
+#define GA_CIM_EXPORT_FORMAT GA_CIM_EXPORT_COMPACT
+#endif
+
+#ifndef GA_BATCH_CANDIDATES
+#define GA_BATCH_CANDIDATES 4
+#endif
+
+#ifndef GA_FITNESS_CACHE_SIZE
+#define GA_FITNESS_CACHE_SIZE 1024 // genomes whose scores are memoized per GA run (0 disables)
+#endif
+
+#ifndef GA_SURROGATE_HISTORY
+#define GA_SURROGATE_HISTORY 512 // fully scored genomes the surrogate is fitted to (the most recent ones)
+#endif
+#ifndef GA_SURROGATE_RIDGE
+#define GA_SURROGATE_RIDGE 1e-4 // surrogate ridge penalty per history genome
+#endif
+#define GA_SURROGATE_FEATURES 7
+#define GA_SURROGATE_MIN_HISTORY (4 * GA_SURROGATE_FEATURES) // no screening before this many real fitnesses
+
+#ifndef GA_POOL_HUGE_PAGES
+#define GA_POOL_HUGE_PAGES 0 // back the per-thread GA candidate pools with transparent huge pages (Linux)
+#endif
+
+#ifndef GA_NESTED_PARALLELISM
+#define GA_NESTED_PARALLELISM 1 // split candidate batches into data shards when threads would idle
+#endif
+
+#ifndef GA_DELTA_ENCODING
+#define GA_DELTA_ENCODING 1
+#endif
+#ifndef GA_DELTA_MAX_CHANGED_FRACTION
+#define GA_DELTA_MAX_CHANGED_FRACTION 0.25 // re-encode from scratch above this share of changed CiM rows
+#endif
+// Delta encoding patches binary precomputed n-gram encodings only.
+#define GA_DELTA_ACTIVE (GA_DELTA_ENCODING && PRECOMPUTED_ITEM_MEMORY && !BIPOLAR_MODE && \
+                         MODEL_VARIANT != MODEL_VARIANT_KRISCHAN)
 
 #if GA_CIM_EXPORT_ENABLED
 static int g_cim_export_run_counter = 0;
 #endif
+static int g_ga_run_counter = 0;
 
 void init_ga_params(struct ga_params *params) {
     if (!params) {
@@ -41,6 +94,26 @@ void init_ga_params(struct ga_params *params) {
     params->tournament_size = GA_DEFAULT_TOURNAMENT_SIZE;
     params->log_every = GA_DEFAULT_LOG_EVERY;
     params->seed = GA_DEFAULT_SEED;
+    params->racing_rungs = GA_DEFAULT_RACING_RUNGS;
+    params->racing_min_fraction = GA_DEFAULT_RACING_MIN_FRACTION;
+    params->racing_keep_fraction = GA_DEFAULT_RACING_KEEP_FRACTION;
+    params->surrogate_keep_fraction = GA_DEFAULT_SURROGATE_KEEP_FRACTION;
+    params->surrogate_refit_every = GA_DEFAULT_SURROGATE_REFIT_EVERY;
+    params->island_count = GA_DEFAULT_ISLANDS;
+    params->island_id = 0;
+    params->migration_interval = GA_DEFAULT_MIGRATION_INTERVAL;
+    params->migrants = GA_DEFAULT_MIGRANTS;
+    params->checkpoint_every = GA_DEFAULT_CHECKPOINT_EVERY;
+    params->resume = GA_DEFAULT_RESUME;
+    params->warm_start_generations = GA_DEFAULT_WARM_START_GENERATIONS;
+}
+
+void free_ga_warm_start(struct ga_warm_start *warm_start) {
+    if (!warm_start) {
+        return;
+    }
+    free(warm_start->population);
+    memset(warm_start, 0, sizeof(*warm_start));
 }
 
 static uint32_t xorshift32(uint32_t *state) {
@@ -614,10 +687,50 @@ struct ga_eval_context {
     double **testing_data;
     int *testing_labels;
     int testing_samples;
+    const struct quantized_dataset *training_levels;
+    const struct quantized_dataset *testing_levels;
     const char *export_label;
+#if HDC_OFFLOAD
+    struct offload_context *offload; // device copy of the data above, or NULL for the CPU path (run_ga)
+#endif
 };
 
-#if GA_CIM_EXPORT_ENABLED
+/**
+ * @brief Quantizes the GA training/testing data once for all candidates.
+ *
+ * The quantizer is fixed for the whole GA run, so every candidate can train and
+ * evaluate on the same level matrices instead of re-running `get_signal_level`.
+ */
+static int init_ga_level_cache(struct ga_eval_context *ctx,
+                               struct quantized_dataset *training_levels,
+                               struct quantized_dataset *testing_levels) {
+    ctx->training_levels = NULL;
+    ctx->testing_levels = NULL;
+    if (init_quantized_dataset(training_levels, ctx->training_data, ctx->training_samples, NUM_FEATURES) != 0) {
+        return -1;
+    }
+    ctx->training_levels = training_levels;
+    testing_levels->levels = NULL;
+    if (ctx->testing_data && ctx->testing_labels && ctx->testing_samples > 0) {
+        if (init_quantized_dataset(testing_levels, ctx->testing_data, ctx->testing_samples, NUM_FEATURES) != 0) {
+            free_quantized_dataset(training_levels);
+            ctx->training_levels = NULL;
+            return -1;
+        }
+        ctx->testing_levels = testing_levels;
+    }
+    return 0;
+}
+
+static void free_ga_level_cache(struct ga_eval_context *ctx,
+                                struct quantized_dataset *training_levels,
+                                struct quantized_dataset *testing_levels) {
+    free_quantized_dataset(training_levels);
+    free_quantized_dataset(testing_levels);
+    ctx->training_levels = NULL;
+    ctx->testing_levels = NULL;
+}
+
 static int create_directory_if_missing(const char *path) {
     if (!path || path[0] == '\0') {
         return -1;
@@ -634,6 +747,7 @@ static int create_directory_if_missing(const char *path) {
     return -1;
 }
 
+#if GA_CIM_EXPORT_ENABLED
 static int init_cim_export_run_dir(const char *label, char *out_dir, size_t out_dir_size) {
     if (!out_dir || out_dir_size == 0) {
         return -1;
@@ -685,6 +799,62 @@ static int init_cim_export_run_dir(const char *label, char *out_dir, size_t out_
     return 0;
 }
 
+/**
+ * @brief Fills the export header describing the CiMs of the GA run on `ctx`.
+ */
+static void init_cim_export_header(struct ga_cim_export_header *header, const struct ga_eval_context *ctx) {
+    header->mode = PRECOMPUTED_ITEM_MEMORY ? GA_CIM_EXPORT_PRECOMPUTED : GA_CIM_EXPORT_CONTINUOUS;
+    header->num_levels = ctx->num_levels;
+    header->num_features = ctx->num_features;
+    header->dimension = VECTOR_DIMENSION;
+    header->max_flips = GA_MAX_FLIPS_CIM;
+    header->seed = ctx->seed;
+    header->genome_length = (ctx->num_levels - 1) * ctx->num_features;
+}
+
+#if GA_CIM_EXPORT_FORMAT == GA_CIM_EXPORT_COMPACT
+/**
+ * @brief Opens the compact export `<run_dir>/cims.hdcx` of the GA run on `ctx`.
+ */
+static int init_compact_cim_export(struct ga_cim_writer *writer,
+                                   const char *run_dir,
+                                   const struct ga_eval_context *ctx) {
+    char path[640];
+    int written = snprintf(path, sizeof(path), "%s/cims.hdcx", run_dir);
+    if (written < 0 || (size_t)written >= sizeof(path)) {
+        fprintf(stderr, "GA CiM export file path too long.\n");
+        return -1;
+    }
+    struct ga_cim_export_header header;
+    init_cim_export_header(&header, ctx);
+    return init_ga_cim_writer(writer, path, &header, ctx->permutations);
+}
+
+/**
+ * @brief Queues the genomes and scores of one evaluated generation for the compact export.
+ *
+ * @return 0 on success, -1 once the writer has failed.
+ */
+static int export_compact_generation(struct ga_cim_writer *writer,
+                                     int generation,
+                                     const uint16_t *genomes,
+                                     int count,
+                                     int genome_length,
+                                     const double *accuracy,
+                                     const double *similarity) {
+    for (int i = 0; i < count; i++) {
+        if (ga_cim_writer_push(writer,
+                               generation,
+                               i,
+                               &genomes[(size_t)i * genome_length],
+                               accuracy[i],
+                               similarity[i]) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+#else
 static int create_generation_export_dirs(const char *run_dir, int generation_count) {
     if (!run_dir || generation_count < 0) {
         return -1;
@@ -705,6 +875,7 @@ static int create_generation_export_dirs(const char *run_dir, int generation_cou
     }
     return 0;
 }
+#endif
 
 #if PRECOMPUTED_ITEM_MEMORY
 static void export_precomputed_cim_csv(const struct item_memory *item_mem,
@@ -736,26 +907,9 @@ static void export_precomputed_cim_csv(const struct item_memory *item_mem,
         return;
     }
 
-    fprintf(file,
-            "#ga_cim_export,mode=precomputed,generation=%d,candidate=%d,num_levels=%d,num_features=%d,num_vectors=%d,dimension=%d,accuracy=%.10f,similarity=%.10f\n",
-            generation,
-            candidate_index,
-            ctx->num_levels,
-            ctx->num_features,
-            item_mem->num_vectors,
-            VECTOR_DIMENSION,
-            accuracy,
-            similarity);
-
-    for (int i = 0; i < item_mem->num_vectors; i++) {
-        for (int bit = 0; bit < VECTOR_DIMENSION; bit++) {
-            fprintf(file, "%d", vector_get_bit(item_mem->base_vectors[i], bit));
-            if (bit < VECTOR_DIMENSION - 1) {
-                fputc(',', file);
-            }
-        }
-        fputc('\n', file);
-    }
+    struct ga_cim_export_header header;
+    init_cim_export_header(&header, ctx);
+    write_ga_cim_csv(file, item_mem, &header, generation, candidate_index, accuracy, similarity);
 
     fclose(file);
 }
@@ -789,218 +943,1670 @@ static void export_continuous_cim_csv(const struct item_memory *signal_mem,
         return;
     }
 
-    fprintf(file,
-            "#ga_cim_export,mode=continuous,generation=%d,candidate=%d,num_levels=%d,num_vectors=%d,dimension=%d,accuracy=%.10f,similarity=%.10f\n",
-            generation,
-            candidate_index,
-            ctx->num_levels,
-            signal_mem->num_vectors,
-            VECTOR_DIMENSION,
-            accuracy,
-            similarity);
-
-    for (int i = 0; i < signal_mem->num_vectors; i++) {
-        for (int bit = 0; bit < VECTOR_DIMENSION; bit++) {
-            fprintf(file, "%d", vector_get_bit(signal_mem->base_vectors[i], bit));
-            if (bit < VECTOR_DIMENSION - 1) {
-                fputc(',', file);
+    struct ga_cim_export_header header;
+    init_cim_export_header(&header, ctx);
+    write_ga_cim_csv(file, signal_mem, &header, generation, candidate_index, accuracy, similarity);
+
+    fclose(file);
+}
+#endif
+#endif
+
+/**
+ * @brief One GA candidate model (item memory, encoder, associative memory).
+ *
+ * Candidate models live in a `ga_candidate_pool` and point into its slab; they
+ * are rebuilt in place for every genome and never freed individually.
+ */
+struct ga_candidate_model {
+    int *flips;
+    struct item_memory item_mem;
+    struct encoder enc;
+    struct associative_memory assoc_mem;
+};
+
+#define GA_POOL_SLOTS (GA_BATCH_CANDIDATES + (GA_DELTA_ACTIVE ? 1 : 0))
+
+/**
+ * @brief Candidate models and scratch of one GA worker thread, reused for every batch.
+ *
+ * A pool is set up by the thread that first uses it, so its pages are
+ * first-touched on that thread's NUMA node, and it then serves every batch of
+ * the GA run without further allocation. Slots 0..GA_BATCH_CANDIDATES-1 hold
+ * the batch; with delta encoding the last slot holds the reference genome.
+ *
+ * - **storage**, **vectors**: One slab behind all item and associative memories.
+ * - **counts**: Per-slot class counts of the associative memories.
+ * - **flips**: Per-slot flip counts in the `int` layout of the item memory builders.
+ * - **ws**: Encoding workspaces of the batch slots.
+ * - **training_reference**, **eval_reference**: Reference timestamp encodings for
+ *   delta encoding, grown to the largest dataset seen (`reference_capacity`).
+ */
+struct ga_candidate_pool {
+    int ready;
+    struct ga_candidate_model models[GA_POOL_SLOTS];
+    struct hdc_workspace ws[GA_BATCH_CANDIDATES];
+    Vector **vectors;
+    vector_element *storage;
+    int *counts;
+    int *flips;
+    Vector **min_vectors; // level-0 CiM rows; fixed by ctx->permutations
+    vector_element *min_storage;
+#if GA_DELTA_ACTIVE
+    Vector **training_reference;
+    vector_element *training_reference_storage;
+    Vector **eval_reference;
+    vector_element *eval_reference_storage;
+    int reference_capacity;
+#endif
+};
+
+/**
+ * @brief Number of candidates each GA task evaluates together.
+ *
+ * Capped so that every OpenMP worker still receives at least one batch.
+ */
+static int ga_batch_size(int population_size) {
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    int per_thread = (population_size + threads - 1) / threads;
+    if (per_thread > GA_BATCH_CANDIDATES) {
+        per_thread = GA_BATCH_CANDIDATES;
+    }
+    return per_thread < 1 ? 1 : per_thread;
+}
+
+/**
+ * @brief Allocates a vector slab for a candidate pool, optionally on huge pages.
+ *
+ * Same layout as `create_vector_slab`. The slab is zeroed by the calling thread,
+ * which places its pages on that thread's NUMA node under first-touch policy.
+ */
+static Vector **create_pool_slab(int num_vectors, vector_element **storage) {
+    size_t stride = vector_slab_stride();
+    size_t bytes = (size_t)num_vectors * stride * sizeof(vector_element);
+    vector_element *slab = NULL;
+#if GA_POOL_HUGE_PAGES && defined(__linux__)
+    size_t huge_page = (size_t)2 << 20;
+    size_t huge_bytes = (bytes + huge_page - 1) & ~(huge_page - 1);
+    slab = (vector_element *)aligned_alloc(huge_page, huge_bytes);
+    if (slab) {
+        madvise(slab, huge_bytes, MADV_HUGEPAGE);
+    }
+#endif
+    if (!slab) {
+        size_t aligned_bytes = (bytes + VECTOR_ALIGNMENT - 1) & ~((size_t)VECTOR_ALIGNMENT - 1);
+        slab = (vector_element *)aligned_alloc(VECTOR_ALIGNMENT, aligned_bytes);
+    }
+    unsigned char *block = (unsigned char *)malloc((size_t)num_vectors * (sizeof(Vector *) + sizeof(Vector)));
+    if (!slab || !block) {
+        fprintf(stderr, "Failed to allocate GA candidate pool.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(slab, 0, bytes);
+
+    Vector **vectors = (Vector **)block;
+    Vector *views = (Vector *)(block + (size_t)num_vectors * sizeof(Vector *));
+    for (int i = 0; i < num_vectors; i++) {
+        views[i].data = slab + (size_t)i * stride;
+        vectors[i] = &views[i];
+    }
+    *storage = slab;
+    return vectors;
+}
+
+static int ga_item_memory_rows(const struct ga_eval_context *ctx) {
+#if PRECOMPUTED_ITEM_MEMORY
+    return ctx->num_levels * ctx->num_features;
+#else
+    return ctx->num_levels;
+#endif
+}
+
+/**
+ * @brief Sets up a pool for candidates of `ctx`'s shape on the calling thread.
+ */
+static void init_candidate_pool(struct ga_candidate_pool *pool, const struct ga_eval_context *ctx, int flip_count) {
+    int rows = ga_item_memory_rows(ctx);
+    int per_slot = rows + NUM_CLASSES;
+    pool->vectors = create_pool_slab(GA_POOL_SLOTS * per_slot, &pool->storage);
+    pool->counts = (int *)calloc((size_t)GA_POOL_SLOTS * NUM_CLASSES, sizeof(int));
+    pool->flips = (int *)malloc((size_t)GA_POOL_SLOTS * (flip_count > 0 ? flip_count : 1) * sizeof(int));
+    if (!pool->counts || !pool->flips) {
+        fprintf(stderr, "Failed to allocate GA candidate pool.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int slot = 0; slot < GA_POOL_SLOTS; slot++) {
+        struct ga_candidate_model *model = &pool->models[slot];
+        Vector **slot_vectors = &pool->vectors[(size_t)slot * per_slot];
+        model->flips = &pool->flips[(size_t)slot * flip_count];
+        model->item_mem.num_vectors = rows;
+        model->item_mem.base_vectors = slot_vectors;
+        model->item_mem.storage = NULL;
+        model->assoc_mem.num_classes = NUM_CLASSES;
+        model->assoc_mem.class_vectors = slot_vectors + rows;
+        model->assoc_mem.counts = &pool->counts[(size_t)slot * NUM_CLASSES];
+        model->assoc_mem.storage = NULL;
+        model->assoc_mem.read_only = false;
+#if PRECOMPUTED_ITEM_MEMORY
+        init_encoder(&model->enc, &model->item_mem);
+#else
+        init_encoder(&model->enc, ctx->channel_memory, &model->item_mem);
+#endif
+    }
+    for (int m = 0; m < GA_BATCH_CANDIDATES; m++) {
+        init_hdc_workspace(&pool->ws[m]);
+    }
+#if PRECOMPUTED_ITEM_MEMORY
+    int min_count = ctx->num_features;
+#else
+    int min_count = 1;
+#endif
+    pool->min_vectors = create_sign_vector_slab(min_count, &pool->min_storage);
+    generate_item_memory_min_vectors(pool->min_vectors, min_count, ctx->permutations);
+#if GA_DELTA_ACTIVE
+    pool->training_reference = NULL;
+    pool->training_reference_storage = NULL;
+    pool->eval_reference = NULL;
+    pool->eval_reference_storage = NULL;
+    pool->reference_capacity = 0;
+#endif
+    pool->ready = 1;
+}
+
+static void free_candidate_pool(struct ga_candidate_pool *pool) {
+    if (!pool->ready) {
+        return;
+    }
+    for (int m = 0; m < GA_BATCH_CANDIDATES; m++) {
+        free_hdc_workspace(&pool->ws[m]);
+    }
+#if GA_DELTA_ACTIVE
+    if (pool->reference_capacity > 0) {
+        free_vector_slab(pool->training_reference, pool->training_reference_storage);
+        free_vector_slab(pool->eval_reference, pool->eval_reference_storage);
+    }
+#endif
+    free_vector_slab(pool->vectors, pool->storage);
+    free_vector_slab(pool->min_vectors, pool->min_storage);
+    free(pool->counts);
+    free(pool->flips);
+    pool->ready = 0;
+}
+
+/**
+ * @brief Rebuilds a pooled candidate model in place for genome `B`.
+ *
+ * Produces the same item memory as `init_precomp_item_memory_with_B` /
+ * `init_continuous_item_memory_with_B` and an empty associative memory. The
+ * level-0 rows are copied from `min_vectors` instead of being regenerated.
+ */
+static void rebuild_candidate_model(struct ga_candidate_model *model,
+                                    const uint16_t *B,
+                                    const struct ga_eval_context *ctx,
+                                    Vector *const *min_vectors,
+                                    int flip_count) {
+    for (int i = 0; i < flip_count; i++) {
+        model->flips[i] = (int)B[i];
+    }
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        vector_zero(model->assoc_mem.class_vectors[c]);
+        model->assoc_mem.counts[c] = 0;
+    }
+#if BIPOLAR_MODE
+    refresh_class_norms(&model->assoc_mem);
+#endif
+#if PRECOMPUTED_ITEM_MEMORY
+    build_precomp_item_memory_with_B(&model->item_mem,
+                                     ctx->num_levels,
+                                     ctx->num_features,
+                                     model->flips,
+                                     ctx->permutations,
+                                     min_vectors);
+#else
+    build_continuous_item_memory_with_B(&model->item_mem,
+                                        ctx->num_levels,
+                                        model->flips,
+                                        ctx->permutations,
+                                        min_vectors[0]);
+#endif
+}
+
+#if GA_DELTA_ACTIVE
+/**
+ * @brief Encodes every row of a quantized dataset with the reference encoder.
+ */
+static void encode_reference_timestamps(struct encoder *enc,
+                                        const struct quantized_dataset *dataset,
+                                        Vector **timestamps) {
+    for (int sample = 0; sample < dataset->num_samples; sample++) {
+        encode_timestamp_levels(enc, quantized_dataset_row(dataset, sample), timestamps[sample]);
+    }
+}
+
+/**
+ * @brief Grows the pool's reference encodings to hold `samples` timestamps.
+ */
+static void reserve_pool_references(struct ga_candidate_pool *pool, int samples) {
+    if (samples <= pool->reference_capacity) {
+        return;
+    }
+    if (pool->reference_capacity > 0) {
+        free_vector_slab(pool->training_reference, pool->training_reference_storage);
+        free_vector_slab(pool->eval_reference, pool->eval_reference_storage);
+    }
+    pool->training_reference = create_vector_slab(samples, &pool->training_reference_storage);
+    pool->eval_reference = create_vector_slab(samples, &pool->eval_reference_storage);
+    pool->reference_capacity = samples;
+}
+#endif
+
+/**
+ * @brief Trains and evaluates up to GA_BATCH_CANDIDATES genomes in one pass over the data.
+ *
+ * All candidates share one sweep over the quantized training set and one over the
+ * evaluation set (`train_model_timeseries_quantized_multi`,
+ * `evaluate_model_timeseries_direct_quantized_multi`), so each level row is loaded
+ * once per batch rather than once per candidate.
+ *
+ * When `reference_genome` is given (typically the parent the candidates were bred
+ * from) and delta encoding is available, the reference's timestamp encodings are
+ * computed once and each candidate only recomputes the words in which its CiM
+ * rows differ from the reference (`encode_timestamp_levels_delta`).
+ *
+ * The scores are identical to evaluating every candidate on its own.
+ *
+ * @param genome_pool Genomes of `genome_length` genes, indexed by candidate.
+ * @param candidates Indices into `genome_pool` of the `count` candidates to evaluate.
+ * @param reference_genome Genome to delta-encode against, or NULL.
+ * @param pool The calling thread's candidate pool; set up on first use.
+ * @param shards Data shards the training and evaluation sweeps are split into
+ *        (see `train_model_timeseries_quantized_sharded`); 1 keeps them whole.
+ * @param out_accuracy Receives the class-average accuracy, indexed by candidate.
+ * @param out_similarity Receives the class-vector similarity, indexed by candidate.
+ */
+static void evaluate_candidates(const uint16_t *genome_pool,
+                                int genome_length,
+                                const int *candidates,
+                                int count,
+                                const uint16_t *reference_genome,
+                                const struct ga_eval_context *ctx,
+                                struct ga_candidate_pool *pool,
+                                int shards,
+                                const char *export_run_dir,
+                                int export_generation,
+                                double *out_accuracy,
+                                double *out_similarity) {
+#if !GA_CIM_EXPORT_ENABLED
+    (void)export_run_dir;
+    (void)export_generation;
+#endif
+    for (int c = 0; c < count; c++) {
+        out_accuracy[candidates[c]] = 0.0;
+        out_similarity[candidates[c]] = 0.0;
+    }
+    if (count <= 0 || count > GA_BATCH_CANDIDATES) {
+        fprintf(stderr, "Invalid GA candidate batch size %d.\n", count);
+        exit(EXIT_FAILURE);
+    }
+    if (!ctx || !ctx->training_levels || !ctx->training_labels || ctx->training_samples <= N_GRAM_SIZE) {
+        return;
+    }
+
+#if PRECOMPUTED_ITEM_MEMORY
+    if (!ctx->permutations) {
+        return;
+    }
+    int flip_count = (ctx->num_levels - 1) * ctx->num_features;
+#else
+    if (!ctx->channel_memory || !ctx->permutations) {
+        return;
+    }
+    int flip_count = ctx->num_levels - 1;
+#endif
+    HDC_PROFILE_BEGIN(HDC_STAGE_GA_EVALUATE);
+
+    const struct quantized_dataset *eval_levels = ctx->training_levels;
+    int *eval_labels = ctx->training_labels;
+    if (ctx->testing_levels && ctx->testing_labels) {
+        eval_levels = ctx->testing_levels;
+        eval_labels = ctx->testing_labels;
+    }
+
+    if (!pool->ready) {
+        init_candidate_pool(pool, ctx, flip_count);
+    }
+    struct ga_candidate_model *models = pool->models;
+    struct encoder *encs[GA_BATCH_CANDIDATES];
+    struct associative_memory *assoc_mems[GA_BATCH_CANDIDATES];
+    struct timeseries_eval_result results[GA_BATCH_CANDIDATES];
+    int model_count = count;
+
+    for (int m = 0; m < model_count; m++) {
+        const uint16_t *B = &genome_pool[(size_t)candidates[m] * (size_t)genome_length];
+        rebuild_candidate_model(&models[m], B, ctx, pool->min_vectors, flip_count);
+        encs[m] = &models[m].enc;
+        assoc_mems[m] = &models[m].assoc_mem;
+    }
+
+    const struct encoder_delta *deltas[GA_BATCH_CANDIDATES] = {0};
+    Vector **training_reference = NULL;
+    Vector **eval_reference = NULL;
+#if GA_DELTA_ACTIVE
+    struct encoder_delta delta_storage[GA_BATCH_CANDIDATES];
+    struct ga_candidate_model *reference = &models[GA_BATCH_CANDIDATES];
+    if (reference_genome != NULL) {
+        rebuild_candidate_model(reference, reference_genome, ctx, pool->min_vectors, flip_count);
+        // Patching only pays off when most CiM rows are untouched, and encoding the
+        // reference costs about one full candidate, so at least two must qualify.
+        int delta_count = 0;
+        for (int m = 0; m < model_count; m++) {
+            if (init_encoder_delta(&delta_storage[m], &reference->item_mem, &models[m].item_mem) != 0) {
+                continue;
+            }
+            if (delta_storage[m].changed_rows > GA_DELTA_MAX_CHANGED_FRACTION * delta_storage[m].num_rows) {
+                free_encoder_delta(&delta_storage[m]);
+                continue;
+            }
+            deltas[m] = &delta_storage[m];
+            delta_count++;
+        }
+        if (delta_count >= 2) {
+            int samples = ctx->training_levels->num_samples > eval_levels->num_samples
+                ? ctx->training_levels->num_samples
+                : eval_levels->num_samples;
+            reserve_pool_references(pool, samples);
+            training_reference = pool->training_reference;
+            eval_reference = pool->eval_reference;
+            encode_reference_timestamps(&reference->enc, ctx->training_levels, training_reference);
+            encode_reference_timestamps(&reference->enc, eval_levels, eval_reference);
+        } else {
+            for (int m = 0; m < model_count; m++) {
+                if (deltas[m]) {
+                    free_encoder_delta(&delta_storage[m]);
+                    deltas[m] = NULL;
+                }
+            }
+        }
+    }
+#else
+    (void)reference_genome;
+#endif
+
+    train_model_timeseries_quantized_sharded(ctx->training_levels,
+                                             ctx->training_labels,
+                                             assoc_mems,
+                                             encs,
+                                             model_count,
+                                             deltas,
+                                             training_reference,
+                                             shards);
+    evaluate_model_timeseries_direct_quantized_sharded(encs,
+                                                       assoc_mems,
+                                                       pool->ws,
+                                                       model_count,
+                                                       eval_levels,
+                                                       eval_labels,
+                                                       deltas,
+                                                       eval_reference,
+                                                       shards,
+                                                       results);
+
+#if GA_DELTA_ACTIVE
+    for (int m = 0; m < model_count; m++) {
+        if (deltas[m]) {
+            free_encoder_delta(&delta_storage[m]);
+        }
+    }
+#endif
+
+    for (int m = 0; m < model_count; m++) {
+        int c = candidates[m];
+        out_accuracy[c] = results[m].class_average_accuracy;
+        out_similarity[c] = results[m].class_vector_similarity;
+
+        #if GA_CIM_EXPORT_ENABLED
+        if (export_run_dir) {
+#if PRECOMPUTED_ITEM_MEMORY
+            export_precomputed_cim_csv(&models[m].item_mem,
+                                       ctx,
+                                       export_run_dir,
+                                       export_generation,
+                                       c,
+                                       out_accuracy[c],
+                                       out_similarity[c]);
+#else
+            export_continuous_cim_csv(&models[m].item_mem,
+                                      ctx,
+                                      export_run_dir,
+                                      export_generation,
+                                      c,
+                                      out_accuracy[c],
+                                      out_similarity[c]);
+#endif
+        }
+        #endif
+    }
+    HDC_PROFILE_END(HDC_STAGE_GA_EVALUATE, count);
+}
+
+#if GA_DELTA_ACTIVE
+/**
+ * @brief Counts the CiM rows in which two genomes produce different item memories.
+ *
+ * A level vector is the feature's level-0 vector with the first `target` bits of
+ * its permutation flipped, `target` being the clipped running sum of the flip
+ * counts. Two genomes therefore yield the same row exactly when their running
+ * sums agree at that level, so this is known without building either memory.
+ */
+static int genome_changed_rows(const uint16_t *a,
+                               const uint16_t *b,
+                               int transitions,
+                               int feature_blocks,
+                               int max_total) {
+    int changed = 0;
+    for (int block = 0; block < feature_blocks; block++) {
+        const uint16_t *ga = a + (size_t)block * transitions;
+        const uint16_t *gb = b + (size_t)block * transitions;
+        int target_a = 0;
+        int target_b = 0;
+        for (int t = 0; t < transitions; t++) {
+            target_a += ga[t];
+            target_b += gb[t];
+            if (target_a > max_total) {
+                target_a = max_total;
+            }
+            if (target_b > max_total) {
+                target_b = max_total;
+            }
+            changed += target_a != target_b;
+        }
+    }
+    return changed;
+}
+#endif
+
+/**
+ * @brief Splits candidates into evaluation batches of at most `batch_size`.
+ *
+ * With `reference` (per candidate an index below `num_references`, or -1),
+ * candidates sharing a reference are batched together and the batch keeps that
+ * reference for delta encoding; a batch with a single candidate drops it, since
+ * encoding the reference would cost as much as encoding the candidate. Candidates
+ * without a reference, or all of them when `reference` is NULL, are batched in order.
+ *
+ * @param order Receives the candidate order; batch g covers
+ *        `order[group_start[g] .. group_start[g + 1])`.
+ * @param group_start Receives the batch offsets (`count + 1` entries suffice).
+ * @param group_reference Receives each batch's reference index, or -1.
+ * @return The number of batches.
+ */
+static int group_candidates(const int *reference,
+                            int num_references,
+                            int count,
+                            int batch_size,
+                            int *order,
+                            int *group_start,
+                            int *group_reference) {
+    if (reference) {
+        // Counting sort by reference index (-1 first) keeps the order stable.
+        int *offsets = (int *)calloc((size_t)num_references + 2, sizeof(int));
+        if (!offsets) {
+            fprintf(stderr, "Failed to allocate GA grouping buffer.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < count; i++) {
+            offsets[reference[i] + 2]++;
+        }
+        for (int r = 0; r <= num_references; r++) {
+            offsets[r + 1] += offsets[r];
+        }
+        for (int i = 0; i < count; i++) {
+            order[offsets[reference[i] + 1]++] = i;
+        }
+        free(offsets);
+    } else {
+        for (int i = 0; i < count; i++) {
+            order[i] = i;
+        }
+    }
+
+    int groups = 0;
+    int pos = 0;
+    while (pos < count) {
+        int ref = reference ? reference[order[pos]] : -1;
+        int end = pos + 1;
+        while (end < count && end - pos < batch_size && (!reference || reference[order[end]] == ref)) {
+            end++;
+        }
+        group_start[groups] = pos;
+        group_reference[groups] = (end - pos >= 2) ? ref : -1;
+        groups++;
+        pos = end;
+    }
+    group_start[groups] = count;
+    return groups;
+}
+
+/**
+ * @brief Bounded LRU cache of GA fitness values keyed by genome.
+ *
+ * Elitist selection keeps identical individuals alive across generations and
+ * tournament breeding recreates them, so many genomes are evaluated more than
+ * once. Entries are keyed by a 64-bit hash of the genome and the GA seed; the
+ * stored genome is compared on lookup, so hash collisions never return a wrong
+ * score. All operations are serialized with a named OpenMP critical section.
+ *
+ * - **keys**, **genomes**, **accuracy**, **similarity**: Entry payloads.
+ * - **prev**, **next**, **head**, **tail**: LRU list, `head` most recently used.
+ * - **buckets**, **chain**: Hash index over the entries (-1 terminated).
+ * - **lookups**, **hits**: Statistics for the GA log.
+ */
+struct ga_fitness_cache {
+    int capacity;
+    int genome_length;
+    int size;
+    uint64_t *keys;
+    uint16_t *genomes;
+    double *accuracy;
+    double *similarity;
+    int *prev;
+    int *next;
+    int head;
+    int tail;
+    int *buckets;
+    int *chain;
+    int bucket_mask;
+    long lookups;
+    long hits;
+};
+
+static uint64_t ga_genome_hash(const uint16_t *genome, int genome_length, unsigned int seed) {
+    uint64_t hash = 1469598103934665603ull ^ (uint64_t)seed;
+    const unsigned char *bytes = (const unsigned char *)genome;
+    size_t count = (size_t)genome_length * sizeof(uint16_t);
+    for (size_t i = 0; i < count; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Allocates a fitness cache for `capacity` genomes.
+ *
+ * @return 0 on success, -1 if `capacity` is not positive or allocation fails.
+ */
+static int init_ga_fitness_cache(struct ga_fitness_cache *cache, int capacity, int genome_length) {
+    memset(cache, 0, sizeof(*cache));
+    cache->head = -1;
+    cache->tail = -1;
+    if (capacity <= 0 || genome_length <= 0) {
+        return -1;
+    }
+
+    int bucket_count = 1;
+    while (bucket_count < 2 * capacity) {
+        bucket_count <<= 1;
+    }
+    cache->capacity = capacity;
+    cache->genome_length = genome_length;
+    cache->bucket_mask = bucket_count - 1;
+    cache->keys = (uint64_t *)malloc((size_t)capacity * sizeof(uint64_t));
+    cache->genomes = (uint16_t *)malloc((size_t)capacity * genome_length * sizeof(uint16_t));
+    cache->accuracy = (double *)malloc((size_t)capacity * sizeof(double));
+    cache->similarity = (double *)malloc((size_t)capacity * sizeof(double));
+    cache->prev = (int *)malloc((size_t)capacity * sizeof(int));
+    cache->next = (int *)malloc((size_t)capacity * sizeof(int));
+    cache->chain = (int *)malloc((size_t)capacity * sizeof(int));
+    cache->buckets = (int *)malloc((size_t)bucket_count * sizeof(int));
+    if (!cache->keys || !cache->genomes || !cache->accuracy || !cache->similarity ||
+        !cache->prev || !cache->next || !cache->chain || !cache->buckets) {
+        free(cache->keys);
+        free(cache->genomes);
+        free(cache->accuracy);
+        free(cache->similarity);
+        free(cache->prev);
+        free(cache->next);
+        free(cache->chain);
+        free(cache->buckets);
+        memset(cache, 0, sizeof(*cache));
+        return -1;
+    }
+    for (int b = 0; b < bucket_count; b++) {
+        cache->buckets[b] = -1;
+    }
+    return 0;
+}
+
+static void free_ga_fitness_cache(struct ga_fitness_cache *cache) {
+    free(cache->keys);
+    free(cache->genomes);
+    free(cache->accuracy);
+    free(cache->similarity);
+    free(cache->prev);
+    free(cache->next);
+    free(cache->chain);
+    free(cache->buckets);
+    memset(cache, 0, sizeof(*cache));
+}
+
+static void ga_fitness_cache_unlink(struct ga_fitness_cache *cache, int entry) {
+    if (cache->prev[entry] >= 0) {
+        cache->next[cache->prev[entry]] = cache->next[entry];
+    } else {
+        cache->head = cache->next[entry];
+    }
+    if (cache->next[entry] >= 0) {
+        cache->prev[cache->next[entry]] = cache->prev[entry];
+    } else {
+        cache->tail = cache->prev[entry];
+    }
+}
+
+static void ga_fitness_cache_push_front(struct ga_fitness_cache *cache, int entry) {
+    cache->prev[entry] = -1;
+    cache->next[entry] = cache->head;
+    if (cache->head >= 0) {
+        cache->prev[cache->head] = entry;
+    }
+    cache->head = entry;
+    if (cache->tail < 0) {
+        cache->tail = entry;
+    }
+}
+
+static int ga_fitness_cache_find(const struct ga_fitness_cache *cache, uint64_t key, const uint16_t *genome) {
+    size_t genome_bytes = (size_t)cache->genome_length * sizeof(uint16_t);
+    for (int entry = cache->buckets[key & (uint64_t)cache->bucket_mask]; entry >= 0; entry = cache->chain[entry]) {
+        if (cache->keys[entry] == key &&
+            memcmp(&cache->genomes[(size_t)entry * cache->genome_length], genome, genome_bytes) == 0) {
+            return entry;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Looks up a genome and marks it as most recently used.
+ *
+ * @return 1 and fills `accuracy`/`similarity` on a hit, 0 on a miss.
+ */
+static int ga_fitness_cache_lookup(struct ga_fitness_cache *cache,
+                                   uint64_t key,
+                                   const uint16_t *genome,
+                                   double *accuracy,
+                                   double *similarity) {
+    int hit = 0;
+#ifdef _OPENMP
+#pragma omp critical(ga_fitness_cache)
+#endif
+    {
+        cache->lookups++;
+        int entry = ga_fitness_cache_find(cache, key, genome);
+        if (entry >= 0) {
+            cache->hits++;
+            *accuracy = cache->accuracy[entry];
+            *similarity = cache->similarity[entry];
+            ga_fitness_cache_unlink(cache, entry);
+            ga_fitness_cache_push_front(cache, entry);
+            hit = 1;
+        }
+    }
+    return hit;
+}
+
+/**
+ * @brief Stores the scores of a genome, evicting the least recently used entry when full.
+ */
+static void ga_fitness_cache_insert(struct ga_fitness_cache *cache,
+                                    uint64_t key,
+                                    const uint16_t *genome,
+                                    double accuracy,
+                                    double similarity) {
+#ifdef _OPENMP
+#pragma omp critical(ga_fitness_cache)
+#endif
+    {
+        int entry = ga_fitness_cache_find(cache, key, genome);
+        if (entry >= 0) {
+            ga_fitness_cache_unlink(cache, entry);
+        } else {
+            if (cache->size < cache->capacity) {
+                entry = cache->size++;
+            } else {
+                entry = cache->tail;
+                ga_fitness_cache_unlink(cache, entry);
+                int *link = &cache->buckets[cache->keys[entry] & (uint64_t)cache->bucket_mask];
+                while (*link != entry) {
+                    link = &cache->chain[*link];
+                }
+                *link = cache->chain[entry];
+            }
+            int bucket = (int)(key & (uint64_t)cache->bucket_mask);
+            cache->keys[entry] = key;
+            memcpy(&cache->genomes[(size_t)entry * cache->genome_length],
+                   genome,
+                   (size_t)cache->genome_length * sizeof(uint16_t));
+            cache->chain[entry] = cache->buckets[bucket];
+            cache->buckets[bucket] = entry;
+        }
+        cache->accuracy[entry] = accuracy;
+        cache->similarity[entry] = similarity;
+        ga_fitness_cache_push_front(cache, entry);
+    }
+}
+
+/**
+ * @brief Resolves a generation's candidates from the fitness cache.
+ *
+ * Cached genomes get their scores directly. Genomes repeated within the
+ * generation are evaluated once: `duplicate_of[i]` names the first candidate
+ * with the same genome, or -1, and counts as a cache hit. The candidates that
+ * still need evaluating are written to `pending`. Called outside parallel regions.
+ *
+ * @return The number of pending candidates.
+ */
+static int ga_resolve_cached(struct ga_fitness_cache *cache,
+                             const uint16_t *genomes,
+                             int count,
+                             unsigned int seed,
+                             uint64_t *keys,
+                             int *duplicate_of,
+                             int *pending,
+                             double *accuracy,
+                             double *similarity) {
+    int pending_count = 0;
+    int genome_length = cache->genome_length;
+    size_t genome_bytes = (size_t)genome_length * sizeof(uint16_t);
+    for (int i = 0; i < count; i++) {
+        const uint16_t *genome = &genomes[(size_t)i * genome_length];
+        keys[i] = ga_genome_hash(genome, genome_length, seed);
+        duplicate_of[i] = -1;
+        if (ga_fitness_cache_lookup(cache, keys[i], genome, &accuracy[i], &similarity[i])) {
+            continue;
+        }
+        for (int p = 0; p < pending_count; p++) {
+            int j = pending[p];
+            if (keys[j] == keys[i] && memcmp(&genomes[(size_t)j * genome_length], genome, genome_bytes) == 0) {
+                duplicate_of[i] = j;
+                cache->hits++;
+                break;
+            }
+        }
+        if (duplicate_of[i] < 0) {
+            pending[pending_count++] = i;
+        }
+    }
+    return pending_count;
+}
+
+/**
+ * @brief Stores freshly evaluated candidates and copies scores to in-generation duplicates.
+ */
+static void ga_store_evaluated(struct ga_fitness_cache *cache,
+                               const uint16_t *genomes,
+                               int count,
+                               const uint64_t *keys,
+                               const int *duplicate_of,
+                               const int *pending,
+                               int pending_count,
+                               double *accuracy,
+                               double *similarity) {
+    for (int p = 0; p < pending_count; p++) {
+        int i = pending[p];
+        ga_fitness_cache_insert(cache,
+                                keys[i],
+                                &genomes[(size_t)i * cache->genome_length],
+                                accuracy[i],
+                                similarity[i]);
+    }
+    for (int i = 0; i < count; i++) {
+        if (duplicate_of[i] >= 0) {
+            accuracy[i] = accuracy[duplicate_of[i]];
+            similarity[i] = similarity[duplicate_of[i]];
+        }
+    }
+}
+
+/**
+ * @brief Buffers reused by every `evaluate_generation` call of a GA run.
+ *
+ * Besides the index buffers it holds one candidate pool per worker thread.
+ */
+struct ga_eval_scratch {
+    struct ga_candidate_pool *pools;
+    int num_pools;
+    uint64_t *keys;
+    int *duplicate_of;
+    int *pending;
+    int *pending_reference;
+    int *order;
+    int *group_start;
+    int *group_reference;
+};
+
+static int init_ga_eval_scratch(struct ga_eval_scratch *scratch, int population_size) {
+    size_t count = (size_t)population_size;
+    scratch->num_pools = 1;
+#ifdef _OPENMP
+    scratch->num_pools = omp_get_max_threads();
+#endif
+    // Pools are only zeroed here; each worker sets up its own on first use.
+    scratch->pools = (struct ga_candidate_pool *)calloc((size_t)scratch->num_pools, sizeof(struct ga_candidate_pool));
+    scratch->keys = (uint64_t *)malloc(count * sizeof(uint64_t));
+    scratch->duplicate_of = (int *)malloc(count * sizeof(int));
+    scratch->pending = (int *)malloc(count * sizeof(int));
+    scratch->pending_reference = (int *)malloc(count * sizeof(int));
+    scratch->order = (int *)malloc(count * sizeof(int));
+    scratch->group_start = (int *)malloc((count + 1) * sizeof(int));
+    scratch->group_reference = (int *)malloc(count * sizeof(int));
+    if (!scratch->pools || !scratch->keys || !scratch->duplicate_of || !scratch->pending || !scratch->pending_reference ||
+        !scratch->order || !scratch->group_start || !scratch->group_reference) {
+        return -1;
+    }
+    return 0;
+}
+
+static void free_ga_eval_scratch(struct ga_eval_scratch *scratch) {
+    for (int p = 0; scratch->pools && p < scratch->num_pools; p++) {
+        free_candidate_pool(&scratch->pools[p]);
+    }
+    free(scratch->pools);
+    free(scratch->keys);
+    free(scratch->duplicate_of);
+    free(scratch->pending);
+    free(scratch->pending_reference);
+    free(scratch->order);
+    free(scratch->group_start);
+    free(scratch->group_reference);
+}
+
+/**
+ * @brief Reduced-data contexts for racing GA offspring (successive halving).
+ *
+ * Rung r trains and validates on a stratified share of the GA's training and
+ * validation sets; the shares grow geometrically from `racing_min_fraction`
+ * towards the full sets, which form the implicit last rung.
+ */
+struct ga_race {
+    int rungs;
+    double keep_fraction;
+    int selection_mode;
+    struct ga_eval_context *rung_ctx;
+    struct quantized_dataset *training_levels;
+    struct quantized_dataset *testing_levels;
+    int **training_labels;
+    int **testing_labels;
+};
+
+/**
+ * @brief Copies a stratified share of a quantized timeseries.
+ *
+ * Every run of equal labels (one gesture segment) contributes its first
+ * `fraction` of samples, but at least 2 * N_GRAM_SIZE where the run allows,
+ * so each class keeps its share and the subset still forms valid n-grams.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int init_ga_race_subset(const struct quantized_dataset *full,
+                               const int *labels,
+                               double fraction,
+                               struct quantized_dataset *subset,
+                               int **subset_labels) {
+    int features = full->num_features;
+    subset->levels = (quantized_level *)malloc((size_t)full->num_samples * features * sizeof(quantized_level));
+    *subset_labels = (int *)malloc((size_t)full->num_samples * sizeof(int));
+    subset->num_features = features;
+    subset->num_samples = 0;
+    if (!subset->levels || !*subset_labels) {
+        free(subset->levels);
+        free(*subset_labels);
+        subset->levels = NULL;
+        *subset_labels = NULL;
+        return -1;
+    }
+
+    int start = 0;
+    while (start < full->num_samples) {
+        int end = start + 1;
+        while (end < full->num_samples && labels[end] == labels[start]) {
+            end++;
+        }
+        int length = end - start;
+        int take = (int)ceil(fraction * (double)length);
+        if (take < 2 * N_GRAM_SIZE) {
+            take = 2 * N_GRAM_SIZE;
+        }
+        if (take > length) {
+            take = length;
+        }
+        memcpy(subset->levels + (size_t)subset->num_samples * features,
+               quantized_dataset_row(full, start),
+               (size_t)take * features * sizeof(quantized_level));
+        for (int i = 0; i < take; i++) {
+            (*subset_labels)[subset->num_samples + i] = labels[start];
+        }
+        subset->num_samples += take;
+        start = end;
+    }
+    return 0;
+}
+
+static void free_ga_race(struct ga_race *race) {
+    for (int r = 0; r < race->rungs; r++) {
+        free_quantized_dataset(&race->training_levels[r]);
+        free_quantized_dataset(&race->testing_levels[r]);
+        free(race->training_labels[r]);
+        free(race->testing_labels[r]);
+    }
+    free(race->rung_ctx);
+    free(race->training_levels);
+    free(race->testing_levels);
+    free(race->training_labels);
+    free(race->testing_labels);
+    memset(race, 0, sizeof(*race));
+}
+
+/**
+ * @brief Builds the racing rungs for a GA run.
+ *
+ * @return 0 on success (including `params->racing_rungs == 0`, which leaves
+ *         `race->rungs` at 0), -1 on allocation failure.
+ */
+static int init_ga_race(struct ga_race *race,
+                        const struct ga_eval_context *ctx,
+                        const struct ga_params *params,
+                        int selection_mode) {
+    memset(race, 0, sizeof(*race));
+    int rungs = params->racing_rungs;
+    double min_fraction = params->racing_min_fraction;
+    if (rungs <= 0 || min_fraction <= 0.0 || min_fraction >= 1.0 || !ctx->training_levels) {
+        return 0;
+    }
+
+    race->keep_fraction = params->racing_keep_fraction;
+    if (race->keep_fraction <= 0.0 || race->keep_fraction > 1.0) {
+        race->keep_fraction = 0.5;
+    }
+    race->selection_mode = selection_mode;
+    race->rung_ctx = (struct ga_eval_context *)calloc((size_t)rungs, sizeof(struct ga_eval_context));
+    race->training_levels = (struct quantized_dataset *)calloc((size_t)rungs, sizeof(struct quantized_dataset));
+    race->testing_levels = (struct quantized_dataset *)calloc((size_t)rungs, sizeof(struct quantized_dataset));
+    race->training_labels = (int **)calloc((size_t)rungs, sizeof(int *));
+    race->testing_labels = (int **)calloc((size_t)rungs, sizeof(int *));
+    if (!race->rung_ctx || !race->training_levels || !race->testing_levels ||
+        !race->training_labels || !race->testing_labels) {
+        free_ga_race(race);
+        return -1;
+    }
+    race->rungs = rungs;
+
+    for (int r = 0; r < rungs; r++) {
+        // Geometric schedule: min_fraction, ..., min_fraction^(1/rungs); the full set follows.
+        double fraction = pow(min_fraction, (double)(rungs - r) / (double)rungs);
+        struct ga_eval_context *rung = &race->rung_ctx[r];
+        *rung = *ctx;
+        if (init_ga_race_subset(ctx->training_levels,
+                                ctx->training_labels,
+                                fraction,
+                                &race->training_levels[r],
+                                &race->training_labels[r]) != 0) {
+            free_ga_race(race);
+            return -1;
+        }
+        rung->training_levels = &race->training_levels[r];
+        rung->training_labels = race->training_labels[r];
+        rung->training_samples = race->training_levels[r].num_samples;
+        if (ctx->testing_levels && ctx->testing_labels) {
+            if (init_ga_race_subset(ctx->testing_levels,
+                                    ctx->testing_labels,
+                                    fraction,
+                                    &race->testing_levels[r],
+                                    &race->testing_labels[r]) != 0) {
+                free_ga_race(race);
+                return -1;
+            }
+            rung->testing_levels = &race->testing_levels[r];
+            rung->testing_labels = race->testing_labels[r];
+            rung->testing_samples = race->testing_levels[r].num_samples;
+        }
+    }
+    return 0;
+}
+
+#if HDC_OFFLOAD
+/**
+ * @brief Copies the data of a GA evaluation context to the offload device.
+ *
+ * @return The offload context, or NULL to keep the CPU evaluation (continuous
+ *         item memories, unsupported model modes, or no device memory).
+ */
+static struct offload_context *create_ga_offload(const struct ga_eval_context *ctx) {
+#if PRECOMPUTED_ITEM_MEMORY
+    if (!ctx->training_levels || !ctx->training_labels || !ctx->permutations) {
+        return NULL;
+    }
+    const struct quantized_dataset *eval_levels = ctx->training_levels;
+    const int *eval_labels = ctx->training_labels;
+    if (ctx->testing_levels && ctx->testing_labels) {
+        eval_levels = ctx->testing_levels;
+        eval_labels = ctx->testing_labels;
+    }
+    return offload_create(ctx->training_levels, ctx->training_labels, eval_levels, eval_labels,
+                          ctx->permutations, ctx->num_levels, ctx->num_features);
+#else
+    (void)ctx;
+    return NULL;
+#endif
+}
+#endif
+
+/**
+ * @brief Orders candidates best first under the GA selection mode.
+ *
+ * Pareto mode ranks by non-dominated front, then by crowding distance; the
+ * scalar modes rank by `compute_scalar_fitness`. Ties keep the input order.
+ *
+ * @param list Candidate indices into `accuracy`/`similarity`, reordered in place.
+ * @return 0 on success, -1 on allocation failure (`list` unchanged).
+ */
+static int rank_race_candidates(int *list,
+                                int count,
+                                int selection_mode,
+                                const double *accuracy,
+                                const double *similarity) {
+    double *acc = (double *)malloc((size_t)count * sizeof(double));
+    double *sim = (double *)malloc((size_t)count * sizeof(double));
+    double *key = (double *)malloc((size_t)count * sizeof(double));
+    int *local = (int *)malloc((size_t)count * sizeof(int));
+    int *ranked = (int *)malloc((size_t)count * sizeof(int));
+    if (!acc || !sim || !key || !local || !ranked) {
+        free(acc);
+        free(sim);
+        free(key);
+        free(local);
+        free(ranked);
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        acc[i] = accuracy[list[i]];
+        sim[i] = similarity[list[i]];
+        local[i] = i;
+    }
+
+    int status = 0;
+    if (selection_mode == GA_SELECTION_PARETO) {
+        int *rank = (int *)malloc((size_t)count * sizeof(int));
+        int *fronts = (int *)malloc((size_t)count * sizeof(int));
+        int *front_offsets = (int *)malloc((size_t)(count + 1) * sizeof(int));
+        int num_fronts = 0;
+        if (rank && fronts && front_offsets) {
+            non_dominated_sort(acc, sim, count, rank, fronts, front_offsets, &num_fronts);
+        }
+        if (num_fronts > 0) {
+            int pos = 0;
+            for (int f = 0; f < num_fronts; f++) {
+                int start = front_offsets[f];
+                int end = front_offsets[f + 1];
+                compute_crowding(acc, sim, fronts, start, end, key);
+                sort_indices_by_value_desc(&fronts[start], end - start, key);
+                for (int i = start; i < end; i++) {
+                    ranked[pos++] = fronts[i];
+                }
+            }
+        } else {
+            status = -1;
+        }
+        free(rank);
+        free(fronts);
+        free(front_offsets);
+    } else {
+        for (int i = 0; i < count; i++) {
+            key[i] = compute_scalar_fitness(selection_mode, acc[i], sim[i]);
+        }
+        sort_indices_by_value_desc(local, count, key);
+        memcpy(ranked, local, (size_t)count * sizeof(int));
+    }
+
+    if (status == 0) {
+        for (int i = 0; i < count; i++) {
+            local[i] = list[ranked[i]];
+        }
+        memcpy(list, local, (size_t)count * sizeof(int));
+    }
+    free(acc);
+    free(sim);
+    free(key);
+    free(local);
+    free(ranked);
+    return status;
+}
+
+/**
+ * @brief Proxy scores that pre-screen GA offspring before the full evaluation.
+ *
+ * Each genome is described by GA_SURROGATE_FEATURES statistics of its flip
+ * schedule, i.e. of the level-to-level Hamming profile of its CiM rows
+ * (`ga_surrogate_features`). Two ridge regressions on those statistics predict
+ * the accuracy and the similarity. They are fitted to the real fitnesses of the
+ * last GA_SURROGATE_HISTORY fully scored genomes and refitted every
+ * `refit_every` generations. Only the best `keep_fraction` of the uncached
+ * offspring under the predicted scores are trained and evaluated.
+ */
+struct ga_surrogate {
+    double keep_fraction;
+    int refit_every;
+    int selection_mode;
+    int num_features;
+    int num_levels;
+    int ready;
+    int generations_since_fit;
+    int history_count;
+    int history_next;
+    double *history_x;   // [GA_SURROGATE_HISTORY][GA_SURROGATE_FEATURES]
+    double *history_acc;
+    double *history_sim;
+    double acc_weights[GA_SURROGATE_FEATURES];
+    double sim_weights[GA_SURROGATE_FEATURES];
+    double *predicted_acc; // [population_size]
+    double *predicted_sim;
+    long screened;
+    long screened_out;
+};
+
+/**
+ * @brief Flip-schedule statistics of a genome: the surrogate's regressors.
+ *
+ * Level `l` of a feature differs from level 0 in its flip target (clipped at
+ * GA_MAX_FLIPS_CIM as in `build_precomp_item_memory_with_B`), so the targets
+ * give the Hamming distance between any two levels without building the CiM.
+ * Per feature: span = target of the top level / VECTOR_DIMENSION, steps =
+ * distances of adjacent levels. The statistics are a bias, the mean span and
+ * mean squared span, the spread of the spans over the features, the mean
+ * coefficient of variation of the steps, the share of empty steps (levels with
+ * identical rows) and the mean share of the span taken by the largest step.
+ */
+static void ga_surrogate_features(const uint16_t *genome, int num_features, int num_levels, double *x) {
+    int steps = num_levels - 1;
+    double span_sum = 0.0;
+    double span_sq_sum = 0.0;
+    double cv_sum = 0.0;
+    double largest_sum = 0.0;
+    int empty_steps = 0;
+    for (int feature = 0; feature < num_features; feature++) {
+        const uint16_t *flips = genome + (size_t)feature * steps;
+        int target = 0;
+        double step_sum = 0.0;
+        double step_sq_sum = 0.0;
+        int largest = 0;
+        for (int level = 0; level < steps; level++) {
+            int next = target + flips[level];
+            if (next > GA_MAX_FLIPS_CIM) {
+                next = GA_MAX_FLIPS_CIM;
+            }
+            int step = next - target;
+            target = next;
+            step_sum += step;
+            step_sq_sum += (double)step * step;
+            if (step == 0) {
+                empty_steps++;
+            }
+            if (step > largest) {
+                largest = step;
             }
         }
-        fputc('\n', file);
+        double span = (double)target / VECTOR_DIMENSION;
+        span_sum += span;
+        span_sq_sum += span * span;
+        if (target > 0) {
+            double mean = step_sum / steps;
+            double variance = step_sq_sum / steps - mean * mean;
+            cv_sum += sqrt(variance > 0.0 ? variance : 0.0) / mean;
+            largest_sum += (double)largest / target;
+        }
     }
+    double mean_span = span_sum / num_features;
+    double span_variance = span_sq_sum / num_features - mean_span * mean_span;
+    x[0] = 1.0;
+    x[1] = mean_span;
+    x[2] = span_sq_sum / num_features;
+    x[3] = sqrt(span_variance > 0.0 ? span_variance : 0.0);
+    x[4] = cv_sum / num_features;
+    x[5] = (double)empty_steps / ((double)num_features * steps);
+    x[6] = largest_sum / num_features;
+}
 
-    fclose(file);
+static void free_ga_surrogate(struct ga_surrogate *surrogate) {
+    free(surrogate->history_x);
+    free(surrogate->history_acc);
+    free(surrogate->history_sim);
+    free(surrogate->predicted_acc);
+    free(surrogate->predicted_sim);
+    memset(surrogate, 0, sizeof(*surrogate));
 }
-#endif
-#endif
 
-static double evaluate_candidate(const uint16_t *B,
-                                 const struct ga_eval_context *ctx,
-                                 const char *export_run_dir,
-                                 int export_generation,
-                                 int export_candidate_index,
-                                 double *out_accuracy,
-                                 double *out_similarity) {
-#if !GA_CIM_EXPORT_ENABLED
-    (void)export_run_dir;
-    (void)export_generation;
-    (void)export_candidate_index;
-#endif
-    if (!ctx || !ctx->training_data || !ctx->training_labels || ctx->training_samples <= N_GRAM_SIZE) {
-        if (out_accuracy) {
-            *out_accuracy = 0.0;
-        }
-        if (out_similarity) {
-            *out_similarity = 0.0;
+/**
+ * @brief Sets up the surrogate stage of a GA run.
+ *
+ * @return 1 if the stage is enabled (`params->surrogate_keep_fraction` in (0, 1)),
+ *         0 if disabled, -1 on allocation failure.
+ */
+static int init_ga_surrogate(struct ga_surrogate *surrogate,
+                             const struct ga_params *params,
+                             int selection_mode,
+                             int num_features,
+                             int num_levels,
+                             int population_size) {
+    memset(surrogate, 0, sizeof(*surrogate));
+    if (params->surrogate_keep_fraction <= 0.0 || params->surrogate_keep_fraction >= 1.0 || num_levels < 2) {
+        return 0;
+    }
+    surrogate->keep_fraction = params->surrogate_keep_fraction;
+    surrogate->refit_every = params->surrogate_refit_every > 0 ? params->surrogate_refit_every : 1;
+    surrogate->selection_mode = selection_mode;
+    surrogate->num_features = num_features;
+    surrogate->num_levels = num_levels;
+    surrogate->history_x = (double *)malloc((size_t)GA_SURROGATE_HISTORY * GA_SURROGATE_FEATURES * sizeof(double));
+    surrogate->history_acc = (double *)malloc((size_t)GA_SURROGATE_HISTORY * sizeof(double));
+    surrogate->history_sim = (double *)malloc((size_t)GA_SURROGATE_HISTORY * sizeof(double));
+    surrogate->predicted_acc = (double *)malloc((size_t)population_size * sizeof(double));
+    surrogate->predicted_sim = (double *)malloc((size_t)population_size * sizeof(double));
+    if (!surrogate->history_x || !surrogate->history_acc || !surrogate->history_sim ||
+        !surrogate->predicted_acc || !surrogate->predicted_sim) {
+        free_ga_surrogate(surrogate);
+        return -1;
+    }
+    return 1;
+}
+
+/**
+ * @brief Adds the real fitness of fully scored genomes to the surrogate's history.
+ */
+static void ga_surrogate_observe(struct ga_surrogate *surrogate,
+                                 const uint16_t *genomes,
+                                 int genome_length,
+                                 const int *list,
+                                 int count,
+                                 const double *accuracy,
+                                 const double *similarity) {
+    for (int i = 0; i < count; i++) {
+        int c = list[i];
+        int slot = surrogate->history_next;
+        ga_surrogate_features(&genomes[(size_t)c * genome_length],
+                              surrogate->num_features,
+                              surrogate->num_levels,
+                              &surrogate->history_x[(size_t)slot * GA_SURROGATE_FEATURES]);
+        surrogate->history_acc[slot] = accuracy[c];
+        surrogate->history_sim[slot] = similarity[c];
+        surrogate->history_next = (slot + 1) % GA_SURROGATE_HISTORY;
+        if (surrogate->history_count < GA_SURROGATE_HISTORY) {
+            surrogate->history_count++;
         }
-        return 0.0;
     }
+}
 
-#if PRECOMPUTED_ITEM_MEMORY
-    int transitions = ctx->num_levels - 1;
-    int genes = transitions * ctx->num_features;
-    int *b_matrix = NULL;
-    if (genes > 0) {
-        b_matrix = (int *)malloc((size_t)genes * sizeof(int));
-        if (!b_matrix) {
-            fprintf(stderr, "Failed to allocate flip matrix.\n");
-            if (out_accuracy) {
-                *out_accuracy = 0.0;
+/**
+ * @brief Solves the ridge normal equations (X'X + lambda I) w = X'y by Gaussian elimination.
+ *
+ * @return 0 on success, -1 if the system is singular.
+ */
+static int ga_surrogate_solve(const double *x, const double *y, int rows, double *weights) {
+    enum { K = GA_SURROGATE_FEATURES };
+    double a[K][K + 1];
+    memset(a, 0, sizeof(a));
+    for (int r = 0; r < rows; r++) {
+        const double *row = x + (size_t)r * K;
+        for (int i = 0; i < K; i++) {
+            for (int j = 0; j < K; j++) {
+                a[i][j] += row[i] * row[j];
             }
-            if (out_similarity) {
-                *out_similarity = 0.0;
+            a[i][K] += row[i] * y[r];
+        }
+    }
+    for (int i = 1; i < K; i++) {
+        a[i][i] += GA_SURROGATE_RIDGE * rows; // the bias stays unpenalized
+    }
+    for (int col = 0; col < K; col++) {
+        int pivot = col;
+        for (int r = col + 1; r < K; r++) {
+            if (fabs(a[r][col]) > fabs(a[pivot][col])) {
+                pivot = r;
             }
-            return 0.0;
         }
-        for (int i = 0; i < genes; i++) {
-            b_matrix[i] = (int)B[i];
+        if (fabs(a[pivot][col]) < 1e-12) {
+            return -1;
         }
-    }
-
-    if (!ctx->permutations) {
-        free(b_matrix);
-        if (out_accuracy) {
-            *out_accuracy = 0.0;
+        if (pivot != col) {
+            for (int j = 0; j <= K; j++) {
+                double t = a[col][j];
+                a[col][j] = a[pivot][j];
+                a[pivot][j] = t;
+            }
         }
-        if (out_similarity) {
-            *out_similarity = 0.0;
+        for (int r = 0; r < K; r++) {
+            if (r == col) {
+                continue;
+            }
+            double factor = a[r][col] / a[col][col];
+            for (int j = col; j <= K; j++) {
+                a[r][j] -= factor * a[col][j];
+            }
         }
-        return 0.0;
     }
-
-    struct associative_memory assoc_mem;
-    init_assoc_mem(&assoc_mem);
-    struct item_memory item_mem;
-    init_precomp_item_memory_with_B(&item_mem,
-                                    ctx->num_levels,
-                                    ctx->num_features,
-                                    b_matrix,
-                                    ctx->permutations);
-    struct encoder enc;
-    init_encoder(&enc, &item_mem);
-    train_model_timeseries(ctx->training_data,
-                           ctx->training_labels,
-                           ctx->training_samples,
-                           &assoc_mem,
-                           &enc);
-
-    double **eval_data = ctx->training_data;
-    int *eval_labels = ctx->training_labels;
-    int eval_samples = ctx->training_samples;
-    if (ctx->testing_data && ctx->testing_labels && ctx->testing_samples > 0) {
-        eval_data = ctx->testing_data;
-        eval_labels = ctx->testing_labels;
-        eval_samples = ctx->testing_samples;
+    for (int i = 0; i < K; i++) {
+        weights[i] = a[i][K] / a[i][i];
     }
+    return 0;
+}
 
-    struct timeseries_eval_result eval_result =
-        evaluate_model_timeseries_direct(&enc, &assoc_mem, eval_data, eval_labels, eval_samples);
-    if (out_accuracy) {
-        *out_accuracy = eval_result.class_average_accuracy;
+/**
+ * @brief Refits the surrogate when it is due; leaves it unready while the history is too short.
+ */
+static void ga_surrogate_refit(struct ga_surrogate *surrogate) {
+    surrogate->generations_since_fit++;
+    if (surrogate->ready && surrogate->generations_since_fit < surrogate->refit_every) {
+        return;
     }
-    if (out_similarity) {
-        *out_similarity = eval_result.class_vector_similarity;
+    if (surrogate->history_count < GA_SURROGATE_MIN_HISTORY) {
+        return;
     }
-    double fitness = eval_result.class_average_accuracy - eval_result.class_vector_similarity;
-
-    #if GA_CIM_EXPORT_ENABLED
-    if (export_run_dir) {
-        export_precomputed_cim_csv(&item_mem,
-                                   ctx,
-                                   export_run_dir,
-                                   export_generation,
-                                   export_candidate_index,
-                                   eval_result.class_average_accuracy,
-                                   eval_result.class_vector_similarity);
+    if (ga_surrogate_solve(surrogate->history_x, surrogate->history_acc, surrogate->history_count,
+                           surrogate->acc_weights) == 0 &&
+        ga_surrogate_solve(surrogate->history_x, surrogate->history_sim, surrogate->history_count,
+                           surrogate->sim_weights) == 0) {
+        surrogate->ready = 1;
+        surrogate->generations_since_fit = 0;
     }
-    #endif
+}
 
-    free_item_memory(&item_mem);
-    free_assoc_mem(&assoc_mem);
-    free(b_matrix);
-    return fitness;
-#else
-    int transitions = ctx->num_levels - 1;
-    int *b_levels = NULL;
-    if (transitions > 0) {
-        b_levels = (int *)malloc((size_t)transitions * sizeof(int));
-        if (!b_levels) {
-            fprintf(stderr, "Failed to allocate flip vector.\n");
-            if (out_accuracy) {
-                *out_accuracy = 0.0;
-            }
-            if (out_similarity) {
-                *out_similarity = 0.0;
-            }
-            return 0.0;
-        }
-        for (int level = 0; level < transitions; level++) {
-            b_levels[level] = (int)B[level];
+/**
+ * @brief Keeps the candidates of `list` with the best predicted scores.
+ *
+ * `list` is reordered best first under the GA selection mode; the dropped
+ * candidates get the worst possible score, as candidates dropped by racing do.
+ *
+ * @return The number of candidates kept at the front of `list`.
+ */
+static int ga_surrogate_screen(struct ga_surrogate *surrogate,
+                               const uint16_t *genomes,
+                               int genome_length,
+                               int *list,
+                               int count,
+                               double *accuracy,
+                               double *similarity) {
+    int keep = (int)ceil(surrogate->keep_fraction * (double)count);
+    if (!surrogate->ready || keep >= count) {
+        return count;
+    }
+    if (keep < 1) {
+        keep = 1;
+    }
+    for (int i = 0; i < count; i++) {
+        int c = list[i];
+        double x[GA_SURROGATE_FEATURES];
+        ga_surrogate_features(&genomes[(size_t)c * genome_length], surrogate->num_features, surrogate->num_levels, x);
+        double acc = 0.0;
+        double sim = 0.0;
+        for (int k = 0; k < GA_SURROGATE_FEATURES; k++) {
+            acc += surrogate->acc_weights[k] * x[k];
+            sim += surrogate->sim_weights[k] * x[k];
         }
+        surrogate->predicted_acc[c] = acc;
+        surrogate->predicted_sim[c] = sim;
+    }
+    if (rank_race_candidates(list, count, surrogate->selection_mode,
+                             surrogate->predicted_acc, surrogate->predicted_sim) != 0) {
+        return count;
     }
+    for (int p = keep; p < count; p++) {
+        accuracy[list[p]] = 0.0;
+        similarity[list[p]] = 1.0;
+    }
+    surrogate->screened += count;
+    surrogate->screened_out += count - keep;
+    return keep;
+}
 
-    if (!ctx->channel_memory || !ctx->permutations) {
-        free(b_levels);
-        if (out_accuracy) {
-            *out_accuracy = 0.0;
-        }
-        if (out_similarity) {
-            *out_similarity = 0.0;
+/**
+ * @brief Number of data shards for candidate batch `group` of `group_count` on `threads` threads.
+ *
+ * Batches are handed out one per thread, so the last `group_count % threads`
+ * batches (all of them when there are fewer batches than threads) run while the
+ * remaining threads have nothing left to pick up. Those batches are split into
+ * data shards that the idle threads execute as OpenMP tasks; every other batch
+ * stays whole.
+ */
+static int ga_group_shards(int group, int group_count, int threads) {
+#if GA_NESTED_PARALLELISM
+    if (threads <= 1 || group_count <= 0) {
+        return 1;
+    }
+    int tail = group_count % threads;
+    if (tail == 0 || group < group_count - tail) {
+        return 1;
+    }
+    return threads / tail;
+#else
+    (void)group;
+    (void)group_count;
+    (void)threads;
+    return 1;
+#endif
+}
+
+/**
+ * @brief Evaluates the candidates in `list` in parallel batches on `ctx`.
+ *
+ * When the batches leave threads idle, the trailing batches are additionally
+ * split into data shards (`ga_group_shards`), so small populations still use
+ * every core.
+ *
+ * @param references Optional per-genome index into `reference_pool` for delta
+ *        encoding (-1 for none), or NULL.
+ * @param reference_pool Genomes the references index into (the parent population).
+ * @param num_references Number of genomes in `reference_pool`.
+ */
+static void evaluate_candidate_list(const uint16_t *genomes,
+                                    int genome_length,
+                                    const int *list,
+                                    int list_count,
+                                    const int *references,
+                                    const uint16_t *reference_pool,
+                                    int num_references,
+                                    const struct ga_eval_context *ctx,
+                                    struct ga_eval_scratch *scratch,
+                                    int batch_size,
+                                    const char *export_run_dir,
+                                    int export_generation,
+                                    double *accuracy,
+                                    double *similarity) {
+#if HDC_OFFLOAD
+    // Exports need the CiMs on the host, so they stay on the CPU path.
+    if (ctx->offload && !export_run_dir &&
+        offload_evaluate_population(ctx->offload, genomes, genome_length, list, list_count, accuracy, similarity) == 0) {
+        return;
+    }
+#endif
+    if (references) {
+        for (int p = 0; p < list_count; p++) {
+            scratch->pending_reference[p] = references[list[p]];
         }
-        return 0.0;
     }
-    struct associative_memory assoc_mem;
-    init_assoc_mem(&assoc_mem);
-    struct encoder enc;
-    struct item_memory signal_mem;
-    init_continuous_item_memory_with_B(&signal_mem,
-                                       ctx->num_levels,
-                                       b_levels,
-                                       ctx->permutations);
-    init_encoder(&enc, ctx->channel_memory, &signal_mem);
-    train_model_timeseries(ctx->training_data,
-                           ctx->training_labels,
-                           ctx->training_samples,
-                           &assoc_mem,
-                           &enc);
-
-    double **eval_data = ctx->training_data;
-    int *eval_labels = ctx->training_labels;
-    int eval_samples = ctx->training_samples;
-    if (ctx->testing_data && ctx->testing_labels && ctx->testing_samples > 0) {
-        eval_data = ctx->testing_data;
-        eval_labels = ctx->testing_labels;
-        eval_samples = ctx->testing_samples;
+
+    int group_count = group_candidates(references ? scratch->pending_reference : NULL,
+                                       num_references,
+                                       list_count,
+                                       batch_size,
+                                       scratch->order,
+                                       scratch->group_start,
+                                       scratch->group_reference);
+    for (int k = 0; k < list_count; k++) {
+        scratch->order[k] = list[scratch->order[k]];
     }
 
-    struct timeseries_eval_result eval_result =
-        evaluate_model_timeseries_direct(&enc, &assoc_mem, eval_data, eval_labels, eval_samples);
-    double accuracy = eval_result.class_average_accuracy;
-    double similarity = eval_result.class_vector_similarity;
-    if (out_accuracy) {
-        *out_accuracy = accuracy;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int g = 0; g < group_count; g++) {
+        const uint16_t *reference_genome = scratch->group_reference[g] >= 0
+            ? &reference_pool[(size_t)scratch->group_reference[g] * genome_length]
+            : NULL;
+        int thread = 0;
+        int threads = 1;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+        threads = omp_get_num_threads();
+#endif
+        evaluate_candidates(genomes,
+                            genome_length,
+                            &scratch->order[scratch->group_start[g]],
+                            scratch->group_start[g + 1] - scratch->group_start[g],
+                            reference_genome,
+                            ctx,
+                            &scratch->pools[thread],
+                            ga_group_shards(g, group_count, threads),
+                            export_run_dir,
+                            export_generation,
+                            accuracy,
+                            similarity);
     }
-    if (out_similarity) {
-        *out_similarity = similarity;
+}
+
+/**
+ * @brief Scores `count` genomes, reusing cached scores and evaluating the rest in parallel batches.
+ *
+ * With racing enabled the uncached candidates first run through the subset
+ * rungs of `race`: after each rung only the best `keep_fraction` (under the GA
+ * selection mode) are promoted, and only the final survivors are scored on the
+ * full data. Dropped candidates receive the worst possible score (accuracy 0,
+ * similarity 1), so selection never prefers them over a fully scored genome.
+ *
+ * @param genomes The genomes to score.
+ * @param references Optional per-genome index into `reference_pool` for delta
+ *        encoding (-1 for none), or NULL.
+ * @param reference_pool Genomes the references index into (the parent population).
+ * @param num_references Number of genomes in `reference_pool`.
+ * @param cache Fitness cache, or NULL to evaluate everything.
+ * @param surrogate Surrogate stage, or NULL. Once fitted it screens the
+ *        uncached candidates before racing; it learns from every fully scored one.
+ * @param race Racing rungs, or NULL to score everything on the full data.
+ *
+ * @note Cache and racing are bypassed while exporting, since every candidate's
+ *       CiM has to be rebuilt and fully scored for the export.
+ */
+static void evaluate_generation(const uint16_t *genomes,
+                                int count,
+                                int genome_length,
+                                const int *references,
+                                const uint16_t *reference_pool,
+                                int num_references,
+                                const struct ga_eval_context *ctx,
+                                struct ga_fitness_cache *cache,
+                                struct ga_surrogate *surrogate,
+                                const struct ga_race *race,
+                                struct ga_eval_scratch *scratch,
+                                int batch_size,
+                                const char *export_run_dir,
+                                int export_generation,
+                                double *accuracy,
+                                double *similarity) {
+    int use_cache = cache != NULL && export_run_dir == NULL;
+    int pending_count = count;
+    if (use_cache) {
+        pending_count = ga_resolve_cached(cache,
+                                          genomes,
+                                          count,
+                                          ctx->seed,
+                                          scratch->keys,
+                                          scratch->duplicate_of,
+                                          scratch->pending,
+                                          accuracy,
+                                          similarity);
+    } else {
+        for (int i = 0; i < count; i++) {
+            scratch->pending[i] = i;
+        }
     }
 
-    #if GA_CIM_EXPORT_ENABLED
-    if (export_run_dir) {
-        export_continuous_cim_csv(&signal_mem,
-                                  ctx,
-                                  export_run_dir,
-                                  export_generation,
-                                  export_candidate_index,
-                                  accuracy,
-                                  similarity);
+    int survivor_count = pending_count;
+    if (surrogate && export_run_dir == NULL) {
+        ga_surrogate_refit(surrogate);
+        survivor_count = ga_surrogate_screen(surrogate,
+                                             genomes,
+                                             genome_length,
+                                             scratch->pending,
+                                             survivor_count,
+                                             accuracy,
+                                             similarity);
+    }
+    if (race && export_run_dir == NULL) {
+        for (int r = 0; r < race->rungs && survivor_count > 1; r++) {
+            int keep = (int)ceil(race->keep_fraction * (double)survivor_count);
+            if (keep < 1) {
+                keep = 1;
+            }
+            if (keep >= survivor_count) {
+                break;
+            }
+            evaluate_candidate_list(genomes,
+                                    genome_length,
+                                    scratch->pending,
+                                    survivor_count,
+                                    references,
+                                    reference_pool,
+                                    num_references,
+                                    &race->rung_ctx[r],
+                                    scratch,
+                                    batch_size,
+                                    NULL,
+                                    0,
+                                    accuracy,
+                                    similarity);
+            if (rank_race_candidates(scratch->pending, survivor_count, race->selection_mode, accuracy, similarity) != 0) {
+                break;
+            }
+            for (int p = keep; p < survivor_count; p++) {
+                accuracy[scratch->pending[p]] = 0.0;
+                similarity[scratch->pending[p]] = 1.0;
+            }
+            survivor_count = keep;
+        }
     }
-    #endif
 
-    free(b_levels);
-    free_assoc_mem(&assoc_mem);
-    free_item_memory(&signal_mem);
-    return accuracy - similarity;
-#endif
+    evaluate_candidate_list(genomes,
+                            genome_length,
+                            scratch->pending,
+                            survivor_count,
+                            references,
+                            reference_pool,
+                            num_references,
+                            ctx,
+                            scratch,
+                            batch_size,
+                            export_run_dir,
+                            export_generation,
+                            accuracy,
+                            similarity);
+    if (surrogate) {
+        ga_surrogate_observe(surrogate, genomes, genome_length, scratch->pending, survivor_count, accuracy, similarity);
+    }
+
+    if (use_cache) {
+        // Only fully scored survivors are memoized; dropped candidates may be retried.
+        ga_store_evaluated(cache,
+                           genomes,
+                           count,
+                           scratch->keys,
+                           scratch->duplicate_of,
+                           scratch->pending,
+                           survivor_count,
+                           accuracy,
+                           similarity);
+    }
 }
 
 static void mutate_individual_naive(uint16_t *individual,
@@ -1358,9 +2964,351 @@ static void recombine_individual_custom(const uint16_t *parent_a,
     free(events_a);
 }
 
+/**
+ * @brief Sends this island's best genomes around the ring and takes in the neighbour's.
+ *
+ * The best individuals under the selection mode emigrate and the immigrants
+ * replace the worst ones. Immigrant scores are taken from the sender: every
+ * island evaluates on the same data, permutations and evaluation seed, so they
+ * are exact here as well, and they are seeded into the fitness cache.
+ *
+ * @param order Scratch of `population_size` indices.
+ * @return The number of immigrants, or -1 if the exchange failed.
+ */
+static int exchange_island_migrants(struct ga_island_link *island,
+                                    int generation,
+                                    uint16_t *population,
+                                    double *accuracy,
+                                    double *similarity,
+                                    int population_size,
+                                    int genome_length,
+                                    int selection_mode,
+                                    struct ga_fitness_cache *cache,
+                                    unsigned int seed,
+                                    int *order) {
+    int migrants = island->migrants < population_size / 2 ? island->migrants : population_size / 2;
+    for (int i = 0; i < population_size; i++) {
+        order[i] = i;
+    }
+    if (rank_race_candidates(order, population_size, selection_mode, accuracy, similarity) != 0) {
+        fprintf(stderr, "Failed to allocate GA migration buffers.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int received = ga_island_migrate(island, generation, population, order, migrants, accuracy, similarity);
+    for (int j = 0; j < received; j++) {
+        int target = order[population_size - 1 - j];
+        uint16_t *genome = &population[(size_t)target * genome_length];
+        memcpy(genome, &island->genomes[(size_t)j * genome_length], (size_t)genome_length * sizeof(uint16_t));
+        accuracy[target] = island->accuracy[j];
+        similarity[target] = island->similarity[j];
+        if (cache) {
+            ga_fitness_cache_insert(cache,
+                                    ga_genome_hash(genome, genome_length, seed),
+                                    genome,
+                                    accuracy[target],
+                                    similarity[target]);
+        }
+    }
+    return received;
+}
+
+/**
+ * @brief Live GA state captured by a checkpoint.
+ *
+ * The array members point at run_ga's own buffers, so saving reads them in
+ * place and loading restores them in place. The fitness cache is not saved:
+ * it only avoids re-evaluations and never changes the result.
+ *
+ * - **next_generation**: Generation the resumed run starts with.
+ * - **ga_state**: RNG state at the start of `next_generation`.
+ * - **best_***: Winner tracking for the final log.
+ * - **chunk_schedule**, **mutation_schedule**: Adaptive schedules of the custom pipeline, or NULL.
+ */
+struct ga_checkpoint {
+    int population_size;
+    int genome_length;
+    int generations;
+    int next_generation;
+    uint32_t ga_state;
+    double best_acc;
+    double best_sim;
+    double best_score;
+    int best_gen;
+    int best_gen_index;
+    uint16_t *population;
+    double *accuracy;
+    double *similarity;
+    double *fitness;
+    int *rank;
+    double *crowding;
+    double *chunk_schedule;
+    int *mutation_schedule;
+};
+
+#define GA_CHECKPOINT_MAGIC "HDCK"
+#define GA_CHECKPOINT_VERSION 1u
+
+static uint64_t fnv1a_update(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Fingerprints everything a checkpoint depends on, so a resumed run
+ *        never continues from the state of a different setup or dataset.
+ */
+static uint64_t ga_checkpoint_fingerprint(const struct ga_eval_context *ctx,
+                                          const struct ga_params *params,
+                                          int genome_length,
+                                          int selection_mode,
+                                          int pipeline_mode,
+                                          int island_id) {
+    int settings[] = {
+        ctx->num_features, ctx->num_levels, ctx->vector_dimension, genome_length,
+        params->population_size, params->generations, params->tournament_size,
+        params->racing_rungs, selection_mode, pipeline_mode, island_id,
+        GA_MAX_FLIPS_CIM, N_GRAM_SIZE, NUM_CLASSES, BIPOLAR_MODE, MODEL_VARIANT,
+        ctx->training_samples, ctx->testing_samples
+    };
+    double rates[] = {
+        params->crossover_rate, params->mutation_rate,
+        params->racing_min_fraction, params->racing_keep_fraction
+    };
+    uint64_t hash = 1469598103934665603ull;
+    hash = fnv1a_update(hash, settings, sizeof(settings));
+    hash = fnv1a_update(hash, rates, sizeof(rates));
+    hash = fnv1a_update(hash, &ctx->seed, sizeof(ctx->seed));
+    hash = fnv1a_update(hash, ctx->permutations, (size_t)ctx->num_features * VECTOR_DIMENSION * sizeof(int));
+    hash = fnv1a_update(hash, ctx->training_labels, (size_t)ctx->training_samples * sizeof(int));
+    if (ctx->training_levels) {
+        hash = fnv1a_update(hash,
+                            ctx->training_levels->levels,
+                            (size_t)ctx->training_levels->num_samples * ctx->training_levels->num_features *
+                                sizeof(quantized_level));
+    }
+    if (ctx->testing_levels) {
+        hash = fnv1a_update(hash, ctx->testing_labels, (size_t)ctx->testing_samples * sizeof(int));
+        hash = fnv1a_update(hash,
+                            ctx->testing_levels->levels,
+                            (size_t)ctx->testing_levels->num_samples * ctx->testing_levels->num_features *
+                                sizeof(quantized_level));
+    }
+    return hash;
+}
+
+static int checkpoint_write(FILE *file, const void *data, size_t size, uint64_t *hash) {
+    *hash = fnv1a_update(*hash, data, size);
+    return fwrite(data, 1, size, file) == size ? 0 : -1;
+}
+
+static int checkpoint_read(FILE *file, void *data, size_t size, uint64_t *hash) {
+    if (fread(data, 1, size, file) != size) {
+        return -1;
+    }
+    *hash = fnv1a_update(*hash, data, size);
+    return 0;
+}
+
+/**
+ * @brief Writes `ckpt` to `path` atomically (temporary file plus rename).
+ *
+ * The file is native-endian: checkpoints resume on the machine type that wrote them.
+ *
+ * @return 0 on success, -1 on I/O failure (the previous checkpoint stays intact).
+ */
+static int save_ga_checkpoint(const char *path, uint64_t fingerprint, const struct ga_checkpoint *ckpt) {
+    char tmp_path[600];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE *file = fopen(tmp_path, "wb");
+    if (!file) {
+        return -1;
+    }
+
+    uint32_t version = GA_CHECKPOINT_VERSION;
+    uint32_t schedules = (ckpt->chunk_schedule ? 1u : 0u) | (ckpt->mutation_schedule ? 2u : 0u);
+    size_t population = (size_t)ckpt->population_size;
+    uint64_t hash = 1469598103934665603ull;
+    int status = 0;
+    status |= checkpoint_write(file, GA_CHECKPOINT_MAGIC, 4, &hash);
+    status |= checkpoint_write(file, &version, sizeof(version), &hash);
+    status |= checkpoint_write(file, &fingerprint, sizeof(fingerprint), &hash);
+    status |= checkpoint_write(file, &ckpt->population_size, sizeof(int), &hash);
+    status |= checkpoint_write(file, &ckpt->genome_length, sizeof(int), &hash);
+    status |= checkpoint_write(file, &ckpt->generations, sizeof(int), &hash);
+    status |= checkpoint_write(file, &ckpt->next_generation, sizeof(int), &hash);
+    status |= checkpoint_write(file, &ckpt->ga_state, sizeof(uint32_t), &hash);
+    status |= checkpoint_write(file, &schedules, sizeof(schedules), &hash);
+    status |= checkpoint_write(file, &ckpt->best_acc, sizeof(double), &hash);
+    status |= checkpoint_write(file, &ckpt->best_sim, sizeof(double), &hash);
+    status |= checkpoint_write(file, &ckpt->best_score, sizeof(double), &hash);
+    status |= checkpoint_write(file, &ckpt->best_gen, sizeof(int), &hash);
+    status |= checkpoint_write(file, &ckpt->best_gen_index, sizeof(int), &hash);
+    status |= checkpoint_write(file, ckpt->population, population * ckpt->genome_length * sizeof(uint16_t), &hash);
+    status |= checkpoint_write(file, ckpt->accuracy, population * sizeof(double), &hash);
+    status |= checkpoint_write(file, ckpt->similarity, population * sizeof(double), &hash);
+    status |= checkpoint_write(file, ckpt->fitness, population * sizeof(double), &hash);
+    status |= checkpoint_write(file, ckpt->rank, population * sizeof(int), &hash);
+    status |= checkpoint_write(file, ckpt->crowding, population * sizeof(double), &hash);
+    if (ckpt->chunk_schedule) {
+        status |= checkpoint_write(file, ckpt->chunk_schedule, (size_t)ckpt->generations * sizeof(double), &hash);
+    }
+    if (ckpt->mutation_schedule) {
+        status |= checkpoint_write(file, ckpt->mutation_schedule, (size_t)ckpt->generations * sizeof(int), &hash);
+    }
+    uint64_t checksum = hash;
+    status |= checkpoint_write(file, &checksum, sizeof(checksum), &hash);
+
+    if (fclose(file) != 0 || status != 0) {
+        remove(tmp_path);
+        return -1;
+    }
+#ifdef _WIN32
+    remove(path);
+#endif
+    if (rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Restores `ckpt` from `path` if it was written for the same setup.
+ *
+ * Sizes in `ckpt` must be preset; the arrays are only overwritten once the
+ * whole file has been validated.
+ *
+ * @return 1 if the state was restored, 0 if there is no usable checkpoint.
+ */
+static int load_ga_checkpoint(const char *path, uint64_t fingerprint, struct ga_checkpoint *ckpt) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+
+    struct ga_checkpoint loaded = *ckpt;
+    size_t population = (size_t)ckpt->population_size;
+    size_t genome_bytes = population * ckpt->genome_length * sizeof(uint16_t);
+    size_t score_bytes = population * sizeof(double);
+    size_t rank_bytes = population * sizeof(int);
+    size_t chunk_bytes = ckpt->chunk_schedule ? (size_t)ckpt->generations * sizeof(double) : 0;
+    size_t mutation_bytes = ckpt->mutation_schedule ? (size_t)ckpt->generations * sizeof(int) : 0;
+    unsigned char *arrays = (unsigned char *)malloc(genome_bytes + 4 * score_bytes + rank_bytes + chunk_bytes +
+                                                    mutation_bytes + 1);
+    if (!arrays) {
+        fclose(file);
+        return 0;
+    }
+    loaded.population = (uint16_t *)arrays;
+    loaded.accuracy = (double *)(arrays + genome_bytes);
+    loaded.similarity = loaded.accuracy + population;
+    loaded.fitness = loaded.similarity + population;
+    loaded.crowding = loaded.fitness + population;
+    loaded.rank = (int *)(loaded.crowding + population);
+    loaded.chunk_schedule = ckpt->chunk_schedule ? (double *)(loaded.rank + population) : NULL;
+    loaded.mutation_schedule = ckpt->mutation_schedule
+        ? (int *)((unsigned char *)(loaded.rank + population) + chunk_bytes)
+        : NULL;
+
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t stored_fingerprint = 0;
+    uint32_t schedules = 0;
+    uint32_t expected_schedules = (ckpt->chunk_schedule ? 1u : 0u) | (ckpt->mutation_schedule ? 2u : 0u);
+    uint64_t hash = 1469598103934665603ull;
+    int status = 0;
+    status |= checkpoint_read(file, magic, sizeof(magic), &hash);
+    status |= checkpoint_read(file, &version, sizeof(version), &hash);
+    status |= checkpoint_read(file, &stored_fingerprint, sizeof(stored_fingerprint), &hash);
+    status |= checkpoint_read(file, &loaded.population_size, sizeof(int), &hash);
+    status |= checkpoint_read(file, &loaded.genome_length, sizeof(int), &hash);
+    status |= checkpoint_read(file, &loaded.generations, sizeof(int), &hash);
+    if (status != 0 || memcmp(magic, GA_CHECKPOINT_MAGIC, 4) != 0 || version != GA_CHECKPOINT_VERSION ||
+        stored_fingerprint != fingerprint || loaded.population_size != ckpt->population_size ||
+        loaded.genome_length != ckpt->genome_length || loaded.generations != ckpt->generations) {
+        free(arrays);
+        fclose(file);
+        return 0;
+    }
+    status |= checkpoint_read(file, &loaded.next_generation, sizeof(int), &hash);
+    status |= checkpoint_read(file, &loaded.ga_state, sizeof(uint32_t), &hash);
+    status |= checkpoint_read(file, &schedules, sizeof(schedules), &hash);
+    status |= checkpoint_read(file, &loaded.best_acc, sizeof(double), &hash);
+    status |= checkpoint_read(file, &loaded.best_sim, sizeof(double), &hash);
+    status |= checkpoint_read(file, &loaded.best_score, sizeof(double), &hash);
+    status |= checkpoint_read(file, &loaded.best_gen, sizeof(int), &hash);
+    status |= checkpoint_read(file, &loaded.best_gen_index, sizeof(int), &hash);
+    status |= checkpoint_read(file, loaded.population, genome_bytes, &hash);
+    status |= checkpoint_read(file, loaded.accuracy, score_bytes, &hash);
+    status |= checkpoint_read(file, loaded.similarity, score_bytes, &hash);
+    status |= checkpoint_read(file, loaded.fitness, score_bytes, &hash);
+    status |= checkpoint_read(file, loaded.rank, rank_bytes, &hash);
+    status |= checkpoint_read(file, loaded.crowding, score_bytes, &hash);
+    if (status == 0 && schedules == expected_schedules) {
+        if (loaded.chunk_schedule) {
+            status |= checkpoint_read(file, loaded.chunk_schedule, chunk_bytes, &hash);
+        }
+        if (loaded.mutation_schedule) {
+            status |= checkpoint_read(file, loaded.mutation_schedule, mutation_bytes, &hash);
+        }
+    } else {
+        status = -1;
+    }
+    uint64_t expected_checksum = hash;
+    uint64_t checksum = 0;
+    if (status == 0) {
+        status |= checkpoint_read(file, &checksum, sizeof(checksum), &hash);
+    }
+    fclose(file);
+    if (status != 0 || checksum != expected_checksum || loaded.next_generation < 1 ||
+        loaded.next_generation > loaded.generations) {
+        free(arrays);
+        return 0;
+    }
+
+    memcpy(ckpt->population, loaded.population, genome_bytes);
+    memcpy(ckpt->accuracy, loaded.accuracy, score_bytes);
+    memcpy(ckpt->similarity, loaded.similarity, score_bytes);
+    memcpy(ckpt->fitness, loaded.fitness, score_bytes);
+    memcpy(ckpt->rank, loaded.rank, rank_bytes);
+    memcpy(ckpt->crowding, loaded.crowding, score_bytes);
+    if (ckpt->chunk_schedule) {
+        memcpy(ckpt->chunk_schedule, loaded.chunk_schedule, chunk_bytes);
+    }
+    if (ckpt->mutation_schedule) {
+        memcpy(ckpt->mutation_schedule, loaded.mutation_schedule, mutation_bytes);
+    }
+    ckpt->next_generation = loaded.next_generation;
+    ckpt->ga_state = loaded.ga_state;
+    ckpt->best_acc = loaded.best_acc;
+    ckpt->best_sim = loaded.best_sim;
+    ckpt->best_score = loaded.best_score;
+    ckpt->best_gen = loaded.best_gen;
+    ckpt->best_gen_index = loaded.best_gen_index;
+    free(arrays);
+    return 1;
+}
+
+/**
+ * @brief Runs the GA on `ctx_in` and writes the winning genome to `B_out`.
+ *
+ * @param warm_in Population to seed the first generation with, or NULL for a
+ *        random one. Its genomes fill the population in order (the rest is
+ *        random) and are scored like random ones; with
+ *        `params->warm_start_generations` > 0 the run is shortened to that many
+ *        generations. Ignored when its genome length differs.
+ * @param warm_out Receives a copy of the final population, or NULL.
+ */
 static void run_ga(const struct ga_eval_context *ctx_in,
                    struct ga_params *params,
-                   uint16_t *B_out) {
+                   const struct ga_warm_start *warm_in,
+                   uint16_t *B_out,
+                   struct ga_warm_start *warm_out) {
     if (!ctx_in || !params || !B_out) {
         return;
     }
@@ -1402,6 +3350,14 @@ static void run_ga(const struct ga_eval_context *ctx_in,
     if (params->mutation_rate < 0.0 || params->mutation_rate > 1.0) {
         params->mutation_rate = 0.02;
     }
+    int warm_count = 0;
+    if (warm_in && warm_in->population && warm_in->genome_length == genome_length) {
+        warm_count = warm_in->population_size < params->population_size ? warm_in->population_size
+                                                                        : params->population_size;
+        if (warm_count > 0 && params->warm_start_generations > 0) {
+            params->generations = params->warm_start_generations;
+        }
+    }
 
     if (params->seed == 0) {
         params->seed = (unsigned int)time(NULL);
@@ -1411,7 +3367,18 @@ static void run_ga(const struct ga_eval_context *ctx_in,
     }
     ctx.seed = params->seed;
 
-    uint32_t ga_state = params->seed ^ 0xA3C59AC3u;
+    struct ga_island_link island;
+    if (init_ga_island_link(&island,
+                            params->island_count,
+                            params->island_id,
+                            params->migration_interval,
+                            params->migrants,
+                            genome_length) != 0) {
+        fprintf(stderr, "Failed to set up the GA island model.\n");
+        exit(EXIT_FAILURE);
+    }
+    // Islands explore with their own RNG stream; ctx.seed stays shared so scores agree.
+    uint32_t ga_state = (params->seed + (unsigned int)island.island_id * 0x9E3779B9u) ^ 0xA3C59AC3u;
     if (ga_state == 0u) {
         ga_state = 1u;
     }
@@ -1435,9 +3402,13 @@ static void run_ga(const struct ga_eval_context *ctx_in,
     double *crowdR = (double *)malloc((size_t)(population_size * 2) * sizeof(double));
     int *fronts = (int *)malloc((size_t)(population_size * 2) * sizeof(int));
     int *front_offsets = (int *)malloc((size_t)(population_size * 2 + 1) * sizeof(int));
+    int *offspring_parent = (int *)malloc((size_t)population_size * sizeof(int));
+    struct ga_eval_scratch eval_scratch;
+    int scratch_status = init_ga_eval_scratch(&eval_scratch, population_size);
 
     if (!population || !offspring || !combined || !accP || !simP || !fitP || !rankP || !crowdP ||
-        !accQ || !simQ || !fitQ || !accR || !simR || !fitR || !rankR || !crowdR || !fronts || !front_offsets) {
+        !accQ || !simQ || !fitQ || !accR || !simR || !fitR || !rankR || !crowdR || !fronts || !front_offsets ||
+        !offspring_parent || scratch_status != 0) {
         fprintf(stderr, "Failed to allocate GA buffers.\n");
         exit(EXIT_FAILURE);
     }
@@ -1462,6 +3433,21 @@ static void run_ga(const struct ga_eval_context *ctx_in,
     const char *active_export_run_dir = NULL;
 #if GA_CIM_EXPORT_ENABLED
     char export_run_dir[512];
+#if GA_CIM_EXPORT_FORMAT == GA_CIM_EXPORT_COMPACT
+    // The compact export is fed from here after every generation, so the workers
+    // never export and cache and racing stay active.
+    struct ga_cim_writer cim_writer;
+    int cim_writer_open = 0;
+    if (init_cim_export_run_dir(ctx.export_label, export_run_dir, sizeof(export_run_dir)) == 0 &&
+        init_compact_cim_export(&cim_writer, export_run_dir, &ctx) == 0) {
+        cim_writer_open = 1;
+        if (ga_output_mode >= OUTPUT_BASIC) {
+            printf("GA CiM export root: %s\n", export_run_dir);
+        }
+    } else {
+        fprintf(stderr, "Warning: GA CiM export disabled for this GA run.\n");
+    }
+#else
     if (init_cim_export_run_dir(ctx.export_label, export_run_dir, sizeof(export_run_dir)) == 0 &&
         create_generation_export_dirs(export_run_dir, params->generations) == 0) {
         active_export_run_dir = export_run_dir;
@@ -1471,35 +3457,108 @@ static void run_ga(const struct ga_eval_context *ctx_in,
     } else {
         fprintf(stderr, "Warning: GA CiM export disabled for this GA run.\n");
     }
+#endif
 #endif
 
-    for (int i = 0; i < population_size; i++) {
-        uint16_t *individual = &population[i * genome_length];
+    double best_acc = -1.0;
+    double best_sim = 0.0;
+    double best_score = -1e9;
+    int best_gen = -1;
+    int best_gen_index = -1;
+
+    // Runs are numbered in call order, so a restarted program finds the checkpoints of each of its GA runs.
+    int ga_run = g_ga_run_counter++;
+    char checkpoint_path[512] = "";
+    uint64_t checkpoint_fingerprint = 0;
+    struct ga_checkpoint checkpoint = {0};
+    checkpoint.population_size = population_size;
+    checkpoint.genome_length = genome_length;
+    checkpoint.generations = params->generations;
+    checkpoint.population = population;
+    checkpoint.accuracy = accP;
+    checkpoint.similarity = simP;
+    checkpoint.fitness = fitP;
+    checkpoint.rank = rankP;
+    checkpoint.crowding = crowdP;
+    checkpoint.chunk_schedule = adaptive_chunk_schedule;
+    checkpoint.mutation_schedule = adaptive_mutation_step_schedule;
+    if (params->checkpoint_every > 0) {
+        if (create_directory_if_missing(GA_CHECKPOINT_DIR) == 0) {
+            snprintf(checkpoint_path,
+                     sizeof(checkpoint_path),
+                     "%s/%s_run%d_island%d.ckpt",
+                     GA_CHECKPOINT_DIR,
+                     ctx.export_label ? ctx.export_label : "ga",
+                     ga_run,
+                     island.island_id);
+            checkpoint_fingerprint = ga_checkpoint_fingerprint(&ctx,
+                                                               params,
+                                                               genome_length,
+                                                               selection_mode,
+                                                               pipeline_mode,
+                                                               island.island_id);
+        } else {
+            fprintf(stderr, "Warning: cannot create %s, GA checkpoints disabled.\n", GA_CHECKPOINT_DIR);
+        }
+    }
+
+    int start_generation = 0;
+    if (checkpoint_path[0] != '\0' && params->resume &&
+        load_ga_checkpoint(checkpoint_path, checkpoint_fingerprint, &checkpoint)) {
+        start_generation = checkpoint.next_generation;
+        ga_state = checkpoint.ga_state;
+        best_acc = checkpoint.best_acc;
+        best_sim = checkpoint.best_sim;
+        best_score = checkpoint.best_score;
+        best_gen = checkpoint.best_gen;
+        best_gen_index = checkpoint.best_gen_index;
+        if (ga_output_mode >= OUTPUT_BASIC) {
+            printf("GA resumed from %s after generation %d/%d\n",
+                   checkpoint_path,
+                   start_generation,
+                   params->generations);
+        }
+    }
+
+    if (start_generation == 0) {
+        if (warm_count > 0) {
+            memcpy(population, warm_in->population, (size_t)warm_count * genome_length * sizeof(uint16_t));
+            if (ga_output_mode >= OUTPUT_BASIC) {
+                printf("GA warm start: %d of %d genomes from the previous run, %d generations\n",
+                       warm_count,
+                       population_size,
+                       params->generations);
+            }
+        }
+        for (int i = warm_count; i < population_size; i++) {
+            uint16_t *individual = &population[i * genome_length];
 #if PRECOMPUTED_ITEM_MEMORY
-        for (int feature = 0; feature < ctx.num_features; feature++) {
-            init_individual(individual + feature * transitions,
+            for (int feature = 0; feature < ctx.num_features; feature++) {
+                init_individual(individual + feature * transitions,
+                                transitions,
+                                max_total,
+                                &ga_state,
+                                ctx.permutations + (size_t)feature * VECTOR_DIMENSION,
+                                VECTOR_DIMENSION);
+            }
+#else
+            init_individual(individual,
                             transitions,
                             max_total,
                             &ga_state,
-                            ctx.permutations + (size_t)feature * VECTOR_DIMENSION,
+                            ctx.permutations,
                             VECTOR_DIMENSION);
-        }
-#else
-        init_individual(individual,
-                        transitions,
-                        max_total,
-                        &ga_state,
-                        ctx.permutations,
-                        VECTOR_DIMENSION);
 #endif
+        }
     }
 
-    double best_acc = -1.0;
-    double best_sim = 0.0;
-    double best_score = -1e9;
-    int best_gen = -1;
-    int best_gen_index = -1;
-
+    if (island.island_count > 1 && ga_output_mode >= OUTPUT_BASIC) {
+        printf("GA island %d of %d, migrating %d genomes every %d generations\n",
+               island.island_id,
+               island.island_count,
+               island.migrants,
+               island.interval);
+    }
     if (ga_output_mode >= OUTPUT_DETAILED) {
 #ifdef _OPENMP
         printf("GA evaluating with %d threads\n", omp_get_max_threads());
@@ -1508,22 +3567,78 @@ static void run_ga(const struct ga_eval_context *ctx_in,
 #endif
     }
 
+    int batch_size = ga_batch_size(population_size);
+    struct ga_fitness_cache fitness_cache;
+    struct ga_fitness_cache *cache = NULL;
+    if (init_ga_fitness_cache(&fitness_cache, GA_FITNESS_CACHE_SIZE, genome_length) == 0) {
+        cache = &fitness_cache;
+    }
+    struct ga_race race;
+    if (init_ga_race(&race, &ctx, params, selection_mode) != 0) {
+        fprintf(stderr, "Failed to allocate GA racing subsets.\n");
+        exit(EXIT_FAILURE);
+    }
+#if HDC_OFFLOAD
+    // Every rung trains on a subset of its own, so each gets its own device copy.
+    ctx.offload = create_ga_offload(&ctx);
+    for (int r = 0; r < race.rungs; r++) {
+        race.rung_ctx[r].offload = create_ga_offload(&race.rung_ctx[r]);
+    }
+    if (ctx.offload && ga_output_mode >= OUTPUT_DETAILED) {
+        printf("GA fitness evaluated %s\n",
+               omp_get_num_devices() > 0 ? "on the offload device" : "by the offload kernels on the host");
+    }
+#endif
+    struct ga_surrogate surrogate_storage;
+    struct ga_surrogate *surrogate = NULL;
+    int surrogate_status = init_ga_surrogate(&surrogate_storage,
+                                             params,
+                                             selection_mode,
+                                             genome_length / (ctx.num_levels - 1),
+                                             ctx.num_levels,
+                                             population_size);
+    if (surrogate_status < 0) {
+        fprintf(stderr, "Failed to allocate the GA surrogate.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (surrogate_status > 0) {
+        surrogate = &surrogate_storage;
+    }
+    if (race.rungs > 0 && ga_output_mode >= OUTPUT_DETAILED) {
+        printf("GA racing offspring through %d subset rungs (first rung: %d training samples)\n",
+               race.rungs,
+               race.training_levels[0].num_samples);
+    }
     output_mode = OUTPUT_NONE;
-#ifdef _OPENMP
-#pragma omp parallel for schedule(dynamic)
+    if (start_generation == 0) {
+        evaluate_generation(population,
+                            population_size,
+                            genome_length,
+                            NULL,
+                            NULL,
+                            0,
+                            &ctx,
+                            cache,
+                            surrogate,
+                            NULL,
+                            &eval_scratch,
+                            batch_size,
+                            NULL,
+                            0,
+                            accP,
+                            simP);
+#if GA_CIM_EXPORT_ENABLED && GA_CIM_EXPORT_FORMAT == GA_CIM_EXPORT_COMPACT
+        if (cim_writer_open &&
+            export_compact_generation(&cim_writer, 0, population, population_size, genome_length, accP, simP) != 0) {
+            fprintf(stderr, "Warning: GA CiM export failed, stopping it.\n");
+            free_ga_cim_writer(&cim_writer);
+            cim_writer_open = 0;
+        }
 #endif
-    for (int i = 0; i < population_size; i++) {
-        (void)evaluate_candidate(&population[i * genome_length],
-                                 &ctx,
-                                 NULL,
-                                 0,
-                                 i,
-                                 &accP[i],
-                                 &simP[i]);
     }
     output_mode = ga_output_mode;
 
-    for (int gen = 0; gen < params->generations; gen++) {
+    for (int gen = start_generation; gen < params->generations; gen++) {
         if (ga_output_mode == OUTPUT_BASIC) {
             printf("\rGA generation %d/%d   ", gen + 1, params->generations);
             fflush(stdout);
@@ -1609,24 +3724,57 @@ static void run_ga(const struct ga_eval_context *ctx_in,
                                         params->mutation_rate,
                                         &ga_state);
             }
+#if GA_DELTA_ACTIVE
+            // Delta-encode against the closer parent when few CiM rows differ from it.
+            int changed_a = genome_changed_rows(&offspring[i * genome_length],
+                                                &population[parent_a * genome_length],
+                                                transitions,
+                                                feature_blocks,
+                                                max_total);
+            int changed_b = genome_changed_rows(&offspring[i * genome_length],
+                                                &population[parent_b * genome_length],
+                                                transitions,
+                                                feature_blocks,
+                                                max_total);
+            int closer_parent = changed_b < changed_a ? parent_b : parent_a;
+            int changed = changed_b < changed_a ? changed_b : changed_a;
+            int cim_rows = (transitions + 1) * feature_blocks;
+            offspring_parent[i] = changed <= GA_DELTA_MAX_CHANGED_FRACTION * cim_rows ? closer_parent : -1;
+#else
+            offspring_parent[i] = -1;
+#endif
         }
 
+        const char *export_dir_for_generation =
+            (active_export_run_dir && (gen + 1 == params->generations)) ? active_export_run_dir : NULL;
+        long lookups_before = cache ? cache->lookups : 0;
+        long hits_before = cache ? cache->hits : 0;
         output_mode = OUTPUT_NONE;
-#ifdef _OPENMP
-#pragma omp parallel for schedule(dynamic)
-#endif
-        for (int i = 0; i < population_size; i++) {
-            const char *export_dir_for_generation =
-                (active_export_run_dir && (gen + 1 == params->generations)) ? active_export_run_dir : NULL;
-            (void)evaluate_candidate(&offspring[i * genome_length],
-                                     &ctx,
-                                     export_dir_for_generation,
-                                     gen + 1,
-                                     i,
-                                     &accQ[i],
-                                     &simQ[i]);
-        }
+        evaluate_generation(offspring,
+                            population_size,
+                            genome_length,
+                            GA_DELTA_ACTIVE ? offspring_parent : NULL,
+                            population,
+                            population_size,
+                            &ctx,
+                            cache,
+                            surrogate,
+                            race.rungs > 0 ? &race : NULL,
+                            &eval_scratch,
+                            batch_size,
+                            export_dir_for_generation,
+                            gen + 1,
+                            accQ,
+                            simQ);
         output_mode = ga_output_mode;
+#if GA_CIM_EXPORT_ENABLED && GA_CIM_EXPORT_FORMAT == GA_CIM_EXPORT_COMPACT
+        if (cim_writer_open &&
+            export_compact_generation(&cim_writer, gen + 1, offspring, population_size, genome_length, accQ, simQ) != 0) {
+            fprintf(stderr, "Warning: GA CiM export failed, stopping it.\n");
+            free_ga_cim_writer(&cim_writer);
+            cim_writer_open = 0;
+        }
+#endif
 
         int new_selected_count = 0;
         if (selection_mode == GA_SELECTION_PARETO) {
@@ -1677,6 +3825,49 @@ static void run_ga(const struct ga_eval_context *ctx_in,
 
         if (ga_output_mode > OUTPUT_BASIC) {
             printf("  new selected individuals: %d/%d\n", new_selected_count, population_size);
+            if (cache) {
+                long lookups = cache->lookups - lookups_before;
+                long hits = cache->hits - hits_before;
+                printf("  fitness cache: %ld/%ld reused (%.1f%%)\n",
+                       hits,
+                       lookups,
+                       lookups > 0 ? 100.0 * (double)hits / (double)lookups : 0.0);
+            }
+        }
+
+        if (ga_island_migration_due(&island, gen + 1, params->generations)) {
+            int received = exchange_island_migrants(&island,
+                                                    gen + 1,
+                                                    population,
+                                                    accP,
+                                                    simP,
+                                                    population_size,
+                                                    genome_length,
+                                                    selection_mode,
+                                                    cache,
+                                                    ctx.seed,
+                                                    eval_scratch.order);
+            if (ga_output_mode > OUTPUT_BASIC) {
+                if (received >= 0) {
+                    printf("  island migration: %d genomes received\n", received);
+                } else {
+                    printf("  island migration failed, continuing in isolation\n");
+                }
+            }
+        }
+
+        if (checkpoint_path[0] != '\0' &&
+            ((gen + 1) % params->checkpoint_every == 0 || gen + 1 == params->generations)) {
+            checkpoint.next_generation = gen + 1;
+            checkpoint.ga_state = ga_state;
+            checkpoint.best_acc = best_acc;
+            checkpoint.best_sim = best_sim;
+            checkpoint.best_score = best_score;
+            checkpoint.best_gen = best_gen;
+            checkpoint.best_gen_index = best_gen_index;
+            if (save_ga_checkpoint(checkpoint_path, checkpoint_fingerprint, &checkpoint) != 0) {
+                fprintf(stderr, "Warning: failed to write GA checkpoint %s.\n", checkpoint_path);
+            }
         }
     }
     if (ga_output_mode == OUTPUT_BASIC) {
@@ -1719,6 +3910,51 @@ static void run_ga(const struct ga_eval_context *ctx_in,
            &population[(size_t)best_idx * genome_length],
            (size_t)genome_length * sizeof(uint16_t));
 
+    if (island.island_count > 1) {
+        // Every island adopts the same overall winner; ties go to the lowest island id.
+        if (ga_island_gather(&island, B_out, accP[best_idx], simP[best_idx]) > 0) {
+            int best_island = 0;
+            for (int i = 1; i < island.island_count; i++) {
+                double acc_i = island.accuracy[i];
+                double sim_i = island.similarity[i];
+                double acc_b = island.accuracy[best_island];
+                double sim_b = island.similarity[best_island];
+                int better;
+                if (selection_mode == GA_SELECTION_PARETO) {
+                    better = acc_i > acc_b || (acc_i == acc_b && sim_i < sim_b);
+                } else {
+                    better = compute_scalar_fitness(selection_mode, acc_i, sim_i) >
+                             compute_scalar_fitness(selection_mode, acc_b, sim_b);
+                }
+                if (better) {
+                    best_island = i;
+                }
+            }
+            memcpy(B_out,
+                   &island.genomes[(size_t)best_island * genome_length],
+                   (size_t)genome_length * sizeof(uint16_t));
+            if (ga_output_mode >= OUTPUT_BASIC) {
+                printf("GA islands: overall winner from island %d (acc %.3f%%, sim %.3f)\n",
+                       best_island,
+                       island.accuracy[best_island] * 100.0,
+                       island.similarity[best_island]);
+            }
+        } else {
+            fprintf(stderr, "Warning: GA island %d keeps its local winner.\n", island.island_id);
+        }
+    }
+    if (warm_out) {
+        warm_out->population = (uint16_t *)malloc((size_t)population_size * genome_length * sizeof(uint16_t));
+        if (warm_out->population) {
+            memcpy(warm_out->population, population, (size_t)population_size * genome_length * sizeof(uint16_t));
+            warm_out->population_size = population_size;
+            warm_out->genome_length = genome_length;
+            warm_out->seed = params->seed;
+        } else {
+            fprintf(stderr, "Warning: cannot keep the GA population for a warm start.\n");
+        }
+    }
+
     if (ga_output_mode >= OUTPUT_DETAILED && best_gen >= 0 && best_gen_index >= 0) {
         if (selection_mode == GA_SELECTION_PARETO) {
             printf("GA winner: generation %d, individual %d (acc %.3f%%, sim %.3f)\n",
@@ -1736,7 +3972,40 @@ static void run_ga(const struct ga_eval_context *ctx_in,
         }
     }
 
+#if GA_CIM_EXPORT_ENABLED && GA_CIM_EXPORT_FORMAT == GA_CIM_EXPORT_COMPACT
+    if (cim_writer_open && free_ga_cim_writer(&cim_writer) != 0) {
+        fprintf(stderr, "Warning: GA CiM export %s is incomplete.\n", export_run_dir);
+    }
+#endif
     free(front_offsets);
+    if (cache) {
+        if (ga_output_mode >= OUTPUT_DETAILED) {
+            printf("GA fitness cache: %ld of %ld evaluations reused (%.1f%%)\n",
+                   cache->hits,
+                   cache->lookups,
+                   cache->lookups > 0 ? 100.0 * (double)cache->hits / (double)cache->lookups : 0.0);
+        }
+        free_ga_fitness_cache(cache);
+    }
+    if (surrogate) {
+        if (ga_output_mode >= OUTPUT_DETAILED) {
+            printf("GA surrogate: %ld of %ld offspring screened out (%.1f%%)\n",
+                   surrogate->screened_out,
+                   surrogate->screened,
+                   surrogate->screened > 0 ? 100.0 * (double)surrogate->screened_out / (double)surrogate->screened : 0.0);
+        }
+        free_ga_surrogate(surrogate);
+    }
+#if HDC_OFFLOAD
+    for (int r = 0; r < race.rungs; r++) {
+        offload_free(race.rung_ctx[r].offload);
+    }
+    offload_free(ctx.offload);
+#endif
+    free_ga_race(&race);
+    free_ga_island_link(&island);
+    free(offspring_parent);
+    free_ga_eval_scratch(&eval_scratch);
     free(fronts);
     free(crowdR);
     free(rankR);
@@ -1769,7 +4038,9 @@ static int run_precomputed_ga_and_capture_flip_counts(int num_features,
                                                       int testing_samples,
                                                       uint16_t *flip_counts_out,
                                                       int **permutations_out,
-                                                      const char *export_label) {
+                                                      const char *export_label,
+                                                      const struct ga_warm_start *warm_in,
+                                                      struct ga_warm_start *warm_out) {
     if (!training_data || !training_labels || training_samples <= N_GRAM_SIZE || !flip_counts_out) {
         return -1;
     }
@@ -1779,6 +4050,10 @@ static int run_precomputed_ga_and_capture_flip_counts(int num_features,
 
     struct ga_params params;
     init_ga_params(&params);
+    if (warm_in && warm_in->population) {
+        // The warm genomes only mean the same thing under the same permutations.
+        params.seed = warm_in->seed;
+    }
 
     if (params.seed == 0) {
         params.seed = (unsigned int)time(NULL);
@@ -1818,9 +4093,18 @@ static int run_precomputed_ga_and_capture_flip_counts(int num_features,
     ctx.testing_samples = testing_samples;
     ctx.export_label = export_label;
 
+    struct quantized_dataset training_levels;
+    struct quantized_dataset testing_levels;
+    if (init_ga_level_cache(&ctx, &training_levels, &testing_levels) != 0) {
+        fprintf(stderr, "Failed to quantize GA datasets.\n");
+        free(permutations);
+        return -1;
+    }
+
     int genome_length = (num_levels - 1) * num_features;
     memset(flip_counts_out, 0, (size_t)genome_length * sizeof(uint16_t));
-    run_ga(&ctx, &params, flip_counts_out);
+    run_ga(&ctx, &params, warm_in, flip_counts_out, warm_out);
+    free_ga_level_cache(&ctx, &training_levels, &testing_levels);
 
     if (permutations_out) {
         *permutations_out = permutations;
@@ -1836,7 +4120,8 @@ int optimize_item_memory_get_flip_counts(double **training_data,
                                          double **testing_data,
                                          int *testing_labels,
                                          int testing_samples,
-                                         uint16_t *flip_counts_out) {
+                                         uint16_t *flip_counts_out,
+                                         struct ga_warm_start *warm_out) {
     return run_precomputed_ga_and_capture_flip_counts(NUM_FEATURES,
                                                       NUM_LEVELS,
                                                       training_data,
@@ -1847,7 +4132,9 @@ int optimize_item_memory_get_flip_counts(double **training_data,
                                                       testing_samples,
                                                       flip_counts_out,
                                                       NULL,
-                                                      "preproc_ga");
+                                                      "preproc_ga",
+                                                      NULL,
+                                                      warm_out);
 }
 
 void optimize_item_memory(struct item_memory *item_mem,
@@ -1857,6 +4144,24 @@ void optimize_item_memory(struct item_memory *item_mem,
                           double **testing_data,
                           int *testing_labels,
                           int testing_samples) {
+    optimize_item_memory_warm(item_mem,
+                              training_data,
+                              training_labels,
+                              training_samples,
+                              testing_data,
+                              testing_labels,
+                              testing_samples,
+                              NULL);
+}
+
+void optimize_item_memory_warm(struct item_memory *item_mem,
+                               double **training_data,
+                               int *training_labels,
+                               int training_samples,
+                               double **testing_data,
+                               int *testing_labels,
+                               int testing_samples,
+                               const struct ga_warm_start *warm_start) {
     if (!item_mem || !training_data || !training_labels || training_samples <= N_GRAM_SIZE) {
         return;
     }
@@ -1887,7 +4192,9 @@ void optimize_item_memory(struct item_memory *item_mem,
                                                    testing_samples,
                                                    flip_counts,
                                                    &permutations,
-                                                   "final_precomputed_ga") != 0) {
+                                                   "final_precomputed_ga",
+                                                   warm_start,
+                                                   NULL) != 0) {
         fprintf(stderr, "Failed to run precomputed GA.\n");
         free(flip_counts);
         return;
@@ -1988,7 +4295,14 @@ void optimize_item_memory(struct item_memory *signal_mem,
         exit(EXIT_FAILURE);
     }
 
-    run_ga(&ctx, &params, flip_counts);
+    struct quantized_dataset training_levels;
+    struct quantized_dataset testing_levels;
+    if (init_ga_level_cache(&ctx, &training_levels, &testing_levels) != 0) {
+        fprintf(stderr, "Failed to quantize GA datasets.\n");
+        exit(EXIT_FAILURE);
+    }
+    run_ga(&ctx, &params, NULL, flip_counts, NULL);
+    free_ga_level_cache(&ctx, &training_levels, &testing_levels);
 
     if (signal_mem->base_vectors && signal_mem->num_vectors > 0) {
         free_item_memory(signal_mem);
@@ -23,8 +23,36 @@ struct ga_params {
     int tournament_size;
     int log_every;
     unsigned int seed;
+    int racing_rungs;              /**< Subset rungs offspring race through before full scoring; 0 disables. */
+    double racing_min_fraction;    /**< Share of the training/validation data used by the first rung. */
+    double racing_keep_fraction;   /**< Share of the candidates promoted from one rung to the next. */
+    double surrogate_keep_fraction;/**< Share of uncached offspring a proxy score lets through to full scoring; 0 disables. */
+    int surrogate_refit_every;     /**< Generations between refits of the proxy on real fitnesses. */
+    int island_count;              /**< Islands in the migration ring; 1 runs a single population. */
+    int island_id;                 /**< This island's position in the ring (overridden by MPI/environment). */
+    int migration_interval;        /**< Generations between migrations. */
+    int migrants;                  /**< Best genomes sent to the next island per migration. */
+    int checkpoint_every;          /**< Generations between checkpoints in GA_CHECKPOINT_DIR; 0 disables. */
+    int resume;                    /**< Continue from a matching checkpoint instead of starting over. */
+    int warm_start_generations;    /**< Generation budget of a run seeded from a warm start; 0 keeps `generations`. */
 };
 
+/**
+ * @brief Final population of a GA run, handed to a later run on the same data.
+ *
+ * A run seeded with it starts from these genomes instead of random ones and
+ * scores them once under its own quantizer. `seed` is the run's GA seed, which
+ * also fixes the flip orders the genomes refer to. Release with `free_ga_warm_start`.
+ */
+struct ga_warm_start {
+    uint16_t *population;  /**< `population_size` genomes of `genome_length` flip counts. */
+    int population_size;
+    int genome_length;
+    unsigned int seed;
+};
+
+void free_ga_warm_start(struct ga_warm_start *warm_start);
+
 
 // Initializes GA parameters with module defaults.
 void init_ga_params(struct ga_params *params);
@@ -46,7 +74,18 @@ int optimize_item_memory_get_flip_counts(
     double **testing_data,
     int *testing_labels,
     int testing_samples,
-    uint16_t *flip_counts_out);
+    uint16_t *flip_counts_out,
+    struct ga_warm_start *warm_out);
+// Same as optimize_item_memory, seeded from a previous run's population (NULL: cold start).
+void optimize_item_memory_warm(
+    struct item_memory *item_mem,
+    double **training_data,
+    int *training_labels,
+    int training_samples,
+    double **testing_data,
+    int *testing_labels,
+    int testing_samples,
+    const struct ga_warm_start *warm_start);
 #else
 void optimize_item_memory(
     struct item_memory *signal_mem,
@@ -0,0 +1,64 @@
+#ifndef BYTE_ORDER_H
+#define BYTE_ORDER_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Little-endian field helpers for the portable file and wire formats.
+ *
+ * The GA island packets, the GA CiM export, the quantizer cut files and the
+ * binary results file are all little-endian regardless of the host, so they
+ * write and read their fields through these instead of copying structs.
+ */
+static inline void put_u16(uint8_t *out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static inline void put_u32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static inline void put_u64(uint8_t *out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static inline void put_f64(uint8_t *out, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_u64(out, bits);
+}
+
+static inline uint16_t get_u16(const uint8_t *in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static inline uint32_t get_u32(const uint8_t *in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (uint32_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+static inline uint64_t get_u64(const uint8_t *in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+static inline double get_f64(const uint8_t *in) {
+    uint64_t bits = get_u64(in);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+#endif // BYTE_ORDER_H
@@ -20,12 +20,139 @@
  * @author Marian Horn
  */
 #include "encoder.h"
+#include "workspace.h"
 #include "operations.h"
 #include "quantizer.h"
+#include "profiler.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdint.h>
+
+#if !BIPOLAR_MODE && (NUM_FEATURES == 16 || NUM_FEATURES == 32 || NUM_FEATURES == 64)
+#define ENCODER_CSA_TREE 1
+
+#if defined(__GNUC__)
+// The CSA tree runs on ENCODER_LANE_WORDS adjacent words at once; the compiler
+// maps the lanes onto the widest SIMD registers -march allows.
+#define ENCODER_LANE_WORDS 8
+typedef uint64_t encoder_lanes __attribute__((vector_size(ENCODER_LANE_WORDS * sizeof(uint64_t))));
+#else
+#define ENCODER_LANE_WORDS 1
+typedef uint64_t encoder_lanes;
+#endif
+
+// Carry-save adder: (high, low) = a + b + c per bit position.
+#define ENCODER_CSA(high, low, a, b, c) \
+    do { \
+        encoder_lanes csa_u = (a) ^ (b); \
+        (high) = ((a) & (b)) | (csa_u & (c)); \
+        (low) = csa_u ^ (c); \
+    } while (0)
+
+/**
+ * @brief Folds 16 inputs into running ones/twos/fours/eights counters.
+ *
+ * Harley-Seal style carry-save tree; stores the weight-16 carry out in `sixteens`
+ * (an out parameter rather than a return value, so the lanes never cross a
+ * by-value ABI boundary when built without -march=native).
+ */
+static inline void encoder_csa16(const encoder_lanes *in,
+                                 encoder_lanes *ones,
+                                 encoder_lanes *twos,
+                                 encoder_lanes *fours,
+                                 encoder_lanes *eights,
+                                 encoder_lanes *sixteens) {
+    encoder_lanes twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+    ENCODER_CSA(twos_a, *ones, *ones, in[0], in[1]);
+    ENCODER_CSA(twos_b, *ones, *ones, in[2], in[3]);
+    ENCODER_CSA(fours_a, *twos, *twos, twos_a, twos_b);
+    ENCODER_CSA(twos_a, *ones, *ones, in[4], in[5]);
+    ENCODER_CSA(twos_b, *ones, *ones, in[6], in[7]);
+    ENCODER_CSA(fours_b, *twos, *twos, twos_a, twos_b);
+    ENCODER_CSA(eights_a, *fours, *fours, fours_a, fours_b);
+    ENCODER_CSA(twos_a, *ones, *ones, in[8], in[9]);
+    ENCODER_CSA(twos_b, *ones, *ones, in[10], in[11]);
+    ENCODER_CSA(fours_a, *twos, *twos, twos_a, twos_b);
+    ENCODER_CSA(twos_a, *ones, *ones, in[12], in[13]);
+    ENCODER_CSA(twos_b, *ones, *ones, in[14], in[15]);
+    ENCODER_CSA(fours_b, *twos, *twos, twos_a, twos_b);
+    ENCODER_CSA(eights_b, *fours, *fours, fours_a, fours_b);
+    ENCODER_CSA(*sixteens, *eights, *eights, eights_a, eights_b);
+}
+
+#undef ENCODER_CSA
+
+/**
+ * @brief Majority of `count` (<= ENCODER_LANE_WORDS) words starting at `word`
+ *        across exactly NUM_FEATURES rows, with the threshold baked in.
+ *
+ * Matches `bundle_multi(vectors, NUM_FEATURES, result)` bit for bit
+ * (bit set when count >= NUM_FEATURES / 2). The count is
+ * 16 * (sum of the weight-16 carries) + (remainder <= 15), so the threshold test
+ * reduces to a few bitwise ops on the carries and the low counters are discarded.
+ */
+static inline void encoder_majority_words(const uint64_t *const *rows,
+                                          size_t word,
+                                          size_t count,
+                                          uint64_t *out) {
+    encoder_lanes in[NUM_FEATURES];
+    if (count == ENCODER_LANE_WORDS) {
+        for (int f = 0; f < NUM_FEATURES; f++) {
+            memcpy(&in[f], rows[f] + word, sizeof(encoder_lanes));
+        }
+    } else {
+        memset(in, 0, sizeof(in));
+        for (int f = 0; f < NUM_FEATURES; f++) {
+            memcpy(&in[f], rows[f] + word, count * sizeof(uint64_t));
+        }
+    }
+
+    encoder_lanes ones = {0}, twos = {0}, fours = {0}, eights = {0};
+    encoder_lanes s0;
+    encoder_csa16(in, &ones, &twos, &fours, &eights, &s0);
+#if NUM_FEATURES == 16
+    // count >= 8
+    encoder_lanes majority = s0 | eights;
+#elif NUM_FEATURES == 32
+    // count >= 16
+    encoder_lanes s1;
+    encoder_csa16(in + 16, &ones, &twos, &fours, &eights, &s1);
+    encoder_lanes majority = s0 | s1;
+#else
+    // count >= 32: at least two of the four weight-16 carries
+    encoder_lanes s1;
+    encoder_csa16(in + 16, &ones, &twos, &fours, &eights, &s1);
+    encoder_lanes s2;
+    encoder_csa16(in + 32, &ones, &twos, &fours, &eights, &s2);
+    encoder_lanes s3;
+    encoder_csa16(in + 48, &ones, &twos, &fours, &eights, &s3);
+    encoder_lanes majority = (s0 & s1) | (s2 & s3) | ((s0 ^ s1) & (s2 | s3));
+#endif
+    memcpy(out, &majority, count * sizeof(uint64_t));
+}
+
+#if PRECOMPUTED_ITEM_MEMORY
+/**
+ * @brief Majority of exactly NUM_FEATURES vectors with the threshold baked in.
+ */
+static void encoder_majority_fixed(Vector **vectors, Vector *result) {
+    const uint64_t *src[NUM_FEATURES];
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        src[f] = vectors[f]->data;
+    }
+    size_t words = vector_storage_count();
+    for (size_t w = 0; w < words; w += ENCODER_LANE_WORDS) {
+        size_t count = words - w < ENCODER_LANE_WORDS ? words - w : ENCODER_LANE_WORDS;
+        encoder_majority_words(src, w, count, result->data + w);
+    }
+    vector_mask_tail(result);
+}
+#endif
+
+#else
+#define ENCODER_CSA_TREE 0
+#endif
 
 #if PRECOMPUTED_ITEM_MEMORY
 /**
@@ -41,6 +168,7 @@
  */
 void init_encoder(struct encoder *enc, struct item_memory *itemMem) {
     enc->item_mem = itemMem;
+    enc->quantizer = quantizer_global();
 }
 #else
 /**
@@ -58,8 +186,54 @@ void init_encoder(struct encoder *enc, struct item_memory *itemMem) {
 void init_encoder(struct encoder *enc, struct item_memory *channel_memory, struct item_memory *signal_memory) {
     enc->channel_memory = channel_memory;
     enc->signal_memory = signal_memory;
+    enc->quantizer = quantizer_global();
 }
 #endif
+
+/**
+ * @brief Makes the encoder quantize raw samples with its own quantizer.
+ *
+ * `init_encoder` starts with the global quantizer; models that fit their own
+ * instance (quantizer_fit()) attach it here. The encoder does not own it.
+ *
+ * @param enc Encoder to configure.
+ * @param quantizer Fitted quantizer, or NULL to fall back to the global one.
+ */
+void encoder_use_quantizer(struct encoder *enc, struct quantizer *quantizer) {
+    enc->quantizer = quantizer ? quantizer : quantizer_global();
+}
+/**
+ * @brief Cost model: item memory reads, binding and bundling counters of `count` timestamps.
+ */
+static inline void count_encode_cost(int count) {
+#if HDC_COST_MODEL
+    uint64_t features = (uint64_t)count * NUM_FEATURES;
+#if PRECOMPUTED_ITEM_MEMORY
+    HDC_COST_ADD(HDC_STAGE_ENCODE_TIMESTAMP, HDC_COST_CIM_READS, features);
+    HDC_COST_ADD(HDC_STAGE_ENCODE_TIMESTAMP, HDC_COST_CIM_READ_BYTES, features * vector_storage_bytes());
+#else
+    // Channel and level vector per feature, bound before bundling.
+    HDC_COST_ADD(HDC_STAGE_ENCODE_TIMESTAMP, HDC_COST_CIM_READS, 2 * features);
+    HDC_COST_ADD(HDC_STAGE_ENCODE_TIMESTAMP, HDC_COST_CIM_READ_BYTES, 2 * features * vector_storage_bytes());
+    HDC_COST_ADD(HDC_STAGE_ENCODE_TIMESTAMP, HDC_COST_XOR_WORDS, features * vector_storage_count());
+#endif
+    HDC_COST_ADD(HDC_STAGE_ENCODE_TIMESTAMP, HDC_COST_COUNTER_UPDATES, features * VECTOR_DIMENSION);
+#else
+    (void)count;
+#endif
+}
+
+/**
+ * @brief Cost model: `passes` permute-and-bind passes over an n-gram vector.
+ */
+static inline void count_ngram_cost(int passes) {
+#if HDC_COST_MODEL
+    HDC_COST_ADD(HDC_STAGE_NGRAM, HDC_COST_XOR_WORDS, (uint64_t)passes * vector_storage_count());
+#else
+    (void)passes;
+#endif
+}
+
 /**
  * @brief Encodes a single timestamp of data into a hypervector.
  *
@@ -76,73 +250,289 @@ void encode_timestamp(struct encoder *enc, double *emg_sample, Vector *result) {
         return;
     }
 
+    quantized_level levels[NUM_FEATURES];
+    quantizer_quantize_sample(enc->quantizer, emg_sample, levels);
+    encode_timestamp_levels(enc, levels, result);
+}
+
+/**
+ * @brief Encodes a single timestamp whose features are already quantized.
+ *
+ * Identical to `encode_timestamp` but skips quantization, e.g. for rows of a
+ * `quantized_dataset`.
+ *
+ * @param enc A pointer to the encoder structure.
+ * @param levels NUM_FEATURES signal levels of the timestamp.
+ * @param result A pointer to the resulting hypervector.
+ */
+void encode_timestamp_levels(struct encoder *enc, const quantized_level *levels, Vector *result) {
+    if (enc == NULL || levels == NULL || result == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to encode_timestamp_levels\n");
+        return;
+    }
+    HDC_PROFILE_BEGIN(HDC_STAGE_ENCODE_TIMESTAMP);
+
 #if PRECOMPUTED_ITEM_MEMORY
     Vector* bound_vectors[NUM_FEATURES];
     for (int channel = 0; channel < NUM_FEATURES; channel++) {
-        int signal_level = get_signal_level(channel, emg_sample[channel]);
+        int signal_level = levels[channel];
         bound_vectors[channel] = enc->item_mem->base_vectors[(signal_level * NUM_FEATURES) + channel];
     }
+#if ENCODER_CSA_TREE
+    encoder_majority_fixed(bound_vectors, result);
+#elif BIPOLAR_MODE
+    bundle_signs(bound_vectors, NULL, NUM_FEATURES, result);
+#else
     bundle_multi(bound_vectors, NUM_FEATURES, result);
+#endif
 #else
+    Vector* channel_vectors[NUM_FEATURES];
+    Vector* signal_vectors[NUM_FEATURES];
+    for (int channel = 0; channel < NUM_FEATURES; channel++) {
+        int signal_level = levels[channel];
+        channel_vectors[channel] = enc->channel_memory->base_vectors[channel];
+        signal_vectors[channel] = enc->signal_memory->base_vectors[signal_level];
+    }
 #if BIPOLAR_MODE
-    for (int d = 0; d < VECTOR_DIMENSION; d++) {
-        result->data[d] = 0;
+    bundle_signs(channel_vectors, signal_vectors, NUM_FEATURES, result);
+#else
+    bundle_multi_bound(channel_vectors, signal_vectors, NUM_FEATURES, result);
+#endif
+#endif
+    count_encode_cost(1);
+    HDC_PROFILE_END(HDC_STAGE_ENCODE_TIMESTAMP, 1);
+}
+
+#if PRECOMPUTED_ITEM_MEMORY && ENCODER_CSA_TREE
+// Delta re-encoding granularity: one CSA-tree lane group.
+#define ENCODER_DELTA_TILE_WORDS ENCODER_LANE_WORDS
+#else
+// Without the CSA tree a changed row forces re-encoding the whole timestamp.
+#define ENCODER_DELTA_TILE_WORDS VECTOR_WORD_COUNT
+#endif
+#define ENCODER_DELTA_TILES ((VECTOR_WORD_COUNT + ENCODER_DELTA_TILE_WORDS - 1) / ENCODER_DELTA_TILE_WORDS)
+#define ENCODER_DELTA_MASK_WORDS ((ENCODER_DELTA_TILES + 63) / 64)
+
+/**
+ * @brief Records which word tiles of every CiM row differ between two item memories.
+ *
+ * @param delta The delta to initialize.
+ * @param reference Item memory the reference encodings were produced with.
+ * @param target Item memory of the encoder that will patch them.
+ * @return 0 on success, -1 if the memories are incompatible, allocation fails, or
+ *         the build has no binary precomputed item memory.
+ */
+int init_encoder_delta(struct encoder_delta *delta,
+                       const struct item_memory *reference,
+                       const struct item_memory *target) {
+    if (delta == NULL) {
+        return -1;
     }
-    for (int channel = 0; channel < NUM_FEATURES; channel++) {
-        int signal_level = get_signal_level(channel, emg_sample[channel]);
-        Vector *channel_vec = enc->channel_memory->base_vectors[channel];
-        Vector *signal_vec = enc->signal_memory->base_vectors[signal_level];
-        for (int d = 0; d < VECTOR_DIMENSION; d++) {
-            result->data[d] += channel_vec->data[d] * signal_vec->data[d];
+    delta->row_tiles = NULL;
+    delta->num_rows = 0;
+    delta->changed_rows = 0;
+#if PRECOMPUTED_ITEM_MEMORY && !BIPOLAR_MODE
+    if (reference == NULL || target == NULL || reference->num_vectors != target->num_vectors) {
+        return -1;
+    }
+
+    int num_rows = target->num_vectors;
+    delta->row_tiles = (uint64_t *)calloc((size_t)num_rows * ENCODER_DELTA_MASK_WORDS, sizeof(uint64_t));
+    if (delta->row_tiles == NULL) {
+        return -1;
+    }
+    delta->num_rows = num_rows;
+
+    size_t words = VECTOR_WORD_COUNT;
+    for (int row = 0; row < num_rows; row++) {
+        const uint64_t *ref = reference->base_vectors[row]->data;
+        const uint64_t *cur = target->base_vectors[row]->data;
+        uint64_t *mask = delta->row_tiles + (size_t)row * ENCODER_DELTA_MASK_WORDS;
+        int changed = 0;
+        for (size_t w = 0; w < words; w++) {
+            if (ref[w] != cur[w]) {
+                size_t tile = w / ENCODER_DELTA_TILE_WORDS;
+                mask[tile / 64] |= (uint64_t)1 << (tile % 64);
+                changed = 1;
+            }
         }
+        delta->changed_rows += changed;
     }
+    return 0;
 #else
-    int threshold = NUM_FEATURES / 2;
-    int nbits = 0;
-    while ((1 << nbits) <= NUM_FEATURES && nbits < 31) {
-        nbits++;
+    (void)reference;
+    (void)target;
+    return -1;
+#endif
+}
+
+/**
+ * @brief Releases the tile masks of an encoder delta.
+ *
+ * @param delta The delta to free. NULL is ignored.
+ */
+void free_encoder_delta(struct encoder_delta *delta) {
+    if (delta == NULL) {
+        return;
     }
-    if (nbits < 1) {
-        nbits = 1;
+    free(delta->row_tiles);
+    delta->row_tiles = NULL;
+    delta->num_rows = 0;
+    delta->changed_rows = 0;
+}
+
+/**
+ * @brief Encodes a quantized timestamp by patching its reference encoding.
+ *
+ * The result equals `encode_timestamp_levels` under the encoder's item memory.
+ * Only word tiles in which one of the timestamp's CiM rows (one per feature)
+ * differs from the reference item memory are recomputed; all other words are
+ * copied from `reference`. A GA offspring that moves a few flip events
+ * therefore only pays for the words those flips land in.
+ *
+ * @param enc A pointer to the encoder structure (target item memory).
+ * @param delta Differences between the reference and the target item memory.
+ * @param levels NUM_FEATURES signal levels of the timestamp.
+ * @param reference The timestamp encoded with the reference item memory.
+ * @param result A pointer to the resulting hypervector (may alias `reference`).
+ */
+void encode_timestamp_levels_delta(struct encoder *enc,
+                                   const struct encoder_delta *delta,
+                                   const quantized_level *levels,
+                                   const Vector *reference,
+                                   Vector *result) {
+    if (enc == NULL || delta == NULL || levels == NULL || reference == NULL || result == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to encode_timestamp_levels_delta\n");
+        return;
+    }
+#if PRECOMPUTED_ITEM_MEMORY && !BIPOLAR_MODE
+    if (delta->row_tiles == NULL || delta->num_rows != enc->item_mem->num_vectors) {
+        encode_timestamp_levels(enc, levels, result);
+        return;
     }
 
-    uint64_t *planes = (uint64_t *)calloc((size_t)nbits, sizeof(uint64_t));
-    if (!planes) {
-        fprintf(stderr, "Error: Failed to allocate bit-sliced counters\n");
+    uint64_t tiles[ENCODER_DELTA_MASK_WORDS] = {0};
+    uint64_t any = 0;
+    for (int channel = 0; channel < NUM_FEATURES; channel++) {
+        int row = (levels[channel] * NUM_FEATURES) + channel;
+        const uint64_t *mask = delta->row_tiles + (size_t)row * ENCODER_DELTA_MASK_WORDS;
+        for (int m = 0; m < ENCODER_DELTA_MASK_WORDS; m++) {
+            tiles[m] |= mask[m];
+            any |= mask[m];
+        }
+    }
+    if (result != reference) {
+        vector_copy(result, reference);
+    }
+    if (!any) {
         return;
     }
 
+#if ENCODER_CSA_TREE
+    const uint64_t *src[NUM_FEATURES];
+    for (int channel = 0; channel < NUM_FEATURES; channel++) {
+        src[channel] = enc->item_mem->base_vectors[(levels[channel] * NUM_FEATURES) + channel]->data;
+    }
+    size_t words = vector_storage_count();
+    for (int tile = 0; tile < ENCODER_DELTA_TILES; tile++) {
+        if (!((tiles[tile / 64] >> (tile % 64)) & 1u)) {
+            continue;
+        }
+        size_t w = (size_t)tile * ENCODER_DELTA_TILE_WORDS;
+        size_t count = words - w < ENCODER_DELTA_TILE_WORDS ? words - w : ENCODER_DELTA_TILE_WORDS;
+        encoder_majority_words(src, w, count, result->data + w);
+    }
+    vector_mask_tail(result);
+#else
+    encode_timestamp_levels(enc, levels, result);
+#endif
+#else
+    (void)reference;
+    encode_timestamp_levels(enc, levels, result);
+#endif
+}
+
+#if PRECOMPUTED_ITEM_MEMORY && ENCODER_CSA_TREE
+// Samples quantized together; their CiM row pointers stay on the stack.
+#define ENCODER_BATCH_BLOCK 64
+// Words of every output computed before moving to the next tile (one cache line per CiM row).
+#define ENCODER_BATCH_TILE_WORDS 8
+#endif
+
+/**
+ * @brief Encodes a block of timestamps into consecutive hypervectors.
+ *
+ * Equivalent to calling `encode_timestamp` for every sample, but with the
+ * precomputed binary item memory and a CSA-tree feature count the samples are
+ * first quantized in blocks of ENCODER_BATCH_BLOCK, and the majority is then
+ * evaluated tile by tile (ENCODER_BATCH_TILE_WORDS words) across the whole
+ * block. The CiM rows touched by one tile stay resident in L1/L2 while every
+ * sample of the block reuses them. When OpenMP is enabled, blocks are
+ * distributed over threads.
+ *
+ * @param enc A pointer to the encoder structure.
+ * @param emg_data Array of `num_samples` timestamps, `[num_samples][NUM_FEATURES]`.
+ * @param num_samples Number of timestamps to encode.
+ * @param out Array of `num_samples` result vectors, typically the views of a
+ *            vector slab (`create_vector_slab`) so the output is contiguous.
+ * @return 0 on success, -1 if any pointer is NULL or `num_samples` is negative.
+ */
+int encode_timestamps_batch(struct encoder *enc, double **emg_data, int num_samples, Vector **out) {
+    if (enc == NULL || emg_data == NULL || out == NULL || num_samples < 0) {
+        fprintf(stderr, "Error: invalid arguments passed to encode_timestamps_batch\n");
+        return -1;
+    }
+
+#if PRECOMPUTED_ITEM_MEMORY && ENCODER_CSA_TREE
+    Vector **base_vectors = enc->item_mem->base_vectors;
     size_t words = vector_storage_count();
-    for (size_t w = 0; w < words; w++) {
-        memset(planes, 0, (size_t)nbits * sizeof(uint64_t));
-        for (int channel = 0; channel < NUM_FEATURES; channel++) {
-            int signal_level = get_signal_level(channel, emg_sample[channel]);
-            Vector *channel_vec = enc->channel_memory->base_vectors[channel];
-            Vector *signal_vec = enc->signal_memory->base_vectors[signal_level];
-            uint64_t carry = channel_vec->data[w] ^ signal_vec->data[w];
-            for (int b = 0; b < nbits; b++) {
-                uint64_t t = planes[b];
-                planes[b] = t ^ carry;
-                carry = t & carry;
+    int num_blocks = (num_samples + ENCODER_BATCH_BLOCK - 1) / ENCODER_BATCH_BLOCK;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int block = 0; block < num_blocks; block++) {
+        int first = block * ENCODER_BATCH_BLOCK;
+        int count = num_samples - first;
+        if (count > ENCODER_BATCH_BLOCK) {
+            count = ENCODER_BATCH_BLOCK;
+        }
+
+        const uint64_t *rows[ENCODER_BATCH_BLOCK][NUM_FEATURES];
+        for (int s = 0; s < count; s++) {
+            quantized_level levels[NUM_FEATURES];
+            quantizer_quantize_sample(enc->quantizer, emg_data[first + s], levels);
+            for (int channel = 0; channel < NUM_FEATURES; channel++) {
+                rows[s][channel] = base_vectors[((int)levels[channel] * NUM_FEATURES) + channel]->data;
             }
         }
 
-        uint64_t out_word = 0ull;
-        for (int bit = 0; bit < 64; bit++) {
-            int count = 0;
-            for (int b = 0; b < nbits; b++) {
-                count |= (int)(((planes[b] >> bit) & 1ull) << b);
+        HDC_PROFILE_BEGIN(HDC_STAGE_ENCODE_TIMESTAMP);
+        for (size_t tile = 0; tile < words; tile += ENCODER_BATCH_TILE_WORDS) {
+            size_t tile_end = tile + ENCODER_BATCH_TILE_WORDS;
+            if (tile_end > words) {
+                tile_end = words;
             }
-            if (count >= threshold) {
-                out_word |= (1ull << bit);
+            for (int s = 0; s < count; s++) {
+                uint64_t *dst = out[first + s]->data;
+                for (size_t w = tile; w < tile_end; w += ENCODER_LANE_WORDS) {
+                    size_t lanes = tile_end - w < ENCODER_LANE_WORDS ? tile_end - w : ENCODER_LANE_WORDS;
+                    encoder_majority_words(rows[s], w, lanes, dst + w);
+                }
             }
         }
-        result->data[w] = out_word;
+
+        for (int s = 0; s < count; s++) {
+            vector_mask_tail(out[first + s]);
+        }
+        count_encode_cost(count);
+        HDC_PROFILE_END(HDC_STAGE_ENCODE_TIMESTAMP, count);
+    }
+#else
+    for (int i = 0; i < num_samples; i++) {
+        encode_timestamp(enc, emg_data[i], out[i]);
     }
-    free(planes);
-    vector_mask_tail(result);
-#endif
 #endif
+    return 0;
 }
 
 /**
@@ -162,35 +552,39 @@ bool is_window_stable(int* labels){
     return true;
 }
 /**
- * @brief Encodes a sequence of data into a single hypervector (N-gram).
- *
- * This function performs temporal encoding by iteratively encoding each 
- * timestamp and applying binding and permutation for N-gram aggregation.
- *
- * @param enc A pointer to the encoder structure.
- * @param emg_data A 2D array of EMG data to encode.
- * @param result A pointer to the resulting hypervector.
- * @return 0 on success, -1 if any pointer is NULL.
+ * @brief Encodes member `i` of an n-gram from raw rows or from consecutive level rows.
  */
-int encode_timeseries(struct encoder *enc, double **emg_data, Vector *result) {
-    if (enc == NULL || emg_data == NULL || result == NULL) {
-        fprintf(stdout, "Error: NULL pointer passed to encode_timeseries\n");
-        return -1;
+static inline void encode_ngram_member(struct encoder *enc,
+                                       double **emg_data,
+                                       const quantized_level *levels,
+                                       size_t i,
+                                       Vector *out) {
+    if (levels != NULL) {
+        encode_timestamp_levels(enc, levels + i * NUM_FEATURES, out);
+    } else {
+        encode_timestamp(enc, emg_data[i], out);
     }
+}
 
+/**
+ * @brief Shared n-gram encoding body; `encoded` and `scratch` are caller-owned temporaries.
+ *
+ * Exactly one of `emg_data` and `levels` is non-NULL.
+ */
+static int encode_timeseries_into(struct encoder *enc, double **emg_data, const quantized_level *levels,
+                                  Vector *result, Vector *encoded, Vector *scratch) {
     #if BIPOLAR_MODE
 
-    encode_timestamp(enc, emg_data[0], result);
+    encode_ngram_member(enc, emg_data, levels, 0, result);
 
-    Vector* encoded = create_vector();
-    Vector* result_permuted = create_vector();
     for (size_t i = 1; i < N_GRAM_SIZE; i++) {
-        encode_timestamp(enc, emg_data[i], encoded);
-        permute(result,1,result_permuted);
-        bind(result_permuted,encoded,result);
+        encode_ngram_member(enc, emg_data, levels, i, encoded);
+        HDC_PROFILE_BEGIN(HDC_STAGE_NGRAM);
+        permute(result,1,scratch);
+        hdc_bind(scratch,encoded,result);
+        count_ngram_cost(1);
+        HDC_PROFILE_END(HDC_STAGE_NGRAM, 1);
     }
-    free_vector(encoded);
-    free_vector(result_permuted);
 
     if (output_mode >= OUTPUT_DEBUG) {
 
@@ -207,34 +601,30 @@ int encode_timeseries(struct encoder *enc, double **emg_data, Vector *result) {
         }
     }
     #else
+    (void)scratch;
 #if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN
     // Rolling-style temporal composition: XOR over slot-rotated timestamp HVs.
     vector_zero(result);
 
-    Vector* encoded = create_vector();
-    Vector* encoded_permuted = create_vector();
     for (size_t i = 0; i < N_GRAM_SIZE; i++) {
-        encode_timestamp(enc, emg_data[i], encoded);
-        permute(encoded, (int)i, encoded_permuted);
-        size_t words = vector_storage_count();
-        for (size_t w = 0; w < words; w++) {
-            result->data[w] ^= encoded_permuted->data[w];
-        }
+        encode_ngram_member(enc, emg_data, levels, i, encoded);
+        HDC_PROFILE_BEGIN(HDC_STAGE_NGRAM);
+        permute_xor_accumulate(result, encoded, (int)i);
+        count_ngram_cost(1);
+        HDC_PROFILE_END(HDC_STAGE_NGRAM, 1);
     }
-    free_vector(encoded);
-    free_vector(encoded_permuted);
 #else
-    encode_timestamp(enc, emg_data[0], result);
+    // Sample i contributes rotated by N_GRAM_SIZE-1-i; XOR binding commutes, so the
+    // n-gram is accumulated directly instead of re-permuting a running result.
+    vector_zero(result);
 
-    Vector* encoded = create_vector();
-    Vector* result_permuted = create_vector();
-    for (size_t i = 1; i < N_GRAM_SIZE; i++) {
-        encode_timestamp(enc, emg_data[i], encoded);
-        permute(result,1,result_permuted);
-        bind(result_permuted,encoded,result);
+    for (size_t i = 0; i < N_GRAM_SIZE; i++) {
+        encode_ngram_member(enc, emg_data, levels, i, encoded);
+        HDC_PROFILE_BEGIN(HDC_STAGE_NGRAM);
+        permute_xor_accumulate(result, encoded, (int)(N_GRAM_SIZE - 1 - i));
+        count_ngram_cost(1);
+        HDC_PROFILE_END(HDC_STAGE_NGRAM, 1);
     }
-    free_vector(encoded);
-    free_vector(result_permuted);
 #endif
     if (output_mode >= OUTPUT_DEBUG) {
         bool vectorContainsOnlyZeroEntries = true;
@@ -251,9 +641,81 @@ int encode_timeseries(struct encoder *enc, double **emg_data, Vector *result) {
     }
 #endif
     return 0;
+}
+
+/**
+ * @brief Encodes a sequence of data into a single hypervector (N-gram).
+ *
+ * This function performs temporal encoding by iteratively encoding each 
+ * timestamp and applying binding and permutation for N-gram aggregation.
+ *
+ * @param enc A pointer to the encoder structure.
+ * @param emg_data A 2D array of EMG data to encode.
+ * @param result A pointer to the resulting hypervector.
+ * @return 0 on success, -1 if any pointer is NULL.
+ *
+ * @note Allocates its temporaries on every call; hot loops should use
+ *       `encode_timeseries_ws` with a per-thread workspace instead.
+ */
+int encode_timeseries(struct encoder *enc, double **emg_data, Vector *result) {
+    if (enc == NULL || emg_data == NULL || result == NULL) {
+        fprintf(stdout, "Error: NULL pointer passed to encode_timeseries\n");
+        return -1;
+    }
+
+    Vector* encoded = create_vector();
+    Vector* scratch = create_vector();
+    int status = encode_timeseries_into(enc, emg_data, NULL, result, encoded, scratch);
+    free_vector(encoded);
+    free_vector(scratch);
+    return status;
+}
+
+/**
+ * @brief Encodes an N-gram using the temporaries of a workspace (no heap allocation).
+ *
+ * @param enc A pointer to the encoder structure.
+ * @param ws The calling thread's workspace. Its `encoded` and `scratch` vectors are clobbered.
+ * @param emg_data A 2D array of EMG data to encode.
+ * @param result A pointer to the resulting hypervector; must not alias `ws->encoded` or `ws->scratch`.
+ * @return 0 on success, -1 if any pointer is NULL.
+ */
+int encode_timeseries_ws(struct encoder *enc, struct hdc_workspace *ws, double **emg_data, Vector *result) {
+    if (enc == NULL || ws == NULL || emg_data == NULL || result == NULL) {
+        fprintf(stdout, "Error: NULL pointer passed to encode_timeseries_ws\n");
+        return -1;
+    }
+
+    return encode_timeseries_into(enc, emg_data, NULL, result, ws->encoded, ws->scratch);
+}
+
+/**
+ * @brief Encodes an N-gram from N_GRAM_SIZE consecutive rows of quantized levels.
+ *
+ * @param enc A pointer to the encoder structure.
+ * @param ws The calling thread's workspace. Its `encoded` and `scratch` vectors are clobbered.
+ * @param levels First of N_GRAM_SIZE consecutive NUM_FEATURES-wide level rows
+ *               (e.g. `quantized_dataset_row(dataset, start)`).
+ * @param result A pointer to the resulting hypervector; must not alias `ws->encoded` or `ws->scratch`.
+ * @return 0 on success, -1 if any pointer is NULL.
+ */
+int encode_timeseries_levels(struct encoder *enc, struct hdc_workspace *ws, const quantized_level *levels, Vector *result) {
+    if (enc == NULL || ws == NULL || levels == NULL || result == NULL) {
+        fprintf(stdout, "Error: NULL pointer passed to encode_timeseries_levels\n");
+        return -1;
+    }
 
+    return encode_timeseries_into(enc, NULL, levels, result, ws->encoded, ws->scratch);
 }
 
+#if !BIPOLAR_MODE && MODEL_VARIANT != MODEL_VARIANT_KRISCHAN
+// XOR binding and cyclic rotation are both invertible, so the n-gram can be
+// updated by cancelling the oldest sample instead of being rebuilt.
+#define NGRAM_ROLLING_UPDATE 1
+#else
+#define NGRAM_ROLLING_UPDATE 0
+#endif
+
 void init_ngram_encoder_state(struct ngram_encoder_state *state) {
     if (state == NULL) {
         fprintf(stderr, "Error: NULL pointer passed to init_ngram_encoder_state\n");
@@ -263,6 +725,7 @@ void init_ngram_encoder_state(struct ngram_encoder_state *state) {
     state->write_pos = 0;
     state->fill_count = 0;
     state->permuted_result = create_vector();
+    state->ngram = create_vector();
     for (int i = 0; i < N_GRAM_SIZE; i++) {
         state->encoded_samples[i] = create_vector();
     }
@@ -280,6 +743,7 @@ void reset_ngram_encoder_state(struct ngram_encoder_state *state) {
         vector_zero(state->encoded_samples[i]);
     }
     vector_zero(state->permuted_result);
+    vector_zero(state->ngram);
 }
 
 void free_ngram_encoder_state(struct ngram_encoder_state *state) {
@@ -297,20 +761,56 @@ void free_ngram_encoder_state(struct ngram_encoder_state *state) {
         free_vector(state->permuted_result);
         state->permuted_result = NULL;
     }
+    if (state->ngram != NULL) {
+        free_vector(state->ngram);
+        state->ngram = NULL;
+    }
     state->write_pos = 0;
     state->fill_count = 0;
 }
 
-int push_ngram_encoder_sample(struct encoder *enc,
-                              struct ngram_encoder_state *state,
-                              double *emg_sample,
-                              Vector *result) {
-    if (enc == NULL || state == NULL || emg_sample == NULL || result == NULL) {
-        fprintf(stderr, "Error: NULL pointer passed to push_ngram_encoder_sample\n");
-        return -1;
+/**
+ * @brief Returns the ring-buffer slot the newest timestamp is encoded into.
+ *
+ * With the rolling update the oldest sample still held by that slot is
+ * cancelled from the running n-gram first.
+ */
+static Vector *ngram_encoder_begin(struct ngram_encoder_state *state) {
+    Vector *slot_vec = state->encoded_samples[state->write_pos];
+#if NGRAM_ROLLING_UPDATE
+    if (state->fill_count == N_GRAM_SIZE) {
+        // The slot about to be overwritten holds the oldest sample: cancel it.
+        permute_xor_accumulate(state->ngram, slot_vec, N_GRAM_SIZE - 1);
+        count_ngram_cost(1);
     }
+#endif
+    return slot_vec;
+}
+
+/**
+ * @brief Folds the freshly encoded slot into the n-gram and advances the ring buffer (unprofiled body).
+ *
+ * @return 1 if `result` holds a full n-gram, 0 while the buffer is filling.
+ */
+static int ngram_encoder_fold(struct ngram_encoder_state *state, Vector *result) {
+#if NGRAM_ROLLING_UPDATE
+    Vector *slot_vec = state->encoded_samples[state->write_pos];
+    permute_bind(state->ngram, 1, slot_vec, state->permuted_result);
+    count_ngram_cost(1);
+    Vector *updated = state->permuted_result;
+    state->permuted_result = state->ngram;
+    state->ngram = updated;
 
-    encode_timestamp(enc, emg_sample, state->encoded_samples[state->write_pos]);
+    state->write_pos = (state->write_pos + 1) % N_GRAM_SIZE;
+    if (state->fill_count < N_GRAM_SIZE) {
+        state->fill_count++;
+    }
+    if (state->fill_count < N_GRAM_SIZE) {
+        return 0;
+    }
+    vector_copy(result, state->ngram);
+    return 1;
+#else
     state->write_pos = (state->write_pos + 1) % N_GRAM_SIZE;
     if (state->fill_count < N_GRAM_SIZE) {
         state->fill_count++;
@@ -323,11 +823,175 @@ int push_ngram_encoder_sample(struct encoder *enc,
     vector_copy(result, state->encoded_samples[oldest_slot]);
     for (int i = 1; i < N_GRAM_SIZE; i++) {
         int slot = (oldest_slot + i) % N_GRAM_SIZE;
-        permute(result, 1, state->permuted_result);
-        bind(state->permuted_result, state->encoded_samples[slot], result);
+        permute_bind(result, 1, state->encoded_samples[slot], state->permuted_result);
+        vector_copy(result, state->permuted_result);
     }
+    count_ngram_cost(N_GRAM_SIZE - 1);
 
     return 1;
+#endif
+}
+
+/**
+ * @brief Folds the freshly encoded slot into the n-gram and advances the ring buffer.
+ *
+ * @return 1 if `result` holds a full n-gram, 0 while the buffer is filling.
+ */
+static int ngram_encoder_commit(struct ngram_encoder_state *state, Vector *result) {
+    HDC_PROFILE_BEGIN(HDC_STAGE_NGRAM);
+    int full = ngram_encoder_fold(state, result);
+    HDC_PROFILE_END(HDC_STAGE_NGRAM, 1);
+    return full;
+}
+
+/**
+ * @brief Pushes one timestamp into the n-gram ring buffer and emits the current n-gram.
+ *
+ * In binary mode (non-KRISCHAN variant) the n-gram
+ * `rho^(N-1)(s_0) ^ rho^(N-2)(s_1) ^ ... ^ s_(N-1)` is maintained incrementally:
+ * the oldest sample is cancelled with one rotation by N-1 and the newest is folded
+ * in with one rotation by 1, so the cost per sample does not depend on
+ * N_GRAM_SIZE. The result is bit-identical to rebuilding the n-gram from the buffer.
+ *
+ * @param enc A pointer to the encoder structure.
+ * @param state The n-gram encoder state.
+ * @param emg_sample The newest timestamp.
+ * @param result Receives the n-gram once the buffer is full.
+ * @return 1 if `result` holds a full n-gram, 0 while the buffer is filling, -1 on error.
+ */
+int push_ngram_encoder_sample(struct encoder *enc,
+                              struct ngram_encoder_state *state,
+                              const double *emg_sample,
+                              Vector *result) {
+    if (enc == NULL || state == NULL || emg_sample == NULL || result == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to push_ngram_encoder_sample\n");
+        return -1;
+    }
+
+    quantized_level levels[NUM_FEATURES];
+    quantizer_quantize_sample(enc->quantizer, emg_sample, levels);
+    return push_ngram_encoder_levels(enc, state, levels, result);
+}
+
+/**
+ * @brief Same as `push_ngram_encoder_sample` for a float32 timestamp (a `sample_matrix` row).
+ *
+ * @param enc A pointer to the encoder structure.
+ * @param state The n-gram encoder state.
+ * @param sample NUM_FEATURES values of the newest timestamp.
+ * @param result Receives the n-gram once the buffer is full.
+ * @return 1 if `result` holds a full n-gram, 0 while the buffer is filling, -1 on error.
+ */
+int push_ngram_encoder_sample_f(struct encoder *enc,
+                                struct ngram_encoder_state *state,
+                                const float *sample,
+                                Vector *result) {
+    if (enc == NULL || state == NULL || sample == NULL || result == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to push_ngram_encoder_sample_f\n");
+        return -1;
+    }
+
+    quantized_level levels[NUM_FEATURES];
+    quantizer_quantize_sample_f(enc->quantizer, sample, levels);
+    return push_ngram_encoder_levels(enc, state, levels, result);
+}
+
+/**
+ * @brief Same as `push_ngram_encoder_sample` for a timestamp of int16 ADC codes.
+ *
+ * Quantizes with quantizer_quantize_sample_i16(), so the whole push runs
+ * without floating point.
+ *
+ * @param enc A pointer to the encoder structure.
+ * @param state The n-gram encoder state.
+ * @param sample NUM_FEATURES codes of the newest timestamp.
+ * @param result Receives the n-gram once the buffer is full.
+ * @return 1 if `result` holds a full n-gram, 0 while the buffer is filling, -1 on error.
+ */
+int push_ngram_encoder_sample_i16(struct encoder *enc,
+                                  struct ngram_encoder_state *state,
+                                  const int16_t *sample,
+                                  Vector *result) {
+    if (enc == NULL || state == NULL || sample == NULL || result == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to push_ngram_encoder_sample_i16\n");
+        return -1;
+    }
+
+    quantized_level levels[NUM_FEATURES];
+    quantizer_quantize_sample_i16(enc->quantizer, sample, levels);
+    return push_ngram_encoder_levels(enc, state, levels, result);
+}
+
+/**
+ * @brief Same as `push_ngram_encoder_sample` for a timestamp that is already quantized.
+ *
+ * @param enc A pointer to the encoder structure.
+ * @param state The n-gram encoder state.
+ * @param levels NUM_FEATURES signal levels of the newest timestamp.
+ * @param result Receives the n-gram once the buffer is full.
+ * @return 1 if `result` holds a full n-gram, 0 while the buffer is filling, -1 on error.
+ */
+int push_ngram_encoder_levels(struct encoder *enc,
+                              struct ngram_encoder_state *state,
+                              const quantized_level *levels,
+                              Vector *result) {
+    if (enc == NULL || state == NULL || levels == NULL || result == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to push_ngram_encoder_levels\n");
+        return -1;
+    }
+
+    encode_timestamp_levels(enc, levels, ngram_encoder_begin(state));
+    return ngram_encoder_commit(state, result);
+}
+
+/**
+ * @brief Same as `push_ngram_encoder_levels`, patching a reference timestamp encoding.
+ *
+ * The newest timestamp is produced by `encode_timestamp_levels_delta` from
+ * `reference`, its encoding under the reference item memory of `delta`.
+ *
+ * @param enc A pointer to the encoder structure (target item memory).
+ * @param state The n-gram encoder state.
+ * @param delta Differences between the reference and the target item memory.
+ * @param levels NUM_FEATURES signal levels of the newest timestamp.
+ * @param reference The timestamp encoded with the reference item memory.
+ * @param result Receives the n-gram once the buffer is full.
+ * @return 1 if `result` holds a full n-gram, 0 while the buffer is filling, -1 on error.
+ */
+int push_ngram_encoder_delta(struct encoder *enc,
+                             struct ngram_encoder_state *state,
+                             const struct encoder_delta *delta,
+                             const quantized_level *levels,
+                             const Vector *reference,
+                             Vector *result) {
+    if (enc == NULL || state == NULL || delta == NULL || levels == NULL || reference == NULL || result == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to push_ngram_encoder_delta\n");
+        return -1;
+    }
+
+    encode_timestamp_levels_delta(enc, delta, levels, reference, ngram_encoder_begin(state));
+    return ngram_encoder_commit(state, result);
+}
+
+/**
+ * @brief Same as `push_ngram_encoder_levels`, taking the newest timestamp already encoded.
+ *
+ * Lets callers that hold encoded timestamps (e.g. a `timestamp_cache`) build
+ * n-grams without touching the item memory.
+ *
+ * @param state The n-gram encoder state.
+ * @param timestamp Encoding of the newest timestamp.
+ * @param result Receives the n-gram once the buffer is full.
+ * @return 1 if `result` holds a full n-gram, 0 while the buffer is filling, -1 on error.
+ */
+int push_ngram_encoder_timestamp(struct ngram_encoder_state *state, const Vector *timestamp, Vector *result) {
+    if (state == NULL || timestamp == NULL || result == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to push_ngram_encoder_timestamp\n");
+        return -1;
+    }
+
+    vector_copy(ngram_encoder_begin(state), timestamp);
+    return ngram_encoder_commit(state, result);
 }
 
 /**
@@ -12,6 +12,7 @@
 #endif
 
 #include "item_mem.h"
+#include "quantizer.h"
 #include "vector.h"
 
 
@@ -21,9 +22,11 @@
  *
  * This structure uses a single item memory that combines signal levels and features.
  * - **item_mem**: Pointer to the precomputed item memory.
+ * - **quantizer**: Quantizer mapping raw samples to signal levels.
  */
 struct encoder {
     struct item_memory *item_mem;/**< Pointer to precomputed item memory. */
+    struct quantizer *quantizer;/**< Quantizer for raw samples (the global one by default). */
 };
 
 // Initialize the encoder
@@ -35,31 +38,87 @@ void init_encoder(struct encoder *enc, struct item_memory *item_mem);
  * This structure maintains separate item memories for signal levels and features.
  * - **channel_memory**: Pointer to the item memory for features.
  * - **signal_memory**: Pointer to the item memory for signal levels.
+ * - **quantizer**: Quantizer mapping raw samples to signal levels.
  */
 struct encoder {
     struct item_memory *channel_memory;/**< Item memory for features. */
     struct item_memory *signal_memory;/**< Item memory for signal levels. */
+    struct quantizer *quantizer;/**< Quantizer for raw samples (the global one by default). */
 };
 
 // Initialize the encoder
 void init_encoder(struct encoder *enc, struct item_memory *channel_memory, struct item_memory *signal_memory);
 #endif
+void encoder_use_quantizer(struct encoder *enc, struct quantizer *quantizer);
+struct hdc_workspace;
+
 struct ngram_encoder_state {
     Vector *encoded_samples[N_GRAM_SIZE];
     Vector *permuted_result;
+    Vector *ngram;/**< Running n-gram of the buffered samples (rolling update). */
     int write_pos;
     int fill_count;
 };
 
+/**
+ * @brief Differences between two precomputed item memories, for delta re-encoding.
+ *
+ * Lets a timestamp encoding made with a reference item memory be patched into the
+ * encoding under a target item memory by recomputing only the word tiles whose
+ * CiM rows differ.
+ *
+ * - **row_tiles**: For every CiM row (`level * NUM_FEATURES + feature`) a bitmask
+ *   of the word tiles in which the target row differs from the reference row.
+ * - **num_rows**: Number of CiM rows covered.
+ * - **changed_rows**: Rows with at least one differing tile.
+ */
+struct encoder_delta {
+    uint64_t *row_tiles;
+    int num_rows;
+    int changed_rows;
+};
+
 void encode_timestamp(struct encoder *enc, double *emg_sample, Vector *result);
+void encode_timestamp_levels(struct encoder *enc, const quantized_level *levels, Vector *result);
+int encode_timestamps_batch(struct encoder *enc, double **emg_data, int num_samples, Vector **out);
 int encode_timeseries(struct encoder *enc, double **emg_data, Vector *result);
+int encode_timeseries_ws(struct encoder *enc, struct hdc_workspace *ws, double **emg_data, Vector *result);
+int encode_timeseries_levels(struct encoder *enc, struct hdc_workspace *ws, const quantized_level *levels, Vector *result);
 void init_ngram_encoder_state(struct ngram_encoder_state *state);
 void reset_ngram_encoder_state(struct ngram_encoder_state *state);
 void free_ngram_encoder_state(struct ngram_encoder_state *state);
 int push_ngram_encoder_sample(struct encoder *enc,
                               struct ngram_encoder_state *state,
-                              double *emg_sample,
+                              const double *emg_sample,
                               Vector *result);
+int push_ngram_encoder_sample_f(struct encoder *enc,
+                                struct ngram_encoder_state *state,
+                                const float *sample,
+                                Vector *result);
+int push_ngram_encoder_sample_i16(struct encoder *enc,
+                                  struct ngram_encoder_state *state,
+                                  const int16_t *sample,
+                                  Vector *result);
+int push_ngram_encoder_levels(struct encoder *enc,
+                              struct ngram_encoder_state *state,
+                              const quantized_level *levels,
+                              Vector *result);
+int push_ngram_encoder_delta(struct encoder *enc,
+                             struct ngram_encoder_state *state,
+                             const struct encoder_delta *delta,
+                             const quantized_level *levels,
+                             const Vector *reference,
+                             Vector *result);
+int push_ngram_encoder_timestamp(struct ngram_encoder_state *state, const Vector *timestamp, Vector *result);
+int init_encoder_delta(struct encoder_delta *delta,
+                       const struct item_memory *reference,
+                       const struct item_memory *target);
+void free_encoder_delta(struct encoder_delta *delta);
+void encode_timestamp_levels_delta(struct encoder *enc,
+                                   const struct encoder_delta *delta,
+                                   const quantized_level *levels,
+                                   const Vector *reference,
+                                   Vector *result);
 bool is_window_stable(int* labels);
 int encode_general_data(struct encoder *enc, double *emg_data, Vector *result);
 
@@ -0,0 +1,388 @@
+/**
+ * @file ensemble.c
+ * @brief Trains and evaluates several models in one pass over the samples.
+ *
+ * @details
+ * The members are grouped once: every distinct quantizer quantizes a sample
+ * once, and every distinct item memory (with its quantizer) encodes the
+ * timestamp once into a ring of the last ENSEMBLE_MAX_NGRAM timestamps. The
+ * n-grams of a group are composed newest first,
+ *
+ *     g_1 = s_t,    g_(k+1) = g_k * rho^k(s_(t-k)),
+ *
+ * which is the n-gram the encoder folds oldest first (binding and rotation
+ * commute), so all n-gram lengths of a group come from one chain of
+ * `permute`/`hdc_bind` steps as long as the longest member. The cost of an
+ * ensemble is one quantization and one timestamp encoding per distinct input,
+ * the n-gram chain per item memory, and one class vector comparison per
+ * member.
+ *
+ * Binary, non-KRISCHAN builds only: training votes into the bit-sliced class
+ * counters, and the KRISCHAN rolling window has no n-gram of its own length.
+ */
+#include "ensemble.h"
+#include "operations.h"
+#include "quantizer.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !BIPOLAR_MODE && MODEL_VARIANT != MODEL_VARIANT_KRISCHAN
+/**
+ * @brief Members sharing one item memory and quantizer, sorted by n-gram length.
+ */
+struct ensemble_group {
+    struct encoder *enc;
+    int quantizer;                         /**< Entry of `ensemble_plan.quantizers`. */
+    int members[ENSEMBLE_MAX_MEMBERS];
+    int num_members;
+    Vector *ring[ENSEMBLE_MAX_NGRAM];      /**< Timestamp `t` in slot `t % ENSEMBLE_MAX_NGRAM`. */
+};
+
+struct ensemble_plan {
+    const struct ensemble_member *members;
+    int num_members;
+    int max_ngram;
+    struct quantizer *quantizers[ENSEMBLE_MAX_MEMBERS];
+    int num_quantizers;
+    struct ensemble_group groups[ENSEMBLE_MAX_MEMBERS];
+    int num_groups;
+    quantized_level levels[ENSEMBLE_MAX_MEMBERS][NUM_FEATURES];
+    Vector *ngrams[ENSEMBLE_MAX_MEMBERS];  /**< The n-gram of every ready member. */
+    Vector *chain;
+    Vector *spare;
+    Vector *rotated;
+    Vector **vectors;
+    vector_element *storage;
+};
+
+static bool same_item_memory(const struct encoder *a, const struct encoder *b) {
+#if PRECOMPUTED_ITEM_MEMORY
+    return a->item_mem == b->item_mem;
+#else
+    return a->channel_memory == b->channel_memory && a->signal_memory == b->signal_memory;
+#endif
+}
+
+/**
+ * @brief Validates the members and groups them by quantizer and item memory.
+ *
+ * @return 0 on success, -1 on invalid members.
+ */
+static int plan_ensemble(struct ensemble_plan *plan, const struct ensemble_member *members, int num_members) {
+    memset(plan, 0, sizeof(*plan));
+    if (members == NULL || num_members < 1 || num_members > ENSEMBLE_MAX_MEMBERS) {
+        fprintf(stderr, "ensemble: between 1 and %d members are supported.\n", ENSEMBLE_MAX_MEMBERS);
+        return -1;
+    }
+    plan->members = members;
+    plan->num_members = num_members;
+    for (int m = 0; m < num_members; m++) {
+        const struct ensemble_member *member = &members[m];
+        if (member->enc == NULL || member->assoc_mem == NULL || member->ngram_size < 1 ||
+            member->ngram_size > ENSEMBLE_MAX_NGRAM || !(member->weight >= 0.0)) {
+            fprintf(stderr, "ensemble: invalid member %d.\n", m);
+            return -1;
+        }
+        if (member->ngram_size > plan->max_ngram) {
+            plan->max_ngram = member->ngram_size;
+        }
+
+        int q = 0;
+        while (q < plan->num_quantizers && plan->quantizers[q] != member->enc->quantizer) {
+            q++;
+        }
+        if (q == plan->num_quantizers) {
+            plan->quantizers[plan->num_quantizers++] = member->enc->quantizer;
+        }
+        int g = 0;
+        while (g < plan->num_groups &&
+               !(plan->groups[g].quantizer == q && same_item_memory(plan->groups[g].enc, member->enc))) {
+            g++;
+        }
+        struct ensemble_group *group = &plan->groups[g];
+        if (g == plan->num_groups) {
+            plan->num_groups++;
+            group->enc = member->enc;
+            group->quantizer = q;
+        }
+        // Insertion keeps the group sorted by n-gram length, so one chain serves all of them.
+        int at = group->num_members++;
+        while (at > 0 && members[group->members[at - 1]].ngram_size > member->ngram_size) {
+            group->members[at] = group->members[at - 1];
+            at--;
+        }
+        group->members[at] = m;
+    }
+
+    int num_vectors = plan->num_groups * ENSEMBLE_MAX_NGRAM + num_members + 3;
+    plan->vectors = create_vector_slab(num_vectors, &plan->storage);
+    Vector **next = plan->vectors;
+    for (int g = 0; g < plan->num_groups; g++) {
+        for (int slot = 0; slot < ENSEMBLE_MAX_NGRAM; slot++) {
+            plan->groups[g].ring[slot] = *next++;
+        }
+    }
+    for (int m = 0; m < num_members; m++) {
+        plan->ngrams[m] = *next++;
+    }
+    plan->chain = *next++;
+    plan->spare = *next++;
+    plan->rotated = *next;
+    return 0;
+}
+
+static void free_plan(struct ensemble_plan *plan) {
+    if (plan->vectors != NULL) {
+        free_vector_slab(plan->vectors, plan->storage);
+        plan->vectors = NULL;
+    }
+}
+
+/**
+ * @brief Quantizes and encodes sample `t` once per quantizer and item memory.
+ */
+static void push_timestamp(struct ensemble_plan *plan, const double *sample, int t) {
+    for (int q = 0; q < plan->num_quantizers; q++) {
+        quantizer_quantize_sample(plan->quantizers[q], sample, plan->levels[q]);
+    }
+    for (int g = 0; g < plan->num_groups; g++) {
+        struct ensemble_group *group = &plan->groups[g];
+        encode_timestamp_levels(group->enc, plan->levels[group->quantizer],
+                                group->ring[t % ENSEMBLE_MAX_NGRAM]);
+    }
+}
+
+/**
+ * @brief Builds the n-gram ending in sample `t` of every member with at most `available` samples.
+ *
+ * @param ready Receives whether `plan->ngrams[m]` holds member `m`'s n-gram.
+ */
+static void compose_ngrams(struct ensemble_plan *plan, int t, int available, bool *ready) {
+    for (int m = 0; m < plan->num_members; m++) {
+        ready[m] = false;
+    }
+    for (int g = 0; g < plan->num_groups; g++) {
+        struct ensemble_group *group = &plan->groups[g];
+        vector_copy(plan->chain, group->ring[t % ENSEMBLE_MAX_NGRAM]);
+        int length = 1;
+        for (int i = 0; i < group->num_members; i++) {
+            int m = group->members[i];
+            int ngram_size = plan->members[m].ngram_size;
+            if (ngram_size > available) {
+                break;
+            }
+            for (; length < ngram_size; length++) {
+                permute(group->ring[(t - length) % ENSEMBLE_MAX_NGRAM], length, plan->rotated);
+                hdc_bind(plan->chain, plan->rotated, plan->spare);
+                Vector *swap = plan->chain;
+                plan->chain = plan->spare;
+                plan->spare = swap;
+            }
+            vector_copy(plan->ngrams[m], plan->chain);
+            ready[m] = true;
+        }
+    }
+}
+
+static void count_prediction(struct timeseries_eval_result *result, int *labels, int t, int window, int predicted) {
+    int ngram_start = t - window + 1;
+    int actual = mode(labels + ngram_start, window);
+    result->confusion_matrix[actual][predicted]++;
+    if (predicted == actual) {
+        result->correct++;
+    } else if (labels[ngram_start] != labels[t]) {
+        result->transition_error++;
+    } else {
+        result->not_correct++;
+    }
+}
+#endif
+
+/**
+ * @brief Trains every member of an ensemble in one sweep over the training data.
+ *
+ * Each member gets the model `train_model_timeseries` builds with its n-gram
+ * length: n-grams restart at every label change, every n-gram votes for the
+ * label of its newest sample, and the classes are the majority of their votes
+ * (the counters are kept, see `keep_counters`). Quantization and timestamp
+ * encoding are shared as described in the file comment.
+ *
+ * @param members The models; their associative memories are replaced.
+ * @param num_members Number of members, at most ENSEMBLE_MAX_MEMBERS.
+ * @param training_data Training samples, NUM_FEATURES values each.
+ * @param training_labels One label per sample.
+ * @param training_samples Number of samples.
+ * @return 0 on success, -1 on invalid members or in unsupported builds.
+ */
+int train_ensemble_timeseries(const struct ensemble_member *members,
+                              int num_members,
+                              double **training_data,
+                              int *training_labels,
+                              int training_samples) {
+#if BIPOLAR_MODE || MODEL_VARIANT == MODEL_VARIANT_KRISCHAN
+    (void)members;
+    (void)num_members;
+    (void)training_data;
+    (void)training_labels;
+    (void)training_samples;
+    fprintf(stderr, "train_ensemble_timeseries: binary, non-KRISCHAN builds only.\n");
+    return -1;
+#else
+    struct ensemble_plan plan;
+    if (plan_ensemble(&plan, members, num_members) != 0 || training_data == NULL || training_labels == NULL ||
+        training_samples < 0) {
+        free_plan(&plan);
+        return -1;
+    }
+
+    // As in the trainer, the last sample only closes the sweep.
+    int sweep_samples = training_samples > 1 ? training_samples - 1 : 0;
+    int nbits = bit_counter_planes(sweep_samples);
+    size_t counter_words = vector_storage_count() * (size_t)nbits;
+    uint64_t *planes = (uint64_t *)calloc((size_t)num_members * NUM_CLASSES * counter_words, sizeof(uint64_t));
+    int *counts = (int *)calloc((size_t)num_members * NUM_CLASSES, sizeof(int));
+    if (!planes || !counts) {
+        fprintf(stderr, "train_ensemble_timeseries: failed to allocate the class counters.\n");
+        free(planes);
+        free(counts);
+        free_plan(&plan);
+        return -1;
+    }
+
+    bool ready[ENSEMBLE_MAX_MEMBERS];
+    int run = 0;
+    for (int t = 0; t < sweep_samples; t++) {
+        if (t > 0 && training_labels[t] != training_labels[t - 1]) {
+            run = 0;
+        }
+        if (run < ENSEMBLE_MAX_NGRAM) {
+            run++;
+        }
+        push_timestamp(&plan, training_data[t], t);
+        int class_id = training_labels[t];
+        if (class_id < 0 || class_id >= NUM_CLASSES) {
+            continue;
+        }
+        compose_ngrams(&plan, t, run, ready);
+        for (int m = 0; m < num_members; m++) {
+            if (!ready[m]) {
+                continue;
+            }
+            size_t counter = (size_t)m * NUM_CLASSES + (size_t)class_id;
+            bit_counter_add(planes + counter * counter_words, nbits, plan.ngrams[m]);
+            counts[counter]++;
+        }
+    }
+
+    Vector *class_hv = create_vector();
+    for (int m = 0; m < num_members; m++) {
+        struct associative_memory *assoc_mem = members[m].assoc_mem;
+        for (int class_id = 0; class_id < NUM_CLASSES; class_id++) {
+            size_t counter = (size_t)m * NUM_CLASSES + (size_t)class_id;
+            bit_counter_threshold(planes + counter * counter_words, nbits, counts[counter] / 2, class_hv);
+            add_to_assoc_mem(assoc_mem, class_hv, class_id);
+            assoc_mem->counts[class_id] = counts[counter];
+        }
+        retain_assoc_mem_counters(assoc_mem, planes + (size_t)m * NUM_CLASSES * counter_words, nbits);
+#if ASSOC_MEM_PRUNE_DIMENSIONS
+        prune_assoc_mem(assoc_mem);
+#endif
+    }
+    free_vector(class_hv);
+    free(planes);
+    free(counts);
+    free_plan(&plan);
+    return 0;
+#endif
+}
+
+/**
+ * @brief Evaluates every member of an ensemble and their weighted vote in one sweep.
+ *
+ * Every member classifies the n-gram ending in each sample once it has
+ * `ngram_size` samples, exactly as `evaluate_model_timeseries_direct` would
+ * for that model. From the n-gram of the longest member on, the members' labels
+ * are combined: each adds its weight to the class it predicts and the heaviest
+ * class wins, ties going to the lower class id.
+ *
+ * @param members The trained models.
+ * @param num_members Number of members, at most ENSEMBLE_MAX_MEMBERS.
+ * @param testing_data Testing samples, NUM_FEATURES values each.
+ * @param testing_labels One label per sample.
+ * @param testing_samples Number of samples.
+ * @param result Receives the combined and the per-member results.
+ * @return 0 on success, -1 on invalid members, a sample no class matches, or in
+ *         unsupported builds.
+ */
+int evaluate_ensemble_timeseries(const struct ensemble_member *members,
+                                 int num_members,
+                                 double **testing_data,
+                                 int *testing_labels,
+                                 int testing_samples,
+                                 struct ensemble_eval_result *result) {
+#if BIPOLAR_MODE || MODEL_VARIANT == MODEL_VARIANT_KRISCHAN
+    (void)members;
+    (void)num_members;
+    (void)testing_data;
+    (void)testing_labels;
+    (void)testing_samples;
+    (void)result;
+    fprintf(stderr, "evaluate_ensemble_timeseries: binary, non-KRISCHAN builds only.\n");
+    return -1;
+#else
+    struct ensemble_plan plan;
+    if (plan_ensemble(&plan, members, num_members) != 0 || testing_data == NULL || testing_labels == NULL ||
+        testing_samples < 0 || result == NULL) {
+        free_plan(&plan);
+        return -1;
+    }
+    memset(result, 0, sizeof(*result));
+    result->quantizations = plan.num_quantizers;
+    result->encodings = plan.num_groups;
+
+    bool ready[ENSEMBLE_MAX_MEMBERS];
+    int predicted[ENSEMBLE_MAX_MEMBERS];
+    int status = 0;
+    for (int t = 0; t < testing_samples && status == 0; t++) {
+        int available = t + 1 < ENSEMBLE_MAX_NGRAM ? t + 1 : ENSEMBLE_MAX_NGRAM;
+        push_timestamp(&plan, testing_data[t], t);
+        compose_ngrams(&plan, t, available, ready);
+        for (int m = 0; m < num_members && status == 0; m++) {
+            if (!ready[m]) {
+                continue;
+            }
+            predicted[m] = classify(members[m].assoc_mem, plan.ngrams[m]);
+            if (predicted[m] < 0) {
+                fprintf(stderr, "evaluate_ensemble_timeseries: no class matches member %d at sample %d.\n", m, t);
+                status = -1;
+                break;
+            }
+            count_prediction(&result->members[m], testing_labels, t, members[m].ngram_size, predicted[m]);
+        }
+        if (status != 0 || t + 1 < plan.max_ngram) {
+            continue;
+        }
+
+        double votes[NUM_CLASSES] = {0.0};
+        for (int m = 0; m < num_members; m++) {
+            votes[predicted[m]] += members[m].weight;
+        }
+        int best = 0;
+        for (int c = 1; c < NUM_CLASSES; c++) {
+            if (votes[c] > votes[best]) {
+                best = c;
+            }
+        }
+        count_prediction(&result->combined, testing_labels, t, plan.max_ngram, best);
+    }
+
+    for (int m = 0; m < num_members; m++) {
+        finish_timeseries_eval_result(&result->members[m], members[m].assoc_mem);
+    }
+    finish_timeseries_eval_result(&result->combined, NULL);
+    free_plan(&plan);
+    return status;
+#endif
+}
@@ -0,0 +1,71 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#ifdef HAND_EMG
+#include "../hand/configHand.h"
+#elif defined(FOOT_EMG)
+#include "../foot/configFoot.h"
+#elif defined(CUSTOM)
+#include "../customModel/configCustom.h"
+#else
+#error "No EMG type defined. Please define HAND_EMG or FOOT_EMG."
+#endif
+
+#include "assoc_mem.h"
+#include "encoder.h"
+#include "evaluator.h"
+
+#ifndef ENSEMBLE_MAX_MEMBERS
+#define ENSEMBLE_MAX_MEMBERS 8 // models one ensemble combines
+#endif
+#ifndef ENSEMBLE_MAX_NGRAM
+#define ENSEMBLE_MAX_NGRAM 8 // longest member n-gram, the depth of the shared timestamp ring
+#endif
+
+/**
+ * @brief One model of an ensemble.
+ *
+ * - **enc**: Item memory and quantizer. Members whose encoders use the same
+ *   quantizer quantize each sample once; members that also share the item
+ *   memory share the timestamp encodings.
+ * - **assoc_mem**: The member's class vectors.
+ * - **ngram_size**: N-gram length, 1 to ENSEMBLE_MAX_NGRAM. A member with
+ *   N_GRAM_SIZE is the model `train_model_timeseries` builds.
+ * - **weight**: Vote weight in the combined prediction.
+ */
+struct ensemble_member {
+    struct encoder *enc;
+    struct associative_memory *assoc_mem;
+    int ngram_size;
+    double weight;
+};
+
+/**
+ * @brief Evaluation of an ensemble.
+ *
+ * - **combined**: The weighted vote, counted for the n-grams of the longest
+ *   member (the ground truth is the mode of its window).
+ * - **members**: Every member on its own, equal to its single-model evaluation.
+ * - **quantizations**, **encodings**: Samples quantized and timestamps encoded
+ *   per input sample: the distinct quantizers and item memories.
+ */
+struct ensemble_eval_result {
+    struct timeseries_eval_result combined;
+    struct timeseries_eval_result members[ENSEMBLE_MAX_MEMBERS];
+    int quantizations;
+    int encodings;
+};
+
+int train_ensemble_timeseries(const struct ensemble_member *members,
+                              int num_members,
+                              double **training_data,
+                              int *training_labels,
+                              int training_samples);
+int evaluate_ensemble_timeseries(const struct ensemble_member *members,
+                                 int num_members,
+                                 double **testing_data,
+                                 int *testing_labels,
+                                 int testing_samples,
+                                 struct ensemble_eval_result *result);
+
+#endif // ENSEMBLE_H
@@ -14,11 +14,15 @@
  * @author Marian Horn
  */
 #include "evaluator.h"
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "assoc_mem.h"
 #include "operations.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 int mode(int *array, int size) {
     int max_value = 0, max_count = 0, i, j;
@@ -87,47 +91,89 @@ static double compute_class_vector_similarity(const struct associative_memory *a
     }
     return sum / (double)pairs;
 }
+
 /**
- * @brief Evaluates the HDC model using a sliding window over time-series data.
- * 
- * @details
- * This function evaluates the performance of the HDC model on a time-series dataset 
- * by applying a sliding window approach. For each window, it determines the most 
- * frequent ground truth label, encodes the data for all N-grams in the window, and predicts the label of the N-gram with the 
- * highest similarity to the class vectors. Results are compared to the ground truth labels to calculate 
- * accuracy and generate a confusion matrix
- * 
- * @param enc A pointer to the encoder structure.
- * @param assoc_mem A pointer to the associative memory structure.
- * @param testing_data A 2D array of testing data.
- * @param testing_labels An array of ground truth labels for the testing data.
- * @param testing_samples The number of testing samples in the dataset.
- * 
- * @note The window's size is determined by WINDOW in config.h
+ * @brief Shards of a single-model evaluation: EVAL_SHARDS, or one per OpenMP thread.
+ *
+ * The result is capped so every shard covers at least EVAL_MIN_SHARD_SAMPLES
+ * of the `samples` samples.
  */
-struct timeseries_eval_result evaluate_model_timeseries_with_window(struct encoder *enc,
-                                                                    struct associative_memory *assoc_mem,
-                                                                    double **testing_data,
-                                                                    int *testing_labels,
-                                                                    int testing_samples) {
-    struct timeseries_eval_result result;
-    result.correct = 0;
-    result.not_correct = 0;
-    result.transition_error = 0;
-    result.total = 0;
-    result.overall_accuracy = 0.0;
-    result.class_average_accuracy = 0.0;
-    result.class_vector_similarity = 0.0;
-    memset(result.confusion_matrix, 0, sizeof(result.confusion_matrix));
+static int default_eval_shards(int samples) {
+#if EVAL_SHARDS > 0
+    int shards = EVAL_SHARDS;
+#elif defined(_OPENMP)
+    int shards = omp_get_max_threads();
+#else
+    int shards = 1;
+#endif
+    if (shards > samples / EVAL_MIN_SHARD_SAMPLES) {
+        shards = samples / EVAL_MIN_SHARD_SAMPLES;
+    }
+    return shards < 1 ? 1 : shards;
+}
+
+static void clear_eval_result(struct timeseries_eval_result *result) {
+    result->correct = 0;
+    result->not_correct = 0;
+    result->transition_error = 0;
+    result->total = 0;
+    result->overall_accuracy = 0.0;
+    result->class_average_accuracy = 0.0;
+    result->class_vector_similarity = 0.0;
+    memset(result->confusion_matrix, 0, sizeof(result->confusion_matrix));
+}
+
+/**
+ * @brief Adds the counters and the confusion matrix of a shard's result to `result`.
+ */
+static void add_eval_counts(struct timeseries_eval_result *result, const struct timeseries_eval_result *part) {
+    result->correct += part->correct;
+    result->not_correct += part->not_correct;
+    result->transition_error += part->transition_error;
+    for (int i = 0; i < NUM_CLASSES; i++) {
+        for (int j = 0; j < NUM_CLASSES; j++) {
+            result->confusion_matrix[i][j] += part->confusion_matrix[i][j];
+        }
+    }
+}
 
-    for (int j = 0; j < testing_samples-WINDOW; j+=WINDOW) {
+/**
+ * @brief Classifies the windows [first_window, last_window) of `evaluate_model_timeseries_with_window_ws`.
+ *
+ * Each window restarts the workspace's n-gram ring buffer and pushes its WINDOW
+ * samples through it, so every timestamp is encoded once per window and windows
+ * can be classified in any order. Only the counters and the confusion matrix of
+ * `result` are filled.
+ */
+static void evaluate_window_range(struct encoder *enc,
+                                  struct associative_memory *assoc_mem,
+                                  struct hdc_workspace *ws,
+                                  double **testing_data,
+                                  int *testing_labels,
+                                  int first_window,
+                                  int last_window,
+                                  struct timeseries_eval_result *result) {
+    clear_eval_result(result);
+    for (int window = first_window; window < last_window; window++) {
+        int j = window * WINDOW;
         int actual_label = mode(testing_labels + j, WINDOW);
         double max_similarity = -1.0;
         int best_predicted_label = -1;
 
+#if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN && !BIPOLAR_MODE
+        // The ring buffer composes slots in the opposite order of the KRISCHAN n-gram.
         for (int k = 0; k <= WINDOW - N_GRAM_SIZE; k++) {
-            Vector* sample_hv = create_vector();
-            int encoding_result = encode_timeseries(enc, &(testing_data[j+k]), sample_hv);
+            Vector* sample_hv = ws->sample;
+            int encoding_result = encode_timeseries_ws(enc, ws, &(testing_data[j+k]), sample_hv);
+#else
+        reset_ngram_encoder_state(&ws->ngram_state);
+        for (int k = 0; k < WINDOW; k++) {
+            Vector* sample_hv = ws->sample;
+            int encoding_result = push_ngram_encoder_sample(enc, &ws->ngram_state, testing_data[j+k], sample_hv);
+            if (encoding_result == 0) {
+                continue;
+            }
+#endif
             int predicted_label = classify(assoc_mem, sample_hv);
             if(predicted_label==-1){
                 printf("Encoding result: %i",encoding_result);
@@ -145,14 +191,74 @@ struct timeseries_eval_result evaluate_model_timeseries_with_window(struct encod
             max_similarity = confidence;
             best_predicted_label = predicted_label;
             }
-            free_vector(sample_hv);
         }
-        result.confusion_matrix[actual_label][best_predicted_label]++;
+        result->confusion_matrix[actual_label][best_predicted_label]++;
         
         if (best_predicted_label == actual_label) {
-            result.correct++;
-        }else{result.not_correct++;}
+            result->correct++;
+        }else{result->not_correct++;}
     }
+}
+/**
+ * @brief Evaluates the HDC model using a sliding window over time-series data.
+ * 
+ * @details
+ * This function evaluates the performance of the HDC model on a time-series dataset 
+ * by applying a sliding window approach. For each window, it determines the most 
+ * frequent ground truth label, encodes the data for all N-grams in the window, and predicts the label of the N-gram with the 
+ * highest similarity to the class vectors. Results are compared to the ground truth labels to calculate 
+ * accuracy and generate a confusion matrix
+ * 
+ * @param enc A pointer to the encoder structure.
+ * @param assoc_mem A pointer to the associative memory structure.
+ * @param ws The calling thread's scratch workspace; no allocation happens per n-gram.
+ * @param testing_data A 2D array of testing data.
+ * @param testing_labels An array of ground truth labels for the testing data.
+ * @param testing_samples The number of testing samples in the dataset.
+ * 
+ * @note The window's size is determined by WINDOW in config.h
+ */
+struct timeseries_eval_result evaluate_model_timeseries_with_window_ws(struct encoder *enc,
+                                                                       struct associative_memory *assoc_mem,
+                                                                       struct hdc_workspace *ws,
+                                                                       double **testing_data,
+                                                                       int *testing_labels,
+                                                                       int testing_samples) {
+    // Windows start every WINDOW samples while j < testing_samples - WINDOW.
+    int windows = testing_samples > WINDOW ? (testing_samples - 1) / WINDOW : 0;
+    int shards = default_eval_shards(windows * WINDOW);
+    struct timeseries_eval_result *partial =
+        (struct timeseries_eval_result *)malloc((size_t)shards * sizeof(*partial));
+    if (!partial) {
+        fprintf(stderr, "Failed to allocate evaluation shards.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Shard 0 uses the caller's workspace, the others bring their own.
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (shards > 1)
+#endif
+    for (int shard = 0; shard < shards; shard++) {
+        int first_window = (int)((long long)windows * shard / shards);
+        int last_window = (int)((long long)windows * (shard + 1) / shards);
+        struct hdc_workspace shard_ws;
+        struct hdc_workspace *shard_workspace = ws;
+        if (shard > 0) {
+            init_hdc_workspace(&shard_ws);
+            shard_workspace = &shard_ws;
+        }
+        evaluate_window_range(enc, assoc_mem, shard_workspace, testing_data, testing_labels,
+                              first_window, last_window, &partial[shard]);
+        if (shard > 0) {
+            free_hdc_workspace(&shard_ws);
+        }
+    }
+
+    struct timeseries_eval_result result = partial[0];
+    for (int shard = 1; shard < shards; shard++) {
+        add_eval_counts(&result, &partial[shard]);
+    }
+    free(partial);
     result.total = result.correct + result.not_correct;
     result.overall_accuracy = result.total > 0 ? (double)result.correct / (double)result.total : 0.0;
     result.class_average_accuracy = compute_class_average_accuracy(result.confusion_matrix);
@@ -184,6 +290,24 @@ struct timeseries_eval_result evaluate_model_timeseries_with_window(struct encod
     }
     return result;
 }
+/**
+ * @brief Evaluates the HDC model using a sliding window over time-series data.
+ *
+ * Convenience wrapper around `evaluate_model_timeseries_with_window_ws` that
+ * allocates a workspace for the duration of the call.
+ */
+struct timeseries_eval_result evaluate_model_timeseries_with_window(struct encoder *enc,
+                                                                    struct associative_memory *assoc_mem,
+                                                                    double **testing_data,
+                                                                    int *testing_labels,
+                                                                    int testing_samples) {
+    struct hdc_workspace ws;
+    init_hdc_workspace(&ws);
+    struct timeseries_eval_result result = evaluate_model_timeseries_with_window_ws(
+        enc, assoc_mem, &ws, testing_data, testing_labels, testing_samples);
+    free_hdc_workspace(&ws);
+    return result;
+}
 /**
  * @brief Directly evaluates the HDC model on a time-series dataset.
  * 
@@ -195,204 +319,650 @@ struct timeseries_eval_result evaluate_model_timeseries_with_window(struct encod
  * 
  * @param enc A pointer to the encoder structure.
  * @param assoc_mem A pointer to the associative memory structure.
- * @param testing_data A 2D array of testing data.
- * @param testing_labels An array of ground truth labels for the testing data.
- * @param testing_samples The number of testing samples in the dataset.
+ * @param ws The calling thread's scratch workspace; it is reset on entry and no
+ *           allocation happens per sample.
+ * @param dataset Quantized testing samples (NUM_FEATURES levels per row), e.g.
+ *                built once and reused for every GA candidate.
+ * @param testing_labels An array of ground truth labels, one per dataset row.
  */
-struct timeseries_eval_result evaluate_model_timeseries_direct(struct encoder *enc,
-                                                               struct associative_memory *assoc_mem,
-                                                               double **testing_data,
-                                                               int *testing_labels,
-                                                               int testing_samples) {
+struct timeseries_eval_result evaluate_model_timeseries_direct_quantized(struct encoder *enc,
+                                                                         struct associative_memory *assoc_mem,
+                                                                         struct hdc_workspace *ws,
+                                                                         const struct quantized_dataset *dataset,
+                                                                         int *testing_labels) {
+    // The single-model evaluation is sharded across the OpenMP threads.
     struct timeseries_eval_result result;
-    result.correct = 0;
-    result.not_correct = 0;
-    result.transition_error = 0;
-    result.total = 0;
-    result.overall_accuracy = 0.0;
-    result.class_average_accuracy = 0.0;
-    result.class_vector_similarity = 0.0;
-    memset(result.confusion_matrix, 0, sizeof(result.confusion_matrix));
+    evaluate_model_timeseries_direct_quantized_sharded(&enc, &assoc_mem, ws, 1, dataset, testing_labels, NULL, NULL,
+                                                       default_eval_shards(dataset ? dataset->num_samples : 0),
+                                                       &result);
+    return result;
+}
 
-    if (output_mode >= OUTPUT_DETAILED) {
-#if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN && !BIPOLAR_MODE
-        printf("Evaluating HDC-Model (rolling XOR) for %d testing samples.\n",testing_samples);
+/**
+ * @brief Same as `evaluate_model_timeseries_direct_quantized`, reading the timestamps from a `timestamp_cache`.
+ *
+ * The cache must hold the timestamps of `dataset` under the item memory of
+ * `enc` (see `timestamp_cache_matches`); only the n-grams are composed.
+ */
+struct timeseries_eval_result evaluate_model_timeseries_direct_cached(struct encoder *enc,
+                                                                      struct associative_memory *assoc_mem,
+                                                                      struct hdc_workspace *ws,
+                                                                      const struct quantized_dataset *dataset,
+                                                                      const struct timestamp_cache *cache,
+                                                                      int *testing_labels) {
+    if (dataset == NULL || cache == NULL || cache->num_samples != dataset->num_samples) {
+        fprintf(stderr, "Timestamp cache does not match the testing data.\n");
+        exit(EXIT_FAILURE);
+    }
+    struct timeseries_eval_result result;
+    evaluate_model_timeseries_direct_quantized_sharded(&enc, &assoc_mem, ws, 1, dataset, testing_labels, NULL,
+                                                       cache->timestamps, default_eval_shards(dataset->num_samples),
+                                                       &result);
+    return result;
+}
+
+/**
+ * @brief Directly evaluates several models on the same quantized time series in one pass.
+ *
+ * All models share one sweep over the data: each sample's level row is loaded once
+ * and pushed through every model's encoder, instead of streaming the dataset once
+ * per model. Each result is identical to
+ * `evaluate_model_timeseries_direct_quantized` on that model alone.
+ *
+ * @param encs Encoders, one per model.
+ * @param assoc_mems Associative memories, one per model.
+ * @param ws Workspaces, one per model; each is reset on entry.
+ * @param num_models Number of models evaluated together.
+ * @param dataset Quantized testing samples (NUM_FEATURES levels per row).
+ * @param testing_labels An array of ground truth labels, one per dataset row.
+ * @param deltas Optional (NULL, or NULL entries): per-model item-memory deltas
+ *        against `reference_timestamps`, see `push_ngram_encoder_delta`.
+ * @param reference_timestamps Reference timestamp encodings, one per dataset row;
+ *        only read for models with a delta. With `deltas` NULL they are the
+ *        timestamps of every model (e.g. a `timestamp_cache` built with their
+ *        shared item memory) and replace encoding altogether.
+ * @param results Receives one evaluation result per model.
+ *
+ * @note The KRISCHAN rolling variant ignores `deltas`.
+ */
+void evaluate_model_timeseries_direct_quantized_multi(struct encoder **encs,
+                                                      struct associative_memory **assoc_mems,
+                                                      struct hdc_workspace *ws,
+                                                      int num_models,
+                                                      const struct quantized_dataset *dataset,
+                                                      int *testing_labels,
+                                                      const struct encoder_delta *const *deltas,
+                                                      Vector *const *reference_timestamps,
+                                                      struct timeseries_eval_result *results) {
+    evaluate_model_timeseries_direct_quantized_sharded(encs, assoc_mems, ws, num_models, dataset, testing_labels,
+                                                       deltas, reference_timestamps, 1, results);
+}
+
+#if !(MODEL_VARIANT == MODEL_VARIANT_KRISCHAN && !BIPOLAR_MODE)
+/**
+ * @brief Classifies the `pending` buffered n-grams of every model and counts the outcomes.
+ *
+ * @param batch Buffered n-grams, EVAL_CLASSIFY_BATCH per model.
+ * @param batch_samples The sample each buffered n-gram ends in.
+ */
+static void flush_eval_batch(struct associative_memory **assoc_mems,
+                             int num_models,
+                             Vector **batch,
+                             const int *batch_samples,
+                             int pending,
+                             int *testing_labels,
+                             struct timeseries_eval_result *results) {
+    int predicted[EVAL_CLASSIFY_BATCH];
+    for (int model = 0; model < num_models; model++) {
+        struct timeseries_eval_result *result = &results[model];
+        Vector **queries = batch + (size_t)model * EVAL_CLASSIFY_BATCH;
+        classify_batch(assoc_mems[model], queries, pending, predicted, NULL);
+        for (int i = 0; i < pending; i++) {
+            int ngram_start = batch_samples[i] - N_GRAM_SIZE + 1;
+            int actual_label = mode(testing_labels + ngram_start, N_GRAM_SIZE);
+            int predicted_label = predicted[i];
+            if(predicted_label==-1){
+                printf("SampleHV number %i:\n",ngram_start);
+                print_vector(queries[i]);
+                fprintf(stderr, "Label not valid, terminating...");
+                exit(EXIT_FAILURE);
+            }
+
+            result->confusion_matrix[actual_label][predicted_label]++;
+
+            if (predicted_label == actual_label) {
+                result->correct++;
+            }else if(testing_labels[ngram_start]!=testing_labels[ngram_start+N_GRAM_SIZE-1])
+            {
+                result->transition_error++;
+
+            } else{result->not_correct++;}
+        }
+    }
+}
+
+/**
+ * @brief Counts the classifications of the n-grams ending in samples [begin, end).
+ *
+ * The workspaces are reset and the N_GRAM_SIZE - 1 samples before `begin` are
+ * pushed without being classified, so the counts equal those the sweep over the
+ * whole dataset collects for the range. The n-grams are buffered and classified
+ * EVAL_CLASSIFY_BATCH at a time with `classify_batch`. Only the counters and the
+ * confusion matrix of `results` are filled; they are zeroed on entry. `origin`
+ * is the position of row 0 in the whole recording and only used in messages.
+ */
+static void evaluate_quantized_range(struct encoder **encs,
+                                     struct associative_memory **assoc_mems,
+                                     struct hdc_workspace *ws,
+                                     int num_models,
+                                     const struct quantized_dataset *dataset,
+                                     int *testing_labels,
+                                     const struct encoder_delta *const *deltas,
+                                     Vector *const *reference_timestamps,
+                                     long long origin,
+                                     int begin,
+                                     int end,
+                                     struct timeseries_eval_result *results) {
+    for (int model = 0; model < num_models; model++) {
+        clear_eval_result(&results[model]);
+        reset_hdc_workspace(&ws[model]);
+    }
+
+    vector_element *batch_storage = NULL;
+    Vector **batch = create_vector_slab(num_models * EVAL_CLASSIFY_BATCH, &batch_storage);
+    int batch_samples[EVAL_CLASSIFY_BATCH];
+    int pending = 0;
+
+    int warmup = begin - (N_GRAM_SIZE - 1);
+    if (warmup < 0) {
+        warmup = 0;
+    }
+    for (int sample = warmup; sample < end; sample++) {
+        const quantized_level *levels = quantized_dataset_row(dataset, sample);
+        int encoding_result = 0;
+        for (int model = 0; model < num_models; model++) {
+            // Every model pushes the same samples, so their n-grams fill the same slot.
+            Vector* sample_hv = batch[(size_t)model * EVAL_CLASSIFY_BATCH + pending];
+            if (deltas && deltas[model]) {
+                encoding_result = push_ngram_encoder_delta(encs[model], &ws[model].ngram_state, deltas[model], levels,
+                                                           reference_timestamps[sample], sample_hv);
+            } else if (!deltas && reference_timestamps) {
+                encoding_result = push_ngram_encoder_timestamp(&ws[model].ngram_state, reference_timestamps[sample],
+                                                               sample_hv);
+            } else {
+                encoding_result = push_ngram_encoder_levels(encs[model], &ws[model].ngram_state, levels, sample_hv);
+            }
+            if (encoding_result < 0) {
+                fprintf(stderr, "Failed to encode testing ngram at sample %lld.\n", origin + sample);
+                exit(EXIT_FAILURE);
+            }
+        }
+        if (!encoding_result || sample < begin) {
+            continue;
+        }
+        batch_samples[pending++] = sample;
+        if (pending == EVAL_CLASSIFY_BATCH) {
+            flush_eval_batch(assoc_mems, num_models, batch, batch_samples, pending, testing_labels, results);
+            pending = 0;
+        }
+    }
+    if (pending > 0) {
+        flush_eval_batch(assoc_mems, num_models, batch, batch_samples, pending, testing_labels, results);
+    }
+    free_vector_slab(batch, batch_storage);
+}
 #else
-        printf("Evaluating HDC-Model for %d testing samples.\n",testing_samples);
-#endif
+/**
+ * @brief Counts the rolling-window classifications of samples [begin, end).
+ *
+ * The rolling window never resets, so replaying the N_GRAM_SIZE - 1 samples
+ * before `begin` rebuilds it exactly; window slots are indexed by the absolute
+ * sample position `origin + sample` as in a sweep over the whole recording. The workspace's n-gram
+ * ring buffer doubles as the rolling window. `deltas` are not used;
+ * `reference_timestamps` only without them (encoded timestamps shared by every model).
+ */
+static void evaluate_quantized_range(struct encoder **encs,
+                                     struct associative_memory **assoc_mems,
+                                     struct hdc_workspace *ws,
+                                     int num_models,
+                                     const struct quantized_dataset *dataset,
+                                     int *testing_labels,
+                                     const struct encoder_delta *const *deltas,
+                                     Vector *const *reference_timestamps,
+                                     long long origin,
+                                     int begin,
+                                     int end,
+                                     struct timeseries_eval_result *results) {
+    (void)deltas;
+    (void)reference_timestamps;
+    for (int model = 0; model < num_models; model++) {
+        clear_eval_result(&results[model]);
+        reset_hdc_workspace(&ws[model]);
     }
 
-#if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN && !BIPOLAR_MODE
     int window_size = N_GRAM_SIZE;
-    Vector *rolling_acc = create_vector();
-    Vector **window_vectors = (Vector **)malloc((size_t)window_size * sizeof(Vector *));
-    if (!rolling_acc || !window_vectors) {
-        fprintf(stderr, "Failed to allocate rolling evaluation buffers.\n");
-        exit(EXIT_FAILURE);
-    }
-    for (int i = 0; i < window_size; i++) {
-        window_vectors[i] = create_vector();
-    }
-
-    int window_filled = 0;
-    int window_pos = 0;
-
-    for (int i = 0; i < testing_samples; i++) {
-        Vector *sample_hv = create_vector();
-        Vector *rotated_hv = create_vector();
-        encode_timestamp(enc, testing_data[i], sample_hv);
-        permute(sample_hv, window_pos, rotated_hv);
-
-        if (window_filled < window_size) {
-            bind(rolling_acc, rotated_hv, rolling_acc);
-            vector_copy(window_vectors[window_pos], rotated_hv);
-            window_filled++;
-        } else {
-            bind(rolling_acc, window_vectors[window_pos], rolling_acc);
-            bind(rolling_acc, rotated_hv, rolling_acc);
-            vector_copy(window_vectors[window_pos], rotated_hv);
+    int warmup = begin - (window_size - 1);
+    if (warmup < 0) {
+        warmup = 0;
+    }
+    for (int sample = warmup; sample < end; sample++) {
+        const quantized_level *levels = quantized_dataset_row(dataset, sample);
+        long long position = origin + sample;
+        int window_pos = (int)(position % window_size);
+        int evict = sample - warmup >= window_size;
+        for (int model = 0; model < num_models; model++) {
+            struct timeseries_eval_result *result = &results[model];
+            Vector *rolling_acc = ws[model].ngram_state.ngram;
+            Vector *slot = ws[model].ngram_state.encoded_samples[window_pos];
+            Vector *sample_hv = ws[model].encoded;
+
+            if (!deltas && reference_timestamps) {
+                vector_copy(sample_hv, reference_timestamps[sample]);
+            } else {
+                encode_timestamp_levels(encs[model], levels, sample_hv);
+            }
+            if (evict) {
+                hdc_bind(rolling_acc, slot, rolling_acc);
+            }
+            // Rotate straight into the window slot; no separate rotated copy is needed.
+            permute(sample_hv, window_pos, slot);
+            hdc_bind(rolling_acc, slot, rolling_acc);
+
+            if (sample < begin || position < window_size - 1) {
+                continue;
+            }
+            int actual_label = testing_labels[sample];
+            int predicted_label = classify(assoc_mems[model], rolling_acc);
+            if (predicted_label < 0) {
+                fprintf(stderr, "Label not valid, terminating...");
+                exit(EXIT_FAILURE);
+            }
+            result->confusion_matrix[actual_label][predicted_label]++;
+            if (predicted_label == actual_label) {
+                result->correct++;
+            } else {
+                result->not_correct++;
+            }
         }
-
-        window_pos = (window_pos + 1) % window_size;
-
-        if (i >= window_size - 1) {
-            int actual_label = testing_labels[i];
-            int predicted_label = classify(assoc_mem, rolling_acc);
-            if (predicted_label < 0) {
-                fprintf(stderr, "Label not valid, terminating...");
-                exit(EXIT_FAILURE);
-            }
-            result.confusion_matrix[actual_label][predicted_label]++;
-            if (predicted_label == actual_label) {
-                result.correct++;
-            } else {
-                result.not_correct++;
-            }
-        }
-
-        free_vector(rotated_hv);
-        free_vector(sample_hv);
-    }
-
-    // Match colleague reporting: denominator is total test samples even with warm-up skipped.
-    result.total = (size_t)testing_samples;
-    result.overall_accuracy =
-        testing_samples > 0 ? (double)result.correct / (double)testing_samples : 0.0;
-    result.class_average_accuracy = compute_class_average_accuracy(result.confusion_matrix);
-    result.class_vector_similarity = compute_class_vector_similarity(assoc_mem);
-
+    }
+}
+#endif
+
+/**
+ * @brief Derives the accuracies of a model's summed counters and prints them.
+ *
+ * @param testing_samples Samples in the testing recording (the KRISCHAN denominator).
+ */
+static void finish_eval_result(struct timeseries_eval_result *result,
+                               const struct associative_memory *assoc_mem,
+                               int testing_samples) {
+#if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN && !BIPOLAR_MODE
+    // Match colleague reporting: denominator is total test samples even with warm-up skipped.
+    result->total = (size_t)testing_samples;
+    result->overall_accuracy =
+        testing_samples > 0 ? (double)result->correct / (double)testing_samples : 0.0;
+#else
+    (void)testing_samples;
+    result->total = result->correct + result->not_correct + result->transition_error;
+    result->overall_accuracy = result->total > 0 ? (double)result->correct / (double)result->total : 0.0;
+#endif
+    result->class_average_accuracy = compute_class_average_accuracy(result->confusion_matrix);
+    result->class_vector_similarity = compute_class_vector_similarity(assoc_mem);
     if (output_mode >= OUTPUT_DETAILED) {
-        printf("Testing accuracy: %.3f%%\n", result.overall_accuracy * 100.0);
-        printf("Class-average accuracy: %.3f%%\n", result.class_average_accuracy * 100.0);
-        printf("Class vector similarity: %.3f\n", result.class_vector_similarity);
+#if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN && !BIPOLAR_MODE
+        printf("Testing accuracy: %.3f%%\n", result->overall_accuracy * 100.0);
+        printf("Class-average accuracy: %.3f%%\n", result->class_average_accuracy * 100.0);
+        printf("Class vector similarity: %.3f\n", result->class_vector_similarity);
         printf("Total: %ld of %d samples correctly classified\n",
-               result.correct,
+               result->correct,
                testing_samples);
+#else
+        int number_total_tests = (int)result->total;
+        float accuracy = number_total_tests > 0 ? (float)result->correct / (number_total_tests) : 0.0f;
+        float accuracyTranz = number_total_tests > 0
+            ? ((float)result->correct + (float)result->transition_error) / (number_total_tests)
+            : 0.0f;
+        printf("Testing accuracy: %.3f%%\n", accuracy * 100);
+
+        printf("Accuracy excluding gesture transitions: %.3f%%\n",accuracyTranz*100);
+        printf("Class-average accuracy: %.3f%%\n", result->class_average_accuracy * 100.0);
+        printf("Class vector similarity: %.3f\n", result->class_vector_similarity);
+        printf("Total: %ld of %d ngrams correctly classified\n",result->correct,number_total_tests);
+        printf("Transition error: %ld\n",result->transition_error);
+#endif
         if (output_mode >= OUTPUT_DEBUG) {
             printf("Confusion Matrix:\n");
             printf("True\\Predicted\n");
             for (int i = 0; i < NUM_CLASSES; i++) {
                 printf("\t%d", i);
             }
-            printf("\n");
-            for (int i = 0; i < NUM_CLASSES; i++) {
-                printf("%d", i);
-                for (int j = 0; j < NUM_CLASSES; j++) {
-                    printf("\t%d", result.confusion_matrix[i][j]);
-                }
-                printf("\n");
-            }
-        }
-    }
-
-    for (int i = 0; i < window_size; i++) {
-        free_vector(window_vectors[i]);
-    }
-    free(window_vectors);
-    free_vector(rolling_acc);
-#else
-    Vector* sample_hv = create_vector();
-    struct ngram_encoder_state ngram_state;
-    init_ngram_encoder_state(&ngram_state);
-    for (int sample = 0; sample < testing_samples; sample++) {
-        int encoding_result = push_ngram_encoder_sample(enc, &ngram_state, testing_data[sample], sample_hv);
-        if (encoding_result < 0) {
-            fprintf(stderr, "Failed to encode testing ngram at sample %d.\n", sample);
-            free_ngram_encoder_state(&ngram_state);
-            free_vector(sample_hv);
-            exit(EXIT_FAILURE);
+            printf("\n");
+            for (int i = 0; i < NUM_CLASSES; i++) {
+                printf("%d", i);
+                for (int j = 0; j < NUM_CLASSES; j++) {
+                    printf("\t%d", result->confusion_matrix[i][j]);
+                }
+                printf("\n");
+            }
         }
-        if (!encoding_result) {
-            continue;
+    }
+}
+
+/**
+ * @brief Completes a result whose counters and confusion matrix were filled by the caller.
+ *
+ * Fills the total, the accuracies and the class vector similarity of
+ * `assoc_mem` (0 when NULL), as the evaluators do for their own counts.
+ */
+void finish_timeseries_eval_result(struct timeseries_eval_result *result, const struct associative_memory *assoc_mem) {
+    finish_eval_result(result, assoc_mem, (int)(result->correct + result->not_correct + result->transition_error));
+}
+
+/**
+ * @brief Sample sweep split into shards with private evaluation counters.
+ *
+ * Shard 0 writes into `results` using the caller's workspaces; shard `s > 0`
+ * writes into `partial[(s - 1) * num_models + model]`.
+ */
+struct evaluation_sweep {
+    struct encoder **encs;
+    struct associative_memory **assoc_mems;
+    struct hdc_workspace *ws;
+    int num_models;
+    const struct quantized_dataset *dataset;
+    int *testing_labels;
+    const struct encoder_delta *const *deltas;
+    Vector *const *reference_timestamps;
+    int shards;
+    struct timeseries_eval_result *results;
+    struct timeseries_eval_result *partial;
+};
+
+/**
+ * @brief Classifies every shard of `sweep`.
+ *
+ * Under OpenMP every shard but the first becomes a task with workspaces of its
+ * own; shard 0 runs on the calling thread once the others are queued.
+ */
+static void run_evaluation_shards(struct evaluation_sweep *sweep) {
+    int testing_samples = sweep->dataset->num_samples;
+    int num_models = sweep->num_models;
+    for (int shard = sweep->shards - 1; shard >= 0; shard--) {
+        int begin = (int)((long long)testing_samples * shard / sweep->shards);
+        int end = (int)((long long)testing_samples * (shard + 1) / sweep->shards);
+#ifdef _OPENMP
+#pragma omp task firstprivate(shard, begin, end) if (shard > 0)
+#endif
+        {
+            if (shard == 0) {
+                evaluate_quantized_range(sweep->encs, sweep->assoc_mems, sweep->ws, num_models, sweep->dataset,
+                                         sweep->testing_labels, sweep->deltas, sweep->reference_timestamps,
+                                         0, begin, end, sweep->results);
+            } else {
+                struct hdc_workspace *shard_ws = (struct hdc_workspace *)malloc((size_t)num_models * sizeof(*shard_ws));
+                if (!shard_ws) {
+                    fprintf(stderr, "Failed to allocate evaluation workspaces.\n");
+                    exit(EXIT_FAILURE);
+                }
+                for (int model = 0; model < num_models; model++) {
+                    init_hdc_workspace(&shard_ws[model]);
+                }
+                evaluate_quantized_range(sweep->encs, sweep->assoc_mems, shard_ws, num_models, sweep->dataset,
+                                         sweep->testing_labels, sweep->deltas, sweep->reference_timestamps,
+                                         0, begin, end, &sweep->partial[(size_t)(shard - 1) * (size_t)num_models]);
+                for (int model = 0; model < num_models; model++) {
+                    free_hdc_workspace(&shard_ws[model]);
+                }
+                free(shard_ws);
+            }
         }
+    }
+#ifdef _OPENMP
+#pragma omp taskwait
+#endif
+}
 
-        int ngram_start = sample - N_GRAM_SIZE + 1;
-        int actual_label = mode(testing_labels + ngram_start, N_GRAM_SIZE);
-        int predicted_label = classify(assoc_mem, sample_hv);
-        if(predicted_label==-1){
-            printf("Encoding result: %i",encoding_result);
-            printf("SampleHV number %i:\n",ngram_start);
-            print_vector(sample_hv);
-            fprintf(stderr, "Label not valid, terminating...");
-            free_ngram_encoder_state(&ngram_state);
-            free_vector(sample_hv);
-            exit(EXIT_FAILURE);
+/**
+ * @brief Same as `evaluate_model_timeseries_direct_quantized_multi`, splitting the sweep into data shards.
+ *
+ * The samples are split into `shards` contiguous ranges that are classified
+ * independently and whose counters are summed. Under OpenMP the shards run as
+ * tasks: inside a parallel region idle threads of that region help with them,
+ * otherwise a parallel region is opened for the sweep. The results are
+ * identical for every shard count.
+ *
+ * @param ws Workspaces, one per model, used by the first shard.
+ * @param shards Requested number of shards; capped so every shard covers at
+ *        least EVAL_MIN_SHARD_SAMPLES samples. 1 runs the plain sweep.
+ */
+void evaluate_model_timeseries_direct_quantized_sharded(struct encoder **encs,
+                                                        struct associative_memory **assoc_mems,
+                                                        struct hdc_workspace *ws,
+                                                        int num_models,
+                                                        const struct quantized_dataset *dataset,
+                                                        int *testing_labels,
+                                                        const struct encoder_delta *const *deltas,
+                                                        Vector *const *reference_timestamps,
+                                                        int shards,
+                                                        struct timeseries_eval_result *results) {
+    if (dataset == NULL || dataset->num_features != NUM_FEATURES) {
+        fprintf(stderr, "Invalid quantized testing dataset.\n");
+        exit(EXIT_FAILURE);
+    }
+    int testing_samples = dataset->num_samples;
+    if (output_mode >= OUTPUT_DETAILED) {
+        for (int model = 0; model < num_models; model++) {
+#if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN && !BIPOLAR_MODE
+            printf("Evaluating HDC-Model (rolling XOR) for %d testing samples.\n",testing_samples);
+#else
+            printf("Evaluating HDC-Model for %d testing samples.\n",testing_samples);
+#endif
         }
-        double confidence = similarity_check(sample_hv,get_class_vector(assoc_mem,predicted_label));
-        if(confidence==-2){
-            fprintf(stderr,"Got invalid cosine similarity\nTerminating...");
-            free_ngram_encoder_state(&ngram_state);
-            free_vector(sample_hv);
+    }
+    if (shards > testing_samples / EVAL_MIN_SHARD_SAMPLES) {
+        shards = testing_samples / EVAL_MIN_SHARD_SAMPLES;
+    }
+    if (shards < 1) {
+        shards = 1;
+    }
+
+    struct timeseries_eval_result *partial = NULL;
+    if (shards > 1) {
+        partial = (struct timeseries_eval_result *)malloc((size_t)(shards - 1) * (size_t)num_models * sizeof(*partial));
+        if (!partial) {
+            fprintf(stderr, "Failed to allocate evaluation shards.\n");
             exit(EXIT_FAILURE);
         }
+    }
 
-        result.confusion_matrix[actual_label][predicted_label]++;
-        
-        if (predicted_label == actual_label) {
-            result.correct++;
-        }else if(testing_labels[ngram_start]!=testing_labels[ngram_start+N_GRAM_SIZE-1])
+    struct evaluation_sweep sweep = {encs, assoc_mems, ws, num_models, dataset, testing_labels,
+                                     deltas, reference_timestamps, shards, results, partial};
+#ifdef _OPENMP
+    if (shards > 1 && !omp_in_parallel()) {
+#pragma omp parallel
         {
-            result.transition_error++;
+#pragma omp single
+            run_evaluation_shards(&sweep);
+        }
+    } else {
+        run_evaluation_shards(&sweep);
+    }
+#else
+    run_evaluation_shards(&sweep);
+#endif
 
-        } else{result.not_correct++;}
+    for (int shard = 1; shard < shards; shard++) {
+        for (int model = 0; model < num_models; model++) {
+            add_eval_counts(&results[model], &partial[(size_t)(shard - 1) * (size_t)num_models + model]);
+        }
     }
-    free_ngram_encoder_state(&ngram_state);
-    free_vector(sample_hv);
+    free(partial);
 
-    result.total = result.correct + result.not_correct + result.transition_error;
-    result.overall_accuracy = result.total > 0 ? (double)result.correct / (double)result.total : 0.0;
-    result.class_average_accuracy = compute_class_average_accuracy(result.confusion_matrix);
-    result.class_vector_similarity = compute_class_vector_similarity(assoc_mem);
-    if (output_mode >= OUTPUT_DETAILED) {
-        int number_total_tests = (int)result.total;
-        float accuracy = number_total_tests > 0 ? (float)result.correct / (number_total_tests) : 0.0f;
-        float accuracyTranz = number_total_tests > 0
-            ? ((float)result.correct + (float)result.transition_error) / (number_total_tests)
-            : 0.0f;
-        printf("Testing accuracy: %.3f%%\n", accuracy * 100);
+    for (int model = 0; model < num_models; model++) {
+        finish_eval_result(&results[model], assoc_mems[model], testing_samples);
+    }
+}
 
-        printf("Accuracy excluding gesture transitions: %.3f%%\n",accuracyTranz*100);
-        printf("Class-average accuracy: %.3f%%\n", result.class_average_accuracy * 100.0);
-        printf("Class vector similarity: %.3f\n", result.class_vector_similarity);
-        printf("Total: %ld of %d ngrams correctly classified\n",result.correct,number_total_tests);
-        printf("Transition error: %ld\n",result.transition_error);
-        if (output_mode >= OUTPUT_DEBUG) {
-            printf("Confusion Matrix:\n");
-            printf("True\\Predicted\n");
-            for (int i = 0; i < NUM_CLASSES; i++) {
-                printf("\t%d", i);
-            }
-            printf("\n");
-            for (int i = 0; i < NUM_CLASSES; i++) {
-                printf("%d", i);
-                for (int j = 0; j < NUM_CLASSES; j++) {
-                    printf("\t%d", result.confusion_matrix[i][j]);
-                }
-                printf("\n");
-            }
-        }
+/**
+ * @brief Directly evaluates the HDC model on raw time-series data with a caller-owned workspace.
+ *
+ * Quantizes `testing_data` once and runs `evaluate_model_timeseries_direct_quantized`.
+ */
+struct timeseries_eval_result evaluate_model_timeseries_direct_ws(struct encoder *enc,
+                                                                  struct associative_memory *assoc_mem,
+                                                                  struct hdc_workspace *ws,
+                                                                  double **testing_data,
+                                                                  int *testing_labels,
+                                                                  int testing_samples) {
+    struct quantized_dataset dataset;
+    if (init_quantized_dataset_for(enc->quantizer, &dataset, testing_data, testing_samples, NUM_FEATURES) != 0) {
+        fprintf(stderr, "Failed to quantize testing data.\n");
+        exit(EXIT_FAILURE);
     }
-#endif
+    struct timeseries_eval_result result =
+        evaluate_model_timeseries_direct_quantized(enc, assoc_mem, ws, &dataset, testing_labels);
+    free_quantized_dataset(&dataset);
+    return result;
+}
+
+/**
+ * @brief Directly evaluates the HDC model on a time-series dataset.
+ *
+ * Convenience wrapper around `evaluate_model_timeseries_direct_ws` that
+ * allocates a workspace for the duration of the call.
+ */
+struct timeseries_eval_result evaluate_model_timeseries_direct(struct encoder *enc,
+                                                               struct associative_memory *assoc_mem,
+                                                               double **testing_data,
+                                                               int *testing_labels,
+                                                               int testing_samples) {
+    struct hdc_workspace ws;
+    init_hdc_workspace(&ws);
+    struct timeseries_eval_result result = evaluate_model_timeseries_direct_ws(
+        enc, assoc_mem, &ws, testing_data, testing_labels, testing_samples);
+    free_hdc_workspace(&ws);
+    return result;
+}
+
+/**
+ * @brief Directly evaluates the HDC model on a float32 sample matrix or strided view.
+ *
+ * Same as `evaluate_model_timeseries_direct`; a `down_sample_matrix` view is
+ * consumed in place.
+ */
+struct timeseries_eval_result evaluate_model_timeseries_direct_matrix(struct encoder *enc,
+                                                                      struct associative_memory *assoc_mem,
+                                                                      const struct sample_matrix *testing_data,
+                                                                      int *testing_labels) {
+    struct quantized_dataset dataset;
+    if (init_quantized_dataset_from_matrix(enc->quantizer, &dataset, testing_data) != 0) {
+        fprintf(stderr, "Failed to quantize testing data.\n");
+        exit(EXIT_FAILURE);
+    }
+    struct hdc_workspace ws;
+    init_hdc_workspace(&ws);
+    struct timeseries_eval_result result =
+        evaluate_model_timeseries_direct_quantized(enc, assoc_mem, &ws, &dataset, testing_labels);
+    free_hdc_workspace(&ws);
+    free_quantized_dataset(&dataset);
+    return result;
+}
+
+/**
+ * @brief Directly evaluates the HDC model on a dataset delivered chunk by chunk.
+ *
+ * Each chunk is quantized into a window that keeps the last N_GRAM_SIZE - 1
+ * rows of the previous chunk, so n-grams spanning chunk boundaries are
+ * classified exactly as by `evaluate_model_timeseries_direct_matrix` on the
+ * whole recording. Within a chunk the samples are split into shards with
+ * workspaces of their own, and the stream's prefetch reads the next chunk
+ * meanwhile.
+ *
+ * @param stream The testing data; consumed to its end (reset it to evaluate again).
+ */
+struct timeseries_eval_result evaluate_model_timeseries_direct_stream(struct encoder *enc,
+                                                                      struct associative_memory *assoc_mem,
+                                                                      struct dataset_stream *stream) {
+    if (!quantizer_fitted(enc->quantizer)) {
+        fprintf(stderr, "quantizer: streamed evaluation requested before fit.\n");
+        exit(EXIT_FAILURE);
+    }
+    int history = N_GRAM_SIZE - 1;
+    size_t chunk_rows = dataset_stream_chunk_rows(stream);
+    if (chunk_rows > (size_t)(INT_MAX - history)) {
+        fprintf(stderr, "Stream chunks too large for evaluation.\n");
+        exit(EXIT_FAILURE);
+    }
+    int capacity = history + (int)chunk_rows;
+    int shards = default_eval_shards((int)chunk_rows);
+
+    struct quantized_dataset window = {NULL, 0, NUM_FEATURES};
+    window.levels = (quantized_level *)malloc((size_t)capacity * NUM_FEATURES * sizeof(quantized_level));
+    int *window_labels = (int *)malloc((size_t)capacity * sizeof(int));
+    struct hdc_workspace *ws = (struct hdc_workspace *)malloc((size_t)shards * sizeof(*ws));
+    struct timeseries_eval_result *partial = (struct timeseries_eval_result *)malloc((size_t)shards * sizeof(*partial));
+    if (!window.levels || !window_labels || !ws || !partial) {
+        fprintf(stderr, "Failed to allocate streamed evaluation buffers.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int shard = 0; shard < shards; shard++) {
+        init_hdc_workspace(&ws[shard]);
+    }
+
+    struct timeseries_eval_result result;
+    clear_eval_result(&result);
+    long long origin = 0;  // recording position of window row 0
+    int carried = 0;
+    struct sample_matrix chunk;
+    const int *labels;
+    long rows;
+    while ((rows = dataset_stream_next_chunk(stream, &chunk, &labels)) > 0) {
+        for (long row = 0; row < rows; row++) {
+            quantizer_quantize_sample_f(enc->quantizer, sample_matrix_row(&chunk, (size_t)row),
+                                        window.levels + (size_t)(carried + row) * NUM_FEATURES);
+        }
+        memcpy(window_labels + carried, labels, (size_t)rows * sizeof(int));
+        window.num_samples = carried + (int)rows;
+
+        int begin = carried;
+        int end = window.num_samples;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (shards > 1)
+#endif
+        for (int shard = 0; shard < shards; shard++) {
+            int shard_begin = begin + (int)((long long)(end - begin) * shard / shards);
+            int shard_end = begin + (int)((long long)(end - begin) * (shard + 1) / shards);
+            evaluate_quantized_range(&enc, &assoc_mem, &ws[shard], 1, &window, window_labels, NULL, NULL,
+                                     origin, shard_begin, shard_end, &partial[shard]);
+        }
+        for (int shard = 0; shard < shards; shard++) {
+            add_eval_counts(&result, &partial[shard]);
+        }
+
+        int keep = window.num_samples < history ? window.num_samples : history;
+        int drop = window.num_samples - keep;
+        memmove(window.levels, window.levels + (size_t)drop * NUM_FEATURES, (size_t)keep * NUM_FEATURES * sizeof(quantized_level));
+        memmove(window_labels, window_labels + drop, (size_t)keep * sizeof(int));
+        origin += drop;
+        carried = keep;
+    }
+    if (rows < 0) {
+        fprintf(stderr, "Failed to read testing data stream.\n");
+        exit(EXIT_FAILURE);
+    }
+    long long testing_samples = origin + carried;
+    if (output_mode >= OUTPUT_DETAILED) {
+        printf("Evaluated HDC-Model on %lld streamed testing samples.\n", testing_samples);
+    }
+    finish_eval_result(&result, assoc_mem, testing_samples < INT_MAX ? (int)testing_samples : INT_MAX);
+
+    for (int shard = 0; shard < shards; shard++) {
+        free_hdc_workspace(&ws[shard]);
+    }
+    free(ws);
+    free(partial);
+    free(window.levels);
+    free(window_labels);
     return result;
 }
 
@@ -418,43 +988,56 @@ struct timeseries_eval_result evaluate_model_general_direct(struct encoder *enc,
     if (output_mode >= OUTPUT_DETAILED) {
         printf("Evaluating HDC-Model for %d testing samples.\n",testing_samples);
     }
-    struct timeseries_eval_result result;
-    result.correct = 0;
-    result.not_correct = 0;
-    result.transition_error = 0;
-    result.total = 0;
-    result.overall_accuracy = 0.0;
-    result.class_average_accuracy = 0.0;
-    result.class_vector_similarity = 0.0;
-    memset(result.confusion_matrix, 0, sizeof(result.confusion_matrix));
+    int shards = default_eval_shards(testing_samples);
+    struct timeseries_eval_result *partial =
+        (struct timeseries_eval_result *)malloc((size_t)shards * sizeof(*partial));
+    if (!partial) {
+        fprintf(stderr, "Failed to allocate evaluation shards.\n");
+        exit(EXIT_FAILURE);
+    }
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (shards > 1)
+#endif
+    for (int shard = 0; shard < shards; shard++) {
+        int begin = (int)((long long)testing_samples * shard / shards);
+        int end = (int)((long long)testing_samples * (shard + 1) / shards);
+        struct timeseries_eval_result *part = &partial[shard];
+        clear_eval_result(part);
 
-    for (int j = 0; j < testing_samples; j++) {
-        int actual_label = testing_labels[j];
         Vector* sample_hv = create_vector();
-        int encoding_result = encode_general_data(enc, testing_data[j], sample_hv);
-        int predicted_label = classify(assoc_mem, sample_hv);
-        if(predicted_label==-1){
-            printf("Encoding result: %i",encoding_result);
-            printf("SampleHV number %i:\n",j);
-            print_vector(sample_hv);
-            fprintf(stderr, "Label not valid, terminating...");
-            exit(EXIT_FAILURE);
-        }
-        double confidence = similarity_check(sample_hv,get_class_vector(assoc_mem,predicted_label));
-        if(confidence==-2){
-            fprintf(stderr,"Got invalid cosine similarity\nTerminating...");
-            exit(EXIT_FAILURE);
-        }
+        for (int j = begin; j < end; j++) {
+            int actual_label = testing_labels[j];
+            int encoding_result = encode_general_data(enc, testing_data[j], sample_hv);
+            int predicted_label = classify(assoc_mem, sample_hv);
+            if(predicted_label==-1){
+                printf("Encoding result: %i",encoding_result);
+                printf("SampleHV number %i:\n",j);
+                print_vector(sample_hv);
+                fprintf(stderr, "Label not valid, terminating...");
+                exit(EXIT_FAILURE);
+            }
+            double confidence = similarity_check(sample_hv,get_class_vector(assoc_mem,predicted_label));
+            if(confidence==-2){
+                fprintf(stderr,"Got invalid cosine similarity\nTerminating...");
+                exit(EXIT_FAILURE);
+            }
 
+            part->confusion_matrix[actual_label][predicted_label]++;
+            
+            if (predicted_label == actual_label) {
+                part->correct++;
+            }else{part->not_correct++;}
+        }
         free_vector(sample_hv);
-        result.confusion_matrix[actual_label][predicted_label]++;
-        
-        if (predicted_label == actual_label) {
-            result.correct++;
-        }else{result.not_correct++;}
     }
 
+    struct timeseries_eval_result result = partial[0];
+    for (int shard = 1; shard < shards; shard++) {
+        add_eval_counts(&result, &partial[shard]);
+    }
+    free(partial);
+
     result.total = result.correct + result.not_correct;
     result.overall_accuracy = result.total > 0 ? (double)result.correct / (double)result.total : 0.0;
     result.class_average_accuracy = compute_class_average_accuracy(result.confusion_matrix);
@@ -14,8 +14,21 @@
 
 #include "assoc_mem.h"
 #include "encoder.h"
+#include "sample_stream.h"
+#include "timestamp_cache.h"
+#include "workspace.h"
 #include <stddef.h>
 
+#ifndef EVAL_MIN_SHARD_SAMPLES
+#define EVAL_MIN_SHARD_SAMPLES 512 // smallest sample range worth an evaluation shard of its own
+#endif
+#ifndef EVAL_CLASSIFY_BATCH
+#define EVAL_CLASSIFY_BATCH 32 // n-grams buffered per model before classify_batch runs
+#endif
+#ifndef EVAL_SHARDS
+#define EVAL_SHARDS 0 // shards of a single-model evaluation (0: one per OpenMP thread)
+#endif
+
 struct timeseries_eval_result {
     size_t correct;
     size_t not_correct;
@@ -27,6 +40,11 @@ struct timeseries_eval_result {
     int confusion_matrix[NUM_CLASSES][NUM_CLASSES];
 };
 
+// Most frequent label of `size` labels, ties going to the smallest
+int mode(int *array, int size);
+// Derive the accuracies and class vector similarity of summed counts
+void finish_timeseries_eval_result(struct timeseries_eval_result *result, const struct associative_memory *assoc_mem);
+
 struct timeseries_eval_result evaluate_model_timeseries_with_window(struct encoder *enc,
                                                                     struct associative_memory *assMem,
                                                                     double **testingData,
@@ -37,6 +55,55 @@ struct timeseries_eval_result evaluate_model_timeseries_direct(struct encoder *e
                                                                double **testingData,
                                                                int *testingLabels,
                                                                int testingSamples);
+struct timeseries_eval_result evaluate_model_timeseries_direct_matrix(struct encoder *enc,
+                                                                      struct associative_memory *assMem,
+                                                                      const struct sample_matrix *testingData,
+                                                                      int *testingLabels);
+struct timeseries_eval_result evaluate_model_timeseries_direct_stream(struct encoder *enc,
+                                                                      struct associative_memory *assMem,
+                                                                      struct dataset_stream *stream);
+struct timeseries_eval_result evaluate_model_timeseries_with_window_ws(struct encoder *enc,
+                                                                       struct associative_memory *assMem,
+                                                                       struct hdc_workspace *ws,
+                                                                       double **testingData,
+                                                                       int *testingLabels,
+                                                                       int testingSamples);
+struct timeseries_eval_result evaluate_model_timeseries_direct_ws(struct encoder *enc,
+                                                                  struct associative_memory *assMem,
+                                                                  struct hdc_workspace *ws,
+                                                                  double **testingData,
+                                                                  int *testingLabels,
+                                                                  int testingSamples);
+struct timeseries_eval_result evaluate_model_timeseries_direct_quantized(struct encoder *enc,
+                                                                         struct associative_memory *assMem,
+                                                                         struct hdc_workspace *ws,
+                                                                         const struct quantized_dataset *dataset,
+                                                                         int *testingLabels);
+struct timeseries_eval_result evaluate_model_timeseries_direct_cached(struct encoder *enc,
+                                                                      struct associative_memory *assMem,
+                                                                      struct hdc_workspace *ws,
+                                                                      const struct quantized_dataset *dataset,
+                                                                      const struct timestamp_cache *cache,
+                                                                      int *testingLabels);
+void evaluate_model_timeseries_direct_quantized_multi(struct encoder **encs,
+                                                      struct associative_memory **assMems,
+                                                      struct hdc_workspace *ws,
+                                                      int numModels,
+                                                      const struct quantized_dataset *dataset,
+                                                      int *testingLabels,
+                                                      const struct encoder_delta *const *deltas,
+                                                      Vector *const *referenceTimestamps,
+                                                      struct timeseries_eval_result *results);
+void evaluate_model_timeseries_direct_quantized_sharded(struct encoder **encs,
+                                                        struct associative_memory **assMems,
+                                                        struct hdc_workspace *ws,
+                                                        int numModels,
+                                                        const struct quantized_dataset *dataset,
+                                                        int *testingLabels,
+                                                        const struct encoder_delta *const *deltas,
+                                                        Vector *const *referenceTimestamps,
+                                                        int shards,
+                                                        struct timeseries_eval_result *results);
 struct timeseries_eval_result evaluate_model_general_direct(struct encoder *enc,
                                                             struct associative_memory *assoc_mem,
                                                             double **testing_data,
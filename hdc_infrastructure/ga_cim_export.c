@@ -0,0 +1,466 @@
+/**
+ * @file ga_cim_export.c
+ * @brief Compact, asynchronous export of GA candidate CiMs and their reconstruction.
+ *
+ * @details
+ * A GA candidate's continuous item memory is fully determined by its flip-count
+ * genome, the base permutations and the build's dimension and flip budget. The
+ * compact export therefore records only the genome and the candidate's scores
+ * (a few hundred bytes) instead of writing the item memory as text, and the
+ * records are written by a background thread so the GA never waits on the disk
+ * unless the bounded queue fills up. `rebuild_ga_cim` regenerates a recorded
+ * CiM bit for bit with the same builders the GA uses; `write_ga_cim_csv` prints
+ * it in the format of the CSV export.
+ */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "ga_cim_export.h"
+#include "byte_order.h"
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t permutation_checksum(const int *permutations, size_t count) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < count; i++) {
+        uint8_t bytes[4];
+        put_u32(bytes, (uint32_t)permutations[i]);
+        for (int b = 0; b < 4; b++) {
+            hash ^= bytes[b];
+            hash *= 16777619u;
+        }
+    }
+    return hash;
+}
+
+static void free_writer_queue(struct ga_cim_writer *writer) {
+    free(writer->genomes);
+    free(writer->generation);
+    free(writer->candidate);
+    free(writer->accuracy);
+    free(writer->similarity);
+    writer->genomes = NULL;
+    writer->generation = NULL;
+    writer->candidate = NULL;
+    writer->accuracy = NULL;
+    writer->similarity = NULL;
+}
+
+static size_t record_size(int genome_length) {
+    return 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t) + (size_t)genome_length * sizeof(uint16_t);
+}
+
+/**
+ * @brief Serializes the queued record in `slot` and appends it to the file.
+ *
+ * @return 0 on success, -1 if the write failed.
+ */
+static int write_record(struct ga_cim_writer *writer, int slot, uint8_t *buffer) {
+    const uint16_t *genome = &writer->genomes[(size_t)slot * writer->genome_length];
+    put_u32(buffer, writer->generation[slot]);
+    put_u32(buffer + 4, writer->candidate[slot]);
+    put_f64(buffer + 8, writer->accuracy[slot]);
+    put_f64(buffer + 16, writer->similarity[slot]);
+    uint8_t *out = buffer + 24;
+    for (int k = 0; k < writer->genome_length; k++) {
+        put_u16(out, genome[k]);
+        out += 2;
+    }
+    size_t size = record_size(writer->genome_length);
+    return fwrite(buffer, 1, size, writer->file) == size ? 0 : -1;
+}
+
+#if GA_CIM_EXPORT_THREADED
+static void *ga_cim_writer_main(void *arg) {
+    struct ga_cim_writer *writer = (struct ga_cim_writer *)arg;
+    uint8_t *buffer = (uint8_t *)malloc(record_size(writer->genome_length));
+
+    pthread_mutex_lock(&writer->lock);
+    for (;;) {
+        while (writer->count == 0 && !writer->closing) {
+            pthread_cond_wait(&writer->not_empty, &writer->lock);
+        }
+        if (writer->count == 0) {
+            break;
+        }
+        int slot = writer->head;
+        pthread_mutex_unlock(&writer->lock);
+
+        // The producer never touches a queued slot, so it is written unlocked.
+        int status = buffer ? write_record(writer, slot, buffer) : -1;
+
+        pthread_mutex_lock(&writer->lock);
+        if (status != 0) {
+            writer->failed = 1;
+        }
+        writer->head = (writer->head + 1) % GA_CIM_EXPORT_QUEUE;
+        writer->count--;
+        pthread_cond_signal(&writer->not_full);
+    }
+    pthread_mutex_unlock(&writer->lock);
+    free(buffer);
+    return NULL;
+}
+#endif
+
+/**
+ * @brief Creates a compact export file and starts its writer.
+ *
+ * @param writer The writer to initialize.
+ * @param path Destination file; an existing file is replaced.
+ * @param header Run parameters written into the file header.
+ * @param permutations Row-major `num_features x dimension` base permutations.
+ * @return 0 on success, -1 if the file cannot be written or allocation fails.
+ */
+int init_ga_cim_writer(struct ga_cim_writer *writer,
+                       const char *path,
+                       const struct ga_cim_export_header *header,
+                       const int *permutations) {
+    memset(writer, 0, sizeof(*writer));
+    if (!path || !header || !permutations || header->genome_length < 0) {
+        return -1;
+    }
+
+    size_t permutation_count = (size_t)header->num_features * (size_t)header->dimension;
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        perror("Failed to open GA CiM export file");
+        return -1;
+    }
+
+    uint8_t head[GA_CIM_EXPORT_HEADER_BYTES];
+    memcpy(head, GA_CIM_EXPORT_MAGIC, 4);
+    put_u16(head + 4, GA_CIM_EXPORT_VERSION);
+    put_u16(head + 6, (uint16_t)header->mode);
+    put_u32(head + 8, (uint32_t)header->num_levels);
+    put_u32(head + 12, (uint32_t)header->num_features);
+    put_u32(head + 16, (uint32_t)header->dimension);
+    put_u32(head + 20, (uint32_t)header->max_flips);
+    put_u32(head + 24, header->seed);
+    put_u32(head + 28, (uint32_t)header->genome_length);
+    put_u32(head + 32, permutation_checksum(permutations, permutation_count));
+    int status = fwrite(head, 1, sizeof(head), writer->file) == sizeof(head) ? 0 : -1;
+    for (size_t i = 0; i < permutation_count && status == 0; i++) {
+        uint8_t entry[4];
+        put_u32(entry, (uint32_t)permutations[i]);
+        status = fwrite(entry, 1, sizeof(entry), writer->file) == sizeof(entry) ? 0 : -1;
+    }
+
+    writer->genome_length = header->genome_length;
+    writer->genomes = (uint16_t *)malloc((size_t)GA_CIM_EXPORT_QUEUE * (size_t)(header->genome_length > 0 ? header->genome_length : 1) * sizeof(uint16_t));
+    writer->generation = (uint32_t *)malloc(GA_CIM_EXPORT_QUEUE * sizeof(uint32_t));
+    writer->candidate = (uint32_t *)malloc(GA_CIM_EXPORT_QUEUE * sizeof(uint32_t));
+    writer->accuracy = (double *)malloc(GA_CIM_EXPORT_QUEUE * sizeof(double));
+    writer->similarity = (double *)malloc(GA_CIM_EXPORT_QUEUE * sizeof(double));
+    if (status != 0 || !writer->genomes || !writer->generation || !writer->candidate || !writer->accuracy ||
+        !writer->similarity) {
+        fclose(writer->file);
+        writer->file = NULL;
+        free_writer_queue(writer);
+        return -1;
+    }
+
+#if GA_CIM_EXPORT_THREADED
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->not_empty, NULL);
+    pthread_cond_init(&writer->not_full, NULL);
+    if (pthread_create(&writer->thread, NULL, ga_cim_writer_main, writer) != 0) {
+        fprintf(stderr, "Failed to start the GA CiM export writer.\n");
+        pthread_mutex_destroy(&writer->lock);
+        pthread_cond_destroy(&writer->not_empty);
+        pthread_cond_destroy(&writer->not_full);
+        fclose(writer->file);
+        writer->file = NULL;
+        free_writer_queue(writer);
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * @brief Queues one candidate record.
+ *
+ * Waits only while GA_CIM_EXPORT_QUEUE records are still pending. Records must
+ * be pushed from one thread at a time.
+ *
+ * @param genome The candidate's `genome_length` flip counts.
+ * @return 0 on success, -1 if the writer is not open or a previous write failed.
+ */
+int ga_cim_writer_push(struct ga_cim_writer *writer,
+                       int generation,
+                       int candidate,
+                       const uint16_t *genome,
+                       double accuracy,
+                       double similarity) {
+    if (!writer || !writer->file || !genome) {
+        return -1;
+    }
+
+#if GA_CIM_EXPORT_THREADED
+    pthread_mutex_lock(&writer->lock);
+    while (writer->count == GA_CIM_EXPORT_QUEUE) {
+        pthread_cond_wait(&writer->not_full, &writer->lock);
+    }
+    int slot = (writer->head + writer->count) % GA_CIM_EXPORT_QUEUE;
+    pthread_mutex_unlock(&writer->lock);
+#else
+    int slot = 0;
+#endif
+
+    memcpy(&writer->genomes[(size_t)slot * writer->genome_length], genome, (size_t)writer->genome_length * sizeof(uint16_t));
+    writer->generation[slot] = (uint32_t)generation;
+    writer->candidate[slot] = (uint32_t)candidate;
+    writer->accuracy[slot] = accuracy;
+    writer->similarity[slot] = similarity;
+
+#if GA_CIM_EXPORT_THREADED
+    pthread_mutex_lock(&writer->lock);
+    writer->count++;
+    int failed = writer->failed;
+    pthread_cond_signal(&writer->not_empty);
+    pthread_mutex_unlock(&writer->lock);
+    return failed ? -1 : 0;
+#else
+    uint8_t *buffer = (uint8_t *)malloc(record_size(writer->genome_length));
+    if (!buffer || write_record(writer, slot, buffer) != 0) {
+        writer->failed = 1;
+    }
+    free(buffer);
+    return writer->failed ? -1 : 0;
+#endif
+}
+
+/**
+ * @brief Writes all queued records, stops the writer and closes the file.
+ *
+ * @param writer The writer to free. A writer that failed to initialize is ignored.
+ * @return 0 if every record reached the file, -1 otherwise.
+ */
+int free_ga_cim_writer(struct ga_cim_writer *writer) {
+    if (!writer || !writer->file) {
+        return -1;
+    }
+
+#if GA_CIM_EXPORT_THREADED
+    pthread_mutex_lock(&writer->lock);
+    writer->closing = 1;
+    pthread_cond_signal(&writer->not_empty);
+    pthread_mutex_unlock(&writer->lock);
+    pthread_join(writer->thread, NULL);
+    pthread_mutex_destroy(&writer->lock);
+    pthread_cond_destroy(&writer->not_empty);
+    pthread_cond_destroy(&writer->not_full);
+#endif
+
+    int status = writer->failed ? -1 : 0;
+    if (fclose(writer->file) != 0) {
+        status = -1;
+    }
+    writer->file = NULL;
+    free_writer_queue(writer);
+    return status;
+}
+
+/**
+ * @brief Opens a compact export file and loads its header and permutations.
+ *
+ * @return 0 on success, -1 if the file is missing, truncated or corrupt.
+ */
+int open_ga_cim_export(struct ga_cim_export_file *export_file, const char *path) {
+    memset(export_file, 0, sizeof(*export_file));
+    export_file->file = fopen(path, "rb");
+    if (!export_file->file) {
+        return -1;
+    }
+
+    uint8_t head[GA_CIM_EXPORT_HEADER_BYTES];
+    if (fread(head, 1, sizeof(head), export_file->file) != sizeof(head) ||
+        memcmp(head, GA_CIM_EXPORT_MAGIC, 4) != 0 ||
+        get_u16(head + 4) != GA_CIM_EXPORT_VERSION) {
+        close_ga_cim_export(export_file);
+        return -1;
+    }
+    struct ga_cim_export_header *header = &export_file->header;
+    header->mode = get_u16(head + 6);
+    header->num_levels = (int)get_u32(head + 8);
+    header->num_features = (int)get_u32(head + 12);
+    header->dimension = (int)get_u32(head + 16);
+    header->max_flips = (int)get_u32(head + 20);
+    header->seed = get_u32(head + 24);
+    header->genome_length = (int)get_u32(head + 28);
+    if (header->num_levels <= 0 || header->num_features <= 0 || header->dimension <= 0 || header->genome_length < 0) {
+        close_ga_cim_export(export_file);
+        return -1;
+    }
+
+    size_t permutation_count = (size_t)header->num_features * (size_t)header->dimension;
+    export_file->permutations = (int *)malloc(permutation_count * sizeof(int));
+    if (!export_file->permutations) {
+        close_ga_cim_export(export_file);
+        return -1;
+    }
+    for (size_t i = 0; i < permutation_count; i++) {
+        uint8_t entry[4];
+        if (fread(entry, 1, sizeof(entry), export_file->file) != sizeof(entry)) {
+            close_ga_cim_export(export_file);
+            return -1;
+        }
+        export_file->permutations[i] = (int)get_u32(entry);
+    }
+    if (permutation_checksum(export_file->permutations, permutation_count) != get_u32(head + 32)) {
+        close_ga_cim_export(export_file);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Reads the next candidate record.
+ *
+ * @param genome Receives `header.genome_length` flip counts.
+ * @return 1 if a record was read, 0 at the end of the file (a record cut off by
+ *         an interrupted run counts as the end), -1 on error.
+ */
+int ga_cim_export_next(struct ga_cim_export_file *export_file,
+                       int *generation,
+                       int *candidate,
+                       uint16_t *genome,
+                       double *accuracy,
+                       double *similarity) {
+    if (!export_file || !export_file->file) {
+        return -1;
+    }
+    size_t size = record_size(export_file->header.genome_length);
+    uint8_t *buffer = (uint8_t *)malloc(size);
+    if (!buffer) {
+        return -1;
+    }
+    if (fread(buffer, 1, size, export_file->file) != size) {
+        free(buffer);
+        return 0;
+    }
+    *generation = (int)get_u32(buffer);
+    *candidate = (int)get_u32(buffer + 4);
+    *accuracy = get_f64(buffer + 8);
+    *similarity = get_f64(buffer + 16);
+    const uint8_t *in = buffer + 24;
+    for (int k = 0; k < export_file->header.genome_length; k++) {
+        genome[k] = get_u16(in);
+        in += 2;
+    }
+    free(buffer);
+    return 1;
+}
+
+/**
+ * @brief Closes an export file opened with `open_ga_cim_export`.
+ */
+void close_ga_cim_export(struct ga_cim_export_file *export_file) {
+    if (!export_file) {
+        return;
+    }
+    if (export_file->file) {
+        fclose(export_file->file);
+    }
+    free(export_file->permutations);
+    export_file->file = NULL;
+    export_file->permutations = NULL;
+}
+
+/**
+ * @brief Rebuilds the CiM of a recorded genome.
+ *
+ * The result is bit-identical to the item memory the GA evaluated, provided the
+ * build matches the exporting one in VECTOR_DIMENSION and GA_MAX_FLIPS_CIM.
+ *
+ * @param header Header of the export file.
+ * @param permutations Base permutations of the export file.
+ * @param genome The recorded flip counts.
+ * @param item_mem Receives the item memory; release it with `free_item_memory`.
+ * @return 0 on success, -1 if the build does not match the export.
+ */
+int rebuild_ga_cim(const struct ga_cim_export_header *header,
+                   const int *permutations,
+                   const uint16_t *genome,
+                   struct item_memory *item_mem) {
+    if (!header || !permutations || !genome || !item_mem) {
+        return -1;
+    }
+    if (header->dimension != VECTOR_DIMENSION || header->max_flips != GA_MAX_FLIPS_CIM) {
+        fprintf(stderr,
+                "CiM export needs VECTOR_DIMENSION=%d and GA_MAX_FLIPS_CIM=%d (this build: %d, %d).\n",
+                header->dimension,
+                header->max_flips,
+                VECTOR_DIMENSION,
+                GA_MAX_FLIPS_CIM);
+        return -1;
+    }
+    int transitions = header->num_levels - 1;
+    if (header->genome_length != transitions * header->num_features ||
+        (header->mode == GA_CIM_EXPORT_CONTINUOUS && header->num_features != 1)) {
+        return -1;
+    }
+
+    int *flips = (int *)malloc((size_t)(header->genome_length > 0 ? header->genome_length : 1) * sizeof(int));
+    if (!flips) {
+        return -1;
+    }
+    for (int i = 0; i < header->genome_length; i++) {
+        flips[i] = (int)genome[i];
+    }
+    if (header->mode == GA_CIM_EXPORT_PRECOMPUTED) {
+        init_precomp_item_memory_with_B(item_mem, header->num_levels, header->num_features, flips, permutations);
+    } else {
+        init_continuous_item_memory_with_B(item_mem, header->num_levels, flips, permutations);
+    }
+    free(flips);
+    return item_mem->num_vectors > 0 ? 0 : -1;
+}
+
+/**
+ * @brief Prints a CiM in the text format of the GA CSV export.
+ *
+ * One comment line with the run parameters and scores, then one row of
+ * comma-separated bits per item-memory vector.
+ */
+void write_ga_cim_csv(FILE *file,
+                      const struct item_memory *item_mem,
+                      const struct ga_cim_export_header *header,
+                      int generation,
+                      int candidate,
+                      double accuracy,
+                      double similarity) {
+    if (header->mode == GA_CIM_EXPORT_PRECOMPUTED) {
+        fprintf(file,
+                "#ga_cim_export,mode=precomputed,generation=%d,candidate=%d,num_levels=%d,num_features=%d,num_vectors=%d,dimension=%d,accuracy=%.10f,similarity=%.10f\n",
+                generation,
+                candidate,
+                header->num_levels,
+                header->num_features,
+                item_mem->num_vectors,
+                VECTOR_DIMENSION,
+                accuracy,
+                similarity);
+    } else {
+        fprintf(file,
+                "#ga_cim_export,mode=continuous,generation=%d,candidate=%d,num_levels=%d,num_vectors=%d,dimension=%d,accuracy=%.10f,similarity=%.10f\n",
+                generation,
+                candidate,
+                header->num_levels,
+                item_mem->num_vectors,
+                VECTOR_DIMENSION,
+                accuracy,
+                similarity);
+    }
+
+    for (int i = 0; i < item_mem->num_vectors; i++) {
+        for (int bit = 0; bit < VECTOR_DIMENSION; bit++) {
+            fprintf(file, "%d", sign_vector_get(item_mem->base_vectors[i], bit));
+            if (bit < VECTOR_DIMENSION - 1) {
+                fputc(',', file);
+            }
+        }
+        fputc('\n', file);
+    }
+}
@@ -0,0 +1,142 @@
+#ifndef GA_CIM_EXPORT_H
+#define GA_CIM_EXPORT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef HAND_EMG
+#include "../hand/configHand.h"
+#elif defined(FOOT_EMG)
+#include "../foot/configFoot.h"
+#elif defined(CUSTOM)
+#include "../customModel/configCustom.h"
+#else
+#error "No EMG type defined. Please define HAND_EMG or FOOT_EMG."
+#endif
+
+#include "item_mem.h"
+
+#ifndef GA_CIM_EXPORT_THREADED
+#ifdef _WIN32
+#define GA_CIM_EXPORT_THREADED 0
+#else
+#define GA_CIM_EXPORT_THREADED 1 // write compact CiM exports from a background thread
+#endif
+#endif
+#ifndef GA_CIM_EXPORT_QUEUE
+#define GA_CIM_EXPORT_QUEUE 256 // records buffered before the GA waits for the export writer
+#endif
+
+#if GA_CIM_EXPORT_THREADED
+#include <pthread.h>
+#endif
+
+/**
+ * @brief Compact GA CiM export file ("cims.hdcx").
+ *
+ * Instead of the item memory itself, the file stores what rebuilds it exactly:
+ * the base permutations once, then one record per exported candidate. All fields
+ * are little endian:
+ * - 36 byte header: magic "HDCX", uint16 version, uint16 mode (0 precomputed,
+ *   1 continuous), then uint32 num_levels, num_features, dimension, max_flips,
+ *   seed, genome_length and an FNV-1a checksum of the permutations.
+ * - `num_features * dimension` uint32 permutation entries.
+ * - Records of uint32 generation, uint32 candidate, float64 accuracy,
+ *   float64 similarity and `genome_length` uint16 flip counts.
+ */
+#define GA_CIM_EXPORT_MAGIC "HDCX"
+#define GA_CIM_EXPORT_VERSION 1
+#define GA_CIM_EXPORT_HEADER_BYTES 36
+#define GA_CIM_EXPORT_PRECOMPUTED 0
+#define GA_CIM_EXPORT_CONTINUOUS 1
+
+/**
+ * @brief Parameters shared by every CiM of one GA run.
+ */
+struct ga_cim_export_header {
+    int mode;           /**< GA_CIM_EXPORT_PRECOMPUTED or GA_CIM_EXPORT_CONTINUOUS. */
+    int num_levels;     /**< Signal levels per feature. */
+    int num_features;   /**< Features with their own levels (1 for continuous). */
+    int dimension;      /**< Hypervector dimension. */
+    int max_flips;      /**< GA_MAX_FLIPS_CIM of the exporting build. */
+    uint32_t seed;      /**< GA seed the permutations were drawn from. */
+    int genome_length;  /**< Flip counts per genome. */
+};
+
+/**
+ * @brief Appends candidate records to a compact export file.
+ *
+ * `ga_cim_writer_push` copies the record into a bounded ring of
+ * GA_CIM_EXPORT_QUEUE slots and returns; a background thread serializes the
+ * ring to disk. A full ring makes the producer wait, so memory stays bounded
+ * however far the disk falls behind. Without threads the record is written
+ * immediately.
+ *
+ * - **file**, **genome_length**: Destination and record size.
+ * - **genomes**, **generation**, **candidate**, **accuracy**, **similarity**: Ring slots.
+ * - **head**, **count**: Oldest slot and number of queued records.
+ * - **closing**, **failed**: Shutdown request and sticky write error.
+ */
+struct ga_cim_writer {
+    FILE *file;
+    int genome_length;
+    uint16_t *genomes;
+    uint32_t *generation;
+    uint32_t *candidate;
+    double *accuracy;
+    double *similarity;
+    int head;
+    int count;
+    int closing;
+    int failed;
+#if GA_CIM_EXPORT_THREADED
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    pthread_t thread;
+#endif
+};
+
+int init_ga_cim_writer(struct ga_cim_writer *writer,
+                       const char *path,
+                       const struct ga_cim_export_header *header,
+                       const int *permutations);
+int ga_cim_writer_push(struct ga_cim_writer *writer,
+                       int generation,
+                       int candidate,
+                       const uint16_t *genome,
+                       double accuracy,
+                       double similarity);
+int free_ga_cim_writer(struct ga_cim_writer *writer);
+
+/**
+ * @brief A compact export file opened for reading.
+ */
+struct ga_cim_export_file {
+    FILE *file;
+    struct ga_cim_export_header header;
+    int *permutations;
+};
+
+int open_ga_cim_export(struct ga_cim_export_file *export_file, const char *path);
+int ga_cim_export_next(struct ga_cim_export_file *export_file,
+                       int *generation,
+                       int *candidate,
+                       uint16_t *genome,
+                       double *accuracy,
+                       double *similarity);
+void close_ga_cim_export(struct ga_cim_export_file *export_file);
+
+int rebuild_ga_cim(const struct ga_cim_export_header *header,
+                   const int *permutations,
+                   const uint16_t *genome,
+                   struct item_memory *item_mem);
+void write_ga_cim_csv(FILE *file,
+                      const struct item_memory *item_mem,
+                      const struct ga_cim_export_header *header,
+                      int generation,
+                      int candidate,
+                      double accuracy,
+                      double similarity);
+
+#endif // GA_CIM_EXPORT_H
@@ -0,0 +1,634 @@
+/**
+ * @file ga_island.c
+ * @brief Genome wire format and migration transport for the island-model GA.
+ *
+ * @details
+ * Several independent GA populations ("islands") evolve in separate processes
+ * and, every few generations, pass their best genomes to the next island of a
+ * ring. Only the flip-count genomes and their scores travel, packed into the
+ * compact little-endian format described in ga_island.h, so the exchange costs
+ * a few kilobytes per island instead of a synchronization every generation.
+ *
+ * The transport is MPI (`GA_ISLAND_MPI=1`, ranks are islands) or, by default,
+ * files written atomically into the shared directory `GA_ISLAND_DIR`. For the
+ * file transport every process is started with `HDC_GA_ISLANDS`, its own
+ * `HDC_GA_ISLAND_ID` and a `HDC_GA_RUN_TAG` shared by the islands of one
+ * launch and unique to it. Each island clears its leftover packets of that tag
+ * on start, and island 0 removes the final packets once every island has
+ * gathered them, so the directory can be reused.
+ */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "ga_island.h"
+#include "byte_order.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+#if GA_ISLAND_MPI
+#include <mpi.h>
+#endif
+
+static int g_island_run_counter = 0;
+
+static uint32_t wire_checksum(const uint8_t *data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Returns the packet size in bytes for `count` genomes of `genome_length` flips.
+ */
+size_t ga_wire_size(int genome_length, int count) {
+    size_t record = 2 * sizeof(uint64_t) + (size_t)genome_length * sizeof(uint16_t);
+    return GA_WIRE_HEADER_BYTES + (size_t)count * record + sizeof(uint32_t);
+}
+
+/**
+ * @brief Serializes genomes and their scores into a packet.
+ *
+ * @param buffer Destination of at least `ga_wire_size(header->genome_length, header->count)` bytes.
+ * @param capacity Size of `buffer` in bytes.
+ * @param header Packet header; `count` genomes are packed.
+ * @param genomes Genome pool, `genome_length` flip counts per genome.
+ * @param indices Pool indices of the genomes to pack, or NULL for the first `count`.
+ * @param accuracy Per-pool-genome accuracy.
+ * @param similarity Per-pool-genome class-vector similarity.
+ * @return The packet size, or 0 if it does not fit into `capacity`.
+ */
+size_t ga_wire_pack(uint8_t *buffer,
+                    size_t capacity,
+                    const struct ga_wire_header *header,
+                    const uint16_t *genomes,
+                    const int *indices,
+                    const double *accuracy,
+                    const double *similarity) {
+    size_t size = ga_wire_size(header->genome_length, header->count);
+    if (!buffer || size > capacity) {
+        return 0;
+    }
+
+    memcpy(buffer, GA_WIRE_MAGIC, 4);
+    put_u16(buffer + 4, GA_WIRE_VERSION);
+    put_u16(buffer + 6, 0);
+    put_u32(buffer + 8, (uint32_t)header->genome_length);
+    put_u32(buffer + 12, (uint32_t)header->count);
+    put_u32(buffer + 16, (uint32_t)header->island);
+    put_u32(buffer + 20, header->generation);
+
+    uint8_t *out = buffer + GA_WIRE_HEADER_BYTES;
+    for (int i = 0; i < header->count; i++) {
+        int index = indices ? indices[i] : i;
+        const uint16_t *genome = &genomes[(size_t)index * header->genome_length];
+        put_f64(out, accuracy[index]);
+        put_f64(out + 8, similarity[index]);
+        out += 16;
+        for (int k = 0; k < header->genome_length; k++) {
+            put_u16(out, genome[k]);
+            out += 2;
+        }
+    }
+    put_u32(out, wire_checksum(buffer, (size_t)(out - buffer)));
+    return size;
+}
+
+/**
+ * @brief Parses a packet produced by `ga_wire_pack`.
+ *
+ * @param header Receives the header; `genome_length` must be preset to the expected length.
+ * @param genomes Receives up to `max_count` genomes.
+ * @param accuracy Receives the per-genome accuracy.
+ * @param similarity Receives the per-genome similarity.
+ * @return The number of genomes unpacked, or -1 for a malformed or mismatching packet.
+ */
+int ga_wire_unpack(const uint8_t *buffer,
+                   size_t size,
+                   struct ga_wire_header *header,
+                   uint16_t *genomes,
+                   double *accuracy,
+                   double *similarity,
+                   int max_count) {
+    if (!buffer || size < ga_wire_size(0, 0) || memcmp(buffer, GA_WIRE_MAGIC, 4) != 0 ||
+        get_u16(buffer + 4) != GA_WIRE_VERSION) {
+        return -1;
+    }
+    int genome_length = (int)get_u32(buffer + 8);
+    int count = (int)get_u32(buffer + 12);
+    if (genome_length != header->genome_length || count < 0 || count > max_count ||
+        size != ga_wire_size(genome_length, count)) {
+        return -1;
+    }
+    size_t payload = size - sizeof(uint32_t);
+    if (wire_checksum(buffer, payload) != get_u32(buffer + payload)) {
+        return -1;
+    }
+
+    header->count = count;
+    header->island = (int)get_u32(buffer + 16);
+    header->generation = get_u32(buffer + 20);
+    const uint8_t *in = buffer + GA_WIRE_HEADER_BYTES;
+    for (int i = 0; i < count; i++) {
+        uint16_t *genome = &genomes[(size_t)i * genome_length];
+        accuracy[i] = get_f64(in);
+        similarity[i] = get_f64(in + 8);
+        in += 16;
+        for (int k = 0; k < genome_length; k++) {
+            genome[k] = get_u16(in);
+            in += 2;
+        }
+    }
+    return count;
+}
+
+#if GA_ISLAND_MPI
+static void finalize_mpi(void) {
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (!finalized) {
+        MPI_Finalize();
+    }
+}
+#else
+static int read_env_int(const char *name, int fallback) {
+    const char *value = getenv(name);
+    if (!value || *value == '\0') {
+        return fallback;
+    }
+    char *end = NULL;
+    errno = 0;
+    long parsed = strtol(value, &end, 10);
+    if (errno != 0 || end == value || *end != '\0') {
+        fprintf(stderr, "Warning: ignoring invalid %s=\"%s\".\n", name, value);
+        return fallback;
+    }
+    return (int)parsed;
+}
+
+static void sleep_milliseconds(int milliseconds) {
+#ifdef _WIN32
+    Sleep((DWORD)milliseconds);
+#else
+    struct timespec delay;
+    delay.tv_sec = milliseconds / 1000;
+    delay.tv_nsec = (long)(milliseconds % 1000) * 1000000L;
+    nanosleep(&delay, NULL);
+#endif
+}
+
+/**
+ * @brief File name prefix shared by every file `island` writes during this run.
+ */
+static void packet_prefix(const struct ga_island_link *link, int island, char *out, size_t out_size) {
+    snprintf(out, out_size, "%s_run%d_island%d_", link->run_tag, link->run, island);
+}
+
+static void packet_path(const struct ga_island_link *link,
+                        int island,
+                        uint32_t generation,
+                        char *out,
+                        size_t out_size) {
+    char prefix[128];
+    packet_prefix(link, island, prefix, sizeof(prefix));
+    if (generation == GA_WIRE_FINAL_GENERATION) {
+        snprintf(out, out_size, "%s/%sfinal.bin", GA_ISLAND_DIR, prefix);
+    } else {
+        snprintf(out, out_size, "%s/%sgen%u.bin", GA_ISLAND_DIR, prefix, (unsigned int)generation);
+    }
+}
+
+/**
+ * @brief Marker `island` leaves once it has read every final packet.
+ */
+static void done_path(const struct ga_island_link *link, int island, char *out, size_t out_size) {
+    char prefix[128];
+    packet_prefix(link, island, prefix, sizeof(prefix));
+    snprintf(out, out_size, "%s/%sdone", GA_ISLAND_DIR, prefix);
+}
+
+/**
+ * @brief Removes files this island left in GA_ISLAND_DIR under the same tag and run.
+ *
+ * Only this island's own files are touched: the others may already have
+ * published packets of the current launch.
+ */
+static void clear_own_packets(const struct ga_island_link *link) {
+    char prefix[128];
+    char path[640];
+    packet_prefix(link, link->island_id, prefix, sizeof(prefix));
+#ifdef _WIN32
+    char pattern[640];
+    snprintf(pattern, sizeof(pattern), "%s/%s*", GA_ISLAND_DIR, prefix);
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA(pattern, &entry);
+    if (find == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    do {
+        snprintf(path, sizeof(path), "%s/%s", GA_ISLAND_DIR, entry.cFileName);
+        remove(path);
+    } while (FindNextFileA(find, &entry));
+    FindClose(find);
+#else
+    DIR *dir = opendir(GA_ISLAND_DIR);
+    if (!dir) {
+        return;
+    }
+    size_t prefix_length = strlen(prefix);
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, prefix, prefix_length) == 0) {
+            snprintf(path, sizeof(path), "%s/%s", GA_ISLAND_DIR, entry->d_name);
+            remove(path);
+        }
+    }
+    closedir(dir);
+#endif
+}
+
+/**
+ * @brief Polls until `path` can be opened, or GA_ISLAND_TIMEOUT_SECONDS pass.
+ */
+static FILE *wait_for_file(const struct ga_island_link *link, const char *path) {
+    time_t start = time(NULL);
+    FILE *file = NULL;
+    while ((file = fopen(path, "rb")) == NULL) {
+        if (difftime(time(NULL), start) > GA_ISLAND_TIMEOUT_SECONDS) {
+            fprintf(stderr, "GA island %d: timed out waiting for %s.\n", link->island_id, path);
+            return NULL;
+        }
+        sleep_milliseconds(20);
+    }
+    return file;
+}
+
+/**
+ * @brief Publishes a packet; readers only ever see complete files thanks to the rename.
+ */
+static int write_packet(const struct ga_island_link *link, uint32_t generation, size_t size) {
+    char path[640];
+    char tmp_path[656];
+    packet_path(link, link->island_id, generation, path, sizeof(path));
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE *file = fopen(tmp_path, "wb");
+    if (!file) {
+        fprintf(stderr, "GA island %d: cannot write %s (%s).\n", link->island_id, tmp_path, strerror(errno));
+        return -1;
+    }
+    size_t written = fwrite(link->buffer, 1, size, file);
+    if (fclose(file) != 0 || written != size) {
+        fprintf(stderr, "GA island %d: short write to %s.\n", link->island_id, tmp_path);
+        remove(tmp_path);
+        return -1;
+    }
+#ifdef _WIN32
+    remove(path);
+#endif
+    if (rename(tmp_path, path) != 0) {
+        fprintf(stderr, "GA island %d: cannot publish %s (%s).\n", link->island_id, path, strerror(errno));
+        remove(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Waits for the packet of `island` and loads it into `link->buffer`.
+ *
+ * @return The packet size, or 0 on timeout or read error.
+ */
+static size_t read_packet(struct ga_island_link *link, int island, uint32_t generation, size_t capacity) {
+    char path[640];
+    packet_path(link, island, generation, path, sizeof(path));
+
+    FILE *file = wait_for_file(link, path);
+    if (!file) {
+        return 0;
+    }
+    size_t size = fread(link->buffer, 1, capacity, file);
+    int trailing = fgetc(file);
+    fclose(file);
+    if (trailing != EOF) {
+        fprintf(stderr, "GA island %d: oversized packet %s.\n", link->island_id, path);
+        return 0;
+    }
+    return size;
+}
+
+/**
+ * @brief Closing barrier of ga_island_gather.
+ *
+ * Every island marks that it has read all final packets. Island 0 waits for
+ * all marks, then removes the final packets and the marks; if one never
+ * arrives, the files stay so that late islands can still read them.
+ */
+static void finish_gather(const struct ga_island_link *link) {
+    char path[640];
+    done_path(link, link->island_id, path, sizeof(path));
+    FILE *mark = fopen(path, "wb");
+    if (!mark || fclose(mark) != 0) {
+        fprintf(stderr, "GA island %d: cannot write %s (%s).\n", link->island_id, path, strerror(errno));
+        return;
+    }
+    if (link->island_id != 0) {
+        return;
+    }
+    for (int island = 0; island < link->island_count; island++) {
+        done_path(link, island, path, sizeof(path));
+        FILE *file = wait_for_file(link, path);
+        if (!file) {
+            return;
+        }
+        fclose(file);
+    }
+    for (int island = 0; island < link->island_count; island++) {
+        packet_path(link, island, GA_WIRE_FINAL_GENERATION, path, sizeof(path));
+        remove(path);
+        done_path(link, island, path, sizeof(path));
+        remove(path);
+    }
+}
+#endif
+
+/**
+ * @brief Connects this GA run to its island ring.
+ *
+ * The island identity is taken, in order of precedence, from the MPI
+ * communicator, the `HDC_GA_ISLANDS`/`HDC_GA_ISLAND_ID` environment variables
+ * or the arguments. With a single island the link stays inactive and every
+ * other function is a no-op.
+ *
+ * @param link The link to initialize.
+ * @param island_count Default number of islands.
+ * @param island_id Default id of this island.
+ * @param interval Generations between migrations.
+ * @param migrants Genomes sent per migration.
+ * @param genome_length Flip counts per genome.
+ * @return 0 on success, -1 on invalid settings or allocation failure.
+ */
+int init_ga_island_link(struct ga_island_link *link,
+                        int island_count,
+                        int island_id,
+                        int interval,
+                        int migrants,
+                        int genome_length) {
+    if (!link || genome_length <= 0) {
+        return -1;
+    }
+    memset(link, 0, sizeof(*link));
+    link->island_count = 1;
+    link->genome_length = genome_length;
+    link->run = g_island_run_counter++;
+
+#if GA_ISLAND_MPI
+    int initialized = 0;
+    MPI_Initialized(&initialized);
+    if (!initialized) {
+        MPI_Init(NULL, NULL);
+        atexit(finalize_mpi);
+    }
+    MPI_Comm_size(MPI_COMM_WORLD, &island_count);
+    MPI_Comm_rank(MPI_COMM_WORLD, &island_id);
+#else
+    island_count = read_env_int("HDC_GA_ISLANDS", island_count);
+    island_id = read_env_int("HDC_GA_ISLAND_ID", island_id);
+#endif
+    if (island_count <= 1) {
+        return 0;
+    }
+    if (island_id < 0 || island_id >= island_count || interval <= 0 || migrants <= 0) {
+        fprintf(stderr, "GA island model: invalid island %d of %d (interval %d, migrants %d).\n",
+                island_id, island_count, interval, migrants);
+        return -1;
+    }
+
+#if !GA_ISLAND_MPI
+    // Packets of another launch under the same name would be read as this one's.
+    const char *tag = getenv("HDC_GA_RUN_TAG");
+    if (!tag || *tag == '\0') {
+        fprintf(stderr, "GA island model: set HDC_GA_RUN_TAG to a value shared by this launch's islands "
+                        "and unique to the launch.\n");
+        return -1;
+    }
+    snprintf(link->run_tag, sizeof(link->run_tag), "%s", tag);
+#endif
+    link->island_id = island_id;
+    link->island_count = island_count;
+    link->interval = interval;
+    link->migrants = migrants;
+
+    int slots = migrants > island_count ? migrants : island_count;
+    link->buffer_size = ga_wire_size(genome_length, migrants);
+    size_t gather_size = (size_t)island_count * ga_wire_size(genome_length, 1);
+    if (gather_size > link->buffer_size) {
+        link->buffer_size = gather_size;
+    }
+    link->buffer = (uint8_t *)malloc(link->buffer_size);
+    link->genomes = (uint16_t *)malloc((size_t)slots * genome_length * sizeof(uint16_t));
+    link->accuracy = (double *)malloc((size_t)slots * sizeof(double));
+    link->similarity = (double *)malloc((size_t)slots * sizeof(double));
+    if (!link->buffer || !link->genomes || !link->accuracy || !link->similarity) {
+        free_ga_island_link(link);
+        return -1;
+    }
+
+#if !GA_ISLAND_MPI
+#ifdef _WIN32
+    int made = _mkdir(GA_ISLAND_DIR);
+#else
+    int made = mkdir(GA_ISLAND_DIR, 0775);
+#endif
+    if (made != 0 && errno != EEXIST) {
+        fprintf(stderr, "GA island model: cannot create %s (%s).\n", GA_ISLAND_DIR, strerror(errno));
+        free_ga_island_link(link);
+        return -1;
+    }
+    clear_own_packets(link);
+#endif
+    return 0;
+}
+
+/**
+ * @brief Releases the buffers of an island link. NULL is ignored.
+ */
+void free_ga_island_link(struct ga_island_link *link) {
+    if (!link) {
+        return;
+    }
+    free(link->buffer);
+    free(link->genomes);
+    free(link->accuracy);
+    free(link->similarity);
+    link->buffer = NULL;
+    link->genomes = NULL;
+    link->accuracy = NULL;
+    link->similarity = NULL;
+    link->island_count = 1;
+}
+
+/**
+ * @brief Returns 1 if islands exchange migrants after `completed_generations`.
+ *
+ * No migration follows the last generation; the final winners are combined by
+ * `ga_island_gather` instead.
+ */
+int ga_island_migration_due(const struct ga_island_link *link, int completed_generations, int generations) {
+    return link && link->island_count > 1 && completed_generations < generations &&
+           completed_generations % link->interval == 0;
+}
+
+/**
+ * @brief Sends genomes to the next island and receives those of the previous one.
+ *
+ * @param generation Number of completed generations, used to match the packets.
+ * @param population Genome pool of this island.
+ * @param indices Pool indices of the genomes to send.
+ * @param count Number of genomes to send, at most `link->migrants`.
+ * @param accuracy Per-pool-genome accuracy.
+ * @param similarity Per-pool-genome similarity.
+ * @return The number of immigrants now in `link->genomes`/`accuracy`/`similarity`,
+ *         or -1 if the exchange failed (the GA then simply continues in isolation).
+ */
+int ga_island_migrate(struct ga_island_link *link,
+                      int generation,
+                      const uint16_t *population,
+                      const int *indices,
+                      int count,
+                      const double *accuracy,
+                      const double *similarity) {
+    if (!link || link->island_count <= 1 || count > link->migrants) {
+        return -1;
+    }
+    struct ga_wire_header header;
+    header.genome_length = link->genome_length;
+    header.count = count;
+    header.island = link->island_id;
+    header.generation = (uint32_t)generation;
+    size_t size = ga_wire_pack(link->buffer, link->buffer_size, &header, population, indices, accuracy, similarity);
+    if (size == 0) {
+        return -1;
+    }
+
+    int next = (link->island_id + 1) % link->island_count;
+    int previous = (link->island_id + link->island_count - 1) % link->island_count;
+#if GA_ISLAND_MPI
+    uint8_t *incoming = (uint8_t *)malloc(link->buffer_size);
+    if (!incoming) {
+        return -1;
+    }
+    MPI_Status status;
+    int received_bytes = 0;
+    MPI_Sendrecv(link->buffer, (int)size, MPI_BYTE, next, generation,
+                 incoming, (int)link->buffer_size, MPI_BYTE, previous, generation,
+                 MPI_COMM_WORLD, &status);
+    MPI_Get_count(&status, MPI_BYTE, &received_bytes);
+    header.genome_length = link->genome_length;
+    int received = ga_wire_unpack(incoming, (size_t)received_bytes, &header,
+                                  link->genomes, link->accuracy, link->similarity, link->migrants);
+    free(incoming);
+#else
+    (void)next;
+    if (write_packet(link, header.generation, size) != 0) {
+        return -1;
+    }
+    size = read_packet(link, previous, header.generation, link->buffer_size);
+    if (size == 0) {
+        return -1;
+    }
+    header.genome_length = link->genome_length;
+    int received = ga_wire_unpack(link->buffer, size, &header,
+                                  link->genomes, link->accuracy, link->similarity, link->migrants);
+    if (received >= 0) {
+        // Each packet has exactly one reader, the next island in the ring.
+        char path[640];
+        packet_path(link, previous, header.generation, path, sizeof(path));
+        remove(path);
+    }
+#endif
+    if (received < 0) {
+        fprintf(stderr, "GA island %d: rejected malformed packet from island %d.\n", link->island_id, previous);
+    }
+    return received;
+}
+
+/**
+ * @brief Collects the final winner of every island.
+ *
+ * Afterwards `link->genomes`, `accuracy` and `similarity` hold one genome per
+ * island, indexed by island id, so every island can pick the same overall winner.
+ *
+ * @return The number of islands gathered (`link->island_count`), or -1 on failure.
+ */
+int ga_island_gather(struct ga_island_link *link,
+                     const uint16_t *genome,
+                     double accuracy,
+                     double similarity) {
+    if (!link || link->island_count <= 1) {
+        return -1;
+    }
+    struct ga_wire_header header;
+    header.genome_length = link->genome_length;
+    header.count = 1;
+    header.island = link->island_id;
+    header.generation = GA_WIRE_FINAL_GENERATION;
+    size_t packet = ga_wire_size(link->genome_length, 1);
+    size_t size = ga_wire_pack(link->buffer, link->buffer_size, &header, genome, NULL, &accuracy, &similarity);
+    if (size == 0) {
+        return -1;
+    }
+
+#if GA_ISLAND_MPI
+    uint8_t *all = (uint8_t *)malloc(packet * (size_t)link->island_count);
+    if (!all) {
+        return -1;
+    }
+    MPI_Allgather(link->buffer, (int)packet, MPI_BYTE, all, (int)packet, MPI_BYTE, MPI_COMM_WORLD);
+#else
+    if (write_packet(link, GA_WIRE_FINAL_GENERATION, size) != 0) {
+        return -1;
+    }
+#endif
+    for (int island = 0; island < link->island_count; island++) {
+        const uint8_t *source;
+#if GA_ISLAND_MPI
+        source = all + (size_t)island * packet;
+#else
+        if (read_packet(link, island, GA_WIRE_FINAL_GENERATION, link->buffer_size) != packet) {
+            return -1;
+        }
+        source = link->buffer;
+#endif
+        header.genome_length = link->genome_length;
+        if (ga_wire_unpack(source, packet, &header,
+                           &link->genomes[(size_t)island * link->genome_length],
+                           &link->accuracy[island],
+                           &link->similarity[island],
+                           1) != 1 || header.island != island) {
+            fprintf(stderr, "GA island %d: invalid final packet from island %d.\n", link->island_id, island);
+#if GA_ISLAND_MPI
+            free(all);
+#endif
+            return -1;
+        }
+    }
+#if GA_ISLAND_MPI
+    free(all);
+#else
+    finish_gather(link);
+#endif
+    return link->island_count;
+}
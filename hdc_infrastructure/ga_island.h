@@ -0,0 +1,118 @@
+#ifndef GA_ISLAND_H
+#define GA_ISLAND_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef HAND_EMG
+#include "../hand/configHand.h"
+#elif defined(FOOT_EMG)
+#include "../foot/configFoot.h"
+#elif defined(CUSTOM)
+#include "../customModel/configCustom.h"
+#else
+#error "No EMG type defined. Please define HAND_EMG or FOOT_EMG."
+#endif
+
+#ifndef GA_ISLAND_MPI
+#define GA_ISLAND_MPI 0 // exchange migrants over MPI instead of GA_ISLAND_DIR (build with mpicc)
+#endif
+#ifndef GA_ISLAND_TIMEOUT_SECONDS
+#define GA_ISLAND_TIMEOUT_SECONDS 600 // give up waiting for a neighbour's migrants after this long
+#endif
+
+/**
+ * @brief Wire format of a genome packet exchanged between GA islands.
+ *
+ * All fields are little endian, independent of the host:
+ * - 24 byte header: magic "HDCG", uint16 version, uint16 reserved, then uint32
+ *   genome_length, count, island and generation.
+ * - `count` records of float64 accuracy, float64 similarity and `genome_length`
+ *   uint16 flip counts.
+ * - uint32 FNV-1a checksum over everything before it.
+ */
+#define GA_WIRE_MAGIC "HDCG"
+#define GA_WIRE_VERSION 1
+#define GA_WIRE_HEADER_BYTES 24
+#define GA_WIRE_FINAL_GENERATION 0xFFFFFFFFu
+
+/**
+ * @brief Header fields of a genome packet.
+ */
+struct ga_wire_header {
+    int genome_length;  /**< Flip counts per genome. */
+    int count;          /**< Genomes in the packet. */
+    int island;         /**< Sending island. */
+    uint32_t generation;/**< Generation the packet was sent after, or GA_WIRE_FINAL_GENERATION. */
+};
+
+size_t ga_wire_size(int genome_length, int count);
+size_t ga_wire_pack(uint8_t *buffer,
+                    size_t capacity,
+                    const struct ga_wire_header *header,
+                    const uint16_t *genomes,
+                    const int *indices,
+                    const double *accuracy,
+                    const double *similarity);
+int ga_wire_unpack(const uint8_t *buffer,
+                   size_t size,
+                   struct ga_wire_header *header,
+                   uint16_t *genomes,
+                   double *accuracy,
+                   double *similarity,
+                   int max_count);
+
+/**
+ * @brief Connection of one GA island to the others.
+ *
+ * Islands form a ring: every migration sends this island's best genomes to
+ * island `(id + 1) % count` and receives those of island `(id - 1) % count`.
+ * Without MPI the packets travel as files through the shared directory
+ * `GA_ISLAND_DIR`, which works for processes on one machine as well as for
+ * nodes sharing a file system.
+ *
+ * - **island_id**, **island_count**: Position in the ring; `island_count` 1 means standalone.
+ * - **interval**: Generations between migrations.
+ * - **migrants**: Genomes sent per migration.
+ * - **genome_length**: Flip counts per genome.
+ * - **run**: Index of the GA run within this process, so consecutive runs do not mix.
+ * - **run_tag**: Launch identifier (`HDC_GA_RUN_TAG`, required by the file transport) separating repeated launches.
+ * - **buffer**, **buffer_size**: Packet staging memory.
+ * - **genomes**, **accuracy**, **similarity**: Genomes received by the last exchange.
+ */
+struct ga_island_link {
+    int island_id;
+    int island_count;
+    int interval;
+    int migrants;
+    int genome_length;
+    int run;
+    char run_tag[64];
+    uint8_t *buffer;
+    size_t buffer_size;
+    uint16_t *genomes;
+    double *accuracy;
+    double *similarity;
+};
+
+int init_ga_island_link(struct ga_island_link *link,
+                        int island_count,
+                        int island_id,
+                        int interval,
+                        int migrants,
+                        int genome_length);
+void free_ga_island_link(struct ga_island_link *link);
+int ga_island_migration_due(const struct ga_island_link *link, int completed_generations, int generations);
+int ga_island_migrate(struct ga_island_link *link,
+                      int generation,
+                      const uint16_t *population,
+                      const int *indices,
+                      int count,
+                      const double *accuracy,
+                      const double *similarity);
+int ga_island_gather(struct ga_island_link *link,
+                     const uint16_t *genome,
+                     double accuracy,
+                     double similarity);
+
+#endif // GA_ISLAND_H
@@ -0,0 +1,162 @@
+/**
+ * @file hdc_config.c
+ * @brief Runtime description of the compiled model dimensions (see hdc_config.h).
+ *
+ * @details
+ * A configuration is written as comma-separated `NAME=value` pairs using the
+ * macro names, e.g. `VECTOR_DIMENSION=2048,N_GRAM_SIZE=4`; omitted names match
+ * any build. `HDC_CONFIG` in the environment holds the configuration a run
+ * requests.
+ */
+#include "hdc_config.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct hdc_config_field {
+    const char *name;
+    size_t offset;
+};
+
+static const struct hdc_config_field config_fields[] = {
+    {"VECTOR_DIMENSION", offsetof(struct hdc_config, vector_dimension)},
+    {"NUM_LEVELS", offsetof(struct hdc_config, num_levels)},
+    {"N_GRAM_SIZE", offsetof(struct hdc_config, n_gram_size)},
+    {"WINDOW", offsetof(struct hdc_config, window)},
+    {"DOWNSAMPLE", offsetof(struct hdc_config, downsample)},
+    {"NUM_FEATURES", offsetof(struct hdc_config, num_features)},
+    {"NUM_CLASSES", offsetof(struct hdc_config, num_classes)},
+    {"MODEL_VARIANT", offsetof(struct hdc_config, model_variant)},
+    {"BIPOLAR_MODE", offsetof(struct hdc_config, bipolar_mode)},
+};
+
+#define NUM_CONFIG_FIELDS ((int)(sizeof(config_fields) / sizeof(config_fields[0])))
+
+static int *config_field(struct hdc_config *config, int field) {
+    return (int *)((char *)config + config_fields[field].offset);
+}
+
+static int config_value(const struct hdc_config *config, int field) {
+    return *(const int *)((const char *)config + config_fields[field].offset);
+}
+
+/**
+ * @brief Sets every field to HDC_CONFIG_ANY.
+ */
+void hdc_config_any(struct hdc_config *config) {
+    for (int field = 0; field < NUM_CONFIG_FIELDS; field++) {
+        *config_field(config, field) = HDC_CONFIG_ANY;
+    }
+}
+
+/**
+ * @brief The dimensions this translation unit was compiled with.
+ */
+void hdc_config_compiled(struct hdc_config *config) {
+    config->vector_dimension = VECTOR_DIMENSION;
+    config->num_levels = NUM_LEVELS;
+    config->n_gram_size = N_GRAM_SIZE;
+    config->window = WINDOW;
+    config->downsample = DOWNSAMPLE;
+    config->num_features = NUM_FEATURES;
+    config->num_classes = NUM_CLASSES;
+    config->model_variant = MODEL_VARIANT;
+    config->bipolar_mode = BIPOLAR_MODE;
+}
+
+/**
+ * @brief Applies `NAME=value[,NAME=value...]` to `config`; other fields are kept.
+ *
+ * @return 0 on success, -1 on an unknown name or a malformed value.
+ */
+int hdc_config_parse(struct hdc_config *config, const char *spec) {
+    const char *p = spec;
+    while (p && *p) {
+        const char *end = strchr(p, ',');
+        size_t length = end ? (size_t)(end - p) : strlen(p);
+        const char *equals = memchr(p, '=', length);
+        int field = 0;
+        while (equals && field < NUM_CONFIG_FIELDS &&
+               (strlen(config_fields[field].name) != (size_t)(equals - p) ||
+                strncmp(config_fields[field].name, p, (size_t)(equals - p)) != 0)) {
+            field++;
+        }
+        if (!equals || field == NUM_CONFIG_FIELDS) {
+            fprintf(stderr, "hdc config: unknown setting '%.*s'.\n", (int)length, p);
+            return -1;
+        }
+        char *value_end = NULL;
+        long value = strtol(equals + 1, &value_end, 10);
+        if (value_end == equals + 1 || value_end != p + length || value < 0 || value > 1L << 30) {
+            fprintf(stderr, "hdc config: invalid value in '%.*s'.\n", (int)length, p);
+            return -1;
+        }
+        *config_field(config, field) = (int)value;
+        p = end ? end + 1 : NULL;
+    }
+    return 0;
+}
+
+/**
+ * @brief Reads the requested configuration from `HDC_CONFIG` (all HDC_CONFIG_ANY when unset).
+ */
+int hdc_config_from_env(struct hdc_config *config) {
+    hdc_config_any(config);
+    return hdc_config_parse(config, getenv("HDC_CONFIG"));
+}
+
+/**
+ * @brief Whether `build` provides every field `requested` sets.
+ */
+int hdc_config_matches(const struct hdc_config *build, const struct hdc_config *requested) {
+    for (int field = 0; field < NUM_CONFIG_FIELDS; field++) {
+        int value = config_value(requested, field);
+        if (value != HDC_CONFIG_ANY && value != config_value(build, field)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Checks a requested configuration against this build at startup.
+ *
+ * @return 0 when the build provides it, -1 (with the mismatching fields on stderr) otherwise.
+ */
+int hdc_config_check(const struct hdc_config *requested) {
+    struct hdc_config build;
+    hdc_config_compiled(&build);
+    if (hdc_config_matches(&build, requested)) {
+        return 0;
+    }
+    for (int field = 0; field < NUM_CONFIG_FIELDS; field++) {
+        int value = config_value(requested, field);
+        if (value != HDC_CONFIG_ANY && value != config_value(&build, field)) {
+            fprintf(stderr, "hdc config: %s=%d requested, but this build has %s=%d.\n",
+                    config_fields[field].name, value, config_fields[field].name, config_value(&build, field));
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Writes the set fields of `config` as `NAME=value,...`.
+ */
+void hdc_config_format(const struct hdc_config *config, char *buffer, size_t size) {
+    size_t used = 0;
+    if (size > 0) {
+        buffer[0] = '\0';
+    }
+    for (int field = 0; field < NUM_CONFIG_FIELDS && used < size; field++) {
+        int value = config_value(config, field);
+        if (value != HDC_CONFIG_ANY) {
+            int written = snprintf(buffer + used, size - used, "%s%s=%d", used ? "," : "",
+                                   config_fields[field].name, value);
+            if (written < 0) {
+                break;
+            }
+            used += (size_t)written;
+        }
+    }
+}
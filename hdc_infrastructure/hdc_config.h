@@ -0,0 +1,47 @@
+#ifndef HDC_CONFIG_H
+#define HDC_CONFIG_H
+
+#ifdef HAND_EMG
+#include "../hand/configHand.h"
+#elif defined(FOOT_EMG)
+#include "../foot/configFoot.h"
+#elif defined(CUSTOM)
+#include "../customModel/configCustom.h"
+#else
+#error "No EMG type defined. Please define HAND_EMG or FOOT_EMG."
+#endif
+
+#include <stddef.h>
+
+#define HDC_CONFIG_ANY -1 // field value that matches every build
+
+/**
+ * @brief Model dimensions a run asks for, or a build was compiled with.
+ *
+ * The dimensions stay compile-time constants (struct layouts, unrolled loops
+ * and stack buffers depend on them); this struct describes them at runtime so
+ * a launcher can pick the matching specialized build and a run can refuse a
+ * configuration it was not compiled for. A field set to HDC_CONFIG_ANY accepts
+ * any value.
+ */
+struct hdc_config {
+    int vector_dimension;
+    int num_levels;
+    int n_gram_size;
+    int window;
+    int downsample;
+    int num_features;
+    int num_classes;
+    int model_variant;
+    int bipolar_mode;
+};
+
+void hdc_config_any(struct hdc_config *config);
+void hdc_config_compiled(struct hdc_config *config);
+int hdc_config_parse(struct hdc_config *config, const char *spec);
+int hdc_config_from_env(struct hdc_config *config);
+int hdc_config_matches(const struct hdc_config *build, const struct hdc_config *requested);
+int hdc_config_check(const struct hdc_config *requested);
+void hdc_config_format(const struct hdc_config *config, char *buffer, size_t size);
+
+#endif // HDC_CONFIG_H
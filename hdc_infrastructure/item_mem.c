@@ -17,7 +17,11 @@
 #include <string.h>
 #include <stdio.h>
 #include <ctype.h>
+#include <stdatomic.h>
 #include "vector.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 void generate_random_hv(vector_element *data, int dimension);
 
@@ -55,10 +59,37 @@ static uint32_t item_mem_seed_from_permutation(const int *perm, int length) {
     return hash;
 }
 
+/**
+ * @brief Independent RNG stream of one precomputed feature, derived from the item memory seed.
+ *
+ * Lets features be generated in any order (and in parallel) with identical results.
+ */
+static uint32_t item_mem_feature_seed(uint32_t seed, int feature) {
+    uint32_t x = seed + 0x9e3779b9u * (uint32_t)(feature + 1);
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return (x == 0u) ? 1u : x;
+}
+
+#ifdef _OPENMP
+/**
+ * @brief Whether a loop over `count` features should open its own OpenMP team.
+ *
+ * GA candidates are rebuilt inside parallel regions already; those stay serial.
+ */
+static int item_mem_parallel(int count) {
+    return count > 1 && !omp_in_parallel();
+}
+#endif
+
 static void generate_random_hv_with_rng(vector_element *data, int dimension, uint32_t *state) {
     for (int i = 0; i < dimension; i++) {
 #if BIPOLAR_MODE
-        data[i] = (item_mem_rand_range(state, 2) * 2) - 1;
+        Vector view = { data };
+        sign_vector_set(&view, i, (item_mem_rand_range(state, 2) * 2) - 1);
 #else
         int word = i >> 6;
         int bit = i & 63;
@@ -77,6 +108,57 @@ static void generate_random_hv_with_rng(vector_element *data, int dimension, uin
     }
 #endif
 }
+/**
+ * @brief Generates the level-0 vector and flip permutation of one precomputed feature.
+ *
+ * Every feature draws from its own stream (`item_mem_feature_seed`), so
+ * `init_precomp_item_memory` and `init_compressed_item_memory` produce
+ * identical levels for the same ITEM_MEM_SEED, in any feature order.
+ */
+static void generate_precomp_feature(uint32_t seed, int feature, Vector *min_vector, int *perm) {
+    uint32_t state = item_mem_feature_seed(seed, feature);
+    uint32_t *rng_state = &state;
+
+    // Level 0 is the min vector, generated randomly in place.
+    generate_random_hv_with_rng(min_vector->data, VECTOR_DIMENSION, rng_state);
+
+    // Prepare a random permutation of indices [0..D-1].
+    for (int i = 0; i < VECTOR_DIMENSION; i++) {
+        perm[i] = i;
+    }
+    for (int i = VECTOR_DIMENSION - 1; i > 0; i--) {
+        int j = item_mem_rand_range(rng_state, i + 1);
+        int tmp = perm[i];
+        perm[i] = perm[j];
+        perm[j] = tmp;
+    }
+}
+
+/**
+ * @brief Builds level vector `curr` from `prev` by flipping `perm[from..to)`.
+ */
+static void apply_level_flips(Vector *curr, const Vector *prev, const int *perm, int from, int to) {
+    sign_vector_copy(curr, prev);
+    for (int k = from; k < to; k++) {
+        sign_vector_flip(curr, perm[k]);
+    }
+}
+
+/**
+ * @brief Number of permutation entries flipped between level 0 and `level`
+ *        when `total_flips` are spread evenly over `num_levels` levels.
+ */
+static int precomp_level_target(int level, int num_levels, int total_flips) {
+    double exact = ((double)level * (double)total_flips) / (double)(num_levels - 1);
+    int target = (int)(exact + 0.5); // balanced rounding
+    if (target < 0) {
+        target = 0;
+    } else if (target > total_flips) {
+        target = total_flips;
+    }
+    return target;
+}
+
 /**
  * @brief Initializes item memory for discrete items, eg. features.
  * 
@@ -92,12 +174,11 @@ void init_item_memory(struct item_memory *item_mem, int num_items) {
         printf("Initializing item memory for %d features.\n",num_items);
     }
     item_mem->num_vectors = num_items;
-    item_mem->base_vectors = (Vector **)malloc(num_items * sizeof(Vector*));
+    item_mem->base_vectors = create_sign_vector_slab(num_items, &item_mem->storage);
     for (int i = 0; i < num_items; i++) {
-        item_mem->base_vectors[i] = create_uninitialized_vector();
         for (int j = 0; j < VECTOR_DIMENSION; j++) {
 #if BIPOLAR_MODE
-            item_mem->base_vectors[i]->data[j] = (rand() % 2) * 2 - 1; //-1 or 1 for bipolar
+            sign_vector_set(item_mem->base_vectors[i], j, (rand() % 2) * 2 - 1); //-1 or 1 for bipolar
 #else
             vector_set_bit(item_mem->base_vectors[i], j, rand() % 2); //0 or 1 for binary
 #endif
@@ -181,10 +262,7 @@ void init_continuous_item_memory(struct item_memory *item_mem, int num_levels) {
         printf("Initializing continuous item memory with %d levels.\n",num_levels);
     }
     item_mem->num_vectors = num_levels;
-    item_mem->base_vectors = (Vector **)malloc(num_levels * sizeof(Vector *));
-    for (int i = 0; i < num_levels; i++) {
-        item_mem->base_vectors[i] = create_uninitialized_vector();
-    }
+    item_mem->base_vectors = create_sign_vector_slab(num_levels, &item_mem->storage);
 
     Vector *min_vector = create_uninitialized_vector();
 
@@ -207,7 +285,7 @@ void init_continuous_item_memory(struct item_memory *item_mem, int num_levels) {
     int total_flips = GA_MAX_FLIPS_CIM;
 
     // Level 0 is the min vector.
-    vector_copy(item_mem->base_vectors[0], min_vector);
+    sign_vector_copy(item_mem->base_vectors[0], min_vector);
 
     if (num_levels > 1) {
         int steps = num_levels - 1;
@@ -223,15 +301,11 @@ void init_continuous_item_memory(struct item_memory *item_mem, int num_levels) {
 
             Vector *prev = item_mem->base_vectors[level - 1];
             Vector *curr = item_mem->base_vectors[level];
-            vector_copy(curr, prev);
+            sign_vector_copy(curr, prev);
 
             for (int k = prev_target; k < target; k++) {
                 int idx = perm[k];
-#if BIPOLAR_MODE
-                curr->data[idx] = -curr->data[idx];
-#else
-                vector_flip_bit(curr, idx);
-#endif
+                sign_vector_flip(curr, idx);
             }
 
             prev_target = target;
@@ -246,6 +320,26 @@ void init_continuous_item_memory(struct item_memory *item_mem, int num_levels) {
     }
 }
 
+/**
+ * @brief Generates the level-0 vectors of B-driven item memories.
+ *
+ * Vector `i` depends only on permutation `i` (row-major, VECTOR_DIMENSION
+ * entries each), so callers rebuilding many memories with the same
+ * permutations can generate them once and pass them to the `build_*_with_B`
+ * functions.
+ *
+ * @param min_vectors Receives `count` level-0 vectors.
+ * @param count Number of permutations.
+ * @param permutations Row-major matrix of size count x VECTOR_DIMENSION.
+ */
+void generate_item_memory_min_vectors(Vector **min_vectors, int count, const int *permutations) {
+    for (int i = 0; i < count; i++) {
+        const int *perm = permutations + (size_t)i * VECTOR_DIMENSION;
+        uint32_t rng_state = item_mem_seed_from_permutation(perm, VECTOR_DIMENSION);
+        generate_random_hv_with_rng(min_vectors[i]->data, VECTOR_DIMENSION, &rng_state);
+    }
+}
+
 /**
  * @brief Initializes continuous item memory using per-level flip counts.
  *
@@ -270,6 +364,7 @@ void init_continuous_item_memory_with_B(struct item_memory *item_mem,
     if (num_levels <= 0) {
         item_mem->num_vectors = 0;
         item_mem->base_vectors = NULL;
+        item_mem->storage = NULL;
         return;
     }
     if (num_levels > 1 && (!B || !permutation)) {
@@ -278,20 +373,49 @@ void init_continuous_item_memory_with_B(struct item_memory *item_mem,
         }
         item_mem->num_vectors = 0;
         item_mem->base_vectors = NULL;
+        item_mem->storage = NULL;
         return;
     }
 
     item_mem->num_vectors = num_levels;
-    item_mem->base_vectors = (Vector **)malloc(num_levels * sizeof(Vector *));
-    for (int i = 0; i < num_levels; i++) {
-        item_mem->base_vectors[i] = create_uninitialized_vector();
+    item_mem->base_vectors = create_sign_vector_slab(num_levels, &item_mem->storage);
+    build_continuous_item_memory_with_B(item_mem, num_levels, B, permutation, NULL);
+
+    if (output_mode >= OUTPUT_DEBUG) {
+        print_item_memory(item_mem);
+        printf("\n");
     }
+}
 
-    Vector *min_vector = create_uninitialized_vector();
-    uint32_t rng_state = item_mem_seed_from_permutation(permutation, VECTOR_DIMENSION);
-    generate_random_hv_with_rng(min_vector->data, VECTOR_DIMENSION, &rng_state);
+/**
+ * @brief Regenerates the levels of an allocated continuous item memory in place.
+ *
+ * @details
+ * Produces exactly the vectors of `init_continuous_item_memory_with_B`, but reuses
+ * the memory's existing slab, so callers that rebuild many item memories (such as
+ * the GA evaluating candidate flip vectors) avoid one allocation per rebuild.
+ *
+ * @param item_mem Item memory holding at least `num_levels` vectors.
+ * @param num_levels The number of continuous signal levels.
+ * @param B Array of size (num_levels-1) specifying flips from level i to i+1.
+ * @param permutation Array of size VECTOR_DIMENSION specifying flip order.
+ * @param min_vector Level-0 vector from `generate_item_memory_min_vectors` for
+ *        `permutation`, or NULL to regenerate it.
+ */
+void build_continuous_item_memory_with_B(struct item_memory *item_mem,
+                                         int num_levels,
+                                         const int *B,
+                                         const int *permutation,
+                                         const Vector *min_vector) {
+    if (num_levels <= 0 || item_mem->num_vectors < num_levels || (num_levels > 1 && (!B || !permutation))) {
+        return;
+    }
 
-    vector_copy(item_mem->base_vectors[0], min_vector);
+    if (min_vector) {
+        sign_vector_copy(item_mem->base_vectors[0], min_vector);
+    } else {
+        generate_item_memory_min_vectors(item_mem->base_vectors, 1, permutation);
+    }
 
     int max_flips = GA_MAX_FLIPS_CIM;
 
@@ -307,35 +431,18 @@ void init_continuous_item_memory_with_B(struct item_memory *item_mem,
                 target = max_flips;
             }
 
-            Vector *prev = item_mem->base_vectors[level - 1];
-            Vector *curr = item_mem->base_vectors[level];
-            vector_copy(curr, prev);
-
-            for (int k = prev_target; k < target; k++) {
-                int idx = permutation[k];
-#if BIPOLAR_MODE
-                curr->data[idx] = -curr->data[idx];
-#else
-                vector_flip_bit(curr, idx);
-#endif
-            }
-
+            apply_level_flips(item_mem->base_vectors[level], item_mem->base_vectors[level - 1],
+                              permutation, prev_target, target);
             prev_target = target;
         }
     }
-
-    free_vector(min_vector);
-
-    if (output_mode >= OUTPUT_DEBUG) {
-        print_item_memory(item_mem);
-        printf("\n");
-    }
 }
 
 void generate_random_hv(vector_element *data, int dimension) {
     for (int i = 0; i < dimension; i++) {
         #if BIPOLAR_MODE
-        data[i] = (rand() % 2) * 2 - 1; // Randomly assign -1 or 1 for bipolar
+        Vector view = { data };
+        sign_vector_set(&view, i, (rand() % 2) * 2 - 1); // Randomly assign -1 or 1 for bipolar
 
         #else
         int word = i >> 6;
@@ -368,74 +475,51 @@ void generate_random_hv(vector_element *data, int dimension) {
  * @note If used, activate PRECOMPUTED_ITEM_MEMORY in config.h
  */
 void init_precomp_item_memory(struct item_memory *item_mem, int num_levels, int num_features) {
+    init_precomp_item_memory_seeded(item_mem, num_levels, num_features, ITEM_MEM_SEED);
+}
+
+/**
+ * @brief `init_precomp_item_memory` with an explicit seed instead of ITEM_MEM_SEED.
+ *
+ * Lets one process build item memories for several seeds, e.g. in a parameter sweep.
+ */
+void init_precomp_item_memory_seeded(struct item_memory *item_mem, int num_levels, int num_features, uint32_t seed) {
     if (output_mode >= OUTPUT_DETAILED) {
         printf("Initializing precomputed item memory with %d levels for %d features.\n",num_levels,num_features);
     }
     int total_vectors = num_levels * num_features; // Total vectors required
     item_mem->num_vectors = total_vectors;
-    item_mem->base_vectors = (Vector **)malloc(total_vectors * sizeof(Vector *));
-    for (int i = 0; i < num_levels*num_features; i++) {
-        item_mem->base_vectors[i] = create_uninitialized_vector();
-    }
-    uint32_t rng_state = (uint32_t)ITEM_MEM_SEED;
-    if (rng_state == 0u) {
-        rng_state = 1u;
-    }
+    item_mem->base_vectors = create_sign_vector_slab(total_vectors, &item_mem->storage);
     // Total flip budget K.
     int total_flips = GA_MAX_FLIPS_CIM;
 
-    for (int feature = 0; feature < num_features; feature++) {
-        Vector *min_vector = create_uninitialized_vector();
-
-        // Generate min randomly.
-        generate_random_hv_with_rng(min_vector->data, VECTOR_DIMENSION, &rng_state);
-
-        // Prepare a random permutation of indices [0..D-1].
+    // Features use independent RNG streams, so they are generated in parallel.
+#ifdef _OPENMP
+    #pragma omp parallel if (item_mem_parallel(num_features))
+#endif
+    {
         int *perm = (int *)malloc(VECTOR_DIMENSION * sizeof(int));
-        for (int i = 0; i < VECTOR_DIMENSION; i++) {
-            perm[i] = i;
-        }
-        for (int i = VECTOR_DIMENSION - 1; i > 0; i--) {
-            int j = item_mem_rand_range(&rng_state, i + 1);
-            int tmp = perm[i];
-            perm[i] = perm[j];
-            perm[j] = tmp;
+        if (!perm) {
+            fprintf(stderr, "Memory allocation failed for item memory permutation\n");
+            exit(EXIT_FAILURE);
         }
 
-        // Level 0 is the min vector.
-        vector_copy(item_mem->base_vectors[feature], min_vector);
+#ifdef _OPENMP
+        #pragma omp for schedule(static)
+#endif
+        for (int feature = 0; feature < num_features; feature++) {
+            generate_precomp_feature(seed, feature, item_mem->base_vectors[feature], perm);
 
-        if (num_levels > 1) {
-            int steps = num_levels - 1;
             int prev_target = 0;
             for (int level = 1; level < num_levels; level++) {
-                double exact = ((double)level * (double)total_flips) / (double)steps;
-                int target = (int)(exact + 0.5); // balanced rounding
-                if (target < 0) {
-                    target = 0;
-                } else if (target > total_flips) {
-                    target = total_flips;
-                }
-
-                Vector *prev = item_mem->base_vectors[(level - 1) * num_features + feature];
-                Vector *curr = item_mem->base_vectors[level * num_features + feature];
-                vector_copy(curr, prev);
-
-                for (int k = prev_target; k < target; k++) {
-                    int idx = perm[k];
-    #if BIPOLAR_MODE
-                    curr->data[idx] = -curr->data[idx];
-    #else
-                    vector_flip_bit(curr, idx);
-    #endif
-                }
-
+                int target = precomp_level_target(level, num_levels, total_flips);
+                apply_level_flips(item_mem->base_vectors[level * num_features + feature],
+                                  item_mem->base_vectors[(level - 1) * num_features + feature],
+                                  perm, prev_target, target);
                 prev_target = target;
             }
         }
-
         free(perm);
-        free_vector(min_vector);
     }
     if (output_mode >= OUTPUT_DEBUG) {
         print_item_memory(item_mem);
@@ -478,23 +562,55 @@ void init_precomp_item_memory_with_B(struct item_memory *item_mem,
 
     int total_vectors = num_levels * num_features;
     item_mem->num_vectors = total_vectors;
-    item_mem->base_vectors = (Vector **)malloc(total_vectors * sizeof(Vector *));
-    for (int i = 0; i < total_vectors; i++) {
-        item_mem->base_vectors[i] = create_uninitialized_vector();
+    item_mem->base_vectors = create_sign_vector_slab(total_vectors, &item_mem->storage);
+    build_precomp_item_memory_with_B(item_mem, num_levels, num_features, B, permutations, NULL);
+
+    if (output_mode >= OUTPUT_DEBUG) {
+        print_item_memory(item_mem);
+        printf("\n");
+    }
+}
+
+/**
+ * @brief Regenerates an allocated precomputed item memory in place from flip counts.
+ *
+ * @details
+ * Produces exactly the vectors of `init_precomp_item_memory_with_B`, but reuses
+ * the memory's existing slab, so callers that rebuild many item memories (such as
+ * the GA evaluating candidate flip matrices) avoid one allocation per rebuild.
+ *
+ * @param item_mem Item memory holding at least `num_levels * num_features` vectors.
+ * @param num_levels The number of signal levels.
+ * @param num_features The number of features to encode.
+ * @param B Row-major matrix of size num_features x (num_levels-1) with flip counts.
+ * @param permutations Row-major matrix of size num_features x VECTOR_DIMENSION with permutations.
+ * @param min_vectors Level-0 vectors from `generate_item_memory_min_vectors` for
+ *        `permutations`, or NULL to regenerate them. The permutations are fixed
+ *        for a whole GA run, so the GA passes them in and only applies the flips.
+ */
+void build_precomp_item_memory_with_B(struct item_memory *item_mem,
+                                      int num_levels,
+                                      int num_features,
+                                      const int *B,
+                                      const int *permutations,
+                                      Vector *const *min_vectors) {
+    if (!B || !permutations || item_mem->num_vectors < num_levels * num_features) {
+        return;
     }
 
     int max_flips = GA_MAX_FLIPS_CIM;
 
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (item_mem_parallel(num_features))
+#endif
     for (int feature = 0; feature < num_features; feature++) {
-        Vector *min_vector = create_uninitialized_vector();
         const int *perm = permutations + (size_t)feature * VECTOR_DIMENSION;
 
-        // Generate min randomly.
-        uint32_t rng_state = item_mem_seed_from_permutation(perm, VECTOR_DIMENSION);
-        generate_random_hv_with_rng(min_vector->data, VECTOR_DIMENSION, &rng_state);
-
-        // Level 0 is the min vector.
-        vector_copy(item_mem->base_vectors[feature], min_vector);
+        if (min_vectors) {
+            sign_vector_copy(item_mem->base_vectors[feature], min_vectors[feature]);
+        } else {
+            generate_item_memory_min_vectors(&item_mem->base_vectors[feature], 1, perm);
+        }
 
         if (num_levels > 1) {
             int prev_target = 0;
@@ -508,46 +624,374 @@ void init_precomp_item_memory_with_B(struct item_memory *item_mem,
                     target = max_flips;
                 }
 
-                Vector *prev = item_mem->base_vectors[(level - 1) * num_features + feature];
-                Vector *curr = item_mem->base_vectors[level * num_features + feature];
-                vector_copy(curr, prev);
-
-                for (int k = prev_target; k < target; k++) {
-                    int idx = perm[k];
-    #if BIPOLAR_MODE
-                    curr->data[idx] = -curr->data[idx];
-    #else
-                    vector_flip_bit(curr, idx);
-    #endif
-                }
-
+                apply_level_flips(item_mem->base_vectors[level * num_features + feature],
+                                  item_mem->base_vectors[(level - 1) * num_features + feature],
+                                  perm, prev_target, target);
                 prev_target = target;
             }
         }
+    }
+}
 
-        free_vector(min_vector);
+/**
+ * @brief Allocates the flip lists, offsets and cache of a compressed item memory.
+ */
+static void alloc_compressed_item_memory(struct compressed_item_memory *cim,
+                                         int num_levels,
+                                         int num_features,
+                                         size_t total_flips,
+                                         int cache_slots) {
+    if (num_levels < 1 || num_features < 1) {
+        fprintf(stderr, "Error: invalid compressed item memory size %d x %d\n", num_levels, num_features);
+        exit(EXIT_FAILURE);
+    }
+    if (cache_slots <= 0) {
+        cache_slots = CIM_CACHE_SLOTS;
+    }
+    int num_keys = num_levels * num_features;
+    if (cache_slots > num_keys) {
+        cache_slots = num_keys;
+    }
+
+    cim->num_levels = num_levels;
+    cim->num_features = num_features;
+    cim->base_vectors = create_sign_vector_slab(num_features, &cim->base_storage);
+    cim->flips = (cim_flip_index *)malloc((total_flips > 0 ? total_flips : 1u) * sizeof(cim_flip_index));
+    cim->flip_offsets = (size_t *)malloc((size_t)(num_features + 1) * sizeof(size_t));
+    cim->level_ends = (int *)malloc((size_t)num_keys * sizeof(int));
+    cim->cache_slots = cache_slots;
+    cim->cache_vectors = create_sign_vector_slab(cache_slots, &cim->cache_storage);
+    cim->cache_keys = (int *)malloc((size_t)cache_slots * sizeof(int));
+    cim->cache_stamps = (unsigned int *)calloc((size_t)cache_slots, sizeof(unsigned int));
+    cim->cache_slot_of = (int *)malloc((size_t)num_keys * sizeof(int));
+    cim->cache_clock = 0u;
+    if (!cim->flips || !cim->flip_offsets || !cim->level_ends ||
+        !cim->cache_keys || !cim->cache_stamps || !cim->cache_slot_of) {
+        fprintf(stderr, "Memory allocation failed for compressed item memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < cache_slots; i++) {
+        cim->cache_keys[i] = -1;
     }
+    for (int i = 0; i < num_keys; i++) {
+        cim->cache_slot_of[i] = -1;
+    }
+}
 
-    if (output_mode >= OUTPUT_DEBUG) {
-        print_item_memory(item_mem);
-        printf("\n");
+/**
+ * @brief Initializes a level-delta compressed precomputed item memory.
+ *
+ * @details
+ * Generates the same vectors as `init_precomp_item_memory` for the same
+ * ITEM_MEM_SEED, but only stores each feature's level-0 vector plus the
+ * permutation prefix that is flipped on the way to the top level. Level `l`
+ * of a feature is its level-0 vector with the first `level_ends[l]` flip
+ * indices applied. For the foot config (D = 5000, 32 features, 80 levels)
+ * this is ~0.37 MB instead of ~1.6 MB, and the full CiM is never allocated.
+ *
+ * @param cim The compressed item memory to initialize.
+ * @param num_levels The number of signal levels.
+ * @param num_features The number of features to encode.
+ * @param cache_slots Materialized vectors kept by `get_compressed_item_vector`
+ *        (<= 0 selects CIM_CACHE_SLOTS).
+ */
+void init_compressed_item_memory(struct compressed_item_memory *cim,
+                                 int num_levels,
+                                 int num_features,
+                                 int cache_slots) {
+    int total_flips = GA_MAX_FLIPS_CIM;
+    if (total_flips > VECTOR_DIMENSION) {
+        total_flips = VECTOR_DIMENSION;
+    }
+    if (num_levels < 2) {
+        total_flips = 0;
+    }
+    alloc_compressed_item_memory(cim, num_levels, num_features,
+                                 (size_t)num_features * (size_t)total_flips, cache_slots);
+
+#ifdef _OPENMP
+    #pragma omp parallel if (item_mem_parallel(num_features))
+#endif
+    {
+        int *perm = (int *)malloc(VECTOR_DIMENSION * sizeof(int));
+        if (!perm) {
+            fprintf(stderr, "Memory allocation failed for item memory permutation\n");
+            exit(EXIT_FAILURE);
+        }
+
+#ifdef _OPENMP
+        #pragma omp for schedule(static)
+#endif
+        for (int feature = 0; feature < num_features; feature++) {
+            generate_precomp_feature(ITEM_MEM_SEED, feature, cim->base_vectors[feature], perm);
+
+            size_t offset = (size_t)feature * (size_t)total_flips;
+            cim->flip_offsets[feature] = offset;
+            for (int k = 0; k < total_flips; k++) {
+                cim->flips[offset + k] = (cim_flip_index)perm[k];
+            }
+            int *ends = cim->level_ends + (size_t)feature * num_levels;
+            ends[0] = 0;
+            for (int level = 1; level < num_levels; level++) {
+                ends[level] = precomp_level_target(level, num_levels, total_flips);
+            }
+        }
+        free(perm);
+    }
+    cim->flip_offsets[num_features] = (size_t)num_features * (size_t)total_flips;
+
+    if (output_mode >= OUTPUT_DETAILED) {
+        printf("Initialized compressed item memory with %d levels for %d features (%zu bytes).\n",
+               num_levels, num_features, compressed_item_memory_bytes(cim));
+    }
+}
+
+/**
+ * @brief Compresses an existing precomputed item memory into level deltas.
+ *
+ * @details
+ * Works for any level layout (e.g. GA-evolved B matrices or memories loaded
+ * from file): the flip list of each level is the set of bits in which it
+ * differs from the level below. The source memory can be freed afterwards.
+ *
+ * @param cim The compressed item memory to initialize.
+ * @param item_mem Precomputed item memory laid out as level * num_features + feature.
+ * @param num_levels The number of signal levels.
+ * @param num_features The number of features.
+ * @param cache_slots Materialized vectors kept by `get_compressed_item_vector`
+ *        (<= 0 selects CIM_CACHE_SLOTS).
+ */
+void compress_precomp_item_memory(struct compressed_item_memory *cim,
+                                  const struct item_memory *item_mem,
+                                  int num_levels,
+                                  int num_features,
+                                  int cache_slots) {
+    if (!item_mem || item_mem->num_vectors < num_levels * num_features) {
+        fprintf(stderr, "Error: item memory too small to compress %d x %d levels\n", num_levels, num_features);
+        exit(EXIT_FAILURE);
+    }
+
+    size_t total_flips = 0;
+    for (int level = 1; level < num_levels; level++) {
+        for (int feature = 0; feature < num_features; feature++) {
+            const Vector *prev = item_mem->base_vectors[(level - 1) * num_features + feature];
+            const Vector *curr = item_mem->base_vectors[level * num_features + feature];
+            for (int d = 0; d < VECTOR_DIMENSION; d++) {
+                total_flips += sign_vector_get(prev, d) != sign_vector_get(curr, d);
+            }
+        }
+    }
+    alloc_compressed_item_memory(cim, num_levels, num_features, total_flips, cache_slots);
+
+    size_t offset = 0;
+    for (int feature = 0; feature < num_features; feature++) {
+        sign_vector_copy(cim->base_vectors[feature], item_mem->base_vectors[feature]);
+        cim->flip_offsets[feature] = offset;
+        int *ends = cim->level_ends + (size_t)feature * num_levels;
+        ends[0] = 0;
+        for (int level = 1; level < num_levels; level++) {
+            const Vector *prev = item_mem->base_vectors[(level - 1) * num_features + feature];
+            const Vector *curr = item_mem->base_vectors[level * num_features + feature];
+            for (int d = 0; d < VECTOR_DIMENSION; d++) {
+                if (sign_vector_get(prev, d) != sign_vector_get(curr, d)) {
+                    cim->flips[offset++] = (cim_flip_index)d;
+                }
+            }
+            ends[level] = (int)(offset - cim->flip_offsets[feature]);
+        }
+    }
+    cim->flip_offsets[num_features] = offset;
+}
+
+/**
+ * @brief Materializes one level vector of a compressed item memory.
+ *
+ * Thread-safe; `result` must hold at least `sign_vector_storage_count()` elements.
+ *
+ * @param cim The compressed item memory.
+ * @param level The signal level.
+ * @param feature The feature index.
+ * @param result Receives the level vector (same layout as item memory base vectors).
+ */
+void materialize_compressed_item_vector(const struct compressed_item_memory *cim,
+                                        int level,
+                                        int feature,
+                                        Vector *result) {
+    sign_vector_copy(result, cim->base_vectors[feature]);
+    const cim_flip_index *flips = cim->flips + cim->flip_offsets[feature];
+    int end = cim->level_ends[(size_t)feature * cim->num_levels + level];
+    for (int k = 0; k < end; k++) {
+        sign_vector_flip(result, flips[k]);
     }
 }
 
+/**
+ * @brief Returns the vector of (`level`, `feature`), materializing it on a cache miss.
+ *
+ * @details
+ * Only levels that are actually hit get materialized. The cache holds
+ * `cache_slots` vectors and evicts the least recently used one. The returned
+ * vector stays valid until `cache_slots` other vectors have been requested.
+ * Not thread-safe: use one compressed item memory per thread, or
+ * `materialize_compressed_item_vector` into a private buffer.
+ *
+ * @param cim The compressed item memory.
+ * @param level The signal level.
+ * @param feature The feature index.
+ * @return The level vector, or NULL if the indices are out of range.
+ */
+Vector* get_compressed_item_vector(struct compressed_item_memory *cim, int level, int feature) {
+    if (level < 0 || level >= cim->num_levels || feature < 0 || feature >= cim->num_features) {
+        return NULL;
+    }
+    int key = level * cim->num_features + feature;
+    int slot = cim->cache_slot_of[key];
+    if (slot < 0) {
+        slot = 0;
+        for (int i = 1; i < cim->cache_slots; i++) {
+            if (cim->cache_stamps[i] < cim->cache_stamps[slot]) {
+                slot = i;
+            }
+        }
+        if (cim->cache_keys[slot] >= 0) {
+            cim->cache_slot_of[cim->cache_keys[slot]] = -1;
+        }
+        cim->cache_keys[slot] = key;
+        cim->cache_slot_of[key] = slot;
+        materialize_compressed_item_vector(cim, level, feature, cim->cache_vectors[slot]);
+    }
+    cim->cache_stamps[slot] = ++cim->cache_clock;
+    return cim->cache_vectors[slot];
+}
+
+/**
+ * @brief Bytes held by a compressed item memory, including its cache.
+ */
+size_t compressed_item_memory_bytes(const struct compressed_item_memory *cim) {
+    size_t num_keys = (size_t)cim->num_levels * (size_t)cim->num_features;
+    size_t vectors = (size_t)(cim->num_features + cim->cache_slots) * sign_vector_storage_bytes();
+    return vectors
+        + cim->flip_offsets[cim->num_features] * sizeof(cim_flip_index)
+        + (size_t)(cim->num_features + 1) * sizeof(size_t)
+        + num_keys * 2u * sizeof(int)
+        + (size_t)cim->cache_slots * (sizeof(int) + sizeof(unsigned int));
+}
+
+/**
+ * @brief Frees a compressed item memory.
+ */
+void free_compressed_item_memory(struct compressed_item_memory *cim) {
+    free_vector_slab(cim->base_vectors, cim->base_storage);
+    free_vector_slab(cim->cache_vectors, cim->cache_storage);
+    free(cim->flips);
+    free(cim->flip_offsets);
+    free(cim->level_ends);
+    free(cim->cache_keys);
+    free(cim->cache_stamps);
+    free(cim->cache_slot_of);
+    memset(cim, 0, sizeof(*cim));
+}
+
 /**
  * @brief Frees the memory allocated for item memory.
  * 
  * @details
- * This function releases all vectors stored in the item memory structure, 
- * as well as the structure itself.
+ * This function releases the slab backing all vectors stored in the item memory
+ * structure, as well as the vector views pointing into it.
  * 
  * @param item_mem A pointer to the item memory structure to be freed.
  */
 void free_item_memory(struct item_memory *item_mem) {
-    for (int i = 0; i < item_mem->num_vectors; i++) {
-        free_vector(item_mem->base_vectors[i]);
+    free_vector_slab(item_mem->base_vectors, item_mem->storage);
+    item_mem->base_vectors = NULL;
+    item_mem->storage = NULL;
+}
+
+struct shared_item_memory {
+    struct item_memory rows;       /**< The shared rows; read-only while shared. */
+    _Atomic int refs;              /**< Creator plus attached views. */
+    void (*release)(void *owner);  /**< Frees the rows' backing; NULL: `free_item_memory(&rows)`. */
+    void *owner;                   /**< Argument of `release`. */
+};
+
+/**
+ * @brief Shares `rows` with one reference held by the caller.
+ *
+ * The rows are moved into the shared object (`rows` is emptied). Without
+ * `release` they must own their slab and are freed with `free_item_memory`;
+ * with it, `release(owner)` frees whatever backs them (e.g. a model bundle
+ * mapping) and only the row pointers are freed here.
+ *
+ * @return The shared item memory; release it with `release_shared_item_memory`.
+ */
+struct shared_item_memory *create_shared_item_memory(struct item_memory *rows, void (*release)(void *owner), void *owner) {
+    struct shared_item_memory *shared = (struct shared_item_memory *)malloc(sizeof(*shared));
+    if (!shared) {
+        fprintf(stderr, "Memory allocation failed for shared item memory\n");
+        exit(EXIT_FAILURE);
+    }
+    shared->rows = *rows;
+    atomic_init(&shared->refs, 1);
+    shared->release = release;
+    shared->owner = owner;
+    rows->num_vectors = 0;
+    rows->base_vectors = NULL;
+    rows->storage = NULL;
+    return shared;
+}
+
+/**
+ * @brief Builds the precomputed item memory of `seed` once, for sharing (see `init_precomp_item_memory_seeded`).
+ */
+struct shared_item_memory *create_shared_precomp_item_memory(int num_levels, int num_features, uint32_t seed) {
+    struct item_memory rows;
+    init_precomp_item_memory_seeded(&rows, num_levels, num_features, seed);
+    return create_shared_item_memory(&rows, NULL, NULL);
+}
+
+/**
+ * @brief Points `view` at the shared rows and takes a reference for it.
+ *
+ * Only the row pointers are allocated. The view is used like any item memory
+ * but must not be written; free it with `detach_shared_item_memory`.
+ */
+void attach_shared_item_memory(struct shared_item_memory *shared, struct item_memory *view) {
+    int num_vectors = shared->rows.num_vectors;
+    Vector **rows = shared->rows.base_vectors;
+    vector_element *base = num_vectors > 0 ? rows[0]->data : NULL;
+    size_t stride = num_vectors > 1 ? (size_t)(rows[1]->data - base) : 0;
+    atomic_fetch_add_explicit(&shared->refs, 1, memory_order_relaxed);
+    view->num_vectors = num_vectors;
+    view->base_vectors = create_vector_views(base, num_vectors, stride);
+    view->storage = NULL;
+}
+
+/**
+ * @brief Frees `view` and drops its reference.
+ *
+ * The view may have been replaced by private rows in the meantime (copy on
+ * write); those are freed as well.
+ */
+void detach_shared_item_memory(struct shared_item_memory *shared, struct item_memory *view) {
+    free_item_memory(view);
+    view->num_vectors = 0;
+    release_shared_item_memory(shared);
+}
+
+/**
+ * @brief Drops one reference; the last one frees the rows.
+ */
+void release_shared_item_memory(struct shared_item_memory *shared) {
+    if (!shared || atomic_fetch_sub_explicit(&shared->refs, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+    if (shared->release) {
+        free_vector_slab(shared->rows.base_vectors, NULL);
+        shared->release(shared->owner);
+    } else {
+        free_item_memory(&shared->rows);
     }
-    free(item_mem->base_vectors);
+    free(shared);
 }
 
 /**
@@ -579,7 +1023,7 @@ void print_item_memory(struct item_memory *item_mem) {
     printf("Item memory contains %d vectors of dimension %d\n", item_mem->num_vectors, VECTOR_DIMENSION);
     for (int j = 0; j < VECTOR_DIMENSION; j += 1000) {
         for (int i = 0; i < item_mem->num_vectors; i++) {
-            printf("%d ", vector_get_bit(item_mem->base_vectors[i], j));
+            printf("%d ", sign_vector_get(item_mem->base_vectors[i], j));
         }
         printf("\n");
     }
@@ -598,7 +1042,8 @@ void print_item_memory(struct item_memory *item_mem) {
  *   - `bool` for binary mode (values: 0 or 1).
  * 
  * The binary file will contain `num_vectors * VECTOR_DIMENSION` elements, 
- * written as a contiguous array.
+ * written as a contiguous array. Each vector is stored in its in-memory layout,
+ * i.e. `sign_vector_storage_count()` elements (packed sign bits in bipolar mode).
  * 
  * @param item_mem A pointer to the item memory structure.
  * @param filepath The path to the binary file where the vectors should be stored.
@@ -616,7 +1061,7 @@ void store_item_mem_to_bin(struct item_memory *item_mem, const char *filepath) {
     for (int i = 0; i < item_mem->num_vectors; i++) {
         fwrite(item_mem->base_vectors[i]->data,
                sizeof(vector_element),
-               vector_storage_count(),
+               sign_vector_storage_count(),
                file);
     }
 
@@ -645,7 +1090,7 @@ void store_item_mem_to_csv(struct item_memory *item_mem, const char *filepath) {
             VECTOR_DIMENSION);
     for (int i = 0; i < item_mem->num_vectors; i++) {
         for (int j = 0; j < VECTOR_DIMENSION; j++) {
-            fprintf(file, "%d", vector_get_bit(item_mem->base_vectors[i], j));
+            fprintf(file, "%d", sign_vector_get(item_mem->base_vectors[i], j));
             if (j < VECTOR_DIMENSION - 1) {
                 fputc(',', file);
             }
@@ -701,7 +1146,7 @@ void store_precomp_item_mem_to_csv(struct item_memory *item_mem,
 
     for (int i = 0; i < item_mem->num_vectors; i++) {
         for (int j = 0; j < VECTOR_DIMENSION; j++) {
-            fprintf(file, "%d", vector_get_bit(item_mem->base_vectors[i], j));
+            fprintf(file, "%d", sign_vector_get(item_mem->base_vectors[i], j));
             if (j < VECTOR_DIMENSION - 1) {
                 fputc(',', file);
             }
@@ -749,7 +1194,7 @@ void store_precomp_item_mem_to_systemc_text(struct item_memory *item_mem,
             int index = level * num_features + feature;
             fprintf(file, "%d %d ", level, feature);
             for (int bit = 0; bit < VECTOR_DIMENSION; bit++) {
-                fputc(vector_get_bit(item_mem->base_vectors[index], bit) ? '1' : '0', file);
+                fputc(sign_vector_get(item_mem->base_vectors[index], bit) ? '1' : '0', file);
             }
             fputc('\n', file);
         }
@@ -793,9 +1238,9 @@ void load_item_mem_from_bin(struct item_memory *item_mem, const char *filepath,
     for (int i = 0; i < num_items; i++) {
         size_t items_read = fread(item_mem->base_vectors[i]->data,
                                   sizeof(vector_element),
-                                  vector_storage_count(),
+                                  sign_vector_storage_count(),
                                   file);
-        if (items_read != vector_storage_count()) {
+        if (items_read != sign_vector_storage_count()) {
             fprintf(stderr, "Error: Incomplete vector data at row %d with only %ld elements\n", i,items_read);
             exit(EXIT_FAILURE);
         }
@@ -885,7 +1330,7 @@ static void load_item_mem_from_csv_stream(struct item_memory *item_mem, FILE *fi
                 fprintf(stderr, "Error: Incomplete vector data at row %d, col %d\n", i, j);
                 exit(EXIT_FAILURE);
             }
-            vector_set_bit(item_mem->base_vectors[i], j, value);
+            sign_vector_set(item_mem->base_vectors[i], j, value);
             if (j < VECTOR_DIMENSION - 1) {
                 int ch = fgetc(file);
                 if (ch != ',') {
@@ -17,26 +17,91 @@
 struct item_memory {
     int num_vectors;/**< Number of base vectors in the item memory. */
     Vector **base_vectors;/**< Array of pointers to the base hypervectors. */
+    vector_element *storage;/**< Contiguous aligned slab backing all base vectors. */
+};
+
+#if VECTOR_DIMENSION <= 65536
+typedef uint16_t cim_flip_index;
+#else
+typedef uint32_t cim_flip_index;
+#endif
+
+#ifndef CIM_CACHE_SLOTS
+#define CIM_CACHE_SLOTS 64 // level vectors materialized at once by get_compressed_item_vector
+#endif
+
+/**
+ * @brief Precomputed item memory stored as level deltas.
+ *
+ * Holds one level-0 vector per feature and, per feature, the list of bit
+ * indices flipped from level to level. Level vectors are materialized on
+ * demand into a small LRU cache (see `get_compressed_item_vector`).
+ */
+struct compressed_item_memory {
+    int num_levels;/**< Number of signal levels. */
+    int num_features;/**< Number of features. */
+    Vector **base_vectors;/**< Level-0 vector of each feature. */
+    vector_element *base_storage;/**< Slab backing `base_vectors`. */
+    cim_flip_index *flips;/**< Flip indices of all features, concatenated in level order. */
+    size_t *flip_offsets;/**< [num_features + 1] start of each feature's flips. */
+    int *level_ends;/**< [num_features][num_levels] flips applied up to each level. */
+    int cache_slots;/**< Number of materialized vectors kept. */
+    Vector **cache_vectors;/**< Materialized level vectors. */
+    vector_element *cache_storage;/**< Slab backing `cache_vectors`. */
+    int *cache_keys;/**< level * num_features + feature held by each slot, or -1. */
+    unsigned int *cache_stamps;/**< Last use of each slot, for LRU eviction. */
+    int *cache_slot_of;/**< Slot holding each key, or -1. */
+    unsigned int cache_clock;/**< Use counter feeding `cache_stamps`. */
 };
 
 // Initialize item memory for discrete items
 void init_item_memory(struct item_memory *item_mem, int num_items);
 void init_precomp_item_memory(struct item_memory *item_mem, int num_levels, int num_features);
+void init_precomp_item_memory_seeded(struct item_memory *item_mem, int num_levels, int num_features, uint32_t seed);
 void init_precomp_item_memory_with_B(struct item_memory *item_mem,
                                      int num_levels,
                                      int num_features,
                                      const int *B,
                                      const int *permutations);
+void build_precomp_item_memory_with_B(struct item_memory *item_mem,
+                                      int num_levels,
+                                      int num_features,
+                                      const int *B,
+                                      const int *permutations,
+                                      Vector *const *min_vectors);
 // Initialize continuous item memory for signal intensities
 void init_continuous_item_memory(struct item_memory *item_mem, int num_levels);
 void init_continuous_item_memory_with_B(struct item_memory *item_mem,
                                         int num_levels,
                                         const int *B,
                                         const int *permutation);
+void build_continuous_item_memory_with_B(struct item_memory *item_mem,
+                                         int num_levels,
+                                         const int *B,
+                                         const int *permutation,
+                                         const Vector *min_vector);
+void generate_item_memory_min_vectors(Vector **min_vectors, int count, const int *permutations);
 
 // Free item memory
 void free_item_memory(struct item_memory *item_mem);
 
+/**
+ * @brief Read-only item memory shared by the encoders of several subjects.
+ *
+ * Reference counted; the rows are never written while shared. Every subject
+ * attaches an `item_memory` view (only the row pointers are per subject) and
+ * keeps its own quantizer and associative memory. A subject whose rows get
+ * rewritten (e.g. by the GA) frees its view with `free_item_memory` and builds
+ * private rows, so the shared rows are copied on write, never modified.
+ */
+struct shared_item_memory;
+
+struct shared_item_memory *create_shared_item_memory(struct item_memory *rows, void (*release)(void *owner), void *owner);
+struct shared_item_memory *create_shared_precomp_item_memory(int num_levels, int num_features, uint32_t seed);
+void attach_shared_item_memory(struct shared_item_memory *shared, struct item_memory *view);
+void detach_shared_item_memory(struct shared_item_memory *shared, struct item_memory *view);
+void release_shared_item_memory(struct shared_item_memory *shared);
+
 // Get the vector for a specific item
 Vector* get_item_vector(struct item_memory *item_mem, int item_id);
 
@@ -66,5 +131,21 @@ void load_precomp_item_mem_from_csv(struct item_memory *item_mem,
                                     const char *filepath,
                                     int num_levels,
                                     int num_features);
+void init_compressed_item_memory(struct compressed_item_memory *cim,
+                                 int num_levels,
+                                 int num_features,
+                                 int cache_slots);
+void compress_precomp_item_memory(struct compressed_item_memory *cim,
+                                  const struct item_memory *item_mem,
+                                  int num_levels,
+                                  int num_features,
+                                  int cache_slots);
+void materialize_compressed_item_vector(const struct compressed_item_memory *cim,
+                                        int level,
+                                        int feature,
+                                        Vector *result);
+Vector* get_compressed_item_vector(struct compressed_item_memory *cim, int level, int feature);
+size_t compressed_item_memory_bytes(const struct compressed_item_memory *cim);
+void free_compressed_item_memory(struct compressed_item_memory *cim);
 
 #endif // ITEM_MEMORY_H
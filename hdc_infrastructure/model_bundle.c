@@ -0,0 +1,572 @@
+/**
+ * @file model_bundle.c
+ * @brief Writes and maps single-file model bundles (see model_bundle.h).
+ */
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+#include "model_bundle.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+_Static_assert(sizeof(struct model_bundle_header) == MODEL_BUNDLE_HEADER_BYTES,
+               "model bundle header layout changed");
+_Static_assert(sizeof(int) == sizeof(int32_t), "class counts are stored as int32");
+
+static uint64_t bundle_align(uint64_t bytes) {
+    return (bytes + VECTOR_ALIGNMENT - 1u) & ~(uint64_t)(VECTOR_ALIGNMENT - 1u);
+}
+
+static int write_padding(FILE *file, uint64_t bytes) {
+    static const unsigned char zeros[VECTOR_ALIGNMENT] = {0};
+    while (bytes > 0) {
+        size_t chunk = bytes < sizeof(zeros) ? (size_t)bytes : sizeof(zeros);
+        if (fwrite(zeros, 1, chunk, file) != chunk) {
+            return -1;
+        }
+        bytes -= chunk;
+    }
+    return 0;
+}
+
+static int write_rows(FILE *file, Vector *const *rows, int count, size_t row_bytes, uint64_t stride) {
+    for (int i = 0; i < count; i++) {
+        if (fwrite(rows[i]->data, 1, row_bytes, file) != row_bytes ||
+            write_padding(file, stride - row_bytes) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes a trained model to a bundle file.
+ *
+ * @param path Destination file.
+ * @param item_mem The precomputed CiM, or the signal level memory.
+ * @param channel_mem The channel memory, or NULL with PRECOMPUTED_ITEM_MEMORY.
+ * @param assoc_mem The trained associative memory.
+ * @param quantizer The fitted quantizer.
+ * @return 0 on success, -1 on failure.
+ */
+int model_bundle_save(const char *path,
+                      const struct item_memory *item_mem,
+                      const struct item_memory *channel_mem,
+                      const struct associative_memory *assoc_mem,
+                      const struct quantizer *quantizer) {
+    int cut_features = 0;
+    int cut_levels = 0;
+    const double *cuts = quantizer_cuts(quantizer, &cut_features, &cut_levels);
+    if (!path || !item_mem || !assoc_mem || !cuts ||
+        (!PRECOMPUTED_ITEM_MEMORY && !channel_mem) ||
+        assoc_mem->num_classes != NUM_CLASSES ||
+        cut_features != NUM_FEATURES || cut_levels != NUM_LEVELS) {
+        fprintf(stderr, "model bundle: incomplete or mismatching model for %s.\n", path ? path : "(null)");
+        return -1;
+    }
+
+    struct model_bundle_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MODEL_BUNDLE_MAGIC, 4);
+    header.version = MODEL_BUNDLE_VERSION;
+    header.byte_order = MODEL_BUNDLE_BYTE_ORDER;
+    header.header_bytes = MODEL_BUNDLE_HEADER_BYTES;
+    header.dimension = VECTOR_DIMENSION;
+    header.num_levels = NUM_LEVELS;
+    header.num_features = NUM_FEATURES;
+    header.num_classes = NUM_CLASSES;
+    header.model_variant = MODEL_VARIANT;
+    header.binning_mode = BINNING_MODE;
+    header.bipolar = BIPOLAR_MODE;
+    header.precomputed = PRECOMPUTED_ITEM_MEMORY;
+    header.element_bytes = sizeof(vector_element);
+    header.item_rows = (uint32_t)item_mem->num_vectors;
+    header.channel_rows = PRECOMPUTED_ITEM_MEMORY ? 0u : (uint32_t)channel_mem->num_vectors;
+    header.cut_count = (uint32_t)NUM_FEATURES * (uint32_t)(NUM_LEVELS - 1);
+    header.item_stride = bundle_align(sign_vector_storage_bytes());
+    header.class_stride = (uint64_t)vector_slab_stride() * sizeof(vector_element);
+
+    header.item_offset = bundle_align(MODEL_BUNDLE_HEADER_BYTES);
+    header.channel_offset = header.item_offset + header.item_rows * header.item_stride;
+    header.class_offset = header.channel_offset + header.channel_rows * header.item_stride;
+    header.counts_offset = header.class_offset + (uint64_t)NUM_CLASSES * header.class_stride;
+    header.cuts_offset = bundle_align(header.counts_offset + (uint64_t)NUM_CLASSES * sizeof(int32_t));
+    header.file_bytes = header.cuts_offset + (uint64_t)header.cut_count * sizeof(double);
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        perror("model bundle: failed to open output file");
+        return -1;
+    }
+    int status = 0;
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        write_padding(file, header.item_offset - sizeof(header)) != 0 ||
+        write_rows(file, item_mem->base_vectors, item_mem->num_vectors,
+                   sign_vector_storage_bytes(), header.item_stride) != 0 ||
+        (channel_mem && header.channel_rows > 0 &&
+         write_rows(file, channel_mem->base_vectors, channel_mem->num_vectors,
+                    sign_vector_storage_bytes(), header.item_stride) != 0) ||
+        write_rows(file, assoc_mem->class_vectors, NUM_CLASSES,
+                   vector_storage_count() * sizeof(vector_element), header.class_stride) != 0 ||
+        fwrite(assoc_mem->counts, sizeof(int32_t), NUM_CLASSES, file) != NUM_CLASSES ||
+        write_padding(file, header.cuts_offset - header.counts_offset - NUM_CLASSES * sizeof(int32_t)) != 0 ||
+        fwrite(cuts, sizeof(double), header.cut_count, file) != header.cut_count) {
+        status = -1;
+    }
+    if (fclose(file) != 0) {
+        status = -1;
+    }
+    if (status != 0) {
+        fprintf(stderr, "model bundle: failed to write %s.\n", path);
+    }
+    return status;
+}
+
+/**
+ * @brief Checks that a bundle matches this build and that every section lies inside the file.
+ */
+static int check_bundle_header(const struct model_bundle_header *header, size_t file_bytes, const char *path) {
+    if (file_bytes < MODEL_BUNDLE_HEADER_BYTES || memcmp(header->magic, MODEL_BUNDLE_MAGIC, 4) != 0) {
+        fprintf(stderr, "model bundle: %s is not a model bundle.\n", path);
+        return -1;
+    }
+    if (header->version != MODEL_BUNDLE_VERSION || header->byte_order != MODEL_BUNDLE_BYTE_ORDER ||
+        header->header_bytes != MODEL_BUNDLE_HEADER_BYTES) {
+        fprintf(stderr, "model bundle: %s has version %u or byte order 0x%08x this build cannot map.\n",
+                path, header->version, header->byte_order);
+        return -1;
+    }
+    if (header->dimension != VECTOR_DIMENSION || header->num_levels != NUM_LEVELS ||
+        header->num_features != NUM_FEATURES || header->num_classes != NUM_CLASSES ||
+        header->model_variant != MODEL_VARIANT || header->binning_mode != BINNING_MODE ||
+        header->bipolar != BIPOLAR_MODE || header->precomputed != PRECOMPUTED_ITEM_MEMORY ||
+        header->element_bytes != sizeof(vector_element)) {
+        fprintf(stderr,
+                "model bundle: %s was built for D=%u, %u levels, %u features, %u classes, variant %u, "
+                "binning %u, bipolar %u, precomputed %u; this build differs.\n",
+                path, header->dimension, header->num_levels, header->num_features, header->num_classes,
+                header->model_variant, header->binning_mode, header->bipolar, header->precomputed);
+        return -1;
+    }
+
+    uint64_t expected_rows = PRECOMPUTED_ITEM_MEMORY ? (uint64_t)NUM_LEVELS * NUM_FEATURES : (uint64_t)NUM_LEVELS;
+    uint64_t expected_channels = PRECOMPUTED_ITEM_MEMORY ? 0u : (uint64_t)NUM_FEATURES;
+    if (header->item_rows != expected_rows || header->channel_rows != expected_channels ||
+        header->cut_count != (uint64_t)NUM_FEATURES * (NUM_LEVELS - 1) ||
+        header->item_stride < sign_vector_storage_bytes() ||
+        header->class_stride < vector_storage_count() * sizeof(vector_element) ||
+        (header->item_stride | header->class_stride | header->item_offset | header->channel_offset |
+         header->class_offset) % VECTOR_ALIGNMENT != 0 ||
+        header->counts_offset % sizeof(int32_t) != 0 || header->cuts_offset % sizeof(double) != 0 ||
+        header->file_bytes != file_bytes ||
+        header->item_offset + header->item_rows * header->item_stride > file_bytes ||
+        header->channel_offset + header->channel_rows * header->item_stride > file_bytes ||
+        header->class_offset + (uint64_t)NUM_CLASSES * header->class_stride > file_bytes ||
+        header->counts_offset + (uint64_t)NUM_CLASSES * sizeof(int32_t) > file_bytes ||
+        header->cuts_offset + (uint64_t)header->cut_count * sizeof(double) > file_bytes) {
+        fprintf(stderr, "model bundle: %s has an invalid section layout.\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+#ifdef _WIN32
+static void *map_bundle_file(const char *path, size_t *bytes) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        perror("model bundle: failed to open bundle");
+        return NULL;
+    }
+    void *data = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+        if (size > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data = _aligned_malloc((size_t)size, VECTOR_ALIGNMENT);
+            if (data && fread(data, 1, (size_t)size, file) != (size_t)size) {
+                _aligned_free(data);
+                data = NULL;
+            }
+            *bytes = (size_t)size;
+        }
+    }
+    fclose(file);
+    if (!data) {
+        fprintf(stderr, "model bundle: failed to read %s.\n", path);
+    }
+    return data;
+}
+
+static void unmap_bundle_file(void *data, size_t bytes) {
+    (void)bytes;
+    _aligned_free(data);
+}
+#else
+static void *map_bundle_file(const char *path, size_t *bytes) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("model bundle: failed to open bundle");
+        return NULL;
+    }
+    struct stat info;
+    void *data = NULL;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            data = NULL;
+        }
+        *bytes = (size_t)info.st_size;
+    }
+    close(fd);
+    if (!data) {
+        fprintf(stderr, "model bundle: failed to map %s.\n", path);
+    }
+    return data;
+}
+
+static void unmap_bundle_file(void *data, size_t bytes) {
+    munmap(data, bytes);
+}
+#endif
+
+/**
+ * @brief Maps a bundle written by `model_bundle_save` and sets up its memories in place.
+ *
+ * Only the vector views (one small block per memory) and the quantizer handle
+ * are allocated; the vectors, counts and cuts are used directly from the
+ * read-only mapping, and the associative memory is marked `read_only`.
+ *
+ * @return 0 on success, -1 on failure (the bundle is left empty).
+ */
+int model_bundle_open(struct model_bundle *bundle, const char *path) {
+    memset(bundle, 0, sizeof(*bundle));
+    if (!path) {
+        return -1;
+    }
+    size_t bytes = 0;
+    unsigned char *base = (unsigned char *)map_bundle_file(path, &bytes);
+    if (!base) {
+        return -1;
+    }
+    const struct model_bundle_header *header = (const struct model_bundle_header *)base;
+    if (check_bundle_header(header, bytes, path) != 0) {
+        unmap_bundle_file(base, bytes);
+        return -1;
+    }
+    bundle->mapping = base;
+    bundle->mapping_bytes = bytes;
+    bundle->header = header;
+
+    size_t item_stride = (size_t)(header->item_stride / sizeof(vector_element));
+    bundle->item_mem.num_vectors = (int)header->item_rows;
+    bundle->item_mem.base_vectors = create_vector_views((vector_element *)(base + header->item_offset),
+                                                        (int)header->item_rows, item_stride);
+    if (header->channel_rows > 0) {
+        bundle->channel_mem.num_vectors = (int)header->channel_rows;
+        bundle->channel_mem.base_vectors = create_vector_views((vector_element *)(base + header->channel_offset),
+                                                               (int)header->channel_rows, item_stride);
+    }
+    bundle->assoc_mem.num_classes = NUM_CLASSES;
+    bundle->assoc_mem.class_vectors = create_vector_views((vector_element *)(base + header->class_offset),
+                                                          NUM_CLASSES,
+                                                          (size_t)(header->class_stride / sizeof(vector_element)));
+    bundle->assoc_mem.counts = (int *)(base + header->counts_offset);
+    bundle->assoc_mem.read_only = true;
+#if BIPOLAR_MODE
+    refresh_class_norms(&bundle->assoc_mem);
+#endif
+    bundle->quantizer = quantizer_wrap_cuts((const double *)(base + header->cuts_offset), NUM_FEATURES, NUM_LEVELS);
+    if (!bundle->quantizer) {
+        model_bundle_close(bundle);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Releases the views and the mapping of an opened bundle.
+ */
+void model_bundle_close(struct model_bundle *bundle) {
+    if (!bundle->mapping) {
+        return;
+    }
+    free_quantizer(bundle->quantizer);
+    free_vector_slab(bundle->item_mem.base_vectors, NULL);
+    free_vector_slab(bundle->channel_mem.base_vectors, NULL);
+    free_vector_slab(bundle->assoc_mem.class_vectors, NULL);
+    unmap_bundle_file(bundle->mapping, bundle->mapping_bytes);
+    memset(bundle, 0, sizeof(*bundle));
+}
+
+static void close_shared_bundle(void *owner) {
+    struct model_bundle *bundle = (struct model_bundle *)owner;
+    model_bundle_close(bundle);
+    free(bundle);
+}
+
+/**
+ * @brief Maps a bundle and shares its precomputed CiM across subjects.
+ *
+ * The CiM rows stay in the read-only mapping, so every process serving the
+ * bundle shares one page-cached copy and every subject attached in this
+ * process only adds its row pointers (`attach_shared_item_memory`). The
+ * bundle's own associative memory and quantizer are not used; the mapping is
+ * closed with the last reference.
+ *
+ * @return The shared item memory, or NULL if the bundle cannot be opened or
+ *         has no precomputed CiM.
+ */
+struct shared_item_memory *model_bundle_share_item_memory(const char *path) {
+    struct model_bundle *bundle = (struct model_bundle *)malloc(sizeof(*bundle));
+    if (!bundle) {
+        fprintf(stderr, "model bundle: allocation failed.\n");
+        return NULL;
+    }
+    if (model_bundle_open(bundle, path) != 0) {
+        free(bundle);
+        return NULL;
+    }
+    if (bundle->header->channel_rows > 0) {
+        fprintf(stderr, "model bundle: %s has no precomputed CiM to share.\n", path);
+        close_shared_bundle(bundle);
+        return NULL;
+    }
+    return create_shared_item_memory(&bundle->item_mem, close_shared_bundle, bundle);
+}
+
+static void write_c_rows(FILE *file, const char *name, Vector *const *rows, int count,
+                         size_t elements, size_t stride) {
+    fprintf(file, "static const _Alignas(VECTOR_ALIGNMENT) vector_element %s[%d][%zu] = {\n", name, count, stride);
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "    {");
+        for (size_t w = 0; w < elements; w++) {
+            if (w % 4 == 0) {
+                fprintf(file, "\n        ");
+            }
+#if BIPOLAR_MODE
+            fprintf(file, "%d,", (int)rows[i]->data[w]);
+#else
+            fprintf(file, "0x%016llxull,", (unsigned long long)rows[i]->data[w]);
+#endif
+        }
+        fprintf(file, "\n    },\n");
+    }
+    fprintf(file, "};\n\n");
+}
+
+static void write_c_views(FILE *file, const char *prefix, const char *name, int count) {
+    fprintf(file, "static const Vector %s_%s_views[%d] = {\n", prefix, name, count);
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "    {(vector_element *)%s_%s[%d]},\n", prefix, name, i);
+    }
+    fprintf(file, "};\n\nstatic Vector *const %s_%s_rows[%d] = {\n", prefix, name, count);
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "    (Vector *)&%s_%s_views[%d],\n", prefix, name, i);
+    }
+    fprintf(file, "};\n\n");
+}
+
+/**
+ * @brief Exports a trained model as a C header/source pair for flash-resident deployment.
+ *
+ * The source holds the item memory, class vectors, class counts and quantizer
+ * cuts as `const`, VECTOR_ALIGNMENT-aligned arrays, together with constant
+ * vector views onto them, so everything lands in read-only memory and needs no
+ * start-up initialization. The header declares `<prefix>_model`,
+ * `<prefix>_init` (fills the model structs with views onto the ROM arrays,
+ * without allocating), `<prefix>_quantize_sample` (level lookup in the ROM
+ * cuts, identical to the quantizer's) and `<prefix>_classify_sample` (one
+ * streaming n-gram step plus classification). The generated files need
+ * hdc_infrastructure on the include path and refuse to build with another
+ * configuration than the exporting one.
+ *
+ * @param header_path Output header.
+ * @param source_path Output source; it includes the header by its file name.
+ * @param prefix C identifier prefixing every generated symbol.
+ * @param item_mem The precomputed CiM, or the signal level memory.
+ * @param channel_mem The channel memory, or NULL with PRECOMPUTED_ITEM_MEMORY.
+ * @param assoc_mem The trained associative memory.
+ * @param quantizer The fitted quantizer.
+ * @return 0 on success, -1 on failure.
+ */
+int model_export_c(const char *header_path,
+                   const char *source_path,
+                   const char *prefix,
+                   const struct item_memory *item_mem,
+                   const struct item_memory *channel_mem,
+                   const struct associative_memory *assoc_mem,
+                   const struct quantizer *quantizer) {
+    int cut_features = 0;
+    int cut_levels = 0;
+    const double *cuts = quantizer_cuts(quantizer, &cut_features, &cut_levels);
+    if (!header_path || !source_path || !prefix || prefix[0] == '\0' || !item_mem || !assoc_mem || !cuts ||
+        (!PRECOMPUTED_ITEM_MEMORY && !channel_mem) ||
+        cut_features != NUM_FEATURES || cut_levels != NUM_LEVELS) {
+        fprintf(stderr, "model export: incomplete or mismatching model.\n");
+        return -1;
+    }
+
+    char guard[128];
+    size_t prefix_length = strlen(prefix);
+    if (prefix_length + sizeof("_MODEL_H") > sizeof(guard)) {
+        fprintf(stderr, "model export: prefix too long.\n");
+        return -1;
+    }
+    for (size_t i = 0; i < prefix_length; i++) {
+        char c = prefix[i];
+        guard[i] = (c >= 'a' && c <= 'z') ? (char)(c - 'a' + 'A') : c;
+    }
+    strcpy(guard + prefix_length, "_MODEL_H");
+
+    FILE *header = fopen(header_path, "w");
+    if (!header) {
+        perror("model export: failed to open header");
+        return -1;
+    }
+    fprintf(header,
+            "/* Generated by model_export_c; do not edit. */\n"
+            "#ifndef %s\n#define %s\n\n"
+            "#include \"assoc_mem.h\"\n#include \"encoder.h\"\n\n"
+            "#if VECTOR_DIMENSION != %d || NUM_LEVELS != %d || NUM_FEATURES != %d || NUM_CLASSES != %d || \\\n"
+            "    N_GRAM_SIZE != %d || MODEL_VARIANT != %d || BIPOLAR_MODE != %d || PRECOMPUTED_ITEM_MEMORY != %d\n"
+            "#error \"%s: model was exported for a different configuration\"\n#endif\n\n",
+            guard, guard, VECTOR_DIMENSION, NUM_LEVELS, NUM_FEATURES, NUM_CLASSES,
+            N_GRAM_SIZE, MODEL_VARIANT, BIPOLAR_MODE, PRECOMPUTED_ITEM_MEMORY, prefix);
+    fprintf(header,
+            "struct %s_model {\n"
+            "    struct item_memory item_mem;\n"
+            "    struct item_memory channel_mem;\n"
+            "    struct associative_memory assoc_mem;\n"
+            "    struct encoder enc;\n"
+            "};\n\n"
+            "void %s_init(struct %s_model *model);\n"
+            "void %s_quantize_sample(const double *x, quantized_level *levels);\n"
+            "int %s_classify_sample(struct %s_model *model, struct ngram_encoder_state *state,\n"
+            "    const double *x, Vector *sample_hv);\n\n"
+            "#endif\n",
+            prefix, prefix, prefix, prefix, prefix, prefix);
+    int status = ferror(header) ? -1 : 0;
+    if (fclose(header) != 0) {
+        status = -1;
+    }
+
+    FILE *source = fopen(source_path, "w");
+    if (!source) {
+        perror("model export: failed to open source");
+        return -1;
+    }
+    const char *header_name = header_path;
+    for (const char *p = header_path; *p; p++) {
+        if (*p == '/' || *p == '\\') {
+            header_name = p + 1;
+        }
+    }
+    fprintf(source, "/* Generated by model_export_c; do not edit. */\n#include \"%s\"\n\n", header_name);
+
+    char name[160];
+    size_t item_stride = (size_t)(bundle_align(sign_vector_storage_bytes()) / sizeof(vector_element));
+    snprintf(name, sizeof(name), "%s_items", prefix);
+    write_c_rows(source, name, item_mem->base_vectors, item_mem->num_vectors,
+                 sign_vector_storage_count(), item_stride);
+    write_c_views(source, prefix, "items", item_mem->num_vectors);
+    if (!PRECOMPUTED_ITEM_MEMORY) {
+        snprintf(name, sizeof(name), "%s_channels", prefix);
+        write_c_rows(source, name, channel_mem->base_vectors, channel_mem->num_vectors,
+                     sign_vector_storage_count(), item_stride);
+        write_c_views(source, prefix, "channels", channel_mem->num_vectors);
+    }
+    snprintf(name, sizeof(name), "%s_classes", prefix);
+    write_c_rows(source, name, assoc_mem->class_vectors, NUM_CLASSES,
+                 vector_storage_count(), vector_slab_stride());
+    write_c_views(source, prefix, "classes", NUM_CLASSES);
+
+    fprintf(source, "static const int %s_counts[NUM_CLASSES] = {", prefix);
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        fprintf(source, "%s%d", c ? ", " : "", assoc_mem->counts[c]);
+    }
+    fprintf(source, "};\n\nstatic const double %s_cuts[NUM_FEATURES][NUM_LEVELS - 1] = {\n", prefix);
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        fprintf(source, "    {");
+        for (int l = 0; l < NUM_LEVELS - 1; l++) {
+            fprintf(source, "%s%.17g", l ? ", " : "", cuts[f * (NUM_LEVELS - 1) + l]);
+        }
+        fprintf(source, "},\n");
+    }
+    fprintf(source, "};\n\n");
+
+    fprintf(source,
+            "void %s_init(struct %s_model *model) {\n"
+            "    model->item_mem.num_vectors = %d;\n"
+            "    model->item_mem.base_vectors = (Vector **)%s_items_rows;\n"
+            "    model->item_mem.storage = NULL;\n",
+            prefix, prefix, item_mem->num_vectors, prefix);
+    if (PRECOMPUTED_ITEM_MEMORY) {
+        fprintf(source,
+                "    model->channel_mem.num_vectors = 0;\n"
+                "    model->channel_mem.base_vectors = NULL;\n"
+                "    model->channel_mem.storage = NULL;\n");
+    } else {
+        fprintf(source,
+                "    model->channel_mem.num_vectors = %d;\n"
+                "    model->channel_mem.base_vectors = (Vector **)%s_channels_rows;\n"
+                "    model->channel_mem.storage = NULL;\n",
+                channel_mem->num_vectors, prefix);
+    }
+    fprintf(source,
+            "    model->assoc_mem.num_classes = NUM_CLASSES;\n"
+            "    model->assoc_mem.class_vectors = (Vector **)%s_classes_rows;\n"
+            "    model->assoc_mem.counts = (int *)%s_counts;\n"
+            "    model->assoc_mem.storage = NULL;\n"
+            "    model->assoc_mem.read_only = true;\n"
+            "#if BIPOLAR_MODE\n"
+            "    refresh_class_norms(&model->assoc_mem);\n"
+            "#endif\n"
+            "#if PRECOMPUTED_ITEM_MEMORY\n"
+            "    init_encoder(&model->enc, &model->item_mem);\n"
+            "#else\n"
+            "    init_encoder(&model->enc, &model->channel_mem, &model->item_mem);\n"
+            "#endif\n"
+            "}\n\n",
+            prefix, prefix);
+    fprintf(source,
+            "void %s_quantize_sample(const double *x, quantized_level *levels) {\n"
+            "    for (int f = 0; f < NUM_FEATURES; f++) {\n"
+            "        const double *base = %s_cuts[f];\n"
+            "        int length = NUM_LEVELS - 1;\n"
+            "        while (length > 1) {\n"
+            "            int half = length / 2;\n"
+            "            base += (base[half - 1] < x[f]) ? half : 0;\n"
+            "            length -= half;\n"
+            "        }\n"
+            "        levels[f] = (quantized_level)((base - %s_cuts[f]) + (*base < x[f]));\n"
+            "    }\n"
+            "}\n\n",
+            prefix, prefix, prefix);
+    fprintf(source,
+            "int %s_classify_sample(struct %s_model *model, struct ngram_encoder_state *state,\n"
+            "    const double *x, Vector *sample_hv) {\n"
+            "    quantized_level levels[NUM_FEATURES];\n"
+            "    %s_quantize_sample(x, levels);\n"
+            "    if (push_ngram_encoder_levels(&model->enc, state, levels, sample_hv) == 0) {\n"
+            "        return -1;\n"
+            "    }\n"
+            "    return classify(&model->assoc_mem, sample_hv);\n"
+            "}\n",
+            prefix, prefix, prefix);
+    if (ferror(source)) {
+        status = -1;
+    }
+    if (fclose(source) != 0) {
+        status = -1;
+    }
+    if (status != 0) {
+        fprintf(stderr, "model export: failed to write %s / %s.\n", header_path, source_path);
+    }
+    return status;
+}
@@ -0,0 +1,109 @@
+#ifndef MODEL_BUNDLE_H
+#define MODEL_BUNDLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef HAND_EMG
+#include "../hand/configHand.h"
+#elif defined(FOOT_EMG)
+#include "../foot/configFoot.h"
+#elif defined(CUSTOM)
+#include "../customModel/configCustom.h"
+#else
+#error "No EMG type defined. Please define HAND_EMG or FOOT_EMG."
+#endif
+
+#include "assoc_mem.h"
+#include "item_mem.h"
+#include "quantizer.h"
+
+/**
+ * @brief Single-file model bundle ("model.hdcb").
+ *
+ * Holds everything a deployed model needs to classify: the item memory (the
+ * precomputed CiM, or signal levels plus channel memory), the associative
+ * memory and the quantizer cuts. Sections are stored in their in-memory
+ * layout, host byte order, aligned to VECTOR_ALIGNMENT, so `model_bundle_open`
+ * maps the file read-only and uses it in place: nothing is parsed or copied,
+ * and processes opening the same bundle share one page-cached copy.
+ *
+ * Layout: a MODEL_BUNDLE_HEADER_BYTES `struct model_bundle_header`, then the
+ * item rows, channel rows, class rows, int32 class counts and float64 cuts at
+ * the offsets recorded in the header. The header carries the configuration
+ * the bundle was built with; opening it in a build with a different
+ * configuration or byte order fails.
+ */
+#define MODEL_BUNDLE_MAGIC "HDCB"
+#define MODEL_BUNDLE_VERSION 1
+#define MODEL_BUNDLE_HEADER_BYTES 128
+#define MODEL_BUNDLE_BYTE_ORDER 0x01020304u
+
+struct model_bundle_header {
+    char magic[4];            /**< MODEL_BUNDLE_MAGIC. */
+    uint32_t version;         /**< MODEL_BUNDLE_VERSION. */
+    uint32_t byte_order;      /**< MODEL_BUNDLE_BYTE_ORDER as written by the producer. */
+    uint32_t header_bytes;    /**< MODEL_BUNDLE_HEADER_BYTES. */
+    uint32_t dimension;       /**< VECTOR_DIMENSION. */
+    uint32_t num_levels;      /**< NUM_LEVELS. */
+    uint32_t num_features;    /**< NUM_FEATURES. */
+    uint32_t num_classes;     /**< NUM_CLASSES. */
+    uint32_t model_variant;   /**< MODEL_VARIANT. */
+    uint32_t binning_mode;    /**< BINNING_MODE. */
+    uint32_t bipolar;         /**< BIPOLAR_MODE. */
+    uint32_t precomputed;     /**< PRECOMPUTED_ITEM_MEMORY. */
+    uint32_t element_bytes;   /**< sizeof(vector_element). */
+    uint32_t item_rows;       /**< Rows of the item (signal) memory. */
+    uint32_t channel_rows;    /**< Rows of the channel memory (0 when precomputed). */
+    uint32_t cut_count;       /**< Quantizer cuts, num_features * (num_levels - 1). */
+    uint64_t item_stride;     /**< Bytes between consecutive item/channel rows. */
+    uint64_t class_stride;    /**< Bytes between consecutive class rows. */
+    uint64_t item_offset;     /**< File offset of the item rows. */
+    uint64_t channel_offset;  /**< File offset of the channel rows. */
+    uint64_t class_offset;    /**< File offset of the class rows. */
+    uint64_t counts_offset;   /**< File offset of the class counts. */
+    uint64_t cuts_offset;     /**< File offset of the cuts. */
+    uint64_t file_bytes;      /**< Total file size. */
+};
+
+/**
+ * @brief A model bundle opened for classification.
+ *
+ * The memories and the quantizer point into the read-only mapping (PROT_READ
+ * on POSIX, so any write faults). They are not const only because the encoder
+ * and `classify` take plain pointers; use them read-only:
+ * - `item_mem`, `channel_mem`: pass to the encoder; never write or regenerate
+ *   their rows or call `free_item_memory` on them.
+ * - `assoc_mem`: pass to `classify`, `classify_topk`, `classify_batch` or
+ *   `prune_assoc_mem`. It is marked `read_only`, so `add_to_assoc_mem`,
+ *   `update_assoc_mem`, `update_assoc_mem_batch` and `free_assoc_mem` refuse it.
+ * - `quantizer`: pass to `quantizer_quantize_sample`; never refit it.
+ * `model_bundle_close` releases all of them together.
+ */
+struct model_bundle {
+    void *mapping;                      /**< Mapped (or, without mmap, loaded) file. */
+    size_t mapping_bytes;               /**< Size of `mapping`. */
+    const struct model_bundle_header *header;
+    struct item_memory item_mem;        /**< Precomputed CiM or signal level memory. */
+    struct item_memory channel_mem;     /**< Channel memory (empty when precomputed). */
+    struct associative_memory assoc_mem;
+    struct quantizer *quantizer;        /**< Borrows the cuts of the mapping. */
+};
+
+int model_bundle_save(const char *path,
+                      const struct item_memory *item_mem,
+                      const struct item_memory *channel_mem,
+                      const struct associative_memory *assoc_mem,
+                      const struct quantizer *quantizer);
+int model_bundle_open(struct model_bundle *bundle, const char *path);
+void model_bundle_close(struct model_bundle *bundle);
+struct shared_item_memory *model_bundle_share_item_memory(const char *path);
+int model_export_c(const char *header_path,
+                   const char *source_path,
+                   const char *prefix,
+                   const struct item_memory *item_mem,
+                   const struct item_memory *channel_mem,
+                   const struct associative_memory *assoc_mem,
+                   const struct quantizer *quantizer);
+
+#endif // MODEL_BUNDLE_H
@@ -0,0 +1,248 @@
+/**
+ * @file multi_stream.c
+ * @brief Batched inference over many concurrent sample streams.
+ *
+ * @details
+ * The streams are sorted by model (encoder and associative memory) once, at
+ * creation, and cut into units. A tick quantizes and encodes the newest sample
+ * of every stream of a unit with its own n-gram state, then classifies the
+ * unit's ready n-grams in one batched distance pass. Units share no mutable
+ * state, so the tick is a parallel loop over units; throughput scales with
+ * the number of streams (longer batches) and with cores (more units in
+ * flight). No memory is allocated after `multi_stream_create`.
+ */
+#include "multi_stream.h"
+#include "operations.h"
+#include "quantizer.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+struct stream_unit {
+    struct encoder *enc;
+    struct associative_memory *assoc_mem;
+    int first;      /**< First entry of `order`. */
+    int count;      /**< Streams in the unit. */
+};
+
+struct multi_stream_engine {
+    int num_streams;
+    int num_units;
+    int *order;                              /**< Stream ids sorted by model. */
+    struct stream_unit *units;
+    struct ngram_encoder_state *states;      /**< One per stream. */
+    Vector **ngrams;                         /**< One per stream, slot of `order`. */
+    vector_element *ngram_storage;
+    Vector **queries;                        /**< Ready n-grams, packed per unit. */
+    int *query_streams;
+    int *query_labels;
+    int *query_distances;
+};
+
+struct stream_key {
+    uintptr_t assoc_mem;
+    uintptr_t enc;
+    int stream;
+};
+
+static int compare_stream_keys(const void *a, const void *b) {
+    const struct stream_key *x = (const struct stream_key *)a;
+    const struct stream_key *y = (const struct stream_key *)b;
+    if (x->assoc_mem != y->assoc_mem) {
+        return x->assoc_mem < y->assoc_mem ? -1 : 1;
+    }
+    if (x->enc != y->enc) {
+        return x->enc < y->enc ? -1 : 1;
+    }
+    return x->stream - y->stream;
+}
+
+void multi_stream_free(struct multi_stream_engine *engine) {
+    if (!engine) {
+        return;
+    }
+    for (int stream = 0; stream < engine->num_streams; stream++) {
+        free_ngram_encoder_state(&engine->states[stream]);
+    }
+    if (engine->ngrams) {
+        free_vector_slab(engine->ngrams, engine->ngram_storage);
+    }
+    free(engine->states);
+    free(engine->order);
+    free(engine->units);
+    free(engine->queries);
+    free(engine->query_streams);
+    free(engine->query_labels);
+    free(engine->query_distances);
+    free(engine);
+}
+
+/**
+ * @brief Creates an engine for `num_streams` streams.
+ *
+ * @param encs Encoder of every stream; streams may share one.
+ * @param assoc_mems Associative memory of every stream; streams may share one.
+ * @return The engine, or NULL on invalid arguments or allocation failure.
+ *
+ * @note The encoders' quantizers must be fitted. The models are borrowed and
+ *       must outlive the engine.
+ */
+struct multi_stream_engine *multi_stream_create(int num_streams,
+                                                struct encoder *const *encs,
+                                                struct associative_memory *const *assoc_mems) {
+    if (num_streams <= 0 || !encs || !assoc_mems) {
+        fprintf(stderr, "multi stream: invalid streams.\n");
+        return NULL;
+    }
+    struct multi_stream_engine *engine = (struct multi_stream_engine *)calloc(1, sizeof(*engine));
+    if (!engine) {
+        fprintf(stderr, "multi stream: allocation failed.\n");
+        return NULL;
+    }
+    size_t n = (size_t)num_streams;
+    engine->order = (int *)malloc(n * sizeof(int));
+    engine->units = (struct stream_unit *)malloc(n * sizeof(struct stream_unit));
+    engine->states = (struct ngram_encoder_state *)calloc(n, sizeof(struct ngram_encoder_state));
+    engine->queries = (Vector **)malloc(n * sizeof(Vector *));
+    engine->query_streams = (int *)malloc(n * sizeof(int));
+    engine->query_labels = (int *)malloc(n * sizeof(int));
+    engine->query_distances = (int *)malloc(n * NUM_CLASSES * sizeof(int));
+    engine->ngrams = create_vector_slab(num_streams, &engine->ngram_storage);
+    if (!engine->order || !engine->units || !engine->states || !engine->queries || !engine->query_streams ||
+        !engine->query_labels || !engine->query_distances || !engine->ngrams) {
+        fprintf(stderr, "multi stream: allocation failed.\n");
+        multi_stream_free(engine);
+        return NULL;
+    }
+    for (int stream = 0; stream < num_streams; stream++) {
+        if (!encs[stream] || !assoc_mems[stream] || !quantizer_fitted(encs[stream]->quantizer)) {
+            fprintf(stderr, "multi stream: stream %d has no fitted model.\n", stream);
+            multi_stream_free(engine);
+            return NULL;
+        }
+    }
+    struct stream_key *keys = (struct stream_key *)malloc(n * sizeof(*keys));
+    if (!keys) {
+        fprintf(stderr, "multi stream: allocation failed.\n");
+        multi_stream_free(engine);
+        return NULL;
+    }
+    for (int stream = 0; stream < num_streams; stream++) {
+        keys[stream].assoc_mem = (uintptr_t)assoc_mems[stream];
+        keys[stream].enc = (uintptr_t)encs[stream];
+        keys[stream].stream = stream;
+        init_ngram_encoder_state(&engine->states[stream]);
+    }
+    engine->num_streams = num_streams;  // from here on `multi_stream_free` releases the states
+    qsort(keys, n, sizeof(*keys), compare_stream_keys);
+    for (int slot = 0; slot < num_streams; slot++) {
+        engine->order[slot] = keys[slot].stream;
+    }
+    free(keys);
+
+    for (int slot = 0; slot < num_streams; slot++) {
+        int stream = engine->order[slot];
+        struct stream_unit *unit = engine->num_units > 0 ? &engine->units[engine->num_units - 1] : NULL;
+        if (!unit || unit->enc != encs[stream] || unit->assoc_mem != assoc_mems[stream] ||
+            unit->count == MULTI_STREAM_UNIT_STREAMS) {
+            unit = &engine->units[engine->num_units++];
+            unit->enc = encs[stream];
+            unit->assoc_mem = assoc_mems[stream];
+            unit->first = slot;
+            unit->count = 0;
+        }
+        unit->count++;
+    }
+    return engine;
+}
+
+/**
+ * @brief Empties the n-gram state of one stream (e.g. after a reconnect), or of all with -1.
+ */
+void multi_stream_reset(struct multi_stream_engine *engine, int stream) {
+    for (int s = 0; s < engine->num_streams; s++) {
+        if (stream < 0 || s == stream) {
+            reset_ngram_encoder_state(&engine->states[s]);
+        }
+    }
+}
+
+static void step_unit(struct multi_stream_engine *engine, const struct stream_unit *unit,
+                      const double *const *samples, int *labels, double *confidences) {
+    Vector **queries = engine->queries + unit->first;
+    int *query_streams = engine->query_streams + unit->first;
+    int ready_count = 0;
+    quantized_level levels[NUM_FEATURES];
+    for (int i = 0; i < unit->count; i++) {
+        int slot = unit->first + i;
+        int stream = engine->order[slot];
+        labels[stream] = -1;
+        confidences[stream] = 0.0;
+        if (!samples[stream]) {
+            continue;
+        }
+        quantizer_quantize_sample(unit->enc->quantizer, samples[stream], levels);
+        int ready = push_ngram_encoder_levels(unit->enc, &engine->states[stream], levels, engine->ngrams[slot]);
+        if (ready > 0) {
+            queries[ready_count] = engine->ngrams[slot];
+            query_streams[ready_count] = stream;
+            ready_count++;
+        }
+    }
+    if (ready_count == 0) {
+        return;
+    }
+
+    int *query_labels = engine->query_labels + unit->first;
+#if BIPOLAR_MODE
+    for (int q = 0; q < ready_count; q++) {
+        classify_topk(unit->assoc_mem, queries[q], 1, &query_labels[q], &confidences[query_streams[q]]);
+        labels[query_streams[q]] = query_labels[q];
+    }
+#else
+    int *distances = engine->query_distances + (size_t)unit->first * NUM_CLASSES;
+    classify_batch(unit->assoc_mem, queries, ready_count, query_labels, distances);
+    for (int q = 0; q < ready_count; q++) {
+        int stream = query_streams[q];
+        labels[stream] = query_labels[q];
+        if (query_labels[q] >= 0) {
+            confidences[stream] = hamming_similarity(distances[(size_t)q * unit->assoc_mem->num_classes + query_labels[q]]);
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Pushes the newest sample of every stream and classifies the ready n-grams.
+ *
+ * @param samples NUM_FEATURES values per stream; a NULL entry skips the stream
+ *        this tick (its n-gram state is kept).
+ * @param labels Receives a class per stream, -1 while its n-gram buffer fills or when skipped.
+ * @param confidences Receives the similarity of the predicted class per stream (0 without a decision).
+ * @return Number of streams with a decision.
+ */
+int multi_stream_step(struct multi_stream_engine *engine,
+                      const double *const *samples,
+                      int *labels,
+                      double *confidences) {
+    if (engine->num_units == 1) {
+        // No parallel region for a single unit: its fork/join would dominate the tick.
+        step_unit(engine, &engine->units[0], samples, labels, confidences);
+    } else {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for (int unit = 0; unit < engine->num_units; unit++) {
+            step_unit(engine, &engine->units[unit], samples, labels, confidences);
+        }
+    }
+    int decisions = 0;
+    for (int stream = 0; stream < engine->num_streams; stream++) {
+        decisions += labels[stream] >= 0;
+    }
+    return decisions;
+}
@@ -0,0 +1,43 @@
+#ifndef MULTI_STREAM_H
+#define MULTI_STREAM_H
+
+#ifdef HAND_EMG
+#include "../hand/configHand.h"
+#elif defined(FOOT_EMG)
+#include "../foot/configFoot.h"
+#elif defined(CUSTOM)
+#include "../customModel/configCustom.h"
+#else
+#error "No EMG type defined. Please define HAND_EMG or FOOT_EMG."
+#endif
+
+#include "assoc_mem.h"
+#include "encoder.h"
+
+#ifndef MULTI_STREAM_UNIT_STREAMS
+#define MULTI_STREAM_UNIT_STREAMS 16 // streams of one model advanced together by one thread
+#endif
+
+/**
+ * @brief Advances many independent sample streams (users, devices) one tick at a time.
+ *
+ * Every stream has its own n-gram state and may use its own encoder (with its
+ * own quantizer) and associative memory. Streams sharing a model are grouped
+ * into units of up to MULTI_STREAM_UNIT_STREAMS: a unit encodes its streams'
+ * timestamps back to back, so the model's item memory rows stay in cache, and
+ * classifies all of its ready n-grams with one `classify_batch` pass. Under
+ * OpenMP the units of a tick run in parallel.
+ */
+struct multi_stream_engine;
+
+struct multi_stream_engine *multi_stream_create(int num_streams,
+                                                struct encoder *const *encs,
+                                                struct associative_memory *const *assoc_mems);
+int multi_stream_step(struct multi_stream_engine *engine,
+                      const double *const *samples,
+                      int *labels,
+                      double *confidences);
+void multi_stream_reset(struct multi_stream_engine *engine, int stream);
+void multi_stream_free(struct multi_stream_engine *engine);
+
+#endif // MULTI_STREAM_H
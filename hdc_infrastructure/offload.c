@@ -0,0 +1,693 @@
+#include "offload.h"
+
+#if HDC_OFFLOAD
+
+#ifndef _OPENMP
+#error "HDC_OFFLOAD requires OpenMP (-fopenmp)."
+#endif
+
+#include "evaluator.h"
+#include "item_mem.h"
+#include "profiler.h"
+#include "vector.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#if OFFLOAD_SUPPORTED
+
+#define OFFLOAD_WORDS ((VECTOR_DIMENSION + 63) / 64)
+#define OFFLOAD_TAIL_MASK ((VECTOR_DIMENSION & 63) ? (1ull << (VECTOR_DIMENSION & 63)) - 1ull : ~0ull)
+#define OFFLOAD_COUNTER_PLANES 16 // bit planes of the timestamp majority, enough for 65535 features
+
+/**
+ * @brief Device buffers of one GA dataset, sized for OFFLOAD_BATCH_CANDIDATES genomes.
+ *
+ * The dataset, `ranks` and `min_words` are uploaded once; the per-genome
+ * buffers are reused by every launch. `ranks[feature][bit]` is the position of
+ * `bit` in the feature's flip order, so level `l` of a CiM row has the bit
+ * flipped exactly when its rank is below the level's flip target.
+ */
+struct offload_context {
+    int device;
+    int host;
+    int num_levels;
+    int num_features;
+    int training_samples;
+    int eval_samples;
+    int training_shards;
+    int eval_shards;
+    quantized_level *training_levels;
+    int *training_labels;
+    quantized_level *eval_levels;
+    int *eval_labels;
+    int *ranks;              // [feature][bit]
+    uint64_t *min_words;     // [feature][word]
+    int *targets;            // [genome][feature][level]
+    uint64_t *cims;          // [genome][level * num_features + feature][word]
+    uint64_t *rings;         // [genome * OFFLOAD_SHARDS + shard][N_GRAM_SIZE][word]
+    int *counters;           // [genome][shard][class][bit]
+    int *counts;             // [genome][shard][class]
+    uint64_t *classes;       // [genome][class][word]
+    int *confusion;          // [genome][shard][actual][predicted]
+    double *similarity;      // [genome]
+    int *invalid;            // set when an n-gram is VECTOR_DIMENSION away from every class
+    int *host_targets;
+    int *host_confusion;
+    double *host_similarity;
+};
+
+#pragma omp declare target
+/**
+ * @brief Word `word` of the majority of the CiM rows selected by `levels` (bit set at >= num_features / 2).
+ */
+static uint64_t offload_timestamp_word(const uint64_t *cim,
+                                       const quantized_level *levels,
+                                       int num_features,
+                                       int word) {
+    uint64_t planes[OFFLOAD_COUNTER_PLANES] = {0};
+    int nbits = 1;
+    while (nbits < OFFLOAD_COUNTER_PLANES && (1 << nbits) <= num_features) {
+        nbits++;
+    }
+    for (int feature = 0; feature < num_features; feature++) {
+        uint64_t carry = cim[((size_t)levels[feature] * num_features + feature) * OFFLOAD_WORDS + word];
+        for (int b = 0; b < nbits && carry; b++) {
+            uint64_t next = planes[b] & carry;
+            planes[b] ^= carry;
+            carry = next;
+        }
+    }
+    int threshold = num_features / 2;
+    uint64_t greater = 0ull;
+    uint64_t equal = ~0ull;
+    for (int b = nbits - 1; b >= 0; b--) {
+        if ((threshold >> b) & 1) {
+            equal &= planes[b];
+        } else {
+            greater |= equal & planes[b];
+            equal &= ~planes[b];
+        }
+    }
+    return (greater | equal) & (word == OFFLOAD_WORDS - 1 ? OFFLOAD_TAIL_MASK : ~0ull);
+}
+
+/**
+ * @brief `count` bits of `v` from bit `start` on (`start + count <= VECTOR_DIMENSION`).
+ */
+static uint64_t offload_bits(const uint64_t *v, int start, int count) {
+    int word = start >> 6;
+    int offset = start & 63;
+    uint64_t bits = v[word] >> offset;
+    if (offset != 0 && offset + count > 64) {
+        bits |= v[word + 1] << (64 - offset);
+    }
+    return count == 64 ? bits : bits & ((1ull << count) - 1ull);
+}
+
+/**
+ * @brief Word `word` of `permute(v, shift)`: result bit i is bit (i - shift) mod VECTOR_DIMENSION of `v`.
+ */
+static uint64_t offload_rotated_word(const uint64_t *v, int shift, int word) {
+    int start = word * 64 - shift % VECTOR_DIMENSION;
+    if (start < 0) {
+        start += VECTOR_DIMENSION;
+    }
+    uint64_t result = 0ull;
+    int got = 0;
+    while (got < 64) {
+        int take = VECTOR_DIMENSION - start;
+        if (take > 64 - got) {
+            take = 64 - got;
+        }
+        result |= offload_bits(v, start, take) << got;
+        got += take;
+        start = 0;
+    }
+    return result & (word == OFFLOAD_WORDS - 1 ? OFFLOAD_TAIL_MASK : ~0ull);
+}
+
+/**
+ * @brief Word `word` of the n-gram in `ring` after `pushes` timestamps: XOR of rho^(N-1-i)(s_i), s_0 oldest.
+ */
+static uint64_t offload_ngram_word(const uint64_t *ring, int pushes, int word) {
+    uint64_t result = 0ull;
+    for (int i = 0; i < N_GRAM_SIZE; i++) {
+        int slot = (pushes - N_GRAM_SIZE + i) % N_GRAM_SIZE;
+        result ^= offload_rotated_word(ring + (size_t)slot * OFFLOAD_WORDS, N_GRAM_SIZE - 1 - i, word);
+    }
+    return result;
+}
+
+/**
+ * @brief Same as `mode` in evaluator.c: most frequent label, ties going to the smallest.
+ */
+static int offload_mode(const int *labels, int size) {
+    int max_value = 0;
+    int max_count = 0;
+    for (int i = 0; i < size; i++) {
+        int count = 0;
+        for (int j = 0; j < size; j++) {
+            if (labels[j] == labels[i]) {
+                count++;
+            }
+        }
+        if (count > max_count || (count == max_count && labels[i] < max_value)) {
+            max_count = count;
+            max_value = labels[i];
+        }
+    }
+    return max_value;
+}
+#pragma omp end declare target
+
+static void *offload_alloc(struct offload_context *ctx, size_t bytes) {
+    return omp_target_alloc(bytes > 0 ? bytes : 1, ctx->device);
+}
+
+static int offload_upload(struct offload_context *ctx, void *dst, const void *src, size_t bytes) {
+    return omp_target_memcpy(dst, (void *)src, bytes, 0, 0, ctx->device, ctx->host);
+}
+
+static int offload_download(struct offload_context *ctx, void *dst, const void *src, size_t bytes) {
+    return omp_target_memcpy(dst, (void *)src, bytes, 0, 0, ctx->host, ctx->device);
+}
+
+/**
+ * @brief Shards a sweep of `samples` is split into: OFFLOAD_SHARDS, fewer for short sweeps.
+ */
+static int offload_shards(int samples) {
+    int shards = samples / (4 * N_GRAM_SIZE);
+    if (shards > OFFLOAD_SHARDS) {
+        shards = OFFLOAD_SHARDS;
+    }
+    return shards < 1 ? 1 : shards;
+}
+
+/**
+ * @brief Copies a GA dataset to the default offload device (the host without one).
+ *
+ * @param training_levels Quantized training set.
+ * @param training_labels Labels of the training set.
+ * @param eval_levels Quantized set the fitness is evaluated on.
+ * @param eval_labels Labels of the evaluation set.
+ * @param permutations Flip order per feature, row-major num_features x VECTOR_DIMENSION.
+ * @param num_levels Quantization levels.
+ * @param num_features Features per sample; must equal NUM_FEATURES.
+ * @return The context, or NULL if the data cannot be offloaded (too short, the
+ *         flip orders are not permutations, or device memory runs out); the
+ *         caller then keeps the CPU evaluation.
+ */
+struct offload_context *offload_create(const struct quantized_dataset *training_levels,
+                                       const int *training_labels,
+                                       const struct quantized_dataset *eval_levels,
+                                       const int *eval_labels,
+                                       const int *permutations,
+                                       int num_levels,
+                                       int num_features) {
+    if (!training_levels || !training_labels || !eval_levels || !eval_labels || !permutations ||
+        num_levels < 2 || num_features != NUM_FEATURES || training_levels->num_samples <= N_GRAM_SIZE ||
+        eval_levels->num_samples < N_GRAM_SIZE) {
+        return NULL;
+    }
+
+    int *ranks = (int *)malloc((size_t)num_features * VECTOR_DIMENSION * sizeof(int));
+    vector_element *min_storage = NULL;
+    Vector **min_vectors = create_vector_slab(num_features, &min_storage);
+    uint64_t *min_words = (uint64_t *)malloc((size_t)num_features * OFFLOAD_WORDS * sizeof(uint64_t));
+    struct offload_context *ctx = (struct offload_context *)calloc(1, sizeof(*ctx));
+    if (!ranks || !min_words || !ctx) {
+        free(ranks);
+        free(min_words);
+        free(ctx);
+        free_vector_slab(min_vectors, min_storage);
+        return NULL;
+    }
+
+    int valid = 1;
+    for (int feature = 0; feature < num_features && valid; feature++) {
+        int *rank = ranks + (size_t)feature * VECTOR_DIMENSION;
+        const int *perm = permutations + (size_t)feature * VECTOR_DIMENSION;
+        for (int bit = 0; bit < VECTOR_DIMENSION; bit++) {
+            rank[bit] = -1;
+        }
+        for (int k = 0; k < VECTOR_DIMENSION; k++) {
+            if (perm[k] < 0 || perm[k] >= VECTOR_DIMENSION || rank[perm[k]] >= 0) {
+                valid = 0;
+                break;
+            }
+            rank[perm[k]] = k;
+        }
+    }
+    generate_item_memory_min_vectors(min_vectors, num_features, permutations);
+    for (int feature = 0; feature < num_features; feature++) {
+        memcpy(min_words + (size_t)feature * OFFLOAD_WORDS, min_vectors[feature]->data,
+               OFFLOAD_WORDS * sizeof(uint64_t));
+        min_words[(size_t)feature * OFFLOAD_WORDS + OFFLOAD_WORDS - 1] &= OFFLOAD_TAIL_MASK;
+    }
+    free_vector_slab(min_vectors, min_storage);
+    if (!valid) {
+        free(ranks);
+        free(min_words);
+        free(ctx);
+        return NULL;
+    }
+
+    ctx->host = omp_get_initial_device();
+    ctx->device = omp_get_num_devices() > 0 ? omp_get_default_device() : ctx->host;
+    ctx->num_levels = num_levels;
+    ctx->num_features = num_features;
+    ctx->training_samples = training_levels->num_samples;
+    ctx->eval_samples = eval_levels->num_samples;
+    // The training sweep leaves out the last sample, as train_model_timeseries_quantized_sharded does.
+    ctx->training_shards = offload_shards(ctx->training_samples - 1);
+    ctx->eval_shards = offload_shards(ctx->eval_samples);
+
+    size_t batch = OFFLOAD_BATCH_CANDIDATES;
+    size_t rows = (size_t)num_levels * num_features;
+    size_t training_bytes = (size_t)ctx->training_samples * num_features * sizeof(quantized_level);
+    size_t eval_bytes = (size_t)ctx->eval_samples * num_features * sizeof(quantized_level);
+    ctx->training_levels = (quantized_level *)offload_alloc(ctx, training_bytes);
+    ctx->training_labels = (int *)offload_alloc(ctx, (size_t)ctx->training_samples * sizeof(int));
+    ctx->eval_levels = (quantized_level *)offload_alloc(ctx, eval_bytes);
+    ctx->eval_labels = (int *)offload_alloc(ctx, (size_t)ctx->eval_samples * sizeof(int));
+    ctx->ranks = (int *)offload_alloc(ctx, (size_t)num_features * VECTOR_DIMENSION * sizeof(int));
+    ctx->min_words = (uint64_t *)offload_alloc(ctx, (size_t)num_features * OFFLOAD_WORDS * sizeof(uint64_t));
+    ctx->targets = (int *)offload_alloc(ctx, batch * num_features * num_levels * sizeof(int));
+    ctx->cims = (uint64_t *)offload_alloc(ctx, batch * rows * OFFLOAD_WORDS * sizeof(uint64_t));
+    ctx->rings = (uint64_t *)offload_alloc(ctx, batch * OFFLOAD_SHARDS * N_GRAM_SIZE * OFFLOAD_WORDS * sizeof(uint64_t));
+    ctx->counters = (int *)offload_alloc(ctx, batch * OFFLOAD_SHARDS * NUM_CLASSES * VECTOR_DIMENSION * sizeof(int));
+    ctx->counts = (int *)offload_alloc(ctx, batch * OFFLOAD_SHARDS * NUM_CLASSES * sizeof(int));
+    ctx->classes = (uint64_t *)offload_alloc(ctx, batch * NUM_CLASSES * OFFLOAD_WORDS * sizeof(uint64_t));
+    ctx->confusion = (int *)offload_alloc(ctx, batch * OFFLOAD_SHARDS * NUM_CLASSES * NUM_CLASSES * sizeof(int));
+    ctx->similarity = (double *)offload_alloc(ctx, batch * sizeof(double));
+    ctx->invalid = (int *)offload_alloc(ctx, sizeof(int));
+    ctx->host_targets = (int *)malloc(batch * num_features * num_levels * sizeof(int));
+    ctx->host_confusion = (int *)malloc(batch * OFFLOAD_SHARDS * NUM_CLASSES * NUM_CLASSES * sizeof(int));
+    ctx->host_similarity = (double *)malloc(batch * sizeof(double));
+    if (!ctx->training_levels || !ctx->training_labels || !ctx->eval_levels || !ctx->eval_labels ||
+        !ctx->ranks || !ctx->min_words || !ctx->targets || !ctx->cims || !ctx->rings || !ctx->counters ||
+        !ctx->counts || !ctx->classes || !ctx->confusion || !ctx->similarity || !ctx->invalid ||
+        !ctx->host_targets || !ctx->host_confusion || !ctx->host_similarity ||
+        offload_upload(ctx, ctx->training_levels, training_levels->levels, training_bytes) != 0 ||
+        offload_upload(ctx, ctx->training_labels, training_labels, (size_t)ctx->training_samples * sizeof(int)) != 0 ||
+        offload_upload(ctx, ctx->eval_levels, eval_levels->levels, eval_bytes) != 0 ||
+        offload_upload(ctx, ctx->eval_labels, eval_labels, (size_t)ctx->eval_samples * sizeof(int)) != 0 ||
+        offload_upload(ctx, ctx->ranks, ranks, (size_t)num_features * VECTOR_DIMENSION * sizeof(int)) != 0 ||
+        offload_upload(ctx, ctx->min_words, min_words, (size_t)num_features * OFFLOAD_WORDS * sizeof(uint64_t)) != 0) {
+        fprintf(stderr, "Failed to set up the offload device; GA fitness stays on the CPU.\n");
+        offload_free(ctx);
+        ctx = NULL;
+    }
+    free(ranks);
+    free(min_words);
+    return ctx;
+}
+
+/**
+ * @brief Builds the CiMs of `count` genomes from their flip targets.
+ */
+static void offload_build_cims(struct offload_context *ctx, int count) {
+    int device = ctx->device;
+    int num_levels = ctx->num_levels;
+    int num_features = ctx->num_features;
+    const int *ranks = ctx->ranks;
+    const uint64_t *min_words = ctx->min_words;
+    const int *targets = ctx->targets;
+    uint64_t *cims = ctx->cims;
+    long long rows = (long long)num_levels * num_features;
+    long long total = (long long)count * rows * OFFLOAD_WORDS;
+
+#pragma omp target teams distribute parallel for device(device) is_device_ptr(ranks, min_words, targets, cims)
+    for (long long i = 0; i < total; i++) {
+        int word = (int)(i % OFFLOAD_WORDS);
+        long long row_index = i / OFFLOAD_WORDS;
+        int row = (int)(row_index % rows);
+        int genome = (int)(row_index / rows);
+        int level = row / num_features;
+        int feature = row % num_features;
+        int target = targets[((size_t)genome * num_features + feature) * num_levels + level];
+        const int *rank = ranks + (size_t)feature * VECTOR_DIMENSION + (size_t)word * 64;
+        int bits = VECTOR_DIMENSION - word * 64 < 64 ? VECTOR_DIMENSION - word * 64 : 64;
+        uint64_t flips = 0ull;
+        for (int b = 0; b < bits; b++) {
+            flips |= (uint64_t)(rank[b] < target) << b;
+        }
+        cims[i] = min_words[(size_t)feature * OFFLOAD_WORDS + word] ^ flips;
+    }
+}
+
+/**
+ * @brief Trains the class vectors of `count` genomes.
+ *
+ * One team per genome and shard counts the n-grams ending in its share of
+ * samples [0, training_samples - 1); like `train_quantized_range` it first
+ * replays the samples back to the last label change or N_GRAM_SIZE - 1
+ * samples, so the summed counters equal those of one sweep. The class bits
+ * are then set where the counter reaches half the class's n-grams.
+ */
+static void offload_train(struct offload_context *ctx, int count) {
+    int device = ctx->device;
+    int num_features = ctx->num_features;
+    int shards = ctx->training_shards;
+    int sweep_samples = ctx->training_samples - 1;
+    const quantized_level *levels = ctx->training_levels;
+    const int *labels = ctx->training_labels;
+    const uint64_t *cims = ctx->cims;
+    uint64_t *rings = ctx->rings;
+    int *counters = ctx->counters;
+    int *counts = ctx->counts;
+    uint64_t *classes = ctx->classes;
+    size_t cim_words = (size_t)ctx->num_levels * num_features * OFFLOAD_WORDS;
+    long long counter_total = (long long)count * shards * NUM_CLASSES * VECTOR_DIMENSION;
+
+#pragma omp target teams distribute parallel for device(device) is_device_ptr(counters)
+    for (long long i = 0; i < counter_total; i++) {
+        counters[i] = 0;
+    }
+
+#pragma omp target teams distribute device(device) is_device_ptr(levels, labels, cims, rings, counters, counts)
+    for (int job = 0; job < count * shards; job++) {
+        int genome = job / shards;
+        int shard = job % shards;
+        int begin = (int)((long long)sweep_samples * shard / shards);
+        int end = (int)((long long)sweep_samples * (shard + 1) / shards);
+        const uint64_t *cim = cims + (size_t)genome * cim_words;
+        uint64_t *ring = rings + (size_t)job * N_GRAM_SIZE * OFFLOAD_WORDS;
+        int *job_counters = counters + (size_t)job * NUM_CLASSES * VECTOR_DIMENSION;
+        int *job_counts = counts + (size_t)job * NUM_CLASSES;
+        for (int c = 0; c < NUM_CLASSES; c++) {
+            job_counts[c] = 0;
+        }
+
+        int warmup = begin;
+        while (warmup > 0 && begin - warmup < N_GRAM_SIZE - 1 && labels[warmup] == labels[warmup - 1]) {
+            warmup--;
+        }
+        int pushes = 0;
+        for (int sample = warmup; sample < end; sample++) {
+            if (sample > warmup && labels[sample] != labels[sample - 1]) {
+                pushes = 0;
+            }
+            const quantized_level *row = levels + (size_t)sample * num_features;
+            uint64_t *slot = ring + (size_t)(pushes % N_GRAM_SIZE) * OFFLOAD_WORDS;
+#pragma omp parallel for
+            for (int w = 0; w < OFFLOAD_WORDS; w++) {
+                slot[w] = offload_timestamp_word(cim, row, num_features, w);
+            }
+            pushes++;
+
+            int class_id = labels[sample];
+            if (pushes < N_GRAM_SIZE || sample < begin || class_id < 0 || class_id >= NUM_CLASSES) {
+                continue;
+            }
+            int *class_counters = job_counters + (size_t)class_id * VECTOR_DIMENSION;
+#pragma omp parallel for
+            for (int w = 0; w < OFFLOAD_WORDS; w++) {
+                uint64_t ngram = offload_ngram_word(ring, pushes, w);
+                int bits = VECTOR_DIMENSION - w * 64 < 64 ? VECTOR_DIMENSION - w * 64 : 64;
+                for (int b = 0; b < bits; b++) {
+                    class_counters[w * 64 + b] += (int)((ngram >> b) & 1ull);
+                }
+            }
+            job_counts[class_id]++;
+        }
+    }
+
+    long long class_total = (long long)count * NUM_CLASSES * OFFLOAD_WORDS;
+#pragma omp target teams distribute parallel for device(device) is_device_ptr(counters, counts, classes)
+    for (long long i = 0; i < class_total; i++) {
+        int word = (int)(i % OFFLOAD_WORDS);
+        int class_id = (int)((i / OFFLOAD_WORDS) % NUM_CLASSES);
+        int genome = (int)(i / ((long long)OFFLOAD_WORDS * NUM_CLASSES));
+        int vectors = 0;
+        for (int shard = 0; shard < shards; shard++) {
+            vectors += counts[((size_t)genome * shards + shard) * NUM_CLASSES + class_id];
+        }
+        int threshold = vectors / 2;
+        int bits = VECTOR_DIMENSION - word * 64 < 64 ? VECTOR_DIMENSION - word * 64 : 64;
+        uint64_t result = 0ull;
+        for (int b = 0; b < bits; b++) {
+            int sum = 0;
+            for (int shard = 0; shard < shards; shard++) {
+                sum += counters[(((size_t)genome * shards + shard) * NUM_CLASSES + class_id) * VECTOR_DIMENSION +
+                                (size_t)word * 64 + b];
+            }
+            result |= (uint64_t)(sum >= threshold) << b;
+        }
+        classes[i] = result;
+    }
+}
+
+/**
+ * @brief Classifies the evaluation set with the class vectors of `count` genomes.
+ *
+ * One team per genome and shard fills a confusion matrix for the n-grams ending
+ * in its share of samples, replaying the N_GRAM_SIZE - 1 samples before it;
+ * nearest class by Hamming distance, ties to the lower id. The class-vector
+ * similarity is computed per genome as in `compute_class_vector_similarity`.
+ */
+static void offload_evaluate(struct offload_context *ctx, int count) {
+    int device = ctx->device;
+    int num_features = ctx->num_features;
+    int shards = ctx->eval_shards;
+    int samples = ctx->eval_samples;
+    const quantized_level *levels = ctx->eval_levels;
+    const int *labels = ctx->eval_labels;
+    const uint64_t *cims = ctx->cims;
+    const uint64_t *classes = ctx->classes;
+    uint64_t *rings = ctx->rings;
+    int *confusion = ctx->confusion;
+    double *similarity = ctx->similarity;
+    int *invalid = ctx->invalid;
+    size_t cim_words = (size_t)ctx->num_levels * num_features * OFFLOAD_WORDS;
+
+#pragma omp target device(device) is_device_ptr(invalid)
+    {
+        *invalid = 0;
+    }
+
+#pragma omp target teams distribute device(device) is_device_ptr(levels, labels, cims, classes, rings, confusion, invalid)
+    for (int job = 0; job < count * shards; job++) {
+        int genome = job / shards;
+        int shard = job % shards;
+        int begin = (int)((long long)samples * shard / shards);
+        int end = (int)((long long)samples * (shard + 1) / shards);
+        const uint64_t *cim = cims + (size_t)genome * cim_words;
+        const uint64_t *class_words = classes + (size_t)genome * NUM_CLASSES * OFFLOAD_WORDS;
+        uint64_t *ring = rings + (size_t)job * N_GRAM_SIZE * OFFLOAD_WORDS;
+        int *job_confusion = confusion + (size_t)job * NUM_CLASSES * NUM_CLASSES;
+        for (int c = 0; c < NUM_CLASSES * NUM_CLASSES; c++) {
+            job_confusion[c] = 0;
+        }
+
+        int warmup = begin - (N_GRAM_SIZE - 1);
+        if (warmup < 0) {
+            warmup = 0;
+        }
+        int pushes = 0;
+        for (int sample = warmup; sample < end; sample++) {
+            const quantized_level *row = levels + (size_t)sample * num_features;
+            uint64_t *slot = ring + (size_t)(pushes % N_GRAM_SIZE) * OFFLOAD_WORDS;
+#pragma omp parallel for
+            for (int w = 0; w < OFFLOAD_WORDS; w++) {
+                slot[w] = offload_timestamp_word(cim, row, num_features, w);
+            }
+            pushes++;
+            if (pushes < N_GRAM_SIZE || sample < begin) {
+                continue;
+            }
+
+            int distances[NUM_CLASSES] = {0};
+#pragma omp parallel for reduction(+ : distances[:NUM_CLASSES])
+            for (int w = 0; w < OFFLOAD_WORDS; w++) {
+                uint64_t ngram = offload_ngram_word(ring, pushes, w);
+                for (int c = 0; c < NUM_CLASSES; c++) {
+                    distances[c] += __builtin_popcountll(ngram ^ class_words[(size_t)c * OFFLOAD_WORDS + w]);
+                }
+            }
+            int predicted = -1;
+            int best = VECTOR_DIMENSION;
+            for (int c = 0; c < NUM_CLASSES; c++) {
+                if (distances[c] < best) {
+                    best = distances[c];
+                    predicted = c;
+                }
+            }
+            int actual = offload_mode(labels + sample - N_GRAM_SIZE + 1, N_GRAM_SIZE);
+            if (predicted < 0) {
+#pragma omp atomic write
+                *invalid = 1;
+            } else if (actual >= 0 && actual < NUM_CLASSES) {
+                job_confusion[actual * NUM_CLASSES + predicted]++;
+            }
+        }
+    }
+
+#pragma omp target teams distribute parallel for device(device) is_device_ptr(classes, similarity)
+    for (int genome = 0; genome < count; genome++) {
+        const uint64_t *class_words = classes + (size_t)genome * NUM_CLASSES * OFFLOAD_WORDS;
+        double sum = 0.0;
+        int pairs = 0;
+        for (int i = 0; i < NUM_CLASSES; i++) {
+            for (int j = i + 1; j < NUM_CLASSES; j++) {
+                int distance = 0;
+                for (int w = 0; w < OFFLOAD_WORDS; w++) {
+                    distance += __builtin_popcountll(class_words[(size_t)i * OFFLOAD_WORDS + w] ^
+                                                     class_words[(size_t)j * OFFLOAD_WORDS + w]);
+                }
+                sum += 1.0 - 2.0 * ((double)distance / VECTOR_DIMENSION);
+                pairs++;
+            }
+        }
+        similarity[genome] = pairs > 0 ? sum / (double)pairs : 0.0;
+    }
+}
+
+/**
+ * @brief Scores genomes on the offload device.
+ *
+ * @param ctx Context from `offload_create`.
+ * @param genomes Genomes of `genome_length` flip counts, indexed by candidate
+ *        (feature-major, as `build_precomp_item_memory_with_B` reads them).
+ * @param candidates Indices into `genomes` of the `count` genomes to score.
+ * @param out_accuracy Receives the class-average accuracy, indexed by candidate.
+ * @param out_similarity Receives the class-vector similarity, indexed by candidate.
+ * @return 0 on success, -1 if `genome_length` does not match the context.
+ */
+int offload_evaluate_population(struct offload_context *ctx,
+                                const uint16_t *genomes,
+                                int genome_length,
+                                const int *candidates,
+                                int count,
+                                double *out_accuracy,
+                                double *out_similarity) {
+    int num_levels = ctx ? ctx->num_levels : 0;
+    int num_features = ctx ? ctx->num_features : 0;
+    if (!ctx || !genomes || genome_length != (num_levels - 1) * num_features) {
+        return -1;
+    }
+    HDC_PROFILE_BEGIN(HDC_STAGE_GA_EVALUATE);
+    for (int first = 0; first < count; first += OFFLOAD_BATCH_CANDIDATES) {
+        int batch = count - first < OFFLOAD_BATCH_CANDIDATES ? count - first : OFFLOAD_BATCH_CANDIDATES;
+        for (int m = 0; m < batch; m++) {
+            const uint16_t *B = &genomes[(size_t)candidates[first + m] * (size_t)genome_length];
+            for (int feature = 0; feature < num_features; feature++) {
+                int *targets = ctx->host_targets + ((size_t)m * num_features + feature) * num_levels;
+                targets[0] = 0;
+                for (int level = 1; level < num_levels; level++) {
+                    int target = targets[level - 1] + B[feature * (num_levels - 1) + (level - 1)];
+                    targets[level] = target > GA_MAX_FLIPS_CIM ? GA_MAX_FLIPS_CIM : target;
+                }
+            }
+        }
+        size_t confusion_ints = (size_t)batch * ctx->eval_shards * NUM_CLASSES * NUM_CLASSES;
+        int invalid = 0;
+        if (offload_upload(ctx, ctx->targets, ctx->host_targets,
+                           (size_t)batch * num_features * num_levels * sizeof(int)) != 0) {
+            fprintf(stderr, "Failed to copy GA genomes to the offload device.\n");
+            exit(EXIT_FAILURE);
+        }
+        offload_build_cims(ctx, batch);
+        offload_train(ctx, batch);
+        offload_evaluate(ctx, batch);
+        if (offload_download(ctx, ctx->host_confusion, ctx->confusion, confusion_ints * sizeof(int)) != 0 ||
+            offload_download(ctx, ctx->host_similarity, ctx->similarity, (size_t)batch * sizeof(double)) != 0 ||
+            offload_download(ctx, &invalid, ctx->invalid, sizeof(int)) != 0) {
+            fprintf(stderr, "Failed to copy GA fitness from the offload device.\n");
+            exit(EXIT_FAILURE);
+        }
+        if (invalid) {
+            fprintf(stderr, "Label not valid, terminating...");
+            exit(EXIT_FAILURE);
+        }
+
+        for (int m = 0; m < batch; m++) {
+            // The fitness only needs the confusion matrix; correct/not_correct are not split by transitions.
+            struct timeseries_eval_result result;
+            memset(&result, 0, sizeof(result));
+            for (int shard = 0; shard < ctx->eval_shards; shard++) {
+                const int *part = ctx->host_confusion + ((size_t)m * ctx->eval_shards + shard) * NUM_CLASSES * NUM_CLASSES;
+                for (int actual = 0; actual < NUM_CLASSES; actual++) {
+                    for (int predicted = 0; predicted < NUM_CLASSES; predicted++) {
+                        int n = part[actual * NUM_CLASSES + predicted];
+                        result.confusion_matrix[actual][predicted] += n;
+                        if (actual == predicted) {
+                            result.correct += (size_t)n;
+                        } else {
+                            result.not_correct += (size_t)n;
+                        }
+                    }
+                }
+            }
+            finish_timeseries_eval_result(&result, NULL);
+            int c = candidates[first + m];
+            out_accuracy[c] = result.class_average_accuracy;
+            out_similarity[c] = ctx->host_similarity[m];
+        }
+    }
+    HDC_PROFILE_END(HDC_STAGE_GA_EVALUATE, count);
+    return 0;
+}
+
+void offload_free(struct offload_context *ctx) {
+    if (!ctx) {
+        return;
+    }
+    void *device_buffers[] = {ctx->training_levels, ctx->training_labels, ctx->eval_levels, ctx->eval_labels,
+                              ctx->ranks, ctx->min_words, ctx->targets, ctx->cims, ctx->rings, ctx->counters,
+                              ctx->counts, ctx->classes, ctx->confusion, ctx->similarity, ctx->invalid};
+    for (size_t i = 0; i < sizeof(device_buffers) / sizeof(device_buffers[0]); i++) {
+        if (device_buffers[i]) {
+            omp_target_free(device_buffers[i], ctx->device);
+        }
+    }
+    free(ctx->host_targets);
+    free(ctx->host_confusion);
+    free(ctx->host_similarity);
+    free(ctx);
+}
+
+#else
+
+struct offload_context *offload_create(const struct quantized_dataset *training_levels,
+                                       const int *training_labels,
+                                       const struct quantized_dataset *eval_levels,
+                                       const int *eval_labels,
+                                       const int *permutations,
+                                       int num_levels,
+                                       int num_features) {
+    (void)training_levels;
+    (void)training_labels;
+    (void)eval_levels;
+    (void)eval_labels;
+    (void)permutations;
+    (void)num_levels;
+    (void)num_features;
+    return NULL;
+}
+
+int offload_evaluate_population(struct offload_context *ctx,
+                                const uint16_t *genomes,
+                                int genome_length,
+                                const int *candidates,
+                                int count,
+                                double *out_accuracy,
+                                double *out_similarity) {
+    (void)ctx;
+    (void)genomes;
+    (void)genome_length;
+    (void)candidates;
+    (void)count;
+    (void)out_accuracy;
+    (void)out_similarity;
+    return -1;
+}
+
+void offload_free(struct offload_context *ctx) {
+    (void)ctx;
+}
+
+#endif // OFFLOAD_SUPPORTED
+#endif // HDC_OFFLOAD
@@ -0,0 +1,66 @@
+#ifndef OFFLOAD_H
+#define OFFLOAD_H
+
+#include <stdint.h>
+
+#ifdef HAND_EMG
+#include "../hand/configHand.h"
+#elif defined(FOOT_EMG)
+#include "../foot/configFoot.h"
+#elif defined(CUSTOM)
+#include "../customModel/configCustom.h"
+#else
+#error "No EMG type defined. Please define HAND_EMG or FOOT_EMG."
+#endif
+
+#include "assoc_mem.h"
+#include "quantizer.h"
+
+#ifndef HDC_OFFLOAD
+#define HDC_OFFLOAD 0 // score GA populations with OpenMP target offload (build with OFFLOAD_TARGET for a GPU)
+#endif
+#ifndef OFFLOAD_BATCH_CANDIDATES
+#define OFFLOAD_BATCH_CANDIDATES 128 // genomes per kernel launch; sizes the device buffers
+#endif
+#ifndef OFFLOAD_SHARDS
+#define OFFLOAD_SHARDS 8 // data shards per genome; genomes x shards device teams
+#endif
+
+// Binary precomputed item memories, n-gram model, unpruned class vectors.
+#define OFFLOAD_SUPPORTED (PRECOMPUTED_ITEM_MEMORY && !BIPOLAR_MODE && \
+                           MODEL_VARIANT != MODEL_VARIANT_KRISCHAN && !ASSOC_MEM_PRUNE_DIMENSIONS)
+
+/**
+ * @brief GA fitness evaluation on an OpenMP offload device.
+ *
+ * `offload_create` copies the quantized training and evaluation sets, the
+ * flip orders and the level-0 item memory vectors to the device once. Every
+ * `offload_evaluate_population` call then uploads only the genomes, builds
+ * their CiMs, trains and evaluates up to OFFLOAD_BATCH_CANDIDATES of them per
+ * kernel launch and copies back one confusion matrix and one class-vector
+ * similarity per genome. The scores are identical to the CPU evaluation.
+ *
+ * Without an offload device (or a build without OFFLOAD_TARGET) the target
+ * regions run on the host.
+ */
+struct offload_context;
+
+#if HDC_OFFLOAD
+struct offload_context *offload_create(const struct quantized_dataset *training_levels,
+                                       const int *training_labels,
+                                       const struct quantized_dataset *eval_levels,
+                                       const int *eval_labels,
+                                       const int *permutations,
+                                       int num_levels,
+                                       int num_features);
+int offload_evaluate_population(struct offload_context *ctx,
+                                const uint16_t *genomes,
+                                int genome_length,
+                                const int *candidates,
+                                int count,
+                                double *out_accuracy,
+                                double *out_similarity);
+void offload_free(struct offload_context *ctx);
+#endif
+
+#endif // OFFLOAD_H
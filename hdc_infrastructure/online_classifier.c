@@ -3,16 +3,23 @@
  * @brief Implements real-time classification for EMG signals using HDC models.
  *
  * This file contains functionality to initialize an online classifier, process
- * streaming EMG data in batches, and calculate predictions based on similarity measures.
+ * streaming EMG data sample by sample or in batches, and calculate predictions
+ * based on similarity measures.
  * 
  * @details
- * The online classifier uses a batch-based approach to process EMG signals and 
- * classify them using hyperdimensional computing principles. It supports both 
+ * The online classifier keeps the n-gram ring buffer of its workspace across
+ * calls: every incoming sample costs one timestamp encoding and one
+ * classification, independent of N_GRAM_SIZE, and no memory is allocated after
+ * initialization. Per-sample decisions can be smoothed by a majority vote or an
+ * exponential moving average of the class similarities. It supports both 
  * bipolar and binary vector modes and utilizes the associative memory for classification.
  * @author Marian Horn
  */
 #include "online_classifier.h"
 #include "vector.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 /**
  * @brief Initializes an online classifier for real-time EMG signal evaluation.
  *
@@ -23,6 +30,9 @@
  * @param assMem A pointer to the associative memory used for classification.
  * @param enc A pointer to the encoder used for feature extraction.
  * @param batchSize The number of samples to process in one batch.
+ *
+ * @note The classifier owns a scratch workspace; release it with `free_online_classifier`.
+ *       Smoothing starts as ONLINE_SMOOTHING over ONLINE_SMOOTHING_WINDOW decisions.
  */
 void init_online_classifier(struct onlineClassifier* classifier, 
                             struct associative_memory* assMem, 
@@ -31,28 +41,194 @@ void init_online_classifier(struct onlineClassifier* classifier,
     classifier->assoc_mem = assMem;
     classifier->enc = enc;
     classifier->batch_size = batchSize;
+    init_hdc_workspace(&classifier->workspace);
+    set_online_smoothing(classifier, ONLINE_SMOOTHING, ONLINE_SMOOTHING_WINDOW);
+}
+/**
+ * @brief Releases the scratch memory owned by an online classifier.
+ *
+ * @param classifier A pointer to the `onlineClassifier` structure to release.
+ */
+void free_online_classifier(struct onlineClassifier* classifier) {
+    if (classifier == NULL) {
+        return;
+    }
+    free_hdc_workspace(&classifier->workspace);
+}
+/**
+ * @brief Selects how `online_push_sample` smooths its decisions and restarts the smoothing.
+ *
+ * @param classifier A pointer to the `onlineClassifier` structure.
+ * @param smoothing One of ONLINE_SMOOTHING_NONE, ONLINE_SMOOTHING_MAJORITY or
+ *        ONLINE_SMOOTHING_EXPONENTIAL.
+ * @param window Decisions in the majority vote (capped at ONLINE_SMOOTHING_MAX_WINDOW),
+ *        or the span of the moving average (weight 2 / (window + 1) for the newest n-gram).
+ */
+void set_online_smoothing(struct onlineClassifier* classifier, int smoothing, int window) {
+    if (window < 1) {
+        window = 1;
+    } else if (window > ONLINE_SMOOTHING_MAX_WINDOW && smoothing == ONLINE_SMOOTHING_MAJORITY) {
+        window = ONLINE_SMOOTHING_MAX_WINDOW;
+    }
+    classifier->smoothing = smoothing;
+    classifier->smoothing_window = window;
+    classifier->history_pos = 0;
+    classifier->history_count = 0;
+    classifier->scores_valid = 0;
+    memset(classifier->votes, 0, sizeof(classifier->votes));
+    memset(classifier->scores, 0, sizeof(classifier->scores));
+}
+
+/**
+ * @brief Restarts the sample stream: empties the n-gram ring buffer and the smoothing state.
+ *
+ * Call this when the input stream is interrupted, so the next n-gram does not
+ * span the gap.
+ */
+void reset_online_classifier(struct onlineClassifier* classifier) {
+    reset_ngram_encoder_state(&classifier->workspace.ngram_state);
+    set_online_smoothing(classifier, classifier->smoothing, classifier->smoothing_window);
 }
+
+/**
+ * @brief Majority vote over the last `smoothing_window` raw decisions.
+ *
+ * Ties go to the newest decision if it is among the leaders, otherwise to the
+ * lowest class id.
+ */
+static int majority_vote(struct onlineClassifier* classifier, int raw_label) {
+    int window = classifier->smoothing_window;
+    if (classifier->history_count == window) {
+        classifier->votes[classifier->history[classifier->history_pos]]--;
+    } else {
+        classifier->history_count++;
+    }
+    classifier->history[classifier->history_pos] = raw_label;
+    classifier->votes[raw_label]++;
+    classifier->history_pos = (classifier->history_pos + 1) % window;
+
+    int best = raw_label;
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        if (classifier->votes[c] > classifier->votes[best]) {
+            best = c;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Pushes the newest sample into the classifier's n-gram ring buffer.
+ *
+ * The encoding half of `online_push_sample`: one timestamp encoding. A
+ * pipeline can run it on another thread than `online_classify_ngram`; the two
+ * halves touch disjoint classifier state.
+ *
+ * @param ngram Receives the current n-gram once N_GRAM_SIZE samples have been seen.
+ * @return 1 if `ngram` holds a full n-gram, 0 while the buffer is filling, -1 on error.
+ */
+int online_encode_sample(struct onlineClassifier* classifier, const double* sample, Vector* ngram) {
+    return push_ngram_encoder_sample(classifier->enc, &classifier->workspace.ngram_state, sample, ngram);
+}
+
+/**
+ * @brief Classifies an n-gram and applies the configured smoothing.
+ *
+ * The classification half of `online_push_sample`: one associative-memory search.
+ *
+ * @param label Receives the (smoothed) class label.
+ * @param confidence Receives the similarity of that class to the n-gram,
+ *        or its smoothed similarity with ONLINE_SMOOTHING_EXPONENTIAL.
+ * @return 1 on success, -1 if no class matches.
+ */
+int online_classify_ngram(struct onlineClassifier* classifier, Vector* ngram, int* label, double* confidence) {
+    int labels[NUM_CLASSES];
+    double similarities[NUM_CLASSES];
+    int ranked = classify_topk(classifier->assoc_mem, ngram,
+                               classifier->smoothing == ONLINE_SMOOTHING_NONE ? 1 : NUM_CLASSES,
+                               labels, similarities);
+    if (ranked < 1 || similarities[0] <= -1.0) {
+        fprintf(stderr, "Online classifier: no valid class for the current n-gram.\n");
+        return -1;
+    }
+
+    if (classifier->smoothing == ONLINE_SMOOTHING_MAJORITY) {
+        int best = majority_vote(classifier, labels[0]);
+        *label = best;
+        *confidence = similarities[0];
+        for (int rank = 0; rank < ranked; rank++) {
+            if (labels[rank] == best) {
+                *confidence = similarities[rank];
+            }
+        }
+    } else if (classifier->smoothing == ONLINE_SMOOTHING_EXPONENTIAL) {
+        double alpha = 2.0 / (classifier->smoothing_window + 1.0);
+        for (int rank = 0; rank < ranked; rank++) {
+            double *score = &classifier->scores[labels[rank]];
+            *score = classifier->scores_valid ? *score + alpha * (similarities[rank] - *score) : similarities[rank];
+        }
+        classifier->scores_valid = 1;
+        int best = labels[0];
+        for (int rank = 1; rank < ranked; rank++) {
+            if (classifier->scores[labels[rank]] > classifier->scores[best]) {
+                best = labels[rank];
+            }
+        }
+        *label = best;
+        *confidence = classifier->scores[best];
+    } else {
+        *label = labels[0];
+        *confidence = similarities[0];
+    }
+    return 1;
+}
+
+/**
+ * @brief Classifies the n-gram ending in the newest sample.
+ *
+ * Pushes `sample` into the classifier's n-gram ring buffer (one timestamp
+ * encoding) and, once N_GRAM_SIZE samples have been seen, classifies the
+ * current n-gram (one associative-memory search). The decision is smoothed as
+ * configured with `set_online_smoothing`.
+ *
+ * @param classifier A pointer to the `onlineClassifier` structure.
+ * @param sample NUM_FEATURES values of the newest EMG sample.
+ * @param label Receives the (smoothed) class label.
+ * @param confidence Receives the similarity of that class to the current n-gram,
+ *        or its smoothed similarity with ONLINE_SMOOTHING_EXPONENTIAL.
+ * @return 1 if `label` and `confidence` were written, 0 while the first
+ *         N_GRAM_SIZE - 1 samples fill the buffer, -1 on error.
+ */
+int online_push_sample(struct onlineClassifier* classifier, const double* sample, int* label, double* confidence) {
+    Vector *ngram = classifier->workspace.sample;
+    int ready = online_encode_sample(classifier, sample, ngram);
+    if (ready <= 0) {
+        return ready;
+    }
+    return online_classify_ngram(classifier, ngram, label, confidence);
+}
+
 /**
  * @brief Calculates the predicted label for a batch of testing data.
  *
- * This function encodes each time-series data sample in the batch using the provided encoder,
- * classifies it using the associative memory, and determines the best-predicted label based
- * on similarity scores.
+ * This function slides the n-gram window over the batch, classifies every
+ * n-gram using the associative memory, and determines the best-predicted label
+ * based on similarity scores.
  *
  * @param classifier A pointer to the `onlineClassifier` structure.
  * @param testing_data A 2D array of testing data samples, where each row is a feature vector.
  * 
- * @return The best-predicted label for the batch.
+ * @return The best-predicted label for the batch, -1 if the batch holds no full n-gram.
  *
- * @note The function assumes that the batch size is larger than `N_GRAM_SIZE`. If this 
- *       condition is not met, the behavior is undefined.
- * 
  * @details
- * - **Encoding:** Each sample is encoded into a hypervector.
+ * - **Encoding:** The samples are pushed through the n-gram ring buffer, one
+ *   timestamp encoding per sample; the n-grams starting at samples
+ *   `0 .. batch_size - N_GRAM_SIZE - 1` are classified.
  * - **Classification:** The hypervector is compared against class vectors in the associative
- *   memory to determine the closest match.
- * - **Confidence:** The similarity score (e.g., cosine similarity) is used to evaluate the
- *   prediction confidence.
+ *   memory to determine the closest match (`classify_topk`).
+ * - **Confidence:** The similarity score of that match (e.g., cosine similarity), returned
+ *   by the same call, is used to evaluate the prediction confidence.
+ *
+ * @note Shares the ring buffer with `online_push_sample`: a batch restarts the sample stream.
  * 
  * @warning If the classification result is invalid (`-1`), the function terminates the program.
  */
@@ -60,28 +236,36 @@ void init_online_classifier(struct onlineClassifier* classifier,
 int calculateUpdate(struct onlineClassifier* classifier,double** testing_data){
     double max_similarity = -1.0;
     int best_predicted_label = -1;
-    //TODO: FEHLER wenn numsamples kleiner als ngram
-    for(int i = 0; i<classifier->batch_size-N_GRAM_SIZE; i++){
-        Vector* sample_hv = create_vector();
-        int encodingResult = encode_timeseries(classifier->enc, &(testing_data[i]), sample_hv);
-        int predicted_label = classify(classifier->assoc_mem, sample_hv);
-        if(predicted_label==-1){
-            printf("Encoding result: %i",encodingResult);
-            printf("SampleHV number %i:\n",i);
-            print_vector(sample_hv);
-            fprintf(stderr, "Label not valid, terminating...");
+    struct hdc_workspace *ws = &classifier->workspace;
+    reset_ngram_encoder_state(&ws->ngram_state);
+    for(int i = 0; i<classifier->batch_size-1; i++){
+        Vector* sample_hv = ws->sample;
+        int encodingResult = push_ngram_encoder_sample(classifier->enc, &ws->ngram_state, testing_data[i], sample_hv);
+        if (encodingResult < 0) {
+            fprintf(stderr, "Failed to encode sample %i, terminating...", i);
             exit(EXIT_FAILURE);
         }
-        double confidence = similarity_check(sample_hv,get_class_vector(classifier->assoc_mem,predicted_label));
+        if (!encodingResult) {
+            continue;
+        }
+        int predicted_label;
+        double confidence;
+        classify_topk(classifier->assoc_mem, sample_hv, 1, &predicted_label, &confidence);
         if(confidence==-2){
             fprintf(stderr,"Got invalid cosine similarity\nTerminating...");
             exit(EXIT_FAILURE);
         }
+        if(confidence<=-1.0){
+            printf("Encoding result: %i",encodingResult);
+            printf("SampleHV number %i:\n",i - N_GRAM_SIZE + 1);
+            print_vector(sample_hv);
+            fprintf(stderr, "Label not valid, terminating...");
+            exit(EXIT_FAILURE);
+        }
         if (confidence > max_similarity) {
         max_similarity = confidence;
         best_predicted_label = predicted_label;
         }
-        free_vector(sample_hv);
     }
     return best_predicted_label;
-}
\ No newline at end of file
+}
@@ -1,6 +1,5 @@
 #ifndef ONLINE_CLASSIFIER_H
 #define ONLINE_CLASSIFIER_H
-#endif
 
 #ifdef HAND_EMG
 #include "../hand/configHand.h"
@@ -16,24 +15,63 @@
 #include "operations.h"
 #include "assoc_mem.h"
 #include "encoder.h"
+#include "workspace.h"
+
+#define ONLINE_SMOOTHING_NONE 0        // report every n-gram's own decision
+#define ONLINE_SMOOTHING_MAJORITY 1    // majority vote over the last ONLINE_SMOOTHING_WINDOW decisions
+#define ONLINE_SMOOTHING_EXPONENTIAL 2 // exponential moving average of the class similarities
+
+#ifndef ONLINE_SMOOTHING
+#define ONLINE_SMOOTHING ONLINE_SMOOTHING_NONE // smoothing of online_push_sample decisions
+#endif
+#ifndef ONLINE_SMOOTHING_WINDOW
+#define ONLINE_SMOOTHING_WINDOW 8 // decisions in the majority window, or span of the moving average
+#endif
+#ifndef ONLINE_SMOOTHING_MAX_WINDOW
+#define ONLINE_SMOOTHING_MAX_WINDOW 64 // capacity of the majority vote history
+#endif
 
 /**
  * @brief Represents the online classifier for real-time predictions.
  *
- * This structure handles batch-based online classification using a pre-trained associative memory
- * and encoder.
+ * This structure handles online classification using a pre-trained associative memory
+ * and encoder, either one sample at a time (`online_push_sample`) or per batch
+ * (`calculateUpdate`).
  * 
  * Members:
  * - **assoc_mem**: Pointer to the associative memory used for classification.
  * - **enc**: Pointer to the encoder used for transforming input data into hypervectors.
  * - **batch_size**: The number of samples to process in each batch.
+ * - **workspace**: Scratch vectors and the n-gram ring buffer owned by the classifier,
+ *   so updates do not allocate.
+ * - **smoothing**, **smoothing_window**: Smoothing of the per-sample decisions.
+ * - **history**, **history_pos**, **history_count**, **votes**: Majority vote state.
+ * - **scores**, **scores_valid**: Moving average of the class similarities.
  */
 struct onlineClassifier{
     struct associative_memory* assoc_mem;/**< Pointer to the associative memory. */
     struct encoder* enc;  /**< Pointer to the encoder. */
     int batch_size; /**< Number of samples in a batch. */
+    struct hdc_workspace workspace; /**< Scratch memory for encoding. */
+    int smoothing; /**< One of the ONLINE_SMOOTHING_* modes. */
+    int smoothing_window; /**< Majority window length or moving-average span. */
+    int history[ONLINE_SMOOTHING_MAX_WINDOW]; /**< Last raw decisions (ring buffer). */
+    int history_pos; /**< Next slot of `history`. */
+    int history_count; /**< Valid entries in `history`. */
+    int votes[NUM_CLASSES]; /**< Decisions per class within `history`. */
+    double scores[NUM_CLASSES]; /**< Smoothed class similarities. */
+    int scores_valid; /**< `scores` holds at least one n-gram. */
 };
 
 void init_online_classifier(struct onlineClassifier* classifier, struct associative_memory* assMem, struct encoder* enc, int batchSize);
+void free_online_classifier(struct onlineClassifier* classifier);
+void set_online_smoothing(struct onlineClassifier* classifier, int smoothing, int window);
+void reset_online_classifier(struct onlineClassifier* classifier);
 
+int online_encode_sample(struct onlineClassifier* classifier, const double* sample, Vector* ngram);
+int online_classify_ngram(struct onlineClassifier* classifier, Vector* ngram, int* label, double* confidence);
+int online_push_sample(struct onlineClassifier* classifier, const double* sample, int* label, double* confidence);
 int calculateUpdate(struct onlineClassifier* classifier,double** testing_data);
+
+#endif // ONLINE_CLASSIFIER_H
+
@@ -0,0 +1,424 @@
+/**
+ * @file online_runtime.c
+ * @brief Threaded acquisition-to-inference pipeline around `struct onlineClassifier`.
+ *
+ * @details
+ * The acquisition thread hands samples to `online_runtime_submit`, which
+ * timestamps them and puts them into a lock-free single-producer /
+ * single-consumer ring; it never blocks and counts a drop when the ring is
+ * full. An inference worker pops the samples and runs `online_push_sample`. In
+ * two-stage mode the worker only encodes and passes the n-grams through a
+ * second SPSC ring to a classification worker. Every decision is timed against
+ * the submit timestamp of its newest sample and recorded in a log-linear
+ * histogram, so p50/p99/max sample-to-decision latency can be read while the
+ * pipeline runs.
+ */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#elif !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "online_runtime.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CACHE_LINE 64
+#define LATENCY_SUB_BITS 4
+#define LATENCY_BUCKETS (64 << LATENCY_SUB_BITS)
+
+/**
+ * @brief Indices of a single-producer / single-consumer ring; the slots live with the user.
+ *
+ * `head` is written only by the producer and `tail` only by the consumer, each
+ * on its own cache line. Release stores publish a slot, acquire loads observe it.
+ */
+struct spsc_ring {
+    size_t mask;
+    _Alignas(CACHE_LINE) atomic_size_t head;
+    _Alignas(CACHE_LINE) atomic_size_t tail;
+};
+
+static void init_spsc_ring(struct spsc_ring *ring, size_t capacity) {
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+}
+
+/** @return Slot the producer may fill, or -1 if the ring is full. */
+static long spsc_reserve(struct spsc_ring *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return head - tail > ring->mask ? -1 : (long)(head & ring->mask);
+}
+
+static void spsc_publish(struct spsc_ring *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/** @return Oldest published slot, or -1 if the ring is empty. */
+static long spsc_peek(struct spsc_ring *ring) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return head == tail ? -1 : (long)(tail & ring->mask);
+}
+
+static void spsc_release(struct spsc_ring *ring) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+struct timed_sample {
+    double values[NUM_FEATURES];
+    uint64_t submitted_ns;
+    uint64_t index;
+};
+
+struct timed_ngram {
+    uint64_t submitted_ns;
+    uint64_t index;
+};
+
+struct online_runtime {
+    struct onlineClassifier *classifier;
+    struct online_runtime_config config;
+
+    struct spsc_ring samples;
+    struct timed_sample *sample_slots;
+    struct spsc_ring ngrams;
+    struct timed_ngram *ngram_slots;
+    Vector **ngram_vectors;
+    vector_element *ngram_storage;
+
+    pthread_t encode_thread;
+    pthread_t classify_thread;
+    atomic_int stopping;      /**< Set by `online_runtime_stop`; workers drain and exit. */
+    atomic_int encode_done;   /**< The encoding worker has drained the sample ring. */
+    int encode_started;
+    int classify_started;
+
+    uint64_t next_index;      /**< Producer side only. */
+    atomic_uint_fast64_t submitted;
+    atomic_uint_fast64_t dropped_samples;
+    atomic_uint_fast64_t dropped_ngrams;
+    atomic_uint_fast64_t latency_sum_ns;
+    atomic_uint_fast64_t latency_max_ns;
+    atomic_uint_fast64_t latency_buckets[LATENCY_BUCKETS];
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Log-linear bucket of a latency: exact below 16 ns, then 16 buckets per octave.
+ */
+static int latency_bucket(uint64_t ns) {
+    if (ns < (1u << LATENCY_SUB_BITS)) {
+        return (int)ns;
+    }
+    int octave = 63 - __builtin_clzll(ns);
+    int sub = (int)((ns >> (octave - LATENCY_SUB_BITS)) & ((1u << LATENCY_SUB_BITS) - 1));
+    return ((octave - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS) + sub;
+}
+
+/** @brief Largest latency that falls into `bucket`. */
+static uint64_t latency_bucket_limit(int bucket) {
+    if (bucket < (1 << LATENCY_SUB_BITS)) {
+        return (uint64_t)bucket;
+    }
+    int octave = (bucket >> LATENCY_SUB_BITS) + LATENCY_SUB_BITS - 1;
+    uint64_t sub = (uint64_t)(bucket & ((1 << LATENCY_SUB_BITS) - 1));
+    uint64_t width = 1ull << (octave - LATENCY_SUB_BITS);
+    return (1ull << octave) + (sub + 1) * width - 1;
+}
+
+static void record_decision(struct online_runtime *runtime, uint64_t index, uint64_t submitted_ns,
+                            int label, double confidence) {
+    uint64_t latency = monotonic_ns() - submitted_ns;
+    // Only the final worker records, so plain read-modify-write on the maximum is race-free.
+    atomic_fetch_add_explicit(&runtime->latency_buckets[latency_bucket(latency)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&runtime->latency_sum_ns, latency, memory_order_relaxed);
+    if (latency > atomic_load_explicit(&runtime->latency_max_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&runtime->latency_max_ns, latency, memory_order_relaxed);
+    }
+    if (runtime->config.on_decision) {
+        struct online_decision decision = {index, label, confidence, latency};
+        runtime->config.on_decision(runtime->config.user, &decision);
+    }
+}
+
+/**
+ * @brief Waits for work: spins first (lowest latency), then sleeps between polls.
+ */
+static void idle_wait(int *idle_polls) {
+    if (++*idle_polls < ONLINE_RUNTIME_SPIN_ITERATIONS) {
+        return;
+    }
+    struct timespec pause = {0, ONLINE_RUNTIME_IDLE_SLEEP_NS};
+    nanosleep(&pause, NULL);
+}
+
+static void *encode_main(void *arg) {
+    struct online_runtime *runtime = (struct online_runtime *)arg;
+    struct onlineClassifier *classifier = runtime->classifier;
+    if (runtime->config.encode_cpu >= 0) {
+        online_pin_current_thread(runtime->config.encode_cpu);
+    }
+    int idle_polls = 0;
+    for (;;) {
+        long slot = spsc_peek(&runtime->samples);
+        if (slot < 0) {
+            if (atomic_load_explicit(&runtime->stopping, memory_order_acquire) &&
+                spsc_peek(&runtime->samples) < 0) {
+                break;
+            }
+            idle_wait(&idle_polls);
+            continue;
+        }
+        idle_polls = 0;
+        const struct timed_sample *sample = &runtime->sample_slots[slot];
+
+        if (!runtime->config.two_stage) {
+            int label;
+            double confidence;
+            int ready = online_push_sample(classifier, sample->values, &label, &confidence);
+            if (ready > 0) {
+                record_decision(runtime, sample->index, sample->submitted_ns, label, confidence);
+            }
+        } else {
+            long out = spsc_reserve(&runtime->ngrams);
+            Vector *ngram = out >= 0 ? runtime->ngram_vectors[out] : classifier->workspace.sample;
+            int ready = online_encode_sample(classifier, sample->values, ngram);
+            if (ready > 0 && out < 0) {
+                // The n-gram state advanced anyway; only this decision is lost.
+                atomic_fetch_add_explicit(&runtime->dropped_ngrams, 1, memory_order_relaxed);
+            } else if (ready > 0) {
+                runtime->ngram_slots[out].index = sample->index;
+                runtime->ngram_slots[out].submitted_ns = sample->submitted_ns;
+                spsc_publish(&runtime->ngrams);
+            }
+        }
+        spsc_release(&runtime->samples);
+    }
+    atomic_store_explicit(&runtime->encode_done, 1, memory_order_release);
+    return NULL;
+}
+
+static void *classify_main(void *arg) {
+    struct online_runtime *runtime = (struct online_runtime *)arg;
+    if (runtime->config.classify_cpu >= 0) {
+        online_pin_current_thread(runtime->config.classify_cpu);
+    }
+    int idle_polls = 0;
+    for (;;) {
+        long slot = spsc_peek(&runtime->ngrams);
+        if (slot < 0) {
+            if (atomic_load_explicit(&runtime->encode_done, memory_order_acquire) &&
+                spsc_peek(&runtime->ngrams) < 0) {
+                break;
+            }
+            idle_wait(&idle_polls);
+            continue;
+        }
+        idle_polls = 0;
+        int label;
+        double confidence;
+        if (online_classify_ngram(runtime->classifier, runtime->ngram_vectors[slot], &label, &confidence) > 0) {
+            record_decision(runtime, runtime->ngram_slots[slot].index, runtime->ngram_slots[slot].submitted_ns,
+                            label, confidence);
+        }
+        spsc_release(&runtime->ngrams);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Pins the calling thread to one CPU.
+ *
+ * @return 0 on success, -1 if pinning failed or is not supported on this platform.
+ */
+int online_pin_current_thread(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        fprintf(stderr, "online runtime: could not pin thread to CPU %d.\n", cpu);
+        return -1;
+    }
+    return 0;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+void default_online_runtime_config(struct online_runtime_config *config) {
+    memset(config, 0, sizeof(*config));
+    config->ring_capacity = ONLINE_RUNTIME_RING_CAPACITY;
+    config->encode_cpu = -1;
+    config->classify_cpu = -1;
+}
+
+static void free_online_runtime(struct online_runtime *runtime) {
+    free(runtime->sample_slots);
+    free(runtime->ngram_slots);
+    if (runtime->ngram_vectors) {
+        free_vector_slab(runtime->ngram_vectors, runtime->ngram_storage);
+    }
+    free(runtime);
+}
+
+/**
+ * @brief Starts the inference worker(s) for `classifier`.
+ *
+ * The classifier is owned by the workers until `online_runtime_stop`; its
+ * smoothing must be configured before the start.
+ *
+ * @param config Settings, or NULL for the defaults.
+ * @return The running pipeline, or NULL on failure.
+ */
+struct online_runtime *online_runtime_start(struct onlineClassifier *classifier, const struct online_runtime_config *config) {
+    struct online_runtime *runtime = (struct online_runtime *)aligned_alloc(CACHE_LINE, (sizeof(*runtime) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE);
+    if (!runtime) {
+        fprintf(stderr, "online runtime: allocation failed.\n");
+        return NULL;
+    }
+    memset(runtime, 0, sizeof(*runtime));
+    runtime->classifier = classifier;
+    if (config) {
+        runtime->config = *config;
+    } else {
+        default_online_runtime_config(&runtime->config);
+    }
+
+    size_t capacity = 2;
+    while (capacity < runtime->config.ring_capacity) {
+        capacity <<= 1;
+    }
+    init_spsc_ring(&runtime->samples, capacity);
+    init_spsc_ring(&runtime->ngrams, capacity);
+    atomic_init(&runtime->stopping, 0);
+    atomic_init(&runtime->encode_done, 0);
+    runtime->sample_slots = (struct timed_sample *)malloc(capacity * sizeof(*runtime->sample_slots));
+    int ok = runtime->sample_slots != NULL;
+    if (ok && runtime->config.two_stage) {
+        runtime->ngram_slots = (struct timed_ngram *)malloc(capacity * sizeof(*runtime->ngram_slots));
+        runtime->ngram_vectors = create_vector_slab((int)capacity, &runtime->ngram_storage);
+        ok = runtime->ngram_slots && runtime->ngram_vectors;
+    }
+    if (!ok) {
+        fprintf(stderr, "online runtime: failed to allocate %zu ring slots.\n", capacity);
+        free_online_runtime(runtime);
+        return NULL;
+    }
+
+    if (pthread_create(&runtime->encode_thread, NULL, encode_main, runtime) != 0) {
+        fprintf(stderr, "online runtime: failed to start the inference thread.\n");
+        free_online_runtime(runtime);
+        return NULL;
+    }
+    runtime->encode_started = 1;
+    if (runtime->config.two_stage) {
+        if (pthread_create(&runtime->classify_thread, NULL, classify_main, runtime) != 0) {
+            fprintf(stderr, "online runtime: failed to start the classification thread.\n");
+            online_runtime_stop(runtime);
+            return NULL;
+        }
+        runtime->classify_started = 1;
+    }
+    return runtime;
+}
+
+/**
+ * @brief Queues one sample; call from a single acquisition thread.
+ *
+ * Never blocks: when the ring is full the sample is dropped and counted.
+ *
+ * @return 0 if queued, -1 if dropped.
+ */
+int online_runtime_submit(struct online_runtime *runtime, const double *sample) {
+    uint64_t now = monotonic_ns();
+    long slot = spsc_reserve(&runtime->samples);
+    if (slot < 0) {
+        atomic_fetch_add_explicit(&runtime->dropped_samples, 1, memory_order_relaxed);
+        return -1;
+    }
+    struct timed_sample *entry = &runtime->sample_slots[slot];
+    memcpy(entry->values, sample, sizeof(entry->values));
+    entry->submitted_ns = now;
+    entry->index = runtime->next_index++;
+    spsc_publish(&runtime->samples);
+    atomic_fetch_add_explicit(&runtime->submitted, 1, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief Snapshot of the counters and latency percentiles; safe while the pipeline runs.
+ */
+void online_runtime_stats(const struct online_runtime *runtime, struct online_latency_stats *stats) {
+    struct online_runtime *rt = (struct online_runtime *)runtime;
+    memset(stats, 0, sizeof(*stats));
+    stats->submitted = atomic_load_explicit(&rt->submitted, memory_order_relaxed);
+    stats->dropped_samples = atomic_load_explicit(&rt->dropped_samples, memory_order_relaxed);
+    stats->dropped_ngrams = atomic_load_explicit(&rt->dropped_ngrams, memory_order_relaxed);
+    stats->max_us = (double)atomic_load_explicit(&rt->latency_max_ns, memory_order_relaxed) / 1000.0;
+
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t total = 0;
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+        counts[bucket] = atomic_load_explicit(&rt->latency_buckets[bucket], memory_order_relaxed);
+        total += counts[bucket];
+    }
+    stats->decisions = total;
+    if (total == 0) {
+        return;
+    }
+    stats->mean_us = (double)atomic_load_explicit(&rt->latency_sum_ns, memory_order_relaxed) / 1000.0 / (double)total;
+    uint64_t p50_rank = (total + 1) / 2;
+    uint64_t p99_rank = total - total / 100;
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+        uint64_t before = seen;
+        seen += counts[bucket];
+        double limit_us = (double)latency_bucket_limit(bucket) / 1000.0;
+        if (before < p50_rank && seen >= p50_rank) {
+            stats->p50_us = limit_us;
+        }
+        if (before < p99_rank && seen >= p99_rank) {
+            stats->p99_us = limit_us;
+            break;
+        }
+    }
+    if (stats->p50_us > stats->max_us) {
+        stats->p50_us = stats->max_us;
+    }
+    if (stats->p99_us > stats->max_us) {
+        stats->p99_us = stats->max_us;
+    }
+}
+
+/**
+ * @brief Processes the queued samples, stops the workers and frees the runtime.
+ */
+void online_runtime_stop(struct online_runtime *runtime) {
+    if (!runtime) {
+        return;
+    }
+    atomic_store_explicit(&runtime->stopping, 1, memory_order_release);
+    if (runtime->encode_started) {
+        pthread_join(runtime->encode_thread, NULL);
+    }
+    if (runtime->classify_started) {
+        pthread_join(runtime->classify_thread, NULL);
+    }
+    free_online_runtime(runtime);
+}
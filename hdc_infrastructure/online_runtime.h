@@ -0,0 +1,72 @@
+#ifndef ONLINE_RUNTIME_H
+#define ONLINE_RUNTIME_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "online_classifier.h"
+
+#ifndef ONLINE_RUNTIME_RING_CAPACITY
+#define ONLINE_RUNTIME_RING_CAPACITY 1024 // samples buffered between acquisition and inference (power of two)
+#endif
+#ifndef ONLINE_RUNTIME_SPIN_ITERATIONS
+#define ONLINE_RUNTIME_SPIN_ITERATIONS 20000 // polls of an empty ring before an idle worker sleeps
+#endif
+#ifndef ONLINE_RUNTIME_IDLE_SLEEP_NS
+#define ONLINE_RUNTIME_IDLE_SLEEP_NS 10000 // sleep of an idle worker between polls
+#endif
+
+/**
+ * @brief One decision of the online runtime, handed to `on_decision`.
+ */
+struct online_decision {
+    uint64_t sample_index;  /**< Index of the newest sample of the n-gram (0-based count of accepted samples). */
+    int label;              /**< Smoothed class label. */
+    double confidence;      /**< See `online_classify_ngram`. */
+    uint64_t latency_ns;    /**< From `online_runtime_submit` of that sample to the decision. */
+};
+
+/**
+ * @brief Settings of `online_runtime_start`; `default_online_runtime_config` fills the defaults.
+ *
+ * - **ring_capacity**: Samples between acquisition and inference (rounded up to a power of two).
+ * - **two_stage**: Non-zero encodes and classifies on separate threads, with a ring of
+ *   n-grams in between; raises throughput when one thread cannot keep up.
+ * - **encode_cpu**, **classify_cpu**: CPUs the workers are pinned to, -1 to leave them floating.
+ * - **on_decision**, **user**: Called on the (last) worker thread for every decision.
+ */
+struct online_runtime_config {
+    size_t ring_capacity;
+    int two_stage;
+    int encode_cpu;
+    int classify_cpu;
+    void (*on_decision)(void *user, const struct online_decision *decision);
+    void *user;
+};
+
+/**
+ * @brief Latency accounting of a running runtime.
+ *
+ * Latencies are sample-to-decision times from a histogram with 1/16-octave
+ * buckets; percentiles report the upper bound of their bucket, `max_us` is exact.
+ */
+struct online_latency_stats {
+    uint64_t submitted;       /**< Samples accepted by `online_runtime_submit`. */
+    uint64_t dropped_samples; /**< Samples rejected because the input ring was full. */
+    uint64_t dropped_ngrams;  /**< N-grams lost because the classification stage fell behind. */
+    uint64_t decisions;       /**< Decisions delivered. */
+    double mean_us;
+    double p50_us;
+    double p99_us;
+    double max_us;
+};
+
+struct online_runtime;
+
+void default_online_runtime_config(struct online_runtime_config *config);
+struct online_runtime *online_runtime_start(struct onlineClassifier *classifier, const struct online_runtime_config *config);
+int online_runtime_submit(struct online_runtime *runtime, const double *sample);
+void online_runtime_stats(const struct online_runtime *runtime, struct online_latency_stats *stats);
+void online_runtime_stop(struct online_runtime *runtime);
+int online_pin_current_thread(int cpu);
+
+#endif // ONLINE_RUNTIME_H
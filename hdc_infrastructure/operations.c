@@ -1,20 +1,20 @@
-/**
- * @file operations.c
-
- * @brief Implements vector operations for hyperdimensional computing.
- *
- * This file contains functions for common operations on hypervectors, including:
- * - **Binding:** Combines two vectors element-wise, either via multiplication (bipolar) or XOR (binary).
- * - **Bundling:** Aggregates multiple vectors, using summation (bipolar) or majority voting (binary).
- * - **Permutation:** Performs cyclic shifts on vectors for encoding temporal information.
- * - **Similarity:** Computes similarity metrics, such as cosine similarity (bipolar) or Hamming distance (binary).
- *
- * @details
- * The operations are optimized for both bipolar and binary vector modes, allowing flexibility in
- * hyperdimensional computing applications. These functions form the core of data encoding, aggregation,
- * and classification pipelines.
- */
-#include "operations.h"
+/**
+ * @file operations.c
+
+ * @brief Implements vector operations for hyperdimensional computing.
+ *
+ * This file contains functions for common operations on hypervectors, including:
+ * - **Binding:** Combines two vectors element-wise, either via multiplication (bipolar) or XOR (binary).
+ * - **Bundling:** Aggregates multiple vectors, using summation (bipolar) or majority voting (binary).
+ * - **Permutation:** Performs cyclic shifts on vectors for encoding temporal information.
+ * - **Similarity:** Computes similarity metrics, such as cosine similarity (bipolar) or Hamming distance (binary).
+ *
+ * @details
+ * The operations are optimized for both bipolar and binary vector modes, allowing flexibility in
+ * hyperdimensional computing applications. These functions form the core of data encoding, aggregation,
+ * and classification pipelines.
+ */
+#include "operations.h"
 #include <stdbool.h>
 #include <stdlib.h>
 #include <math.h>
@@ -22,152 +22,565 @@
 #include <stdint.h>
 #include <string.h>
 #include "vector.h"
+#include "profiler.h"
+
+#if !BIPOLAR_MODE && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(OPERATIONS_FORCE_SCALAR)
+#define OPERATIONS_X86_DISPATCH 1
+#include <immintrin.h>
+#else
+#define OPERATIONS_X86_DISPATCH 0
+#endif
+
+#if !BIPOLAR_MODE
+/**
+ * @brief Word-level kernels used by the binary operations.
+ *
+ * One table exists per instruction set; the active table is chosen once at
+ * program start from CPUID, so a single binary runs on any x86-64 host and
+ * still uses the widest available vector unit.
+ */
+struct operations_kernels {
+    const char *name;
+    void (*xor_words)(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t words);
+    void (*and_words)(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t words);
+    uint64_t (*popcount_xor)(const uint64_t *a, const uint64_t *b, size_t words);
+    void (*popcount_xor_rows)(const uint64_t *a, Vector *const *rows, int num_rows,
+                              size_t offset, size_t words, int *counts);
+};
+
+static void xor_words_scalar(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t words) {
+    for (size_t w = 0; w < words; w++) {
+        out[w] = a[w] ^ b[w];
+    }
+}
+
+static void and_words_scalar(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t words) {
+    for (size_t w = 0; w < words; w++) {
+        out[w] = a[w] & b[w];
+    }
+}
+
+static uint64_t popcount_xor_scalar(const uint64_t *a, const uint64_t *b, size_t words) {
+    uint64_t count = 0;
+    for (size_t w = 0; w < words; w++) {
+        count += (uint64_t)__builtin_popcountll(a[w] ^ b[w]);
+    }
+    return count;
+}
+
+/**
+ * @brief Adds popcount(a ^ rows[r]) over words [offset, offset + words) to counts[r].
+ */
+static void popcount_xor_rows_scalar(const uint64_t *a, Vector *const *rows, int num_rows,
+                                     size_t offset, size_t words, int *counts) {
+    for (int r = 0; r < num_rows; r++) {
+        counts[r] += (int)popcount_xor_scalar(a + offset, rows[r]->data + offset, words);
+    }
+}
+
+static const struct operations_kernels kernels_scalar = {
+    "scalar", xor_words_scalar, and_words_scalar, popcount_xor_scalar, popcount_xor_rows_scalar
+};
+
+#if OPERATIONS_X86_DISPATCH
+__attribute__((target("avx2")))
+static void xor_words_avx2(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t words) {
+    size_t w = 0;
+    for (; w + 4 <= words; w += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + w));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + w));
+        _mm256_storeu_si256((__m256i *)(out + w), _mm256_xor_si256(va, vb));
+    }
+    for (; w < words; w++) {
+        out[w] = a[w] ^ b[w];
+    }
+}
+
+__attribute__((target("avx2")))
+static void and_words_avx2(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t words) {
+    size_t w = 0;
+    for (; w + 4 <= words; w += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + w));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + w));
+        _mm256_storeu_si256((__m256i *)(out + w), _mm256_and_si256(va, vb));
+    }
+    for (; w < words; w++) {
+        out[w] = a[w] & b[w];
+    }
+}
+
+// With hardware POPCNT (-march=native on any AVX2 host) the scalar popcount loop
+// is about twice as fast as the nibble-lookup kernels below, so they are only
+// built for PORTABLE binaries, where __builtin_popcountll is a libgcc call.
+#ifndef __POPCNT__
+// Per-byte popcount through a nibble lookup, summed into four 64-bit lanes.
+__attribute__((target("avx2")))
+static inline __m256i popcount256_avx2(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_and_si256(v, low_mask);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+}
+
+// Carry-save adder: (high, low) = a + b + c per bit position.
+#define OPERATIONS_CSA(high, low, a, b, c) \
+    do { \
+        __m256i csa_u = _mm256_xor_si256((a), (b)); \
+        (high) = _mm256_or_si256(_mm256_and_si256((a), (b)), _mm256_and_si256(csa_u, (c))); \
+        (low) = _mm256_xor_si256(csa_u, (c)); \
+    } while (0)
+
+#define OPERATIONS_XOR_LOAD(i) \
+    _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a + 4 * (i))), \
+                     _mm256_loadu_si256((const __m256i *)(b + 4 * (i))))
+
+/**
+ * @brief Harley-Seal popcount of a XOR b over blocks of 16 AVX2 registers.
+ */
+__attribute__((target("avx2")))
+static uint64_t popcount_xor_avx2(const uint64_t *a, const uint64_t *b, size_t words) {
+    size_t blocks = words / 4;
+    size_t i = 0;
+    __m256i total = _mm256_setzero_si256();
+    __m256i ones = _mm256_setzero_si256();
+    __m256i twos = _mm256_setzero_si256();
+    __m256i fours = _mm256_setzero_si256();
+    __m256i eights = _mm256_setzero_si256();
+    __m256i sixteens;
+    __m256i twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+
+    for (; i + 16 <= blocks; i += 16) {
+        OPERATIONS_CSA(twos_a, ones, ones, OPERATIONS_XOR_LOAD(i + 0), OPERATIONS_XOR_LOAD(i + 1));
+        OPERATIONS_CSA(twos_b, ones, ones, OPERATIONS_XOR_LOAD(i + 2), OPERATIONS_XOR_LOAD(i + 3));
+        OPERATIONS_CSA(fours_a, twos, twos, twos_a, twos_b);
+        OPERATIONS_CSA(twos_a, ones, ones, OPERATIONS_XOR_LOAD(i + 4), OPERATIONS_XOR_LOAD(i + 5));
+        OPERATIONS_CSA(twos_b, ones, ones, OPERATIONS_XOR_LOAD(i + 6), OPERATIONS_XOR_LOAD(i + 7));
+        OPERATIONS_CSA(fours_b, twos, twos, twos_a, twos_b);
+        OPERATIONS_CSA(eights_a, fours, fours, fours_a, fours_b);
+        OPERATIONS_CSA(twos_a, ones, ones, OPERATIONS_XOR_LOAD(i + 8), OPERATIONS_XOR_LOAD(i + 9));
+        OPERATIONS_CSA(twos_b, ones, ones, OPERATIONS_XOR_LOAD(i + 10), OPERATIONS_XOR_LOAD(i + 11));
+        OPERATIONS_CSA(fours_a, twos, twos, twos_a, twos_b);
+        OPERATIONS_CSA(twos_a, ones, ones, OPERATIONS_XOR_LOAD(i + 12), OPERATIONS_XOR_LOAD(i + 13));
+        OPERATIONS_CSA(twos_b, ones, ones, OPERATIONS_XOR_LOAD(i + 14), OPERATIONS_XOR_LOAD(i + 15));
+        OPERATIONS_CSA(fours_b, twos, twos, twos_a, twos_b);
+        OPERATIONS_CSA(eights_b, fours, fours, fours_a, fours_b);
+        OPERATIONS_CSA(sixteens, eights, eights, eights_a, eights_b);
+        total = _mm256_add_epi64(total, popcount256_avx2(sixteens));
+    }
+
+    total = _mm256_slli_epi64(total, 4);
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256_avx2(eights), 3));
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256_avx2(fours), 2));
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256_avx2(twos), 1));
+    total = _mm256_add_epi64(total, popcount256_avx2(ones));
+    for (; i < blocks; i++) {
+        total = _mm256_add_epi64(total, popcount256_avx2(OPERATIONS_XOR_LOAD(i)));
+    }
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, total);
+    uint64_t count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (size_t w = blocks * 4; w < words; w++) {
+        count += (uint64_t)__builtin_popcountll(a[w] ^ b[w]);
+    }
+    return count;
+}
+
+#undef OPERATIONS_XOR_LOAD
+#undef OPERATIONS_CSA
+
+/**
+ * @brief AVX2 `popcount_xor_rows`: each query register is XORed against four rows at a time.
+ */
+__attribute__((target("avx2")))
+static void popcount_xor_rows_avx2(const uint64_t *a, Vector *const *rows, int num_rows,
+                                   size_t offset, size_t words, int *counts) {
+    const uint64_t *query = a + offset;
+    for (int r = 0; r < num_rows; r += 4) {
+        int group = num_rows - r < 4 ? num_rows - r : 4;
+        const uint64_t *row[4];
+        __m256i acc[4];
+        for (int k = 0; k < 4; k++) {
+            row[k] = rows[r + (k < group ? k : 0)]->data + offset;
+            acc[k] = _mm256_setzero_si256();
+        }
+        size_t w = 0;
+        for (; w + 4 <= words; w += 4) {
+            __m256i q = _mm256_loadu_si256((const __m256i *)(query + w));
+            for (int k = 0; k < 4; k++) {
+                __m256i v = _mm256_loadu_si256((const __m256i *)(row[k] + w));
+                acc[k] = _mm256_add_epi64(acc[k], popcount256_avx2(_mm256_xor_si256(q, v)));
+            }
+        }
+        for (int k = 0; k < group; k++) {
+            uint64_t lanes[4];
+            _mm256_storeu_si256((__m256i *)lanes, acc[k]);
+            uint64_t count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+            for (size_t t = w; t < words; t++) {
+                count += (uint64_t)__builtin_popcountll(query[t] ^ row[k][t]);
+            }
+            counts[r + k] += (int)count;
+        }
+    }
+}
+#endif
+
+static const struct operations_kernels kernels_avx2 = {
+#ifdef __POPCNT__
+    "avx2", xor_words_avx2, and_words_avx2, popcount_xor_scalar, popcount_xor_rows_scalar
+#else
+    "avx2", xor_words_avx2, and_words_avx2, popcount_xor_avx2, popcount_xor_rows_avx2
+#endif
+};
+
+__attribute__((target("avx512f")))
+static void xor_words_avx512(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t words) {
+    size_t w = 0;
+    for (; w + 8 <= words; w += 8) {
+        __m512i va = _mm512_loadu_si512((const void *)(a + w));
+        __m512i vb = _mm512_loadu_si512((const void *)(b + w));
+        _mm512_storeu_si512((void *)(out + w), _mm512_xor_si512(va, vb));
+    }
+    if (w < words) {
+        __mmask8 mask = (__mmask8)((1u << (words - w)) - 1u);
+        __m512i va = _mm512_maskz_loadu_epi64(mask, a + w);
+        __m512i vb = _mm512_maskz_loadu_epi64(mask, b + w);
+        _mm512_mask_storeu_epi64(out + w, mask, _mm512_xor_si512(va, vb));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void and_words_avx512(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t words) {
+    size_t w = 0;
+    for (; w + 8 <= words; w += 8) {
+        __m512i va = _mm512_loadu_si512((const void *)(a + w));
+        __m512i vb = _mm512_loadu_si512((const void *)(b + w));
+        _mm512_storeu_si512((void *)(out + w), _mm512_and_si512(va, vb));
+    }
+    if (w < words) {
+        __mmask8 mask = (__mmask8)((1u << (words - w)) - 1u);
+        __m512i va = _mm512_maskz_loadu_epi64(mask, a + w);
+        __m512i vb = _mm512_maskz_loadu_epi64(mask, b + w);
+        _mm512_mask_storeu_epi64(out + w, mask, _mm512_and_si512(va, vb));
+    }
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static uint64_t popcount_xor_avx512(const uint64_t *a, const uint64_t *b, size_t words) {
+    __m512i total = _mm512_setzero_si512();
+    size_t w = 0;
+    for (; w + 8 <= words; w += 8) {
+        __m512i va = _mm512_loadu_si512((const void *)(a + w));
+        __m512i vb = _mm512_loadu_si512((const void *)(b + w));
+        total = _mm512_add_epi64(total, _mm512_popcnt_epi64(_mm512_xor_si512(va, vb)));
+    }
+    if (w < words) {
+        __mmask8 mask = (__mmask8)((1u << (words - w)) - 1u);
+        __m512i va = _mm512_maskz_loadu_epi64(mask, a + w);
+        __m512i vb = _mm512_maskz_loadu_epi64(mask, b + w);
+        total = _mm512_add_epi64(total, _mm512_popcnt_epi64(_mm512_xor_si512(va, vb)));
+    }
+    return (uint64_t)_mm512_reduce_add_epi64(total);
+}
+
+/**
+ * @brief AVX-512 `popcount_xor_rows`: each query register is XORed against four rows at a time.
+ */
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static void popcount_xor_rows_avx512(const uint64_t *a, Vector *const *rows, int num_rows,
+                                     size_t offset, size_t words, int *counts) {
+    const uint64_t *query = a + offset;
+    for (int r = 0; r < num_rows; r += 4) {
+        int group = num_rows - r < 4 ? num_rows - r : 4;
+        const uint64_t *row[4];
+        __m512i acc[4];
+        for (int k = 0; k < 4; k++) {
+            row[k] = rows[r + (k < group ? k : 0)]->data + offset;
+            acc[k] = _mm512_setzero_si512();
+        }
+        size_t w = 0;
+        for (; w + 8 <= words; w += 8) {
+            __m512i q = _mm512_loadu_si512((const void *)(query + w));
+            for (int k = 0; k < 4; k++) {
+                __m512i v = _mm512_loadu_si512((const void *)(row[k] + w));
+                acc[k] = _mm512_add_epi64(acc[k], _mm512_popcnt_epi64(_mm512_xor_si512(q, v)));
+            }
+        }
+        if (w < words) {
+            __mmask8 mask = (__mmask8)((1u << (words - w)) - 1u);
+            __m512i q = _mm512_maskz_loadu_epi64(mask, query + w);
+            for (int k = 0; k < 4; k++) {
+                __m512i v = _mm512_maskz_loadu_epi64(mask, row[k] + w);
+                acc[k] = _mm512_add_epi64(acc[k], _mm512_popcnt_epi64(_mm512_xor_si512(q, v)));
+            }
+        }
+        for (int k = 0; k < group; k++) {
+            counts[r + k] += (int)_mm512_reduce_add_epi64(acc[k]);
+        }
+    }
+}
+
+static const struct operations_kernels kernels_avx512 = {
+    "avx512-vpopcntdq", xor_words_avx512, and_words_avx512, popcount_xor_avx512, popcount_xor_rows_avx512
+};
+#endif
+
+static const struct operations_kernels *active_kernels = &kernels_scalar;
+
+#if OPERATIONS_X86_DISPATCH
+__attribute__((constructor))
+static void operations_select_kernels(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq")) {
+        active_kernels = &kernels_avx512;
+    } else if (__builtin_cpu_supports("avx2")) {
+        active_kernels = &kernels_avx2;
+    }
+}
+#endif
+#endif
+
+/**
+ * @brief Returns the name of the word-level kernel set used by the binary operations.
+ *
+ * @return "scalar", "avx2" or "avx512-vpopcntdq" (always "scalar" in bipolar mode).
+ */
+const char *operations_kernel_name(void) {
+#if BIPOLAR_MODE
+    return "scalar";
+#else
+    return active_kernels->name;
+#endif
+}
+
+/**
+ * @brief Overrides the CPUID-selected kernel set, e.g. for benchmarking.
+ *
+ * @param name One of "scalar", "avx2" or "avx512-vpopcntdq".
+ * @return 0 on success, -1 if the kernel set is unknown or not supported by this CPU.
+ *
+ * @note Not thread-safe; call before any parallel region uses the operations.
+ */
+int operations_use_kernel(const char *name) {
+    if (name == NULL) {
+        return -1;
+    }
+#if BIPOLAR_MODE
+    return (strcmp(name, "scalar") == 0) ? 0 : -1;
+#else
+    if (strcmp(name, kernels_scalar.name) == 0) {
+        active_kernels = &kernels_scalar;
+        return 0;
+    }
+#if OPERATIONS_X86_DISPATCH
+    __builtin_cpu_init();
+    if (strcmp(name, kernels_avx2.name) == 0 && __builtin_cpu_supports("avx2")) {
+        active_kernels = &kernels_avx2;
+        return 0;
+    }
+    if (strcmp(name, kernels_avx512.name) == 0 &&
+        __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq")) {
+        active_kernels = &kernels_avx512;
+        return 0;
+    }
+#endif
+    return -1;
+#endif
+}
 
 #if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN && !BIPOLAR_MODE
+#define KRISCHAN_CHUNKS ((VECTOR_DIMENSION + 31) / 32)
+
+static inline uint32_t reverse_bits32(uint32_t x) {
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+    return __builtin_bswap32(x);
+}
+
+/**
+ * @brief Krischan-compatible rotation, computed on whole words.
+ *
+ * Krischan's model stores index i at bit 31-(i%32) of 32-bit chunk i/32, i.e. each
+ * half of one of our 64-bit words is a bit-reversed chunk. The vector is repacked
+ * with one bit reversal per chunk, rotated with Krischan's chunk funnel shift and
+ * unpacked the same way, using stack buffers only.
+ *
+ * @note For bit_shift == 0 the reference evaluates `b << 32`, which is undefined in C
+ * and gave compiler-dependent results. Here the term is defined as zero, i.e. a pure
+ * chunk rotation.
+ */
 static void permute_like_krischan(Vector *vector, int offset, Vector *result) {
-    int chunks = (VECTOR_DIMENSION + 31) / 32;
-    uint32_t *in_words = (uint32_t *)calloc((size_t)chunks, sizeof(uint32_t));
-    uint32_t *out_words = (uint32_t *)calloc((size_t)chunks, sizeof(uint32_t));
-    if (!in_words || !out_words) {
-        fprintf(stderr, "Memory allocation failed in permute_like_krischan\n");
-        free(in_words);
-        free(out_words);
-        exit(EXIT_FAILURE);
-    }
+    const int chunks = KRISCHAN_CHUNKS;
+    uint32_t in_words[KRISCHAN_CHUNKS];
+    uint32_t out_words[KRISCHAN_CHUNKS];
 
-    // Match krischan loader bit order: index i maps to bit 31-(i%32) in chunk i/32.
-    for (int i = 0; i < VECTOR_DIMENSION; i++) {
-        if (vector_get_bit(vector, i)) {
-            int chunk = i / 32;
-            int bit_in_chunk = 31 - (i % 32);
-            in_words[chunk] |= (1u << bit_in_chunk);
+    for (int c = 0; c < chunks; c++) {
+        uint64_t word = vector->data[c >> 1];
+        if ((c >> 1) == VECTOR_WORD_COUNT - 1 && (VECTOR_DIMENSION & 63) != 0) {
+            word &= (1ull << (VECTOR_DIMENSION & 63)) - 1ull;
         }
+        in_words[c] = reverse_bits32((uint32_t)(word >> ((c & 1) * 32)));
     }
 
     int shift_bits = offset;
     int total_bits = chunks * 32;
-    if (total_bits > 0) {
-        shift_bits %= total_bits;
-        if (shift_bits < 0) {
-            shift_bits += total_bits;
-        }
+    shift_bits %= total_bits;
+    if (shift_bits < 0) {
+        shift_bits += total_bits;
     }
 
     int word_shift = shift_bits / 32;
     int bit_shift = shift_bits % 32;
-    // Intentional parity path with Krischan implementation, including bit_shift==0 behavior.
     for (int i = 0; i < chunks; i++) {
-        uint32_t a = in_words[(i + word_shift) % chunks];
-        uint32_t b = in_words[(i + word_shift + 1) % chunks];
-        out_words[i] = (a >> bit_shift) | (b << (32 - bit_shift));
+        int src = i + word_shift;
+        if (src >= chunks) {
+            src -= chunks;
+        }
+        uint32_t a = in_words[src];
+        if (bit_shift == 0) {
+            out_words[i] = a;
+        } else {
+            int next = (src + 1 == chunks) ? 0 : src + 1;
+            out_words[i] = (a >> bit_shift) | (in_words[next] << (32 - bit_shift));
+        }
     }
 
-    vector_zero(result);
-    for (int i = 0; i < VECTOR_DIMENSION; i++) {
-        int chunk = i / 32;
-        int bit_in_chunk = 31 - (i % 32);
-        vector_set_bit(result, i, (out_words[chunk] >> bit_in_chunk) & 1u);
+    for (size_t w = 0; w < VECTOR_WORD_COUNT; w++) {
+        uint64_t low = reverse_bits32(out_words[2 * w]);
+        uint64_t high = (2 * w + 1 < (size_t)chunks) ? reverse_bits32(out_words[2 * w + 1]) : 0u;
+        result->data[w] = low | (high << 32);
     }
-
-    free(out_words);
-    free(in_words);
+    vector_mask_tail(result);
 }
 #endif
 
-#if !BIPOLAR_MODE
-static void permute_binary_words(const Vector *vector, int right_shift, Vector *result) {
-    int shift = right_shift % VECTOR_DIMENSION;
+/**
+ * @brief Normalizes a permutation offset to a right rotation in [0, VECTOR_DIMENSION).
+ */
+static inline int rotation_shift(int offset) {
+    int shift = offset % VECTOR_DIMENSION;
     if (shift < 0) {
         shift += VECTOR_DIMENSION;
     }
+    return shift;
+}
 
-    if (shift == 0) {
-        memcpy(result->data, vector->data, vector_storage_bytes());
-        return;
+#if !BIPOLAR_MODE
+/**
+ * @brief Word `idx` of a binary vector, 0 outside the vector, tail bits cleared.
+ */
+static inline uint64_t rotation_source_word(const uint64_t *data, long idx) {
+    if (idx < 0 || idx >= (long)VECTOR_WORD_COUNT) {
+        return 0ull;
     }
+    uint64_t word = data[idx];
+    if (idx == (long)VECTOR_WORD_COUNT - 1 && (VECTOR_DIMENSION & 63) != 0) {
+        word &= (1ull << (VECTOR_DIMENSION & 63)) - 1ull;
+    }
+    return word;
+}
 
-    if ((VECTOR_DIMENSION & 63) == 0) {
-        int words = (int)vector_storage_count();
-        int word_shift = shift >> 6;
-        int bit_shift = shift & 63;
-        for (int w = 0; w < words; w++) {
-            int src = w - word_shift;
-            while (src < 0) {
-                src += words;
-            }
-            src %= words;
+/**
+ * @brief Word-level parameters of a cyclic right rotation by `shift` bits.
+ *
+ * A rotation of a D-bit vector is (v << shift) | (v >> (D - shift)); both halves are
+ * plain multi-word funnel shifts, so any output word is built from at most four
+ * source words regardless of whether D is a multiple of 64.
+ */
+struct rotation_plan {
+    long left_words;
+    int left_bits;
+    long right_words;
+    int right_bits;
+};
 
-            if (bit_shift == 0) {
-                result->data[w] = vector->data[src];
-            } else {
-                int src_prev = src - 1;
-                if (src_prev < 0) {
-                    src_prev += words;
-                }
-                result->data[w] =
-                    (vector->data[src] << bit_shift) |
-                    (vector->data[src_prev] >> (64 - bit_shift));
-            }
-        }
+static inline struct rotation_plan make_rotation_plan(int shift) {
+    struct rotation_plan plan;
+    int right = VECTOR_DIMENSION - shift;
+    plan.left_words = shift >> 6;
+    plan.left_bits = shift & 63;
+    plan.right_words = right >> 6;
+    plan.right_bits = right & 63;
+    return plan;
+}
+
+static inline uint64_t rotated_word(const uint64_t *data, const struct rotation_plan *plan, long w) {
+    long src = w - plan->left_words;
+    uint64_t left = rotation_source_word(data, src) << plan->left_bits;
+    if (plan->left_bits != 0) {
+        left |= rotation_source_word(data, src - 1) >> (64 - plan->left_bits);
+    }
+    src = w + plan->right_words;
+    uint64_t right = rotation_source_word(data, src) >> plan->right_bits;
+    if (plan->right_bits != 0) {
+        right |= rotation_source_word(data, src + 1) << (64 - plan->right_bits);
+    }
+    return left | right;
+}
+
+static void permute_binary_words(const Vector *vector, int right_shift, Vector *result) {
+    int shift = rotation_shift(right_shift);
+    if (shift == 0) {
+        memcpy(result->data, vector->data, vector_storage_bytes());
         return;
     }
 
-    vector_zero(result);
-    for (int i = 0; i < VECTOR_DIMENSION; i++) {
-        int out_idx = i + shift;
-        if (out_idx >= VECTOR_DIMENSION) {
-            out_idx -= VECTOR_DIMENSION;
-        }
-        vector_set_bit(result, out_idx, vector_get_bit(vector, i));
+    struct rotation_plan plan = make_rotation_plan(shift);
+    long words = (long)vector_storage_count();
+    for (long w = 0; w < words; w++) {
+        result->data[w] = rotated_word(vector->data, &plan, w);
     }
     vector_mask_tail(result);
 }
 #endif
+
 /**
  * @brief Combines two hypervectors element-wise.
- *
- * Performs binding by:
- * - **Bipolar mode:** Multiplying corresponding elements.
- * - **Binary mode:** Applying XOR on corresponding elements.
- *
- * @param vector1 The first input vector.
- * @param vector2 The second input vector.
- * @param result The resulting bound vector.
- *
- * @note All input vectors must be initialized. The `result` vector is modified in-place.
- * @warning The function exits the program if any of the input vectors are uninitialized.
- */
-void bind(Vector* vector1, Vector* vector2, Vector* result) {
-    if (vector1 == NULL || vector2 == NULL || result == NULL) {
-        printf("Input vector for binding not initialized");
-        exit(EXIT_FAILURE);
-    }
+ *
+ * Performs binding by:
+ * - **Bipolar mode:** Multiplying corresponding elements.
+ * - **Binary mode:** Applying XOR on corresponding elements.
+ *
+ * @param vector1 The first input vector.
+ * @param vector2 The second input vector.
+ * @param result The resulting bound vector.
+ *
+ * @note All input vectors must be initialized. The `result` vector is modified in-place.
+ * @warning The function exits the program if any of the input vectors are uninitialized.
+ */
+void hdc_bind(Vector* vector1, Vector* vector2, Vector* result) {
+    if (vector1 == NULL || vector2 == NULL || result == NULL) {
+        printf("Input vector for binding not initialized");
+        exit(EXIT_FAILURE);
+    }
 #if BIPOLAR_MODE
     for (int i = 0; i < VECTOR_DIMENSION; i++) {
         result->data[i] = vector1->data[i] * vector2->data[i]; //multiplication for bipolar
     }
 #else
-    size_t words = vector_storage_count();
-    for (size_t w = 0; w < words; w++) {
-        result->data[w] = vector1->data[w] ^ vector2->data[w]; // XOR for binary
-    }
+    active_kernels->xor_words(vector1->data, vector2->data, result->data, vector_storage_count()); // XOR for binary
 #endif
 }
-
-/**
- * @brief Aggregates two hypervectors.
- *
- * Bundling combines two vectors:
- * - **Bipolar mode:** Adds corresponding elements.
- * - **Binary mode:** Uses majority voting across corresponding elements.
- *
- * @param vector1 The first input vector.
- * @param vector2 The second input vector.
- * @param result The resulting bundled vector.
- *
- * @note The `result` vector is modified in-place.
- * @warning The function exits the program if any of the input vectors are uninitialized.
- */
+
+/**
+ * @brief Aggregates two hypervectors.
+ *
+ * Bundling combines two vectors:
+ * - **Bipolar mode:** Adds corresponding elements.
+ * - **Binary mode:** Uses majority voting across corresponding elements.
+ *
+ * @param vector1 The first input vector.
+ * @param vector2 The second input vector.
+ * @param result The resulting bundled vector.
+ *
+ * @note The `result` vector is modified in-place.
+ * @warning The function exits the program if any of the input vectors are uninitialized.
+ */
 void bundle(Vector* vector1, Vector* vector2, Vector* result) {
     if (vector1 == NULL || vector2 == NULL || result == NULL) {
         printf("Input vector for bundling not initialized");
@@ -178,103 +591,305 @@ void bundle(Vector* vector1, Vector* vector2, Vector* result) {
         result->data[i] = vector1->data[i] + vector2->data[i]; //Addition for bipolar
     }
 #else
-    size_t words = vector_storage_count();
-    for (size_t w = 0; w < words; w++) {
-        // For two vectors and strict majority (>1), binary bundle is bitwise AND.
-        result->data[w] = vector1->data[w] & vector2->data[w];
-    }
+    // For two vectors and strict majority (>1), binary bundle is bitwise AND.
+    active_kernels->and_words(vector1->data, vector2->data, result->data, vector_storage_count());
     vector_mask_tail(result);
 #endif
 }
 
-/**
- * @brief Aggregates multiple hypervectors.
- *
- * Combines an array of vectors into a single bundled vector:
- * - **Bipolar mode:** Sums the elements of all input vectors.
- * - **Binary mode:** Applies majority voting across corresponding elements.
- *
- * @param vectors An array of pointers to the vectors to bundle.
- * @param num_vectors The number of vectors to bundle.
- * @param result The resulting bundled vector.
- *
- * @note The `result` vector is modified in-place and should be initialized before calling.
- * @warning The function exits the program if `vectors` or `result` is uninitialized.
- */
-void bundle_multi(Vector** vectors, int num_vectors, Vector* result) {
-    if (vectors == NULL || result == NULL) {
-        printf("Input vector for bundling not initialized");
-        exit(EXIT_FAILURE);
-    }
-    vector_zero(result);
-#if BIPOLAR_MODE
-    for (int v = 0; v < num_vectors; v++) {
-        for (int i = 0; i < VECTOR_DIMENSION; i++) {
-            result->data[i] += vectors[v]->data[i];
-        }
-    }
+#if !BIPOLAR_MODE
+#define BUNDLE_TILE_WORDS 8
+#define BUNDLE_MAX_PLANES 31
 
-#else
+/**
+ * @brief Bit-sliced majority of `num_vectors` binary vectors (optionally bound pairwise).
+ *
+ * Words are processed in tiles of BUNDLE_TILE_WORDS so the per-lane loops map onto
+ * SIMD registers. Each input word is added into `nbits` counter planes with a ripple
+ * carry, and the planes are compared against the constant threshold with a bitwise
+ * magnitude comparison (MSB first), so no per-bit count is ever rebuilt.
+ *
+ * @param vectors Input vectors.
+ * @param bind_with Optional second operand per input; when non-NULL the input word is
+ *        `vectors[v] XOR bind_with[v]`.
+ * @param num_vectors Number of input vectors.
+ * @param result Output vector; bit is set when count >= num_vectors / 2.
+ */
+static void bundle_bitsliced(Vector **vectors, Vector **bind_with, int num_vectors, Vector *result) {
     int threshold = num_vectors / 2;
     int nbits = 0;
     int max_count = num_vectors;
-    while ((1 << nbits) <= max_count && nbits < 31) {
+    while ((1 << nbits) <= max_count && nbits < BUNDLE_MAX_PLANES) {
         nbits++;
     }
     if (nbits < 1) {
         nbits = 1;
     }
 
-    uint64_t *planes = (uint64_t *)calloc((size_t)nbits, sizeof(uint64_t));
-    if (!planes) {
-        fprintf(stderr, "Failed to allocate bit-sliced counters in bundle_multi\n");
-        exit(EXIT_FAILURE);
-    }
+    uint64_t planes[BUNDLE_MAX_PLANES][BUNDLE_TILE_WORDS];
+    uint64_t carry[BUNDLE_TILE_WORDS];
+    uint64_t greater[BUNDLE_TILE_WORDS];
+    uint64_t equal[BUNDLE_TILE_WORDS];
 
     size_t words = vector_storage_count();
-    for (size_t w = 0; w < words; w++) {
-        memset(planes, 0, (size_t)nbits * sizeof(uint64_t));
+    for (size_t base = 0; base < words; base += BUNDLE_TILE_WORDS) {
+        size_t lanes = words - base;
+        if (lanes > BUNDLE_TILE_WORDS) {
+            lanes = BUNDLE_TILE_WORDS;
+        }
+        memset(planes, 0, (size_t)nbits * sizeof(planes[0]));
 
         for (int v = 0; v < num_vectors; v++) {
-            uint64_t carry = vectors[v]->data[w];
+            const uint64_t *src = vectors[v]->data + base;
+            memset(carry, 0, sizeof(carry));
+            if (bind_with) {
+                const uint64_t *other = bind_with[v]->data + base;
+                for (size_t lane = 0; lane < lanes; lane++) {
+                    carry[lane] = src[lane] ^ other[lane];
+                }
+            } else {
+                for (size_t lane = 0; lane < lanes; lane++) {
+                    carry[lane] = src[lane];
+                }
+            }
             for (int b = 0; b < nbits; b++) {
-                uint64_t t = planes[b];
-                planes[b] = t ^ carry;
-                carry = t & carry;
+                for (int lane = 0; lane < BUNDLE_TILE_WORDS; lane++) {
+                    uint64_t t = planes[b][lane];
+                    planes[b][lane] = t ^ carry[lane];
+                    carry[lane] = t & carry[lane];
+                }
             }
         }
 
-        uint64_t out_word = 0ull;
-        for (int bit = 0; bit < 64; bit++) {
-            int count = 0;
-            for (int b = 0; b < nbits; b++) {
-                count |= (int)(((planes[b] >> bit) & 1ull) << b);
+        // count >= threshold, evaluated for all 64 * lanes counters at once.
+        for (int lane = 0; lane < BUNDLE_TILE_WORDS; lane++) {
+            greater[lane] = 0ull;
+            equal[lane] = ~0ull;
+        }
+        for (int b = nbits - 1; b >= 0; b--) {
+            if ((threshold >> b) & 1) {
+                for (int lane = 0; lane < BUNDLE_TILE_WORDS; lane++) {
+                    equal[lane] &= planes[b][lane];
+                }
+            } else {
+                for (int lane = 0; lane < BUNDLE_TILE_WORDS; lane++) {
+                    greater[lane] |= equal[lane] & planes[b][lane];
+                    equal[lane] &= ~planes[b][lane];
+                }
             }
-            if (count >= threshold) {
-                out_word |= (1ull << bit);
+        }
+        for (size_t lane = 0; lane < lanes; lane++) {
+            result->data[base + lane] = greater[lane] | equal[lane];
+        }
+    }
+    vector_mask_tail(result);
+}
+
+/**
+ * @brief Number of counter planes needed to count up to `max_count` per bit.
+ */
+int bit_counter_planes(int max_count) {
+    int nbits = 1;
+    while (nbits < BUNDLE_MAX_PLANES && (1 << nbits) <= max_count) {
+        nbits++;
+    }
+    return nbits;
+}
+
+/**
+ * @brief Adds a binary vector to bit-sliced vertical counters.
+ *
+ * `planes` holds one counter per vector bit, stored word by word: the `nbits`
+ * planes of word `w` are `planes[w * nbits + b]`, plane 0 being the least
+ * significant. A half-adder chain adds the whole word at once and stops as soon
+ * as the carry is empty, which on average happens after two planes.
+ *
+ * @param planes Counters, `vector_storage_count() * nbits` words.
+ * @param nbits Planes per word; must be large enough for the final counts.
+ * @param vector Vector whose set bits are counted.
+ */
+void bit_counter_add(uint64_t *planes, int nbits, const Vector *vector) {
+    HDC_PROFILE_BEGIN(HDC_STAGE_CLASS_UPDATE);
+    size_t words = vector_storage_count();
+    for (size_t w = 0; w < words; w++) {
+        uint64_t *word_planes = planes + w * (size_t)nbits;
+        uint64_t carry = vector->data[w];
+        for (int b = 0; carry && b < nbits; b++) {
+            uint64_t t = word_planes[b];
+            word_planes[b] = t ^ carry;
+            carry &= t;
+        }
+    }
+    HDC_COST_ADD(HDC_STAGE_CLASS_UPDATE, HDC_COST_COUNTER_UPDATES, VECTOR_DIMENSION);
+    HDC_PROFILE_END(HDC_STAGE_CLASS_UPDATE, 1);
+}
+
+/**
+ * @brief Adds the counters in `other` to `planes` (same layout and plane count).
+ */
+void bit_counter_merge(uint64_t *planes, const uint64_t *other, int nbits) {
+    size_t words = vector_storage_count();
+    for (size_t w = 0; w < words; w++) {
+        uint64_t *word_planes = planes + w * (size_t)nbits;
+        const uint64_t *other_planes = other + w * (size_t)nbits;
+        uint64_t carry = 0ull;
+        for (int b = 0; b < nbits; b++) {
+            uint64_t a = word_planes[b];
+            uint64_t c = other_planes[b];
+            word_planes[b] = a ^ c ^ carry;
+            carry = (a & c) | (carry & (a ^ c));
+        }
+    }
+}
+
+/**
+ * @brief Sets every bit of `result` whose counter is at least `threshold`.
+ *
+ * The comparison runs MSB first over all 64 counters of a word at once, as in
+ * `bundle_multi`.
+ */
+void bit_counter_threshold(const uint64_t *planes, int nbits, int threshold, Vector *result) {
+    size_t words = vector_storage_count();
+    if ((long long)threshold >= (1ll << nbits)) {
+        memset(result->data, 0, vector_storage_bytes());
+        return;
+    }
+    for (size_t w = 0; w < words; w++) {
+        const uint64_t *word_planes = planes + w * (size_t)nbits;
+        uint64_t greater = 0ull;
+        uint64_t equal = ~0ull;
+        for (int b = nbits - 1; b >= 0; b--) {
+            if ((threshold >> b) & 1) {
+                equal &= word_planes[b];
+            } else {
+                greater |= equal & word_planes[b];
+                equal &= ~word_planes[b];
             }
         }
-        result->data[w] = out_word;
+        result->data[w] = greater | equal;
     }
-    free(planes);
     vector_mask_tail(result);
+}
+#endif
+
+/**
+ * @brief Aggregates multiple hypervectors.
+ *
+ * Combines an array of vectors into a single bundled vector:
+ * - **Bipolar mode:** Sums the elements of all input vectors.
+ * - **Binary mode:** Applies majority voting across corresponding elements.
+ *
+ * @param vectors An array of pointers to the vectors to bundle.
+ * @param num_vectors The number of vectors to bundle.
+ * @param result The resulting bundled vector.
+ *
+ * @note The `result` vector is modified in-place and should be initialized before calling.
+ * @warning The function exits the program if `vectors` or `result` is uninitialized.
+ */
+void bundle_multi(Vector** vectors, int num_vectors, Vector* result) {
+    if (vectors == NULL || result == NULL) {
+        printf("Input vector for bundling not initialized");
+        exit(EXIT_FAILURE);
+    }
+#if BIPOLAR_MODE
+    vector_zero(result);
+    for (int v = 0; v < num_vectors; v++) {
+        for (int i = 0; i < VECTOR_DIMENSION; i++) {
+            result->data[i] += vectors[v]->data[i];
+        }
+    }
 
+#else
+    bundle_bitsliced(vectors, NULL, num_vectors, result);
+
+#endif
+}
+
+/**
+ * @brief Aggregates pairwise-bound hypervectors without materializing the bound vectors.
+ *
+ * Equivalent to binding `vectors[v]` with `bind_with[v]` for every input and bundling
+ * the results with `bundle_multi`, but the binding is fused into the bundling loop.
+ *
+ * @param vectors First operands of the bindings.
+ * @param bind_with Second operands of the bindings.
+ * @param num_vectors The number of bound pairs to bundle.
+ * @param result The resulting bundled vector.
+ *
+ * @warning The function exits the program if any argument is uninitialized.
+ */
+void bundle_multi_bound(Vector** vectors, Vector** bind_with, int num_vectors, Vector* result) {
+    if (vectors == NULL || bind_with == NULL || result == NULL) {
+        printf("Input vector for bundling not initialized");
+        exit(EXIT_FAILURE);
+    }
+#if BIPOLAR_MODE
+    vector_zero(result);
+    for (int v = 0; v < num_vectors; v++) {
+        for (int i = 0; i < VECTOR_DIMENSION; i++) {
+            result->data[i] += vectors[v]->data[i] * bind_with[v]->data[i];
+        }
+    }
+#else
+    bundle_bitsliced(vectors, bind_with, num_vectors, result);
 #endif
 }
-
-/**
- * @brief Performs cyclic permutation (shift) on a vector.
- *
- * Shifts the elements of the input vector by the specified offset:
- * - **Positive offset:** Right shift.
- * - **Negative offset:** Left shift.
- *
- * @param vector The input vector to permute.
- * @param offset The number of positions to shift. Positive values shift right; negative values shift left.
- * @param result The resulting permuted vector.
- *
- * @note The `result` vector is modified in-place and should be initialized before calling.
- */
+
+#if BIPOLAR_MODE
+/**
+ * @brief Bundles packed-sign base vectors (see `sign_vector_get`) into a full bipolar sum.
+ *
+ * Equivalent to `bundle_multi` (or `bundle_multi_bound` when `bind_with` is not
+ * NULL) on the expanded +-1 vectors. Binding two sign-packed vectors is an XOR of
+ * their sign bits, so each component is `num_vectors - 2 * (number of set bits)`;
+ * the set bits are counted one VECTOR_SIGN_BITS word at a time.
+ *
+ * @param signs Sign-packed vectors to bundle.
+ * @param bind_with Optional sign-packed vectors bound to `signs` pairwise, or NULL.
+ * @param num_vectors The number of vectors to bundle.
+ * @param result The resulting bundled vector (full `vector_element` components).
+ */
+void bundle_signs(Vector **signs, Vector **bind_with, int num_vectors, Vector *result) {
+    if (signs == NULL || result == NULL) {
+        printf("Input vector for bundling not initialized");
+        exit(EXIT_FAILURE);
+    }
+    for (int w = 0; w < VECTOR_SIGN_COUNT; w++) {
+        int counts[VECTOR_SIGN_BITS] = {0};
+        for (int v = 0; v < num_vectors; v++) {
+            unsigned int bits = ((const unsigned int *)signs[v]->data)[w];
+            if (bind_with != NULL) {
+                bits ^= ((const unsigned int *)bind_with[v]->data)[w];
+            }
+            for (int b = 0; b < VECTOR_SIGN_BITS; b++) {
+                counts[b] += (int)((bits >> b) & 1u);
+            }
+        }
+        int base = w * VECTOR_SIGN_BITS;
+        int limit = VECTOR_DIMENSION - base;
+        if (limit > VECTOR_SIGN_BITS) {
+            limit = VECTOR_SIGN_BITS;
+        }
+        for (int b = 0; b < limit; b++) {
+            result->data[base + b] = num_vectors - 2 * counts[b];
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Performs cyclic permutation (shift) on a vector.
+ *
+ * Shifts the elements of the input vector by the specified offset:
+ * - **Positive offset:** Right shift.
+ * - **Negative offset:** Left shift.
+ *
+ * @param vector The input vector to permute.
+ * @param offset The number of positions to shift. Positive values shift right; negative values shift left.
+ * @param result The resulting permuted vector.
+ *
+ * @note The `result` vector is modified in-place and should be initialized before calling.
+ */
 void permute(Vector* vector, int offset, Vector* result) {
 #if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN && !BIPOLAR_MODE
     permute_like_krischan(vector, offset, result);
@@ -284,9 +899,9 @@ void permute(Vector* vector, int offset, Vector* result) {
         for (int i = 0; i < VECTOR_DIMENSION; i++) {
             result->data[(i + offset) % VECTOR_DIMENSION] = vector->data[i];
         }
-    }else {
-        // Negative offset (left shift)
-        offset = -offset;  // Make offset positive for easier calculation
+    }else {
+        // Negative offset (left shift)
+        offset = -offset;  // Make offset positive for easier calculation
         for (int i = 0; i < VECTOR_DIMENSION; i++) {
             result->data[i] = vector->data[(i + offset) % VECTOR_DIMENSION];
         }
@@ -305,96 +920,295 @@ void permute(Vector* vector, int offset, Vector* result) {
 #endif
 #endif
 }
-
-/**
- * @brief Computes the cosine similarity between two bipolar vectors.
- *
- * Measures the cosine of the angle between the two input vectors, returning a value in the range [-1, 1].
- *
- * @param vec1 The first input vector.
- * @param vec2 The second input vector.
- * 
- * @return The cosine similarity value, or -2 if any input vector is `NULL` or has zero norm.
- *
- * @note This function is applicable only to bipolar vectors.
- */
-double cosine_similarity(Vector *vec1, Vector *vec2) {
-    if (vec1 == NULL || vec2 == NULL) {
-        fprintf(stderr, "Error: NULL vector passed to cosine_similarity\n");
-        return -2;
-    }
-
-    double dot_product = 0;
-    long int norm1 = 0;
-    long int norm2 = 0;
-    long int summand1 = 0;
-    long int summand2 = 0;
-
-    for (int i = 0; i < VECTOR_DIMENSION; i++) {
-        dot_product += vec1->data[i] * vec2->data[i];
-        summand1 = (long int) vec1->data[i] * vec1->data[i];
-        summand2 = (long int) vec2->data[i] * vec2->data[i];
-        norm1 += summand1;
-        norm2 += summand2;
-    }
-
-    if (norm1 == 0 || norm2 == 0) {
-        return -2; // Handle divide-by-zero case
-    } else {
-        return dot_product / (sqrt(norm1) * sqrt(norm2));
-    }
-}
-
-/**
- * @brief Computes the Hamming distance between two binary vectors.
- *
- * Calculates the fraction of differing elements between the two vectors and projects it onto the range [-1, 1].
- *
- * @param vec1 The first input vector.
- * @param vec2 The second input vector.
- * 
- * @return The normalized Hamming distance in the range [-1, 1].
- *
- * @note This function is applicable only to binary vectors.
- */
+
+/**
+ * @brief Permutes a hypervector and binds it with a second one in a single pass.
+ *
+ * Equivalent to `permute(vector, offset, tmp); hdc_bind(tmp, other, result);` without the
+ * intermediate vector: each output word is rotated, bound and stored in one stream.
+ *
+ * @param vector The vector to permute.
+ * @param offset The permutation offset, with the same convention as `permute`.
+ * @param other The vector to bind with the permuted one.
+ * @param result The resulting vector. May alias `other`, must not alias `vector`.
+ */
+void permute_bind(Vector* vector, int offset, Vector* other, Vector* result) {
+#if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN && !BIPOLAR_MODE
+    vector_element buffer[VECTOR_WORD_COUNT];
+    Vector permuted = { buffer };
+    permute_like_krischan(vector, offset, &permuted);
+    hdc_bind(&permuted, other, result);
+#elif BIPOLAR_MODE
+    int shift = rotation_shift(offset);
+    for (int i = 0; i < VECTOR_DIMENSION; i++) {
+        int src = i - shift;
+        if (src < 0) {
+            src += VECTOR_DIMENSION;
+        }
+        result->data[i] = vector->data[src] * other->data[i];
+    }
+#else
+    int shift = rotation_shift(offset);
+    if (shift == 0) {
+        hdc_bind(vector, other, result);
+        return;
+    }
+    struct rotation_plan plan = make_rotation_plan(shift);
+    long words = (long)vector_storage_count();
+    for (long w = 0; w < words; w++) {
+        result->data[w] = rotated_word(vector->data, &plan, w) ^ other->data[w];
+    }
+    vector_mask_tail(result);
+#endif
+}
+
+/**
+ * @brief Binds a permuted hypervector into an accumulator in a single pass.
+ *
+ * Equivalent to `permute(vector, offset, tmp); hdc_bind(acc, tmp, acc);` without the
+ * intermediate vector (XOR in binary mode, multiplication in bipolar mode).
+ *
+ * @param acc The accumulator, updated in place. Must not alias `vector`.
+ * @param vector The vector to permute.
+ * @param offset The permutation offset, with the same convention as `permute`.
+ */
+void permute_xor_accumulate(Vector* acc, Vector* vector, int offset) {
+#if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN && !BIPOLAR_MODE
+    vector_element buffer[VECTOR_WORD_COUNT];
+    Vector permuted = { buffer };
+    permute_like_krischan(vector, offset, &permuted);
+    hdc_bind(acc, &permuted, acc);
+#elif BIPOLAR_MODE
+    int shift = rotation_shift(offset);
+    for (int i = 0; i < VECTOR_DIMENSION; i++) {
+        int src = i - shift;
+        if (src < 0) {
+            src += VECTOR_DIMENSION;
+        }
+        acc->data[i] *= vector->data[src];
+    }
+#else
+    int shift = rotation_shift(offset);
+    if (shift == 0) {
+        hdc_bind(acc, vector, acc);
+        return;
+    }
+    struct rotation_plan plan = make_rotation_plan(shift);
+    long words = (long)vector_storage_count();
+    for (long w = 0; w < words; w++) {
+        acc->data[w] ^= rotated_word(vector->data, &plan, w);
+    }
+    vector_mask_tail(acc);
+#endif
+}
+
+/**
+ * @brief Computes the cosine similarity between two bipolar vectors.
+ *
+ * Measures the cosine of the angle between the two input vectors, returning a value in the range [-1, 1].
+ *
+ * @param vec1 The first input vector.
+ * @param vec2 The second input vector.
+ * 
+ * @return The cosine similarity value, or -2 if any input vector is `NULL` or has zero norm.
+ *
+ * @note This function is applicable only to bipolar vectors.
+ */
+double cosine_similarity(Vector *vec1, Vector *vec2) {
+    if (vec1 == NULL || vec2 == NULL) {
+        fprintf(stderr, "Error: NULL vector passed to cosine_similarity\n");
+        return -2;
+    }
+
+    // Exact integer accumulation (vectorizes as int64 lanes); one division at the end.
+    long long dot = 0;
+    long long norm1 = 0;
+    long long norm2 = 0;
+
+    for (int i = 0; i < VECTOR_DIMENSION; i++) {
+        long long a = vec1->data[i];
+        long long b = vec2->data[i];
+        dot += a * b;
+        norm1 += a * a;
+        norm2 += b * b;
+    }
+
+    if (norm1 == 0 || norm2 == 0) {
+        return -2; // Handle divide-by-zero case
+    } else {
+        return (double)dot / sqrt((double)norm1 * (double)norm2);
+    }
+}
+
+#if BIPOLAR_MODE
+/**
+ * @brief Computes the integer dot product of two bipolar vectors.
+ *
+ * The products are accumulated exactly in 64 bits, so bundled class vectors
+ * with large components cannot overflow.
+ *
+ * @param vec1 The first input vector.
+ * @param vec2 The second input vector.
+ *
+ * @return The dot product.
+ */
+long long dot_product(const Vector *vec1, const Vector *vec2) {
+    long long dot = 0;
+    for (int i = 0; i < VECTOR_DIMENSION; i++) {
+        dot += (long long)vec1->data[i] * vec2->data[i];
+    }
+    return dot;
+}
+#endif
+
+/**
+ * @brief Computes the Hamming distance between two binary vectors.
+ *
+ * Calculates the fraction of differing elements between the two vectors and projects it onto the range [-1, 1].
+ *
+ * @param vec1 The first input vector.
+ * @param vec2 The second input vector.
+ * 
+ * @return The normalized Hamming distance in the range [-1, 1].
+ *
+ * @note This function is applicable only to binary vectors.
+ */
 double hamming_distance(Vector *vec1, Vector *vec2) {
     int distance = 0;
     size_t words = vector_storage_count();
+#if BIPOLAR_MODE
+    // No word kernels are built for bipolar storage.
     for (size_t w = 0; w < words; w++) {
-        uint64_t diff = vec1->data[w] ^ vec2->data[w];
+        uint64_t diff = (uint64_t)(vec1->data[w] ^ vec2->data[w]);
         if (w + 1 == words && (VECTOR_DIMENSION & 63) != 0) {
-            uint64_t mask = (1ull << (VECTOR_DIMENSION & 63)) - 1ull;
-            diff &= mask;
+            diff &= (1ull << (VECTOR_DIMENSION & 63)) - 1ull;
         }
         distance += __builtin_popcountll(diff);
     }
+#else
+    if ((VECTOR_DIMENSION & 63) != 0) {
+        // The partial last word is masked so stale tail bits never count.
+        uint64_t mask = (1ull << (VECTOR_DIMENSION & 63)) - 1ull;
+        uint64_t diff = (vec1->data[words - 1] ^ vec2->data[words - 1]) & mask;
+        distance += __builtin_popcountll(diff);
+        words--;
+    }
+    distance += (int)active_kernels->popcount_xor(vec1->data, vec2->data, words);
+#endif
     // Project Hamming distance onto the range -1 to 1
     // distance of 0 (identical) -> 1, max distance -> -1
-    return 1.0 - 2.0 * ((double)distance / VECTOR_DIMENSION);
-}
-
-/**
- * @brief Computes the similarity between two vectors based on the vector mode.
- *
- * - **Bipolar mode:** Uses cosine similarity.
- * - **Binary mode:** Uses normalized Hamming distance.
- *
- * @param vec1 The first input vector.
- * @param vec2 The second input vector.
- * 
- * @return The similarity value, or -2 if any input vector is `NULL`.
- */
-double similarity_check(Vector *vec1, Vector *vec2) {
-    if (vec1 == NULL || vec2 == NULL) {
-        fprintf(stderr, "Error: NULL vector passed to similarityCheck\n");
-        return -2;
-    }
-
-#if BIPOLAR_MODE
-    // Use cosine similarity for bipolar vectors
-    return cosine_similarity(vec1, vec2);
-#else
-    // Use Hamming distance for binary vectors, projected onto -1 to 1
-    return hamming_distance(vec1, vec2);
-#endif
+    return 1.0 - 2.0 * ((double)distance / VECTOR_DIMENSION);
+}
+
+#if !BIPOLAR_MODE
+/**
+ * @brief Projects a raw Hamming distance onto the similarity range [-1, 1] of `hamming_distance`.
+ */
+double hamming_similarity(int distance) {
+    return 1.0 - 2.0 * ((double)distance / VECTOR_DIMENSION);
+}
+
+/**
+ * @brief Adds the Hamming distances of `query` to each row over a range of storage words.
+ *
+ * Lets callers accumulate distances progressively, e.g. to stop once the
+ * nearest row is decided. A range covering the partial last word only counts
+ * its bits below VECTOR_DIMENSION.
+ *
+ * @param query The query vector.
+ * @param rows The vectors the query is compared against.
+ * @param num_rows Number of rows.
+ * @param offset First storage word of the range.
+ * @param words Number of storage words in the range.
+ * @param distances Per-row distances the counts are added to.
+ */
+void hamming_distance_accumulate(Vector *query, Vector *const *rows, int num_rows,
+                                 size_t offset, size_t words, int *distances) {
+    size_t full_words = (size_t)VECTOR_DIMENSION / 64;
+    size_t end = offset + words;
+    if ((VECTOR_DIMENSION & 63) != 0 && end > full_words) {
+        uint64_t mask = (1ull << (VECTOR_DIMENSION & 63)) - 1ull;
+        uint64_t tail = query->data[full_words];
+        for (int r = 0; r < num_rows; r++) {
+            distances[r] += __builtin_popcountll((tail ^ rows[r]->data[full_words]) & mask);
+        }
+        end = full_words;
+    }
+    if (end > offset) {
+        active_kernels->popcount_xor_rows(query->data, rows, num_rows, offset, end - offset, distances);
+    }
+}
+
+/**
+ * @brief Computes the raw Hamming distances of a block of queries to a set of rows.
+ *
+ * GEMM-style blocking: the dimension is walked in word tiles sized so that the
+ * tile of every row (at most HAMMING_TILE_BYTES together) stays in L1 while
+ * HAMMING_QUERY_BLOCK queries are compared against it, and the kernels hold
+ * each query register while XORing it against several rows.
+ *
+ * @param queries The query vectors.
+ * @param num_queries Number of queries.
+ * @param rows The vectors every query is compared against (e.g. class vectors).
+ * @param num_rows Number of rows.
+ * @param distances Receives `num_queries * num_rows` distances, the distance of
+ *        query `q` to row `r` at `distances[q * num_rows + r]`.
+ */
+void hamming_distance_block(Vector *const *queries, int num_queries,
+                            Vector *const *rows, int num_rows, int *distances) {
+    if (num_queries <= 0 || num_rows <= 0) {
+        return;
+    }
+    size_t full_words = (size_t)VECTOR_DIMENSION / 64;
+    size_t tile_words = (size_t)HAMMING_TILE_BYTES / sizeof(uint64_t) / (size_t)num_rows;
+    tile_words = tile_words < 8 ? 8 : tile_words & ~(size_t)7;
+
+    for (int first = 0; first < num_queries; first += HAMMING_QUERY_BLOCK) {
+        int last = first + HAMMING_QUERY_BLOCK < num_queries ? first + HAMMING_QUERY_BLOCK : num_queries;
+        memset(distances + (size_t)first * num_rows, 0, (size_t)(last - first) * num_rows * sizeof(*distances));
+        for (size_t offset = 0; offset < full_words; offset += tile_words) {
+            size_t words = full_words - offset < tile_words ? full_words - offset : tile_words;
+            for (int q = first; q < last; q++) {
+                active_kernels->popcount_xor_rows(queries[q]->data, rows, num_rows, offset, words,
+                                                  distances + (size_t)q * num_rows);
+            }
+        }
+        if ((VECTOR_DIMENSION & 63) != 0) {
+            // The partial last word is masked so stale tail bits never count.
+            uint64_t mask = (1ull << (VECTOR_DIMENSION & 63)) - 1ull;
+            for (int q = first; q < last; q++) {
+                uint64_t tail = queries[q]->data[full_words];
+                for (int r = 0; r < num_rows; r++) {
+                    distances[(size_t)q * num_rows + r] += __builtin_popcountll((tail ^ rows[r]->data[full_words]) & mask);
+                }
+            }
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Computes the similarity between two vectors based on the vector mode.
+ *
+ * - **Bipolar mode:** Uses cosine similarity.
+ * - **Binary mode:** Uses normalized Hamming distance.
+ *
+ * @param vec1 The first input vector.
+ * @param vec2 The second input vector.
+ * 
+ * @return The similarity value, or -2 if any input vector is `NULL`.
+ */
+double similarity_check(Vector *vec1, Vector *vec2) {
+    if (vec1 == NULL || vec2 == NULL) {
+        fprintf(stderr, "Error: NULL vector passed to similarityCheck\n");
+        return -2;
+    }
+
+#if BIPOLAR_MODE
+    // Use cosine similarity for bipolar vectors
+    return cosine_similarity(vec1, vec2);
+#else
+    // Use Hamming distance for binary vectors, projected onto -1 to 1
+    return hamming_distance(vec1, vec2);
+#endif
 }
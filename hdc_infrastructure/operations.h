@@ -11,8 +11,35 @@
 #include <stdbool.h>
 #include "vector.h"
 
-void bind(Vector* vector1,Vector* vector2,Vector* result);
+void hdc_bind(Vector* vector1,Vector* vector2,Vector* result);
 void bundle(Vector* vector1, Vector* vector2, Vector* result);
 void bundle_multi(Vector** vectors, int num_vectors, Vector* result);
+void bundle_multi_bound(Vector** vectors, Vector** bind_with, int num_vectors, Vector* result);
 void permute(Vector* vector, int offset, Vector* result);
-double similarity_check(Vector *vec1, Vector *vec2);
\ No newline at end of file
+void permute_bind(Vector* vector, int offset, Vector* other, Vector* result);
+void permute_xor_accumulate(Vector* acc, Vector* vector, int offset);
+#if !BIPOLAR_MODE
+int bit_counter_planes(int max_count);
+void bit_counter_add(uint64_t *planes, int nbits, const Vector *vector);
+void bit_counter_merge(uint64_t *planes, const uint64_t *other, int nbits);
+void bit_counter_threshold(const uint64_t *planes, int nbits, int threshold, Vector *result);
+#ifndef HAMMING_TILE_BYTES
+#define HAMMING_TILE_BYTES 16384 // row bytes per word tile of hamming_distance_block (kept in L1)
+#endif
+#ifndef HAMMING_QUERY_BLOCK
+#define HAMMING_QUERY_BLOCK 8 // queries compared against one word tile of the rows
+#endif
+double hamming_similarity(int distance);
+void hamming_distance_accumulate(Vector *query, Vector *const *rows, int num_rows,
+                                 size_t offset, size_t words, int *distances);
+void hamming_distance_block(Vector *const *queries, int num_queries,
+                            Vector *const *rows, int num_rows, int *distances);
+#endif
+#if BIPOLAR_MODE
+void bundle_signs(Vector **signs, Vector **bind_with, int num_vectors, Vector *result);
+long long dot_product(const Vector *vec1, const Vector *vec2);
+#endif
+double hamming_distance(Vector *vec1, Vector *vec2);
+double similarity_check(Vector *vec1, Vector *vec2);
+const char *operations_kernel_name(void);
+int operations_use_kernel(const char *name);
\ No newline at end of file
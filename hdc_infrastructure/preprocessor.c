@@ -18,48 +18,115 @@
  * @brief Downsamples the input data by a specified factor.
  *
  * This function reduces the size of the input dataset by selecting every `DOWNSAMPLE`-th sample.
- * It adjusts both the data and their corresponding labels accordingly.
+ * It adjusts both the data and their corresponding labels accordingly. No sample is copied:
+ * the downsampled rows point into `data`.
  *
  * @param data The original 2D array of input data with dimensions `[original_size][NUM_FEATURES]`.
  * @param labels The array of labels corresponding to the input data, with `original_size` elements.
  * @param original_size The total number of samples in the input data.
- * @param downsampled_data Pointer to the output 2D array for the downsampled data.
+ * @param downsampled_data Pointer to the output array of row pointers into `data`.
  * @param downsampled_labels Pointer to the output array for the downsampled labels.
  * @param newSize Pointer to a variable to store the new size of the downsampled data.
  *
  * @note The output arrays (`downsampled_data` and `downsampled_labels`) are dynamically allocated
- * and must be freed by the caller.
+ * and must be released with `free` by the caller; the rows themselves still belong to `data`,
+ * which must outlive the view.
  *
  * @warning If memory allocation fails at any point, the program will terminate with an error message.
  */
 void down_sample(double** data, int* labels, size_t original_size, double*** downsampled_data, int** downsampled_labels, size_t *newSize) {
     size_t new_length = original_size / DOWNSAMPLE;
-    *downsampled_data = (double **)malloc(new_length * sizeof(double*));
+    *downsampled_data = (double **)malloc((new_length > 0 ? new_length : 1) * sizeof(double*));
     if(*downsampled_data == NULL) {
         perror("Malloc failed for downsampled_data");
         exit(EXIT_FAILURE);
     }
 
-    *downsampled_labels = (int *)malloc(new_length * sizeof(int));
+    *downsampled_labels = (int *)malloc((new_length > 0 ? new_length : 1) * sizeof(int));
     if(*downsampled_labels == NULL) {
         perror("Malloc failed for downsampled_labels");
         exit(EXIT_FAILURE);
     }
 
     for (size_t i = 0; i < new_length; i++) {
-        (*downsampled_data)[i] = (double *)malloc(NUM_FEATURES * sizeof(double));
-        if ((*downsampled_data)[i] == NULL) {
-            perror("Malloc failed for downsampled_data[i]");
-            exit(EXIT_FAILURE);
-        }
-        memcpy((*downsampled_data)[i], data[i * DOWNSAMPLE], NUM_FEATURES * sizeof(double));
+        (*downsampled_data)[i] = data[i * DOWNSAMPLE];
         (*downsampled_labels)[i] = labels[i * DOWNSAMPLE];
     }
 
     *newSize = new_length;
+}
 
-    if(*downsampled_data == NULL) {
-        perror("Error already in downsampling");
+/**
+ * @brief Downsamples a sample matrix by `DOWNSAMPLE` without copying any sample.
+ *
+ * The result is a strided view onto `data` (see `sample_matrix_view`), so it
+ * must not outlive it; only the labels are copied.
+ *
+ * @param data The original samples.
+ * @param labels The labels of `data`, one per row.
+ * @param downsampled_data Receives the view of every `DOWNSAMPLE`-th row.
+ * @param downsampled_labels Receives the matching labels; must be freed by the caller.
+ *
+ * @warning If memory allocation fails, the program will terminate with an error message.
+ */
+void down_sample_matrix(const struct sample_matrix *data, const int *labels,
+                        struct sample_matrix *downsampled_data, int **downsampled_labels) {
+    size_t new_length = data->rows / DOWNSAMPLE;
+    sample_matrix_view(data, 0, DOWNSAMPLE, new_length, downsampled_data);
+
+    *downsampled_labels = (int *)malloc((new_length > 0 ? new_length : 1) * sizeof(int));
+    if (*downsampled_labels == NULL) {
+        perror("Malloc failed for downsampled_labels");
         exit(EXIT_FAILURE);
     }
+    for (size_t i = 0; i < new_length; i++) {
+        (*downsampled_labels)[i] = labels[i * DOWNSAMPLE];
+    }
+}
+
+/**
+ * @brief Initializes a streaming decimator for the live path.
+ *
+ * @param dec The decimator.
+ * @param factor Keep one output per `factor` input samples (values < 1 act as 1).
+ * @param average 0 keeps the first sample of every block, like `down_sample`;
+ *        1 emits the mean of the block (boxcar anti-aliasing filter).
+ */
+void init_stream_decimator(struct stream_decimator *dec, int factor, int average) {
+    dec->factor = factor > 1 ? factor : 1;
+    dec->average = average;
+    reset_stream_decimator(dec);
+}
+
+void reset_stream_decimator(struct stream_decimator *dec) {
+    dec->phase = 0;
+    memset(dec->sum, 0, sizeof(dec->sum));
+}
+
+/**
+ * @brief Feeds one raw sample; returns the sample to encode, or NULL when this one is dropped.
+ *
+ * Meant to run inline in front of `push_ngram_encoder_sample`:
+ * `const double *x = stream_decimator_push(&dec, raw); if (x) push_ngram_encoder_sample(enc, state, x, hv);`
+ * The returned pointer is either `sample` or the decimator's own buffer and
+ * stays valid until the next push.
+ */
+const double *stream_decimator_push(struct stream_decimator *dec, const double *sample) {
+    int phase = dec->phase;
+    dec->phase = phase + 1 == dec->factor ? 0 : phase + 1;
+    if (!dec->average) {
+        return phase == 0 ? sample : NULL;
+    }
+    for (int feature = 0; feature < NUM_FEATURES; feature++) {
+        dec->sum[feature] += sample[feature];
+    }
+    if (phase + 1 < dec->factor) {
+        return NULL;
+    }
+    double scale = 1.0 / (double)dec->factor;
+    for (int feature = 0; feature < NUM_FEATURES; feature++) {
+        dec->out[feature] = dec->sum[feature] * scale;
+        dec->sum[feature] = 0.0;
+    }
+    return dec->out;
 }
@@ -11,9 +11,25 @@
 #error "No EMG type defined. Please define HAND_EMG or FOOT_EMG."
 #endif
 #include <stddef.h>
+#include "sample_matrix.h"
 
+/**
+ * @brief Streaming decimation stage for live data (see `stream_decimator_push`).
+ */
+struct stream_decimator {
+    int factor;                 /**< Input samples per output sample. */
+    int average;                /**< 1: emit block means, 0: keep the first sample of each block. */
+    int phase;                  /**< Position inside the current block. */
+    double sum[NUM_FEATURES];   /**< Running block sum (averaging mode). */
+    double out[NUM_FEATURES];   /**< Last emitted block mean. */
+};
 
 // Function to downsample the data
 void down_sample(double** data, int* labels, size_t original_size, double*** downsampled_data, int** downsampled_labels, size_t* new_size);
+void down_sample_matrix(const struct sample_matrix *data, const int *labels,
+                        struct sample_matrix *downsampled_data, int **downsampled_labels);
+void init_stream_decimator(struct stream_decimator *dec, int factor, int average);
+void reset_stream_decimator(struct stream_decimator *dec);
+const double *stream_decimator_push(struct stream_decimator *dec, const double *sample);
 
 #endif // PREPROCESSOR_H
@@ -0,0 +1,215 @@
+/**
+ * @file profiler.c
+ * @brief Per-thread stage counters (see profiler.h), merged on demand.
+ *
+ * @details
+ * Every thread that records a stage gets its own counter block on first use,
+ * linked into a global list, so recording never shares a cache line or takes
+ * a lock. Each block has a single writer; the merge reads the counters with
+ * relaxed atomics while the threads keep running. Blocks of finished threads
+ * stay in the list, so their time still counts. Ticks are converted to ns
+ * with the rate measured between the first recorded stage and the merge.
+ * HDC_COST_MODEL builds keep their operation counters in the same blocks.
+ */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "profiler.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *const stage_names[HDC_NUM_STAGES] = {
+    "quantize",
+    "encode_timestamp",
+    "ngram",
+    "class_update",
+    "classify",
+    "ga_evaluate",
+};
+
+static const char *const cost_counter_names[HDC_NUM_COST_COUNTERS] = {
+    "quantizer_row_reads",
+    "quantizer_row_read_bytes",
+    "cim_reads",
+    "cim_read_bytes",
+    "assoc_reads",
+    "assoc_read_bytes",
+    "assoc_writes",
+    "assoc_write_bytes",
+    "xor_words",
+    "popcount_words",
+    "counter_updates",
+};
+
+const char *hdc_profile_stage_name(enum hdc_profile_stage stage) {
+    return (stage >= 0 && stage < HDC_NUM_STAGES) ? stage_names[stage] : "unknown";
+}
+
+const char *hdc_cost_counter_name(enum hdc_cost_counter counter) {
+    return (counter >= 0 && counter < HDC_NUM_COST_COUNTERS) ? cost_counter_names[counter] : "unknown";
+}
+
+#if HDC_PROFILE || HDC_COST_MODEL
+#include <pthread.h>
+#include <stdatomic.h>
+
+struct profile_block {
+    _Atomic uint64_t ticks[HDC_NUM_STAGES];
+    _Atomic uint64_t calls[HDC_NUM_STAGES];
+    _Atomic uint64_t cost[HDC_NUM_STAGES][HDC_NUM_COST_COUNTERS];
+    struct profile_block *next;
+};
+
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct profile_block *profile_blocks = NULL;
+static _Thread_local struct profile_block *thread_block = NULL;
+static uint64_t origin_ticks;
+static double origin_ns;
+
+static double monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+// Single writer per block: a plain load and store, no locked add.
+static inline void add_relaxed(_Atomic uint64_t *counter, uint64_t amount) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + amount,
+                          memory_order_relaxed);
+}
+
+static struct profile_block *register_thread_block(void) {
+    struct profile_block *block = (struct profile_block *)calloc(1, sizeof(*block));
+    if (!block) {
+        fprintf(stderr, "profiler: allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_lock(&profile_lock);
+    if (profile_blocks == NULL) {
+        origin_ticks = hdc_profile_ticks();
+        origin_ns = monotonic_ns();
+    }
+    block->next = profile_blocks;
+    profile_blocks = block;
+    pthread_mutex_unlock(&profile_lock);
+    thread_block = block;
+    return block;
+}
+
+/**
+ * @brief Adds the time since `start` and `calls` calls to `stage` of the calling thread.
+ */
+void hdc_profile_record(enum hdc_profile_stage stage, uint64_t start, uint64_t calls) {
+    uint64_t elapsed = hdc_profile_ticks() - start;
+    struct profile_block *block = thread_block ? thread_block : register_thread_block();
+    add_relaxed(&block->ticks[stage], elapsed);
+    add_relaxed(&block->calls[stage], calls);
+}
+
+/**
+ * @brief Adds `calls` calls to `stage` of the calling thread without timing them.
+ */
+void hdc_profile_count(enum hdc_profile_stage stage, uint64_t calls) {
+    struct profile_block *block = thread_block ? thread_block : register_thread_block();
+    add_relaxed(&block->calls[stage], calls);
+}
+
+/**
+ * @brief Adds `amount` to one operation counter of `stage` of the calling thread.
+ */
+void hdc_cost_record(enum hdc_profile_stage stage, enum hdc_cost_counter counter, uint64_t amount) {
+    struct profile_block *block = thread_block ? thread_block : register_thread_block();
+    add_relaxed(&block->cost[stage][counter], amount);
+}
+
+/**
+ * @brief Sums the counters of every thread recorded so far.
+ */
+void hdc_profile_snapshot(struct hdc_profile_totals *totals) {
+    memset(totals, 0, sizeof(*totals));
+    pthread_mutex_lock(&profile_lock);
+    for (const struct profile_block *block = profile_blocks; block; block = block->next) {
+        for (int stage = 0; stage < HDC_NUM_STAGES; stage++) {
+            totals->ticks[stage] += atomic_load_explicit(&block->ticks[stage], memory_order_relaxed);
+            totals->calls[stage] += atomic_load_explicit(&block->calls[stage], memory_order_relaxed);
+            for (int counter = 0; counter < HDC_NUM_COST_COUNTERS; counter++) {
+                totals->cost[stage][counter] +=
+                    atomic_load_explicit(&block->cost[stage][counter], memory_order_relaxed);
+            }
+        }
+    }
+    double ns_per_tick = 0.0;
+    if (profile_blocks != NULL) {
+        uint64_t ticks = hdc_profile_ticks() - origin_ticks;
+        ns_per_tick = ticks > 0 ? (monotonic_ns() - origin_ns) / (double)ticks : 0.0;
+    }
+    pthread_mutex_unlock(&profile_lock);
+    for (int stage = 0; stage < HDC_NUM_STAGES; stage++) {
+        totals->ns[stage] = (double)totals->ticks[stage] * ns_per_tick;
+    }
+}
+#else
+void hdc_profile_snapshot(struct hdc_profile_totals *totals) {
+    memset(totals, 0, sizeof(*totals));
+}
+#endif
+
+/**
+ * @brief Prints the merged time, calls and time per call of every stage that ran.
+ */
+void hdc_profile_print(FILE *out) {
+    struct hdc_profile_totals totals;
+    hdc_profile_snapshot(&totals);
+    fprintf(out, "\nStage profile (all threads)\n");
+    fprintf(out, "  %-18s %14s %14s %12s\n", "stage", "total ms", "calls", "ns/call");
+    for (int stage = 0; stage < HDC_NUM_STAGES; stage++) {
+        if (totals.calls[stage] == 0) {
+            continue;
+        }
+        fprintf(out, "  %-18s %14.3f %14llu %12.1f\n", stage_names[stage], totals.ns[stage] * 1e-6,
+                (unsigned long long)totals.calls[stage], totals.ns[stage] / (double)totals.calls[stage]);
+    }
+}
+
+/**
+ * @brief Prints the operation counters of every stage that ran, in total and per call.
+ *
+ * A streamed sample (`push_ngram_encoder_sample` plus `classify`) costs one
+ * call of quantize, encode_timestamp, ngram and classify; the last block sums
+ * those per-call costs. Training and GA stages are listed but not part of it.
+ */
+void hdc_cost_print(FILE *out) {
+    static const enum hdc_profile_stage inference_stages[] = {
+        HDC_STAGE_QUANTIZE, HDC_STAGE_ENCODE_TIMESTAMP, HDC_STAGE_NGRAM, HDC_STAGE_CLASSIFY,
+    };
+    struct hdc_profile_totals totals;
+    hdc_profile_snapshot(&totals);
+    fprintf(out, "\nCost model (all threads)\n");
+    fprintf(out, "  %-18s %-26s %16s %14s\n", "stage", "counter", "total", "per call");
+    for (int stage = 0; stage < HDC_NUM_STAGES; stage++) {
+        if (totals.calls[stage] == 0) {
+            continue;
+        }
+        for (int counter = 0; counter < HDC_NUM_COST_COUNTERS; counter++) {
+            if (totals.cost[stage][counter] == 0) {
+                continue;
+            }
+            fprintf(out, "  %-18s %-26s %16llu %14.1f\n", stage_names[stage], cost_counter_names[counter],
+                    (unsigned long long)totals.cost[stage][counter],
+                    (double)totals.cost[stage][counter] / (double)totals.calls[stage]);
+        }
+    }
+
+    fprintf(out, "\nCost per streamed sample (one call of each inference stage)\n");
+    for (int counter = 0; counter < HDC_NUM_COST_COUNTERS; counter++) {
+        double per_sample = 0.0;
+        for (size_t i = 0; i < sizeof(inference_stages) / sizeof(inference_stages[0]); i++) {
+            enum hdc_profile_stage stage = inference_stages[i];
+            if (totals.calls[stage] > 0) {
+                per_sample += (double)totals.cost[stage][counter] / (double)totals.calls[stage];
+            }
+        }
+        fprintf(out, "  %-26s %14.1f\n", cost_counter_names[counter], per_sample);
+    }
+}
@@ -0,0 +1,117 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef HDC_PROFILE
+#define HDC_PROFILE 0 // per-stage time and call counters (0 = compiled out, no overhead)
+#endif
+#ifndef HDC_COST_MODEL
+#define HDC_COST_MODEL 0 // per-stage operation and memory-traffic counters (0 = compiled out, no overhead)
+#endif
+
+/**
+ * @brief Pipeline stages with their own counters.
+ *
+ * - **QUANTIZE**: One sample mapped to signal levels (`quantizer_quantize_sample`).
+ * - **ENCODE_TIMESTAMP**: One timestamp hypervector from its levels.
+ * - **NGRAM**: Folding a timestamp into the n-gram (permute/bind composition).
+ * - **CLASS_UPDATE**: Adding n-grams to the class counters (training and retraining).
+ * - **CLASSIFY**: Nearest-class search, counted per query.
+ * - **GA_EVALUATE**: Training and scoring GA candidates, counted per candidate;
+ *   includes the stages above that run inside it.
+ */
+enum hdc_profile_stage {
+    HDC_STAGE_QUANTIZE,
+    HDC_STAGE_ENCODE_TIMESTAMP,
+    HDC_STAGE_NGRAM,
+    HDC_STAGE_CLASS_UPDATE,
+    HDC_STAGE_CLASSIFY,
+    HDC_STAGE_GA_EVALUATE,
+    HDC_NUM_STAGES
+};
+
+/**
+ * @brief Primitive operations and memory traffic counted per stage by HDC_COST_MODEL builds.
+ *
+ * The memory counters use the names of the SystemC `MemoryStats`, so both
+ * models report the same quantities. Reads and writes count hypervectors (a
+ * quantizer row is one feature's cuts); XOR and popcount count 64-bit words;
+ * counter updates count one bundling counter (one dimension of one vote).
+ */
+enum hdc_cost_counter {
+    HDC_COST_QUANTIZER_ROW_READS,
+    HDC_COST_QUANTIZER_ROW_READ_BYTES,
+    HDC_COST_CIM_READS,
+    HDC_COST_CIM_READ_BYTES,
+    HDC_COST_ASSOC_READS,
+    HDC_COST_ASSOC_READ_BYTES,
+    HDC_COST_ASSOC_WRITES,
+    HDC_COST_ASSOC_WRITE_BYTES,
+    HDC_COST_XOR_WORDS,
+    HDC_COST_POPCOUNT_WORDS,
+    HDC_COST_COUNTER_UPDATES,
+    HDC_NUM_COST_COUNTERS
+};
+
+/**
+ * @brief Counters of all threads merged: raw ticks, their wall time, the number of calls
+ * and (HDC_COST_MODEL) the operation counters.
+ */
+struct hdc_profile_totals {
+    uint64_t ticks[HDC_NUM_STAGES];
+    double ns[HDC_NUM_STAGES];
+    uint64_t calls[HDC_NUM_STAGES];
+    uint64_t cost[HDC_NUM_STAGES][HDC_NUM_COST_COUNTERS];
+};
+
+#if HDC_PROFILE || HDC_COST_MODEL
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+/**
+ * @brief Current time stamp counter (cycles), converted to ns when the counters are merged.
+ */
+static inline uint64_t hdc_profile_ticks(void) {
+    return (uint64_t)__rdtsc();
+}
+#else
+#include <time.h>
+static inline uint64_t hdc_profile_ticks(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+#endif
+
+void hdc_profile_record(enum hdc_profile_stage stage, uint64_t start, uint64_t calls);
+void hdc_profile_count(enum hdc_profile_stage stage, uint64_t calls);
+void hdc_cost_record(enum hdc_profile_stage stage, enum hdc_cost_counter counter, uint64_t amount);
+#endif
+
+#if HDC_PROFILE
+// Brackets one stage in a function; END must follow BEGIN in the same scope.
+#define HDC_PROFILE_BEGIN(stage) const uint64_t hdc_profile_start_##stage = hdc_profile_ticks()
+#define HDC_PROFILE_END(stage, calls) hdc_profile_record((stage), hdc_profile_start_##stage, (uint64_t)(calls))
+#elif HDC_COST_MODEL
+// Cost model builds count the calls without timing them, to report the counters per call.
+#define HDC_PROFILE_BEGIN(stage) ((void)0)
+#define HDC_PROFILE_END(stage, calls) hdc_profile_count((stage), (uint64_t)(calls))
+#else
+#define HDC_PROFILE_BEGIN(stage) ((void)0)
+#define HDC_PROFILE_END(stage, calls) ((void)0)
+#endif
+
+#if HDC_COST_MODEL
+#define HDC_COST_ADD(stage, counter, amount) hdc_cost_record((stage), (counter), (uint64_t)(amount))
+#else
+#define HDC_COST_ADD(stage, counter, amount) ((void)0)
+#endif
+
+const char *hdc_profile_stage_name(enum hdc_profile_stage stage);
+const char *hdc_cost_counter_name(enum hdc_cost_counter counter);
+void hdc_profile_snapshot(struct hdc_profile_totals *totals);
+void hdc_profile_print(FILE *out);
+void hdc_cost_print(FILE *out);
+
+#endif // PROFILER_H
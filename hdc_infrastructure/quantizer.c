@@ -1,4 +1,7 @@
 #include "quantizer.h"
+#include "byte_order.h"
+#include "profiler.h"
+#include <limits.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -13,6 +16,7 @@
 #define TREE_1D_MIN_SAMPLES_LEAF 10
 #define TREE_1D_THRESHOLD_EPS 1e-12
 #define CHIMERGE_THRESHOLD_EPS 1e-12
+#define SUPERVISED_HISTOGRAM_BINS 4096 // class-histogram bins the split/merge search runs on (0: one per distinct value)
 
 #if BIPOLAR_MODE != 0 || MODEL_VARIANT != MODEL_VARIANT_FUSION
 #error "quantizer: only BIPOLAR_MODE=0 and MODEL_VARIANT_FUSION are supported in the current branch. For deprecated versions go back in git history to end of April."
@@ -30,14 +34,24 @@ typedef struct {
 typedef struct {
     int start;
     int end;
+    int split_pos;
+    double threshold;
+    double gain;
+    int has_split;
 } tree_leaf_t;
 
+/**
+ * @brief Value range of sorted samples with its per-class counts.
+ *
+ * Pre-binned histogram entry for the supervised modes; ChiMerge also uses it
+ * as its interval.
+ */
 typedef struct {
     double left_value;
     double right_value;
     int counts[NUM_CLASSES];
     int sample_count;
-} chimerge_interval_t;
+} class_interval_t;
 
 typedef struct {
     double *boundaries;
@@ -45,6 +59,8 @@ typedef struct {
     int num_features;
     int num_levels;
     int fitted;
+    int borrowed_boundaries; /* boundaries point into caller memory (quantizer_wrap_cuts) */
+    int32_t *thresholds_i16; /* per cut the smallest int16 code above it (install_level_lookup) */
     int non_finite_replacements;
 #if BINNING_MODE == GA_REFINED_BINNING
     uint16_t *ga_refined_flip_counts;
@@ -73,9 +89,18 @@ typedef struct {
     int total_fallback_thresholds;
 } quantizer_statistics_t;
 
-static quantizer_state_t g_quantizer_state = {0};
-static quantizer_statistics_t g_quantizer_statistics = {0};
+/**
+ * @brief A fitted quantizer: its cuts plus the diagnostics of the fit.
+ */
+struct quantizer {
+    quantizer_state_t state;
+    quantizer_statistics_t stats;
+};
 
+/**
+ * @brief Quantizer behind the global API (`quantizer_fit_from_training`, `get_signal_level`, ...).
+ */
+static struct quantizer g_quantizer = {0};
 
 static size_t boundary_count_total_for(int num_features, int num_levels) {
     if (num_features <= 0 || num_levels <= 1) {
@@ -91,15 +116,15 @@ static size_t center_count_total_for(int num_features, int num_levels) {
     return (size_t)num_features * (size_t)num_levels;
 }
 
-#if BINNING_MODE == KMEANS_1D_BINNING
-static int center_index(int feature_idx, int center_idx) {
-    return feature_idx * g_quantizer_state.num_levels + center_idx;
+#if BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING
+static int center_index(struct quantizer *quantizer, int feature_idx, int center_idx) {
+    return feature_idx * quantizer->state.num_levels + center_idx;
 }
 #endif
 
-#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING || BINNING_MODE == GA_REFINED_BINNING
-static int occupancy_index(int feature_idx, int level_idx) {
-    return feature_idx * g_quantizer_state.num_levels + level_idx;
+#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING || BINNING_MODE == GA_REFINED_BINNING
+static int occupancy_index(struct quantizer *quantizer, int feature_idx, int level_idx) {
+    return feature_idx * quantizer->state.num_levels + level_idx;
 }
 #endif
 
@@ -109,11 +134,11 @@ static void fill_with_nan(double *data, size_t count) {
     }
 }
 
-static int boundary_index(int feature_idx, int cut_idx) {
-    return feature_idx * (g_quantizer_state.num_levels - 1) + cut_idx;
+static int boundary_index(struct quantizer *quantizer, int feature_idx, int cut_idx) {
+    return feature_idx * (quantizer->state.num_levels - 1) + cut_idx;
 }
 
-#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING
+#if BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING
 static int compare_doubles(const void *a, const void *b) {
     double da = *(const double *)a;
     double db = *(const double *)b;
@@ -125,7 +150,9 @@ static int compare_doubles(const void *a, const void *b) {
     }
     return 0;
 }
+#endif
 
+#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING
 static double interpolate_sorted_value(const double *sorted_values, int sample_count, double q) {
     if (sample_count <= 0) {
         return 0.0;
@@ -175,47 +202,47 @@ static double interpolate_sorted_sample_value(const feature_sample_t *sorted_sam
 }
 #endif
 
-static int allocate_quantizer_state(int num_features, int num_levels) {
+static int allocate_quantizer_state(struct quantizer *quantizer, int num_features, int num_levels) {
     size_t boundary_count = boundary_count_total_for(num_features, num_levels);
     size_t center_count = center_count_total_for(num_features, num_levels);
 
     if (boundary_count > 0) {
-        g_quantizer_state.boundaries = (double *)malloc(boundary_count * sizeof(double));
+        quantizer->state.boundaries = (double *)malloc(boundary_count * sizeof(double));
     }
     if (center_count > 0) {
-        g_quantizer_state.centers = (double *)malloc(center_count * sizeof(double));
-        g_quantizer_statistics.training_occupancy = (int *)calloc(center_count, sizeof(int));
-    }
-
-    g_quantizer_statistics.refinement_counts = (int *)calloc((size_t)num_features, sizeof(int));
-    g_quantizer_statistics.duplicate_center_counts = (int *)calloc((size_t)num_features, sizeof(int));
-    g_quantizer_statistics.zero_width_interval_counts = (int *)calloc((size_t)num_features, sizeof(int));
-    g_quantizer_statistics.empty_bin_counts = (int *)calloc((size_t)num_features, sizeof(int));
-    g_quantizer_statistics.iteration_counts = (int *)calloc((size_t)num_features, sizeof(int));
-    g_quantizer_statistics.tree_split_counts = (int *)calloc((size_t)num_features, sizeof(int));
-    g_quantizer_statistics.fallback_threshold_counts = (int *)calloc((size_t)num_features, sizeof(int));
-    g_quantizer_statistics.initial_interval_counts = (int *)calloc((size_t)num_features, sizeof(int));
+        quantizer->state.centers = (double *)malloc(center_count * sizeof(double));
+        quantizer->stats.training_occupancy = (int *)calloc(center_count, sizeof(int));
+    }
+
+    quantizer->stats.refinement_counts = (int *)calloc((size_t)num_features, sizeof(int));
+    quantizer->stats.duplicate_center_counts = (int *)calloc((size_t)num_features, sizeof(int));
+    quantizer->stats.zero_width_interval_counts = (int *)calloc((size_t)num_features, sizeof(int));
+    quantizer->stats.empty_bin_counts = (int *)calloc((size_t)num_features, sizeof(int));
+    quantizer->stats.iteration_counts = (int *)calloc((size_t)num_features, sizeof(int));
+    quantizer->stats.tree_split_counts = (int *)calloc((size_t)num_features, sizeof(int));
+    quantizer->stats.fallback_threshold_counts = (int *)calloc((size_t)num_features, sizeof(int));
+    quantizer->stats.initial_interval_counts = (int *)calloc((size_t)num_features, sizeof(int));
 #if BINNING_MODE == GA_REFINED_BINNING
     if (boundary_count > 0) {
-        g_quantizer_state.ga_refined_flip_counts = (uint16_t *)calloc(boundary_count, sizeof(uint16_t));
-        g_quantizer_state.ga_refined_transition_weights = (double *)malloc(boundary_count * sizeof(double));
+        quantizer->state.ga_refined_flip_counts = (uint16_t *)calloc(boundary_count, sizeof(uint16_t));
+        quantizer->state.ga_refined_transition_weights = (double *)malloc(boundary_count * sizeof(double));
     }
 #endif
 
-    if ((boundary_count > 0 && g_quantizer_state.boundaries == NULL) ||
-        (center_count > 0 && g_quantizer_state.centers == NULL) ||
-        (center_count > 0 && g_quantizer_statistics.training_occupancy == NULL) ||
-        g_quantizer_statistics.refinement_counts == NULL ||
-        g_quantizer_statistics.duplicate_center_counts == NULL ||
-        g_quantizer_statistics.zero_width_interval_counts == NULL ||
-        g_quantizer_statistics.empty_bin_counts == NULL ||
-        g_quantizer_statistics.iteration_counts == NULL ||
-        g_quantizer_statistics.tree_split_counts == NULL ||
-        g_quantizer_statistics.fallback_threshold_counts == NULL ||
-        g_quantizer_statistics.initial_interval_counts == NULL
+    if ((boundary_count > 0 && quantizer->state.boundaries == NULL) ||
+        (center_count > 0 && quantizer->state.centers == NULL) ||
+        (center_count > 0 && quantizer->stats.training_occupancy == NULL) ||
+        quantizer->stats.refinement_counts == NULL ||
+        quantizer->stats.duplicate_center_counts == NULL ||
+        quantizer->stats.zero_width_interval_counts == NULL ||
+        quantizer->stats.empty_bin_counts == NULL ||
+        quantizer->stats.iteration_counts == NULL ||
+        quantizer->stats.tree_split_counts == NULL ||
+        quantizer->stats.fallback_threshold_counts == NULL ||
+        quantizer->stats.initial_interval_counts == NULL
 #if BINNING_MODE == GA_REFINED_BINNING
-        || (boundary_count > 0 && g_quantizer_state.ga_refined_flip_counts == NULL)
-        || (boundary_count > 0 && g_quantizer_state.ga_refined_transition_weights == NULL)
+        || (boundary_count > 0 && quantizer->state.ga_refined_flip_counts == NULL)
+        || (boundary_count > 0 && quantizer->state.ga_refined_transition_weights == NULL)
 #endif
         ) {
         fprintf(stderr, "quantizer: failed to allocate state buffers.\n");
@@ -223,14 +250,14 @@ static int allocate_quantizer_state(int num_features, int num_levels) {
     }
 
     if (boundary_count > 0) {
-        fill_with_nan(g_quantizer_state.boundaries, boundary_count);
+        fill_with_nan(quantizer->state.boundaries, boundary_count);
     }
     if (center_count > 0) {
-        fill_with_nan(g_quantizer_state.centers, center_count);
+        fill_with_nan(quantizer->state.centers, center_count);
     }
 #if BINNING_MODE == GA_REFINED_BINNING
     if (boundary_count > 0) {
-        fill_with_nan(g_quantizer_state.ga_refined_transition_weights, boundary_count);
+        fill_with_nan(quantizer->state.ga_refined_transition_weights, boundary_count);
     }
 #endif
 
@@ -244,6 +271,8 @@ static const char *quantizer_mode_name(void) {
     return "quantile";
 #elif BINNING_MODE == KMEANS_1D_BINNING
     return "kmeans-1d";
+#elif BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING
+    return "kmeans-1d-optimal";
 #elif BINNING_MODE == DECISION_TREE_1D_BINNING
     return "decision-tree-1d";
 #elif BINNING_MODE == CHIMERGE_BINNING
@@ -256,90 +285,209 @@ static const char *quantizer_mode_name(void) {
 }
 
 #if BINNING_MODE == QUANTILE_BINNING
-static int fit_quantile_feature(int feature_idx, const double *sorted_values, int sample_count);
+static int fit_quantile_feature(struct quantizer *quantizer, int feature_idx, const double *sorted_values, int sample_count);
 #endif
-#if BINNING_MODE == KMEANS_1D_BINNING
-static int fit_kmeans_feature(int feature_idx, const double *sorted_values, int sample_count);
-static void print_kmeans_diagnostics(void);
+#if BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING
+static int fit_kmeans_feature(struct quantizer *quantizer, int feature_idx, const double *sorted_values, int sample_count);
+static void print_kmeans_diagnostics(struct quantizer *quantizer);
 #endif
 #if BINNING_MODE == DECISION_TREE_1D_BINNING
-static int fit_decision_tree_feature(int feature_idx,
+static int fit_decision_tree_feature(struct quantizer *quantizer,
+                                     int feature_idx,
                                      const feature_sample_t *sorted_samples,
                                      int sample_count);
-static void print_decision_tree_diagnostics(void);
+static void print_decision_tree_diagnostics(struct quantizer *quantizer);
 #endif
 #if BINNING_MODE == CHIMERGE_BINNING
-static int fit_chimerge_feature(int feature_idx,
+static int fit_chimerge_feature(struct quantizer *quantizer,
+                                int feature_idx,
                                 const feature_sample_t *sorted_samples,
                                 int sample_count);
-static void print_chimerge_diagnostics(void);
+static void print_chimerge_diagnostics(struct quantizer *quantizer);
 #endif
 #if BINNING_MODE == GA_REFINED_BINNING
-static void print_ga_refined_diagnostics(void);
+static void print_ga_refined_diagnostics(struct quantizer *quantizer);
 #endif
-#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING || BINNING_MODE == GA_REFINED_BINNING
-static void compute_training_occupancy(double **training_data, int training_samples);
+#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING || BINNING_MODE == GA_REFINED_BINNING
+static void compute_training_occupancy(struct quantizer *quantizer, double **training_data, int training_samples);
+#endif
+
+#if BINNING_MODE == UNIFORM_BINNING || BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING || BINNING_MODE == GA_REFINED_BINNING
+/**
+ * @brief Maps one value to its level without any validation.
+ *
+ * The level is the number of cuts strictly below @p x (NaN maps to level 0).
+ * UNIFORM_BINNING estimates it with one multiply/floor on the evenly spaced
+ * cuts and corrects the estimate against the installed cuts, so the result is
+ * exactly that of the cut search. The other modes run a branchless lower-bound
+ * search whose comparisons compile to conditional moves. The cut layout is
+ * validated by check_level_lookup() whenever cuts are installed.
+ */
+static inline int lookup_level(struct quantizer *quantizer, int feature_idx, double x) {
+    int cut_count = quantizer->state.num_levels - 1;
+    if (cut_count <= 0) {
+        return 0;
+    }
+    const double *boundaries = &quantizer->state.boundaries[feature_idx * cut_count];
+
+#if BINNING_MODE == UNIFORM_BINNING
+    double scaled = (x + 1.0) * 0.5 * (double)cut_count + 0.5;
+    int level = 0;
+    if (scaled >= (double)cut_count) {
+        level = cut_count;
+    } else if (scaled > 0.0) {
+        level = (int)scaled;
+    }
+    while (level > 0 && !(x > boundaries[level - 1])) {
+        level--;
+    }
+    while (level < cut_count && x > boundaries[level]) {
+        level++;
+    }
+    return level;
+#else
+    const double *base = boundaries;
+    int length = cut_count;
+    while (length > 1) {
+        int half = length / 2;
+        base += (base[half - 1] < x) ? half : 0;
+        length -= half;
+    }
+    return (int)(base - boundaries) + (*base < x);
 #endif
+}
 
-#if BINNING_MODE == UNIFORM_BINNING || BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING || BINNING_MODE == GA_REFINED_BINNING
-static int map_value_with_boundaries_unchecked(int feature_idx, double x) {
-    if (g_quantizer_state.num_levels <= 1) {
+/**
+ * @brief Validates the installed cuts once so lookups can skip all checks.
+ *
+ * @return 0 if every feature has non-decreasing, non-NaN cuts, -1 otherwise.
+ */
+static int check_level_lookup(struct quantizer *quantizer) {
+    int cut_count = quantizer->state.num_levels - 1;
+    if (cut_count <= 0) {
         return 0;
     }
-    if (g_quantizer_state.boundaries == NULL) {
+    if (quantizer->state.boundaries == NULL) {
         fprintf(stderr, "quantizer: boundaries requested before allocation.\n");
-        exit(EXIT_FAILURE);
+        return -1;
     }
+    for (int feature = 0; feature < quantizer->state.num_features; feature++) {
+        const double *boundaries = &quantizer->state.boundaries[feature * cut_count];
+        for (int cut = 0; cut < cut_count; cut++) {
+            if (isnan(boundaries[cut]) || (cut > 0 && boundaries[cut] < boundaries[cut - 1])) {
+                fprintf(stderr, "quantizer: feature %d has unordered cut %d.\n", feature, cut);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
 
-    int cut_count = g_quantizer_state.num_levels - 1;
-    const double *boundaries = &g_quantizer_state.boundaries[feature_idx * cut_count];
+/**
+ * @brief Smallest int16 code whose input value lies above @p cut.
+ *
+ * Code c stands for the value `c / QUANTIZER_I16_FULL_SCALE`. The result is
+ * clamped to [INT16_MIN, INT16_MAX + 1]; INT16_MAX + 1 means no code exceeds
+ * the cut. Comparing codes against it gives the level the double lookup gives
+ * the converted value, because both count the cuts strictly below the value.
+ */
+static int32_t code_threshold_i16(double cut) {
+    const double scale = (double)QUANTIZER_I16_FULL_SCALE;
+    double bound = floor(cut * scale) + 1.0;
+    if (!(bound > (double)INT16_MIN)) {
+        return INT16_MIN;
+    }
+    if (bound > (double)INT16_MAX + 1.0) {
+        return (int32_t)INT16_MAX + 1;
+    }
+    int32_t code = (int32_t)bound;
+    while (code > INT16_MIN && (double)(code - 1) / scale > cut) {
+        code--;
+    }
+    while (code <= INT16_MAX && !((double)code / scale > cut)) {
+        code++;
+    }
+    return code;
+}
 
-    if (isnan(x) || x <= boundaries[0]) {
+/**
+ * @brief Validates the installed cuts and derives the integer thresholds of the int16 path.
+ *
+ * Runs whenever cuts are installed (fit, refinement, load, wrap), so
+ * quantizer_quantize_sample_i16() always matches the double cuts.
+ *
+ * @return 0 on success, -1 if the cuts are invalid or the thresholds cannot be allocated.
+ */
+static int install_level_lookup(struct quantizer *quantizer) {
+    if (check_level_lookup(quantizer) != 0) {
+        return -1;
+    }
+    free(quantizer->state.thresholds_i16);
+    quantizer->state.thresholds_i16 = NULL;
+    size_t cut_total = boundary_count_total_for(quantizer->state.num_features, quantizer->state.num_levels);
+    if (cut_total == 0) {
         return 0;
     }
-    if (x > boundaries[cut_count - 1]) {
-        return g_quantizer_state.num_levels - 1;
+    quantizer->state.thresholds_i16 = (int32_t *)malloc(cut_total * sizeof(int32_t));
+    if (quantizer->state.thresholds_i16 == NULL) {
+        fprintf(stderr, "quantizer: failed to allocate int16 thresholds.\n");
+        return -1;
+    }
+    for (size_t cut = 0; cut < cut_total; cut++) {
+        quantizer->state.thresholds_i16[cut] = code_threshold_i16(quantizer->state.boundaries[cut]);
     }
+    return 0;
+}
 
-    int lo = 0;
-    int hi = cut_count - 1;
-    while (lo < hi) {
-        int mid = lo + (hi - lo) / 2;
-        if (x <= boundaries[mid]) {
-            hi = mid;
-        } else {
-            lo = mid + 1;
-        }
+/**
+ * @brief Integer counterpart of lookup_level() for an int16 code.
+ *
+ * The thresholds are non-decreasing like the cuts, so the same branchless
+ * lower-bound search counts the thresholds at or below the code.
+ */
+static inline int lookup_level_i16(const struct quantizer *quantizer, int feature_idx, int16_t code) {
+    int cut_count = quantizer->state.num_levels - 1;
+    if (cut_count <= 0) {
+        return 0;
     }
-    return lo;
+    const int32_t *thresholds = &quantizer->state.thresholds_i16[feature_idx * cut_count];
+    const int32_t *base = thresholds;
+    int32_t x = code;
+    int length = cut_count;
+    while (length > 1) {
+        int half = length / 2;
+        base += (base[half - 1] <= x) ? half : 0;
+        length -= half;
+    }
+    return (int)(base - thresholds) + (*base <= x);
 }
 
-static int map_value_with_boundaries_checked(int feature_idx, double x) {
-    if (!g_quantizer_state.fitted) {
+static int map_value_with_boundaries_checked(struct quantizer *quantizer, int feature_idx, double x) {
+    if (!quantizer->state.fitted) {
         fprintf(stderr, "quantizer: map called before fit.\n");
         exit(EXIT_FAILURE);
     }
-    if (feature_idx < 0 || feature_idx >= g_quantizer_state.num_features) {
-        fprintf(stderr, "quantizer: feature index %d out of range [0,%d).\n", feature_idx, g_quantizer_state.num_features);
+    if (feature_idx < 0 || feature_idx >= quantizer->state.num_features) {
+        fprintf(stderr, "quantizer: feature index %d out of range [0,%d).\n", feature_idx, quantizer->state.num_features);
         exit(EXIT_FAILURE);
     }
-    return map_value_with_boundaries_unchecked(feature_idx, x);
+    return lookup_level(quantizer, feature_idx, x);
 }
 #endif
 
 #if BINNING_MODE == UNIFORM_BINNING || BINNING_MODE == GA_REFINED_BINNING
-static int install_uniform_boundaries(void) {
-    int cut_count = g_quantizer_state.num_levels - 1;
-    if (cut_count <= 0 || g_quantizer_state.boundaries == NULL) {
+static int install_uniform_boundaries(struct quantizer *quantizer) {
+    int cut_count = quantizer->state.num_levels - 1;
+    if (cut_count <= 0 || quantizer->state.boundaries == NULL) {
         return 0;
     }
 
-    for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
+    for (int feature = 0; feature < quantizer->state.num_features; feature++) {
         for (int level = 0; level < cut_count; level++) {
             long long numerator = 20000LL * (long long)(level + 1) - 10000LL;
             long long threshold_scaled = (numerator + (long long)cut_count - 1LL) / (long long)cut_count;
             double boundary = ((double)(threshold_scaled - 1LL) - 10000.0) / 10000.0;
-            g_quantizer_state.boundaries[boundary_index(feature, level)] = boundary;
+            quantizer->state.boundaries[boundary_index(quantizer, feature, level)] = boundary;
         }
     }
     return 0;
@@ -347,25 +495,25 @@ static int install_uniform_boundaries(void) {
 #endif
 
 #if BINNING_MODE == GA_REFINED_BINNING
-static void reset_ga_refined_feature_stats(void) {
-    memset(g_quantizer_statistics.refinement_counts, 0, (size_t)g_quantizer_state.num_features * sizeof(int));
-    memset(g_quantizer_statistics.duplicate_center_counts, 0, (size_t)g_quantizer_state.num_features * sizeof(int));
-    memset(g_quantizer_statistics.zero_width_interval_counts, 0, (size_t)g_quantizer_state.num_features * sizeof(int));
-    memset(g_quantizer_statistics.empty_bin_counts, 0, (size_t)g_quantizer_state.num_features * sizeof(int));
-    memset(g_quantizer_statistics.iteration_counts, 0, (size_t)g_quantizer_state.num_features * sizeof(int));
-    memset(g_quantizer_statistics.tree_split_counts, 0, (size_t)g_quantizer_state.num_features * sizeof(int));
-    memset(g_quantizer_statistics.fallback_threshold_counts, 0, (size_t)g_quantizer_state.num_features * sizeof(int));
-    memset(g_quantizer_statistics.initial_interval_counts, 0, (size_t)g_quantizer_state.num_features * sizeof(int));
-    g_quantizer_statistics.total_refinements = 0;
-    g_quantizer_statistics.total_duplicate_centers = 0;
-    g_quantizer_statistics.total_zero_width_intervals = 0;
-    g_quantizer_statistics.total_empty_bins = 0;
-    g_quantizer_statistics.total_tree_splits = 0;
-    g_quantizer_statistics.total_fallback_thresholds = 0;
-}
-
-static int fit_ga_refined_feature(int feature_idx, const uint16_t *flip_counts) {
-    int transitions = g_quantizer_state.num_levels - 1;
+static void reset_ga_refined_feature_stats(struct quantizer *quantizer) {
+    memset(quantizer->stats.refinement_counts, 0, (size_t)quantizer->state.num_features * sizeof(int));
+    memset(quantizer->stats.duplicate_center_counts, 0, (size_t)quantizer->state.num_features * sizeof(int));
+    memset(quantizer->stats.zero_width_interval_counts, 0, (size_t)quantizer->state.num_features * sizeof(int));
+    memset(quantizer->stats.empty_bin_counts, 0, (size_t)quantizer->state.num_features * sizeof(int));
+    memset(quantizer->stats.iteration_counts, 0, (size_t)quantizer->state.num_features * sizeof(int));
+    memset(quantizer->stats.tree_split_counts, 0, (size_t)quantizer->state.num_features * sizeof(int));
+    memset(quantizer->stats.fallback_threshold_counts, 0, (size_t)quantizer->state.num_features * sizeof(int));
+    memset(quantizer->stats.initial_interval_counts, 0, (size_t)quantizer->state.num_features * sizeof(int));
+    quantizer->stats.total_refinements = 0;
+    quantizer->stats.total_duplicate_centers = 0;
+    quantizer->stats.total_zero_width_intervals = 0;
+    quantizer->stats.total_empty_bins = 0;
+    quantizer->stats.total_tree_splits = 0;
+    quantizer->stats.total_fallback_thresholds = 0;
+}
+
+static int fit_ga_refined_feature(struct quantizer *quantizer, int feature_idx, const uint16_t *flip_counts) {
+    int transitions = quantizer->state.num_levels - 1;
     if (transitions <= 0) {
         return 0;
     }
@@ -376,23 +524,23 @@ static int fit_ga_refined_feature(int feature_idx, const uint16_t *flip_counts)
         if (!isfinite(weight) || weight <= 0.0) {
             weight = 1.0;
         }
-        g_quantizer_state.ga_refined_transition_weights[boundary_index(feature_idx, level)] = weight;
+        quantizer->state.ga_refined_transition_weights[boundary_index(quantizer, feature_idx, level)] = weight;
         sum_weights += weight;
-        g_quantizer_state.ga_refined_flip_counts[boundary_index(feature_idx, level)] = flip_counts[level];
+        quantizer->state.ga_refined_flip_counts[boundary_index(quantizer, feature_idx, level)] = flip_counts[level];
     }
     if (sum_weights <= 0.0) {
         sum_weights = (double)transitions;
         for (int level = 0; level < transitions; level++) {
-            g_quantizer_state.ga_refined_transition_weights[boundary_index(feature_idx, level)] = 1.0 / (double)transitions;
+            quantizer->state.ga_refined_transition_weights[boundary_index(quantizer, feature_idx, level)] = 1.0 / (double)transitions;
         }
     } else {
         for (int level = 0; level < transitions; level++) {
-            g_quantizer_state.ga_refined_transition_weights[boundary_index(feature_idx, level)] /= sum_weights;
+            quantizer->state.ga_refined_transition_weights[boundary_index(quantizer, feature_idx, level)] /= sum_weights;
         }
     }
 
-    double *bin_importance = (double *)malloc((size_t)g_quantizer_state.num_levels * sizeof(double));
-    double *bin_widths = (double *)malloc((size_t)g_quantizer_state.num_levels * sizeof(double));
+    double *bin_importance = (double *)malloc((size_t)quantizer->state.num_levels * sizeof(double));
+    double *bin_widths = (double *)malloc((size_t)quantizer->state.num_levels * sizeof(double));
     if (!bin_importance || !bin_widths) {
         fprintf(stderr, "quantizer: failed to allocate GA-refined buffers.\n");
         free(bin_importance);
@@ -400,17 +548,17 @@ static int fit_ga_refined_feature(int feature_idx, const uint16_t *flip_counts)
         return -1;
     }
 
-    bin_importance[0] = g_quantizer_state.ga_refined_transition_weights[boundary_index(feature_idx, 0)];
-    bin_importance[g_quantizer_state.num_levels - 1] =
-        g_quantizer_state.ga_refined_transition_weights[boundary_index(feature_idx, transitions - 1)];
-    for (int level = 1; level < g_quantizer_state.num_levels - 1; level++) {
-        double left = g_quantizer_state.ga_refined_transition_weights[boundary_index(feature_idx, level - 1)];
-        double right = g_quantizer_state.ga_refined_transition_weights[boundary_index(feature_idx, level)];
+    bin_importance[0] = quantizer->state.ga_refined_transition_weights[boundary_index(quantizer, feature_idx, 0)];
+    bin_importance[quantizer->state.num_levels - 1] =
+        quantizer->state.ga_refined_transition_weights[boundary_index(quantizer, feature_idx, transitions - 1)];
+    for (int level = 1; level < quantizer->state.num_levels - 1; level++) {
+        double left = quantizer->state.ga_refined_transition_weights[boundary_index(quantizer, feature_idx, level - 1)];
+        double right = quantizer->state.ga_refined_transition_weights[boundary_index(quantizer, feature_idx, level)];
         bin_importance[level] = 0.5 * (left + right);
     }
 
     double width_sum = 0.0;
-    for (int level = 0; level < g_quantizer_state.num_levels; level++) {
+    for (int level = 0; level < quantizer->state.num_levels; level++) {
         double importance = bin_importance[level];
         if (!isfinite(importance) || importance <= 0.0) {
             importance = 1.0;
@@ -439,50 +587,50 @@ static int fit_ga_refined_feature(int feature_idx, const uint16_t *flip_counts)
             boundary = nextafter(previous_boundary, INFINITY);
             refinements++;
         }
-        g_quantizer_state.boundaries[boundary_index(feature_idx, level)] = boundary;
+        quantizer->state.boundaries[boundary_index(quantizer, feature_idx, level)] = boundary;
         previous_boundary = boundary;
     }
 
-    g_quantizer_statistics.refinement_counts[feature_idx] = refinements;
-    g_quantizer_statistics.zero_width_interval_counts[feature_idx] = zero_width_intervals;
-    g_quantizer_statistics.total_refinements += refinements;
-    g_quantizer_statistics.total_zero_width_intervals += zero_width_intervals;
+    quantizer->stats.refinement_counts[feature_idx] = refinements;
+    quantizer->stats.zero_width_interval_counts[feature_idx] = zero_width_intervals;
+    quantizer->stats.total_refinements += refinements;
+    quantizer->stats.total_zero_width_intervals += zero_width_intervals;
 
     free(bin_widths);
     free(bin_importance);
     return 0;
 }
 
-static void print_ga_refined_diagnostics(void) {
+static void print_ga_refined_diagnostics(struct quantizer *quantizer) {
     if (output_mode >= OUTPUT_DETAILED) {
-        for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
+        for (int feature = 0; feature < quantizer->state.num_features; feature++) {
             fprintf(stdout,
                     "quantizer: ga-refined feature %d: refinements=%d, empty_bins=%d, zero_width_intervals=%d\n",
                     feature,
-                    g_quantizer_statistics.refinement_counts[feature],
-                    g_quantizer_statistics.empty_bin_counts[feature],
-                    g_quantizer_statistics.zero_width_interval_counts[feature]);
+                    quantizer->stats.refinement_counts[feature],
+                    quantizer->stats.empty_bin_counts[feature],
+                    quantizer->stats.zero_width_interval_counts[feature]);
         }
     }
 
     if (output_mode >= OUTPUT_DEBUG) {
-        int transitions = g_quantizer_state.num_levels - 1;
-        for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
+        int transitions = quantizer->state.num_levels - 1;
+        for (int feature = 0; feature < quantizer->state.num_features; feature++) {
             fprintf(stdout, "quantizer: feature %d flip-counts:", feature);
             for (int level = 0; level < transitions; level++) {
-                fprintf(stdout, " %u", (unsigned)g_quantizer_state.ga_refined_flip_counts[boundary_index(feature, level)]);
+                fprintf(stdout, " %u", (unsigned)quantizer->state.ga_refined_flip_counts[boundary_index(quantizer, feature, level)]);
             }
             fprintf(stdout, "\n");
 
             fprintf(stdout, "quantizer: feature %d transition weights:", feature);
             for (int level = 0; level < transitions; level++) {
-                fprintf(stdout, " %.17g", g_quantizer_state.ga_refined_transition_weights[boundary_index(feature, level)]);
+                fprintf(stdout, " %.17g", quantizer->state.ga_refined_transition_weights[boundary_index(quantizer, feature, level)]);
             }
             fprintf(stdout, "\n");
 
             fprintf(stdout, "quantizer: feature %d boundaries:", feature);
             for (int level = 0; level < transitions; level++) {
-                fprintf(stdout, " %.17g", g_quantizer_state.boundaries[boundary_index(feature, level)]);
+                fprintf(stdout, " %.17g", quantizer->state.boundaries[boundary_index(quantizer, feature, level)]);
             }
             fprintf(stdout, "\n");
         }
@@ -491,32 +639,31 @@ static void print_ga_refined_diagnostics(void) {
 #endif
 
 #if BINNING_MODE == QUANTILE_BINNING
-static int fit_quantile_feature(int feature_idx, const double *sorted_values, int sample_count) {
-    if (g_quantizer_state.num_levels <= 1) {
-        g_quantizer_statistics.iteration_counts[feature_idx] = 1;
+static int fit_quantile_feature(struct quantizer *quantizer, int feature_idx, const double *sorted_values, int sample_count) {
+    if (quantizer->state.num_levels <= 1) {
+        quantizer->stats.iteration_counts[feature_idx] = 1;
         return 0;
     }
 
-    int cut_count = g_quantizer_state.num_levels - 1;
-    for (int k = 1; k < g_quantizer_state.num_levels; k++) {
-        double q = (double)k / (double)g_quantizer_state.num_levels;
-        g_quantizer_state.boundaries[boundary_index(feature_idx, k - 1)] =
+    int cut_count = quantizer->state.num_levels - 1;
+    for (int k = 1; k < quantizer->state.num_levels; k++) {
+        double q = (double)k / (double)quantizer->state.num_levels;
+        quantizer->state.boundaries[boundary_index(quantizer, feature_idx, k - 1)] =
             interpolate_sorted_value(sorted_values, sample_count, q);
     }
 
     int refinements = 0;
     for (int k = 1; k < cut_count; k++) {
-        int prev_idx = boundary_index(feature_idx, k - 1);
-        int curr_idx = boundary_index(feature_idx, k);
-        if (g_quantizer_state.boundaries[curr_idx] <= g_quantizer_state.boundaries[prev_idx]) {
-            g_quantizer_state.boundaries[curr_idx] = nextafter(g_quantizer_state.boundaries[prev_idx], INFINITY);
+        int prev_idx = boundary_index(quantizer, feature_idx, k - 1);
+        int curr_idx = boundary_index(quantizer, feature_idx, k);
+        if (quantizer->state.boundaries[curr_idx] <= quantizer->state.boundaries[prev_idx]) {
+            quantizer->state.boundaries[curr_idx] = nextafter(quantizer->state.boundaries[prev_idx], INFINITY);
             refinements++;
         }
     }
 
-    g_quantizer_statistics.refinement_counts[feature_idx] = refinements;
-    g_quantizer_statistics.total_refinements += refinements;
-    g_quantizer_statistics.iteration_counts[feature_idx] = 1;
+    quantizer->stats.refinement_counts[feature_idx] = refinements;
+    quantizer->stats.iteration_counts[feature_idx] = 1;
 
     if (refinements > 0 && output_mode >= OUTPUT_BASIC) {
         fprintf(stderr,
@@ -575,34 +722,36 @@ static int select_repair_sample(const double *errors,
 
     return 0;
 }
+#endif
 
-static void analyze_kmeans_feature(int feature_idx) {
+#if BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING
+static void analyze_kmeans_feature(struct quantizer *quantizer, int feature_idx) {
     int duplicate_count = 0;
     int zero_width_count = 0;
 
-    for (int i = 0; i < g_quantizer_state.num_levels - 1; i++) {
-        double left = g_quantizer_state.centers[center_index(feature_idx, i)];
-        double right = g_quantizer_state.centers[center_index(feature_idx, i + 1)];
+    for (int i = 0; i < quantizer->state.num_levels - 1; i++) {
+        double left = quantizer->state.centers[center_index(quantizer, feature_idx, i)];
+        double right = quantizer->state.centers[center_index(quantizer, feature_idx, i + 1)];
         if (fabs(right - left) <= KMEANS_1D_TOLERANCE) {
             duplicate_count++;
         }
     }
 
-    for (int i = 1; i < g_quantizer_state.num_levels - 1; i++) {
-        double left = g_quantizer_state.boundaries[boundary_index(feature_idx, i - 1)];
-        double right = g_quantizer_state.boundaries[boundary_index(feature_idx, i)];
+    for (int i = 1; i < quantizer->state.num_levels - 1; i++) {
+        double left = quantizer->state.boundaries[boundary_index(quantizer, feature_idx, i - 1)];
+        double right = quantizer->state.boundaries[boundary_index(quantizer, feature_idx, i)];
         if (fabs(right - left) <= KMEANS_1D_TOLERANCE) {
             zero_width_count++;
         }
     }
 
-    g_quantizer_statistics.duplicate_center_counts[feature_idx] = duplicate_count;
-    g_quantizer_statistics.zero_width_interval_counts[feature_idx] = zero_width_count;
-    g_quantizer_statistics.total_duplicate_centers += duplicate_count;
-    g_quantizer_statistics.total_zero_width_intervals += zero_width_count;
+    quantizer->stats.duplicate_center_counts[feature_idx] = duplicate_count;
+    quantizer->stats.zero_width_interval_counts[feature_idx] = zero_width_count;
 }
+#endif
 
-static int fit_kmeans_feature(int feature_idx, const double *sorted_values, int sample_count) {
+#if BINNING_MODE == KMEANS_1D_BINNING
+static int fit_kmeans_feature(struct quantizer *quantizer, int feature_idx, const double *sorted_values, int sample_count) {
     double *working_centers = NULL;
     double *next_centers = NULL;
     double *sums = NULL;
@@ -611,22 +760,22 @@ static int fit_kmeans_feature(int feature_idx, const double *sorted_values, int
     unsigned char *claimed = NULL;
     int iterations_used = 0;
 
-    if (g_quantizer_state.num_levels <= 1) {
+    if (quantizer->state.num_levels <= 1) {
         double mean = 0.0;
         for (int i = 0; i < sample_count; i++) {
             mean += sorted_values[i];
         }
         mean /= (double)sample_count;
-        g_quantizer_state.centers[center_index(feature_idx, 0)] = mean;
-        g_quantizer_statistics.iteration_counts[feature_idx] = 1;
+        quantizer->state.centers[center_index(quantizer, feature_idx, 0)] = mean;
+        quantizer->stats.iteration_counts[feature_idx] = 1;
         return 0;
     }
 
-    working_centers = (double *)malloc((size_t)g_quantizer_state.num_levels * sizeof(double));
-    next_centers = (double *)malloc((size_t)g_quantizer_state.num_levels * sizeof(double));
-    sums = (double *)malloc((size_t)g_quantizer_state.num_levels * sizeof(double));
+    working_centers = (double *)malloc((size_t)quantizer->state.num_levels * sizeof(double));
+    next_centers = (double *)malloc((size_t)quantizer->state.num_levels * sizeof(double));
+    sums = (double *)malloc((size_t)quantizer->state.num_levels * sizeof(double));
     errors = (double *)malloc((size_t)sample_count * sizeof(double));
-    counts = (int *)malloc((size_t)g_quantizer_state.num_levels * sizeof(int));
+    counts = (int *)malloc((size_t)quantizer->state.num_levels * sizeof(int));
     claimed = (unsigned char *)malloc((size_t)sample_count * sizeof(unsigned char));
 
     if (!working_centers || !next_centers || !sums || !errors || !counts || !claimed) {
@@ -640,17 +789,17 @@ static int fit_kmeans_feature(int feature_idx, const double *sorted_values, int
         return -1;
     }
 
-    for (int i = 0; i < g_quantizer_state.num_levels; i++) {
-        double q = ((double)i + 0.5) / (double)g_quantizer_state.num_levels;
+    for (int i = 0; i < quantizer->state.num_levels; i++) {
+        double q = ((double)i + 0.5) / (double)quantizer->state.num_levels;
         working_centers[i] = interpolate_sorted_value(sorted_values, sample_count, q);
     }
 
     for (int iter = 0; iter < KMEANS_1D_MAX_ITERATIONS; iter++) {
-        memset(counts, 0, (size_t)g_quantizer_state.num_levels * sizeof(int));
-        memset(sums, 0, (size_t)g_quantizer_state.num_levels * sizeof(double));
+        memset(counts, 0, (size_t)quantizer->state.num_levels * sizeof(int));
+        memset(sums, 0, (size_t)quantizer->state.num_levels * sizeof(double));
 
         for (int i = 0; i < sample_count; i++) {
-            int cluster_idx = nearest_center_index(working_centers, g_quantizer_state.num_levels, sorted_values[i]);
+            int cluster_idx = nearest_center_index(working_centers, quantizer->state.num_levels, sorted_values[i]);
             double delta = sorted_values[i] - working_centers[cluster_idx];
             counts[cluster_idx] += 1;
             sums[cluster_idx] += sorted_values[i];
@@ -661,7 +810,7 @@ static int fit_kmeans_feature(int feature_idx, const double *sorted_values, int
         int had_empty_cluster = 0;
         double max_shift = 0.0;
 
-        for (int cluster = 0; cluster < g_quantizer_state.num_levels; cluster++) {
+        for (int cluster = 0; cluster < quantizer->state.num_levels; cluster++) {
             if (counts[cluster] > 0) {
                 next_centers[cluster] = sums[cluster] / (double)counts[cluster];
             } else {
@@ -677,7 +826,7 @@ static int fit_kmeans_feature(int feature_idx, const double *sorted_values, int
             }
         }
 
-        for (int cluster = 0; cluster < g_quantizer_state.num_levels; cluster++) {
+        for (int cluster = 0; cluster < quantizer->state.num_levels; cluster++) {
             working_centers[cluster] = next_centers[cluster];
         }
 
@@ -687,18 +836,18 @@ static int fit_kmeans_feature(int feature_idx, const double *sorted_values, int
         }
     }
 
-    qsort(working_centers, (size_t)g_quantizer_state.num_levels, sizeof(double), compare_doubles);
-    for (int i = 0; i < g_quantizer_state.num_levels; i++) {
-        g_quantizer_state.centers[center_index(feature_idx, i)] = working_centers[i];
+    qsort(working_centers, (size_t)quantizer->state.num_levels, sizeof(double), compare_doubles);
+    for (int i = 0; i < quantizer->state.num_levels; i++) {
+        quantizer->state.centers[center_index(quantizer, feature_idx, i)] = working_centers[i];
     }
-    for (int i = 0; i < g_quantizer_state.num_levels - 1; i++) {
-        double left = g_quantizer_state.centers[center_index(feature_idx, i)];
-        double right = g_quantizer_state.centers[center_index(feature_idx, i + 1)];
-        g_quantizer_state.boundaries[boundary_index(feature_idx, i)] = 0.5 * (left + right);
+    for (int i = 0; i < quantizer->state.num_levels - 1; i++) {
+        double left = quantizer->state.centers[center_index(quantizer, feature_idx, i)];
+        double right = quantizer->state.centers[center_index(quantizer, feature_idx, i + 1)];
+        quantizer->state.boundaries[boundary_index(quantizer, feature_idx, i)] = 0.5 * (left + right);
     }
 
-    g_quantizer_statistics.iteration_counts[feature_idx] = iterations_used;
-    analyze_kmeans_feature(feature_idx);
+    quantizer->stats.iteration_counts[feature_idx] = iterations_used;
+    analyze_kmeans_feature(quantizer, feature_idx);
 
     free(working_centers);
     free(next_centers);
@@ -709,26 +858,229 @@ static int fit_kmeans_feature(int feature_idx, const double *sorted_values, int
     return 0;
 }
 #endif
-#if BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING
-static int compare_feature_samples(const void *a, const void *b) {
-    const feature_sample_t *sa = (const feature_sample_t *)a;
-    const feature_sample_t *sb = (const feature_sample_t *)b;
-    if (sa->value < sb->value) {
-        return -1;
+
+#if BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING
+/**
+ * @brief Weighted prefix sums over the distinct values of one sorted feature.
+ *
+ * Entry `i` holds the sums over the first `i` distinct values; values are
+ * shifted by the median before squaring to keep the sums well conditioned.
+ */
+typedef struct {
+    double *weight;
+    double *value;
+    double *square;
+} kmeans_prefix_t;
+
+/**
+ * @brief Sum of squared deviations from the mean of distinct values [first, last].
+ */
+static double kmeans_cluster_cost(const kmeans_prefix_t *prefix, int first, int last) {
+    double weight = prefix->weight[last + 1] - prefix->weight[first];
+    double sum = prefix->value[last + 1] - prefix->value[first];
+    double cost = (prefix->square[last + 1] - prefix->square[first]) - sum * sum / weight;
+    return cost > 0.0 ? cost : 0.0;
+}
+
+/**
+ * @brief Fills one row of the k-means DP by divide and conquer.
+ *
+ * `current[i]` becomes the optimal cost of splitting distinct values [0, i]
+ * into `cluster + 1` clusters and `split[i]` the first value of the last one.
+ * The optimal split is monotone in `i`, so the search range of every midpoint
+ * is bounded by the splits of its neighbours (O(m log m) per row).
+ */
+static void kmeans_dp_row(const kmeans_prefix_t *prefix,
+                          const double *previous,
+                          double *current,
+                          int *split,
+                          int cluster,
+                          int lo,
+                          int hi,
+                          int split_lo,
+                          int split_hi) {
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        int first = split_lo > cluster ? split_lo : cluster;
+        int last = split_hi < mid ? split_hi : mid;
+        int best_split = first;
+        double best_cost = INFINITY;
+        for (int j = first; j <= last; j++) {
+            double cost = previous[j - 1] + kmeans_cluster_cost(prefix, j, mid);
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_split = j;
+            }
+        }
+        current[mid] = best_cost;
+        split[mid] = best_split;
+
+        kmeans_dp_row(prefix, previous, current, split, cluster, lo, mid - 1, split_lo, best_split);
+        lo = mid + 1;
+        split_lo = best_split;
     }
-    if (sa->value > sb->value) {
-        return 1;
+}
+
+/**
+ * @brief Globally optimal 1D k-means (Ckmeans.1d.dp) on one sorted feature.
+ *
+ * Minimizes the within-cluster sum of squares exactly by dynamic programming
+ * over the distinct values, so the result is deterministic and needs no
+ * initialization or iteration limit. Cuts are the midpoints between adjacent
+ * centers, as in KMEANS_1D_BINNING. With fewer distinct values than levels
+ * every value gets its own cluster and the last center is repeated.
+ */
+static int fit_kmeans_feature(struct quantizer *quantizer, int feature_idx, const double *sorted_values, int sample_count) {
+    int num_levels = quantizer->state.num_levels;
+    int distinct = 0;
+    for (int i = 0; i < sample_count; i++) {
+        if (i == 0 || sorted_values[i] != sorted_values[i - 1]) {
+            distinct++;
+        }
     }
-    if (sa->label < sb->label) {
+
+    int clusters = num_levels < distinct ? num_levels : distinct;
+    double *values = (double *)malloc((size_t)distinct * sizeof(double));
+    kmeans_prefix_t prefix;
+    prefix.weight = (double *)malloc((size_t)(distinct + 1) * sizeof(double));
+    prefix.value = (double *)malloc((size_t)(distinct + 1) * sizeof(double));
+    prefix.square = (double *)malloc((size_t)(distinct + 1) * sizeof(double));
+    double *previous = (double *)malloc((size_t)distinct * sizeof(double));
+    double *current = (double *)malloc((size_t)distinct * sizeof(double));
+    int *splits = (int *)malloc((size_t)clusters * (size_t)distinct * sizeof(int));
+    if (!values || !prefix.weight || !prefix.value || !prefix.square || !previous || !current || !splits) {
+        fprintf(stderr, "quantizer: failed to allocate k-means work buffers.\n");
+        free(values);
+        free(prefix.weight);
+        free(prefix.value);
+        free(prefix.square);
+        free(previous);
+        free(current);
+        free(splits);
         return -1;
     }
-    if (sa->label > sb->label) {
-        return 1;
+
+    double shift = sorted_values[sample_count / 2];
+    prefix.weight[0] = 0.0;
+    prefix.value[0] = 0.0;
+    prefix.square[0] = 0.0;
+    int m = 0;
+    for (int i = 0; i < sample_count; i++) {
+        if (i == 0 || sorted_values[i] != sorted_values[i - 1]) {
+            values[m] = sorted_values[i];
+            prefix.weight[m + 1] = prefix.weight[m];
+            prefix.value[m + 1] = prefix.value[m];
+            prefix.square[m + 1] = prefix.square[m];
+            m++;
+        }
+        double x = sorted_values[i] - shift;
+        prefix.weight[m] += 1.0;
+        prefix.value[m] += x;
+        prefix.square[m] += x * x;
+    }
+
+    for (int i = 0; i <= distinct - clusters; i++) {
+        previous[i] = kmeans_cluster_cost(&prefix, 0, i);
+        splits[i] = 0;
+    }
+    for (int cluster = 1; cluster < clusters; cluster++) {
+        int *split = splits + (size_t)cluster * (size_t)distinct;
+        int hi = distinct - clusters + cluster;
+        if (cluster == clusters - 1) {
+            kmeans_dp_row(&prefix, previous, current, split, cluster, distinct - 1, distinct - 1, cluster, distinct - 1);
+        } else {
+            kmeans_dp_row(&prefix, previous, current, split, cluster, cluster, hi, cluster, hi);
+        }
+        double *swap = previous;
+        previous = current;
+        current = swap;
+    }
+
+    int last = distinct - 1;
+    for (int cluster = clusters - 1; cluster >= 0; cluster--) {
+        int first = splits[(size_t)cluster * (size_t)distinct + (size_t)last];
+        double weight = prefix.weight[last + 1] - prefix.weight[first];
+        double mean = shift + (prefix.value[last + 1] - prefix.value[first]) / weight;
+        if (mean < values[first]) {
+            mean = values[first];
+        } else if (mean > values[last]) {
+            mean = values[last];
+        }
+        quantizer->state.centers[center_index(quantizer, feature_idx, cluster)] = mean;
+        last = first - 1;
+    }
+    for (int i = clusters; i < num_levels; i++) {
+        quantizer->state.centers[center_index(quantizer, feature_idx, i)] =
+            quantizer->state.centers[center_index(quantizer, feature_idx, clusters - 1)];
+    }
+    for (int i = 0; i < num_levels - 1; i++) {
+        double left = quantizer->state.centers[center_index(quantizer, feature_idx, i)];
+        double right = quantizer->state.centers[center_index(quantizer, feature_idx, i + 1)];
+        quantizer->state.boundaries[boundary_index(quantizer, feature_idx, i)] = 0.5 * (left + right);
     }
+
+    quantizer->stats.iteration_counts[feature_idx] = 1;
+    analyze_kmeans_feature(quantizer, feature_idx);
+
+    free(values);
+    free(prefix.weight);
+    free(prefix.value);
+    free(prefix.square);
+    free(previous);
+    free(current);
+    free(splits);
     return 0;
 }
 #endif
 
+#if BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING
+/**
+ * @brief Pre-bins a sorted feature into a class histogram.
+ *
+ * Runs of values closer than @p eps always share a bin. With at most
+ * SUPERVISED_HISTOGRAM_BINS such runs every run gets its own bin, so the
+ * split/merge search is exact; otherwise runs are grouped into roughly
+ * equal-frequency bins and the search only considers cuts between them.
+ *
+ * @param sorted_samples Samples sorted by value.
+ * @param sample_count Number of samples.
+ * @param eps Largest gap between values of one run.
+ * @param bins Output, capacity `sample_count` (zero-initialized).
+ * @return Number of bins.
+ */
+static int build_class_histogram(const feature_sample_t *sorted_samples,
+                                 int sample_count,
+                                 double eps,
+                                 class_interval_t *bins) {
+    int runs = 0;
+    for (int i = 0; i < sample_count; i++) {
+        if (i == 0 || fabs(sorted_samples[i].value - sorted_samples[i - 1].value) > eps) {
+            runs++;
+        }
+    }
+    int max_bins = SUPERVISED_HISTOGRAM_BINS;
+    int merge_runs = max_bins > 0 && runs > max_bins;
+
+    int bin_count = 0;
+    for (int i = 0; i < sample_count; i++) {
+        double value = sorted_samples[i].value;
+        int new_run = i == 0 || fabs(value - sorted_samples[i - 1].value) > eps;
+        /* With merging, a run opens a new bin once the previous bins reach their share of the samples. */
+        if (new_run &&
+            (!merge_runs || bin_count == 0 ||
+             (double)i >= (double)bin_count * (double)sample_count / (double)max_bins)) {
+            bins[bin_count].left_value = value;
+            bin_count++;
+        }
+        class_interval_t *bin = &bins[bin_count - 1];
+        bin->right_value = value;
+        bin->counts[sorted_samples[i].label] += 1;
+        bin->sample_count += 1;
+    }
+    return bin_count;
+}
+#endif
+
 #if BINNING_MODE == DECISION_TREE_1D_BINNING
 static double gini_impurity(const int *counts, int total) {
     if (total <= 0) {
@@ -762,12 +1114,13 @@ static int contains_near_duplicate_threshold(const double *values,
     return 0;
 }
 
-static int finalize_decision_tree_boundaries(int feature_idx,
+static int finalize_decision_tree_boundaries(struct quantizer *quantizer,
+                                             int feature_idx,
                                              const double *tree_thresholds,
                                              int tree_threshold_count,
                                              const feature_sample_t *sorted_samples,
                                              int sample_count) {
-    int cut_count = g_quantizer_state.num_levels - 1;
+    int cut_count = quantizer->state.num_levels - 1;
     int fallback_count = 0;
     int refinements = 0;
     int unique_tree_count = 0;
@@ -776,10 +1129,9 @@ static int finalize_decision_tree_boundaries(int feature_idx,
     double *selected = NULL;
 
     if (cut_count <= 0) {
-        g_quantizer_statistics.tree_split_counts[feature_idx] = tree_threshold_count;
-        g_quantizer_statistics.fallback_threshold_counts[feature_idx] = 0;
-        g_quantizer_statistics.refinement_counts[feature_idx] = 0;
-        g_quantizer_statistics.total_tree_splits += tree_threshold_count;
+        quantizer->stats.tree_split_counts[feature_idx] = tree_threshold_count;
+        quantizer->stats.fallback_threshold_counts[feature_idx] = 0;
+        quantizer->stats.refinement_counts[feature_idx] = 0;
         return 0;
     }
 
@@ -801,8 +1153,8 @@ static int finalize_decision_tree_boundaries(int feature_idx,
         qsort(sorted_tree, (size_t)tree_threshold_count, sizeof(double), compare_doubles);
     }
 
-    for (int k = 1; k < g_quantizer_state.num_levels; k++) {
-        double q = (double)k / (double)g_quantizer_state.num_levels;
+    for (int k = 1; k < quantizer->state.num_levels; k++) {
+        double q = (double)k / (double)quantizer->state.num_levels;
         quantile_thresholds[k - 1] = interpolate_sorted_sample_value(sorted_samples, sample_count, q);
     }
 
@@ -850,15 +1202,12 @@ static int finalize_decision_tree_boundaries(int feature_idx,
     }
 
     for (int i = 0; i < cut_count; i++) {
-        g_quantizer_state.boundaries[boundary_index(feature_idx, i)] = selected[i];
+        quantizer->state.boundaries[boundary_index(quantizer, feature_idx, i)] = selected[i];
     }
 
-    g_quantizer_statistics.tree_split_counts[feature_idx] = tree_threshold_count;
-    g_quantizer_statistics.fallback_threshold_counts[feature_idx] = fallback_count;
-    g_quantizer_statistics.refinement_counts[feature_idx] = refinements;
-    g_quantizer_statistics.total_tree_splits += tree_threshold_count;
-    g_quantizer_statistics.total_fallback_thresholds += fallback_count;
-    g_quantizer_statistics.total_refinements += refinements;
+    quantizer->stats.tree_split_counts[feature_idx] = tree_threshold_count;
+    quantizer->stats.fallback_threshold_counts[feature_idx] = fallback_count;
+    quantizer->stats.refinement_counts[feature_idx] = refinements;
 
     free(sorted_tree);
     free(quantile_thresholds);
@@ -866,36 +1215,41 @@ static int finalize_decision_tree_boundaries(int feature_idx,
     return 0;
 }
 
-static int evaluate_best_tree_split(const feature_sample_t *sorted_samples,
-                                    const int *prefix_counts,
-                                    int start,
-                                    int end,
-                                    int *best_split_pos,
-                                    double *best_threshold,
-                                    double *best_gain) {
-    int leaf_size = end - start;
+/**
+ * @brief Finds the best Gini split of the leaf covering bins [start, end).
+ *
+ * @param bins Class histogram of the feature.
+ * @param prefix_counts Per-class sample counts before every bin.
+ * @param prefix_sizes Sample counts before every bin.
+ * @param leaf Leaf to split; receives the best split, if any.
+ */
+static void evaluate_best_tree_split(const class_interval_t *bins,
+                                     const int *prefix_counts,
+                                     const int *prefix_sizes,
+                                     tree_leaf_t *leaf) {
+    int start = leaf->start;
+    int end = leaf->end;
+    int leaf_size = prefix_sizes[end] - prefix_sizes[start];
+    leaf->has_split = 0;
     if (leaf_size < 2 * TREE_1D_MIN_SAMPLES_LEAF) {
-        return 0;
+        return;
     }
 
     int total_counts[NUM_CLASSES];
     get_range_class_counts(prefix_counts, start, end, total_counts);
     double parent_weighted_impurity = (double)leaf_size * gini_impurity(total_counts, leaf_size);
-    int found = 0;
     double local_best_gain = TREE_1D_THRESHOLD_EPS;
-    int local_best_pos = -1;
-    double local_best_threshold = 0.0;
-
-    for (int split_pos = start + TREE_1D_MIN_SAMPLES_LEAF;
-         split_pos <= end - TREE_1D_MIN_SAMPLES_LEAF;
-         split_pos++) {
-        if (fabs(sorted_samples[split_pos].value - sorted_samples[split_pos - 1].value) <=
-            TREE_1D_THRESHOLD_EPS) {
+
+    for (int split_pos = start + 1; split_pos < end; split_pos++) {
+        int left_size = prefix_sizes[split_pos] - prefix_sizes[start];
+        int right_size = prefix_sizes[end] - prefix_sizes[split_pos];
+        if (left_size < TREE_1D_MIN_SAMPLES_LEAF) {
             continue;
         }
+        if (right_size < TREE_1D_MIN_SAMPLES_LEAF) {
+            break;
+        }
 
-        int left_size = split_pos - start;
-        int right_size = end - split_pos;
         int left_counts[NUM_CLASSES];
         int right_counts[NUM_CLASSES];
         get_range_class_counts(prefix_counts, start, split_pos, left_counts);
@@ -908,84 +1262,78 @@ static int evaluate_best_tree_split(const feature_sample_t *sorted_samples,
 
         if (gain > local_best_gain + TREE_1D_THRESHOLD_EPS) {
             local_best_gain = gain;
-            local_best_pos = split_pos;
-            local_best_threshold =
-                0.5 * (sorted_samples[split_pos - 1].value + sorted_samples[split_pos].value);
-            found = 1;
+            leaf->split_pos = split_pos;
+            leaf->threshold = 0.5 * (bins[split_pos - 1].right_value + bins[split_pos].left_value);
+            leaf->has_split = 1;
         }
     }
-
-    if (!found) {
-        return 0;
-    }
-
-    *best_split_pos = local_best_pos;
-    *best_threshold = local_best_threshold;
-    *best_gain = local_best_gain;
-    return 1;
+    leaf->gain = local_best_gain;
 }
 
-static int fit_decision_tree_feature(int feature_idx,
+static int fit_decision_tree_feature(struct quantizer *quantizer,
+                                     int feature_idx,
                                      const feature_sample_t *sorted_samples,
                                      int sample_count) {
+    class_interval_t *bins = NULL;
     int *prefix_counts = NULL;
+    int *prefix_sizes = NULL;
     tree_leaf_t *leaves = NULL;
     double *tree_thresholds = NULL;
     int leaf_count = 1;
     int tree_threshold_count = 0;
 
-    if (g_quantizer_state.num_levels <= 1) {
-        g_quantizer_statistics.tree_split_counts[feature_idx] = 0;
-        g_quantizer_statistics.fallback_threshold_counts[feature_idx] = 0;
-        g_quantizer_statistics.refinement_counts[feature_idx] = 0;
+    if (quantizer->state.num_levels <= 1) {
+        quantizer->stats.tree_split_counts[feature_idx] = 0;
+        quantizer->stats.fallback_threshold_counts[feature_idx] = 0;
+        quantizer->stats.refinement_counts[feature_idx] = 0;
         return 0;
     }
 
-    prefix_counts = (int *)calloc((size_t)(sample_count + 1) * (size_t)NUM_CLASSES, sizeof(int));
-    leaves = (tree_leaf_t *)malloc((size_t)g_quantizer_state.num_levels * sizeof(tree_leaf_t));
-    tree_thresholds = (double *)malloc((size_t)(g_quantizer_state.num_levels - 1) * sizeof(double));
-    if (!prefix_counts || !leaves || !tree_thresholds) {
+    bins = (class_interval_t *)calloc((size_t)sample_count, sizeof(class_interval_t));
+    leaves = (tree_leaf_t *)malloc((size_t)quantizer->state.num_levels * sizeof(tree_leaf_t));
+    tree_thresholds = (double *)malloc((size_t)(quantizer->state.num_levels - 1) * sizeof(double));
+    if (!bins || !leaves || !tree_thresholds) {
         fprintf(stderr, "quantizer: failed to allocate decision-tree fit buffers.\n");
-        free(prefix_counts);
+        free(bins);
         free(leaves);
         free(tree_thresholds);
         return -1;
     }
 
-    for (int i = 0; i < sample_count; i++) {
-        memcpy(&prefix_counts[(size_t)(i + 1) * (size_t)NUM_CLASSES],
-               &prefix_counts[(size_t)i * (size_t)NUM_CLASSES],
-               (size_t)NUM_CLASSES * sizeof(int));
-        prefix_counts[(size_t)(i + 1) * (size_t)NUM_CLASSES + (size_t)sorted_samples[i].label] += 1;
+    int bin_count = build_class_histogram(sorted_samples, sample_count, TREE_1D_THRESHOLD_EPS, bins);
+    prefix_counts = (int *)calloc((size_t)(bin_count + 1) * (size_t)NUM_CLASSES, sizeof(int));
+    prefix_sizes = (int *)calloc((size_t)(bin_count + 1), sizeof(int));
+    if (!prefix_counts || !prefix_sizes) {
+        fprintf(stderr, "quantizer: failed to allocate decision-tree fit buffers.\n");
+        free(bins);
+        free(prefix_counts);
+        free(prefix_sizes);
+        free(leaves);
+        free(tree_thresholds);
+        return -1;
+    }
+    for (int bin = 0; bin < bin_count; bin++) {
+        for (int cls = 0; cls < NUM_CLASSES; cls++) {
+            prefix_counts[(size_t)(bin + 1) * (size_t)NUM_CLASSES + (size_t)cls] =
+                prefix_counts[(size_t)bin * (size_t)NUM_CLASSES + (size_t)cls] + bins[bin].counts[cls];
+        }
+        prefix_sizes[bin + 1] = prefix_sizes[bin] + bins[bin].sample_count;
     }
 
     leaves[0].start = 0;
-    leaves[0].end = sample_count;
+    leaves[0].end = bin_count;
+    evaluate_best_tree_split(bins, prefix_counts, prefix_sizes, &leaves[0]);
 
-    while (leaf_count < g_quantizer_state.num_levels) {
+    /* Every leaf caches its best split; a split only re-evaluates the two new leaves. */
+    while (leaf_count < quantizer->state.num_levels) {
         int best_leaf_idx = -1;
-        int best_split_pos = -1;
-        double best_threshold = 0.0;
         double best_gain = TREE_1D_THRESHOLD_EPS;
 
         for (int leaf_idx = 0; leaf_idx < leaf_count; leaf_idx++) {
-            int candidate_split_pos = -1;
-            double candidate_threshold = 0.0;
-            double candidate_gain = 0.0;
-
-            if (evaluate_best_tree_split(sorted_samples,
-                                         prefix_counts,
-                                         leaves[leaf_idx].start,
-                                         leaves[leaf_idx].end,
-                                         &candidate_split_pos,
-                                         &candidate_threshold,
-                                         &candidate_gain)) {
-                if (best_leaf_idx < 0 || candidate_gain > best_gain + TREE_1D_THRESHOLD_EPS) {
-                    best_leaf_idx = leaf_idx;
-                    best_split_pos = candidate_split_pos;
-                    best_threshold = candidate_threshold;
-                    best_gain = candidate_gain;
-                }
+            if (leaves[leaf_idx].has_split &&
+                (best_leaf_idx < 0 || leaves[leaf_idx].gain > best_gain + TREE_1D_THRESHOLD_EPS)) {
+                best_leaf_idx = leaf_idx;
+                best_gain = leaves[leaf_idx].gain;
             }
         }
 
@@ -994,34 +1342,33 @@ static int fit_decision_tree_feature(int feature_idx,
         }
 
         tree_leaf_t original_leaf = leaves[best_leaf_idx];
-        leaves[best_leaf_idx].start = original_leaf.start;
-        leaves[best_leaf_idx].end = best_split_pos;
-        leaves[leaf_count].start = best_split_pos;
+        leaves[best_leaf_idx].end = original_leaf.split_pos;
+        leaves[leaf_count].start = original_leaf.split_pos;
         leaves[leaf_count].end = original_leaf.end;
+        evaluate_best_tree_split(bins, prefix_counts, prefix_sizes, &leaves[best_leaf_idx]);
+        evaluate_best_tree_split(bins, prefix_counts, prefix_sizes, &leaves[leaf_count]);
         leaf_count++;
-        tree_thresholds[tree_threshold_count++] = best_threshold;
+        tree_thresholds[tree_threshold_count++] = original_leaf.threshold;
     }
 
-    if (finalize_decision_tree_boundaries(feature_idx,
-                                          tree_thresholds,
-                                          tree_threshold_count,
-                                          sorted_samples,
-                                          sample_count) != 0) {
-        free(prefix_counts);
-        free(leaves);
-        free(tree_thresholds);
-        return -1;
-    }
+    int status = finalize_decision_tree_boundaries(quantizer,
+                                                   feature_idx,
+                                                   tree_thresholds,
+                                                   tree_threshold_count,
+                                                   sorted_samples,
+                                                   sample_count);
 
+    free(bins);
     free(prefix_counts);
+    free(prefix_sizes);
     free(leaves);
     free(tree_thresholds);
-    return 0;
+    return status;
 }
 #endif
 #if BINNING_MODE == CHIMERGE_BINNING
-static double compute_chimerge_score(const chimerge_interval_t *left,
-                                     const chimerge_interval_t *right) {
+static double compute_chimerge_score(const class_interval_t *left,
+                                     const class_interval_t *right) {
     double grand_total = (double)(left->sample_count + right->sample_count);
     if (grand_total <= 0.0) {
         return 0.0;
@@ -1050,20 +1397,21 @@ static double compute_chimerge_score(const chimerge_interval_t *left,
     return score;
 }
 
-static int finalize_chimerge_boundaries(int feature_idx,
-                                        const chimerge_interval_t *intervals,
+static int finalize_chimerge_boundaries(struct quantizer *quantizer,
+                                        int feature_idx,
+                                        const class_interval_t *intervals,
                                         int interval_count,
                                         const feature_sample_t *sorted_samples,
                                         int sample_count) {
-    int cut_count = g_quantizer_state.num_levels - 1;
+    int cut_count = quantizer->state.num_levels - 1;
     int meaningful_count = (interval_count > 0) ? (interval_count - 1) : 0;
     int fallback_count = 0;
     int refinements = 0;
     double *selected = NULL;
 
     if (cut_count <= 0) {
-        g_quantizer_statistics.fallback_threshold_counts[feature_idx] = 0;
-        g_quantizer_statistics.refinement_counts[feature_idx] = 0;
+        quantizer->stats.fallback_threshold_counts[feature_idx] = 0;
+        quantizer->stats.refinement_counts[feature_idx] = 0;
         return 0;
     }
 
@@ -1098,90 +1446,208 @@ static int finalize_chimerge_boundaries(int feature_idx,
     }
 
     for (int i = 0; i < cut_count; i++) {
-        g_quantizer_state.boundaries[boundary_index(feature_idx, i)] = selected[i];
+        quantizer->state.boundaries[boundary_index(quantizer, feature_idx, i)] = selected[i];
     }
 
-    g_quantizer_statistics.fallback_threshold_counts[feature_idx] = fallback_count;
-    g_quantizer_statistics.refinement_counts[feature_idx] = refinements;
-    g_quantizer_statistics.total_fallback_thresholds += fallback_count;
-    g_quantizer_statistics.total_refinements += refinements;
+    quantizer->stats.fallback_threshold_counts[feature_idx] = fallback_count;
+    quantizer->stats.refinement_counts[feature_idx] = refinements;
 
     free(selected);
     return 0;
 }
 
-static int fit_chimerge_feature(int feature_idx,
+/**
+ * @brief Candidate merge of two adjacent ChiMerge intervals.
+ *
+ * `left_version`/`right_version` record the intervals' versions when the
+ * score was computed; entries whose intervals changed since are stale.
+ */
+typedef struct {
+    double score;
+    int left;
+    int right;
+    int left_version;
+    int right_version;
+} chimerge_pair_t;
+
+/* Scores within CHIMERGE_THRESHOLD_EPS tie and the leftmost pair merges first, as in the linear scan. */
+static int chimerge_pair_before(const chimerge_pair_t *a, const chimerge_pair_t *b) {
+    if (a->score < b->score - CHIMERGE_THRESHOLD_EPS) {
+        return 1;
+    }
+    if (b->score < a->score - CHIMERGE_THRESHOLD_EPS) {
+        return 0;
+    }
+    return a->left < b->left;
+}
+
+static void chimerge_heap_push(chimerge_pair_t *heap, int *heap_size, chimerge_pair_t pair) {
+    int pos = (*heap_size)++;
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!chimerge_pair_before(&pair, &heap[parent])) {
+            break;
+        }
+        heap[pos] = heap[parent];
+        pos = parent;
+    }
+    heap[pos] = pair;
+}
+
+static chimerge_pair_t chimerge_heap_pop(chimerge_pair_t *heap, int *heap_size) {
+    chimerge_pair_t top = heap[0];
+    chimerge_pair_t last = heap[--(*heap_size)];
+    int pos = 0;
+    for (;;) {
+        int child = 2 * pos + 1;
+        if (child >= *heap_size) {
+            break;
+        }
+        if (child + 1 < *heap_size && chimerge_pair_before(&heap[child + 1], &heap[child])) {
+            child++;
+        }
+        if (!chimerge_pair_before(&heap[child], &last)) {
+            break;
+        }
+        heap[pos] = heap[child];
+        pos = child;
+    }
+    if (*heap_size > 0) {
+        heap[pos] = last;
+    }
+    return top;
+}
+
+static void chimerge_push_pair(chimerge_pair_t *heap,
+                               int *heap_size,
+                               const class_interval_t *intervals,
+                               const int *versions,
+                               int left,
+                               int right) {
+    chimerge_pair_t pair;
+    pair.score = compute_chimerge_score(&intervals[left], &intervals[right]);
+    pair.left = left;
+    pair.right = right;
+    pair.left_version = versions[left];
+    pair.right_version = versions[right];
+    chimerge_heap_push(heap, heap_size, pair);
+}
+
+static int fit_chimerge_feature(struct quantizer *quantizer,
+                                int feature_idx,
                                 const feature_sample_t *sorted_samples,
                                 int sample_count) {
-    chimerge_interval_t *intervals = NULL;
+    class_interval_t *intervals = NULL;
     int interval_count = 0;
 
-    if (g_quantizer_state.num_levels <= 1) {
-        g_quantizer_statistics.initial_interval_counts[feature_idx] = 1;
-        g_quantizer_statistics.fallback_threshold_counts[feature_idx] = 0;
-        g_quantizer_statistics.refinement_counts[feature_idx] = 0;
+    if (quantizer->state.num_levels <= 1) {
+        quantizer->stats.initial_interval_counts[feature_idx] = 1;
+        quantizer->stats.fallback_threshold_counts[feature_idx] = 0;
+        quantizer->stats.refinement_counts[feature_idx] = 0;
         return 0;
     }
 
-    intervals = (chimerge_interval_t *)calloc((size_t)sample_count, sizeof(chimerge_interval_t));
+    intervals = (class_interval_t *)calloc((size_t)sample_count, sizeof(class_interval_t));
     if (intervals == NULL) {
         fprintf(stderr, "quantizer: failed to allocate ChiMerge intervals.\n");
         return -1;
     }
 
-    for (int i = 0; i < sample_count; i++) {
-        double value = sorted_samples[i].value;
-        int label = sorted_samples[i].label;
-
-        if (interval_count == 0 ||
-            fabs(value - intervals[interval_count - 1].right_value) > CHIMERGE_THRESHOLD_EPS) {
-            intervals[interval_count].left_value = value;
-            intervals[interval_count].right_value = value;
-            interval_count++;
-        }
+    interval_count = build_class_histogram(sorted_samples, sample_count, CHIMERGE_THRESHOLD_EPS, intervals);
 
-        chimerge_interval_t *interval = &intervals[interval_count - 1];
-        interval->right_value = value;
-        interval->counts[label] += 1;
-        interval->sample_count += 1;
-    }
-
-    g_quantizer_statistics.initial_interval_counts[feature_idx] = interval_count;
-    if (interval_count < g_quantizer_state.num_levels && output_mode >= OUTPUT_BASIC) {
+    quantizer->stats.initial_interval_counts[feature_idx] = interval_count;
+    if (interval_count < quantizer->state.num_levels && output_mode >= OUTPUT_BASIC) {
         fprintf(stderr,
                 "quantizer: feature %d has only %d distinct value intervals for %d target bins; ChiMerge fallback will be used.\n",
                 feature_idx,
                 interval_count,
-                g_quantizer_state.num_levels);
-    }
+                quantizer->state.num_levels);
+    }
+
+    if (interval_count > quantizer->state.num_levels) {
+        /* Live intervals form a linked list; the heap holds the adjacent-pair scores, stale entries are skipped. */
+        int *next = (int *)malloc((size_t)interval_count * sizeof(int));
+        int *versions = (int *)calloc((size_t)interval_count, sizeof(int));
+        int *prev = (int *)malloc((size_t)interval_count * sizeof(int));
+        int heap_capacity = 3 * interval_count;
+        chimerge_pair_t *heap = (chimerge_pair_t *)malloc((size_t)heap_capacity * sizeof(chimerge_pair_t));
+        if (!next || !versions || !prev || !heap) {
+            fprintf(stderr, "quantizer: failed to allocate ChiMerge merge heap.\n");
+            free(next);
+            free(versions);
+            free(prev);
+            free(heap);
+            free(intervals);
+            return -1;
+        }
 
-    while (interval_count > g_quantizer_state.num_levels) {
-        int best_pair_idx = 0;
-        double best_score = compute_chimerge_score(&intervals[0], &intervals[1]);
+        int heap_size = 0;
+        for (int i = 0; i < interval_count; i++) {
+            prev[i] = i - 1;
+            next[i] = (i + 1 < interval_count) ? i + 1 : -1;
+        }
+        for (int i = 0; i + 1 < interval_count; i++) {
+            chimerge_push_pair(heap, &heap_size, intervals, versions, i, i + 1);
+        }
 
-        for (int pair_idx = 1; pair_idx < interval_count - 1; pair_idx++) {
-            double score = compute_chimerge_score(&intervals[pair_idx], &intervals[pair_idx + 1]);
-            if (score < best_score - CHIMERGE_THRESHOLD_EPS) {
-                best_score = score;
-                best_pair_idx = pair_idx;
+        int live_count = interval_count;
+        while (live_count > quantizer->state.num_levels && heap_size > 0) {
+            chimerge_pair_t pair = chimerge_heap_pop(heap, &heap_size);
+            if (versions[pair.left] != pair.left_version ||
+                versions[pair.right] != pair.right_version ||
+                next[pair.left] != pair.right) {
+                continue;
             }
-        }
 
-        chimerge_interval_t *left = &intervals[best_pair_idx];
-        chimerge_interval_t *right = &intervals[best_pair_idx + 1];
-        left->right_value = right->right_value;
-        left->sample_count += right->sample_count;
-        for (int cls = 0; cls < NUM_CLASSES; cls++) {
-            left->counts[cls] += right->counts[cls];
+            class_interval_t *left = &intervals[pair.left];
+            const class_interval_t *right = &intervals[pair.right];
+            left->right_value = right->right_value;
+            left->sample_count += right->sample_count;
+            for (int cls = 0; cls < NUM_CLASSES; cls++) {
+                left->counts[cls] += right->counts[cls];
+            }
+            versions[pair.left]++;
+            versions[pair.right] = -1;
+            next[pair.left] = next[pair.right];
+            if (next[pair.right] >= 0) {
+                prev[next[pair.right]] = pair.left;
+            }
+            live_count--;
+
+            if (heap_size + 2 > heap_capacity) {
+                heap_capacity *= 2;
+                chimerge_pair_t *grown = (chimerge_pair_t *)realloc(heap, (size_t)heap_capacity * sizeof(chimerge_pair_t));
+                if (!grown) {
+                    fprintf(stderr, "quantizer: failed to grow ChiMerge merge heap.\n");
+                    free(next);
+                    free(versions);
+                    free(prev);
+                    free(heap);
+                    free(intervals);
+                    return -1;
+                }
+                heap = grown;
+            }
+            if (prev[pair.left] >= 0) {
+                chimerge_push_pair(heap, &heap_size, intervals, versions, prev[pair.left], pair.left);
+            }
+            if (next[pair.left] >= 0) {
+                chimerge_push_pair(heap, &heap_size, intervals, versions, pair.left, next[pair.left]);
+            }
         }
 
-        for (int i = best_pair_idx + 1; i < interval_count - 1; i++) {
-            intervals[i] = intervals[i + 1];
+        int compacted = 0;
+        for (int i = 0; i >= 0; i = next[i]) {
+            intervals[compacted++] = intervals[i];
         }
-        interval_count--;
+        interval_count = compacted;
+        free(next);
+        free(versions);
+        free(prev);
+        free(heap);
     }
 
-    if (finalize_chimerge_boundaries(feature_idx, intervals, interval_count, sorted_samples, sample_count) != 0) {
+    if (finalize_chimerge_boundaries(quantizer, feature_idx, intervals, interval_count, sorted_samples, sample_count) != 0) {
         free(intervals);
         return -1;
     }
@@ -1191,69 +1657,69 @@ static int fit_chimerge_feature(int feature_idx,
 }
 #endif
 
-#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING || BINNING_MODE == GA_REFINED_BINNING
-static void compute_training_occupancy(double **training_data, int training_samples) {
-    if (g_quantizer_statistics.training_occupancy == NULL || g_quantizer_state.num_features <= 0 || g_quantizer_state.num_levels <= 0) {
+#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING || BINNING_MODE == GA_REFINED_BINNING
+static void compute_training_occupancy(struct quantizer *quantizer, double **training_data, int training_samples) {
+    if (quantizer->stats.training_occupancy == NULL || quantizer->state.num_features <= 0 || quantizer->state.num_levels <= 0) {
         return;
     }
 
-    memset(g_quantizer_statistics.training_occupancy, 0, center_count_total_for(g_quantizer_state.num_features, g_quantizer_state.num_levels) * sizeof(int));
-    memset(g_quantizer_statistics.empty_bin_counts, 0, (size_t)g_quantizer_state.num_features * sizeof(int));
+    memset(quantizer->stats.training_occupancy, 0, center_count_total_for(quantizer->state.num_features, quantizer->state.num_levels) * sizeof(int));
+    memset(quantizer->stats.empty_bin_counts, 0, (size_t)quantizer->state.num_features * sizeof(int));
 
     for (int sample = 0; sample < training_samples; sample++) {
-        for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
-            int level = get_signal_level(feature, training_data[sample][feature]);
-            g_quantizer_statistics.training_occupancy[occupancy_index(feature, level)] += 1;
+        for (int feature = 0; feature < quantizer->state.num_features; feature++) {
+            int level = quantizer_get_signal_level(quantizer, feature, training_data[sample][feature]);
+            quantizer->stats.training_occupancy[occupancy_index(quantizer, feature, level)] += 1;
         }
     }
 
-    g_quantizer_statistics.total_empty_bins = 0;
-    for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
+    quantizer->stats.total_empty_bins = 0;
+    for (int feature = 0; feature < quantizer->state.num_features; feature++) {
         int empty_bins = 0;
-        for (int level = 0; level < g_quantizer_state.num_levels; level++) {
-            if (g_quantizer_statistics.training_occupancy[occupancy_index(feature, level)] == 0) {
+        for (int level = 0; level < quantizer->state.num_levels; level++) {
+            if (quantizer->stats.training_occupancy[occupancy_index(quantizer, feature, level)] == 0) {
                 empty_bins++;
             }
         }
-        g_quantizer_statistics.empty_bin_counts[feature] = empty_bins;
-        g_quantizer_statistics.total_empty_bins += empty_bins;
+        quantizer->stats.empty_bin_counts[feature] = empty_bins;
+        quantizer->stats.total_empty_bins += empty_bins;
     }
 }
 #endif
 
-#if BINNING_MODE == KMEANS_1D_BINNING
-static void print_kmeans_diagnostics(void) {
+#if BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING
+static void print_kmeans_diagnostics(struct quantizer *quantizer) {
     if (output_mode >= OUTPUT_DETAILED) {
-        for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
+        for (int feature = 0; feature < quantizer->state.num_features; feature++) {
             fprintf(stdout,
                     "quantizer: kmeans feature %d: iter=%d, empty_bins=%d, duplicate_centers=%d, zero_width_intervals=%d\n",
                     feature,
-                    g_quantizer_statistics.iteration_counts[feature],
-                    g_quantizer_statistics.empty_bin_counts[feature],
-                    g_quantizer_statistics.duplicate_center_counts[feature],
-                    g_quantizer_statistics.zero_width_interval_counts[feature]);
+                    quantizer->stats.iteration_counts[feature],
+                    quantizer->stats.empty_bin_counts[feature],
+                    quantizer->stats.duplicate_center_counts[feature],
+                    quantizer->stats.zero_width_interval_counts[feature]);
         }
     }
 
     if (output_mode >= OUTPUT_DEBUG) {
-        for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
+        for (int feature = 0; feature < quantizer->state.num_features; feature++) {
             fprintf(stdout, "quantizer: feature %d centers:", feature);
-            for (int i = 0; i < g_quantizer_state.num_levels; i++) {
-                fprintf(stdout, " %.17g", g_quantizer_state.centers[center_index(feature, i)]);
+            for (int i = 0; i < quantizer->state.num_levels; i++) {
+                fprintf(stdout, " %.17g", quantizer->state.centers[center_index(quantizer, feature, i)]);
             }
             fprintf(stdout, "\n");
 
-            if (g_quantizer_state.num_levels > 1) {
+            if (quantizer->state.num_levels > 1) {
                 fprintf(stdout, "quantizer: feature %d boundaries:", feature);
-                for (int i = 0; i < g_quantizer_state.num_levels - 1; i++) {
-                    fprintf(stdout, " %.17g", g_quantizer_state.boundaries[boundary_index(feature, i)]);
+                for (int i = 0; i < quantizer->state.num_levels - 1; i++) {
+                    fprintf(stdout, " %.17g", quantizer->state.boundaries[boundary_index(quantizer, feature, i)]);
                 }
                 fprintf(stdout, "\n");
             }
 
             fprintf(stdout, "quantizer: feature %d occupancy:", feature);
-            for (int level = 0; level < g_quantizer_state.num_levels; level++) {
-                fprintf(stdout, " %d", g_quantizer_statistics.training_occupancy[occupancy_index(feature, level)]);
+            for (int level = 0; level < quantizer->state.num_levels; level++) {
+                fprintf(stdout, " %d", quantizer->stats.training_occupancy[occupancy_index(quantizer, feature, level)]);
             }
             fprintf(stdout, "\n");
         }
@@ -1262,32 +1728,32 @@ static void print_kmeans_diagnostics(void) {
 #endif
 
 #if BINNING_MODE == DECISION_TREE_1D_BINNING
-static void print_decision_tree_diagnostics(void) {
+static void print_decision_tree_diagnostics(struct quantizer *quantizer) {
     if (output_mode >= OUTPUT_DETAILED) {
-        for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
+        for (int feature = 0; feature < quantizer->state.num_features; feature++) {
             fprintf(stdout,
                     "quantizer: tree feature %d: splits=%d, fallback_thresholds=%d, empty_bins=%d, refinements=%d\n",
                     feature,
-                    g_quantizer_statistics.tree_split_counts[feature],
-                    g_quantizer_statistics.fallback_threshold_counts[feature],
-                    g_quantizer_statistics.empty_bin_counts[feature],
-                    g_quantizer_statistics.refinement_counts[feature]);
+                    quantizer->stats.tree_split_counts[feature],
+                    quantizer->stats.fallback_threshold_counts[feature],
+                    quantizer->stats.empty_bin_counts[feature],
+                    quantizer->stats.refinement_counts[feature]);
         }
     }
 
     if (output_mode >= OUTPUT_DEBUG) {
-        for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
-            if (g_quantizer_state.num_levels > 1) {
+        for (int feature = 0; feature < quantizer->state.num_features; feature++) {
+            if (quantizer->state.num_levels > 1) {
                 fprintf(stdout, "quantizer: feature %d boundaries:", feature);
-                for (int i = 0; i < g_quantizer_state.num_levels - 1; i++) {
-                    fprintf(stdout, " %.17g", g_quantizer_state.boundaries[boundary_index(feature, i)]);
+                for (int i = 0; i < quantizer->state.num_levels - 1; i++) {
+                    fprintf(stdout, " %.17g", quantizer->state.boundaries[boundary_index(quantizer, feature, i)]);
                 }
                 fprintf(stdout, "\n");
             }
 
             fprintf(stdout, "quantizer: feature %d occupancy:", feature);
-            for (int level = 0; level < g_quantizer_state.num_levels; level++) {
-                fprintf(stdout, " %d", g_quantizer_statistics.training_occupancy[occupancy_index(feature, level)]);
+            for (int level = 0; level < quantizer->state.num_levels; level++) {
+                fprintf(stdout, " %d", quantizer->stats.training_occupancy[occupancy_index(quantizer, feature, level)]);
             }
             fprintf(stdout, "\n");
         }
@@ -1296,32 +1762,32 @@ static void print_decision_tree_diagnostics(void) {
 #endif
 
 #if BINNING_MODE == CHIMERGE_BINNING
-static void print_chimerge_diagnostics(void) {
+static void print_chimerge_diagnostics(struct quantizer *quantizer) {
     if (output_mode >= OUTPUT_DETAILED) {
-        for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
+        for (int feature = 0; feature < quantizer->state.num_features; feature++) {
             fprintf(stdout,
                     "quantizer: chimerge feature %d: initial_intervals=%d, fallback_thresholds=%d, empty_bins=%d, refinements=%d\n",
                     feature,
-                    g_quantizer_statistics.initial_interval_counts[feature],
-                    g_quantizer_statistics.fallback_threshold_counts[feature],
-                    g_quantizer_statistics.empty_bin_counts[feature],
-                    g_quantizer_statistics.refinement_counts[feature]);
+                    quantizer->stats.initial_interval_counts[feature],
+                    quantizer->stats.fallback_threshold_counts[feature],
+                    quantizer->stats.empty_bin_counts[feature],
+                    quantizer->stats.refinement_counts[feature]);
         }
     }
 
     if (output_mode >= OUTPUT_DEBUG) {
-        for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
-            if (g_quantizer_state.num_levels > 1) {
+        for (int feature = 0; feature < quantizer->state.num_features; feature++) {
+            if (quantizer->state.num_levels > 1) {
                 fprintf(stdout, "quantizer: feature %d boundaries:", feature);
-                for (int i = 0; i < g_quantizer_state.num_levels - 1; i++) {
-                    fprintf(stdout, " %.17g", g_quantizer_state.boundaries[boundary_index(feature, i)]);
+                for (int i = 0; i < quantizer->state.num_levels - 1; i++) {
+                    fprintf(stdout, " %.17g", quantizer->state.boundaries[boundary_index(quantizer, feature, i)]);
                 }
                 fprintf(stdout, "\n");
             }
 
             fprintf(stdout, "quantizer: feature %d occupancy:", feature);
-            for (int level = 0; level < g_quantizer_state.num_levels; level++) {
-                fprintf(stdout, " %d", g_quantizer_statistics.training_occupancy[occupancy_index(feature, level)]);
+            for (int level = 0; level < quantizer->state.num_levels; level++) {
+                fprintf(stdout, " %d", quantizer->stats.training_occupancy[occupancy_index(quantizer, feature, level)]);
             }
             fprintf(stdout, "\n");
         }
@@ -1329,33 +1795,134 @@ static void print_chimerge_diagnostics(void) {
 }
 #endif
 
-#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING
-static int prepare_sorted_feature_values(double **training_data,
-                                         int training_samples,
-                                         int feature_idx,
-                                         double *sorted_values) {
+#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING
+#define QUANTIZER_RADIX_BITS 8
+#define QUANTIZER_RADIX_BUCKETS (1 << QUANTIZER_RADIX_BITS)
+#define QUANTIZER_RADIX_PASSES (64 / QUANTIZER_RADIX_BITS)
+
+/**
+ * @brief Copies the training features into one contiguous column per feature.
+ *
+ * Non-finite values are replaced with 0.0 (and counted) once here, so the
+ * per-feature fits read a clean, sequential column instead of striding through
+ * the sample rows.
+ *
+ * @return `num_features * training_samples` values, feature-major, or NULL.
+ */
+static double *build_feature_columns(struct quantizer *quantizer, double **training_data, int training_samples) {
+    int num_features = quantizer->state.num_features;
+    double *columns = (double *)malloc((size_t)num_features * (size_t)training_samples * sizeof(double));
+    if (columns == NULL) {
+        fprintf(stderr, "quantizer: failed to allocate feature columns.\n");
+        return NULL;
+    }
+
     for (int sample = 0; sample < training_samples; sample++) {
-        double value = training_data[sample][feature_idx];
-        if (!isfinite(value)) {
-            value = 0.0;
-            g_quantizer_state.non_finite_replacements++;
+        const double *row = training_data[sample];
+        for (int feature = 0; feature < num_features; feature++) {
+            double value = row[feature];
+            if (!isfinite(value)) {
+                value = 0.0;
+                quantizer->state.non_finite_replacements++;
+            }
+            columns[(size_t)feature * (size_t)training_samples + (size_t)sample] = value;
         }
-        sorted_values[sample] = value;
     }
+    return columns;
+}
 
-    qsort(sorted_values, (size_t)training_samples, sizeof(double), compare_doubles);
-    return 0;
+/**
+ * @brief Maps a finite double to an unsigned key with the same ordering.
+ *
+ * Negative values get all bits flipped, non-negative values only the sign bit,
+ * so unsigned comparison of the keys matches numeric comparison of the values.
+ */
+static uint64_t sortable_double_key(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & UINT64_C(0x8000000000000000)) ? ~bits : (bits | UINT64_C(0x8000000000000000));
+}
+
+/**
+ * @brief Counts the radix digits of all keys for every pass at once.
+ *
+ * @return Bit mask of the passes whose digit is not the same for every key;
+ *         the others leave the order unchanged and are skipped.
+ */
+static unsigned radix_histograms(const uint64_t *keys,
+                                 int count,
+                                 size_t histogram[QUANTIZER_RADIX_PASSES][QUANTIZER_RADIX_BUCKETS]) {
+    memset(histogram, 0, sizeof(size_t) * QUANTIZER_RADIX_PASSES * QUANTIZER_RADIX_BUCKETS);
+    for (int i = 0; i < count; i++) {
+        uint64_t key = keys[i];
+        for (int pass = 0; pass < QUANTIZER_RADIX_PASSES; pass++) {
+            histogram[pass][(key >> (pass * QUANTIZER_RADIX_BITS)) & (QUANTIZER_RADIX_BUCKETS - 1)]++;
+        }
+    }
+
+    unsigned active = 0u;
+    for (int pass = 0; pass < QUANTIZER_RADIX_PASSES; pass++) {
+        size_t first_digit = (keys[0] >> (pass * QUANTIZER_RADIX_BITS)) & (QUANTIZER_RADIX_BUCKETS - 1);
+        if (histogram[pass][first_digit] != (size_t)count) {
+            active |= 1u << pass;
+        }
+        size_t offset = 0;
+        for (int bucket = 0; bucket < QUANTIZER_RADIX_BUCKETS; bucket++) {
+            size_t bucket_count = histogram[pass][bucket];
+            histogram[pass][bucket] = offset;
+            offset += bucket_count;
+        }
+    }
+    return active;
 }
 #endif
 
-#if BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING
-static int prepare_sorted_feature_samples(double **training_data,
-                                          const int *training_labels,
+#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING
+/**
+ * @brief Sorts one feature column ascending with an LSD radix sort on its bit pattern.
+ *
+ * @param column Feature values (finite).
+ * @param training_samples Number of values.
+ * @param sorted_values Output, sorted copy of @p column.
+ * @param keys, scratch Work buffers of @p training_samples keys each.
+ */
+static void prepare_sorted_feature_values(const double *column,
                                           int training_samples,
-                                          int feature_idx,
-                                          feature_sample_t *sorted_samples) {
+                                          double *sorted_values,
+                                          uint64_t *keys,
+                                          uint64_t *scratch) {
+    size_t histogram[QUANTIZER_RADIX_PASSES][QUANTIZER_RADIX_BUCKETS];
+
+    for (int sample = 0; sample < training_samples; sample++) {
+        keys[sample] = sortable_double_key(column[sample]);
+    }
+
+    unsigned active = radix_histograms(keys, training_samples, histogram);
+    for (int pass = 0; pass < QUANTIZER_RADIX_PASSES; pass++) {
+        if (!(active & (1u << pass))) {
+            continue;
+        }
+        size_t *offsets = histogram[pass];
+        for (int i = 0; i < training_samples; i++) {
+            uint64_t key = keys[i];
+            scratch[offsets[(key >> (pass * QUANTIZER_RADIX_BITS)) & (QUANTIZER_RADIX_BUCKETS - 1)]++] = key;
+        }
+        uint64_t *swap = keys;
+        keys = scratch;
+        scratch = swap;
+    }
+
+    for (int sample = 0; sample < training_samples; sample++) {
+        uint64_t key = keys[sample];
+        uint64_t bits = (key & UINT64_C(0x8000000000000000)) ? (key & ~UINT64_C(0x8000000000000000)) : ~key;
+        memcpy(&sorted_values[sample], &bits, sizeof(bits));
+    }
+}
+#endif
+
+#if BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING
+static int validate_training_labels(const int *training_labels, int training_samples) {
     for (int sample = 0; sample < training_samples; sample++) {
-        double value = training_data[sample][feature_idx];
         int label = training_labels[sample];
         if (label < 0 || label >= NUM_CLASSES) {
             fprintf(stderr,
@@ -1365,24 +1932,105 @@ static int prepare_sorted_feature_samples(double **training_data,
                     NUM_CLASSES);
             return -1;
         }
-        if (!isfinite(value)) {
-            value = 0.0;
-            g_quantizer_state.non_finite_replacements++;
+    }
+    return 0;
+}
+
+/**
+ * @brief Sorts one feature column into (value, label) order with an LSD radix sort.
+ *
+ * A stable counting pass on the label precedes the passes over the value key,
+ * which yields the value order with ties broken by label.
+ *
+ * @param column Feature values (finite).
+ * @param training_labels Validated labels in [0, NUM_CLASSES).
+ * @param training_samples Number of samples.
+ * @param sorted_samples Output, sorted (value, label) pairs.
+ * @param scratch Work buffer of @p training_samples pairs.
+ * @param keys Work buffer of @p training_samples keys.
+ */
+static void prepare_sorted_feature_samples(const double *column,
+                                           const int *training_labels,
+                                           int training_samples,
+                                           feature_sample_t *sorted_samples,
+                                           feature_sample_t *scratch,
+                                           uint64_t *keys) {
+    size_t histogram[QUANTIZER_RADIX_PASSES][QUANTIZER_RADIX_BUCKETS];
+    size_t label_offsets[NUM_CLASSES] = {0};
+
+    for (int sample = 0; sample < training_samples; sample++) {
+        label_offsets[training_labels[sample]]++;
+    }
+    size_t offset = 0;
+    for (int cls = 0; cls < NUM_CLASSES; cls++) {
+        size_t class_count = label_offsets[cls];
+        label_offsets[cls] = offset;
+        offset += class_count;
+    }
+    for (int sample = 0; sample < training_samples; sample++) {
+        feature_sample_t *slot = &scratch[label_offsets[training_labels[sample]]++];
+        slot->value = column[sample];
+        slot->label = training_labels[sample];
+    }
+
+    feature_sample_t *source = scratch;
+    feature_sample_t *target = sorted_samples;
+    for (int sample = 0; sample < training_samples; sample++) {
+        keys[sample] = sortable_double_key(source[sample].value);
+    }
+
+    unsigned active = radix_histograms(keys, training_samples, histogram);
+    for (int pass = 0; pass < QUANTIZER_RADIX_PASSES; pass++) {
+        if (!(active & (1u << pass))) {
+            continue;
+        }
+        size_t *offsets = histogram[pass];
+        for (int i = 0; i < training_samples; i++) {
+            uint64_t key = sortable_double_key(source[i].value);
+            target[offsets[(key >> (pass * QUANTIZER_RADIX_BITS)) & (QUANTIZER_RADIX_BUCKETS - 1)]++] = source[i];
         }
-        sorted_samples[sample].value = value;
-        sorted_samples[sample].label = label;
+        feature_sample_t *swap = source;
+        source = target;
+        target = swap;
     }
 
-    qsort(sorted_samples, (size_t)training_samples, sizeof(feature_sample_t), compare_feature_samples);
-    return 0;
+    if (source != sorted_samples) {
+        memcpy(sorted_samples, source, (size_t)training_samples * sizeof(feature_sample_t));
+    }
 }
 #endif
 
-static int finalize_quantizer_fit(double **training_data, int training_samples) {
-    g_quantizer_state.fitted = 1;
+#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING
+/**
+ * @brief Recomputes the fit totals from the per-feature statistics.
+ *
+ * Features are fitted in parallel, so each fit only writes its own entries and
+ * the totals are summed once afterwards.
+ */
+static void sum_feature_statistics(struct quantizer *quantizer) {
+    quantizer->stats.total_refinements = 0;
+    quantizer->stats.total_duplicate_centers = 0;
+    quantizer->stats.total_zero_width_intervals = 0;
+    quantizer->stats.total_tree_splits = 0;
+    quantizer->stats.total_fallback_thresholds = 0;
+    for (int feature = 0; feature < quantizer->state.num_features; feature++) {
+        quantizer->stats.total_refinements += quantizer->stats.refinement_counts[feature];
+        quantizer->stats.total_duplicate_centers += quantizer->stats.duplicate_center_counts[feature];
+        quantizer->stats.total_zero_width_intervals += quantizer->stats.zero_width_interval_counts[feature];
+        quantizer->stats.total_tree_splits += quantizer->stats.tree_split_counts[feature];
+        quantizer->stats.total_fallback_thresholds += quantizer->stats.fallback_threshold_counts[feature];
+    }
+}
+#endif
+
+static int finalize_quantizer_fit(struct quantizer *quantizer, double **training_data, int training_samples) {
+    if (install_level_lookup(quantizer) != 0) {
+        return -1;
+    }
+    quantizer->state.fitted = 1;
 
-#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING || BINNING_MODE == GA_REFINED_BINNING
-    compute_training_occupancy(training_data, training_samples);
+#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING || BINNING_MODE == GA_REFINED_BINNING
+    compute_training_occupancy(quantizer, training_data, training_samples);
 #else
     (void)training_data;
     (void)training_samples;
@@ -1390,11 +2038,11 @@ static int finalize_quantizer_fit(double **training_data, int training_samples)
     return 0;
 }
 
-static void print_quantizer_fit_summary(void) {
-    if (g_quantizer_state.non_finite_replacements > 0 && output_mode >= OUTPUT_BASIC) {
+static void print_quantizer_fit_summary(struct quantizer *quantizer) {
+    if (quantizer->state.non_finite_replacements > 0 && output_mode >= OUTPUT_BASIC) {
         fprintf(stderr,
                 "quantizer: replaced %d non-finite training values with 0.0 during fit.\n",
-                g_quantizer_state.non_finite_replacements);
+                quantizer->state.non_finite_replacements);
     }
 
 #if BINNING_MODE == QUANTILE_BINNING
@@ -1402,139 +2050,168 @@ static void print_quantizer_fit_summary(void) {
         fprintf(stdout,
                 "quantizer: fitted %s boundaries for %d features, %d levels (total refinements: %d).\n",
                 quantizer_mode_name(),
-                g_quantizer_state.num_features,
-                g_quantizer_state.num_levels,
-                g_quantizer_statistics.total_refinements);
+                quantizer->state.num_features,
+                quantizer->state.num_levels,
+                quantizer->stats.total_refinements);
     }
-#elif BINNING_MODE == KMEANS_1D_BINNING
+#elif BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING
     if (output_mode >= OUTPUT_DETAILED) {
         fprintf(stdout,
                 "quantizer: fitted %s boundaries for %d features, %d levels (duplicate centers: %d, zero-width intervals: %d, empty bins: %d).\n",
                 quantizer_mode_name(),
-                g_quantizer_state.num_features,
-                g_quantizer_state.num_levels,
-                g_quantizer_statistics.total_duplicate_centers,
-                g_quantizer_statistics.total_zero_width_intervals,
-                g_quantizer_statistics.total_empty_bins);
+                quantizer->state.num_features,
+                quantizer->state.num_levels,
+                quantizer->stats.total_duplicate_centers,
+                quantizer->stats.total_zero_width_intervals,
+                quantizer->stats.total_empty_bins);
     }
-    print_kmeans_diagnostics();
+    print_kmeans_diagnostics(quantizer);
 #elif BINNING_MODE == DECISION_TREE_1D_BINNING
     if (output_mode >= OUTPUT_DETAILED) {
         fprintf(stdout,
                 "quantizer: fitted %s boundaries for %d features, %d levels (tree splits: %d, fallback thresholds: %d, refinements: %d, empty bins: %d).\n",
                 quantizer_mode_name(),
-                g_quantizer_state.num_features,
-                g_quantizer_state.num_levels,
-                g_quantizer_statistics.total_tree_splits,
-                g_quantizer_statistics.total_fallback_thresholds,
-                g_quantizer_statistics.total_refinements,
-                g_quantizer_statistics.total_empty_bins);
-    }
-    print_decision_tree_diagnostics();
+                quantizer->state.num_features,
+                quantizer->state.num_levels,
+                quantizer->stats.total_tree_splits,
+                quantizer->stats.total_fallback_thresholds,
+                quantizer->stats.total_refinements,
+                quantizer->stats.total_empty_bins);
+    }
+    print_decision_tree_diagnostics(quantizer);
 #elif BINNING_MODE == CHIMERGE_BINNING
     if (output_mode >= OUTPUT_DETAILED) {
         fprintf(stdout,
                 "quantizer: fitted %s boundaries for %d features, %d levels (fallback thresholds: %d, refinements: %d, empty bins: %d).\n",
                 quantizer_mode_name(),
-                g_quantizer_state.num_features,
-                g_quantizer_state.num_levels,
-                g_quantizer_statistics.total_fallback_thresholds,
-                g_quantizer_statistics.total_refinements,
-                g_quantizer_statistics.total_empty_bins);
+                quantizer->state.num_features,
+                quantizer->state.num_levels,
+                quantizer->stats.total_fallback_thresholds,
+                quantizer->stats.total_refinements,
+                quantizer->stats.total_empty_bins);
     }
-    print_chimerge_diagnostics();
+    print_chimerge_diagnostics(quantizer);
 #elif BINNING_MODE == GA_REFINED_BINNING
     if (output_mode >= OUTPUT_DETAILED) {
         fprintf(stdout,
                 "quantizer: fitted %s boundaries for %d features, %d levels (refinements: %d, empty bins: %d, zero-width intervals: %d).\n",
                 quantizer_mode_name(),
-                g_quantizer_state.num_features,
-                g_quantizer_state.num_levels,
-                g_quantizer_statistics.total_refinements,
-                g_quantizer_statistics.total_empty_bins,
-                g_quantizer_statistics.total_zero_width_intervals);
+                quantizer->state.num_features,
+                quantizer->state.num_levels,
+                quantizer->stats.total_refinements,
+                quantizer->stats.total_empty_bins,
+                quantizer->stats.total_zero_width_intervals);
     }
-    print_ga_refined_diagnostics();
+    print_ga_refined_diagnostics(quantizer);
 #endif
 }
 
 #if BINNING_MODE == UNIFORM_BINNING
-static int fit_uniform_quantizer(double **training_data,
+static int fit_uniform_quantizer(struct quantizer *quantizer,
+                                 double **training_data,
                                  const int *training_labels,
                                  int training_samples) {
     (void)training_data;
     (void)training_labels;
     (void)training_samples;
-    if (install_uniform_boundaries() != 0) {
+    if (install_uniform_boundaries(quantizer) != 0 || install_level_lookup(quantizer) != 0) {
         return -1;
     }
-    g_quantizer_state.fitted = 1;
+    quantizer->state.fitted = 1;
     return 0;
 }
 #endif
 
 #if BINNING_MODE == GA_REFINED_BINNING
-static int fit_ga_refined_quantizer_init(double **training_data, int training_samples) {
+static int fit_ga_refined_quantizer_init(struct quantizer *quantizer, double **training_data, int training_samples) {
     if (!training_data || training_samples <= 0) {
         fprintf(stderr, "quantizer: invalid fit input for GA-refined mode.\n");
         return -1;
     }
 
-    g_quantizer_state.training_data_ref = training_data;
-    g_quantizer_state.training_samples_ref = training_samples;
-    g_quantizer_state.ga_refined_ready = 0;
-    if (install_uniform_boundaries() != 0) {
+    quantizer->state.training_data_ref = training_data;
+    quantizer->state.training_samples_ref = training_samples;
+    quantizer->state.ga_refined_ready = 0;
+    if (install_uniform_boundaries(quantizer) != 0 || install_level_lookup(quantizer) != 0) {
         return -1;
     }
-    g_quantizer_state.fitted = 1;
+    quantizer->state.fitted = 1;
     if (output_mode >= OUTPUT_DETAILED) {
         fprintf(stdout,
                 "quantizer: initialized %s mode with temporary uniform lookup for %d features, %d levels.\n",
                 quantizer_mode_name(),
-                g_quantizer_state.num_features,
-                g_quantizer_state.num_levels);
+                quantizer->state.num_features,
+                quantizer->state.num_levels);
     }
     return 0;
 }
 #endif
 
-#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING
-static int fit_unsupervised_boundary_quantizer(double **training_data, int training_samples) {
-    double *sorted_values = NULL;
+#if BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING
+static int fit_unsupervised_boundary_quantizer(struct quantizer *quantizer, double **training_data, int training_samples) {
+    double *columns = NULL;
+    int status = 0;
 
     if (!training_data || training_samples <= 0) {
         fprintf(stderr, "quantizer: invalid fit input.\n");
         return -1;
     }
 
-    sorted_values = (double *)malloc((size_t)training_samples * sizeof(double));
-    if (sorted_values == NULL) {
-        fprintf(stderr, "quantizer: failed to allocate training buffer.\n");
+    columns = build_feature_columns(quantizer, training_data, training_samples);
+    if (columns == NULL) {
         return -1;
     }
 
-    for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
-        prepare_sorted_feature_values(training_data, training_samples, feature, sorted_values);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int feature = 0; feature < quantizer->state.num_features; feature++) {
+        double *sorted_values = (double *)malloc((size_t)training_samples * sizeof(double));
+        uint64_t *keys = (uint64_t *)malloc((size_t)training_samples * sizeof(uint64_t));
+        uint64_t *scratch = (uint64_t *)malloc((size_t)training_samples * sizeof(uint64_t));
+        int feature_status = 0;
+        if (sorted_values == NULL || keys == NULL || scratch == NULL) {
+            fprintf(stderr, "quantizer: failed to allocate training buffer.\n");
+            feature_status = -1;
+        } else {
+            prepare_sorted_feature_values(columns + (size_t)feature * (size_t)training_samples,
+                                          training_samples,
+                                          sorted_values,
+                                          keys,
+                                          scratch);
 #if BINNING_MODE == QUANTILE_BINNING
-        if (fit_quantile_feature(feature, sorted_values, training_samples) != 0) {
+            feature_status = fit_quantile_feature(quantizer, feature, sorted_values, training_samples);
 #else
-        if (fit_kmeans_feature(feature, sorted_values, training_samples) != 0) {
+            feature_status = fit_kmeans_feature(quantizer, feature, sorted_values, training_samples);
 #endif
-            free(sorted_values);
-            return -1;
         }
+        if (feature_status != 0) {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+            status = -1;
+        }
+        free(sorted_values);
+        free(keys);
+        free(scratch);
     }
 
-    free(sorted_values);
+    free(columns);
+    if (status != 0) {
+        return -1;
+    }
+    sum_feature_statistics(quantizer);
     return 0;
 }
 #endif
 
 #if BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING
-static int fit_supervised_boundary_quantizer(double **training_data,
+static int fit_supervised_boundary_quantizer(struct quantizer *quantizer,
+                                             double **training_data,
                                              const int *training_labels,
                                              int training_samples) {
-    feature_sample_t *sorted_samples = NULL;
+    double *columns = NULL;
+    int status = 0;
 
     if (!training_data || !training_labels || training_samples <= 0) {
 #if BINNING_MODE == DECISION_TREE_1D_BINNING
@@ -1545,156 +2222,187 @@ static int fit_supervised_boundary_quantizer(double **training_data,
         return -1;
     }
 
-    sorted_samples = (feature_sample_t *)malloc((size_t)training_samples * sizeof(feature_sample_t));
-    if (sorted_samples == NULL) {
-#if BINNING_MODE == DECISION_TREE_1D_BINNING
-        fprintf(stderr, "quantizer: failed to allocate decision-tree training buffers.\n");
-#else
-        fprintf(stderr, "quantizer: failed to allocate ChiMerge training buffers.\n");
-#endif
-        free(sorted_samples);
+    if (validate_training_labels(training_labels, training_samples) != 0) {
+        return -1;
+    }
+    columns = build_feature_columns(quantizer, training_data, training_samples);
+    if (columns == NULL) {
         return -1;
     }
 
-    for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
-        if (prepare_sorted_feature_samples(training_data,
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int feature = 0; feature < quantizer->state.num_features; feature++) {
+        feature_sample_t *sorted_samples = (feature_sample_t *)malloc((size_t)training_samples * sizeof(feature_sample_t));
+        feature_sample_t *scratch = (feature_sample_t *)malloc((size_t)training_samples * sizeof(feature_sample_t));
+        uint64_t *keys = (uint64_t *)malloc((size_t)training_samples * sizeof(uint64_t));
+        int feature_status = 0;
+        if (sorted_samples == NULL || scratch == NULL || keys == NULL) {
+#if BINNING_MODE == DECISION_TREE_1D_BINNING
+            fprintf(stderr, "quantizer: failed to allocate decision-tree training buffers.\n");
+#else
+            fprintf(stderr, "quantizer: failed to allocate ChiMerge training buffers.\n");
+#endif
+            feature_status = -1;
+        } else {
+            prepare_sorted_feature_samples(columns + (size_t)feature * (size_t)training_samples,
                                            training_labels,
                                            training_samples,
-                                           feature,
-                                           sorted_samples) != 0) {
-            free(sorted_samples);
-            return -1;
-        }
+                                           sorted_samples,
+                                           scratch,
+                                           keys);
 #if BINNING_MODE == DECISION_TREE_1D_BINNING
-        if (fit_decision_tree_feature(feature, sorted_samples, training_samples) != 0) {
+            feature_status = fit_decision_tree_feature(quantizer, feature, sorted_samples, training_samples);
 #else
-        if (fit_chimerge_feature(feature, sorted_samples, training_samples) != 0) {
+            feature_status = fit_chimerge_feature(quantizer, feature, sorted_samples, training_samples);
 #endif
-            free(sorted_samples);
-            return -1;
         }
+        if (feature_status != 0) {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+            status = -1;
+        }
+        free(sorted_samples);
+        free(scratch);
+        free(keys);
     }
 
-    free(sorted_samples);
+    free(columns);
+    if (status != 0) {
+        return -1;
+    }
+    sum_feature_statistics(quantizer);
     return 0;
 }
 #endif
 
-void quantizer_clear(void) {
-    free(g_quantizer_state.boundaries);
-    free(g_quantizer_state.centers);
-    free(g_quantizer_statistics.refinement_counts);
-    free(g_quantizer_statistics.duplicate_center_counts);
-    free(g_quantizer_statistics.zero_width_interval_counts);
-    free(g_quantizer_statistics.empty_bin_counts);
-    free(g_quantizer_statistics.iteration_counts);
-    free(g_quantizer_statistics.training_occupancy);
-    free(g_quantizer_statistics.tree_split_counts);
-    free(g_quantizer_statistics.fallback_threshold_counts);
-    free(g_quantizer_statistics.initial_interval_counts);
+static void clear_quantizer(struct quantizer *quantizer) {
+    if (!quantizer->state.borrowed_boundaries) {
+        free(quantizer->state.boundaries);
+    }
+    quantizer->state.borrowed_boundaries = 0;
+    free(quantizer->state.thresholds_i16);
+    quantizer->state.thresholds_i16 = NULL;
+    free(quantizer->state.centers);
+    free(quantizer->stats.refinement_counts);
+    free(quantizer->stats.duplicate_center_counts);
+    free(quantizer->stats.zero_width_interval_counts);
+    free(quantizer->stats.empty_bin_counts);
+    free(quantizer->stats.iteration_counts);
+    free(quantizer->stats.training_occupancy);
+    free(quantizer->stats.tree_split_counts);
+    free(quantizer->stats.fallback_threshold_counts);
+    free(quantizer->stats.initial_interval_counts);
 #if BINNING_MODE == GA_REFINED_BINNING
-    free(g_quantizer_state.ga_refined_flip_counts);
-    free(g_quantizer_state.ga_refined_transition_weights);
+    free(quantizer->state.ga_refined_flip_counts);
+    free(quantizer->state.ga_refined_transition_weights);
 #endif
-    g_quantizer_state.boundaries = NULL;
-    g_quantizer_state.centers = NULL;
-    g_quantizer_statistics.refinement_counts = NULL;
-    g_quantizer_statistics.duplicate_center_counts = NULL;
-    g_quantizer_statistics.zero_width_interval_counts = NULL;
-    g_quantizer_statistics.empty_bin_counts = NULL;
-    g_quantizer_statistics.iteration_counts = NULL;
-    g_quantizer_statistics.training_occupancy = NULL;
-    g_quantizer_statistics.tree_split_counts = NULL;
-    g_quantizer_statistics.fallback_threshold_counts = NULL;
-    g_quantizer_statistics.initial_interval_counts = NULL;
+    quantizer->state.boundaries = NULL;
+    quantizer->state.centers = NULL;
+    quantizer->stats.refinement_counts = NULL;
+    quantizer->stats.duplicate_center_counts = NULL;
+    quantizer->stats.zero_width_interval_counts = NULL;
+    quantizer->stats.empty_bin_counts = NULL;
+    quantizer->stats.iteration_counts = NULL;
+    quantizer->stats.training_occupancy = NULL;
+    quantizer->stats.tree_split_counts = NULL;
+    quantizer->stats.fallback_threshold_counts = NULL;
+    quantizer->stats.initial_interval_counts = NULL;
 #if BINNING_MODE == GA_REFINED_BINNING
-    g_quantizer_state.ga_refined_flip_counts = NULL;
-    g_quantizer_state.ga_refined_transition_weights = NULL;
-    g_quantizer_state.training_data_ref = NULL;
-    g_quantizer_state.training_samples_ref = 0;
-    g_quantizer_state.ga_refined_ready = 0;
+    quantizer->state.ga_refined_flip_counts = NULL;
+    quantizer->state.ga_refined_transition_weights = NULL;
+    quantizer->state.training_data_ref = NULL;
+    quantizer->state.training_samples_ref = 0;
+    quantizer->state.ga_refined_ready = 0;
 #endif
-    g_quantizer_state.num_features = 0;
-    g_quantizer_state.num_levels = 0;
-    g_quantizer_state.fitted = 0;
-    g_quantizer_state.non_finite_replacements = 0;
-    g_quantizer_statistics.total_refinements = 0;
-    g_quantizer_statistics.total_duplicate_centers = 0;
-    g_quantizer_statistics.total_zero_width_intervals = 0;
-    g_quantizer_statistics.total_empty_bins = 0;
-    g_quantizer_statistics.total_tree_splits = 0;
-    g_quantizer_statistics.total_fallback_thresholds = 0;
+    quantizer->state.num_features = 0;
+    quantizer->state.num_levels = 0;
+    quantizer->state.fitted = 0;
+    quantizer->state.non_finite_replacements = 0;
+    quantizer->stats.total_refinements = 0;
+    quantizer->stats.total_duplicate_centers = 0;
+    quantizer->stats.total_zero_width_intervals = 0;
+    quantizer->stats.total_empty_bins = 0;
+    quantizer->stats.total_tree_splits = 0;
+    quantizer->stats.total_fallback_thresholds = 0;
 }
 
-int quantizer_is_fitted(void) {
-    return g_quantizer_state.fitted;
-}
-int quantizer_fit_from_training(double **training_data,
-                                const int *training_labels,
-                                int training_samples,
-                                int num_features,
-                                int num_levels) {
-    quantizer_clear();
+static int fit_quantizer(struct quantizer *quantizer,
+                         double **training_data,
+                         const int *training_labels,
+                         int training_samples,
+                         int num_features,
+                         int num_levels) {
+    clear_quantizer(quantizer);
 
     if (num_features <= 0 || num_levels <= 0) {
         fprintf(stderr, "quantizer: invalid fit input.\n");
         return -1;
     }
 
-    g_quantizer_state.num_features = num_features;
-    g_quantizer_state.num_levels = num_levels;
+    quantizer->state.num_features = num_features;
+    quantizer->state.num_levels = num_levels;
 
-    if (allocate_quantizer_state(num_features, num_levels) != 0) {
-        quantizer_clear();
+    if (allocate_quantizer_state(quantizer, num_features, num_levels) != 0) {
+        clear_quantizer(quantizer);
         return -1;
     }
 
 #if BINNING_MODE == UNIFORM_BINNING
-    if (fit_uniform_quantizer(training_data, training_labels, training_samples) != 0) {
-        quantizer_clear();
+    if (fit_uniform_quantizer(quantizer, training_data, training_labels, training_samples) != 0) {
+        clear_quantizer(quantizer);
         return -1;
     }
     return 0;
 #elif BINNING_MODE == GA_REFINED_BINNING
     (void)training_labels;
-    if (fit_ga_refined_quantizer_init(training_data, training_samples) != 0) {
-        quantizer_clear();
+    if (fit_ga_refined_quantizer_init(quantizer, training_data, training_samples) != 0) {
+        clear_quantizer(quantizer);
         return -1;
     }
     return 0;
-#elif BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING
+#elif BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING
     (void)training_labels;
-    if (fit_unsupervised_boundary_quantizer(training_data, training_samples) != 0) {
-        quantizer_clear();
+    if (fit_unsupervised_boundary_quantizer(quantizer, training_data, training_samples) != 0) {
+        clear_quantizer(quantizer);
         return -1;
     }
 #elif BINNING_MODE == DECISION_TREE_1D_BINNING
-    if (fit_supervised_boundary_quantizer(training_data, training_labels, training_samples) != 0) {
-        quantizer_clear();
+    if (fit_supervised_boundary_quantizer(quantizer, training_data, training_labels, training_samples) != 0) {
+        clear_quantizer(quantizer);
         return -1;
     }
 #elif BINNING_MODE == CHIMERGE_BINNING
-    if (fit_supervised_boundary_quantizer(training_data, training_labels, training_samples) != 0) {
-        quantizer_clear();
+    if (fit_supervised_boundary_quantizer(quantizer, training_data, training_labels, training_samples) != 0) {
+        clear_quantizer(quantizer);
         return -1;
     }
 #else
-#error "Unsupported BINNING_MODE. Use UNIFORM_BINNING, QUANTILE_BINNING, KMEANS_1D_BINNING, DECISION_TREE_1D_BINNING, CHIMERGE_BINNING, or GA_REFINED_BINNING."
+#error "Unsupported BINNING_MODE. Use UNIFORM_BINNING, QUANTILE_BINNING, KMEANS_1D_BINNING, KMEANS_1D_OPTIMAL_BINNING, DECISION_TREE_1D_BINNING, CHIMERGE_BINNING, or GA_REFINED_BINNING."
 #endif
 
-    finalize_quantizer_fit(training_data, training_samples);
-    print_quantizer_fit_summary();
+    if (finalize_quantizer_fit(quantizer, training_data, training_samples) != 0) {
+        clear_quantizer(quantizer);
+        return -1;
+    }
+    print_quantizer_fit_summary(quantizer);
     return 0;
 }
 
 #if BINNING_MODE == GA_REFINED_BINNING
-int quantizer_refine_from_flip_counts(const uint16_t *flip_counts, int genome_length) {
-    if (!g_quantizer_state.fitted) {
+int quantizer_refine(struct quantizer *quantizer, const uint16_t *flip_counts, int genome_length) {
+    if (!quantizer->state.fitted) {
         fprintf(stderr, "quantizer: GA-refined thresholds requested before fit.\n");
         return -1;
     }
+    if (quantizer->state.borrowed_boundaries) {
+        fprintf(stderr, "quantizer: cannot refine borrowed (read-only) cuts.\n");
+        return -1;
+    }
 
-    int expected_length = g_quantizer_state.num_features * (g_quantizer_state.num_levels - 1);
+    int expected_length = quantizer->state.num_features * (quantizer->state.num_levels - 1);
     if (!flip_counts || genome_length != expected_length) {
         fprintf(stderr,
                 "quantizer: invalid GA-refined flip-count input (got %d, expected %d).\n",
@@ -1703,47 +2411,519 @@ int quantizer_refine_from_flip_counts(const uint16_t *flip_counts, int genome_le
         return -1;
     }
 
-    reset_ga_refined_feature_stats();
-    if (g_quantizer_statistics.training_occupancy != NULL) {
-        memset(g_quantizer_statistics.training_occupancy, 0, (size_t)g_quantizer_state.num_features * (size_t)g_quantizer_state.num_levels * sizeof(int));
+    reset_ga_refined_feature_stats(quantizer);
+    if (quantizer->stats.training_occupancy != NULL) {
+        memset(quantizer->stats.training_occupancy, 0, (size_t)quantizer->state.num_features * (size_t)quantizer->state.num_levels * sizeof(int));
     }
 
-    int transitions = g_quantizer_state.num_levels - 1;
-    for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
-        if (fit_ga_refined_feature(feature, flip_counts + (size_t)feature * transitions) != 0) {
+    int transitions = quantizer->state.num_levels - 1;
+    for (int feature = 0; feature < quantizer->state.num_features; feature++) {
+        if (fit_ga_refined_feature(quantizer, feature, flip_counts + (size_t)feature * transitions) != 0) {
             return -1;
         }
     }
 
-    g_quantizer_state.ga_refined_ready = 1;
-    if (g_quantizer_state.training_data_ref && g_quantizer_state.training_samples_ref > 0) {
-        compute_training_occupancy(g_quantizer_state.training_data_ref, g_quantizer_state.training_samples_ref);
+    if (install_level_lookup(quantizer) != 0) {
+        return -1;
+    }
+    quantizer->state.ga_refined_ready = 1;
+    if (quantizer->state.training_data_ref && quantizer->state.training_samples_ref > 0) {
+        compute_training_occupancy(quantizer, quantizer->state.training_data_ref, quantizer->state.training_samples_ref);
     }
 
     if (output_mode >= OUTPUT_DETAILED) {
         fprintf(stdout,
                 "quantizer: installed GA-refined thresholds for %d features, %d levels.\n",
-                g_quantizer_state.num_features,
-                g_quantizer_state.num_levels);
+                quantizer->state.num_features,
+                quantizer->state.num_levels);
     }
-    print_ga_refined_diagnostics();
+    print_ga_refined_diagnostics(quantizer);
     return 0;
 }
 #endif
 
+int quantizer_get_signal_level(struct quantizer *quantizer, int feature_idx, double emg_value) {
+    return map_value_with_boundaries_checked(quantizer, feature_idx, emg_value);
+}
+
+/**
+ * @brief Cost model: one quantizer row (a feature's cuts of `cut_bytes` each) read per feature.
+ */
+static inline void count_quantize_cost(const struct quantizer *quantizer, size_t cut_bytes) {
+#if HDC_COST_MODEL
+    int num_features = quantizer->state.num_features;
+    int cut_count = quantizer->state.num_levels > 1 ? quantizer->state.num_levels - 1 : 1;
+    HDC_COST_ADD(HDC_STAGE_QUANTIZE, HDC_COST_QUANTIZER_ROW_READS, num_features);
+    HDC_COST_ADD(HDC_STAGE_QUANTIZE, HDC_COST_QUANTIZER_ROW_READ_BYTES, (size_t)num_features * cut_count * cut_bytes);
+#else
+    (void)quantizer;
+    (void)cut_bytes;
+#endif
+}
+
+/**
+ * @brief Maps all features of one sample to signal levels.
+ *
+ * Fast path of quantizer_get_signal_level() for the encoders: the quantizer must be
+ * fitted and @p x must hold one value per fitted feature. Both are the
+ * caller's contract, because the cuts were validated once at fit time.
+ *
+ * @param quantizer Fitted quantizer.
+ * @param x Sample values `[num_features]`.
+ * @param levels_out Receives the signal level of every feature.
+ */
+void quantizer_quantize_sample(struct quantizer *quantizer, const double *x, quantized_level *levels_out) {
+    HDC_PROFILE_BEGIN(HDC_STAGE_QUANTIZE);
+    int num_features = quantizer->state.num_features;
+    for (int feature = 0; feature < num_features; feature++) {
+        levels_out[feature] = (quantized_level)lookup_level(quantizer, feature, x[feature]);
+    }
+    count_quantize_cost(quantizer, sizeof(double));
+    HDC_PROFILE_END(HDC_STAGE_QUANTIZE, 1);
+}
+
+/**
+ * @brief Quantizes a float32 sample; each value is widened to double before the lookup.
+ */
+void quantizer_quantize_sample_f(struct quantizer *quantizer, const float *x, quantized_level *levels_out) {
+    HDC_PROFILE_BEGIN(HDC_STAGE_QUANTIZE);
+    int num_features = quantizer->state.num_features;
+    for (int feature = 0; feature < num_features; feature++) {
+        levels_out[feature] = (quantized_level)lookup_level(quantizer, feature, (double)x[feature]);
+    }
+    count_quantize_cost(quantizer, sizeof(double));
+    HDC_PROFILE_END(HDC_STAGE_QUANTIZE, 1);
+}
+
+/**
+ * @brief Maps an int16 ADC code of one feature to its signal level.
+ *
+ * The code stands for the value `code / QUANTIZER_I16_FULL_SCALE`; the level
+ * equals quantizer_get_signal_level() of that value.
+ */
+int quantizer_get_signal_level_i16(struct quantizer *quantizer, int feature_idx, int16_t code) {
+    if (!quantizer->state.fitted) {
+        fprintf(stderr, "quantizer: map called before fit.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (feature_idx < 0 || feature_idx >= quantizer->state.num_features) {
+        fprintf(stderr, "quantizer: feature index %d out of range [0,%d).\n", feature_idx, quantizer->state.num_features);
+        exit(EXIT_FAILURE);
+    }
+    return lookup_level_i16(quantizer, feature_idx, code);
+}
+
+/**
+ * @brief Quantizes a sample of int16 ADC codes with integer comparisons only.
+ *
+ * Same contract as quantizer_quantize_sample(); no floating point is involved,
+ * the thresholds were derived from the cuts when they were installed.
+ */
+void quantizer_quantize_sample_i16(struct quantizer *quantizer, const int16_t *x, quantized_level *levels_out) {
+    HDC_PROFILE_BEGIN(HDC_STAGE_QUANTIZE);
+    int num_features = quantizer->state.num_features;
+    for (int feature = 0; feature < num_features; feature++) {
+        levels_out[feature] = (quantized_level)lookup_level_i16(quantizer, feature, x[feature]);
+    }
+    count_quantize_cost(quantizer, sizeof(int32_t));
+    HDC_PROFILE_END(HDC_STAGE_QUANTIZE, 1);
+}
+
+/**
+ * @brief Validates the inputs of a dataset quantization and allocates its level matrix.
+ */
+static int alloc_quantized_dataset(struct quantizer *quantizer,
+                                   struct quantized_dataset *dataset,
+                                   int has_data,
+                                   int num_samples,
+                                   int num_features) {
+    if (!dataset) {
+        return -1;
+    }
+    dataset->levels = NULL;
+    dataset->num_samples = 0;
+    dataset->num_features = 0;
+    if ((!has_data && num_samples > 0) || num_samples < 0 || num_features <= 0) {
+        return -1;
+    }
+    if (!quantizer->state.fitted) {
+        fprintf(stderr, "quantizer: dataset quantization requested before fit.\n");
+        return -1;
+    }
+    if (quantizer->state.num_levels - 1 > (int)(quantized_level)~(quantized_level)0) {
+        fprintf(stderr, "quantizer: %d levels do not fit the quantized level type.\n", quantizer->state.num_levels);
+        return -1;
+    }
+    if (num_features != quantizer->state.num_features) {
+        fprintf(stderr,
+                "quantizer: dataset has %d features, the quantizer was fitted on %d.\n",
+                num_features,
+                quantizer->state.num_features);
+        return -1;
+    }
+
+    size_t count = (size_t)num_samples * (size_t)num_features;
+    dataset->levels = (quantized_level *)malloc((count > 0 ? count : 1) * sizeof(quantized_level));
+    if (!dataset->levels) {
+        fprintf(stderr, "quantizer: failed to allocate quantized dataset.\n");
+        return -1;
+    }
+    dataset->num_samples = num_samples;
+    dataset->num_features = num_features;
+    return 0;
+}
+
+/**
+ * @brief Quantizes a whole dataset into a contiguous level matrix.
+ *
+ * @param quantizer Fitted quantizer.
+ * @param dataset Receives the level matrix.
+ * @param data Samples `[num_samples][num_features]`.
+ * @param num_samples Number of samples.
+ * @param num_features Number of features per sample.
+ * @return 0 on success, -1 on invalid input, an unfitted quantizer or allocation failure.
+ */
+int init_quantized_dataset_for(struct quantizer *quantizer,
+                               struct quantized_dataset *dataset,
+                               double **data,
+                               int num_samples,
+                               int num_features) {
+    if (alloc_quantized_dataset(quantizer, dataset, data != NULL, num_samples, num_features) != 0) {
+        return -1;
+    }
+    for (int sample = 0; sample < num_samples; sample++) {
+        quantizer_quantize_sample(quantizer, data[sample], dataset->levels + (size_t)sample * (size_t)num_features);
+    }
+    return 0;
+}
+
+/**
+ * @brief Quantizes a float32 sample matrix into a contiguous level matrix.
+ *
+ * Same as `init_quantized_dataset_for`, streaming over the matrix rows.
+ *
+ * @return 0 on success, -1 on invalid input, an unfitted quantizer or allocation failure.
+ */
+int init_quantized_dataset_from_matrix(struct quantizer *quantizer,
+                                       struct quantized_dataset *dataset,
+                                       const struct sample_matrix *samples) {
+    if (!samples || samples->rows > (size_t)INT_MAX ||
+        alloc_quantized_dataset(quantizer, dataset, samples->data != NULL, (int)samples->rows, (int)samples->cols) != 0) {
+        return -1;
+    }
+    for (size_t sample = 0; sample < samples->rows; sample++) {
+        quantizer_quantize_sample_f(quantizer, sample_matrix_row(samples, sample),
+                                    dataset->levels + sample * samples->cols);
+    }
+    return 0;
+}
+
+void free_quantized_dataset(struct quantized_dataset *dataset) {
+    if (!dataset) {
+        return;
+    }
+    free(dataset->levels);
+    dataset->levels = NULL;
+    dataset->num_samples = 0;
+    dataset->num_features = 0;
+}
+
+/**
+ * @brief Fits a new quantizer instance on training data.
+ *
+ * Unlike quantizer_fit_from_training() the result is independent of the global
+ * quantizer, so several models (e.g. one per dataset or subject) can hold their
+ * own quantizer at the same time. Pass it to an encoder with
+ * encoder_use_quantizer().
+ *
+ * @param training_data Training samples `[training_samples][num_features]`.
+ * @param training_labels Labels of the samples (used by the supervised modes).
+ * @param training_samples Number of training samples.
+ * @param num_features Number of features.
+ * @param num_levels Number of signal levels.
+ * @return The fitted quantizer (release with free_quantizer()), or NULL on failure.
+ */
+struct quantizer *quantizer_fit(double **training_data,
+                                const int *training_labels,
+                                int training_samples,
+                                int num_features,
+                                int num_levels) {
+    struct quantizer *quantizer = (struct quantizer *)calloc(1, sizeof(*quantizer));
+    if (quantizer == NULL) {
+        fprintf(stderr, "quantizer: failed to allocate quantizer.\n");
+        return NULL;
+    }
+    if (fit_quantizer(quantizer, training_data, training_labels, training_samples, num_features, num_levels) != 0) {
+        free(quantizer);
+        return NULL;
+    }
+    return quantizer;
+}
+
+void free_quantizer(struct quantizer *quantizer) {
+    if (quantizer == NULL || quantizer == &g_quantizer) {
+        return;
+    }
+    clear_quantizer(quantizer);
+    free(quantizer);
+}
+
+/**
+ * @brief Returns the quantizer behind the global API.
+ *
+ * The handle stays valid across quantizer_fit_from_training() and
+ * quantizer_clear(); it always refers to the most recent global fit.
+ */
+struct quantizer *quantizer_global(void) {
+    return &g_quantizer;
+}
+
+int quantizer_fitted(const struct quantizer *quantizer) {
+    return quantizer != NULL && quantizer->state.fitted;
+}
+
+/**
+ * @brief Writes a fitted quantizer to a binary file.
+ *
+ * See QUANTIZER_FILE_MAGIC for the layout. Only the cuts and centers are
+ * stored; the fit diagnostics are not part of the file.
+ *
+ * @return 0 on success, -1 if the quantizer is not fitted or writing fails.
+ */
+int quantizer_save(const struct quantizer *quantizer, const char *filepath) {
+    if (!quantizer_fitted(quantizer) || !filepath || filepath[0] == '\0') {
+        fprintf(stderr, "quantizer: save requires a fitted quantizer and a path.\n");
+        return -1;
+    }
+
+    size_t boundary_count = boundary_count_total_for(quantizer->state.num_features, quantizer->state.num_levels);
+    size_t center_count = center_count_total_for(quantizer->state.num_features, quantizer->state.num_levels);
+    size_t size = QUANTIZER_FILE_HEADER_BYTES + (boundary_count + center_count) * 8u;
+    uint8_t *buffer = (uint8_t *)malloc(size);
+    if (!buffer) {
+        fprintf(stderr, "quantizer: failed to allocate save buffer.\n");
+        return -1;
+    }
+
+    memcpy(buffer, QUANTIZER_FILE_MAGIC, 4);
+    put_u16(buffer + 4, QUANTIZER_FILE_VERSION);
+    put_u16(buffer + 6, (uint16_t)BINNING_MODE);
+    put_u32(buffer + 8, (uint32_t)quantizer->state.num_features);
+    put_u32(buffer + 12, (uint32_t)quantizer->state.num_levels);
+    uint8_t *out = buffer + QUANTIZER_FILE_HEADER_BYTES;
+    for (size_t i = 0; i < boundary_count; i++, out += 8) {
+        put_f64(out, quantizer->state.boundaries[i]);
+    }
+    for (size_t i = 0; i < center_count; i++, out += 8) {
+        put_f64(out, quantizer->state.centers[i]);
+    }
+
+    FILE *file = fopen(filepath, "wb");
+    if (!file) {
+        perror("quantizer: failed to open save path");
+        free(buffer);
+        return -1;
+    }
+    int status = fwrite(buffer, 1, size, file) == size ? 0 : -1;
+    if (fclose(file) != 0) {
+        status = -1;
+    }
+    if (status != 0) {
+        fprintf(stderr, "quantizer: failed to write %s.\n", filepath);
+    }
+    free(buffer);
+    return status;
+}
+
+/**
+ * @brief Reads a quantizer written by quantizer_save().
+ *
+ * The file must come from a build with the same BINNING_MODE.
+ *
+ * @return The loaded quantizer (release with free_quantizer()), or NULL on failure.
+ */
+struct quantizer *quantizer_load(const char *filepath) {
+    if (!filepath || filepath[0] == '\0') {
+        return NULL;
+    }
+    FILE *file = fopen(filepath, "rb");
+    if (!file) {
+        perror("quantizer: failed to open quantizer file");
+        return NULL;
+    }
+
+    uint8_t header[QUANTIZER_FILE_HEADER_BYTES];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, QUANTIZER_FILE_MAGIC, 4) != 0 ||
+        get_u16(header + 4) != QUANTIZER_FILE_VERSION) {
+        fprintf(stderr, "quantizer: %s is not a quantizer file.\n", filepath);
+        fclose(file);
+        return NULL;
+    }
+    int mode = get_u16(header + 6);
+    int num_features = (int)get_u32(header + 8);
+    int num_levels = (int)get_u32(header + 12);
+    if (mode != BINNING_MODE) {
+        fprintf(stderr, "quantizer: %s was fitted with binning mode %d, this build uses %s.\n", filepath, mode, quantizer_mode_name());
+        fclose(file);
+        return NULL;
+    }
+    if (num_features <= 0 || num_levels <= 0 || num_levels - 1 > (int)(quantized_level)~(quantized_level)0) {
+        fprintf(stderr, "quantizer: %s has invalid dimensions.\n", filepath);
+        fclose(file);
+        return NULL;
+    }
+
+    struct quantizer *quantizer = (struct quantizer *)calloc(1, sizeof(*quantizer));
+    size_t boundary_count = boundary_count_total_for(num_features, num_levels);
+    size_t center_count = center_count_total_for(num_features, num_levels);
+    size_t payload = (boundary_count + center_count) * 8u;
+    uint8_t *buffer = (uint8_t *)malloc(payload > 0 ? payload : 1);
+    if (quantizer) {
+        quantizer->state.num_features = num_features;
+        quantizer->state.num_levels = num_levels;
+    }
+    if (!quantizer || !buffer || allocate_quantizer_state(quantizer, num_features, num_levels) != 0 ||
+        fread(buffer, 1, payload, file) != payload) {
+        fprintf(stderr, "quantizer: failed to read %s.\n", filepath);
+        free(buffer);
+        fclose(file);
+        free_quantizer(quantizer);
+        return NULL;
+    }
+    fclose(file);
+
+    const uint8_t *in = buffer;
+    for (size_t i = 0; i < boundary_count; i++, in += 8) {
+        quantizer->state.boundaries[i] = get_f64(in);
+    }
+    for (size_t i = 0; i < center_count; i++, in += 8) {
+        quantizer->state.centers[i] = get_f64(in);
+    }
+    free(buffer);
+
+    if (install_level_lookup(quantizer) != 0) {
+        free_quantizer(quantizer);
+        return NULL;
+    }
+    quantizer->state.fitted = 1;
+#if BINNING_MODE == GA_REFINED_BINNING
+    quantizer->state.ga_refined_ready = 1;
+#endif
+    return quantizer;
+}
+
+/**
+ * @brief Returns the cuts of a fitted quantizer.
+ *
+ * The cuts are feature-major, `num_levels - 1` per feature, and stay owned by
+ * the quantizer.
+ *
+ * @return The cuts, or NULL if the quantizer is not fitted.
+ */
+const double *quantizer_cuts(const struct quantizer *quantizer, int *num_features, int *num_levels) {
+    if (!quantizer_fitted(quantizer)) {
+        return NULL;
+    }
+    if (num_features) {
+        *num_features = quantizer->state.num_features;
+    }
+    if (num_levels) {
+        *num_levels = quantizer->state.num_levels;
+    }
+    return quantizer->state.boundaries;
+}
+
+/**
+ * @brief Creates a quantizer that looks levels up in caller-owned cuts without copying them.
+ *
+ * Used for models mapped from a bundle file (model_bundle.h). The cuts must
+ * outlive the quantizer and are never written; refining such a quantizer fails.
+ * Only level lookup is available: the centers and fit diagnostics are absent.
+ *
+ * @param cuts Feature-major cuts, `num_features * (num_levels - 1)` values.
+ * @return The quantizer (release with free_quantizer()), or NULL on failure.
+ */
+struct quantizer *quantizer_wrap_cuts(const double *cuts, int num_features, int num_levels) {
+    if ((!cuts && num_levels > 1) || num_features <= 0 || num_levels <= 0 ||
+        num_levels - 1 > (int)(quantized_level)~(quantized_level)0) {
+        fprintf(stderr, "quantizer: invalid cuts to wrap.\n");
+        return NULL;
+    }
+    struct quantizer *quantizer = (struct quantizer *)calloc(1, sizeof(*quantizer));
+    if (!quantizer) {
+        fprintf(stderr, "quantizer: failed to allocate wrapped quantizer.\n");
+        return NULL;
+    }
+    quantizer->state.num_features = num_features;
+    quantizer->state.num_levels = num_levels;
+    quantizer->state.boundaries = (double *)cuts;
+    quantizer->state.borrowed_boundaries = 1;
+    if (install_level_lookup(quantizer) != 0) {
+        free_quantizer(quantizer);
+        return NULL;
+    }
+    quantizer->state.fitted = 1;
+#if BINNING_MODE == GA_REFINED_BINNING
+    quantizer->state.ga_refined_ready = 1;
+#endif
+    return quantizer;
+}
+
+void quantizer_clear(void) {
+    clear_quantizer(&g_quantizer);
+}
+
+int quantizer_is_fitted(void) {
+    return g_quantizer.state.fitted;
+}
+
+int quantizer_fit_from_training(double **training_data,
+                                const int *training_labels,
+                                int training_samples,
+                                int num_features,
+                                int num_levels) {
+    return fit_quantizer(&g_quantizer, training_data, training_labels, training_samples, num_features, num_levels);
+}
+
+#if BINNING_MODE == GA_REFINED_BINNING
+int quantizer_refine_from_flip_counts(const uint16_t *flip_counts, int genome_length) {
+    return quantizer_refine(&g_quantizer, flip_counts, genome_length);
+}
+#endif
+
 int get_signal_level(int feature_idx, double emg_value) {
-    return map_value_with_boundaries_checked(feature_idx, emg_value);
+    return map_value_with_boundaries_checked(&g_quantizer, feature_idx, emg_value);
+}
+
+void quantize_sample(const double *x, quantized_level *levels_out) {
+    quantizer_quantize_sample(&g_quantizer, x, levels_out);
+}
+
+int get_signal_level_i16(int feature_idx, int16_t code) {
+    return quantizer_get_signal_level_i16(&g_quantizer, feature_idx, code);
+}
+
+void quantize_sample_i16(const int16_t *x, quantized_level *levels_out) {
+    quantizer_quantize_sample_i16(&g_quantizer, x, levels_out);
+}
+
+int init_quantized_dataset(struct quantized_dataset *dataset,
+                           double **data,
+                           int num_samples,
+                           int num_features) {
+    return init_quantized_dataset_for(&g_quantizer, dataset, data, num_samples, num_features);
 }
 
 const char *quantizer_get_mode_name(void) {
     return quantizer_mode_name();
 }
-#if BINNING_MODE == KMEANS_1D_BINNING
-static int quantizer_export_centers_csv(const char *filepath) {
+#if BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING
+static int export_centers_csv(struct quantizer *quantizer, const char *filepath) {
     if (!filepath || filepath[0] == '\0') {
         return -1;
     }
-    if (!g_quantizer_state.fitted) {
+    if (!quantizer->state.fitted) {
         fprintf(stderr, "quantizer: center export requested before fit.\n");
         return -1;
     }
@@ -1757,18 +2937,18 @@ static int quantizer_export_centers_csv(const char *filepath) {
     fprintf(file,
             "#quantizer_centers,mode=%s,num_features=%d,num_levels=%d\n",
             quantizer_mode_name(),
-            g_quantizer_state.num_features,
-            g_quantizer_state.num_levels);
+            quantizer->state.num_features,
+            quantizer->state.num_levels);
     fprintf(file, "feature");
-    for (int k = 0; k < g_quantizer_state.num_levels; k++) {
+    for (int k = 0; k < quantizer->state.num_levels; k++) {
         fprintf(file, ",center_%03d", k);
     }
     fprintf(file, "\n");
 
-    for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
+    for (int feature = 0; feature < quantizer->state.num_features; feature++) {
         fprintf(file, "%d", feature);
-        for (int k = 0; k < g_quantizer_state.num_levels; k++) {
-            fprintf(file, ",%.17g", g_quantizer_state.centers[center_index(feature, k)]);
+        for (int k = 0; k < quantizer->state.num_levels; k++) {
+            fprintf(file, ",%.17g", quantizer->state.centers[center_index(quantizer, feature, k)]);
         }
         fprintf(file, "\n");
     }
@@ -1778,7 +2958,9 @@ static int quantizer_export_centers_csv(const char *filepath) {
 }
 #endif
 
-int quantizer_export_cuts_csv_for_dataset(int dataset) {
+static int export_cuts_csv(struct quantizer *quantizer, const char *filepath);
+
+static int export_cuts_csv_for_dataset(struct quantizer *quantizer, int dataset) {
     if (!QUANTIZER_EXPORT_ENABLED) {
         return 0;
     }
@@ -1793,11 +2975,11 @@ int quantizer_export_cuts_csv_for_dataset(int dataset) {
         return -1;
     }
 
-    if (quantizer_export_cuts_csv(cuts_filepath) != 0) {
+    if (export_cuts_csv(quantizer, cuts_filepath) != 0) {
         return -1;
     }
 
-#if BINNING_MODE == KMEANS_1D_BINNING
+#if BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING
     char centers_filepath[512];
     written = snprintf(centers_filepath,
                        sizeof(centers_filepath),
@@ -1808,7 +2990,7 @@ int quantizer_export_cuts_csv_for_dataset(int dataset) {
         return -1;
     }
 
-    if (quantizer_export_centers_csv(centers_filepath) != 0) {
+    if (export_centers_csv(quantizer, centers_filepath) != 0) {
         return -1;
     }
 #endif
@@ -1816,11 +2998,11 @@ int quantizer_export_cuts_csv_for_dataset(int dataset) {
     return 0;
 }
 
-int quantizer_export_cuts_csv(const char *filepath) {
+static int export_cuts_csv(struct quantizer *quantizer, const char *filepath) {
     if (!filepath || filepath[0] == '\0') {
         return -1;
     }
-    if (!g_quantizer_state.fitted) {
+    if (!quantizer->state.fitted) {
         fprintf(stderr, "quantizer: export requested before fit.\n");
         return -1;
     }
@@ -1832,67 +3014,67 @@ int quantizer_export_cuts_csv(const char *filepath) {
     }
 
 #if BINNING_MODE == UNIFORM_BINNING
-    int cut_count = g_quantizer_state.num_levels - 1;
+    int cut_count = quantizer->state.num_levels - 1;
     fprintf(file,
             "#quantizer,mode=%s,num_features=%d,num_levels=%d,total_refinements=0,non_finite_replacements=0,total_tree_splits=0,total_fallback_thresholds=0\n",
             quantizer_mode_name(),
-            g_quantizer_state.num_features,
-            g_quantizer_state.num_levels);
+            quantizer->state.num_features,
+            quantizer->state.num_levels);
     fprintf(file, "feature,refinement_count,tree_split_count,fallback_threshold_count,initial_interval_count");
     for (int k = 0; k < cut_count; k++) {
         fprintf(file, ",cut_%03d", k);
     }
     fprintf(file, "\n");
-    for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
+    for (int feature = 0; feature < quantizer->state.num_features; feature++) {
         fprintf(file, "%d,0,0,0,0", feature);
         for (int k = 0; k < cut_count; k++) {
-            fprintf(file, ",%.17g", g_quantizer_state.boundaries[boundary_index(feature, k)]);
+            fprintf(file, ",%.17g", quantizer->state.boundaries[boundary_index(quantizer, feature, k)]);
         }
         fprintf(file, "\n");
     }
-#elif BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING
-    int cut_count = g_quantizer_state.num_levels - 1;
+#elif BINNING_MODE == QUANTILE_BINNING || BINNING_MODE == KMEANS_1D_BINNING || BINNING_MODE == KMEANS_1D_OPTIMAL_BINNING || BINNING_MODE == DECISION_TREE_1D_BINNING || BINNING_MODE == CHIMERGE_BINNING
+    int cut_count = quantizer->state.num_levels - 1;
     fprintf(file,
             "#quantizer,mode=%s,num_features=%d,num_levels=%d,total_refinements=%d,non_finite_replacements=%d,total_tree_splits=%d,total_fallback_thresholds=%d\n",
             quantizer_mode_name(),
-            g_quantizer_state.num_features,
-            g_quantizer_state.num_levels,
-            g_quantizer_statistics.total_refinements,
-            g_quantizer_state.non_finite_replacements,
-            g_quantizer_statistics.total_tree_splits,
-            g_quantizer_statistics.total_fallback_thresholds);
+            quantizer->state.num_features,
+            quantizer->state.num_levels,
+            quantizer->stats.total_refinements,
+            quantizer->state.non_finite_replacements,
+            quantizer->stats.total_tree_splits,
+            quantizer->stats.total_fallback_thresholds);
     fprintf(file, "feature,refinement_count,tree_split_count,fallback_threshold_count,initial_interval_count");
     for (int k = 0; k < cut_count; k++) {
         fprintf(file, ",cut_%03d", k);
     }
     fprintf(file, "\n");
 
-    for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
+    for (int feature = 0; feature < quantizer->state.num_features; feature++) {
         fprintf(file,
                 "%d,%d,%d,%d,%d",
                 feature,
-                g_quantizer_statistics.refinement_counts[feature],
-                g_quantizer_statistics.tree_split_counts[feature],
-                g_quantizer_statistics.fallback_threshold_counts[feature],
-                g_quantizer_statistics.initial_interval_counts[feature]);
+                quantizer->stats.refinement_counts[feature],
+                quantizer->stats.tree_split_counts[feature],
+                quantizer->stats.fallback_threshold_counts[feature],
+                quantizer->stats.initial_interval_counts[feature]);
         for (int k = 0; k < cut_count; k++) {
-            fprintf(file, ",%.17g", g_quantizer_state.boundaries[boundary_index(feature, k)]);
+            fprintf(file, ",%.17g", quantizer->state.boundaries[boundary_index(quantizer, feature, k)]);
         }
         fprintf(file, "\n");
     }
 #elif BINNING_MODE == GA_REFINED_BINNING
-    int cut_count = g_quantizer_state.num_levels - 1;
+    int cut_count = quantizer->state.num_levels - 1;
     fprintf(file,
             "#quantizer,mode=%s,num_features=%d,num_levels=%d,total_refinements=%d,non_finite_replacements=%d,total_zero_width_intervals=%d,epsilon=%.17g,alpha=%.17g,refined_ready=%d\n",
             quantizer_mode_name(),
-            g_quantizer_state.num_features,
-            g_quantizer_state.num_levels,
-            g_quantizer_statistics.total_refinements,
-            g_quantizer_state.non_finite_replacements,
-            g_quantizer_statistics.total_zero_width_intervals,
+            quantizer->state.num_features,
+            quantizer->state.num_levels,
+            quantizer->stats.total_refinements,
+            quantizer->state.non_finite_replacements,
+            quantizer->stats.total_zero_width_intervals,
             (double)GA_BINNING_EPSILON,
             (double)GA_BINNING_ALPHA,
-            g_quantizer_state.ga_refined_ready);
+            quantizer->state.ga_refined_ready);
     fprintf(file, "feature,refinement_count,empty_bin_count,zero_width_interval_count");
     for (int k = 0; k < cut_count; k++) {
         fprintf(file, ",flip_%03d", k);
@@ -1905,41 +3087,41 @@ int quantizer_export_cuts_csv(const char *filepath) {
     }
     fprintf(file, "\n");
 
-    for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
+    for (int feature = 0; feature < quantizer->state.num_features; feature++) {
         fprintf(file,
                 "%d,%d,%d,%d",
                 feature,
-                g_quantizer_statistics.refinement_counts[feature],
-                g_quantizer_statistics.empty_bin_counts[feature],
-                g_quantizer_statistics.zero_width_interval_counts[feature]);
+                quantizer->stats.refinement_counts[feature],
+                quantizer->stats.empty_bin_counts[feature],
+                quantizer->stats.zero_width_interval_counts[feature]);
         for (int k = 0; k < cut_count; k++) {
-            fprintf(file, ",%u", (unsigned)g_quantizer_state.ga_refined_flip_counts[boundary_index(feature, k)]);
+            fprintf(file, ",%u", (unsigned)quantizer->state.ga_refined_flip_counts[boundary_index(quantizer, feature, k)]);
         }
         for (int k = 0; k < cut_count; k++) {
-            fprintf(file, ",%.17g", g_quantizer_state.ga_refined_transition_weights[boundary_index(feature, k)]);
+            fprintf(file, ",%.17g", quantizer->state.ga_refined_transition_weights[boundary_index(quantizer, feature, k)]);
         }
         for (int k = 0; k < cut_count; k++) {
-            fprintf(file, ",%.17g", g_quantizer_state.boundaries[boundary_index(feature, k)]);
+            fprintf(file, ",%.17g", quantizer->state.boundaries[boundary_index(quantizer, feature, k)]);
         }
         fprintf(file, "\n");
     }
 #else
-#error "Unsupported BINNING_MODE. Use UNIFORM_BINNING, QUANTILE_BINNING, KMEANS_1D_BINNING, DECISION_TREE_1D_BINNING, CHIMERGE_BINNING, or GA_REFINED_BINNING."
+#error "Unsupported BINNING_MODE. Use UNIFORM_BINNING, QUANTILE_BINNING, KMEANS_1D_BINNING, KMEANS_1D_OPTIMAL_BINNING, DECISION_TREE_1D_BINNING, CHIMERGE_BINNING, or GA_REFINED_BINNING."
 #endif
 
     fclose(file);
     return 0;
 }
 
-int quantizer_export_systemc_text(const char *filepath) {
+static int export_systemc_text(struct quantizer *quantizer, const char *filepath) {
     if (!filepath || filepath[0] == '\0') {
         return -1;
     }
-    if (!g_quantizer_state.fitted) {
+    if (!quantizer->state.fitted) {
         fprintf(stderr, "quantizer: SystemC export requested before fit.\n");
         return -1;
     }
-    if (g_quantizer_state.num_features <= 0 || g_quantizer_state.num_levels <= 0) {
+    if (quantizer->state.num_features <= 0 || quantizer->state.num_levels <= 0) {
         fprintf(stderr, "quantizer: invalid quantizer dimensions for SystemC export.\n");
         return -1;
     }
@@ -1953,15 +3135,15 @@ int quantizer_export_systemc_text(const char *filepath) {
     fprintf(file,
             "#systemc_quantizer mode=%s num_features=%d num_levels=%d layout=feature_major_cut_minor\n",
             quantizer_mode_name(),
-            g_quantizer_state.num_features,
-            g_quantizer_state.num_levels);
+            quantizer->state.num_features,
+            quantizer->state.num_levels);
 
     {
-        int cut_count = g_quantizer_state.num_levels - 1;
-        for (int feature = 0; feature < g_quantizer_state.num_features; feature++) {
+        int cut_count = quantizer->state.num_levels - 1;
+        for (int feature = 0; feature < quantizer->state.num_features; feature++) {
             fprintf(file, "%d", feature);
             for (int cut = 0; cut < cut_count; cut++) {
-                fprintf(file, " %.17g", g_quantizer_state.boundaries[boundary_index(feature, cut)]);
+                fprintf(file, " %.17g", quantizer->state.boundaries[boundary_index(quantizer, feature, cut)]);
             }
             fputc('\n', file);
         }
@@ -1970,3 +3152,15 @@ int quantizer_export_systemc_text(const char *filepath) {
     fclose(file);
     return 0;
 }
+
+int quantizer_export_cuts_csv_for_dataset(int dataset) {
+    return export_cuts_csv_for_dataset(&g_quantizer, dataset);
+}
+
+int quantizer_export_cuts_csv(const char *filepath) {
+    return export_cuts_csv(&g_quantizer, filepath);
+}
+
+int quantizer_export_systemc_text(const char *filepath) {
+    return export_systemc_text(&g_quantizer, filepath);
+}
@@ -2,6 +2,8 @@
 #define QUANTIZER_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include "sample_matrix.h"
 
 #ifdef HAND_EMG
 #include "../hand/configHand.h"
@@ -13,6 +15,57 @@
 #error "No model type defined. Please define HAND_EMG, FOOT_EMG, or CUSTOM."
 #endif
 
+#ifndef QUANTIZER_I16_FULL_SCALE
+#define QUANTIZER_I16_FULL_SCALE 32768 // int16 ADC code that stands for the input value 1.0 (Q15)
+#endif
+
+#if NUM_LEVELS <= 256
+typedef uint8_t quantized_level;
+#else
+typedef uint16_t quantized_level;
+#endif
+
+/**
+ * @brief A dataset mapped to signal levels once by the fitted quantizer.
+ *
+ * Levels are stored as a contiguous row-major `[num_samples][num_features]` matrix,
+ * so repeated training/evaluation passes over the same data (e.g. every GA
+ * candidate) skip `get_signal_level` and touch 8x (uint8) less input memory than
+ * the `double **` rows. The cache is only valid for the quantizer it was built
+ * with; rebuild it after refitting.
+ */
+struct quantized_dataset {
+    quantized_level *levels;
+    int num_samples;
+    int num_features;
+};
+
+/**
+ * @brief A fitted quantizer (cuts, centers and fit diagnostics).
+ *
+ * Opaque handle: quantizer_fit() returns an independent instance, so several
+ * models can quantize with their own cuts in one process. The global API
+ * (`quantizer_fit_from_training`, `get_signal_level`, ...) is a thin wrapper
+ * around the instance returned by quantizer_global().
+ */
+struct quantizer;
+
+/**
+ * @brief Binary quantizer file written by quantizer_save().
+ *
+ * All fields are little endian: magic "HDCQ", uint16 version, uint16
+ * BINNING_MODE, uint32 num_features and num_levels, then
+ * `num_features * (num_levels - 1)` float64 cuts and `num_features * num_levels`
+ * float64 centers, both feature-major.
+ */
+#define QUANTIZER_FILE_MAGIC "HDCQ"
+#define QUANTIZER_FILE_VERSION 1
+#define QUANTIZER_FILE_HEADER_BYTES 16
+
+static inline const quantized_level *quantized_dataset_row(const struct quantized_dataset *dataset, int sample) {
+    return dataset->levels + (size_t)sample * (size_t)dataset->num_features;
+}
+
 int quantizer_fit_from_training(double **training_data,
                                 const int *training_labels,
                                 int training_samples,
@@ -22,11 +75,48 @@ int quantizer_fit_from_training(double **training_data,
 int quantizer_refine_from_flip_counts(const uint16_t *flip_counts, int genome_length);
 #endif
 int get_signal_level(int feature_idx, double emg_value);
+void quantize_sample(const double *x, quantized_level *levels_out);
+int get_signal_level_i16(int feature_idx, int16_t code);
+void quantize_sample_i16(const int16_t *x, quantized_level *levels_out);
 const char *quantizer_get_mode_name(void);
 int quantizer_export_cuts_csv_for_dataset(int dataset);
 int quantizer_export_cuts_csv(const char *filepath);
 int quantizer_export_systemc_text(const char *filepath);
 void quantizer_clear(void);
 int quantizer_is_fitted(void);
+int init_quantized_dataset(struct quantized_dataset *dataset,
+                           double **data,
+                           int num_samples,
+                           int num_features);
+void free_quantized_dataset(struct quantized_dataset *dataset);
+
+struct quantizer *quantizer_fit(double **training_data,
+                                const int *training_labels,
+                                int training_samples,
+                                int num_features,
+                                int num_levels);
+void free_quantizer(struct quantizer *quantizer);
+struct quantizer *quantizer_global(void);
+int quantizer_fitted(const struct quantizer *quantizer);
+#if BINNING_MODE == GA_REFINED_BINNING
+int quantizer_refine(struct quantizer *quantizer, const uint16_t *flip_counts, int genome_length);
+#endif
+int quantizer_get_signal_level(struct quantizer *quantizer, int feature_idx, double emg_value);
+void quantizer_quantize_sample(struct quantizer *quantizer, const double *x, quantized_level *levels_out);
+void quantizer_quantize_sample_f(struct quantizer *quantizer, const float *x, quantized_level *levels_out);
+int quantizer_get_signal_level_i16(struct quantizer *quantizer, int feature_idx, int16_t code);
+void quantizer_quantize_sample_i16(struct quantizer *quantizer, const int16_t *x, quantized_level *levels_out);
+int init_quantized_dataset_for(struct quantizer *quantizer,
+                               struct quantized_dataset *dataset,
+                               double **data,
+                               int num_samples,
+                               int num_features);
+int init_quantized_dataset_from_matrix(struct quantizer *quantizer,
+                                       struct quantized_dataset *dataset,
+                                       const struct sample_matrix *samples);
+int quantizer_save(const struct quantizer *quantizer, const char *filepath);
+struct quantizer *quantizer_load(const char *filepath);
+const double *quantizer_cuts(const struct quantizer *quantizer, int *num_features, int *num_levels);
+struct quantizer *quantizer_wrap_cuts(const double *cuts, int num_features, int num_levels);
 
 #endif
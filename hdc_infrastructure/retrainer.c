@@ -0,0 +1,329 @@
+/**
+ * @file retrainer.c
+ * @brief Iterative (perceptron-style) retraining on cached training hypervectors.
+ *
+ * @details
+ * Single-pass majority training weighs every n-gram equally, however easy it
+ * is. Retraining repeats passes over the training set and only moves the
+ * classes where the model is wrong: every misclassified n-gram votes for its
+ * own class and against the predicted one. The n-grams are encoded once into an
+ * `encoded_training_set`, so an epoch is one parallel batched classification
+ * (`classify_batch`) plus one `update_assoc_mem_batch` call that adds the votes
+ * to the class counters and re-thresholds the touched classes. In binary mode a
+ * vote against an n-gram adds its complement, which is subtracting it from the
+ * bipolar vote sum the majority threshold decides on.
+ */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "retrainer.h"
+#include "operations.h"
+#include "trainer.h"
+#include "workspace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static double now_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Encodes the training n-grams of a quantized timeseries once.
+ *
+ * Selects exactly the n-grams the binary `train_model_timeseries_quantized`
+ * counts: the n-gram state restarts at every label change, samples with a
+ * label outside [0, NUM_CLASSES) are skipped and so, as in the trainer's sweep,
+ * is the last sample. The samples are split into shards that are encoded in
+ * parallel under OpenMP, each rebuilding its n-gram state from the samples
+ * before its range as the trainer does.
+ *
+ * @param dataset Quantized training samples (NUM_FEATURES levels per row).
+ * @param training_labels Class label of every dataset row.
+ * @param enc Encoder of the model.
+ * @param set Receives the encoded n-grams; release with `free_encoded_training_set`.
+ * @return 0 on success, -1 on invalid arguments or allocation failure.
+ */
+int encode_training_set(const struct quantized_dataset *dataset, const int *training_labels,
+                        struct encoder *enc, struct encoded_training_set *set) {
+    memset(set, 0, sizeof(*set));
+#if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN
+    (void)dataset;
+    (void)training_labels;
+    (void)enc;
+    fprintf(stderr, "encode_training_set: the KRISCHAN rolling window is not supported.\n");
+    return -1;
+#else
+    if (dataset == NULL || dataset->num_features != NUM_FEATURES || training_labels == NULL) {
+        fprintf(stderr, "encode_training_set: invalid training dataset.\n");
+        return -1;
+    }
+    int samples = dataset->num_samples - 1;
+    if (samples < 1) {
+        return 0;
+    }
+    set->vectors = create_vector_slab(samples, &set->storage);
+    set->hvs = (Vector **)malloc((size_t)samples * sizeof(Vector *));
+    set->labels = (int *)malloc((size_t)samples * sizeof(int));
+    char *ready = (char *)calloc((size_t)samples, 1);
+    if (!set->vectors || !set->hvs || !set->labels || !ready) {
+        fprintf(stderr, "encode_training_set: allocation failed.\n");
+        free(ready);
+        free_encoded_training_set(set);
+        return -1;
+    }
+
+    int shards = 1;
+#ifdef _OPENMP
+    shards = omp_get_max_threads();
+#endif
+    if (shards > samples / TRAIN_MIN_SHARD_SAMPLES) {
+        shards = samples / TRAIN_MIN_SHARD_SAMPLES;
+    }
+    if (shards < 1) {
+        shards = 1;
+    }
+    int failed = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(| : failed) if (shards > 1)
+#endif
+    for (int shard = 0; shard < shards; shard++) {
+        int begin = (int)((long long)samples * shard / shards);
+        int end = (int)((long long)samples * (shard + 1) / shards);
+        int warmup = begin;
+        while (warmup > 0 && begin - warmup < N_GRAM_SIZE - 1 && training_labels[warmup] == training_labels[warmup - 1]) {
+            warmup--;
+        }
+        struct hdc_workspace ws;
+        init_hdc_workspace(&ws);
+        for (int sample = warmup; sample < end; sample++) {
+            if (sample > warmup && training_labels[sample] != training_labels[sample - 1]) {
+                reset_hdc_workspace(&ws);
+            }
+            // Warm-up samples belong to the previous shard: encode them into scratch.
+            Vector *ngram = sample >= begin ? set->vectors[sample] : ws.sample;
+            int pushed = push_ngram_encoder_levels(enc, &ws.ngram_state, quantized_dataset_row(dataset, sample), ngram);
+            if (pushed < 0) {
+                failed = 1;
+                break;
+            }
+            if (sample >= begin) {
+                int class_id = training_labels[sample];
+                ready[sample] = pushed && class_id >= 0 && class_id < NUM_CLASSES;
+            }
+        }
+        free_hdc_workspace(&ws);
+    }
+    if (failed) {
+        fprintf(stderr, "encode_training_set: failed to encode the training n-grams.\n");
+        free(ready);
+        free_encoded_training_set(set);
+        return -1;
+    }
+
+    for (int sample = 0; sample < samples; sample++) {
+        if (ready[sample]) {
+            set->hvs[set->count] = set->vectors[sample];
+            set->labels[set->count] = training_labels[sample];
+            set->count++;
+        }
+    }
+    free(ready);
+    return 0;
+#endif
+}
+
+/**
+ * @brief Same as `encode_training_set`, quantizing the raw samples with the encoder's quantizer first.
+ */
+int encode_training_set_timeseries(double **training_data, int *training_labels, int training_samples,
+                                   struct encoder *enc, struct encoded_training_set *set) {
+    struct quantized_dataset dataset;
+    if (init_quantized_dataset_for(enc->quantizer, &dataset, training_data, training_samples, NUM_FEATURES) != 0) {
+        fprintf(stderr, "Failed to quantize training data.\n");
+        memset(set, 0, sizeof(*set));
+        return -1;
+    }
+    int result = encode_training_set(&dataset, training_labels, enc, set);
+    free_quantized_dataset(&dataset);
+    return result;
+}
+
+void free_encoded_training_set(struct encoded_training_set *set) {
+    if (set->vectors) {
+        free_vector_slab(set->vectors, set->storage);
+    }
+    free(set->hvs);
+    free(set->labels);
+    memset(set, 0, sizeof(*set));
+}
+
+/**
+ * @brief Trains the associative memory from cached n-grams.
+ *
+ * In binary mode this gives the model `train_model_timeseries` builds from the
+ * same data, and the class counters are kept in the associative memory (see
+ * `keep_counters`), ready for `retrain_model` and `update_assoc_mem`.
+ *
+ * @param set Encoded training n-grams.
+ * @param assoc_mem An initialized associative memory; its classes are replaced.
+ */
+void train_model_encoded(const struct encoded_training_set *set, struct associative_memory *assoc_mem) {
+    for (int class_id = 0; class_id < assoc_mem->num_classes; class_id++) {
+        vector_zero(assoc_mem->class_vectors[class_id]);
+        assoc_mem->counts[class_id] = 0;
+    }
+#if BIPOLAR_MODE
+    for (int i = 0; i < set->count; i++) {
+        add_to_assoc_mem(assoc_mem, set->hvs[i], set->labels[i]);
+    }
+    if (NORMALIZE) {
+        normalize(assoc_mem);
+    }
+#else
+    size_t counter_words = (size_t)assoc_mem->num_classes * vector_storage_count();
+    int *weights = (int *)malloc((size_t)(set->count > 0 ? set->count : 1) * sizeof(int));
+    free(assoc_mem->counters);
+    assoc_mem->counters = (uint64_t *)calloc(counter_words, sizeof(uint64_t));
+    assoc_mem->counter_nbits = 1;
+    assoc_mem->keep_counters = true;
+    if (!weights || !assoc_mem->counters) {
+        fprintf(stderr, "Failed to allocate training counters.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < set->count; i++) {
+        weights[i] = 1;
+    }
+    if (update_assoc_mem_batch(assoc_mem, set->hvs, set->labels, weights, set->count) < 0) {
+        fprintf(stderr, "Failed to train from the encoded training set.\n");
+        exit(EXIT_FAILURE);
+    }
+    free(weights);
+    for (int class_id = 0; class_id < assoc_mem->num_classes; class_id++) {
+        if (assoc_mem->counts[class_id] == 0) {
+            // An empty class thresholds at zero, as in the trainer.
+            bit_counter_threshold(assoc_mem->counters + (size_t)class_id * vector_storage_count() * assoc_mem->counter_nbits,
+                                  assoc_mem->counter_nbits, 0, assoc_mem->class_vectors[class_id]);
+        }
+    }
+#if ASSOC_MEM_PRUNE_DIMENSIONS
+    prune_assoc_mem(assoc_mem);
+#endif
+#endif
+    if (output_mode >= OUTPUT_DEBUG) {
+        print_class_vectors(assoc_mem);
+    }
+}
+
+/**
+ * @brief Retrains the associative memory for up to `epochs` passes over cached n-grams.
+ *
+ * Every epoch classifies all n-grams with the current model (in parallel
+ * blocks of RETRAIN_CLASSIFY_BLOCK) and then applies, in one batch, RETRAIN_WEIGHT
+ * votes for the true class and against the predicted class of every
+ * misclassified n-gram. Training stops early once an epoch has no errors.
+ *
+ * In binary mode the model is first trained from `set` with
+ * `train_model_encoded` unless the associative memory kept its training
+ * counters; in bipolar mode the current class vectors are refined directly.
+ *
+ * @param assoc_mem The model to refine.
+ * @param set Encoded training n-grams.
+ * @param epochs Maximum number of epochs.
+ * @param history Optional (NULL): receives the statistics of every epoch run.
+ * @return Number of epochs run, or -1 on invalid arguments or allocation failure.
+ */
+int retrain_model(struct associative_memory *assoc_mem, const struct encoded_training_set *set,
+                  int epochs, struct retrain_epoch_stats *history) {
+    if (set == NULL || set->count <= 0 || epochs < 0) {
+        fprintf(stderr, "retrain_model: invalid training set or epochs.\n");
+        return -1;
+    }
+#if !BIPOLAR_MODE
+    if (assoc_mem->counters == NULL) {
+        train_model_encoded(set, assoc_mem);
+    }
+#endif
+    int n = set->count;
+    int *predicted = (int *)malloc((size_t)n * sizeof(int));
+    Vector **vote_hvs = (Vector **)malloc((size_t)n * 2 * sizeof(Vector *));
+    int *vote_classes = (int *)malloc((size_t)n * 2 * sizeof(int));
+    int *vote_weights = (int *)malloc((size_t)n * 2 * sizeof(int));
+    if (!predicted || !vote_hvs || !vote_classes || !vote_weights) {
+        fprintf(stderr, "retrain_model: allocation failed.\n");
+        free(predicted);
+        free(vote_hvs);
+        free(vote_classes);
+        free(vote_weights);
+        return -1;
+    }
+
+    int blocks = (n + RETRAIN_CLASSIFY_BLOCK - 1) / RETRAIN_CLASSIFY_BLOCK;
+    int epoch = 0;
+    while (epoch < epochs) {
+        double start = now_seconds();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (blocks > 1)
+#endif
+        for (int block = 0; block < blocks; block++) {
+            int first = block * RETRAIN_CLASSIFY_BLOCK;
+            int count = n - first < RETRAIN_CLASSIFY_BLOCK ? n - first : RETRAIN_CLASSIFY_BLOCK;
+            classify_batch(assoc_mem, set->hvs + first, count, predicted + first, NULL);
+        }
+
+        int errors = 0;
+        int votes = 0;
+        for (int i = 0; i < n; i++) {
+            if (predicted[i] == set->labels[i]) {
+                continue;
+            }
+            errors++;
+            vote_hvs[votes] = set->hvs[i];
+            vote_classes[votes] = set->labels[i];
+            vote_weights[votes++] = RETRAIN_WEIGHT;
+            if (predicted[i] >= 0) {
+                vote_hvs[votes] = set->hvs[i];
+                vote_classes[votes] = predicted[i];
+                vote_weights[votes++] = -RETRAIN_WEIGHT;
+            }
+        }
+        int changed = 0;
+        if (votes > 0) {
+            changed = update_assoc_mem_batch(assoc_mem, vote_hvs, vote_classes, vote_weights, votes);
+            if (changed < 0) {
+                epoch = -1;
+                break;
+            }
+        }
+
+        struct retrain_epoch_stats stats;
+        stats.epoch = epoch;
+        stats.errors = errors;
+        stats.accuracy = 1.0 - (double)errors / n;
+        stats.changed_words = changed;
+        stats.seconds = now_seconds() - start;
+        if (history) {
+            history[epoch] = stats;
+        }
+        if (output_mode >= OUTPUT_DETAILED) {
+            printf("Retraining epoch %d: training accuracy %.2f%%, %d errors, %d words changed, %.2f ms\n",
+                   epoch, stats.accuracy * 100.0, errors, changed, stats.seconds * 1e3);
+        }
+        epoch++;
+        if (errors == 0) {
+            break;
+        }
+    }
+
+    free(predicted);
+    free(vote_hvs);
+    free(vote_classes);
+    free(vote_weights);
+    return epoch;
+}
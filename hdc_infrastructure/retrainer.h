@@ -0,0 +1,69 @@
+#ifndef RETRAINER_H
+#define RETRAINER_H
+
+#ifdef HAND_EMG
+#include "../hand/configHand.h"
+#elif defined(FOOT_EMG)
+#include "../foot/configFoot.h"
+#elif defined(CUSTOM)
+#include "../customModel/configCustom.h"
+#else
+#error "No EMG type defined. Please define HAND_EMG or FOOT_EMG."
+#endif
+
+#include "assoc_mem.h"
+#include "encoder.h"
+#include "quantizer.h"
+
+#ifndef RETRAIN_EPOCHS
+#define RETRAIN_EPOCHS 10 // default number of retraining epochs
+#endif
+#ifndef RETRAIN_WEIGHT
+#define RETRAIN_WEIGHT 1 // votes a misclassified sample moves toward its class and away from the prediction
+#endif
+#ifndef RETRAIN_CLASSIFY_BLOCK
+#define RETRAIN_CLASSIFY_BLOCK 256 // cached hypervectors per parallel classify_batch call
+#endif
+
+/**
+ * @brief Training n-grams encoded once and kept for repeated passes.
+ *
+ * - **count**: Number of encoded n-grams.
+ * - **hvs**: The n-gram hypervectors, in sample order.
+ * - **labels**: Class of every n-gram.
+ * - **vectors**, **storage**: Slab backing `hvs`.
+ */
+struct encoded_training_set {
+    int count;
+    Vector **hvs;
+    int *labels;
+    Vector **vectors;
+    vector_element *storage;
+};
+
+/**
+ * @brief Progress of one retraining epoch.
+ *
+ * - **errors**, **accuracy**: Misclassified training n-grams and training accuracy
+ *   of the model the epoch started with.
+ * - **changed_words**: Class vector storage words the epoch's update changed.
+ * - **seconds**: Wall time of the epoch (classification and update).
+ */
+struct retrain_epoch_stats {
+    int epoch;
+    int errors;
+    double accuracy;
+    int changed_words;
+    double seconds;
+};
+
+int encode_training_set(const struct quantized_dataset *dataset, const int *training_labels,
+                        struct encoder *enc, struct encoded_training_set *set);
+int encode_training_set_timeseries(double **training_data, int *training_labels, int training_samples,
+                                   struct encoder *enc, struct encoded_training_set *set);
+void free_encoded_training_set(struct encoded_training_set *set);
+void train_model_encoded(const struct encoded_training_set *set, struct associative_memory *assoc_mem);
+int retrain_model(struct associative_memory *assoc_mem, const struct encoded_training_set *set,
+                  int epochs, struct retrain_epoch_stats *history);
+
+#endif // RETRAINER_H
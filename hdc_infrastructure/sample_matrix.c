@@ -0,0 +1,100 @@
+/**
+ * @file sample_matrix.c
+ * @brief Contiguous float32 sample matrices and their `double **` adapters.
+ */
+#include "sample_matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Allocates a zeroed `rows x cols` matrix with `stride == cols`.
+ *
+ * @return 0 on success, -1 on allocation failure (the matrix is left empty).
+ */
+int init_sample_matrix(struct sample_matrix *matrix, size_t rows, size_t cols) {
+    memset(matrix, 0, sizeof(*matrix));
+    size_t count = rows * cols;
+    float *storage = (float *)calloc(count > 0 ? count : 1, sizeof(float));
+    if (!storage) {
+        fprintf(stderr, "sample matrix: failed to allocate %zu x %zu floats.\n", rows, cols);
+        return -1;
+    }
+    matrix->data = storage;
+    matrix->rows = rows;
+    matrix->cols = cols;
+    matrix->stride = cols;
+    matrix->storage = storage;
+    return 0;
+}
+
+void free_sample_matrix(struct sample_matrix *matrix) {
+    if (!matrix) {
+        return;
+    }
+    free(matrix->storage);
+    memset(matrix, 0, sizeof(*matrix));
+}
+
+/**
+ * @brief Views `rows` rows of `matrix`, starting at `first` and taking every `step`-th row.
+ *
+ * No data is copied; the view borrows the parent's storage.
+ */
+void sample_matrix_view(const struct sample_matrix *matrix, size_t first, size_t step, size_t rows,
+                        struct sample_matrix *view) {
+    view->data = matrix->data + first * matrix->stride;
+    view->rows = rows;
+    view->cols = matrix->cols;
+    view->stride = matrix->stride * step;
+    view->storage = NULL;
+}
+
+/**
+ * @brief Copies `double **` rows into a new matrix (rounding to float32).
+ *
+ * @return 0 on success, -1 on invalid input or allocation failure.
+ */
+int sample_matrix_from_rows(struct sample_matrix *matrix, double **rows, size_t num_rows, size_t cols) {
+    if ((!rows && num_rows > 0) || init_sample_matrix(matrix, num_rows, cols) != 0) {
+        return -1;
+    }
+    for (size_t row = 0; row < num_rows; row++) {
+        float *out = sample_matrix_row(matrix, row);
+        for (size_t col = 0; col < cols; col++) {
+            out[col] = (float)rows[row][col];
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Adapter for the `double **` API: copies the matrix into separately allocated rows.
+ *
+ * The result is released with the data readers' `freeData`.
+ *
+ * @return The rows, or NULL on allocation failure.
+ */
+double **sample_matrix_to_rows(const struct sample_matrix *matrix) {
+    double **rows = (double **)malloc((matrix->rows > 0 ? matrix->rows : 1) * sizeof(double *));
+    if (!rows) {
+        fprintf(stderr, "sample matrix: failed to allocate row pointers.\n");
+        return NULL;
+    }
+    for (size_t row = 0; row < matrix->rows; row++) {
+        rows[row] = (double *)malloc((matrix->cols > 0 ? matrix->cols : 1) * sizeof(double));
+        if (!rows[row]) {
+            fprintf(stderr, "sample matrix: failed to allocate row %zu.\n", row);
+            for (size_t done = 0; done < row; done++) {
+                free(rows[done]);
+            }
+            free(rows);
+            return NULL;
+        }
+        const float *in = sample_matrix_row(matrix, row);
+        for (size_t col = 0; col < matrix->cols; col++) {
+            rows[row][col] = (double)in[col];
+        }
+    }
+    return rows;
+}
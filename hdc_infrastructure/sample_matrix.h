@@ -0,0 +1,34 @@
+#ifndef SAMPLE_MATRIX_H
+#define SAMPLE_MATRIX_H
+
+#include <stddef.h>
+
+/**
+ * @brief Raw samples as one contiguous float32 matrix.
+ *
+ * Row `i` starts at `data + i * stride`; `stride >= cols`, so a strided view
+ * (e.g. every DOWNSAMPLE-th row) shares the parent's storage instead of copying
+ * rows. Compared with the `double **` rows this halves the footprint and turns
+ * sample iteration into linear streaming. Matrices own `storage`; views leave
+ * it NULL and must not outlive their parent.
+ */
+struct sample_matrix {
+    float *data;     /**< First element of row 0. */
+    size_t rows;     /**< Number of samples. */
+    size_t cols;     /**< Values per sample. */
+    size_t stride;   /**< Floats between consecutive rows. */
+    float *storage;  /**< Owned allocation, NULL for views. */
+};
+
+static inline float *sample_matrix_row(const struct sample_matrix *matrix, size_t row) {
+    return matrix->data + row * matrix->stride;
+}
+
+int init_sample_matrix(struct sample_matrix *matrix, size_t rows, size_t cols);
+void free_sample_matrix(struct sample_matrix *matrix);
+void sample_matrix_view(const struct sample_matrix *matrix, size_t first, size_t step, size_t rows,
+                        struct sample_matrix *view);
+int sample_matrix_from_rows(struct sample_matrix *matrix, double **rows, size_t num_rows, size_t cols);
+double **sample_matrix_to_rows(const struct sample_matrix *matrix);
+
+#endif // SAMPLE_MATRIX_H
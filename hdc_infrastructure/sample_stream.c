@@ -0,0 +1,147 @@
+/**
+ * @file sample_stream.c
+ * @brief Chunked, double-buffered delivery of a `sample_source`.
+ *
+ * @details
+ * The stream owns two chunk buffers. `dataset_stream_next_chunk` hands out one
+ * of them and, with prefetching enabled, immediately starts a background
+ * thread that reads the following chunk into the other, so disk I/O and
+ * parsing overlap the caller's encoding of the current chunk.
+ */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "sample_stream.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct stream_buffer {
+    float *samples;
+    int *labels;
+    long rows;
+};
+
+struct dataset_stream {
+    struct sample_source source;
+    size_t chunk_rows;
+    int prefetch;
+    struct stream_buffer buffers[2];
+    int current;        /**< Buffer handed out by the last `next_chunk`. */
+    int in_flight;      /**< A prefetch thread is filling the other buffer. */
+    pthread_t thread;
+};
+
+static void fill_buffer(struct dataset_stream *stream, struct stream_buffer *buffer) {
+    buffer->rows = stream->source.read(stream->source.context, buffer->samples, buffer->labels, stream->chunk_rows);
+}
+
+static void *prefetch_main(void *arg) {
+    struct dataset_stream *stream = (struct dataset_stream *)arg;
+    fill_buffer(stream, &stream->buffers[1 - stream->current]);
+    return NULL;
+}
+
+static void wait_prefetch(struct dataset_stream *stream) {
+    if (stream->in_flight) {
+        pthread_join(stream->thread, NULL);
+        stream->in_flight = 0;
+    }
+}
+
+/**
+ * @brief Opens a chunked stream over `source`; the stream takes ownership of the source.
+ *
+ * @param chunk_rows Samples per chunk (0 selects DATASET_STREAM_CHUNK_ROWS).
+ * @param prefetch Non-zero reads the next chunk on a background thread.
+ * @return The stream, or NULL on allocation failure (the source is closed).
+ */
+struct dataset_stream *dataset_stream_open(struct sample_source source, size_t chunk_rows, int prefetch) {
+    if (chunk_rows == 0) {
+        chunk_rows = DATASET_STREAM_CHUNK_ROWS;
+    }
+    struct dataset_stream *stream = (struct dataset_stream *)calloc(1, sizeof(*stream));
+    if (stream) {
+        stream->source = source;
+        stream->chunk_rows = chunk_rows;
+        stream->prefetch = prefetch;
+        for (int i = 0; i < 2; i++) {
+            stream->buffers[i].samples = (float *)malloc(chunk_rows * source.cols * sizeof(float));
+            stream->buffers[i].labels = (int *)malloc(chunk_rows * sizeof(int));
+        }
+    }
+    if (!stream || !stream->buffers[0].samples || !stream->buffers[0].labels ||
+        !stream->buffers[1].samples || !stream->buffers[1].labels) {
+        fprintf(stderr, "dataset stream: failed to allocate chunk buffers.\n");
+        if (stream) {
+            dataset_stream_close(stream);
+        } else if (source.close) {
+            source.close(source.context);
+        }
+        return NULL;
+    }
+    return stream;
+}
+
+/**
+ * @brief Delivers the next chunk.
+ *
+ * `chunk` becomes a view onto the stream's buffer and `labels` points at the
+ * chunk's labels; both stay valid until the next call (or reset/close).
+ *
+ * @return Rows in the chunk, 0 at the end of the data, -1 on a read error.
+ */
+long dataset_stream_next_chunk(struct dataset_stream *stream, struct sample_matrix *chunk, const int **labels) {
+    int next = 1 - stream->current;
+    if (stream->in_flight) {
+        wait_prefetch(stream);
+    } else {
+        fill_buffer(stream, &stream->buffers[next]);
+    }
+    stream->current = next;
+
+    struct stream_buffer *buffer = &stream->buffers[next];
+    chunk->data = buffer->samples;
+    chunk->rows = buffer->rows > 0 ? (size_t)buffer->rows : 0;
+    chunk->cols = stream->source.cols;
+    chunk->stride = stream->source.cols;
+    chunk->storage = NULL;
+    *labels = buffer->labels;
+
+    if (buffer->rows > 0 && stream->prefetch) {
+        stream->in_flight = pthread_create(&stream->thread, NULL, prefetch_main, stream) == 0;
+    }
+    return buffer->rows;
+}
+
+/**
+ * @brief Restarts the stream at the first sample.
+ *
+ * @return 0 on success, -1 if the source cannot rewind.
+ */
+int dataset_stream_reset(struct dataset_stream *stream) {
+    wait_prefetch(stream);
+    stream->buffers[0].rows = 0;
+    stream->buffers[1].rows = 0;
+    return stream->source.rewind ? stream->source.rewind(stream->source.context) : -1;
+}
+
+size_t dataset_stream_chunk_rows(const struct dataset_stream *stream) {
+    return stream->chunk_rows;
+}
+
+void dataset_stream_close(struct dataset_stream *stream) {
+    if (!stream) {
+        return;
+    }
+    wait_prefetch(stream);
+    if (stream->source.close) {
+        stream->source.close(stream->source.context);
+    }
+    for (int i = 0; i < 2; i++) {
+        free(stream->buffers[i].samples);
+        free(stream->buffers[i].labels);
+    }
+    free(stream);
+}
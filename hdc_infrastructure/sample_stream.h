@@ -0,0 +1,42 @@
+#ifndef SAMPLE_STREAM_H
+#define SAMPLE_STREAM_H
+
+#include <stddef.h>
+#include "sample_matrix.h"
+
+#ifndef DATASET_STREAM_CHUNK_ROWS
+#define DATASET_STREAM_CHUNK_ROWS 65536 // samples per chunk of a streamed dataset
+#endif
+
+/**
+ * @brief A sequential reader of labelled samples (e.g. a CSV file or its binary cache).
+ *
+ * `read` fills up to `max_rows` rows of `cols` floats (densely packed) and
+ * their labels and returns the number of rows read, 0 at the end of the data
+ * or -1 on error. `rewind` restarts at the first sample; `close` releases the
+ * context.
+ */
+struct sample_source {
+    void *context;
+    size_t cols;
+    long (*read)(void *context, float *samples, int *labels, size_t max_rows);
+    int (*rewind)(void *context);
+    void (*close)(void *context);
+};
+
+/**
+ * @brief A dataset delivered in bounded chunks instead of loaded as a whole.
+ *
+ * Memory is two chunk buffers, independent of the recording length. With
+ * prefetching, the next chunk is read on a background thread while the
+ * caller encodes the current one.
+ */
+struct dataset_stream;
+
+struct dataset_stream *dataset_stream_open(struct sample_source source, size_t chunk_rows, int prefetch);
+long dataset_stream_next_chunk(struct dataset_stream *stream, struct sample_matrix *chunk, const int **labels);
+int dataset_stream_reset(struct dataset_stream *stream);
+size_t dataset_stream_chunk_rows(const struct dataset_stream *stream);
+void dataset_stream_close(struct dataset_stream *stream);
+
+#endif // SAMPLE_STREAM_H
@@ -0,0 +1,242 @@
+/**
+ * @file timestamp_cache.c
+ * @brief Encode-once cache of timestamp hypervectors (see timestamp_cache.h).
+ *
+ * @details
+ * The cache lives in one aligned slab, or, above TIMESTAMP_CACHE_MAX_MEMORY_BYTES,
+ * in a file mapping so the kernel can page it out instead of swapping. With
+ * TIMESTAMP_CACHE_DIR set the mapping is a file named after the fingerprint
+ * that later runs (e.g. a sweep over N_GRAM_SIZE or WINDOW builds) map
+ * read-only instead of encoding again. A new file is written under a
+ * temporary name and renamed once complete, so concurrent runs never map a
+ * partial cache.
+ */
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+#include "timestamp_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define TIMESTAMP_CACHE_MAGIC "HDCTSC01"
+#define TIMESTAMP_CACHE_HEADER_BYTES 4096 // page-aligned offset of the timestamps in a cache file
+
+struct timestamp_cache_header {
+    char magic[8];
+    uint64_t fingerprint;
+    uint64_t num_samples;
+    uint64_t stride_bytes;
+};
+
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t bytes) {
+    const unsigned char *p = (const unsigned char *)data;
+    size_t words = bytes / sizeof(uint64_t);
+    for (size_t i = 0; i < words; i++) {
+        uint64_t word;
+        memcpy(&word, p + i * sizeof(uint64_t), sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ull;
+    }
+    for (size_t i = words * sizeof(uint64_t); i < bytes; i++) {
+        hash = (hash ^ p[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static uint64_t hash_item_memory(uint64_t hash, const struct item_memory *item_mem) {
+    hash = hash_bytes(hash, &item_mem->num_vectors, sizeof(item_mem->num_vectors));
+    for (int i = 0; i < item_mem->num_vectors; i++) {
+        hash = hash_bytes(hash, item_mem->base_vectors[i]->data, sign_vector_storage_bytes());
+    }
+    return hash;
+}
+
+/**
+ * @brief Fingerprint of the timestamps `enc` produces for `dataset`.
+ *
+ * Hashes the vector layout, the item memory (or memories) and the quantized
+ * levels; any change to the item memory, the quantizer or the data changes it.
+ */
+uint64_t timestamp_cache_fingerprint(const struct encoder *enc, const struct quantized_dataset *dataset) {
+    uint64_t layout[4] = {(uint64_t)VECTOR_DIMENSION, (uint64_t)BIPOLAR_MODE, (uint64_t)dataset->num_samples,
+                          (uint64_t)dataset->num_features};
+    uint64_t hash = hash_bytes(0xcbf29ce484222325ull, layout, sizeof(layout));
+#if PRECOMPUTED_ITEM_MEMORY
+    hash = hash_item_memory(hash, enc->item_mem);
+#else
+    hash = hash_item_memory(hash, enc->channel_memory);
+    hash = hash_item_memory(hash, enc->signal_memory);
+#endif
+    return hash_bytes(hash, dataset->levels,
+                      (size_t)dataset->num_samples * (size_t)dataset->num_features * sizeof(quantized_level));
+}
+
+static void encode_rows(struct timestamp_cache *cache, struct encoder *enc, const struct quantized_dataset *dataset) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int sample = 0; sample < cache->num_samples; sample++) {
+        encode_timestamp_levels(enc, quantized_dataset_row(dataset, sample), cache->timestamps[sample]);
+    }
+}
+
+#ifndef _WIN32
+/**
+ * @brief Maps an existing cache file read-only if it holds `cache->fingerprint`.
+ */
+static int map_cache_file(struct timestamp_cache *cache, const char *path, size_t data_bytes) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat info;
+    size_t bytes = TIMESTAMP_CACHE_HEADER_BYTES + data_bytes;
+    void *mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && (size_t)info.st_size == bytes) {
+        mapping = mmap(NULL, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return -1;
+    }
+    const struct timestamp_cache_header *header = (const struct timestamp_cache_header *)mapping;
+    if (memcmp(header->magic, TIMESTAMP_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->fingerprint != cache->fingerprint || header->num_samples != (uint64_t)cache->num_samples ||
+        header->stride_bytes != vector_slab_stride() * sizeof(vector_element)) {
+        munmap(mapping, bytes);
+        return -1;
+    }
+    cache->mapping = mapping;
+    cache->mapped_bytes = bytes;
+    return 0;
+}
+
+/**
+ * @brief Creates a writable cache file mapping; `path` NULL creates an unnamed temporary file.
+ *
+ * @param tmp_path Receives the name the file is written under (renamed by the caller), or "".
+ */
+static int create_cache_file(struct timestamp_cache *cache, const char *path, char *tmp_path, size_t tmp_size,
+                             size_t data_bytes) {
+    int fd;
+    if (path) {
+        snprintf(tmp_path, tmp_size, "%s.%ld.tmp", path, (long)getpid());
+        fd = open(tmp_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    } else {
+        const char *dir = getenv("TMPDIR");
+        snprintf(tmp_path, tmp_size, "%s/hdc_timestamps_XXXXXX", dir && dir[0] ? dir : "/tmp");
+        fd = mkstemp(tmp_path);
+        if (fd >= 0) {
+            unlink(tmp_path);  // the mapping keeps the file alive until it is unmapped
+        }
+        tmp_path[0] = '\0';
+    }
+    if (fd < 0) {
+        perror("timestamp cache: failed to create cache file");
+        return -1;
+    }
+    size_t bytes = TIMESTAMP_CACHE_HEADER_BYTES + data_bytes;
+    void *mapping = MAP_FAILED;
+    if (ftruncate(fd, (off_t)bytes) == 0) {
+        mapping = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        perror("timestamp cache: failed to map cache file");
+        if (tmp_path[0]) {
+            unlink(tmp_path);
+        }
+        return -1;
+    }
+    cache->mapping = mapping;
+    cache->mapped_bytes = bytes;
+    return 0;
+}
+#endif
+
+/**
+ * @brief Encodes (or maps a persisted copy of) the timestamps of every dataset row.
+ *
+ * @param cache Receives the timestamps; release with `free_timestamp_cache`.
+ * @param enc Encoder whose item memory the timestamps are encoded with.
+ * @param dataset Quantized samples (NUM_FEATURES levels per row).
+ * @return 0 on success, -1 on invalid arguments or I/O failure.
+ */
+int build_timestamp_cache(struct timestamp_cache *cache, struct encoder *enc, const struct quantized_dataset *dataset) {
+    memset(cache, 0, sizeof(*cache));
+    if (enc == NULL || dataset == NULL || dataset->num_features != NUM_FEATURES || dataset->num_samples <= 0) {
+        fprintf(stderr, "timestamp cache: invalid dataset.\n");
+        return -1;
+    }
+    cache->num_samples = dataset->num_samples;
+    cache->fingerprint = timestamp_cache_fingerprint(enc, dataset);
+    size_t stride = vector_slab_stride();
+    size_t data_bytes = (size_t)cache->num_samples * stride * sizeof(vector_element);
+
+#ifndef _WIN32
+    char path[4096] = "";
+    char tmp_path[4096 + 32] = "";
+    if (TIMESTAMP_CACHE_DIR[0] != '\0') {
+        snprintf(path, sizeof(path), "%s/timestamps_%016llx.bin", TIMESTAMP_CACHE_DIR,
+                 (unsigned long long)cache->fingerprint);
+        if (map_cache_file(cache, path, data_bytes) == 0) {
+            cache->storage = (vector_element *)((unsigned char *)cache->mapping + TIMESTAMP_CACHE_HEADER_BYTES);
+            cache->timestamps = create_vector_views(cache->storage, cache->num_samples, stride);
+            cache->reused = 1;
+            return 0;
+        }
+    }
+    if (path[0] != '\0' || data_bytes > TIMESTAMP_CACHE_MAX_MEMORY_BYTES) {
+        if (create_cache_file(cache, path[0] ? path : NULL, tmp_path, sizeof(tmp_path), data_bytes) != 0) {
+            return -1;
+        }
+        cache->storage = (vector_element *)((unsigned char *)cache->mapping + TIMESTAMP_CACHE_HEADER_BYTES);
+        cache->timestamps = create_vector_views(cache->storage, cache->num_samples, stride);
+        encode_rows(cache, enc, dataset);
+        if (tmp_path[0] != '\0') {
+            struct timestamp_cache_header header;
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, TIMESTAMP_CACHE_MAGIC, sizeof(header.magic));
+            header.fingerprint = cache->fingerprint;
+            header.num_samples = (uint64_t)cache->num_samples;
+            header.stride_bytes = stride * sizeof(vector_element);
+            memcpy(cache->mapping, &header, sizeof(header));
+            if (msync(cache->mapping, cache->mapped_bytes, MS_SYNC) != 0 || rename(tmp_path, path) != 0) {
+                perror("timestamp cache: failed to persist cache file");
+                unlink(tmp_path);
+            }
+        }
+        return 0;
+    }
+#endif
+    cache->timestamps = create_vector_slab(cache->num_samples, &cache->storage);
+    encode_rows(cache, enc, dataset);
+    return 0;
+}
+
+/**
+ * @brief Whether `cache` holds the timestamps `enc` produces for `dataset` (e.g. after a GA changed the item memory).
+ */
+int timestamp_cache_matches(const struct timestamp_cache *cache, const struct encoder *enc,
+                            const struct quantized_dataset *dataset) {
+    return cache->timestamps != NULL && dataset != NULL && cache->num_samples == dataset->num_samples &&
+           cache->fingerprint == timestamp_cache_fingerprint(enc, dataset);
+}
+
+void free_timestamp_cache(struct timestamp_cache *cache) {
+    if (cache->mapping) {
+#ifndef _WIN32
+        munmap(cache->mapping, cache->mapped_bytes);
+#endif
+        free(cache->timestamps);
+    } else if (cache->timestamps) {
+        free_vector_slab(cache->timestamps, cache->storage);
+    }
+    memset(cache, 0, sizeof(*cache));
+}
@@ -0,0 +1,56 @@
+#ifndef TIMESTAMP_CACHE_H
+#define TIMESTAMP_CACHE_H
+
+#ifdef HAND_EMG
+#include "../hand/configHand.h"
+#elif defined(FOOT_EMG)
+#include "../foot/configFoot.h"
+#elif defined(CUSTOM)
+#include "../customModel/configCustom.h"
+#else
+#error "No EMG type defined. Please define HAND_EMG or FOOT_EMG."
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "encoder.h"
+#include "quantizer.h"
+
+#ifndef TIMESTAMP_CACHE_MAX_MEMORY_BYTES
+#define TIMESTAMP_CACHE_MAX_MEMORY_BYTES (512ull << 20) // larger caches spill to an mmap'ed file
+#endif
+#ifndef TIMESTAMP_CACHE_DIR
+#define TIMESTAMP_CACHE_DIR "" // directory of cache files kept across runs ("" = no persistent files)
+#endif
+
+/**
+ * @brief Timestamp hypervectors of every row of a quantized dataset, encoded once.
+ *
+ * A timestamp encoding only depends on the item memory and the row's signal
+ * levels, so it can be shared by every training and evaluation pass that uses
+ * the same item memory, whatever the n-gram size, window or classifier. The
+ * cache is keyed by `fingerprint`, a hash of the item memory and the quantized
+ * levels (which already reflect the quantizer).
+ *
+ * - **timestamps**: One vector per dataset row, stored contiguously at the slab stride.
+ * - **mapped_bytes**: Size of the file mapping behind `storage`, 0 when it lives in memory.
+ * - **reused**: 1 when the timestamps were read from a persistent cache file
+ *   (TIMESTAMP_CACHE_DIR) instead of being encoded.
+ */
+struct timestamp_cache {
+    uint64_t fingerprint;
+    int num_samples;
+    Vector **timestamps;
+    vector_element *storage;
+    void *mapping;
+    size_t mapped_bytes;
+    int reused;
+};
+
+uint64_t timestamp_cache_fingerprint(const struct encoder *enc, const struct quantized_dataset *dataset);
+int build_timestamp_cache(struct timestamp_cache *cache, struct encoder *enc, const struct quantized_dataset *dataset);
+int timestamp_cache_matches(const struct timestamp_cache *cache, const struct encoder *enc,
+                            const struct quantized_dataset *dataset);
+void free_timestamp_cache(struct timestamp_cache *cache);
+
+#endif // TIMESTAMP_CACHE_H
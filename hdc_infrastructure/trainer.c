@@ -25,10 +25,30 @@
 #include "vector.h"
 #include "assoc_mem.h"
 #include "encoder.h"
+#include "workspace.h"
 #include "operations.h"
+#include <limits.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if !BIPOLAR_MODE
+/**
+ * @brief Shards of a single-model training sweep: TRAIN_SHARDS, or one per OpenMP thread.
+ */
+static int default_training_shards(void) {
+#if TRAIN_SHARDS > 0
+    return TRAIN_SHARDS;
+#elif defined(_OPENMP)
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+#endif
 
 /**
  * @brief Trains the HDC model using timeseries data.
@@ -55,182 +75,629 @@
  * - In bipolar mode, associative memory updates occur incrementally, while in binary mode, updates are applied after bundling.
  */
 void train_model_timeseries(double **training_data, int *training_labels, int training_samples, struct associative_memory *assoc_mem, struct encoder *enc) {
+    struct quantized_dataset dataset;
+    if (init_quantized_dataset_for(enc->quantizer, &dataset, training_data, training_samples, NUM_FEATURES) != 0) {
+        fprintf(stderr, "Failed to quantize training data.\n");
+        exit(EXIT_FAILURE);
+    }
+    train_model_timeseries_quantized(&dataset, training_labels, assoc_mem, enc);
+    free_quantized_dataset(&dataset);
+}
+
+/**
+ * @brief Trains the HDC model on a float32 sample matrix or strided view.
+ *
+ * Same as `train_model_timeseries`; a `down_sample_matrix` view is consumed
+ * in place, without materializing the downsampled samples.
+ */
+void train_model_timeseries_matrix(const struct sample_matrix *training_data, int *training_labels, struct associative_memory *assoc_mem, struct encoder *enc) {
+    struct quantized_dataset dataset;
+    if (init_quantized_dataset_from_matrix(enc->quantizer, &dataset, training_data) != 0) {
+        fprintf(stderr, "Failed to quantize training data.\n");
+        exit(EXIT_FAILURE);
+    }
+    train_model_timeseries_quantized(&dataset, training_labels, assoc_mem, enc);
+    free_quantized_dataset(&dataset);
+}
+
+/**
+ * @brief Trains the HDC model on a timeseries that is already quantized.
+ *
+ * Same algorithm as `train_model_timeseries`, reading signal levels from a
+ * `quantized_dataset` instead of quantizing every sample again. Callers that
+ * train repeatedly on the same data (GA candidates) build the dataset once.
+ *
+ * @param dataset Quantized training samples (NUM_FEATURES levels per row).
+ * @param training_labels An array of class labels, one per dataset row.
+ * @param assoc_mem A pointer to the associative memory structure for storing class-specific hypervectors.
+ * @param enc A pointer to the encoder structure for encoding the training data.
+ */
+void train_model_timeseries_quantized(const struct quantized_dataset *dataset, int *training_labels, struct associative_memory *assoc_mem, struct encoder *enc) {
+#if !BIPOLAR_MODE
+    // The binary variants are the single-model case of the shared sweep.
+    train_model_timeseries_quantized_sharded(dataset, training_labels, &assoc_mem, &enc, 1, NULL, NULL,
+                                             default_training_shards());
+#else
+    if (dataset == NULL || dataset->num_features != NUM_FEATURES) {
+        fprintf(stderr, "Invalid quantized training dataset.\n");
+        exit(EXIT_FAILURE);
+    }
+    int training_samples = dataset->num_samples;
     if (output_mode >= OUTPUT_DETAILED) {
         printf("Training HDC-Model for %d training samples.\n",training_samples);
         fflush(stdout);
     }
-    #if BIPOLAR_MODE
-
+    struct hdc_workspace ws;
+    init_hdc_workspace(&ws);
     for (int j = 0; j < training_samples - N_GRAM_SIZE; j++) {
-        Vector* sample_hv = create_vector();
         if (is_window_stable(&training_labels[j])) {
-            encode_timeseries(enc, &training_data[j], sample_hv);
-            add_to_assoc_mem(assoc_mem, sample_hv, training_labels[j]);
+            encode_timeseries_levels(enc, &ws, quantized_dataset_row(dataset, j), ws.sample);
+            add_to_assoc_mem(assoc_mem, ws.sample, training_labels[j]);
 
         }
-        free_vector(sample_hv);
 
     }
+    free_hdc_workspace(&ws);
     if (NORMALIZE) {
         normalize(assoc_mem);
     }
-    
+
+    if (output_mode >= OUTPUT_DEBUG) {
+        print_class_vectors(assoc_mem);
+    }
+#endif
+}
+
+/**
+ * @brief Same as `train_model_timeseries_quantized`, reading the timestamps from a `timestamp_cache`.
+ *
+ * The cache must hold the timestamps of `dataset` under the item memory of
+ * `enc` (see `timestamp_cache_matches`); the model is the same, but no
+ * timestamp is encoded.
+ */
+void train_model_timeseries_cached(const struct quantized_dataset *dataset, const struct timestamp_cache *cache,
+                                   int *training_labels, struct associative_memory *assoc_mem, struct encoder *enc) {
+    if (dataset == NULL || cache == NULL || cache->num_samples != dataset->num_samples) {
+        fprintf(stderr, "Timestamp cache does not match the training data.\n");
+        exit(EXIT_FAILURE);
+    }
+#if !BIPOLAR_MODE
+    train_model_timeseries_quantized_sharded(dataset, training_labels, &assoc_mem, &enc, 1, NULL, cache->timestamps,
+                                             default_training_shards());
 #else
-#if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN
-    int window_size = N_GRAM_SIZE;
-    Vector *rolling_acc = create_vector();
-    Vector **window_vectors = (Vector **)malloc((size_t)window_size * sizeof(Vector *));
-    int **class_bit_counts = (int **)malloc((size_t)NUM_CLASSES * sizeof(int *));
-    int *class_counts = (int *)calloc((size_t)NUM_CLASSES, sizeof(int));
+    // The bipolar trainer adds n-grams one by one and encodes them itself.
+    train_model_timeseries_quantized(dataset, training_labels, assoc_mem, enc);
+#endif
+}
 
-    if (!rolling_acc || !window_vectors || !class_bit_counts || !class_counts) {
-        fprintf(stderr, "Failed to allocate rolling training buffers.\n");
-        if (rolling_acc) {
-            free_vector(rolling_acc);
-        }
-        free(window_vectors);
-        free(class_bit_counts);
-        free(class_counts);
+/**
+ * @brief Trains several models on the same quantized timeseries in one pass.
+ *
+ * Every model keeps its own n-gram state and class bit counters, but the
+ * dataset is swept once: each sample's level row is read once and pushed
+ * through all encoders before moving on. Each model ends up identical to
+ * training it alone with `train_model_timeseries_quantized`.
+ *
+ * @param dataset Quantized training samples (NUM_FEATURES levels per row).
+ * @param training_labels An array of class labels, one per dataset row.
+ * @param assoc_mems Associative memories, one per model.
+ * @param encs Encoders, one per model.
+ * @param num_models Number of models trained together.
+ * @param deltas Optional (NULL, or NULL entries): per-model item-memory deltas
+ *        against the reference encodings in `reference_timestamps`, so a model's
+ *        timestamps are patched with `push_ngram_encoder_delta` instead of being
+ *        encoded from scratch.
+ * @param reference_timestamps Reference timestamp encodings, one per dataset row;
+ *        only read for models with a delta. With `deltas` NULL they are the
+ *        timestamps of every model (e.g. a `timestamp_cache` built with their
+ *        shared item memory) and replace encoding altogether.
+ *
+ * @note Only the binary n-gram variant shares the sweep; bipolar and KRISCHAN
+ *       builds train the models one after another and ignore `deltas`.
+ */
+void train_model_timeseries_quantized_multi(const struct quantized_dataset *dataset,
+                                            int *training_labels,
+                                            struct associative_memory **assoc_mems,
+                                            struct encoder **encs,
+                                            int num_models,
+                                            const struct encoder_delta *const *deltas,
+                                            Vector *const *reference_timestamps) {
+    train_model_timeseries_quantized_sharded(dataset, training_labels, assoc_mems, encs, num_models,
+                                             deltas, reference_timestamps, 1);
+}
+
+#if !BIPOLAR_MODE
+#if MODEL_VARIANT != MODEL_VARIANT_KRISCHAN
+/**
+ * @brief Accumulates the class bit counters of the n-grams ending in samples [begin, end).
+ *
+ * The n-gram state is rebuilt from fresh workspaces: samples before `begin` are
+ * pushed without being counted, back to the last label change or N_GRAM_SIZE - 1
+ * samples, whichever is closer. Counting a range therefore gives exactly the
+ * counts the sweep over the whole dataset collects for those samples.
+ * `origin` is the position of row 0 in the whole recording (non-zero for
+ * streamed chunks) and only used in messages.
+ */
+static void train_quantized_range(const struct quantized_dataset *dataset,
+                                  int *training_labels,
+                                  struct encoder **encs,
+                                  int num_models,
+                                  const struct encoder_delta *const *deltas,
+                                  Vector *const *reference_timestamps,
+                                  long long origin,
+                                  int begin,
+                                  int end,
+                                  uint64_t *class_bit_planes,
+                                  int nbits,
+                                  int *vector_counts) {
+    struct hdc_workspace *ws = (struct hdc_workspace *)malloc((size_t)num_models * sizeof(struct hdc_workspace));
+    if (!ws) {
+        fprintf(stderr, "Failed to allocate training workspaces.\n");
         exit(EXIT_FAILURE);
     }
+    for (int model = 0; model < num_models; model++) {
+        init_hdc_workspace(&ws[model]);
+    }
 
-    for (int i = 0; i < window_size; i++) {
-        window_vectors[i] = create_vector();
+    int warmup = begin;
+    while (warmup > 0 && begin - warmup < N_GRAM_SIZE - 1 && training_labels[warmup] == training_labels[warmup - 1]) {
+        warmup--;
     }
-    for (int c = 0; c < NUM_CLASSES; c++) {
-        class_bit_counts[c] = (int *)calloc((size_t)VECTOR_DIMENSION, sizeof(int));
-        if (!class_bit_counts[c]) {
-            fprintf(stderr, "Failed to allocate class bit counters.\n");
-            exit(EXIT_FAILURE);
+
+    for (int sample = warmup; sample < end; sample++) {
+        int label_changed = sample > warmup && training_labels[sample] != training_labels[sample - 1];
+        const quantized_level *levels = quantized_dataset_row(dataset, sample);
+        int class_id = training_labels[sample];
+        int class_valid = sample >= begin && class_id >= 0 && class_id < NUM_CLASSES;
+
+        for (int model = 0; model < num_models; model++) {
+            if (label_changed) {
+                reset_hdc_workspace(&ws[model]);
+            }
+
+            Vector *sample_hv = ws[model].sample;
+            int ready;
+            if (deltas && deltas[model]) {
+                ready = push_ngram_encoder_delta(encs[model], &ws[model].ngram_state, deltas[model], levels,
+                                                 reference_timestamps[sample], sample_hv);
+            } else if (!deltas && reference_timestamps) {
+                ready = push_ngram_encoder_timestamp(&ws[model].ngram_state, reference_timestamps[sample], sample_hv);
+            } else {
+                ready = push_ngram_encoder_levels(encs[model], &ws[model].ngram_state, levels, sample_hv);
+            }
+            if (ready < 0) {
+                fprintf(stderr, "Failed to encode training ngram at sample %lld.\n", origin + sample);
+                exit(EXIT_FAILURE);
+            }
+            if (!ready || !class_valid) {
+                continue;
+            }
+
+            size_t counter = (size_t)model * NUM_CLASSES + (size_t)class_id;
+            bit_counter_add(class_bit_planes + counter * vector_storage_count() * (size_t)nbits, nbits, sample_hv);
+            vector_counts[model * NUM_CLASSES + class_id]++;
         }
     }
 
-    int window_filled = 0;
-    int window_pos = 0;
-    Vector *sample_hv = create_vector();
-    Vector *rotated_hv = create_vector();
-    for (int i = 0; i < training_samples; i++) {
-        encode_timestamp(enc, training_data[i], sample_hv);
-        permute(sample_hv, window_pos, rotated_hv);
-
-        if (window_filled < window_size) {
-            bind(rolling_acc, rotated_hv, rolling_acc);
-            vector_copy(window_vectors[window_pos], rotated_hv);
-            window_filled++;
-        } else {
-            bind(rolling_acc, window_vectors[window_pos], rolling_acc);
-            bind(rolling_acc, rotated_hv, rolling_acc);
-            vector_copy(window_vectors[window_pos], rotated_hv);
+    for (int model = 0; model < num_models; model++) {
+        free_hdc_workspace(&ws[model]);
+    }
+    free(ws);
+}
+#else
+/**
+ * @brief Accumulates the class bit counters of the rolling windows ending in samples [begin, end).
+ *
+ * The rolling window never resets at label changes, so replaying the
+ * N_GRAM_SIZE - 1 samples before `begin` rebuilds it exactly; window slots are
+ * indexed by the absolute sample position `origin + sample` as in a sweep over
+ * the whole recording. `deltas` are not used; `reference_timestamps` only
+ * without them (encoded timestamps shared by every model).
+ */
+static void train_quantized_range(const struct quantized_dataset *dataset,
+                                  int *training_labels,
+                                  struct encoder **encs,
+                                  int num_models,
+                                  const struct encoder_delta *const *deltas,
+                                  Vector *const *reference_timestamps,
+                                  long long origin,
+                                  int begin,
+                                  int end,
+                                  uint64_t *class_bit_planes,
+                                  int nbits,
+                                  int *vector_counts) {
+    (void)deltas;
+    (void)reference_timestamps;
+    int window_size = N_GRAM_SIZE;
+    Vector **rolling_acc = (Vector **)malloc((size_t)num_models * sizeof(Vector *));
+    Vector **window_vectors = (Vector **)malloc((size_t)num_models * (size_t)window_size * sizeof(Vector *));
+    if (!rolling_acc || !window_vectors) {
+        fprintf(stderr, "Failed to allocate rolling training buffers.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int model = 0; model < num_models; model++) {
+        rolling_acc[model] = create_vector();
+        for (int i = 0; i < window_size; i++) {
+            window_vectors[model * window_size + i] = create_vector();
         }
+    }
+
+    int warmup = begin - (window_size - 1);
+    if (warmup < 0) {
+        warmup = 0;
+    }
 
-        window_pos = (window_pos + 1) % window_size;
+    Vector *sample_hv = create_vector();
+    for (int sample = warmup; sample < end; sample++) {
+        const quantized_level *levels = quantized_dataset_row(dataset, sample);
+        long long position = origin + sample;
+        int window_pos = (int)(position % window_size);
+        int evict = sample - warmup >= window_size;
+        int class_id = training_labels[sample];
+        int class_valid = sample >= begin && position >= window_size - 1 && class_id >= 0 && class_id < NUM_CLASSES;
 
-        if (i >= window_size - 1) {
-            int label = training_labels[i];
-            if (label >= 0 && label < NUM_CLASSES) {
-                for (int d = 0; d < VECTOR_DIMENSION; d++) {
-                    class_bit_counts[label][d] += vector_get_bit(rolling_acc, d) ? 1 : 0;
-                }
-                class_counts[label]++;
+        for (int model = 0; model < num_models; model++) {
+            Vector *slot = window_vectors[model * window_size + window_pos];
+            if (!deltas && reference_timestamps) {
+                vector_copy(sample_hv, reference_timestamps[sample]);
+            } else {
+                encode_timestamp_levels(encs[model], levels, sample_hv);
             }
-        }
+            if (evict) {
+                hdc_bind(rolling_acc[model], slot, rolling_acc[model]);
+            }
+            // Rotate straight into the window slot; no separate rotated copy is needed.
+            permute(sample_hv, window_pos, slot);
+            hdc_bind(rolling_acc[model], slot, rolling_acc[model]);
 
+            if (!class_valid) {
+                continue;
+            }
+            size_t counter = (size_t)model * NUM_CLASSES + (size_t)class_id;
+            bit_counter_add(class_bit_planes + counter * vector_storage_count() * (size_t)nbits, nbits, rolling_acc[model]);
+            vector_counts[model * NUM_CLASSES + class_id]++;
+        }
     }
-    free_vector(rotated_hv);
     free_vector(sample_hv);
 
-    for (int class_id = 0; class_id < NUM_CLASSES; class_id++) {
-        Vector *bundled_hv = create_vector();
-        int thr = class_counts[class_id] / 2;
-        for (int d = 0; d < VECTOR_DIMENSION; d++) {
-            vector_set_bit(bundled_hv, d, (class_bit_counts[class_id][d] > thr) ? 1 : 0);
+    for (int model = 0; model < num_models; model++) {
+        for (int i = 0; i < window_size; i++) {
+            free_vector(window_vectors[model * window_size + i]);
         }
-        add_to_assoc_mem(assoc_mem, bundled_hv, class_id);
-        assoc_mem->counts[class_id] = class_counts[class_id];
-        free_vector(bundled_hv);
+        free_vector(rolling_acc[model]);
     }
+    free(window_vectors);
+    free(rolling_acc);
+}
+#endif
+
+/**
+ * @brief Sample sweep split into shards with private class bit counters.
+ */
+struct training_sweep {
+    const struct quantized_dataset *dataset;
+    int *training_labels;
+    struct encoder **encs;
+    int num_models;
+    const struct encoder_delta *const *deltas;
+    Vector *const *reference_timestamps;
+    int sweep_samples;
+    int shards;
+    size_t counter_count;
+    int nbits;
+    uint64_t **class_bit_planes;
+    int **vector_counts;
+};
 
-    for (int c = 0; c < NUM_CLASSES; c++) {
-        free(class_bit_counts[c]);
+/**
+ * @brief Collects the counters of every shard of `sweep`.
+ *
+ * Under OpenMP every shard but the first becomes a task, shard 0 runs on the
+ * calling thread once the others are queued.
+ */
+static void run_training_shards(struct training_sweep *sweep) {
+    size_t plane_words = sweep->counter_count * vector_storage_count() * (size_t)sweep->nbits;
+    for (int shard = sweep->shards - 1; shard >= 0; shard--) {
+        int begin = (int)((long long)sweep->sweep_samples * shard / sweep->shards);
+        int end = (int)((long long)sweep->sweep_samples * (shard + 1) / sweep->shards);
+#ifdef _OPENMP
+#pragma omp task firstprivate(shard, begin, end) if (shard > 0)
+#endif
+        {
+            // Each shard allocates its counters itself so they are first touched by
+            // the thread that fills them.
+            sweep->class_bit_planes[shard] = (uint64_t *)calloc(plane_words, sizeof(uint64_t));
+            sweep->vector_counts[shard] = (int *)calloc(sweep->counter_count, sizeof(int));
+            if (!sweep->class_bit_planes[shard] || !sweep->vector_counts[shard]) {
+                fprintf(stderr, "Failed to allocate training bit counters.\n");
+                exit(EXIT_FAILURE);
+            }
+            train_quantized_range(sweep->dataset, sweep->training_labels, sweep->encs, sweep->num_models,
+                                  sweep->deltas, sweep->reference_timestamps, 0, begin, end,
+                                  sweep->class_bit_planes[shard], sweep->nbits, sweep->vector_counts[shard]);
+        }
     }
-    for (int i = 0; i < window_size; i++) {
-        free_vector(window_vectors[i]);
+#ifdef _OPENMP
+#pragma omp taskwait
+#endif
+}
+
+/**
+ * @brief Thresholds the merged class bit counters into the associative memories.
+ */
+static void store_class_vectors(struct associative_memory **assoc_mems,
+                                int num_models,
+                                const uint64_t *class_bit_planes,
+                                int nbits,
+                                const int *vector_counts) {
+    size_t counter_words = vector_storage_count() * (size_t)nbits;
+    for (int model = 0; model < num_models; model++) {
+        struct associative_memory *assoc_mem = assoc_mems[model];
+        for (int class_id = 0; class_id < NUM_CLASSES; class_id++) {
+            Vector *bundled_hv = create_vector();
+            size_t counter = (size_t)model * NUM_CLASSES + (size_t)class_id;
+            int threshold = vector_counts[counter] / 2;
+#if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN
+            threshold++; // KRISCHAN sets a bit only above half the votes
+#endif
+            bit_counter_threshold(class_bit_planes + counter * counter_words, nbits, threshold, bundled_hv);
+
+            // Add the bundled vector to the associative memory for this class
+            add_to_assoc_mem(assoc_mem, bundled_hv, class_id);
+            assoc_mem->counts[class_id] = vector_counts[counter];
+            free_vector(bundled_hv);
+        }
+        retain_assoc_mem_counters(assoc_mem, class_bit_planes + (size_t)model * NUM_CLASSES * counter_words, nbits);
+#if ASSOC_MEM_PRUNE_DIMENSIONS
+        prune_assoc_mem(assoc_mem);
+#endif
+
+        if (output_mode >= OUTPUT_DEBUG) {
+            print_class_vectors(assoc_mem);
+        }
     }
-    free(class_counts);
-    free(class_bit_counts);
-    free(window_vectors);
-    free_vector(rolling_acc);
+}
+#endif
+
+/**
+ * @brief Same as `train_model_timeseries_quantized_multi`, splitting the sweep into data shards.
+ *
+ * The samples are split into `shards` contiguous ranges whose class bit counters
+ * are collected independently and summed before thresholding. Under OpenMP the
+ * shards run as tasks: inside a parallel region idle threads of that region
+ * (e.g. a GA generation with fewer candidate batches than cores) help with
+ * them, otherwise a parallel region is opened for the sweep. The counters are
+ * integers, so the models are identical for every shard count.
+ *
+ * @param shards Requested number of shards; capped so every shard covers at
+ *        least TRAIN_MIN_SHARD_SAMPLES samples. 1 runs the plain sweep.
+ *
+ * @note Bipolar builds train the models one after another and ignore `shards`.
+ */
+void train_model_timeseries_quantized_sharded(const struct quantized_dataset *dataset,
+                                              int *training_labels,
+                                              struct associative_memory **assoc_mems,
+                                              struct encoder **encs,
+                                              int num_models,
+                                              const struct encoder_delta *const *deltas,
+                                              Vector *const *reference_timestamps,
+                                              int shards) {
+#if BIPOLAR_MODE
+    (void)deltas;
+    (void)reference_timestamps;
+    (void)shards;
+    for (int model = 0; model < num_models; model++) {
+        train_model_timeseries_quantized(dataset, training_labels, assoc_mems[model], encs[model]);
+    }
+#else
+    if (dataset == NULL || dataset->num_features != NUM_FEATURES || num_models <= 0) {
+        fprintf(stderr, "Invalid quantized training dataset.\n");
+        exit(EXIT_FAILURE);
+    }
+    int training_samples = dataset->num_samples;
+    if (output_mode >= OUTPUT_DETAILED) {
+        for (int model = 0; model < num_models; model++) {
+            printf("Training HDC-Model for %d training samples.\n",training_samples);
+        }
+        fflush(stdout);
+    }
+
+#if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN
+    int sweep_samples = training_samples;
 #else
-    int **class_bit_counts = (int **)malloc((size_t)NUM_CLASSES * sizeof(int *));
-    int* vector_counts = (int*)calloc((size_t)NUM_CLASSES, sizeof(int));
-    if (!class_bit_counts || !vector_counts) {
+    int sweep_samples = training_samples > 1 ? training_samples - 1 : 0;
+#endif
+    if (shards > sweep_samples / TRAIN_MIN_SHARD_SAMPLES) {
+        shards = sweep_samples / TRAIN_MIN_SHARD_SAMPLES;
+    }
+    if (shards < 1) {
+        shards = 1;
+    }
+
+    // Bit-sliced class counters: enough planes for every n-gram landing in one class.
+    size_t counter_count = (size_t)num_models * NUM_CLASSES;
+    int nbits = bit_counter_planes(sweep_samples);
+    size_t counter_words = vector_storage_count() * (size_t)nbits;
+    uint64_t **class_bit_planes = (uint64_t **)calloc((size_t)shards, sizeof(uint64_t *));
+    int **vector_counts = (int **)calloc((size_t)shards, sizeof(int *));
+    if (!class_bit_planes || !vector_counts) {
         fprintf(stderr, "Failed to allocate training bit counters.\n");
-        free(class_bit_counts);
-        free(vector_counts);
         exit(EXIT_FAILURE);
     }
-    for (int class_id = 0; class_id < NUM_CLASSES; class_id++) {
-        class_bit_counts[class_id] = (int *)calloc((size_t)VECTOR_DIMENSION, sizeof(int));
-        if (!class_bit_counts[class_id]) {
-            fprintf(stderr, "Failed to allocate class bit counters.\n");
-            exit(EXIT_FAILURE);
+
+    struct training_sweep sweep = {dataset, training_labels, encs, num_models, deltas, reference_timestamps,
+                                   sweep_samples, shards, counter_count, nbits, class_bit_planes, vector_counts};
+#ifdef _OPENMP
+    if (shards > 1 && !omp_in_parallel()) {
+#pragma omp parallel
+        {
+#pragma omp single
+            run_training_shards(&sweep);
         }
+    } else {
+        run_training_shards(&sweep);
     }
+#else
+    run_training_shards(&sweep);
+#endif
 
-    Vector* sample_hv = create_vector();
-    struct ngram_encoder_state ngram_state;
-    init_ngram_encoder_state(&ngram_state);
-    for (int sample = 0; sample < training_samples - 1; sample++) {
-        if (sample > 0 && training_labels[sample] != training_labels[sample - 1]) {
-            reset_ngram_encoder_state(&ngram_state);
+    for (int shard = 1; shard < shards; shard++) {
+        for (size_t counter = 0; counter < counter_count; counter++) {
+            bit_counter_merge(class_bit_planes[0] + counter * counter_words,
+                              class_bit_planes[shard] + counter * counter_words,
+                              nbits);
+        }
+        for (size_t i = 0; i < counter_count; i++) {
+            vector_counts[0][i] += vector_counts[shard][i];
         }
+        free(class_bit_planes[shard]);
+        free(vector_counts[shard]);
+    }
+
+    store_class_vectors(assoc_mems, num_models, class_bit_planes[0], nbits, vector_counts[0]);
+    free(class_bit_planes[0]);
+    free(vector_counts[0]);
+    free(class_bit_planes);
+    free(vector_counts);
+#endif
+}
+
+/**
+ * @brief Trains the HDC model on a dataset delivered chunk by chunk.
+ *
+ * Each chunk is quantized into a window that keeps the trailing rows of the
+ * previous chunk, so n-grams (or the KRISCHAN rolling window) span chunk
+ * boundaries and the model is identical to training on the whole recording
+ * with `train_model_timeseries_matrix`. Memory is bounded by the chunk size:
+ * the class bit counters carry enough planes for any sample count, and the
+ * stream's prefetch overlaps reading the next chunk with encoding this one.
+ * Within a chunk the samples are split into shards like the in-memory sweep.
+ *
+ * @param stream The training data; consumed to its end (reset it to train again).
+ * @param assoc_mem A pointer to the associative memory structure for storing class-specific hypervectors.
+ * @param enc A pointer to the encoder structure for encoding the training data.
+ *
+ * @note Binary builds only; bipolar builds exit with an error.
+ */
+void train_model_timeseries_stream(struct dataset_stream *stream, struct associative_memory *assoc_mem, struct encoder *enc) {
+#if BIPOLAR_MODE
+    (void)stream;
+    (void)assoc_mem;
+    (void)enc;
+    fprintf(stderr, "Streamed training is only supported for binary models.\n");
+    exit(EXIT_FAILURE);
+#else
+#if MODEL_VARIANT == MODEL_VARIANT_KRISCHAN
+    const int pending = 0;
+#else
+    const int pending = 1; // the last sample of the recording never ends a counted n-gram
+#endif
+    int history = N_GRAM_SIZE - 1 + pending;
+    if (!quantizer_fitted(enc->quantizer)) {
+        fprintf(stderr, "quantizer: streamed training requested before fit.\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t chunk_rows = dataset_stream_chunk_rows(stream);
+    if (chunk_rows > (size_t)(INT_MAX - history)) {
+        fprintf(stderr, "Stream chunks too large for training.\n");
+        exit(EXIT_FAILURE);
+    }
+    int capacity = history + (int)chunk_rows;
+    int shards = default_training_shards();
+    if (shards > (int)chunk_rows / TRAIN_MIN_SHARD_SAMPLES) {
+        shards = (int)chunk_rows / TRAIN_MIN_SHARD_SAMPLES;
+    }
+    if (shards < 1) {
+        shards = 1;
+    }
 
-        int ready = push_ngram_encoder_sample(enc, &ngram_state, training_data[sample], sample_hv);
-        if (ready < 0) {
-            fprintf(stderr, "Failed to encode training ngram at sample %d.\n", sample);
-            free_ngram_encoder_state(&ngram_state);
-            free_vector(sample_hv);
+    int nbits = bit_counter_planes(INT_MAX);
+    size_t counter_words = vector_storage_count() * (size_t)nbits;
+    struct quantized_dataset window = {NULL, 0, NUM_FEATURES};
+    window.levels = (quantized_level *)malloc((size_t)capacity * NUM_FEATURES * sizeof(quantized_level));
+    int *window_labels = (int *)malloc((size_t)capacity * sizeof(int));
+    uint64_t **class_bit_planes = (uint64_t **)calloc((size_t)shards, sizeof(uint64_t *));
+    int **vector_counts = (int **)calloc((size_t)shards, sizeof(int *));
+    if (!window.levels || !window_labels || !class_bit_planes || !vector_counts) {
+        fprintf(stderr, "Failed to allocate streamed training buffers.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int shard = 0; shard < shards; shard++) {
+        class_bit_planes[shard] = (uint64_t *)calloc((size_t)NUM_CLASSES * counter_words, sizeof(uint64_t));
+        vector_counts[shard] = (int *)calloc(NUM_CLASSES, sizeof(int));
+        if (!class_bit_planes[shard] || !vector_counts[shard]) {
+            fprintf(stderr, "Failed to allocate training bit counters.\n");
             exit(EXIT_FAILURE);
         }
-        if (!ready) {
-            continue;
+    }
+
+    long long origin = 0;   // recording position of window row 0
+    long long counted = 0;  // recording position of the next sample to count
+    int carried = 0;
+    struct sample_matrix chunk;
+    const int *labels;
+    long rows;
+    while ((rows = dataset_stream_next_chunk(stream, &chunk, &labels)) > 0) {
+        for (long row = 0; row < rows; row++) {
+            quantizer_quantize_sample_f(enc->quantizer, sample_matrix_row(&chunk, (size_t)row),
+                                        window.levels + (size_t)(carried + row) * NUM_FEATURES);
         }
+        memcpy(window_labels + carried, labels, (size_t)rows * sizeof(int));
+        window.num_samples = carried + (int)rows;
 
-        int class_id = training_labels[sample];
-        if (class_id >= 0 && class_id < NUM_CLASSES) {
-            for (int d = 0; d < VECTOR_DIMENSION; d++) {
-                class_bit_counts[class_id][d] += vector_get_bit(sample_hv, d) ? 1 : 0;
+        int begin = (int)(counted - origin);
+        int end = window.num_samples - pending;
+        if (end > begin) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (shards > 1)
+#endif
+            for (int shard = 0; shard < shards; shard++) {
+                int shard_begin = begin + (int)((long long)(end - begin) * shard / shards);
+                int shard_end = begin + (int)((long long)(end - begin) * (shard + 1) / shards);
+                if (shard_end > shard_begin) {
+                    train_quantized_range(&window, window_labels, &enc, 1, NULL, NULL, origin, shard_begin, shard_end,
+                                          class_bit_planes[shard], nbits, vector_counts[shard]);
+                }
             }
-            vector_counts[class_id]++;
+            counted = origin + end;
         }
+
+        int keep = window.num_samples < history ? window.num_samples : history;
+        int drop = window.num_samples - keep;
+        memmove(window.levels, window.levels + (size_t)drop * NUM_FEATURES, (size_t)keep * NUM_FEATURES * sizeof(quantized_level));
+        memmove(window_labels, window_labels + drop, (size_t)keep * sizeof(int));
+        origin += drop;
+        carried = keep;
+    }
+    if (rows < 0) {
+        fprintf(stderr, "Failed to read training data stream.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (output_mode >= OUTPUT_DETAILED) {
+        printf("Trained HDC-Model on %lld streamed training samples.\n", origin + carried);
+        fflush(stdout);
     }
-    free_ngram_encoder_state(&ngram_state);
-    free_vector(sample_hv);
 
-    for (int class_id = 0; class_id < NUM_CLASSES; class_id++) {
-        Vector* bundled_hv = create_vector();  // Create a bundled vector to store the final result
-        int threshold = vector_counts[class_id] / 2;
-        for (int d = 0; d < VECTOR_DIMENSION; d++) {
-            vector_set_bit(bundled_hv, d, class_bit_counts[class_id][d] >= threshold ? 1 : 0);
+    for (int shard = 1; shard < shards; shard++) {
+        for (int class_id = 0; class_id < NUM_CLASSES; class_id++) {
+            bit_counter_merge(class_bit_planes[0] + (size_t)class_id * counter_words,
+                              class_bit_planes[shard] + (size_t)class_id * counter_words,
+                              nbits);
+            vector_counts[0][class_id] += vector_counts[shard][class_id];
         }
-        
-        // Add the bundled vector to the associative memory for this class
-        add_to_assoc_mem(assoc_mem, bundled_hv, class_id);
-        assoc_mem->counts[class_id] = vector_counts[class_id];
-        
-        free_vector(bundled_hv);  // Free the bundled vector
-
-        free(class_bit_counts[class_id]);
+        free(class_bit_planes[shard]);
+        free(vector_counts[shard]);
     }
-    free(class_bit_counts);
+    store_class_vectors(&assoc_mem, 1, class_bit_planes[0], nbits, vector_counts[0]);
+    free(class_bit_planes[0]);
+    free(vector_counts[0]);
+    free(class_bit_planes);
     free(vector_counts);
+    free(window.levels);
+    free(window_labels);
 #endif
-#endif
-
-    if (output_mode >= OUTPUT_DEBUG) {
-        print_class_vectors(assoc_mem);
-    }
 }
+
 /**
  * @brief Trains the HDC model using general (non-timeseries) data.
  *
@@ -245,12 +712,14 @@ void train_model_timeseries(double **training_data, int *training_labels, int tr
  *
  * @note 
  * - In **bipolar mode**, incremental bundling of hypervectors is supported.
- * - In **binary mode**, pre-bundling of class hypervectors is necessary before updates.
+ * - In **binary mode**, every encoded sample votes into its class' bit-sliced
+ *   counters right away; the class vectors are the majority of those votes.
  *
  * @details 
  * - Each sample is individually encoded into a hypervector.
  * - Encoded hypervectors are bundled together for each class and added to associative memory.
- * - In binary mode, majority voting influences how the bundling is performed.
+ * - In binary mode, the samples are split into shards (one per OpenMP thread,
+ *   or TRAIN_SHARDS) with private counters, so memory stays O(NUM_CLASSES x D).
  *
  * @warning The caller is responsible for proper memory allocation and cleanup of all input data.
  */
@@ -275,40 +744,82 @@ void train_model_general_data(double **training_data, int *training_labels, int
     }
     
     #else
-    Vector*** encoded_vectors = (Vector***)malloc((training_samples) * NUM_CLASSES * sizeof(Vector*));
-    int* vector_counts = (int*)calloc(NUM_CLASSES, sizeof(int)); // Array to keep track of vector count for each class
-    // Allocate memory for each class' vector array
-    for (int class_id = 0; class_id < NUM_CLASSES; class_id++) {
-        encoded_vectors[class_id] = (Vector**)malloc((training_samples) * sizeof(Vector*));
-        
-        // Initialize each vector to NULL or allocate the Vector objects
-        for (int i = 0; i < training_samples; i++) {
-            encoded_vectors[class_id][i] = create_vector();  // Allocate each Vector for the class
+    // Every sample votes into its class' bit-sliced counters as soon as it is
+    // encoded, so memory stays O(NUM_CLASSES x D) regardless of the sample count.
+    int shards = default_training_shards();
+    if (shards > training_samples / TRAIN_MIN_SHARD_SAMPLES) {
+        shards = training_samples / TRAIN_MIN_SHARD_SAMPLES;
+    }
+    if (shards < 1) {
+        shards = 1;
+    }
+    int nbits = bit_counter_planes(training_samples);
+    size_t counter_words = vector_storage_count() * (size_t)nbits;
+    uint64_t **class_bit_planes = (uint64_t **)calloc((size_t)shards, sizeof(uint64_t *));
+    int **vector_counts = (int **)calloc((size_t)shards, sizeof(int *));
+    if (!class_bit_planes || !vector_counts) {
+        fprintf(stderr, "Failed to allocate training bit counters.\n");
+        exit(EXIT_FAILURE);
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (shards > 1)
+#endif
+    for (int shard = 0; shard < shards; shard++) {
+        int begin = (int)((long long)training_samples * shard / shards);
+        int end = (int)((long long)training_samples * (shard + 1) / shards);
+        class_bit_planes[shard] = (uint64_t *)calloc((size_t)NUM_CLASSES * counter_words, sizeof(uint64_t));
+        vector_counts[shard] = (int *)calloc((size_t)NUM_CLASSES, sizeof(int));
+        if (!class_bit_planes[shard] || !vector_counts[shard]) {
+            fprintf(stderr, "Failed to allocate training bit counters.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        Vector *sample_hv = create_vector();
+        for (int j = begin; j < end; j++) {
+            int class_id = training_labels[j];
+            if (class_id < 0 || class_id >= NUM_CLASSES) {
+                continue;
+            }
+            encode_general_data(enc, training_data[j], sample_hv);
+            bit_counter_add(class_bit_planes[shard] + (size_t)class_id * counter_words, nbits, sample_hv);
+            vector_counts[shard][class_id]++;
         }
+        free_vector(sample_hv);
     }
-    for (int j = 0; j < training_samples; j++) {
-            encode_general_data(enc, training_data[j], encoded_vectors[training_labels[j]][vector_counts[training_labels[j]]]); 
-            vector_counts[training_labels[j]]++;
-        
+
+    for (int shard = 1; shard < shards; shard++) {
+        for (int class_id = 0; class_id < NUM_CLASSES; class_id++) {
+            bit_counter_merge(class_bit_planes[0] + (size_t)class_id * counter_words,
+                              class_bit_planes[shard] + (size_t)class_id * counter_words,
+                              nbits);
+            vector_counts[0][class_id] += vector_counts[shard][class_id];
+        }
+        free(class_bit_planes[shard]);
+        free(vector_counts[shard]);
     }
 
     for (int class_id = 0; class_id < NUM_CLASSES; class_id++) {
         Vector* bundled_hv = create_vector();  // Create a bundled vector to store the final result
-        bundle_multi(encoded_vectors[class_id], vector_counts[class_id], bundled_hv);  // Bundle all vectors for this class
-        
+        // Same majority as bundle_multi over the class' vectors: count >= n / 2.
+        bit_counter_threshold(class_bit_planes[0] + (size_t)class_id * counter_words,
+                              nbits,
+                              vector_counts[0][class_id] / 2,
+                              bundled_hv);
+
         // Add the bundled vector to the associative memory for this class
         add_to_assoc_mem(assoc_mem, bundled_hv, class_id);
-        assoc_mem->counts[class_id] = vector_counts[class_id];
-        
-        free_vector(bundled_hv);  // Free the bundled vector
-        
-        for (int i = 0; i < training_samples; i++) {
-            free_vector(encoded_vectors[class_id][i]);  // Free each stored vector
-        }
+        assoc_mem->counts[class_id] = vector_counts[0][class_id];
 
-        free(encoded_vectors[class_id]);  // Free the array of vectors for each class
+        free_vector(bundled_hv);  // Free the bundled vector
     }
-    free(encoded_vectors);
+    retain_assoc_mem_counters(assoc_mem, class_bit_planes[0], nbits);
+#if ASSOC_MEM_PRUNE_DIMENSIONS
+    prune_assoc_mem(assoc_mem);
+#endif
+    free(class_bit_planes[0]);
+    free(vector_counts[0]);
+    free(class_bit_planes);
     free(vector_counts);
     #endif
 
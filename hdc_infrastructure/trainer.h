@@ -13,9 +13,39 @@
 
 #include "assoc_mem.h"
 #include "encoder.h"
+#include "quantizer.h"
+#include "sample_stream.h"
+#include "timestamp_cache.h"
+
+#ifndef TRAIN_MIN_SHARD_SAMPLES
+#define TRAIN_MIN_SHARD_SAMPLES 512 // smallest sample range worth a training shard of its own
+#endif
+#ifndef TRAIN_SHARDS
+#define TRAIN_SHARDS 0 // shards of a single-model training sweep (0: one per OpenMP thread)
+#endif
 
 // Function to train the model
 void train_model_timeseries(double **trainingData, int *trainingLabels, int trainingSamples, struct associative_memory *assMem, struct encoder *enc);
+void train_model_timeseries_matrix(const struct sample_matrix *trainingData, int *trainingLabels, struct associative_memory *assMem, struct encoder *enc);
+void train_model_timeseries_quantized(const struct quantized_dataset *dataset, int *trainingLabels, struct associative_memory *assMem, struct encoder *enc);
+void train_model_timeseries_quantized_multi(const struct quantized_dataset *dataset,
+                                            int *trainingLabels,
+                                            struct associative_memory **assMems,
+                                            struct encoder **encs,
+                                            int numModels,
+                                            const struct encoder_delta *const *deltas,
+                                            Vector *const *referenceTimestamps);
+void train_model_timeseries_quantized_sharded(const struct quantized_dataset *dataset,
+                                              int *trainingLabels,
+                                              struct associative_memory **assMems,
+                                              struct encoder **encs,
+                                              int numModels,
+                                              const struct encoder_delta *const *deltas,
+                                              Vector *const *referenceTimestamps,
+                                              int shards);
+void train_model_timeseries_cached(const struct quantized_dataset *dataset, const struct timestamp_cache *cache,
+                                   int *trainingLabels, struct associative_memory *assMem, struct encoder *enc);
+void train_model_timeseries_stream(struct dataset_stream *stream, struct associative_memory *assMem, struct encoder *enc);
 void train_model_general_data(double **training_data, int *training_labels, int training_samples, struct associative_memory *assoc_mem, struct encoder *enc);
 
 #endif // TRAINER_H
\ No newline at end of file
@@ -112,3 +112,99 @@ void print_vector(const Vector* vec) {
     }
     printf("\n");
 }
+
+/**
+ * @brief Creates `num_vectors` vector views onto caller-owned storage.
+ *
+ * Vector `i` starts at `base + i * stride`. Only the pointer array and the
+ * `Vector` headers are allocated (one block); the element data is neither
+ * copied nor owned, e.g. for vectors of a memory-mapped model bundle. Free the
+ * views with `free_vector_slab(views, NULL)`.
+ *
+ * @param base First element of vector 0.
+ * @param num_vectors Number of vectors.
+ * @param stride Elements between the starts of consecutive vectors.
+ * @return Array of `num_vectors` vector views.
+ */
+Vector** create_vector_views(vector_element *base, int num_vectors, size_t stride) {
+    size_t count = (num_vectors > 0) ? (size_t)num_vectors : 1u;
+    unsigned char *block = (unsigned char *)malloc(count * (sizeof(Vector *) + sizeof(Vector)));
+    if (!block) {
+        fprintf(stderr, "Memory allocation failed for vector views\n");
+        exit(EXIT_FAILURE);
+    }
+
+    Vector **vectors = (Vector **)block;
+    Vector *views = (Vector *)(block + count * sizeof(Vector *));
+    for (size_t i = 0; i < count; i++) {
+        views[i].data = base + i * stride;
+        vectors[i] = &views[i];
+    }
+    return vectors;
+}
+
+/**
+ * @brief Allocates `num_vectors` vectors of `stride` elements in one slab; see `create_vector_slab`.
+ */
+static Vector** create_slab_with_stride(int num_vectors, size_t stride, vector_element **storage) {
+    size_t count = (num_vectors > 0) ? (size_t)num_vectors : 1u;
+    size_t slab_bytes = count * stride * sizeof(vector_element);
+
+    vector_element *slab = (vector_element *)aligned_alloc(VECTOR_ALIGNMENT, slab_bytes);
+    if (!slab) {
+        fprintf(stderr, "Memory allocation failed for vector slab\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(slab, 0, slab_bytes);
+
+    *storage = slab;
+    return create_vector_views(slab, num_vectors, stride);
+}
+
+/**
+ * @brief Allocates a set of vectors backed by one contiguous, cache-aligned slab.
+ *
+ * The element storage of all vectors lives in a single `VECTOR_ALIGNMENT`-aligned
+ * block; vector `i` starts at `storage + i * vector_slab_stride()`. The returned
+ * pointer array and the `Vector` headers it points to share a second allocation,
+ * so the whole set costs exactly two allocations regardless of `num_vectors`.
+ * The slab is zero-initialized.
+ *
+ * @param num_vectors Number of vectors to allocate.
+ * @param storage Receives the slab base pointer, needed by `free_vector_slab`.
+ * @return Array of `num_vectors` vector views into the slab.
+ *
+ * @warning Vectors obtained this way must not be passed to `free_vector`.
+ */
+Vector** create_vector_slab(int num_vectors, vector_element **storage) {
+    return create_slab_with_stride(num_vectors, vector_slab_stride(), storage);
+}
+
+/**
+ * @brief Allocates a set of base vectors in the packed sign layout (see `sign_vector_get`).
+ *
+ * Same as `create_vector_slab`, but every vector only holds
+ * `sign_vector_storage_count()` elements (rounded up to VECTOR_ALIGNMENT). In
+ * binary mode this is the regular slab. Free it with `free_vector_slab`.
+ *
+ * @param num_vectors Number of vectors to allocate.
+ * @param storage Receives the slab base pointer, needed by `free_vector_slab`.
+ * @return Array of `num_vectors` vector views into the slab.
+ */
+Vector** create_sign_vector_slab(int num_vectors, vector_element **storage) {
+    size_t bytes = sign_vector_storage_bytes();
+    bytes = (bytes + VECTOR_ALIGNMENT - 1) & ~((size_t)VECTOR_ALIGNMENT - 1);
+    return create_slab_with_stride(num_vectors, bytes / sizeof(vector_element), storage);
+}
+
+/**
+ * @brief Frees a vector set created by `create_vector_slab`.
+ *
+ * @param vectors The pointer array returned by `create_vector_slab`.
+ * @param storage The slab base pointer returned through `create_vector_slab`.
+ */
+void free_vector_slab(Vector **vectors, vector_element *storage) {
+    free(storage);
+    free(vectors);
+}
+
@@ -50,6 +50,22 @@ static inline size_t vector_storage_bytes(void) {
     return vector_storage_count() * sizeof(vector_element);
 }
 
+#ifndef VECTOR_ALIGNMENT
+#define VECTOR_ALIGNMENT 64
+#endif
+
+/**
+ * @brief Number of elements between consecutive vectors inside a slab.
+ *
+ * The per-vector storage is rounded up to a multiple of VECTOR_ALIGNMENT bytes so
+ * that every vector in a slab starts on its own cache line.
+ */
+static inline size_t vector_slab_stride(void) {
+    size_t bytes = vector_storage_bytes();
+    bytes = (bytes + VECTOR_ALIGNMENT - 1) & ~((size_t)VECTOR_ALIGNMENT - 1);
+    return bytes / sizeof(vector_element);
+}
+
 static inline void vector_zero(Vector *vec) {
     memset(vec->data, 0, vector_storage_bytes());
 }
@@ -108,10 +124,78 @@ static inline void vector_mask_tail(Vector *vec) {
 }
 #endif
 
+
+/**
+ * @brief Storage of base (item-memory) vectors, whose components are all +-1.
+ *
+ * In bipolar mode base vectors are packed to one sign bit per component (set bit
+ * = -1), VECTOR_SIGN_BITS components per element, instead of one `int` each;
+ * the encoder expands them on the fly while bundling. Encoded samples and class
+ * vectors keep full `vector_element` components. In binary mode base vectors
+ * already use one bit per component and the `sign_vector_*` helpers are the
+ * plain vector accessors.
+ */
+#if BIPOLAR_MODE
+#define VECTOR_SIGN_BITS 32
+#define VECTOR_SIGN_COUNT ((VECTOR_DIMENSION + VECTOR_SIGN_BITS - 1) / VECTOR_SIGN_BITS)
+
+static inline size_t sign_vector_storage_count(void) {
+    return (size_t)VECTOR_SIGN_COUNT;
+}
+
+static inline int sign_vector_get(const Vector *vec, int idx) {
+    const unsigned int *bits = (const unsigned int *)vec->data;
+    return ((bits[idx / VECTOR_SIGN_BITS] >> (idx % VECTOR_SIGN_BITS)) & 1u) ? -1 : 1;
+}
+
+static inline void sign_vector_set(Vector *vec, int idx, int value) {
+    unsigned int *bits = (unsigned int *)vec->data;
+    unsigned int mask = 1u << (idx % VECTOR_SIGN_BITS);
+    if (value < 0) {
+        bits[idx / VECTOR_SIGN_BITS] |= mask;
+    } else {
+        bits[idx / VECTOR_SIGN_BITS] &= ~mask;
+    }
+}
+
+static inline void sign_vector_flip(Vector *vec, int idx) {
+    unsigned int *bits = (unsigned int *)vec->data;
+    bits[idx / VECTOR_SIGN_BITS] ^= 1u << (idx % VECTOR_SIGN_BITS);
+}
+#else
+static inline size_t sign_vector_storage_count(void) {
+    return vector_storage_count();
+}
+
+static inline int sign_vector_get(const Vector *vec, int idx) {
+    return vector_get_bit(vec, idx);
+}
+
+static inline void sign_vector_set(Vector *vec, int idx, int value) {
+    vector_set_bit(vec, idx, value);
+}
+
+static inline void sign_vector_flip(Vector *vec, int idx) {
+    vector_flip_bit(vec, idx);
+}
+#endif
+
+static inline size_t sign_vector_storage_bytes(void) {
+    return sign_vector_storage_count() * sizeof(vector_element);
+}
+
+static inline void sign_vector_copy(Vector *dst, const Vector *src) {
+    memcpy(dst->data, src->data, sign_vector_storage_bytes());
+}
+
 // Function declarations
 Vector* create_vector();
 Vector* create_uninitialized_vector();
 void free_vector(Vector* vec);
+Vector** create_vector_slab(int num_vectors, vector_element **storage);
+Vector** create_sign_vector_slab(int num_vectors, vector_element **storage);
+Vector** create_vector_views(vector_element *base, int num_vectors, size_t stride);
+void free_vector_slab(Vector **vectors, vector_element *storage);
 void print_vector(const Vector* vec);
 
 #endif // VECTOR_H
@@ -0,0 +1,67 @@
+/**
+ * @file workspace.c
+ * @brief Allocation and lifetime of per-thread HDC scratch workspaces.
+ *
+ * @details
+ * All scratch hypervectors of a workspace live in one aligned slab; the n-gram
+ * ring buffer is allocated alongside it. Everything is allocated once in
+ * `init_hdc_workspace` and released in `free_hdc_workspace`.
+ */
+#include "workspace.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define WORKSPACE_SLAB_VECTORS 3
+
+/**
+ * @brief Allocates the scratch vectors and n-gram state of a workspace.
+ *
+ * @param ws The workspace to initialize.
+ *
+ * @warning The function exits with an error if `ws` is NULL or allocation fails.
+ */
+void init_hdc_workspace(struct hdc_workspace *ws) {
+    if (ws == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to init_hdc_workspace\n");
+        exit(EXIT_FAILURE);
+    }
+
+    ws->vectors = create_vector_slab(WORKSPACE_SLAB_VECTORS, &ws->storage);
+    ws->encoded = ws->vectors[0];
+    ws->scratch = ws->vectors[1];
+    ws->sample = ws->vectors[2];
+    init_ngram_encoder_state(&ws->ngram_state);
+}
+
+/**
+ * @brief Clears the n-gram state so the workspace can start a new stream.
+ *
+ * @param ws The workspace to reset.
+ */
+void reset_hdc_workspace(struct hdc_workspace *ws) {
+    if (ws == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to reset_hdc_workspace\n");
+        exit(EXIT_FAILURE);
+    }
+
+    reset_ngram_encoder_state(&ws->ngram_state);
+}
+
+/**
+ * @brief Releases all memory owned by a workspace.
+ *
+ * @param ws The workspace to free. NULL is ignored.
+ */
+void free_hdc_workspace(struct hdc_workspace *ws) {
+    if (ws == NULL) {
+        return;
+    }
+
+    free_ngram_encoder_state(&ws->ngram_state);
+    free_vector_slab(ws->vectors, ws->storage);
+    ws->vectors = NULL;
+    ws->storage = NULL;
+    ws->encoded = NULL;
+    ws->scratch = NULL;
+    ws->sample = NULL;
+}
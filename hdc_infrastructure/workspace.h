@@ -0,0 +1,44 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#ifdef HAND_EMG
+#include "../hand/configHand.h"
+#elif defined(FOOT_EMG)
+#include "../foot/configFoot.h"
+#elif defined(CUSTOM)
+#include "../customModel/configCustom.h"
+#else
+#error "No EMG type defined. Please define HAND_EMG or FOOT_EMG."
+#endif
+
+#include "vector.h"
+#include "encoder.h"
+
+/**
+ * @brief Per-thread scratch memory for encoding and classification.
+ *
+ * A workspace owns every temporary hypervector the encode/classify hot loops need,
+ * so that, once it is initialized, steady-state inference performs no heap
+ * allocation. Workspaces are not shared: create one per thread (e.g. one per
+ * OpenMP worker evaluating GA candidates) and pass it to the `_ws` entry points.
+ *
+ * - **encoded**: Timestamp hypervector produced by `encode_timestamp`.
+ * - **scratch**: Temporary for permutations in multi-step encodings.
+ * - **sample**: Encoded n-gram handed to the associative memory.
+ * - **ngram_state**: Ring buffer for streaming n-gram encoding.
+ * - **vectors**, **storage**: Aligned slab backing `encoded`, `scratch` and `sample`.
+ */
+struct hdc_workspace {
+    Vector *encoded;
+    Vector *scratch;
+    Vector *sample;
+    struct ngram_encoder_state ngram_state;
+    Vector **vectors;
+    vector_element *storage;
+};
+
+void init_hdc_workspace(struct hdc_workspace *ws);
+void reset_hdc_workspace(struct hdc_workspace *ws);
+void free_hdc_workspace(struct hdc_workspace *ws);
+
+#endif // WORKSPACE_H
@@ -1,20 +1,36 @@
 #ifndef BLOCK_ACCUMULATOR_H
 #define BLOCK_ACCUMULATOR_H
 
+#include <stdint.h>
 #include "hdc_types.h"
 
 // Window size für Rolling Bundling
 #define BLOCK_WINDOW 5
 
-// Muss einmal beim Programmstart aufgerufen werden
-void block_init(void);
+// Zustand eines Rolling-Accumulators. Jede Sequenz bekommt ihre eigene
+// Instanz; Instanzen teilen keinen Zustand und können parallel laufen.
+// Intern in 64-bit Wörtern, der gesamte Speicher wird bei init angelegt.
+typedef struct {
+    int bits;           // 32 * chunks_per_vec() beim init
+    int words;          // 64-bit Wörter pro Vektor
+    int window_filled;
+    int window_pos;
+    uint64_t* window;   // BLOCK_WINDOW rotierte Samples, je `words` Wörter
+    uint64_t* scratch;  // Eingabe-Sample und Änderung für out
+} block_accumulator;
+
+// Nach dem Setzen von D aufrufen; 0 bei Erfolg, -1 wenn kein Speicher
+int block_accumulator_init(block_accumulator* acc);
+
+// Gibt den Speicher frei (auch für eine mit {0} initialisierte Instanz)
+void block_accumulator_free(block_accumulator* acc);
 
 // Reset des accumulators (für neues Signal / neue Sequenz)
-void block_reset(void);
+void block_accumulator_reset(block_accumulator* acc);
 
 // Berechnet Rolling-Block-Bundling:
 // - input_sample: HV eines einzelnen Samples (aus encode_sample())
-// - out: aktueller Rolling-HV (wird aktualisiert)
-void block_accumulate(hv_t out, hv_t input_sample);
+// - out: aktueller Rolling-HV (wird aktualisiert), nach reset mit 0 starten
+void block_accumulator_push(block_accumulator* acc, hv_t out, const hv_t input_sample);
 
 #endif
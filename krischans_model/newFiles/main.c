@@ -76,8 +76,13 @@ int main(int argc, char* argv[])
     int64_t train_total_duration = 0;
     int train_measured_runs = 0;
 
+    block_accumulator block_acc = {0};
+
     alloc_memory();
-    if (mode == 1) block_init();
+    if (mode == 1 && block_accumulator_init(&block_acc) != 0) {
+        fprintf(stderr, "Failed to allocate the rolling accumulator\n");
+        return 1;
+    }
 
     load_im("memoryfiles/position-vectors.txt");
     load_cm("memoryfiles/value_vectors.txt");
@@ -178,7 +183,7 @@ int main(int argc, char* argv[])
     hv_t rolling_acc = NULL;
     if (mode == 1) {
         rolling_acc = hv_alloc();
-        block_reset();
+        block_accumulator_reset(&block_acc);
     }
 
     srand(0);
@@ -209,7 +214,7 @@ int main(int argc, char* argv[])
                 }
             }
         } else {
-            block_accumulate(rolling_acc, hv_single);
+            block_accumulator_push(&block_acc, rolling_acc, hv_single);
             if (i >= BLOCK_WINDOW - 1) {
                 if (target_per_class[c] > 0) {
                     seen_per_class[c]++;
@@ -262,7 +267,7 @@ int main(int argc, char* argv[])
     if (mode == 1) {
         hv_test_roll = hv_alloc();
         memset(hv_test_roll, 0, (size_t)chunks_per_vec()*sizeof(uint32_t));
-        block_reset();
+        block_accumulator_reset(&block_acc);
     }
     
     FILE *fp_pred = fopen("predicted_labels.txt", "w");
@@ -293,7 +298,7 @@ int main(int argc, char* argv[])
             pred_local = classify(hv_test_single);
             did_classify = 1;
         } else {
-            block_accumulate(hv_test_roll, hv_test_single);
+            block_accumulator_push(&block_acc, hv_test_roll, hv_test_single);
             if (i >= BLOCK_WINDOW - 1) { pred_local = classify(hv_test_roll); did_classify = 1; }
         }
 
@@ -354,6 +359,7 @@ int main(int argc, char* argv[])
     if (hv_test_roll) hv_free(hv_test_roll);
     if (rolling_acc) hv_free(rolling_acc);
 
+    block_accumulator_free(&block_acc);
     free_memory();
     return 0;
 }
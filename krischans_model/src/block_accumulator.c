@@ -1,58 +1,107 @@
 #include "block_accumulator.h"
-#include "hdc_utils.h"
 #include <stdlib.h>
 #include <string.h>
 
-static hv_t window[BLOCK_WINDOW] = {0};
-static int window_filled = 0;
-static int window_pos = 0;
+#if BLOCK_WINDOW > 64
+#error "block_accumulator rotates by at most 63 bits"
+#endif
 
-void block_init(void)
+// hv_t ist ein Array von uint32_t; je zwei Chunks bilden ein 64-bit Wort
+// (little-endian), ein ungerader letzter Chunk wird mit 0 aufgefüllt.
+static void pack_words(uint64_t* dst, const hv_t src, int words)
 {
-    for(int i = 0; i < BLOCK_WINDOW; i++)
-        window[i] = hv_alloc();
-
-    window_filled = 0;
-    window_pos = 0;
+    int chunks = chunks_per_vec();
+    for(int w = 0; w < words; w++) {
+        uint64_t lo = src[2 * w];
+        uint64_t hi = (2 * w + 1 < chunks) ? src[2 * w + 1] : 0;
+        dst[w] = lo | (hi << 32);
+    }
 }
 
-void block_reset(void)
+static void xor_into(hv_t out, const uint64_t* delta, int words)
 {
     int chunks = chunks_per_vec();
+    for(int w = 0; w < words; w++) {
+        out[2 * w] ^= (uint32_t)delta[w];
+        if(2 * w + 1 < chunks)
+            out[2 * w + 1] ^= (uint32_t)(delta[w] >> 32);
+    }
+}
+
+// Rotation um `shift` Bits nach rechts über den ganzen Vektor aus `bits`
+// Bits (alle Chunks, wie hv_rotate_right). Bits oberhalb von `bits` sind 0.
+static void rotate_right_words(uint64_t* out, const uint64_t* in, int words, int bits, int shift)
+{
+    if(shift == 0) {
+        memcpy(out, in, (size_t)words * sizeof(uint64_t));
+        return;
+    }
 
-    for(int i = 0; i < BLOCK_WINDOW; i++)
-        memset(window[i], 0, chunks * sizeof(uint32_t));
+    for(int w = 0; w < words; w++) {
+        uint64_t next = (w + 1 < words) ? in[w + 1] : 0;
+        out[w] = (in[w] >> shift) | (next << (64 - shift));
+    }
 
-    window_filled = 0;
-    window_pos = 0;
+    // Die untersten `shift` Bits wandern an das obere Ende
+    uint64_t wrapped = in[0] & ((UINT64_C(1) << shift) - 1);
+    int pos = bits - shift;
+    int offset = pos % 64;
+    out[pos / 64] |= wrapped << offset;
+    if(offset + shift > 64)
+        out[pos / 64 + 1] |= wrapped >> (64 - offset);
+}
+
+int block_accumulator_init(block_accumulator* acc)
+{
+    acc->bits = 32 * chunks_per_vec();
+    acc->words = (acc->bits + 63) / 64;
+    acc->window = calloc((size_t)BLOCK_WINDOW * acc->words, sizeof(uint64_t));
+    acc->scratch = calloc(2 * (size_t)acc->words, sizeof(uint64_t));
+    if(!acc->window || !acc->scratch) {
+        block_accumulator_free(acc);
+        return -1;
+    }
+
+    acc->window_filled = 0;
+    acc->window_pos = 0;
+    return 0;
+}
+
+void block_accumulator_free(block_accumulator* acc)
+{
+    free(acc->window);
+    free(acc->scratch);
+    acc->window = NULL;
+    acc->scratch = NULL;
+}
+
+void block_accumulator_reset(block_accumulator* acc)
+{
+    memset(acc->window, 0, (size_t)BLOCK_WINDOW * acc->words * sizeof(uint64_t));
+    acc->window_filled = 0;
+    acc->window_pos = 0;
 }
 
 // input_sample = HV_single (Output von encode_sample())
 // out          = Rolling-HV, wird von dir extern bereitgestellt
-void block_accumulate(hv_t out, hv_t input_sample)
+void block_accumulator_push(block_accumulator* acc, hv_t out, const hv_t input_sample)
 {
-    hv_t rotated = hv_alloc();
-
-    // Permutation abhängig vom Fensterindex
-    hv_rotate_right(rotated, input_sample, window_pos);
+    int words = acc->words;
+    uint64_t* input = acc->scratch;
+    uint64_t* delta = acc->scratch + words;
+    uint64_t* slot = acc->window + (size_t)acc->window_pos * words;
 
-    if(window_filled < BLOCK_WINDOW)
-    {
-        // Einfach hinzufügen
-        hv_xor(out, out, rotated);
-        hv_copy(window[window_pos], rotated);
-        window_filled++;
-    }
-    else
-    {
-        // Ältesten entfernen
-        hv_xor(out, out, window[window_pos]);
-        // Neuen hinzufügen
-        hv_xor(out, out, rotated);
-        hv_copy(window[window_pos], rotated);
-    }
+    pack_words(input, input_sample, words);
 
-    window_pos = (window_pos + 1) % BLOCK_WINDOW;
+    // Ältesten entfernen (Slot ist 0, solange das Fenster nicht voll ist),
+    // neuen mit Permutation abhängig vom Fensterindex hinzufügen
+    memcpy(delta, slot, (size_t)words * sizeof(uint64_t));
+    rotate_right_words(slot, input, words, acc->bits, acc->window_pos);
+    for(int w = 0; w < words; w++)
+        delta[w] ^= slot[w];
+    xor_into(out, delta, words);
 
-    hv_free(rotated);
+    if(acc->window_filled < BLOCK_WINDOW)
+        acc->window_filled++;
+    acc->window_pos = (acc->window_pos + 1) % BLOCK_WINDOW;
 }
@@ -28,8 +28,13 @@ int main(int argc, char* argv[])
     printf("=== CPU HDC Dynamic ===\n");
     printf("D = %d, M = %d, mode = %d\n", D, M, mode);
 
+    block_accumulator block_acc = {0};
+
     alloc_memory();
-    if(mode == 1) block_init();
+    if(mode == 1 && block_accumulator_init(&block_acc) != 0) {
+        fprintf(stderr, "Failed to allocate the rolling accumulator\n");
+        return 1;
+    }
 
     load_im("memoryfiles/position-vectors.txt");
     load_cm("memoryfiles/value_vectors.txt");
@@ -89,7 +94,7 @@ int main(int argc, char* argv[])
         hv_t rolling_acc = NULL;
         if(mode == 1) {
             rolling_acc = hv_alloc();   // output des Rolling-Fensters
-            block_reset();
+            block_accumulator_reset(&block_acc);
         }
 
         // -----------------------------
@@ -114,7 +119,7 @@ int main(int argc, char* argv[])
             }
             else {
                 // Rolling Pfad
-                block_accumulate(rolling_acc, hv_single);
+                block_accumulator_push(&block_acc, rolling_acc, hv_single);
 
                 if(i >= BLOCK_WINDOW - 1) {
                     // Erst ab Sample 5 entsteht ein Rolling-HV
@@ -145,7 +150,7 @@ int main(int argc, char* argv[])
         if(mode == 1) {
             hv_test_roll = hv_alloc();
             memset(hv_test_roll, 0, chunks_per_vec()*sizeof(uint32_t));
-            block_reset();
+            block_accumulator_reset(&block_acc);
         }
 
         int correct = 0;
@@ -158,7 +163,7 @@ int main(int argc, char* argv[])
             if(mode == 0) {
                 pred = classify(hv_test_single);
             } else {
-                block_accumulate(hv_test_roll, hv_test_single);
+                block_accumulator_push(&block_acc, hv_test_roll, hv_test_single);
                 if(i < BLOCK_WINDOW - 1) 
                     continue; // noch kein vollständiger Block
                 pred = classify(hv_test_roll);
@@ -196,6 +201,7 @@ int main(int argc, char* argv[])
 
     printf("Accuracy: %.2f%%\n", mean_accuracy / 4);
 
+    block_accumulator_free(&block_acc);
     free_memory();
 
     return 0;
@@ -33,23 +33,93 @@
 #define NGRAM_PES 8
 #endif
 
+// Hypervectors as packed uint64_t words (1) or sc_dt::sc_bv (0).
+// Both give the same results and simulated times; words simulate much faster.
+#ifndef HV_NATIVE_WORDS
+#define HV_NATIVE_WORDS 1
+#endif
+
 // Distance computation is parallelized across classes.
 // The accelerator instantiates one distance PE per class.
 
-#ifndef ACCEL_LATENCY_ENCODE_NS
-#define ACCEL_LATENCY_ENCODE_NS 1
+// Pipelined timing model. Every PE processes ACCEL_PE_WORD_BITS bits per
+// clock, which sets each stage's initiation interval (II):
+//   encoder:  NUM_FEATURES * ceil(D / ENCODER_PES / word) cycles
+//   n-gram:   (N_GRAM_SIZE - 1) * ceil(D / NGRAM_PES / word) cycles
+//   bundler:  ceil(D / word) cycles (one counter word per cycle)
+//   distance: ceil(D / word) cycles (one PE per class)
+// A result leaves its stage ACCEL_DEPTH_*_CYCLES after its II.
+#ifndef ACCEL_CLOCK_PERIOD_NS
+#define ACCEL_CLOCK_PERIOD_NS 1
+#endif
+
+#ifndef ACCEL_PE_WORD_BITS
+#define ACCEL_PE_WORD_BITS 64
+#endif
+
+#ifndef ACCEL_DEPTH_ENCODE_CYCLES
+#define ACCEL_DEPTH_ENCODE_CYCLES 2
+#endif
+
+#ifndef ACCEL_DEPTH_NGRAM_CYCLES
+#define ACCEL_DEPTH_NGRAM_CYCLES 1
+#endif
+
+#ifndef ACCEL_DEPTH_DISTANCE_CYCLES
+#define ACCEL_DEPTH_DISTANCE_CYCLES 2
+#endif
+
+// Depth of the FIFOs between the stages; a full FIFO stalls its producer.
+#ifndef ACCEL_FIFO_DEPTH
+#define ACCEL_FIFO_DEPTH 8
+#endif
+
+// Accelerator-to-memory TLM port. With DMI the accelerator uses direct
+// pointers (fast functional runs); without it every hypervector goes through
+// b_transport. DMI is only granted while the memory is untimed, so timed runs
+// always go through the bank model below.
+#ifndef HDC_TLM_DMI
+#define HDC_TLM_DMI 1
+#endif
+
+// Global quantum of the temporally decoupled accelerator threads.
+#ifndef HDC_TLM_QUANTUM_NS
+#define HDC_TLM_QUANTUM_NS 1000
+#endif
+
+// Time one memory port takes per hypervector: latency plus bytes over the
+// port bandwidth. A bandwidth of 0 means unlimited; the defaults give an
+// untimed memory.
+#ifndef HDC_MEMORY_LATENCY_NS
+#define HDC_MEMORY_LATENCY_NS 0
+#endif
+
+#ifndef HDC_BUS_BYTES_PER_NS
+#define HDC_BUS_BYTES_PER_NS 0
+#endif
+
+// Banked CiM and associative memory. CiM rows map to banks by feature
+// (HDC_CIM_BANK_BY_LEVEL 0) or by level (1), class vectors by class id.
+// A bank serves as many accesses at once as it has ports; an access that
+// finds all of them busy waits for the first free one (a conflict).
+#ifndef HDC_CIM_BANKS
+#define HDC_CIM_BANKS 8
+#endif
+
+#ifndef HDC_CIM_BANK_BY_LEVEL
+#define HDC_CIM_BANK_BY_LEVEL 0
 #endif
 
-#ifndef ACCEL_LATENCY_NGRAM_NS
-#define ACCEL_LATENCY_NGRAM_NS 1
+#ifndef HDC_CIM_PORTS_PER_BANK
+#define HDC_CIM_PORTS_PER_BANK 1
 #endif
 
-#ifndef ACCEL_LATENCY_BUNDLE_NS
-#define ACCEL_LATENCY_BUNDLE_NS 1
+#ifndef HDC_ASSOC_BANKS
+#define HDC_ASSOC_BANKS 1
 #endif
 
-#ifndef ACCEL_LATENCY_DISTANCE_NS
-#define ACCEL_LATENCY_DISTANCE_NS 1
+#ifndef HDC_ASSOC_PORTS_PER_BANK
+#define HDC_ASSOC_PORTS_PER_BANK 1
 #endif
 
 #endif
@@ -60,6 +60,12 @@ void clear_memory_stats(MemoryStats &stats) {
     stats.assoc_read_bytes = 0;
     stats.assoc_writes = 0;
     stats.assoc_write_bytes = 0;
+    for (int bank = 0; bank < HDC_CIM_BANKS; ++bank) {
+        stats.cim_banks[bank] = BankStats();
+    }
+    for (int bank = 0; bank < HDC_ASSOC_BANKS; ++bank) {
+        stats.assoc_banks[bank] = BankStats();
+    }
 }
 
 void clear_accelerator_stats(AcceleratorStats &stats) {
@@ -73,23 +79,35 @@ void clear_accelerator_stats(AcceleratorStats &stats) {
     stats.bundle_flushes = 0;
     stats.distance_requests = 0;
     stats.valid_distance_requests = 0;
+    stats.bus_reads = 0;
+    stats.bus_writes = 0;
+    stats.bus_bytes = 0;
+    stats.dmi_accesses = 0;
+    stats.bus_time_ps = 0;
+    for (int stage = 0; stage < ACCEL_NUM_STAGES; ++stage) {
+        stats.stage_busy_cycles[stage] = 0;
+        stats.stage_stall_cycles[stage] = 0;
+    }
 }
 
 } // namespace
 
-Controller::Controller(sc_core::sc_module_name name)
+Controller::Controller(sc_core::sc_module_name name, const AcceleratorConfig &accelerator_config)
     : sc_module(name),
       m_done(false),
       m_memory("hdc_memory"),
       m_cmd_fifo("cmd_fifo", 16),
-      m_rsp_fifo("rsp_fifo", 16),
-      m_accelerator("hdc_accelerator") {
+      m_rsp_fifo("rsp_fifo", RESPONSE_FIFO_DEPTH),
+      m_accelerator("hdc_accelerator", accelerator_config) {
     for (int dataset = 0; dataset < NUM_DATASETS; ++dataset) {
         m_dataset_configs[dataset].dataset_id = dataset;
         m_dataset_configs[dataset].cim_path = 0;
         m_dataset_configs[dataset].quantizer_path = 0;
+        m_dataset_configs[dataset].cim = 0;
+        m_dataset_configs[dataset].quantizer_cuts = 0;
         m_dataset_configs[dataset].dataset = 0;
         m_dataset_configs[dataset].configured = false;
+        m_dataset_configs[dataset].enabled = true;
         clear_evaluation_result(m_test_results[dataset]);
         clear_memory_stats(m_memory_stats[dataset]);
         clear_accelerator_stats(m_accelerator_stats[dataset]);
@@ -98,7 +116,7 @@ Controller::Controller(sc_core::sc_module_name name)
 
     m_accelerator.cmd_in(m_cmd_fifo);
     m_accelerator.rsp_out(m_rsp_fifo);
-    m_accelerator.bind_memory(&m_memory);
+    m_accelerator.memory_socket.bind(m_memory.socket);
     SC_THREAD(main_thread);
 }
 
@@ -117,10 +135,44 @@ void Controller::configure(int dataset_id,
     config.dataset_id = dataset_id;
     config.cim_path = cim_path;
     config.quantizer_path = quantizer_path;
+    config.cim = 0;
+    config.quantizer_cuts = 0;
+    config.dataset = dataset;
+    config.configured = true;
+}
+
+void Controller::configure(int dataset_id,
+                           const hv_t *cim,
+                           const double *quantizer_cuts,
+                           const FootDataset *dataset) {
+    if (dataset_id < 0 || dataset_id >= NUM_DATASETS) {
+        SC_REPORT_FATAL("Controller", "dataset_id out of range");
+    }
+    if (cim == 0 || (quantizer_cuts == 0 && NUM_LEVELS > 1) || dataset == 0) {
+        SC_REPORT_FATAL("Controller", "invalid dataset configuration");
+    }
+
+    DatasetConfig &config = m_dataset_configs[dataset_id];
+    config.dataset_id = dataset_id;
+    config.cim_path = 0;
+    config.quantizer_path = 0;
+    config.cim = cim;
+    config.quantizer_cuts = quantizer_cuts;
     config.dataset = dataset;
     config.configured = true;
 }
 
+void Controller::set_dataset_enabled(int dataset_id, bool enabled) {
+    if (dataset_id < 0 || dataset_id >= NUM_DATASETS) {
+        SC_REPORT_FATAL("Controller", "dataset_id out of range");
+    }
+    m_dataset_configs[dataset_id].enabled = enabled;
+}
+
+void Controller::set_accelerator_observer(AcceleratorObserver *observer) {
+    m_accelerator.set_observer(observer);
+}
+
 bool Controller::done() const {
     return m_done;
 }
@@ -153,16 +205,28 @@ const sc_core::sc_time &Controller::dataset_sim_time(int dataset_id) const {
     return m_dataset_sim_times[dataset_id];
 }
 
+const AcceleratorConfig &Controller::accelerator_config() const {
+    return m_accelerator.config();
+}
+
 void Controller::main_thread() {
     for (int dataset = 0; dataset < NUM_DATASETS; ++dataset) {
         const DatasetConfig &config = m_dataset_configs[dataset];
+        if (!config.enabled) {
+            continue;
+        }
         if (!config.configured) {
             SC_REPORT_FATAL("Controller", "dataset not configured before simulation start");
         }
 
         m_memory.clear_all();
-        load_cim(config.cim_path);
-        load_quantizer(config.quantizer_path);
+        if (config.cim != 0) {
+            m_memory.set_cim(config.cim);
+            m_memory.set_quantizer_boundaries(config.quantizer_cuts);
+        } else {
+            load_cim(config.cim_path);
+            load_quantizer(config.quantizer_path);
+        }
         m_memory.reset_stats();
         m_accelerator.reset_stats();
 
@@ -209,15 +273,13 @@ void Controller::send_command(const AccelCommand &command) {
     m_cmd_fifo.write(command);
 }
 
-AccelResponse Controller::send_inference_command(const AccelCommand &command) {
-    m_cmd_fifo.write(command);
-
+AccelResponse Controller::receive_response() {
     AccelResponse response;
     m_rsp_fifo.read(response);
     return response;
 }
 
-void Controller::load_cim(const char *path) {
+std::vector<hv_t> load_cim_text(const char *path) {
     if (path == 0 || path[0] == '\0') {
         SC_REPORT_FATAL("Controller", "CiM path must not be null or empty");
     }
@@ -298,16 +360,15 @@ void Controller::load_cim(const char *path) {
         SC_REPORT_FATAL("Controller", "CiM text file does not contain all entries");
     }
 
-    m_memory.set_cim(flat_cim.data());
+    return flat_cim;
 }
 
-void Controller::load_quantizer(const char *path) {
+std::vector<double> load_quantizer_text(const char *path) {
     if (path == 0 || path[0] == '\0') {
         SC_REPORT_FATAL("Controller", "quantizer path must not be null or empty");
     }
     if (NUM_LEVELS <= 1) {
-        m_memory.set_quantizer_boundaries(0);
-        return;
+        return std::vector<double>();
     }
 
     std::ifstream file(path);
@@ -369,7 +430,17 @@ void Controller::load_quantizer(const char *path) {
         SC_REPORT_FATAL("Controller", "quantizer text file does not contain all features");
     }
 
-    m_memory.set_quantizer_boundaries(flat_boundaries.data());
+    return flat_boundaries;
+}
+
+void Controller::load_cim(const char *path) {
+    const std::vector<hv_t> flat_cim = load_cim_text(path);
+    m_memory.set_cim(flat_cim.data());
+}
+
+void Controller::load_quantizer(const char *path) {
+    const std::vector<double> flat_boundaries = load_quantizer_text(path);
+    m_memory.set_quantizer_boundaries(flat_boundaries.empty() ? 0 : flat_boundaries.data());
 }
 
 level_t Controller::quantize_value(unsigned feature, double value) const {
@@ -462,6 +533,38 @@ int Controller::get_ngram_real_label(const int *labels, int size) const {
     return max_value;
 }
 
+void Controller::score_response(const int *labels,
+                                int sample,
+                                const AccelResponse &response,
+                                EvaluationResult &result) const {
+    if (!response.valid_prediction) {
+        return;
+    }
+
+    const int ngram_start = sample - N_GRAM_SIZE + 1;
+    const int actual = get_ngram_real_label(&labels[ngram_start], N_GRAM_SIZE);
+    int predicted = 0;
+    distance_counter_t best_distance = response.distances[0];
+    for (int class_id = 1; class_id < NUM_CLASSES; ++class_id) {
+        if (response.distances[class_id] < best_distance) {
+            best_distance = response.distances[class_id];
+            predicted = class_id;
+        }
+    }
+
+    if (actual >= 0 && actual < NUM_CLASSES && predicted >= 0 && predicted < NUM_CLASSES) {
+        ++result.confusion_matrix[actual][predicted];
+    }
+
+    if (predicted == actual) {
+        ++result.correct;
+    } else if (labels[ngram_start] != labels[ngram_start + N_GRAM_SIZE - 1]) {
+        ++result.transition_error;
+    } else {
+        ++result.not_correct;
+    }
+}
+
 EvaluationResult Controller::evaluate_dataset(const double *raw_data, const int *labels, int num_samples) {
     if (raw_data == 0 || labels == 0) {
         SC_REPORT_FATAL("Controller", "evaluation data and labels must not be null");
@@ -475,39 +578,28 @@ EvaluationResult Controller::evaluate_dataset(const double *raw_data, const int
     command.class_id = 0;
     send_command(command);
 
+    // Keep up to RESPONSE_FIFO_DEPTH samples in flight so the accelerator
+    // pipeline stays full; responses come back in order.
+    int in_flight[RESPONSE_FIFO_DEPTH];
+    int issued = 0;
+    int completed = 0;
     level_t quantized_sample[NUM_FEATURES];
     for (int sample = 0; sample < num_samples; ++sample) {
+        if (issued - completed == RESPONSE_FIFO_DEPTH) {
+            score_response(labels, in_flight[completed % RESPONSE_FIFO_DEPTH], receive_response(), result);
+            ++completed;
+        }
         quantize_sample(&raw_data[sample * NUM_FEATURES], quantized_sample);
         command.kind = AccelCommandKind::InferSample;
         command.class_id = 0;
         copy_quantized_sample(quantized_sample, command.sample);
-        const AccelResponse response = send_inference_command(command);
-        if (!response.valid_prediction) {
-            continue;
-        }
-
-        const int ngram_start = sample - N_GRAM_SIZE + 1;
-        const int actual = get_ngram_real_label(&labels[ngram_start], N_GRAM_SIZE);
-        int predicted = 0;
-        distance_counter_t best_distance = response.distances[0];
-        for (int class_id = 1; class_id < NUM_CLASSES; ++class_id) {
-            if (response.distances[class_id] < best_distance) {
-                best_distance = response.distances[class_id];
-                predicted = class_id;
-            }
-        }
-
-        if (actual >= 0 && actual < NUM_CLASSES && predicted >= 0 && predicted < NUM_CLASSES) {
-            ++result.confusion_matrix[actual][predicted];
-        }
-
-        if (predicted == actual) {
-            ++result.correct;
-        } else if (labels[ngram_start] != labels[ngram_start + N_GRAM_SIZE - 1]) {
-            ++result.transition_error;
-        } else {
-            ++result.not_correct;
-        }
+        send_command(command);
+        in_flight[issued % RESPONSE_FIFO_DEPTH] = sample;
+        ++issued;
+    }
+    while (completed < issued) {
+        score_response(labels, in_flight[completed % RESPONSE_FIFO_DEPTH], receive_response(), result);
+        ++completed;
     }
 
     result.total = result.correct + result.not_correct + result.transition_error;
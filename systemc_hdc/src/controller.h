@@ -2,6 +2,7 @@
 #define SYSTEMC_HDC_CONTROLLER_H
 
 #include <systemc>
+#include <vector>
 #include "systemc_types.h"
 #include "hdc_transactions.h"
 #include "hdc_memory.h"
@@ -10,27 +11,51 @@
 
 namespace hdc_systemc {
 
+// The CiM (NUM_LEVELS * NUM_FEATURES, level-major) and quantizer
+// (feature-major cuts, empty for one level) text exports, checked against
+// config_systemc.h.
+std::vector<hv_t> load_cim_text(const char *path);
+std::vector<double> load_quantizer_text(const char *path);
+
 SC_MODULE(Controller) {
 public:
-    SC_CTOR(Controller);
+    SC_HAS_PROCESS(Controller);
+    Controller(sc_core::sc_module_name name, const AcceleratorConfig &accelerator_config = AcceleratorConfig());
 
     void configure(int dataset_id,
                    const char *cim_path,
                    const char *quantizer_path,
                    const FootDataset *dataset);
+    // Same, with the item memory (NUM_LEVELS * NUM_FEATURES, level-major) and
+    // the feature-major quantizer cuts already in memory; both must outlive
+    // the simulation.
+    void configure(int dataset_id,
+                   const hv_t *cim,
+                   const double *quantizer_cuts,
+                   const FootDataset *dataset);
+    // Disabled datasets are skipped (and need no configuration), so one
+    // process can simulate a subset of them.
+    void set_dataset_enabled(int dataset_id, bool enabled);
+    void set_accelerator_observer(AcceleratorObserver *observer);
     bool done() const;
     const EvaluationResult &test_result(int dataset_id) const;
     const MemoryStats &memory_stats(int dataset_id) const;
     const AcceleratorStats &accelerator_stats(int dataset_id) const;
     const sc_core::sc_time &dataset_sim_time(int dataset_id) const;
+    const AcceleratorConfig &accelerator_config() const;
 
 private:
+    static constexpr int RESPONSE_FIFO_DEPTH = 16;
+
     struct DatasetConfig {
         int dataset_id;
         const char *cim_path;
         const char *quantizer_path;
+        const hv_t *cim;
+        const double *quantizer_cuts;
         const FootDataset *dataset;
         bool configured;
+        bool enabled;
     };
 
     void main_thread();
@@ -43,7 +68,8 @@ private:
     int get_ngram_real_label(const int *labels, int size) const;
     void copy_quantized_sample(const level_t *levels, QuantizedSample &sample) const;
     void send_command(const AccelCommand &command);
-    AccelResponse send_inference_command(const AccelCommand &command);
+    AccelResponse receive_response();
+    void score_response(const int *labels, int sample, const AccelResponse &response, EvaluationResult &result) const;
 
     DatasetConfig m_dataset_configs[NUM_DATASETS];
     EvaluationResult m_test_results[NUM_DATASETS];
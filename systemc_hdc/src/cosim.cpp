@@ -0,0 +1,434 @@
+// Lockstep co-simulation against the C reference model.
+//
+// Usage:
+//   systemc_hdc_cosim [assoc=reference|accelerator] [trace=N] [accelerator options]
+//
+// hdc_infrastructure is linked in (cosim_reference.c). Per dataset it fits the
+// quantizer, builds the seeded item memory and trains its associative memory;
+// the accelerator is loaded with the same cuts and item memory in-process, so
+// no exported files are involved. Both models then see every sample: the
+// observer compares the quantized levels and encoded hypervector of each
+// sample, each n-gram, the class vectors once training is done and the
+// per-class distances of each inference. The simulation stops at the first
+// mismatch, printing it with the last N checks (trace=N, default 16).
+// With assoc=accelerator the reference distances use the accelerator's class
+// vectors instead of comparing them, so the inference datapath is still
+// checked when training diverges. Accelerator options are name=value as for
+// tb_systemc (see parse_accelerator_option).
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "controller.h"
+#include "cosim_reference.h"
+#include "foot_dataset_loader.h"
+
+using namespace hdc_systemc;
+
+namespace {
+
+void hv_to_words(const hv_t &hv, std::uint64_t *words) {
+    for (int w = 0; w < COSIM_HV_WORDS; ++w) {
+        words[w] = 0;
+    }
+    for (int d = 0; d < VECTOR_DIMENSION; ++d) {
+        if (hv[d].to_bool()) {
+            words[d >> 6] |= std::uint64_t(1) << (d & 63);
+        }
+    }
+}
+
+hv_t words_to_hv(const std::uint64_t *words) {
+    hv_t hv;
+    for (int d = 0; d < VECTOR_DIMENSION; ++d) {
+        hv[d] = ((words[d >> 6] >> (d & 63)) & 1u) != 0 ? sc_dt::SC_LOGIC_1 : sc_dt::SC_LOGIC_0;
+    }
+    return hv;
+}
+
+// Differing bits of two hypervectors, with the first differing words.
+std::string describe_hv_diff(const std::uint64_t *accelerator, const std::uint64_t *reference) {
+    std::ostringstream out;
+    int bits = 0;
+    for (int w = 0; w < COSIM_HV_WORDS; ++w) {
+        bits += __builtin_popcountll(accelerator[w] ^ reference[w]);
+    }
+    out << "  " << bits << " of " << VECTOR_DIMENSION << " bits differ\n";
+    int shown = 0;
+    for (int w = 0; w < COSIM_HV_WORDS && shown < 8; ++w) {
+        if (accelerator[w] == reference[w]) {
+            continue;
+        }
+        char line[96];
+        std::snprintf(line, sizeof(line), "  bits %5d..%5d: accelerator %016llx reference %016llx\n", w * 64,
+                      w * 64 + 63, static_cast<unsigned long long>(accelerator[w]),
+                      static_cast<unsigned long long>(reference[w]));
+        out << line;
+        ++shown;
+    }
+    return out.str();
+}
+
+std::string describe_levels(const char *model, const int *levels) {
+    std::ostringstream out;
+    out << "  " << model << " levels:";
+    for (int feature = 0; feature < NUM_FEATURES; ++feature) {
+        out << ' ' << levels[feature];
+    }
+    out << '\n';
+    return out.str();
+}
+
+class LockstepChecker : public AcceleratorObserver {
+public:
+    LockstepChecker(const FootDataset *datasets, cosim_reference *const *references, bool accelerator_classes,
+                    std::size_t trace_depth)
+        : m_datasets(datasets),
+          m_references(references),
+          m_accelerator_classes(accelerator_classes),
+          m_trace_depth(trace_depth),
+          m_failed(false),
+          m_classes_checked(false),
+          m_encodings(0),
+          m_ngrams(0),
+          m_class_checks(0),
+          m_distance_checks(0) {
+        std::memset(m_class_words, 0, sizeof(m_class_words));
+    }
+
+    bool failed() const { return m_failed; }
+
+    void print_summary(std::ostream &out) const {
+        out << "cosim: all checks passed: " << m_encodings << " encodings, " << m_ngrams << " n-grams, "
+            << m_class_checks << " class vectors, " << m_distance_checks << " distance vectors" << std::endl;
+    }
+
+    void encoded(const PipelineItem &item) override {
+        if (m_failed || !advance(m_encoder, item)) {
+            return;
+        }
+        cosim_reference *ref = m_references[m_encoder.dataset];
+        int reference_levels[NUM_FEATURES];
+        int accelerator_levels[NUM_FEATURES];
+        cosim_reference_quantize(ref, raw_sample(m_encoder), reference_levels);
+        bool levels_match = true;
+        for (int feature = 0; feature < NUM_FEATURES; ++feature) {
+            accelerator_levels[feature] = item.sample.levels[feature].to_int();
+            levels_match = levels_match && accelerator_levels[feature] == reference_levels[feature];
+        }
+        if (!levels_match) {
+            fail("quantizer", m_encoder,
+                 describe_levels("accelerator", accelerator_levels) + describe_levels("reference", reference_levels));
+            return;
+        }
+
+        std::uint64_t reference[COSIM_HV_WORDS];
+        std::uint64_t accelerator[COSIM_HV_WORDS];
+        cosim_reference_encode(ref, reference_levels, reference);
+        hv_to_words(item.encoded, accelerator);
+        if (std::memcmp(reference, accelerator, sizeof(reference)) != 0) {
+            fail("encoder", m_encoder, describe_levels("sample", reference_levels) +
+                                           describe_hv_diff(accelerator, reference));
+            return;
+        }
+        ++m_encodings;
+        record("encoder", m_encoder);
+    }
+
+    void ngram(const PipelineItem &item) override {
+        if (m_failed) {
+            return;
+        }
+        if (!advance(m_ngram, item)) {
+            if (item.kind == AccelCommandKind::ResetTraining) {
+                std::memset(m_class_words, 0, sizeof(m_class_words));
+                m_classes_checked = false;
+            }
+            cosim_reference_reset_ngram(m_references[m_ngram.dataset]);
+            return;
+        }
+        // The bundler has written every class vector before the first
+        // inference sample is accepted.
+        if (m_ngram.inference && !m_classes_checked && !check_class_vectors()) {
+            return;
+        }
+
+        cosim_reference *ref = m_references[m_ngram.dataset];
+        int levels[NUM_FEATURES];
+        std::uint64_t reference[COSIM_HV_WORDS];
+        std::uint64_t accelerator[COSIM_HV_WORDS];
+        cosim_reference_quantize(ref, raw_sample(m_ngram), levels);
+        const bool valid = cosim_reference_push_ngram(ref, levels, reference) != 0;
+        if (valid != item.valid_ngram) {
+            fail("n-gram", m_ngram, std::string("  accelerator window ") + (item.valid_ngram ? "full" : "filling") +
+                                        ", reference window " + (valid ? "full" : "filling") + '\n');
+            return;
+        }
+        if (valid) {
+            hv_to_words(item.ngram, accelerator);
+            if (std::memcmp(reference, accelerator, sizeof(reference)) != 0) {
+                fail("n-gram", m_ngram, describe_hv_diff(accelerator, reference));
+                return;
+            }
+            ++m_ngrams;
+            record("n-gram", m_ngram);
+        }
+
+        if (m_ngram.inference) {
+            PendingDistances pending = {};
+            pending.position = m_ngram;
+            pending.valid = valid;
+            if (valid) {
+                cosim_reference_distances(ref, reference, m_accelerator_classes ? &m_class_words[0][0] : 0,
+                                          pending.distances);
+            }
+            m_pending.push_back(pending);
+        }
+    }
+
+    void class_vector(unsigned class_id, const hv_t &class_hv) override {
+        if (class_id < static_cast<unsigned>(NUM_CLASSES)) {
+            hv_to_words(class_hv, m_class_words[class_id]);
+        }
+    }
+
+    void distances(const DistanceResponse &response) override {
+        if (m_failed) {
+            return;
+        }
+        if (m_pending.empty()) {
+            SC_REPORT_FATAL("cosim", "distance response without a checked n-gram");
+        }
+        const PendingDistances pending = m_pending.front();
+        m_pending.pop_front();
+
+        bool match = response.valid_prediction == pending.valid;
+        for (int class_id = 0; match && pending.valid && class_id < NUM_CLASSES; ++class_id) {
+            match = static_cast<int>(response.distances[class_id].to_uint()) == pending.distances[class_id];
+        }
+        if (!match) {
+            std::ostringstream detail;
+            detail << "  accelerator:";
+            for (int class_id = 0; class_id < NUM_CLASSES; ++class_id) {
+                detail << ' ' << response.distances[class_id].to_uint();
+            }
+            detail << (response.valid_prediction ? "" : " (no prediction)") << "\n  reference:  ";
+            for (int class_id = 0; class_id < NUM_CLASSES; ++class_id) {
+                detail << ' ' << pending.distances[class_id];
+            }
+            detail << (pending.valid ? "" : " (no prediction)") << '\n';
+            fail("distance", pending.position, detail.str());
+            return;
+        }
+        if (pending.valid) {
+            ++m_distance_checks;
+            record("distance", pending.position);
+        }
+    }
+
+private:
+    // Position of the last sample a stage reported.
+    struct Cursor {
+        int dataset = -1;
+        bool inference = false;
+        int sample = -1;
+    };
+
+    struct PendingDistances {
+        Cursor position;
+        bool valid;
+        int distances[NUM_CLASSES];
+    };
+
+    // Moves `cursor` past `item`; true for a sample.
+    bool advance(Cursor &cursor, const PipelineItem &item) const {
+        switch (item.kind) {
+        case AccelCommandKind::ResetTraining:
+            if (++cursor.dataset >= NUM_DATASETS) {
+                SC_REPORT_FATAL("cosim", "more datasets than configured");
+            }
+            cursor.inference = false;
+            cursor.sample = -1;
+            return false;
+        case AccelCommandKind::ResetInference:
+            cursor.inference = true;
+            cursor.sample = -1;
+            return false;
+        case AccelCommandKind::TrainSample:
+        case AccelCommandKind::InferSample:
+            ++cursor.sample;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    const double *raw_sample(const Cursor &cursor) const {
+        const DatasetSplit &split =
+            cursor.inference ? m_datasets[cursor.dataset].testing : m_datasets[cursor.dataset].training;
+        return &split.data[static_cast<std::size_t>(cursor.sample) * NUM_FEATURES];
+    }
+
+    bool check_class_vectors() {
+        m_classes_checked = true;
+        if (m_accelerator_classes) {
+            return true;
+        }
+        for (int class_id = 0; class_id < NUM_CLASSES; ++class_id) {
+            std::uint64_t reference[COSIM_HV_WORDS];
+            cosim_reference_class_vector(m_references[m_ngram.dataset], class_id, reference);
+            if (std::memcmp(reference, m_class_words[class_id], sizeof(reference)) != 0) {
+                Cursor position = m_ngram;
+                position.inference = false;
+                position.sample = m_datasets[m_ngram.dataset].training.samples - 2;
+                fail("class vector " + std::to_string(class_id), position,
+                     describe_hv_diff(m_class_words[class_id], reference));
+                return false;
+            }
+            ++m_class_checks;
+        }
+        return true;
+    }
+
+    static std::string describe(const std::string &stage, const Cursor &cursor) {
+        std::ostringstream out;
+        out << stage << ": dataset " << cursor.dataset << (cursor.inference ? " inference" : " training")
+            << " sample " << cursor.sample;
+        return out.str();
+    }
+
+    void record(const char *stage, const Cursor &cursor) {
+        if (m_trace_depth == 0) {
+            return;
+        }
+        if (m_trace.size() == m_trace_depth) {
+            m_trace.pop_front();
+        }
+        m_trace.push_back(describe(stage, cursor) + " at " + sc_core::sc_time_stamp().to_string());
+    }
+
+    void fail(const std::string &stage, const Cursor &cursor, const std::string &detail) {
+        m_failed = true;
+        std::cerr << "cosim: first mismatch in " << describe(stage, cursor) << " at "
+                  << sc_core::sc_time_stamp() << '\n'
+                  << detail;
+        if (!m_trace.empty()) {
+            std::cerr << "cosim: last " << m_trace.size() << " matching checks:\n";
+            for (const std::string &line : m_trace) {
+                std::cerr << "  " << line << '\n';
+            }
+        }
+        std::cerr.flush();
+        sc_core::sc_stop();
+    }
+
+    const FootDataset *m_datasets;
+    cosim_reference *const *m_references;
+    const bool m_accelerator_classes;
+    const std::size_t m_trace_depth;
+    bool m_failed;
+
+    Cursor m_encoder;
+    Cursor m_ngram;
+    // Class vectors the accelerator wrote for the current dataset.
+    std::uint64_t m_class_words[NUM_CLASSES][COSIM_HV_WORDS];
+    bool m_classes_checked;
+    // Reference results of the inferences still in the distance stage.
+    std::deque<PendingDistances> m_pending;
+    std::deque<std::string> m_trace;
+
+    std::uint64_t m_encodings;
+    std::uint64_t m_ngrams;
+    std::uint64_t m_class_checks;
+    std::uint64_t m_distance_checks;
+};
+
+void check_reference_config() {
+    cosim_reference_config config;
+    cosim_reference_get_config(&config);
+    if (config.dimension != VECTOR_DIMENSION || config.num_levels != NUM_LEVELS ||
+        config.num_features != NUM_FEATURES || config.num_classes != NUM_CLASSES ||
+        config.ngram_size != N_GRAM_SIZE) {
+        SC_REPORT_FATAL("cosim", "C reference model was built with a different configuration");
+    }
+}
+
+} // namespace
+
+int sc_main(int argc, char *argv[]) {
+    AcceleratorConfig accelerator_config;
+    bool accelerator_classes = false;
+    long trace_depth = 16;
+    for (int arg = 1; arg < argc; ++arg) {
+        if (std::strcmp(argv[arg], "assoc=reference") == 0) {
+            accelerator_classes = false;
+        } else if (std::strcmp(argv[arg], "assoc=accelerator") == 0) {
+            accelerator_classes = true;
+        } else if (std::strncmp(argv[arg], "trace=", 6) == 0) {
+            trace_depth = std::atol(argv[arg] + 6);
+            if (trace_depth < 0) {
+                std::cerr << "cosim: invalid option " << argv[arg] << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (!parse_accelerator_option(accelerator_config, argv[arg])) {
+            std::cerr << "cosim: unknown option " << argv[arg] << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    check_reference_config();
+
+    FootDataset datasets[NUM_DATASETS];
+    cosim_reference *references[NUM_DATASETS];
+    std::vector<hv_t> cims[NUM_DATASETS];
+    Controller controller("controller", accelerator_config);
+
+    for (int dataset = 0; dataset < NUM_DATASETS; ++dataset) {
+        datasets[dataset] = load_foot_dataset_by_id(dataset);
+        const DatasetSplit &training = datasets[dataset].training;
+        // The controller trains on all but the last training sample.
+        references[dataset] = cosim_reference_create(training.raw_data(), training.raw_labels(), training.samples,
+                                                     training.samples - 1);
+        if (references[dataset] == 0) {
+            SC_REPORT_FATAL("cosim", "failed to build the C reference model");
+        }
+
+        std::uint64_t words[COSIM_HV_WORDS];
+        cims[dataset].resize(static_cast<std::size_t>(NUM_LEVELS) * NUM_FEATURES);
+        for (int level = 0; level < NUM_LEVELS; ++level) {
+            for (int feature = 0; feature < NUM_FEATURES; ++feature) {
+                cosim_reference_item(references[dataset], level, feature, words);
+                cims[dataset][static_cast<std::size_t>(level) * NUM_FEATURES + feature] = words_to_hv(words);
+            }
+        }
+        controller.configure(dataset, cims[dataset].data(), cosim_reference_cuts(references[dataset]),
+                             &datasets[dataset]);
+    }
+
+    LockstepChecker checker(datasets, references, accelerator_classes, static_cast<std::size_t>(trace_depth));
+    controller.set_accelerator_observer(&checker);
+    sc_core::sc_start();
+
+    int status = EXIT_SUCCESS;
+    if (checker.failed()) {
+        status = EXIT_FAILURE;
+    } else if (!controller.done()) {
+        SC_REPORT_FATAL("cosim", "controller did not finish");
+    } else {
+        checker.print_summary(std::cout);
+        for (int dataset = 0; dataset < NUM_DATASETS; ++dataset) {
+            std::cout << "Dataset " << dataset << ": accuracy "
+                      << 100.0 * controller.test_result(dataset).overall_accuracy << "%" << std::endl;
+        }
+    }
+
+    for (int dataset = 0; dataset < NUM_DATASETS; ++dataset) {
+        cosim_reference_free(references[dataset]);
+    }
+    return status;
+}
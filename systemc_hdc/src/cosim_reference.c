@@ -0,0 +1,174 @@
+#include "cosim_reference.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../hdc_infrastructure/assoc_mem.h"
+#include "../../hdc_infrastructure/encoder.h"
+#include "../../hdc_infrastructure/item_mem.h"
+#include "../../hdc_infrastructure/operations.h"
+#include "../../hdc_infrastructure/quantizer.h"
+#include "../../hdc_infrastructure/trainer.h"
+#include "../../hdc_infrastructure/vector.h"
+
+#if BIPOLAR_MODE || !PRECOMPUTED_ITEM_MEMORY
+#error "The co-simulation reference needs the binary model with a precomputed item memory."
+#endif
+
+int output_mode = OUTPUT_NONE;
+
+struct cosim_reference {
+    struct quantizer *quantizer;
+    struct item_memory item_mem;
+    struct encoder enc;
+    struct associative_memory assoc_mem;
+    struct ngram_encoder_state ngram_state;
+    Vector *scratch;
+    Vector *query;
+    Vector *class_vectors[NUM_CLASSES]; // caller-provided classes for cosim_reference_distances
+};
+
+static void copy_to_words(const Vector *vec, uint64_t *words) {
+    memcpy(words, vec->data, COSIM_HV_WORDS * sizeof(uint64_t));
+}
+
+static void copy_from_words(const uint64_t *words, Vector *vec) {
+    memcpy(vec->data, words, COSIM_HV_WORDS * sizeof(uint64_t));
+}
+
+static void to_quantized_levels(const int *levels, quantized_level *out) {
+    for (int feature = 0; feature < NUM_FEATURES; feature++) {
+        out[feature] = (quantized_level)levels[feature];
+    }
+}
+
+void cosim_reference_get_config(struct cosim_reference_config *config) {
+    config->dimension = VECTOR_DIMENSION;
+    config->num_levels = NUM_LEVELS;
+    config->num_features = NUM_FEATURES;
+    config->num_classes = NUM_CLASSES;
+    config->ngram_size = N_GRAM_SIZE;
+}
+
+struct cosim_reference *cosim_reference_create(const double *training_data,
+                                               const int *training_labels,
+                                               int samples,
+                                               int trained_samples) {
+    if (!training_data || !training_labels || samples <= 0 || trained_samples <= 0 || trained_samples > samples) {
+        fprintf(stderr, "cosim_reference_create: invalid training data.\n");
+        return NULL;
+    }
+
+    double **rows = (double **)malloc((size_t)samples * sizeof(double *));
+    struct cosim_reference *ref = (struct cosim_reference *)calloc(1, sizeof(*ref));
+    if (!rows || !ref) {
+        fprintf(stderr, "cosim_reference_create: allocation failed.\n");
+        free(rows);
+        free(ref);
+        return NULL;
+    }
+    for (int sample = 0; sample < samples; sample++) {
+        rows[sample] = (double *)training_data + (size_t)sample * NUM_FEATURES;
+    }
+
+    ref->quantizer = quantizer_fit(rows, training_labels, samples, NUM_FEATURES, NUM_LEVELS);
+    if (!ref->quantizer) {
+        fprintf(stderr, "cosim_reference_create: failed to fit the quantizer.\n");
+        free(rows);
+        free(ref);
+        return NULL;
+    }
+    init_precomp_item_memory(&ref->item_mem, NUM_LEVELS, NUM_FEATURES);
+    init_encoder(&ref->enc, &ref->item_mem);
+    encoder_use_quantizer(&ref->enc, ref->quantizer);
+    init_assoc_mem(&ref->assoc_mem);
+    init_ngram_encoder_state(&ref->ngram_state);
+    ref->scratch = create_vector();
+    ref->query = create_vector();
+    for (int class_id = 0; class_id < NUM_CLASSES; class_id++) {
+        ref->class_vectors[class_id] = create_vector();
+    }
+
+    struct quantized_dataset dataset;
+    if (init_quantized_dataset_for(ref->quantizer, &dataset, rows, trained_samples, NUM_FEATURES) != 0) {
+        fprintf(stderr, "cosim_reference_create: failed to quantize the training data.\n");
+        free(rows);
+        cosim_reference_free(ref);
+        return NULL;
+    }
+    train_model_timeseries_quantized(&dataset, (int *)training_labels, &ref->assoc_mem, &ref->enc);
+    free_quantized_dataset(&dataset);
+    free(rows);
+    return ref;
+}
+
+void cosim_reference_free(struct cosim_reference *ref) {
+    if (!ref) {
+        return;
+    }
+    for (int class_id = 0; class_id < NUM_CLASSES; class_id++) {
+        free_vector(ref->class_vectors[class_id]);
+    }
+    free_vector(ref->query);
+    free_vector(ref->scratch);
+    free_ngram_encoder_state(&ref->ngram_state);
+    free_assoc_mem(&ref->assoc_mem);
+    free_item_memory(&ref->item_mem);
+    free_quantizer(ref->quantizer);
+    free(ref);
+}
+
+const double *cosim_reference_cuts(const struct cosim_reference *ref) {
+    return NUM_LEVELS > 1 ? quantizer_cuts(ref->quantizer, NULL, NULL) : NULL;
+}
+
+void cosim_reference_item(const struct cosim_reference *ref, int level, int feature, uint64_t *words) {
+    copy_to_words(ref->item_mem.base_vectors[level * NUM_FEATURES + feature], words);
+}
+
+void cosim_reference_class_vector(const struct cosim_reference *ref, int class_id, uint64_t *words) {
+    copy_to_words(ref->assoc_mem.class_vectors[class_id], words);
+}
+
+void cosim_reference_quantize(const struct cosim_reference *ref, const double *sample, int *levels) {
+    quantized_level quantized[NUM_FEATURES];
+    quantizer_quantize_sample(ref->quantizer, sample, quantized);
+    for (int feature = 0; feature < NUM_FEATURES; feature++) {
+        levels[feature] = quantized[feature];
+    }
+}
+
+void cosim_reference_encode(struct cosim_reference *ref, const int *levels, uint64_t *words) {
+    quantized_level quantized[NUM_FEATURES];
+    to_quantized_levels(levels, quantized);
+    encode_timestamp_levels(&ref->enc, quantized, ref->scratch);
+    copy_to_words(ref->scratch, words);
+}
+
+void cosim_reference_reset_ngram(struct cosim_reference *ref) {
+    reset_ngram_encoder_state(&ref->ngram_state);
+}
+
+int cosim_reference_push_ngram(struct cosim_reference *ref, const int *levels, uint64_t *words) {
+    quantized_level quantized[NUM_FEATURES];
+    to_quantized_levels(levels, quantized);
+    int ready = push_ngram_encoder_levels(&ref->enc, &ref->ngram_state, quantized, ref->scratch);
+    if (ready > 0) {
+        copy_to_words(ref->scratch, words);
+    }
+    return ready > 0;
+}
+
+void cosim_reference_distances(struct cosim_reference *ref,
+                               const uint64_t *query,
+                               const uint64_t *class_words,
+                               int *distances) {
+    Vector *const *rows = ref->assoc_mem.class_vectors;
+    if (class_words) {
+        for (int class_id = 0; class_id < NUM_CLASSES; class_id++) {
+            copy_from_words(class_words + (size_t)class_id * COSIM_HV_WORDS, ref->class_vectors[class_id]);
+        }
+        rows = ref->class_vectors;
+    }
+    copy_from_words(query, ref->query);
+    hamming_distance_block(&ref->query, 1, rows, NUM_CLASSES, distances);
+}
@@ -0,0 +1,63 @@
+#ifndef SYSTEMC_HDC_COSIM_REFERENCE_H
+#define SYSTEMC_HDC_COSIM_REFERENCE_H
+
+// C reference model of the lockstep co-simulation (cosim.cpp): the
+// hdc_infrastructure quantizer, item memory, encoder, trainer and associative
+// memory, compiled with the SystemC configuration (config_systemc.h).
+// Hypervectors cross the interface as COSIM_HV_WORDS uint64_t words, bit d in
+// bit d % 64 of word d / 64 (the hv_t and Vector layout).
+
+#include <stdint.h>
+#include "config_systemc.h"
+
+#define COSIM_HV_WORDS ((VECTOR_DIMENSION + 63) / 64)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct cosim_reference;
+
+// Model parameters the C library was compiled with.
+struct cosim_reference_config {
+    int dimension;
+    int num_levels;
+    int num_features;
+    int num_classes;
+    int ngram_size;
+};
+
+void cosim_reference_get_config(struct cosim_reference_config *config);
+
+// Fits the quantizer on `samples` training rows (NUM_FEATURES values each),
+// builds the seeded item memory and trains the associative memory on the
+// first `trained_samples` rows. Returns NULL on failure.
+struct cosim_reference *cosim_reference_create(const double *training_data,
+                                               const int *training_labels,
+                                               int samples,
+                                               int trained_samples);
+void cosim_reference_free(struct cosim_reference *ref);
+
+// Feature-major cuts, NUM_FEATURES * (NUM_LEVELS - 1) values (NULL for one level).
+const double *cosim_reference_cuts(const struct cosim_reference *ref);
+void cosim_reference_item(const struct cosim_reference *ref, int level, int feature, uint64_t *words);
+void cosim_reference_class_vector(const struct cosim_reference *ref, int class_id, uint64_t *words);
+
+void cosim_reference_quantize(const struct cosim_reference *ref, const double *sample, int *levels);
+void cosim_reference_encode(struct cosim_reference *ref, const int *levels, uint64_t *words);
+void cosim_reference_reset_ngram(struct cosim_reference *ref);
+// Pushes one sample into the n-gram window; returns 1 and writes the n-gram
+// once the window is full, 0 before.
+int cosim_reference_push_ngram(struct cosim_reference *ref, const int *levels, uint64_t *words);
+// Hamming distance of `query` to every class vector: the reference model's own,
+// or NUM_CLASSES vectors from `class_words` when it is not NULL.
+void cosim_reference_distances(struct cosim_reference *ref,
+                               const uint64_t *query,
+                               const uint64_t *class_words,
+                               int *distances);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,298 @@
+// Design-space exploration over the SystemC accelerator.
+//
+// Usage:
+//   systemc_hdc_dse [dimensions=1024,...] [encoder_pes=4,8,...] [ngram_pes=4,8,...]
+//                   [pe_word_bits=32,64,...] [jobs=N] [import=import] [csv=dse.csv]
+//
+// Every grid point is one testbench process (build/systemc_hdc_tb_D<dimension>,
+// built by `make dse` for each DSE_DIMENSIONS value, since the hypervector
+// width is compile-time); up to `jobs` of them run at once. `import` is the
+// CiM/quantizer export directory, with %d replaced by the dimension. Each run
+// appends its per-dataset rows (accuracy, simulated time, memory accesses,
+// stage utilization) to its own CSV; the runner averages them over the
+// datasets and prints throughput against an area proxy, marking the Pareto
+// front (no other point is at least as fast, as small and as accurate).
+// The area proxy counts datapath bit lanes:
+//   (encoder_pes + ngram_pes + NUM_CLASSES distance PEs + 1 bundler) * pe_word_bits
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include "config_systemc.h"
+
+namespace {
+
+struct DsePoint {
+    unsigned dimension;
+    unsigned encoder_pes;
+    unsigned ngram_pes;
+    unsigned pe_word_bits;
+    std::string csv_path;
+    std::string log_path;
+    bool ok;
+
+    // Averaged / summed over the datasets of the run.
+    double accuracy;
+    double sim_time_ns;
+    double samples;
+    double bus_bytes;
+    double utilization[4];
+    double stall_cycles;
+    bool pareto;
+};
+
+bool parse_list(const char *text, std::vector<unsigned> &values) {
+    values.clear();
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        char *end = 0;
+        const unsigned long value = std::strtoul(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0' || value == 0) {
+            return false;
+        }
+        values.push_back(static_cast<unsigned>(value));
+    }
+    return !values.empty();
+}
+
+std::string with_dimension(const std::string &pattern, unsigned dimension) {
+    const std::string::size_type at = pattern.find("%d");
+    if (at == std::string::npos) {
+        return pattern;
+    }
+    return pattern.substr(0, at) + std::to_string(dimension) + pattern.substr(at + 2);
+}
+
+pid_t launch(const DsePoint &point, const std::string &import_pattern) {
+    const std::string tb = "build/systemc_hdc_tb_D" + std::to_string(point.dimension);
+    std::vector<std::string> args = {
+        tb,
+        "encoder_pes=" + std::to_string(point.encoder_pes),
+        "ngram_pes=" + std::to_string(point.ngram_pes),
+        "pe_word_bits=" + std::to_string(point.pe_word_bits),
+        "import=" + with_dimension(import_pattern, point.dimension),
+        "csv=" + point.csv_path,
+    };
+
+    const pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+    const int log = open(point.log_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (log >= 0) {
+        dup2(log, STDOUT_FILENO);
+        dup2(log, STDERR_FILENO);
+        close(log);
+    }
+    std::vector<char *> argv;
+    for (std::string &arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(0);
+    execv(argv[0], argv.data());
+    std::fprintf(stderr, "dse: cannot run %s: %s\n", argv[0], std::strerror(errno));
+    _exit(127);
+}
+
+// Sums the per-dataset rows of one run; false if the run wrote none.
+bool read_run(DsePoint &point) {
+    std::ifstream csv(point.csv_path);
+    std::string line;
+    if (!std::getline(csv, line)) {
+        return false;
+    }
+    int rows = 0;
+    point.accuracy = point.sim_time_ns = point.samples = point.bus_bytes = point.stall_cycles = 0.0;
+    std::fill(point.utilization, point.utilization + 4, 0.0);
+    while (std::getline(csv, line)) {
+        std::vector<double> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            fields.push_back(std::atof(field.c_str()));
+        }
+        if (fields.size() < 22) {
+            return false;
+        }
+        point.accuracy += fields[5];
+        point.sim_time_ns += fields[6];
+        point.samples += fields[7];
+        point.bus_bytes += fields[13];
+        for (int stage = 0; stage < 4; ++stage) {
+            point.utilization[stage] += fields[14 + stage] * fields[6];
+            point.stall_cycles += fields[18 + stage];
+        }
+        ++rows;
+    }
+    if (rows == 0) {
+        return false;
+    }
+    point.accuracy /= rows;
+    for (int stage = 0; stage < 4; ++stage) {
+        point.utilization[stage] = point.sim_time_ns > 0.0 ? point.utilization[stage] / point.sim_time_ns : 0.0;
+    }
+    return true;
+}
+
+double throughput(const DsePoint &point) {
+    return point.sim_time_ns > 0.0 ? point.samples / (point.sim_time_ns * 1e-9) : 0.0;
+}
+
+unsigned area_proxy(const DsePoint &point) {
+    return (point.encoder_pes + point.ngram_pes + NUM_CLASSES + 1) * point.pe_word_bits;
+}
+
+bool dominates(const DsePoint &a, const DsePoint &b) {
+    const bool no_worse = throughput(a) >= throughput(b) && area_proxy(a) <= area_proxy(b) &&
+                          a.accuracy >= b.accuracy;
+    const bool better = throughput(a) > throughput(b) || area_proxy(a) < area_proxy(b) ||
+                        a.accuracy > b.accuracy;
+    return no_worse && better;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::vector<unsigned> dimensions = {VECTOR_DIMENSION};
+    std::vector<unsigned> encoder_pes = {ENCODER_PES};
+    std::vector<unsigned> ngram_pes = {NGRAM_PES};
+    std::vector<unsigned> word_bits = {ACCEL_PE_WORD_BITS};
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    std::string import_pattern = "import";
+    std::string csv_path = "dse.csv";
+
+    for (int arg = 1; arg < argc; ++arg) {
+        const char *value = std::strchr(argv[arg], '=');
+        const std::string name = value ? std::string(argv[arg], static_cast<std::size_t>(value - argv[arg])) : "";
+        bool ok = value != 0;
+        if (ok) {
+            ++value;
+            if (name == "dimensions") {
+                ok = parse_list(value, dimensions);
+            } else if (name == "encoder_pes") {
+                ok = parse_list(value, encoder_pes);
+            } else if (name == "ngram_pes") {
+                ok = parse_list(value, ngram_pes);
+            } else if (name == "pe_word_bits") {
+                ok = parse_list(value, word_bits);
+            } else if (name == "jobs") {
+                jobs = std::atol(value);
+                ok = jobs > 0;
+            } else if (name == "import") {
+                import_pattern = value;
+            } else if (name == "csv") {
+                csv_path = value;
+            } else {
+                ok = false;
+            }
+        }
+        if (!ok) {
+            std::fprintf(stderr, "dse: invalid argument %s\n", argv[arg]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<DsePoint> points;
+    for (unsigned dimension : dimensions) {
+        for (unsigned encoders : encoder_pes) {
+            for (unsigned ngrams : ngram_pes) {
+                for (unsigned bits : word_bits) {
+                    DsePoint point = {};
+                    point.dimension = dimension;
+                    point.encoder_pes = encoders;
+                    point.ngram_pes = ngrams;
+                    point.pe_word_bits = bits;
+                    const std::string stem = csv_path + ".run" + std::to_string(points.size());
+                    point.csv_path = stem + ".csv";
+                    point.log_path = stem + ".log";
+                    points.push_back(point);
+                }
+            }
+        }
+    }
+
+    // Keep up to `jobs` simulations running; each writes its own CSV.
+    std::vector<std::pair<pid_t, std::size_t>> running;
+    std::size_t next = 0;
+    while (next < points.size() || !running.empty()) {
+        while (next < points.size() && static_cast<long>(running.size()) < jobs) {
+            std::remove(points[next].csv_path.c_str());
+            const pid_t pid = launch(points[next], import_pattern);
+            if (pid < 0) {
+                std::perror("dse: fork failed");
+                return EXIT_FAILURE;
+            }
+            running.push_back(std::make_pair(pid, next++));
+        }
+        int status = 0;
+        const pid_t done = wait(&status);
+        if (done < 0) {
+            std::perror("dse: wait failed");
+            return EXIT_FAILURE;
+        }
+        for (std::size_t i = 0; i < running.size(); ++i) {
+            if (running[i].first != done) {
+                continue;
+            }
+            DsePoint &point = points[running[i].second];
+            point.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0 && read_run(point);
+            std::fprintf(stderr, "dse: D=%u encoder_pes=%u ngram_pes=%u pe_word_bits=%u %s\n", point.dimension,
+                         point.encoder_pes, point.ngram_pes, point.pe_word_bits,
+                         point.ok ? "done" : ("failed, see " + point.log_path).c_str());
+            if (point.ok) {
+                std::remove(point.csv_path.c_str());
+                std::remove(point.log_path.c_str());
+            }
+            running.erase(running.begin() + static_cast<std::ptrdiff_t>(i));
+            break;
+        }
+    }
+
+    std::vector<DsePoint> results;
+    for (const DsePoint &point : points) {
+        if (point.ok) {
+            results.push_back(point);
+        }
+    }
+    for (DsePoint &point : results) {
+        point.pareto = std::none_of(results.begin(), results.end(),
+                                    [&point](const DsePoint &other) { return dominates(other, point); });
+    }
+    std::sort(results.begin(), results.end(), [](const DsePoint &a, const DsePoint &b) {
+        return area_proxy(a) != area_proxy(b) ? area_proxy(a) < area_proxy(b) : throughput(a) > throughput(b);
+    });
+
+    FILE *csv = std::fopen(csv_path.c_str(), "w");
+    if (csv == 0) {
+        std::perror("dse: cannot write CSV");
+        return EXIT_FAILURE;
+    }
+    std::fprintf(csv, "dimension,encoder_pes,ngram_pes,pe_word_bits,area_proxy,samples_per_s,accuracy,"
+                      "sim_time_ns,bus_bytes,util_encoder,util_ngram,util_bundler,util_distance,stall_cycles,pareto\n");
+    std::printf("\n  %5s %4s %4s %4s %8s %14s %9s %7s %7s %7s %7s %12s\n", "D", "enc", "ngr", "word", "area",
+                "samples/s", "accuracy", "u_enc", "u_ngr", "u_bun", "u_dst", "stalls");
+    for (const DsePoint &point : results) {
+        std::fprintf(csv, "%u,%u,%u,%u,%u,%.6g,%.6f,%.0f,%.0f,%.4f,%.4f,%.4f,%.4f,%.0f,%d\n", point.dimension,
+                     point.encoder_pes, point.ngram_pes, point.pe_word_bits, area_proxy(point), throughput(point),
+                     point.accuracy, point.sim_time_ns, point.bus_bytes, point.utilization[0], point.utilization[1],
+                     point.utilization[2], point.utilization[3], point.stall_cycles, point.pareto ? 1 : 0);
+        std::printf("%s %5u %4u %4u %4u %8u %14.1f %8.2f%% %6.1f%% %6.1f%% %6.1f%% %6.1f%% %12.0f\n",
+                    point.pareto ? "*" : " ", point.dimension, point.encoder_pes, point.ngram_pes,
+                    point.pe_word_bits, area_proxy(point), throughput(point), 100.0 * point.accuracy,
+                    100.0 * point.utilization[0], 100.0 * point.utilization[1], 100.0 * point.utilization[2],
+                    100.0 * point.utilization[3], point.stall_cycles);
+    }
+    std::fclose(csv);
+    std::printf("\n* Pareto-optimal in throughput, area proxy and accuracy. Results in %s\n", csv_path.c_str());
+    return results.size() == points.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
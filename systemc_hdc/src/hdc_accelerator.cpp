@@ -1,4 +1,7 @@
 #include "hdc_accelerator.h"
+#include <cstdlib>
+#include <cstring>
+#include <string>
 #include "sysc/kernel/sc_spawn.h"
 
 namespace hdc_systemc {
@@ -13,38 +16,99 @@ void set_bit(hv_t &hv, int index, bool value) {
     hv[index] = value ? sc_dt::SC_LOGIC_1 : sc_dt::SC_LOGIC_0;
 }
 
+constexpr unsigned ceil_div(unsigned value, unsigned divisor) {
+    return (value + divisor - 1) / divisor;
+}
+
+const AcceleratorConfig &checked_config(const AcceleratorConfig &config) {
+    if (config.encoder_pes == 0 || config.encoder_pes > VECTOR_DIMENSION ||
+        config.ngram_pes == 0 || config.ngram_pes > VECTOR_DIMENSION) {
+        SC_REPORT_FATAL("HDC_Accelerator", "PE counts must be between 1 and VECTOR_DIMENSION");
+    }
+    if (config.pe_word_bits == 0 || config.fifo_depth == 0 || !(config.clock_period_ns > 0.0)) {
+        SC_REPORT_FATAL("HDC_Accelerator", "word width, FIFO depth and clock period must be positive");
+    }
+    return config;
+}
+
 void clear_hv(hv_t &hv) {
+#if HV_NATIVE_WORDS
+    hv = hv_t();
+#else
     for (int d = 0; d < VECTOR_DIMENSION; ++d) {
         hv[d] = sc_dt::SC_LOGIC_0;
     }
+#endif
 }
 
 } // namespace
 
-HDC_Accelerator::HDC_Accelerator(sc_core::sc_module_name name)
+bool parse_accelerator_option(AcceleratorConfig &config, const char *option) {
+    const char *equals = std::strchr(option, '=');
+    if (equals == 0 || equals[1] == '\0') {
+        return false;
+    }
+    const std::string name(option, static_cast<std::size_t>(equals - option));
+    char *end = 0;
+    const double value = std::strtod(equals + 1, &end);
+    if (*end != '\0' || !(value >= 0.0)) {
+        return false;
+    }
+
+    if (name == "clock_period_ns") {
+        config.clock_period_ns = value;
+        return true;
+    }
+    unsigned *field = name == "encoder_pes"             ? &config.encoder_pes
+                      : name == "ngram_pes"             ? &config.ngram_pes
+                      : name == "pe_word_bits"          ? &config.pe_word_bits
+                      : name == "fifo_depth"            ? &config.fifo_depth
+                      : name == "depth_encode_cycles"   ? &config.depth_encode_cycles
+                      : name == "depth_ngram_cycles"    ? &config.depth_ngram_cycles
+                      : name == "depth_distance_cycles" ? &config.depth_distance_cycles
+                                                        : 0;
+    if (field == 0 || value != static_cast<double>(static_cast<unsigned>(value))) {
+        return false;
+    }
+    *field = static_cast<unsigned>(value);
+    return true;
+}
+
+HDC_Accelerator::HDC_Accelerator(sc_core::sc_module_name name, const AcceleratorConfig &config)
     : sc_module(name),
       cmd_in("cmd_in"),
       rsp_out("rsp_out"),
-      m_encoder_in_fifo("encoder_in_fifo", 8),
-      m_encoder_out_fifo("encoder_out_fifo", 8),
-      m_bundler_in_fifo("bundler_in_fifo", 8),
-      m_distance_in_fifo("distance_in_fifo", 8),
+      memory_socket("memory_socket"),
+      m_encoder_in_fifo("encoder_in_fifo", config.fifo_depth),
+      m_encoder_out_fifo("encoder_out_fifo", config.fifo_depth),
+      m_bundler_in_fifo("bundler_in_fifo", config.fifo_depth),
+      m_distance_in_fifo("distance_in_fifo", config.fifo_depth),
       m_control_done_fifo("control_done_fifo", 8),
-      m_distance_done_fifo("distance_done_fifo", 8),
+      m_distance_done_fifo("distance_done_fifo", config.fifo_depth),
+      m_encode_done_event(new sc_core::sc_event[config.encoder_pes]),
+      m_encode_done_flags(config.encoder_pes, false),
+      m_ngram_done_event(new sc_core::sc_event[config.ngram_pes]),
       m_ngram_work_input(0),
       m_ngram_work_rhs(0),
       m_ngram_work_output(0),
-      m_memory(0) {
-    for (unsigned pe = 0; pe < ENCODER_PES; ++pe) {
-        m_encode_done_flags[pe] = false;
+      m_ngram_done_flags(config.ngram_pes, false),
+      m_config(checked_config(config)),
+      m_encode_ii_cycles(NUM_FEATURES *
+                         ceil_div(ceil_div(VECTOR_DIMENSION, config.encoder_pes), config.pe_word_bits)),
+      m_ngram_ii_cycles((N_GRAM_SIZE - 1) *
+                        ceil_div(ceil_div(VECTOR_DIMENSION, config.ngram_pes), config.pe_word_bits)),
+      m_bundle_ii_cycles(ceil_div(VECTOR_DIMENSION, config.pe_word_bits)),
+      m_distance_ii_cycles(ceil_div(VECTOR_DIMENSION, config.pe_word_bits)),
+      m_observer(0) {
+    memory_socket.register_invalidate_direct_mem_ptr(this, &HDC_Accelerator::invalidate_direct_mem_ptr);
+    tlm::tlm_global_quantum::instance().set(sc_core::sc_time(HDC_TLM_QUANTUM_NS, sc_core::SC_NS));
+    for (int region = 0; region < DMI_REGIONS; ++region) {
+        m_dmi_valid[region] = false;
     }
     for (unsigned class_id = 0; class_id < NUM_CLASSES; ++class_id) {
         m_distance_current_result[class_id] = 0;
         m_distance_done_flags[class_id] = false;
     }
-    for (unsigned pe = 0; pe < NGRAM_PES; ++pe) {
-        m_ngram_done_flags[pe] = false;
-    }
     reset_stats();
 
     SC_THREAD(command_thread);
@@ -52,12 +116,13 @@ HDC_Accelerator::HDC_Accelerator(sc_core::sc_module_name name)
     SC_THREAD(ngram_thread);
     SC_THREAD(bundler_thread);
     SC_THREAD(distance_thread);
-    for (unsigned pe = 0; pe < ENCODER_PES; ++pe) {
+    SC_THREAD(response_thread);
+    for (unsigned pe = 0; pe < m_config.encoder_pes; ++pe) {
         sc_core::sc_spawn(
             sc_core::sc_bind(&HDC_Accelerator::encoder_pe_thread, this, pe),
             sc_core::sc_gen_unique_name("encoder_pe"));
     }
-    for (unsigned pe = 0; pe < NGRAM_PES; ++pe) {
+    for (unsigned pe = 0; pe < m_config.ngram_pes; ++pe) {
         sc_core::sc_spawn(
             sc_core::sc_bind(&HDC_Accelerator::ngram_pe_thread, this, pe),
             sc_core::sc_gen_unique_name("ngram_pe"));
@@ -71,10 +136,6 @@ HDC_Accelerator::HDC_Accelerator(sc_core::sc_module_name name)
     reset_all_local_state();
 }
 
-void HDC_Accelerator::bind_memory(HDC_Memory *memory) {
-    m_memory = memory;
-}
-
 void HDC_Accelerator::reset_stats() {
     m_stats.command_count = 0;
     m_stats.train_samples = 0;
@@ -86,82 +147,68 @@ void HDC_Accelerator::reset_stats() {
     m_stats.bundle_flushes = 0;
     m_stats.distance_requests = 0;
     m_stats.valid_distance_requests = 0;
+    m_stats.bus_reads = 0;
+    m_stats.bus_writes = 0;
+    m_stats.bus_bytes = 0;
+    m_stats.dmi_accesses = 0;
+    m_stats.bus_time_ps = 0;
+    for (int stage = 0; stage < ACCEL_NUM_STAGES; ++stage) {
+        m_stats.stage_busy_cycles[stage] = 0;
+        m_stats.stage_stall_cycles[stage] = 0;
+    }
 }
 
 const AcceleratorStats &HDC_Accelerator::stats() const {
     return m_stats;
 }
 
+const AcceleratorConfig &HDC_Accelerator::config() const {
+    return m_config;
+}
+
+void HDC_Accelerator::set_observer(AcceleratorObserver *observer) {
+    m_observer = observer;
+}
+
 void HDC_Accelerator::command_thread() {
+    // Samples stream into the pipeline; only resets and shutdown wait for it
+    // to drain (the bundler acknowledges them once everything before is done).
     while (true) {
         const AccelCommand command = cmd_in.read();
         ++m_stats.command_count;
+        PipelineItem item = {};
+        item.kind = command.kind;
+        item.valid_ngram = false;
+        item.ready_time = sc_core::sc_time_stamp();
         switch (command.kind) {
-        case AccelCommandKind::ResetTraining: {
-            reset_bundling_buffer_only();
-            PipelineItem item = {};
-            item.kind = AccelCommandKind::ResetTraining;
-            item.valid_ngram = false;
-            m_encoder_in_fifo.write(item);
-            m_control_done_fifo.read();
-            break;
-        }
-
-        case AccelCommandKind::ResetInference: {
-            PipelineItem item = {};
-            item.kind = AccelCommandKind::ResetInference;
-            item.valid_ngram = false;
+        case AccelCommandKind::ResetTraining:
+        case AccelCommandKind::ResetInference:
+            item.class_id = 0;
             m_encoder_in_fifo.write(item);
             m_control_done_fifo.read();
             break;
-        }
 
-        case AccelCommandKind::TrainSample: {
+        case AccelCommandKind::TrainSample:
             ++m_stats.train_samples;
-            PipelineItem item = {};
-            item.kind = AccelCommandKind::TrainSample;
             item.class_id = command.class_id;
             item.sample = command.sample;
-            item.valid_ngram = false;
             m_encoder_in_fifo.write(item);
-            m_control_done_fifo.read();
             break;
-        }
 
-        case AccelCommandKind::InvalidTrainingStep: {
-            PipelineItem item = {};
-            item.kind = AccelCommandKind::InvalidTrainingStep;
-            item.valid_ngram = false;
+        case AccelCommandKind::InvalidTrainingStep:
+            item.class_id = 0;
             m_encoder_in_fifo.write(item);
-            m_control_done_fifo.read();
             break;
-        }
 
-        case AccelCommandKind::InferSample: {
+        case AccelCommandKind::InferSample:
             ++m_stats.infer_samples;
-            PipelineItem item = {};
-            item.kind = AccelCommandKind::InferSample;
             item.class_id = 0;
             item.sample = command.sample;
-            item.valid_ngram = false;
             m_encoder_in_fifo.write(item);
-
-            const DistanceResponse distance_response = m_distance_done_fifo.read();
-            AccelResponse response = {};
-            response.valid_prediction = distance_response.valid_prediction;
-            response.is_shutdown_ack = false;
-            response.predicted_class = 0;
-            for (int class_id = 0; class_id < NUM_CLASSES; ++class_id) {
-                response.distances[class_id] = distance_response.distances[class_id];
-            }
-            rsp_out.write(response);
             break;
-        }
 
         case AccelCommandKind::Shutdown:
-            PipelineItem shutdown = {};
-            shutdown.kind = AccelCommandKind::Shutdown;
-            m_encoder_in_fifo.write(shutdown);
+            m_encoder_in_fifo.write(item);
             m_control_done_fifo.read();
 
             AccelResponse response = {};
@@ -175,6 +222,7 @@ void HDC_Accelerator::command_thread() {
 }
 
 void HDC_Accelerator::encoder_thread() {
+    m_encoder_keeper.reset();
     while (true) {
         PipelineItem item = m_encoder_in_fifo.read();
         if (item.kind == AccelCommandKind::Shutdown) {
@@ -182,12 +230,17 @@ void HDC_Accelerator::encoder_thread() {
             return;
         }
 
+        item.ready_time = sc_core::sc_time_stamp();
         if (item.kind == AccelCommandKind::TrainSample || item.kind == AccelCommandKind::InferSample) {
             encode_sample_parallel(item.sample, item.encoded);
             ++m_stats.encoded_samples;
-            sc_core::wait(ACCEL_LATENCY_ENCODE_NS, sc_core::SC_NS);
+            occupy_stage(ACCEL_STAGE_ENCODER, m_encode_ii_cycles);
+            item.ready_time = sc_core::sc_time_stamp() + clock_cycles(m_config.depth_encode_cycles);
+        }
+        if (m_observer != 0) {
+            m_observer->encoded(item);
         }
-        m_encoder_out_fifo.write(item);
+        write_output(m_encoder_out_fifo, item, ACCEL_STAGE_ENCODER);
     }
 }
 
@@ -200,22 +253,16 @@ void HDC_Accelerator::ngram_thread() {
             return;
         }
 
-        if (item.kind == AccelCommandKind::ResetTraining) {
-            reset_ngram_buffer();
-            m_control_done_fifo.write(true);
-            continue;
-        }
-
-        if (item.kind == AccelCommandKind::ResetInference) {
-            reset_ngram_buffer();
-            m_control_done_fifo.write(true);
-            continue;
-        }
-
-        if (item.kind == AccelCommandKind::InvalidTrainingStep) {
+        wait_until(item.ready_time);
+        if (item.kind == AccelCommandKind::ResetTraining ||
+            item.kind == AccelCommandKind::ResetInference ||
+            item.kind == AccelCommandKind::InvalidTrainingStep) {
             reset_ngram_buffer();
             item.valid_ngram = false;
-            m_bundler_in_fifo.write(item);
+            if (m_observer != 0) {
+                m_observer->ngram(item);
+            }
+            write_output(m_bundler_in_fifo, item, ACCEL_STAGE_NGRAM);
             continue;
         }
 
@@ -226,22 +273,27 @@ void HDC_Accelerator::ngram_thread() {
                 bind_ngram_parallel(item.ngram);
                 item.valid_ngram = true;
                 ++m_stats.valid_ngrams;
+                occupy_stage(ACCEL_STAGE_NGRAM, m_ngram_ii_cycles);
             } else {
                 item.valid_ngram = false;
+                occupy_stage(ACCEL_STAGE_NGRAM, 1);
+            }
+            item.ready_time = sc_core::sc_time_stamp() + clock_cycles(m_config.depth_ngram_cycles);
+            if (m_observer != 0) {
+                m_observer->ngram(item);
             }
-
-            sc_core::wait(ACCEL_LATENCY_NGRAM_NS, sc_core::SC_NS);
 
             if (item.kind == AccelCommandKind::TrainSample) {
-                m_bundler_in_fifo.write(item);
+                write_output(m_bundler_in_fifo, item, ACCEL_STAGE_NGRAM);
             } else {
-                m_distance_in_fifo.write(item);
+                write_output(m_distance_in_fifo, item, ACCEL_STAGE_NGRAM);
             }
         }
     }
 }
 
 void HDC_Accelerator::bundler_thread() {
+    m_bundler_keeper.reset();
     while (true) {
         const PipelineItem item = m_bundler_in_fifo.read();
         if (item.kind == AccelCommandKind::Shutdown) {
@@ -249,6 +301,18 @@ void HDC_Accelerator::bundler_thread() {
             return;
         }
 
+        wait_until(item.ready_time);
+        if (item.kind == AccelCommandKind::ResetTraining) {
+            reset_bundling_buffer_only();
+            m_control_done_fifo.write(true);
+            continue;
+        }
+
+        if (item.kind == AccelCommandKind::ResetInference) {
+            m_control_done_fifo.write(true);
+            continue;
+        }
+
         if (item.kind == AccelCommandKind::TrainSample) {
             if (item.valid_ngram) {
                 const int class_id = item.class_id.to_int();
@@ -264,9 +328,8 @@ void HDC_Accelerator::bundler_thread() {
                 }
 
                 add_ngram_to_bundling_buffer(item.ngram);
+                occupy_stage(ACCEL_STAGE_BUNDLER, m_bundle_ii_cycles);
             }
-            sc_core::wait(ACCEL_LATENCY_BUNDLE_NS, sc_core::SC_NS);
-            m_control_done_fifo.write(true);
             continue;
         }
 
@@ -274,20 +337,21 @@ void HDC_Accelerator::bundler_thread() {
             finalize_current_class();
             reset_bundling_buffer_only();
             ++m_stats.bundle_flushes;
-            sc_core::wait(ACCEL_LATENCY_BUNDLE_NS, sc_core::SC_NS);
-            m_control_done_fifo.write(true);
+            occupy_stage(ACCEL_STAGE_BUNDLER, m_bundle_ii_cycles);
             continue;
         }
     }
 }
 
 void HDC_Accelerator::distance_thread() {
+    m_distance_keeper.reset();
     while (true) {
         const PipelineItem item = m_distance_in_fifo.read();
         if (item.kind == AccelCommandKind::Shutdown) {
             return;
         }
 
+        wait_until(item.ready_time);
         DistanceResponse response;
         ++m_stats.distance_requests;
         if (!item.valid_ngram) {
@@ -295,18 +359,67 @@ void HDC_Accelerator::distance_thread() {
             for (int class_id = 0; class_id < NUM_CLASSES; ++class_id) {
                 response.distances[class_id] = 0;
             }
-            m_distance_done_fifo.write(response);
+            response.ready_time = sc_core::sc_time_stamp();
+            if (m_observer != 0) {
+                m_observer->distances(response);
+            }
+            write_output(m_distance_done_fifo, response, ACCEL_STAGE_DISTANCE);
             continue;
         }
 
         response.valid_prediction = true;
         ++m_stats.valid_distance_requests;
         compute_hamming_distances_parallel(item.ngram, response.distances);
-        sc_core::wait(ACCEL_LATENCY_DISTANCE_NS, sc_core::SC_NS);
-        m_distance_done_fifo.write(response);
+        occupy_stage(ACCEL_STAGE_DISTANCE, m_distance_ii_cycles);
+        response.ready_time = sc_core::sc_time_stamp() + clock_cycles(m_config.depth_distance_cycles);
+        if (m_observer != 0) {
+            m_observer->distances(response);
+        }
+        write_output(m_distance_done_fifo, response, ACCEL_STAGE_DISTANCE);
+    }
+}
+
+// Returns the inference results to the controller in order.
+void HDC_Accelerator::response_thread() {
+    while (true) {
+        const DistanceResponse distance_response = m_distance_done_fifo.read();
+        wait_until(distance_response.ready_time);
+
+        AccelResponse response = {};
+        response.valid_prediction = distance_response.valid_prediction;
+        response.is_shutdown_ack = false;
+        response.predicted_class = 0;
+        for (int class_id = 0; class_id < NUM_CLASSES; ++class_id) {
+            response.distances[class_id] = distance_response.distances[class_id];
+        }
+        rsp_out.write(response);
+    }
+}
+
+void HDC_Accelerator::occupy_stage(AccelStage stage, unsigned cycles) {
+    m_stats.stage_busy_cycles[stage] += cycles;
+    sc_core::wait(clock_cycles(cycles));
+}
+
+sc_core::sc_time HDC_Accelerator::clock_cycles(unsigned cycles) const {
+    return sc_core::sc_time(static_cast<double>(cycles) * m_config.clock_period_ns, sc_core::SC_NS);
+}
+
+void HDC_Accelerator::wait_until(const sc_core::sc_time &ready_time) {
+    const sc_core::sc_time now = sc_core::sc_time_stamp();
+    if (ready_time > now) {
+        sc_core::wait(ready_time - now);
     }
 }
 
+template <typename Fifo, typename Item>
+void HDC_Accelerator::write_output(Fifo &fifo, const Item &item, AccelStage stage) {
+    const sc_core::sc_time start = sc_core::sc_time_stamp();
+    fifo.write(item);
+    m_stats.stage_stall_cycles[stage] +=
+        static_cast<std::uint64_t>((sc_core::sc_time_stamp() - start) / clock_cycles(1));
+}
+
 void HDC_Accelerator::reset_all_local_state() {
     reset_ngram_buffer();
     reset_bundling_buffer_only();
@@ -339,9 +452,6 @@ void HDC_Accelerator::add_ngram_to_bundling_buffer(const hv_t &encoded_ngram) {
 }
 
 void HDC_Accelerator::finalize_current_class() {
-    if (m_memory == 0) {
-        SC_REPORT_FATAL("HDC_Accelerator", "memory not bound");
-    }
     if (m_current_class_id < 0) {
         return;
     }
@@ -360,7 +470,10 @@ void HDC_Accelerator::finalize_current_class() {
         set_bit(class_vector, d, m_bundling_buffer[d] >= threshold);
         m_bundling_buffer[d] = 0;
     }
-    m_memory->write_assoc_class(static_cast<unsigned>(m_current_class_id), class_vector);
+    write_hv(assoc_address(static_cast<unsigned>(m_current_class_id)), class_vector, m_bundler_keeper);
+    if (m_observer != 0) {
+        m_observer->class_vector(static_cast<unsigned>(m_current_class_id), class_vector);
+    }
 
     m_current_class_count = 0;
     m_current_class_id = -1;
@@ -381,12 +494,12 @@ void HDC_Accelerator::permute_xor_parallel(const hv_t &input, const hv_t &rhs, h
     m_ngram_work_input = &input;
     m_ngram_work_rhs = &rhs;
     m_ngram_work_output = &output;
-    for (unsigned pe = 0; pe < NGRAM_PES; ++pe) {
+    for (unsigned pe = 0; pe < m_config.ngram_pes; ++pe) {
         m_ngram_done_flags[pe] = false;
     }
 
     m_ngram_start_event.notify(sc_core::SC_ZERO_TIME);
-    for (unsigned pe = 0; pe < NGRAM_PES; ++pe) {
+    for (unsigned pe = 0; pe < m_config.ngram_pes; ++pe) {
         while (!m_ngram_done_flags[pe]) {
             sc_core::wait(m_ngram_done_event[pe]);
         }
@@ -397,8 +510,8 @@ void HDC_Accelerator::ngram_pe_thread(unsigned pe_id) {
     while (true) {
         sc_core::wait(m_ngram_start_event);
 
-        const unsigned begin = pe_id * VECTOR_DIMENSION / NGRAM_PES;
-        const unsigned end = (pe_id + 1) * VECTOR_DIMENSION / NGRAM_PES;
+        const unsigned begin = pe_id * VECTOR_DIMENSION / m_config.ngram_pes;
+        const unsigned end = (pe_id + 1) * VECTOR_DIMENSION / m_config.ngram_pes;
         for (unsigned d = begin; d < end; ++d) {
             const unsigned source_index = (d + VECTOR_DIMENSION - 1) % VECTOR_DIMENSION;
             const bool bit =
@@ -421,17 +534,19 @@ void HDC_Accelerator::push_encoded_sample_to_ngram_buffer(const hv_t &encoded_sa
 }
 
 void HDC_Accelerator::encode_sample_parallel(const QuantizedSample &sample, hv_t &encoded_sample) {
-    if (m_memory == 0) {
-        SC_REPORT_FATAL("HDC_Accelerator", "memory not bound");
+    // One CiM row per feature and sample, shared by all encoder PEs.
+    std::uint64_t addresses[NUM_FEATURES];
+    for (unsigned feature = 0; feature < NUM_FEATURES; ++feature) {
+        addresses[feature] = cim_address(sample.levels[feature].to_uint(), feature);
     }
+    read_hvs(addresses, NUM_FEATURES, m_encode_rows, m_encode_row_buffers, m_encoder_keeper);
 
-    m_encode_current_sample = sample;
-    for (unsigned pe = 0; pe < ENCODER_PES; ++pe) {
+    for (unsigned pe = 0; pe < m_config.encoder_pes; ++pe) {
         m_encode_done_flags[pe] = false;
     }
 
     m_encode_start_event.notify(sc_core::SC_ZERO_TIME);
-    for (unsigned pe = 0; pe < ENCODER_PES; ++pe) {
+    for (unsigned pe = 0; pe < m_config.encoder_pes; ++pe) {
         while (!m_encode_done_flags[pe]) {
             sc_core::wait(m_encode_done_event[pe]);
         }
@@ -444,16 +559,14 @@ void HDC_Accelerator::encoder_pe_thread(unsigned pe_id) {
     while (true) {
         sc_core::wait(m_encode_start_event);
 
-        const unsigned begin = pe_id * VECTOR_DIMENSION / ENCODER_PES;
-        const unsigned end = (pe_id + 1) * VECTOR_DIMENSION / ENCODER_PES;
+        const unsigned begin = pe_id * VECTOR_DIMENSION / m_config.encoder_pes;
+        const unsigned end = (pe_id + 1) * VECTOR_DIMENSION / m_config.encoder_pes;
         const feature_counter_t threshold = NUM_FEATURES / 2;
 
         for (unsigned d = begin; d < end; ++d) {
             feature_counter_t ones = 0;
             for (unsigned feature = 0; feature < NUM_FEATURES; ++feature) {
-                const hv_t &feature_hv =
-                    m_memory->read_cim(m_encode_current_sample.levels[feature], feature);
-                if (get_bit(feature_hv, static_cast<int>(d))) {
+                if (get_bit(*m_encode_rows[feature], static_cast<int>(d))) {
                     ++ones;
                 }
             }
@@ -467,14 +580,16 @@ void HDC_Accelerator::encoder_pe_thread(unsigned pe_id) {
 }
 
 void HDC_Accelerator::compute_hamming_distances_parallel(const hv_t &query, distance_counter_t *distances) {
-    if (m_memory == 0) {
-        SC_REPORT_FATAL("HDC_Accelerator", "memory not bound");
-    }
     if (distances == 0) {
         SC_REPORT_FATAL("HDC_Accelerator", "distances must not be null");
     }
 
     m_distance_current_query = query;
+    std::uint64_t addresses[NUM_CLASSES];
+    for (unsigned class_id = 0; class_id < NUM_CLASSES; ++class_id) {
+        addresses[class_id] = assoc_address(class_id);
+    }
+    read_hvs(addresses, NUM_CLASSES, m_distance_class_vectors, m_distance_class_buffers, m_distance_keeper);
     for (unsigned class_id = 0; class_id < NUM_CLASSES; ++class_id) {
         m_distance_done_flags[class_id] = false;
     }
@@ -495,14 +610,8 @@ void HDC_Accelerator::distance_class_pe_thread(unsigned class_id) {
     while (true) {
         sc_core::wait(m_distance_start_event);
 
-        const hv_t &class_vector = m_memory->read_assoc_class(class_id);
-        distance_counter_t distance = 0;
-        for (unsigned d = 0; d < VECTOR_DIMENSION; ++d) {
-            if (get_bit(m_distance_current_query, static_cast<int>(d)) !=
-                get_bit(class_vector, static_cast<int>(d))) {
-                ++distance;
-            }
-        }
+        const distance_counter_t distance =
+            hv_hamming_distance(m_distance_current_query, *m_distance_class_vectors[class_id]);
 
         m_distance_current_result[class_id] = distance;
         m_distance_done_flags[class_id] = true;
@@ -510,4 +619,129 @@ void HDC_Accelerator::distance_class_pe_thread(unsigned class_id) {
     }
 }
 
+// Reads `count` hypervectors issued together, as the PEs do: every access
+// starts at the thread's local time, so they only serialize where the
+// memory's banks conflict. rows[i] points into the memory (DMI) or to
+// buffers[i] (b_transport).
+void HDC_Accelerator::read_hvs(const std::uint64_t *addresses, unsigned count, const hv_t **rows, hv_t *buffers,
+                               tlm_utils::tlm_quantumkeeper &keeper) {
+    const sc_core::sc_time issue = keeper.get_local_time();
+    sc_core::sc_time done = issue;
+    for (unsigned i = 0; i < count; ++i) {
+        sc_core::sc_time complete;
+        const unsigned char *dmi = dmi_pointer(addresses[i], tlm::TLM_READ_COMMAND, complete);
+        if (dmi != 0) {
+            ++m_stats.dmi_accesses;
+            rows[i] = reinterpret_cast<const hv_t *>(dmi);
+            complete += issue;
+        } else {
+            complete = memory_transport(tlm::TLM_READ_COMMAND, addresses[i], buffers[i], issue);
+            rows[i] = &buffers[i];
+        }
+        count_memory_access(tlm::TLM_READ_COMMAND, complete - issue);
+        if (complete > done) {
+            done = complete;
+        }
+    }
+    advance_local_time(keeper, done);
+}
+
+void HDC_Accelerator::write_hv(std::uint64_t address, const hv_t &data, tlm_utils::tlm_quantumkeeper &keeper) {
+    const sc_core::sc_time issue = keeper.get_local_time();
+    sc_core::sc_time complete;
+    unsigned char *dmi = dmi_pointer(address, tlm::TLM_WRITE_COMMAND, complete);
+    if (dmi != 0) {
+        *reinterpret_cast<hv_t *>(dmi) = data;
+        ++m_stats.dmi_accesses;
+        complete += issue;
+    } else {
+        hv_t buffer = data;
+        complete = memory_transport(tlm::TLM_WRITE_COMMAND, address, buffer, issue);
+    }
+    count_memory_access(tlm::TLM_WRITE_COMMAND, complete - issue);
+    advance_local_time(keeper, complete);
+}
+
+// One b_transport issued at local time `issue`; returns the local time at
+// which it completes.
+sc_core::sc_time HDC_Accelerator::memory_transport(tlm::tlm_command command, std::uint64_t address, hv_t &data,
+                                                   const sc_core::sc_time &issue) {
+    tlm::tlm_generic_payload trans;
+    trans.set_command(command);
+    trans.set_address(address);
+    trans.set_data_ptr(reinterpret_cast<unsigned char *>(&data));
+    trans.set_data_length(static_cast<unsigned>(HV_SLOT_BYTES));
+    trans.set_streaming_width(static_cast<unsigned>(HV_SLOT_BYTES));
+    trans.set_byte_enable_ptr(0);
+    trans.set_dmi_allowed(false);
+    trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+    sc_core::sc_time delay = issue;
+    memory_socket->b_transport(trans, delay);
+    if (trans.is_response_error()) {
+        SC_REPORT_FATAL("HDC_Accelerator", trans.get_response_string().c_str());
+    }
+
+    if (trans.is_dmi_allowed()) {
+        for (int region = 0; region < DMI_REGIONS; ++region) {
+            if (!m_dmi_valid[region]) {
+                m_dmi_valid[region] = memory_socket->get_direct_mem_ptr(trans, m_dmi[region]);
+                break;
+            }
+        }
+    }
+    return delay;
+}
+
+// Pointer to `address` in a granted DMI region that allows `command`, or null.
+unsigned char *HDC_Accelerator::dmi_pointer(std::uint64_t address, tlm::tlm_command command,
+                                            sc_core::sc_time &latency) {
+    for (int region = 0; region < DMI_REGIONS; ++region) {
+        const tlm::tlm_dmi &dmi = m_dmi[region];
+        if (!m_dmi_valid[region] || address < dmi.get_start_address() ||
+            address + HV_SLOT_BYTES - 1 > dmi.get_end_address()) {
+            continue;
+        }
+        if (command == tlm::TLM_READ_COMMAND && dmi.is_read_allowed()) {
+            latency = dmi.get_read_latency();
+        } else if (command == tlm::TLM_WRITE_COMMAND && dmi.is_write_allowed()) {
+            latency = dmi.get_write_latency();
+        } else {
+            continue;
+        }
+        return dmi.get_dmi_ptr() + (address - dmi.get_start_address());
+    }
+    return 0;
+}
+
+void HDC_Accelerator::invalidate_direct_mem_ptr(sc_dt::uint64 start_range, sc_dt::uint64 end_range) {
+    for (int region = 0; region < DMI_REGIONS; ++region) {
+        if (m_dmi[region].get_start_address() <= end_range && m_dmi[region].get_end_address() >= start_range) {
+            m_dmi_valid[region] = false;
+        }
+    }
+}
+
+void HDC_Accelerator::count_memory_access(tlm::tlm_command command, const sc_core::sc_time &latency) {
+    if (command == tlm::TLM_WRITE_COMMAND) {
+        ++m_stats.bus_writes;
+    } else {
+        ++m_stats.bus_reads;
+    }
+    m_stats.bus_bytes += (VECTOR_DIMENSION + 7u) / 8u;
+    m_stats.bus_time_ps += static_cast<std::uint64_t>(latency / sc_core::sc_time(1, sc_core::SC_PS));
+}
+
+// Moves the thread's local time to `local_time`; the thread only yields once
+// the quantum is used up, so zero-time accesses never yield.
+void HDC_Accelerator::advance_local_time(tlm_utils::tlm_quantumkeeper &keeper, const sc_core::sc_time &local_time) {
+    if (local_time == keeper.get_local_time()) {
+        return;
+    }
+    keeper.set(local_time);
+    if (keeper.need_sync()) {
+        keeper.sync();
+    }
+}
+
 } // namespace hdc_systemc
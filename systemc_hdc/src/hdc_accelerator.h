@@ -2,13 +2,36 @@
 #define SYSTEMC_HDC_HDC_ACCELERATOR_H
 
 #include <ostream>
+#include <cstdint>
+#include <memory>
+#include <vector>
 #include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <tlm_utils/tlm_quantumkeeper.h>
 #include "systemc_types.h"
 #include "hdc_transactions.h"
 #include "hdc_memory.h"
 
 namespace hdc_systemc {
 
+// Elaboration-time parameters of one accelerator instance; the defaults come
+// from config_systemc.h. VECTOR_DIMENSION stays compile-time (hv_t width).
+struct AcceleratorConfig {
+    unsigned encoder_pes = ENCODER_PES;
+    unsigned ngram_pes = NGRAM_PES;
+    unsigned pe_word_bits = ACCEL_PE_WORD_BITS;
+    double clock_period_ns = ACCEL_CLOCK_PERIOD_NS;
+    unsigned fifo_depth = ACCEL_FIFO_DEPTH;
+    unsigned depth_encode_cycles = ACCEL_DEPTH_ENCODE_CYCLES;
+    unsigned depth_ngram_cycles = ACCEL_DEPTH_NGRAM_CYCLES;
+    unsigned depth_distance_cycles = ACCEL_DEPTH_DISTANCE_CYCLES;
+};
+
+// Applies one `name=value` option (e.g. encoder_pes=16) to `config`.
+// Returns false for an unknown name or an invalid value.
+bool parse_accelerator_option(AcceleratorConfig &config, const char *option);
+
 struct PipelineItem {
     AccelCommandKind kind;
     class_t class_id;
@@ -16,11 +39,14 @@ struct PipelineItem {
     hv_t encoded;
     hv_t ngram;
     bool valid_ngram;
+    // When the producing stage's pipeline hands the item on.
+    sc_core::sc_time ready_time;
 };
 
 struct DistanceResponse {
     bool valid_prediction;
     distance_counter_t distances[NUM_CLASSES];
+    sc_core::sc_time ready_time;
 };
 
 inline std::ostream &operator<<(std::ostream &os, const PipelineItem &item) {
@@ -41,14 +67,34 @@ inline std::ostream &operator<<(std::ostream &os, const DistanceResponse &respon
     return os << "]}";
 }
 
+// Sees every datapath result, e.g. to check it against a reference model
+// (cosim.cpp). The callbacks run in the stage threads; each stage reports its
+// items in command order, but the stages run ahead of each other.
+class AcceleratorObserver {
+public:
+    virtual ~AcceleratorObserver() {}
+    // Every item leaving the encoder and the n-gram stage, controls included.
+    virtual void encoded(const PipelineItem &item) = 0;
+    virtual void ngram(const PipelineItem &item) = 0;
+    // A class vector written back by the bundler.
+    virtual void class_vector(unsigned class_id, const hv_t &class_hv) = 0;
+    // Every inference result.
+    virtual void distances(const DistanceResponse &response) = 0;
+};
+
 SC_MODULE(HDC_Accelerator) {
 public:
     sc_core::sc_fifo_in<AccelCommand> cmd_in;
     sc_core::sc_fifo_out<AccelResponse> rsp_out;
+    // CiM and associative memory, bound to HDC_Memory::socket.
+    tlm_utils::simple_initiator_socket<HDC_Accelerator> memory_socket;
 
-    SC_CTOR(HDC_Accelerator);
+    SC_HAS_PROCESS(HDC_Accelerator);
+    HDC_Accelerator(sc_core::sc_module_name name, const AcceleratorConfig &config = AcceleratorConfig());
+
+    const AcceleratorConfig &config() const;
+    void set_observer(AcceleratorObserver *observer);
 
-    void bind_memory(HDC_Memory *memory);
     void reset_stats();
     const AcceleratorStats &stats() const;
 
@@ -59,6 +105,15 @@ private:
     void ngram_thread();
     void bundler_thread();
     void distance_thread();
+    void response_thread();
+
+    // Timing model: occupy a stage for its II, wait for an item's pipeline
+    // latency, count the cycles a stage is blocked on its output FIFO.
+    void occupy_stage(AccelStage stage, unsigned cycles);
+    void wait_until(const sc_core::sc_time &ready_time);
+    sc_core::sc_time clock_cycles(unsigned cycles) const;
+    template <typename Fifo, typename Item>
+    void write_output(Fifo &fifo, const Item &item, AccelStage stage);
 
     // Encoder datapath.
     void encode_sample_parallel(const QuantizedSample &sample, hv_t &encoded_sample);
@@ -77,6 +132,17 @@ private:
     void finalize_current_class();
     void reset_ngram_buffer();
 
+    // Memory port. Each thread passes its own quantum keeper.
+    void read_hvs(const std::uint64_t *addresses, unsigned count, const hv_t **rows, hv_t *buffers,
+                  tlm_utils::tlm_quantumkeeper &keeper);
+    void write_hv(std::uint64_t address, const hv_t &data, tlm_utils::tlm_quantumkeeper &keeper);
+    sc_core::sc_time memory_transport(tlm::tlm_command command, std::uint64_t address, hv_t &data,
+                                      const sc_core::sc_time &issue);
+    unsigned char *dmi_pointer(std::uint64_t address, tlm::tlm_command command, sc_core::sc_time &latency);
+    void invalidate_direct_mem_ptr(sc_dt::uint64 start_range, sc_dt::uint64 end_range);
+    void count_memory_access(tlm::tlm_command command, const sc_core::sc_time &latency);
+    void advance_local_time(tlm_utils::tlm_quantumkeeper &keeper, const sc_core::sc_time &local_time);
+
     // Distance datapath.
     void compute_hamming_distances_parallel(const hv_t &query, distance_counter_t *distances);
     void distance_class_pe_thread(unsigned class_id);
@@ -91,19 +157,20 @@ private:
 
     // Encoder PE state. Done flags avoid missed zero-time event notifications.
     sc_core::sc_event m_encode_start_event;
-    sc_core::sc_event m_encode_done_event[ENCODER_PES];
-    QuantizedSample m_encode_current_sample;
+    std::unique_ptr<sc_core::sc_event[]> m_encode_done_event;
+    const hv_t *m_encode_rows[NUM_FEATURES];
+    hv_t m_encode_row_buffers[NUM_FEATURES];
     hv_t m_encode_current_output;
-    bool m_encode_done_flags[ENCODER_PES];
+    std::vector<bool> m_encode_done_flags;
 
     // N-gram PE state. Done flags avoid missed zero-time event notifications.
     sc_core::sc_event m_ngram_start_event;
-    sc_core::sc_event m_ngram_done_event[NGRAM_PES];
+    std::unique_ptr<sc_core::sc_event[]> m_ngram_done_event;
     hv_t m_ngram_current_output;
     const hv_t *m_ngram_work_input;
     const hv_t *m_ngram_work_rhs;
     hv_t *m_ngram_work_output;
-    bool m_ngram_done_flags[NGRAM_PES];
+    std::vector<bool> m_ngram_done_flags;
     hv_t m_ngram_buffer[N_GRAM_SIZE];
     int m_ngram_buffer_write_pos;
     int m_ngram_buffer_fill_count;
@@ -117,11 +184,30 @@ private:
     sc_core::sc_event m_distance_start_event;
     sc_core::sc_event m_distance_done_event[NUM_CLASSES];
     hv_t m_distance_current_query;
+    const hv_t *m_distance_class_vectors[NUM_CLASSES];
+    hv_t m_distance_class_buffers[NUM_CLASSES];
     distance_counter_t m_distance_current_result[NUM_CLASSES];
     bool m_distance_done_flags[NUM_CLASSES];
 
+    // Temporal decoupling: local time of the threads that access memory.
+    tlm_utils::tlm_quantumkeeper m_encoder_keeper;
+    tlm_utils::tlm_quantumkeeper m_bundler_keeper;
+    tlm_utils::tlm_quantumkeeper m_distance_keeper;
+
+    // DMI regions granted by the memory (CiM and associative memory).
+    static constexpr int DMI_REGIONS = 2;
+    tlm::tlm_dmi m_dmi[DMI_REGIONS];
+    bool m_dmi_valid[DMI_REGIONS];
+
+    const AcceleratorConfig m_config;
+    // Initiation intervals derived from m_config, see config_systemc.h.
+    const unsigned m_encode_ii_cycles;
+    const unsigned m_ngram_ii_cycles;
+    const unsigned m_bundle_ii_cycles;
+    const unsigned m_distance_ii_cycles;
+
     AcceleratorStats m_stats;
-    HDC_Memory *m_memory;
+    AcceleratorObserver *m_observer;
 };
 
 } // namespace hdc_systemc
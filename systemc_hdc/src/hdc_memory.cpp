@@ -6,23 +6,43 @@ namespace {
 static constexpr std::uint64_t HV_BYTES = (VECTOR_DIMENSION + 7u) / 8u;
 static constexpr std::uint64_t QUANTIZER_ROW_BYTES =
     static_cast<std::uint64_t>((NUM_LEVELS > 1) ? (NUM_LEVELS - 1) : 1) * sizeof(double);
+static constexpr double BUS_BYTES_PER_NS = HDC_BUS_BYTES_PER_NS;
 
 void clear_hv(hv_t &hv) {
+#if HV_NATIVE_WORDS
+    hv = hv_t();
+#else
     for (int d = 0; d < VECTOR_DIMENSION; ++d) {
         hv[d] = sc_dt::SC_LOGIC_0;
     }
+#endif
+}
+
+// Time to move one hypervector over the accelerator bus.
+sc_core::sc_time hv_transfer_time() {
+    double ns = HDC_MEMORY_LATENCY_NS;
+    if (BUS_BYTES_PER_NS > 0) {
+        ns += static_cast<double>(HV_BYTES) / BUS_BYTES_PER_NS;
+    }
+    return sc_core::sc_time(ns, sc_core::SC_NS);
 }
 
 void copy_hv(const hv_t &src, hv_t &dst) {
+#if HV_NATIVE_WORDS
+    dst = src;
+#else
     for (int d = 0; d < VECTOR_DIMENSION; ++d) {
         dst[d] = src[d];
     }
+#endif
 }
 
 } // namespace
 
 HDC_Memory::HDC_Memory(sc_core::sc_module_name name)
-    : sc_module(name), m_cim_loaded(false), m_quantizer_loaded(false) {
+    : sc_module(name), socket("socket"), m_cim_loaded(false), m_quantizer_loaded(false), m_dmi_granted(false) {
+    socket.register_b_transport(this, &HDC_Memory::b_transport);
+    socket.register_get_direct_mem_ptr(this, &HDC_Memory::get_direct_mem_ptr);
     reset_stats();
     clear_all();
 }
@@ -39,6 +59,10 @@ void HDC_Memory::clear_all() {
     }
     m_cim_loaded = false;
     m_quantizer_loaded = false;
+    if (m_dmi_granted) {
+        socket->invalidate_direct_mem_ptr(0, ~std::uint64_t(0));
+        m_dmi_granted = false;
+    }
 }
 
 void HDC_Memory::reset_stats() {
@@ -50,6 +74,12 @@ void HDC_Memory::reset_stats() {
     m_stats.assoc_read_bytes = 0;
     m_stats.assoc_writes = 0;
     m_stats.assoc_write_bytes = 0;
+    for (int bank = 0; bank < HDC_CIM_BANKS; ++bank) {
+        m_stats.cim_banks[bank] = BankStats();
+    }
+    for (int bank = 0; bank < HDC_ASSOC_BANKS; ++bank) {
+        m_stats.assoc_banks[bank] = BankStats();
+    }
 }
 
 const MemoryStats &HDC_Memory::stats() const {
@@ -150,4 +180,105 @@ const hv_t &HDC_Memory::read_assoc_class(unsigned class_id) const {
     return m_assoc_mem[class_id];
 }
 
+void HDC_Memory::b_transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
+    const std::uint64_t address = trans.get_address();
+    hv_t *data = reinterpret_cast<hv_t *>(trans.get_data_ptr());
+    if (trans.get_byte_enable_ptr() != 0) {
+        trans.set_response_status(tlm::TLM_BYTE_ENABLE_ERROR_RESPONSE);
+        return;
+    }
+    if (trans.get_data_length() != HV_SLOT_BYTES || trans.get_streaming_width() < HV_SLOT_BYTES ||
+        (address % HV_SLOT_BYTES) != 0) {
+        trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
+        return;
+    }
+
+    if (address >= CIM_BASE_ADDRESS && address < CIM_BASE_ADDRESS + CIM_REGION_BYTES) {
+        if (!trans.is_read()) {
+            trans.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
+            return;
+        }
+        const std::uint64_t row = (address - CIM_BASE_ADDRESS) / HV_SLOT_BYTES;
+        const unsigned level = static_cast<unsigned>(row / NUM_FEATURES);
+        const unsigned feature = static_cast<unsigned>(row % NUM_FEATURES);
+        copy_hv(read_cim(level_t(level), feature), *data);
+        const unsigned bank = (HDC_CIM_BANK_BY_LEVEL ? level : feature) % HDC_CIM_BANKS;
+        delay = access_bank(m_cim_port_free[bank], HDC_CIM_PORTS_PER_BANK, delay, m_stats.cim_banks[bank]);
+    } else if (address >= ASSOC_BASE_ADDRESS && address < ASSOC_BASE_ADDRESS + ASSOC_REGION_BYTES) {
+        const unsigned class_id = static_cast<unsigned>((address - ASSOC_BASE_ADDRESS) / HV_SLOT_BYTES);
+        if (trans.is_read()) {
+            copy_hv(read_assoc_class(class_id), *data);
+        } else if (trans.is_write()) {
+            write_assoc_class(class_id, *data);
+        } else {
+            trans.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
+            return;
+        }
+        const unsigned bank = class_id % HDC_ASSOC_BANKS;
+        delay = access_bank(m_assoc_port_free[bank], HDC_ASSOC_PORTS_PER_BANK, delay, m_stats.assoc_banks[bank]);
+    } else {
+        trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+        return;
+    }
+
+    trans.set_dmi_allowed(HDC_TLM_DMI != 0 && hv_transfer_time() == sc_core::SC_ZERO_TIME);
+    trans.set_response_status(tlm::TLM_OK_RESPONSE);
+}
+
+// Reserves the first free port of a bank for an access arriving `arrival`
+// after the current time; returns when, relative to now, the access is done.
+sc_core::sc_time HDC_Memory::access_bank(sc_core::sc_time *port_free, int ports, const sc_core::sc_time &arrival,
+                                         BankStats &bank) {
+    const sc_core::sc_time now = sc_core::sc_time_stamp();
+    const sc_core::sc_time service = hv_transfer_time();
+    int port = 0;
+    for (int candidate = 1; candidate < ports; ++candidate) {
+        if (port_free[candidate] < port_free[port]) {
+            port = candidate;
+        }
+    }
+
+    sc_core::sc_time start = now + arrival;
+    ++bank.accesses;
+    if (port_free[port] > start) {
+        ++bank.conflicts;
+        bank.conflict_ps += static_cast<std::uint64_t>((port_free[port] - start) / sc_core::sc_time(1, sc_core::SC_PS));
+        start = port_free[port];
+    }
+    port_free[port] = start + service;
+    bank.busy_ps += static_cast<std::uint64_t>(service / sc_core::sc_time(1, sc_core::SC_PS));
+    return port_free[port] - now;
+}
+
+// Grants the CiM (read-only, once loaded) or the associative memory
+// (read/write) while the memory is untimed. Accesses through the pointer
+// bypass the stats and the bank model; the accelerator counts them itself.
+bool HDC_Memory::get_direct_mem_ptr(tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi_data) {
+    const std::uint64_t address = trans.get_address();
+    dmi_data.set_read_latency(hv_transfer_time());
+    dmi_data.set_write_latency(hv_transfer_time());
+
+    if (HDC_TLM_DMI == 0 || hv_transfer_time() != sc_core::SC_ZERO_TIME) {
+        return false;
+    }
+    if (address >= CIM_BASE_ADDRESS && address < CIM_BASE_ADDRESS + CIM_REGION_BYTES) {
+        if (!m_cim_loaded) {
+            return false;
+        }
+        dmi_data.set_dmi_ptr(reinterpret_cast<unsigned char *>(m_cim));
+        dmi_data.set_start_address(CIM_BASE_ADDRESS);
+        dmi_data.set_end_address(CIM_BASE_ADDRESS + CIM_REGION_BYTES - 1);
+        dmi_data.allow_read();
+    } else if (address >= ASSOC_BASE_ADDRESS && address < ASSOC_BASE_ADDRESS + ASSOC_REGION_BYTES) {
+        dmi_data.set_dmi_ptr(reinterpret_cast<unsigned char *>(m_assoc_mem));
+        dmi_data.set_start_address(ASSOC_BASE_ADDRESS);
+        dmi_data.set_end_address(ASSOC_BASE_ADDRESS + ASSOC_REGION_BYTES - 1);
+        dmi_data.allow_read_write();
+    } else {
+        return false;
+    }
+    m_dmi_granted = true;
+    return true;
+}
+
 } // namespace hdc_systemc
@@ -1,13 +1,38 @@
 #ifndef SYSTEMC_HDC_HDC_MEMORY_H
 #define SYSTEMC_HDC_HDC_MEMORY_H
 
+#include <cstdint>
 #include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_target_socket.h>
 #include "systemc_types.h"
 
 namespace hdc_systemc {
 
+// Address map of the TLM port. A transfer moves one whole hypervector:
+// data_length is HV_SLOT_BYTES and data_ptr points to an hv_t object.
+static constexpr std::uint64_t HV_SLOT_BYTES = sizeof(hv_t);
+static constexpr std::uint64_t CIM_BASE_ADDRESS = 0;
+static constexpr std::uint64_t CIM_REGION_BYTES =
+    static_cast<std::uint64_t>(NUM_LEVELS) * NUM_FEATURES * HV_SLOT_BYTES;
+static constexpr std::uint64_t ASSOC_BASE_ADDRESS = std::uint64_t(1) << 32;
+static constexpr std::uint64_t ASSOC_REGION_BYTES = static_cast<std::uint64_t>(NUM_CLASSES) * HV_SLOT_BYTES;
+
+inline std::uint64_t cim_address(unsigned level, unsigned feature) {
+    return CIM_BASE_ADDRESS + ((static_cast<std::uint64_t>(level) * NUM_FEATURES) + feature) * HV_SLOT_BYTES;
+}
+
+inline std::uint64_t assoc_address(unsigned class_id) {
+    return ASSOC_BASE_ADDRESS + static_cast<std::uint64_t>(class_id) * HV_SLOT_BYTES;
+}
+
 SC_MODULE(HDC_Memory) {
 public:
+    // Accelerator port: b_transport for CiM reads and class vector
+    // reads/writes, DMI when HDC_TLM_DMI is set. The controller loads the
+    // tables through the direct calls below.
+    tlm_utils::simple_target_socket<HDC_Memory> socket;
+
     SC_CTOR(HDC_Memory);
 
     void clear_all();
@@ -29,12 +54,21 @@ public:
     void clear_assoc_mem();
 
 private:
+    void b_transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay);
+    bool get_direct_mem_ptr(tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi_data);
+    sc_core::sc_time access_bank(sc_core::sc_time *port_free, int ports, const sc_core::sc_time &arrival,
+                                 BankStats &bank);
+
     hv_t m_cim[NUM_LEVELS * NUM_FEATURES];
     double m_quantizer_boundaries[NUM_FEATURES * ((NUM_LEVELS > 1) ? (NUM_LEVELS - 1) : 1)];
     hv_t m_assoc_mem[NUM_CLASSES];
     bool m_cim_loaded;
     bool m_quantizer_loaded;
+    bool m_dmi_granted;
     mutable MemoryStats m_stats;
+    // Time at which each port of each bank is free again.
+    sc_core::sc_time m_cim_port_free[HDC_CIM_BANKS][HDC_CIM_PORTS_PER_BANK];
+    sc_core::sc_time m_assoc_port_free[HDC_ASSOC_BANKS][HDC_ASSOC_PORTS_PER_BANK];
 };
 
 } // namespace hdc_systemc
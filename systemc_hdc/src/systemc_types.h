@@ -28,7 +28,87 @@ typedef sc_dt::sc_uint<CLASS_BITS> class_t;
 typedef sc_dt::sc_uint<FEATURE_COUNT_BITS> feature_counter_t;
 typedef sc_dt::sc_uint<DISTANCE_BITS> distance_counter_t;
 typedef sc_dt::sc_uint<TRAIN_COUNT_BITS> train_counter_t;
+
+#if HV_NATIVE_WORDS
+// Simulation-speed stand-in for sc_dt::sc_bv<N>: the bits are packed into
+// uint64_t words, with the sc_bv bit access the models use (hv[i].to_bool(),
+// hv[i] = SC_LOGIC_x). Bits past N stay zero.
+template <int N>
+class native_bv {
+public:
+    static constexpr int WORDS = (N + 63) / 64;
+
+    class const_bit_ref {
+    public:
+        const_bit_ref(const std::uint64_t &word, int bit) : m_word(word), m_bit(bit) {}
+        bool to_bool() const { return ((m_word >> m_bit) & 1u) != 0; }
+
+    private:
+        const std::uint64_t &m_word;
+        int m_bit;
+    };
+
+    class bit_ref {
+    public:
+        bit_ref(std::uint64_t &word, int bit) : m_word(word), m_bit(bit) {}
+        bool to_bool() const { return ((m_word >> m_bit) & 1u) != 0; }
+        bit_ref &operator=(bool value) {
+            const std::uint64_t mask = std::uint64_t(1) << m_bit;
+            m_word = value ? (m_word | mask) : (m_word & ~mask);
+            return *this;
+        }
+        bit_ref &operator=(const sc_dt::sc_logic &value) { return *this = value.to_bool(); }
+        bit_ref &operator=(const const_bit_ref &value) { return *this = value.to_bool(); }
+        bit_ref &operator=(const bit_ref &value) { return *this = value.to_bool(); }
+
+    private:
+        std::uint64_t &m_word;
+        int m_bit;
+    };
+
+    native_bv() : m_words() {}
+
+    bit_ref operator[](int index) { return bit_ref(m_words[index >> 6], index & 63); }
+    const_bit_ref operator[](int index) const { return const_bit_ref(m_words[index >> 6], index & 63); }
+    int length() const { return N; }
+
+    std::uint64_t *words() { return m_words; }
+    const std::uint64_t *words() const { return m_words; }
+
+    bool operator==(const native_bv &other) const {
+        for (int w = 0; w < WORDS; ++w) {
+            if (m_words[w] != other.m_words[w]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    std::uint64_t m_words[WORDS];
+};
+
+typedef native_bv<VECTOR_DIMENSION> hv_t;
+#else
 typedef sc_dt::sc_bv<VECTOR_DIMENSION> hv_t;
+#endif
+
+// Number of differing bits; one popcount per word with native words.
+inline unsigned hv_hamming_distance(const hv_t &lhs, const hv_t &rhs) {
+    unsigned distance = 0;
+#if HV_NATIVE_WORDS
+    for (int w = 0; w < hv_t::WORDS; ++w) {
+        distance += static_cast<unsigned>(__builtin_popcountll(lhs.words()[w] ^ rhs.words()[w]));
+    }
+#else
+    for (int d = 0; d < VECTOR_DIMENSION; ++d) {
+        if (lhs[d].to_bool() != rhs[d].to_bool()) {
+            ++distance;
+        }
+    }
+#endif
+    return distance;
+}
 
 struct EvaluationResult {
     unsigned correct;
@@ -40,6 +120,18 @@ struct EvaluationResult {
     unsigned confusion_matrix[NUM_CLASSES][NUM_CLASSES];
 };
 
+// One memory bank, counting the accelerator's b_transport accesses: how many,
+// how many found every port busy, how long those waited and how long the
+// bank's ports were busy in total.
+struct BankStats {
+    std::uint64_t accesses;
+    std::uint64_t conflicts;
+    std::uint64_t conflict_ps;
+    std::uint64_t busy_ps;
+};
+
+// Accesses served by HDC_Memory itself; accesses through DMI only show up
+// in AcceleratorStats.
 struct MemoryStats {
     std::uint64_t quantizer_row_reads;
     std::uint64_t quantizer_row_read_bytes;
@@ -49,8 +141,24 @@ struct MemoryStats {
     std::uint64_t assoc_read_bytes;
     std::uint64_t assoc_writes;
     std::uint64_t assoc_write_bytes;
+    BankStats cim_banks[HDC_CIM_BANKS];
+    BankStats assoc_banks[HDC_ASSOC_BANKS];
+};
+
+// Pipeline stages with their own timing counters.
+enum AccelStage {
+    ACCEL_STAGE_ENCODER,
+    ACCEL_STAGE_NGRAM,
+    ACCEL_STAGE_BUNDLER,
+    ACCEL_STAGE_DISTANCE,
+    ACCEL_NUM_STAGES
 };
 
+inline const char *accel_stage_name(int stage) {
+    static const char *const names[ACCEL_NUM_STAGES] = {"encoder", "ngram", "bundler", "distance"};
+    return (stage >= 0 && stage < ACCEL_NUM_STAGES) ? names[stage] : "unknown";
+}
+
 struct AcceleratorStats {
     std::uint64_t command_count;
     std::uint64_t train_samples;
@@ -62,6 +170,17 @@ struct AcceleratorStats {
     std::uint64_t bundle_flushes;
     std::uint64_t distance_requests;
     std::uint64_t valid_distance_requests;
+    // Hypervector transfers on the memory port (dmi_accesses of them through
+    // DMI) and the access time they annotated.
+    std::uint64_t bus_reads;
+    std::uint64_t bus_writes;
+    std::uint64_t bus_bytes;
+    std::uint64_t dmi_accesses;
+    std::uint64_t bus_time_ps;
+    // Per stage: clock cycles spent working (II per sample) and blocked on a
+    // full output FIFO.
+    std::uint64_t stage_busy_cycles[ACCEL_NUM_STAGES];
+    std::uint64_t stage_stall_cycles[ACCEL_NUM_STAGES];
 };
 
 } // namespace hdc_systemc
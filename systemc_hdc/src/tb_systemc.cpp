@@ -1,7 +1,13 @@
 #include <cstdlib>
 #include <cstdio>
 #include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
 #include "controller.h"
 #include "foot_dataset_loader.h"
 
@@ -9,6 +15,29 @@ using namespace hdc_systemc;
 
 namespace {
 
+// What one dataset's simulation reports; plain data, so a forked simulation
+// can hand it back through a pipe.
+struct DatasetReport {
+    EvaluationResult test_result;
+    MemoryStats memory_stats;
+    AcceleratorStats accelerator_stats;
+    std::uint64_t sim_time_ps;
+};
+
+DatasetReport collect_report(const Controller &controller, int dataset) {
+    DatasetReport report;
+    report.test_result = controller.test_result(dataset);
+    report.memory_stats = controller.memory_stats(dataset);
+    report.accelerator_stats = controller.accelerator_stats(dataset);
+    report.sim_time_ps = static_cast<std::uint64_t>(
+        controller.dataset_sim_time(dataset) / sc_core::sc_time(1, sc_core::SC_PS) + 0.5);
+    return report;
+}
+
+sc_core::sc_time report_sim_time(const DatasetReport &report) {
+    return sc_core::sc_time(static_cast<double>(report.sim_time_ps), sc_core::SC_PS);
+}
+
 void print_eval_result(const char *name, const EvaluationResult &result) {
     std::cout << name << " accuracy: " << (result.overall_accuracy * 100.0) << "%" << std::endl;
     std::cout << name << " accuracy excl. transitions: "
@@ -19,7 +48,21 @@ void print_eval_result(const char *name, const EvaluationResult &result) {
               << ", total=" << result.total << std::endl;
 }
 
-void print_memory_stats(const MemoryStats &stats) {
+void print_bank_stats(const char *name, const BankStats *banks, int count, double sim_ps) {
+    for (int bank = 0; bank < count; ++bank) {
+        if (banks[bank].accesses == 0) {
+            continue;
+        }
+        std::cout << "  " << name << " bank " << bank << ": accesses=" << banks[bank].accesses
+                  << ", conflicts=" << banks[bank].conflicts
+                  << ", conflict wait=" << sc_core::sc_time(static_cast<double>(banks[bank].conflict_ps), sc_core::SC_PS)
+                  << ", utilization="
+                  << (sim_ps > 0.0 ? 100.0 * static_cast<double>(banks[bank].busy_ps) / sim_ps : 0.0) << "%"
+                  << std::endl;
+    }
+}
+
+void print_memory_stats(const MemoryStats &stats, const sc_core::sc_time &sim_time) {
     const std::uint64_t total_read_accesses =
         stats.quantizer_row_reads + stats.cim_reads + stats.assoc_reads;
     const std::uint64_t total_read_bytes =
@@ -40,9 +83,25 @@ void print_memory_stats(const MemoryStats &stats) {
               << ", bytes=" << total_read_bytes << std::endl;
     std::cout << "  total writes: " << total_write_accesses
               << ", bytes=" << total_write_bytes << std::endl;
+
+    // Bank counters and bandwidth only cover b_transport accesses (timed runs).
+    const double sim_ps = sim_time / sc_core::sc_time(1, sc_core::SC_PS);
+    if (sim_ps > 0.0) {
+        std::cout << "  achieved CiM bandwidth: " << static_cast<double>(stats.cim_read_bytes) * 1e3 / sim_ps
+                  << " GB/s" << std::endl;
+    }
+    print_bank_stats("CiM", stats.cim_banks, HDC_CIM_BANKS, sim_ps);
+    print_bank_stats("associative", stats.assoc_banks, HDC_ASSOC_BANKS, sim_ps);
+}
+
+double stage_utilization(const AcceleratorStats &stats, int stage, const sc_core::sc_time &sim_time,
+                         double clock_period_ns) {
+    const double cycles = sim_time / sc_core::sc_time(clock_period_ns, sc_core::SC_NS);
+    return cycles > 0.0 ? static_cast<double>(stats.stage_busy_cycles[stage]) / cycles : 0.0;
 }
 
-void print_accelerator_stats(const AcceleratorStats &stats) {
+void print_accelerator_stats(const AcceleratorStats &stats, const sc_core::sc_time &sim_time,
+                             double clock_period_ns) {
     std::cout << "Accelerator stats:" << std::endl;
     std::cout << "  commands: " << stats.command_count << std::endl;
     std::cout << "  train samples: " << stats.train_samples << std::endl;
@@ -54,36 +113,260 @@ void print_accelerator_stats(const AcceleratorStats &stats) {
     std::cout << "  bundle flushes: " << stats.bundle_flushes << std::endl;
     std::cout << "  distance requests: " << stats.distance_requests << std::endl;
     std::cout << "  valid distance requests: " << stats.valid_distance_requests << std::endl;
+    std::cout << "  memory port reads: " << stats.bus_reads
+              << ", writes=" << stats.bus_writes
+              << ", bytes=" << stats.bus_bytes
+              << ", via DMI=" << stats.dmi_accesses << std::endl;
+    std::cout << "  memory port time: " << sc_core::sc_time(static_cast<double>(stats.bus_time_ps), sc_core::SC_PS)
+              << std::endl;
+
+    const double seconds = sim_time.to_seconds();
+    if (seconds > 0.0) {
+        std::cout << "  throughput: "
+                  << static_cast<double>(stats.train_samples + stats.infer_samples) / seconds
+                  << " samples/s" << std::endl;
+    }
+    for (int stage = 0; stage < ACCEL_NUM_STAGES; ++stage) {
+        std::cout << "  " << accel_stage_name(stage) << ": utilization="
+                  << 100.0 * stage_utilization(stats, stage, sim_time, clock_period_ns)
+                  << "%, busy cycles=" << stats.stage_busy_cycles[stage]
+                  << ", stall cycles=" << stats.stage_stall_cycles[stage] << std::endl;
+    }
+}
+
+// Per processed sample, with the counter names of the C model's HDC_COST_MODEL
+// report (hdc_cost_print). Memory counters come from MemoryStats, so DMI
+// accesses are missing from them; operation counters are derived from the
+// pipeline counts: the n-gram stage binds N_GRAM_SIZE - 1 times per valid
+// n-gram, the distance stage compares every class in full, the encoder
+// bundles NUM_FEATURES votes and the bundler one vote per dimension.
+void print_cost_per_sample(const MemoryStats &memory, const AcceleratorStats &stats) {
+    const std::uint64_t samples = stats.train_samples + stats.infer_samples;
+    if (samples == 0) {
+        return;
+    }
+    const std::uint64_t hv_words = (VECTOR_DIMENSION + 63u) / 64u;
+    const std::uint64_t distance_words = stats.valid_distance_requests * NUM_CLASSES * hv_words;
+    const struct {
+        const char *name;
+        std::uint64_t total;
+    } counters[] = {
+        {"quantizer_row_reads", memory.quantizer_row_reads},
+        {"quantizer_row_read_bytes", memory.quantizer_row_read_bytes},
+        {"cim_reads", memory.cim_reads},
+        {"cim_read_bytes", memory.cim_read_bytes},
+        {"assoc_reads", memory.assoc_reads},
+        {"assoc_read_bytes", memory.assoc_read_bytes},
+        {"assoc_writes", memory.assoc_writes},
+        {"assoc_write_bytes", memory.assoc_write_bytes},
+        {"xor_words", stats.valid_ngrams * (N_GRAM_SIZE - 1) * hv_words + distance_words},
+        {"popcount_words", distance_words},
+        {"counter_updates", (stats.encoded_samples * NUM_FEATURES + stats.bundled_ngrams) *
+                                static_cast<std::uint64_t>(VECTOR_DIMENSION)},
+    };
+    std::cout << "Cost per sample (" << samples << " samples, " << stats.dmi_accesses
+              << " DMI accesses not in the memory counters):" << std::endl;
+    for (const auto &counter : counters) {
+        std::cout << "  " << counter.name << ": "
+                  << static_cast<double>(counter.total) / static_cast<double>(samples) << std::endl;
+    }
+}
+
+// One row per dataset for the design-space exploration runner (dse_runner.cpp).
+void append_summary_csv(const char *path, const AcceleratorConfig &config, const DatasetReport *reports) {
+    std::ofstream csv(path, std::ios::app);
+    if (!csv.is_open()) {
+        SC_REPORT_FATAL("tb_systemc", "failed to open summary CSV");
+    }
+    csv.seekp(0, std::ios::end);
+    if (csv.tellp() == 0) {
+        csv << "dimension,encoder_pes,ngram_pes,pe_word_bits,dataset,accuracy,sim_time_ns,samples,"
+               "cim_reads,assoc_reads,assoc_writes,bus_reads,bus_writes,bus_bytes";
+        for (int stage = 0; stage < ACCEL_NUM_STAGES; ++stage) {
+            csv << ",util_" << accel_stage_name(stage);
+        }
+        for (int stage = 0; stage < ACCEL_NUM_STAGES; ++stage) {
+            csv << ",stall_" << accel_stage_name(stage);
+        }
+        csv << '\n';
+    }
+
+    for (int dataset = 0; dataset < NUM_DATASETS; ++dataset) {
+        const MemoryStats &memory = reports[dataset].memory_stats;
+        const AcceleratorStats &stats = reports[dataset].accelerator_stats;
+        const sc_core::sc_time sim_time = report_sim_time(reports[dataset]);
+        csv << VECTOR_DIMENSION << ',' << config.encoder_pes << ',' << config.ngram_pes << ','
+            << config.pe_word_bits << ',' << dataset << ','
+            << reports[dataset].test_result.overall_accuracy << ','
+            << sim_time / sc_core::sc_time(1, sc_core::SC_NS) << ','
+            << stats.train_samples + stats.infer_samples << ','
+            << memory.cim_reads << ',' << memory.assoc_reads << ',' << memory.assoc_writes << ','
+            << stats.bus_reads << ',' << stats.bus_writes << ',' << stats.bus_bytes;
+        for (int stage = 0; stage < ACCEL_NUM_STAGES; ++stage) {
+            csv << ',' << stage_utilization(stats, stage, sim_time, config.clock_period_ns);
+        }
+        for (int stage = 0; stage < ACCEL_NUM_STAGES; ++stage) {
+            csv << ',' << stats.stage_stall_cycles[stage];
+        }
+        csv << '\n';
+    }
+}
+
+// Runs every dataset in its own forked copy of the elaborated model, up to
+// `jobs` at a time, each with all other datasets disabled. The children share
+// the parent's loaded datasets and tables copy-on-write and write their
+// report back through a pipe. Forking before sc_start needs the default
+// user-space (QuickThreads) coroutines; a pthreads-coroutine SystemC build
+// must use jobs=1.
+bool run_forked(Controller &controller, long jobs, DatasetReport *reports) {
+    struct Child {
+        pid_t pid;
+        int fd;
+        int dataset;
+    };
+    std::vector<Child> running;
+    bool ok = true;
+    int next = 0;
+    std::cout << std::flush;
+    while (next < NUM_DATASETS || !running.empty()) {
+        while (ok && next < NUM_DATASETS && static_cast<long>(running.size()) < jobs) {
+            int fds[2];
+            if (pipe(fds) != 0) {
+                std::perror("tb_systemc: pipe failed");
+                ok = false;
+                break;
+            }
+            const pid_t pid = fork();
+            if (pid < 0) {
+                std::perror("tb_systemc: fork failed");
+                close(fds[0]);
+                close(fds[1]);
+                ok = false;
+                break;
+            }
+            if (pid == 0) {
+                close(fds[0]);
+                for (int dataset = 0; dataset < NUM_DATASETS; ++dataset) {
+                    controller.set_dataset_enabled(dataset, dataset == next);
+                }
+                sc_core::sc_start();
+                if (!controller.done()) {
+                    _exit(EXIT_FAILURE);
+                }
+                const DatasetReport report = collect_report(controller, next);
+                const bool written = write(fds[1], &report, sizeof(report)) == static_cast<ssize_t>(sizeof(report));
+                std::cout << std::flush;
+                _exit(written ? EXIT_SUCCESS : EXIT_FAILURE);
+            }
+            close(fds[1]);
+            Child child = {pid, fds[0], next++};
+            running.push_back(child);
+        }
+        if (running.empty()) {
+            break;
+        }
+
+        int status = 0;
+        const pid_t done = wait(&status);
+        if (done < 0) {
+            std::perror("tb_systemc: wait failed");
+            return false;
+        }
+        for (std::size_t i = 0; i < running.size(); ++i) {
+            if (running[i].pid != done) {
+                continue;
+            }
+            // The report fits in the pipe buffer, so it is complete once the child exits.
+            const Child child = running[i];
+            const bool read_ok = read(child.fd, &reports[child.dataset], sizeof(DatasetReport)) ==
+                                 static_cast<ssize_t>(sizeof(DatasetReport));
+            close(child.fd);
+            if (!(WIFEXITED(status) && WEXITSTATUS(status) == 0 && read_ok)) {
+                std::cerr << "tb_systemc: dataset " << child.dataset << " simulation failed" << std::endl;
+                ok = false;
+            }
+            running.erase(running.begin() + static_cast<std::ptrdiff_t>(i));
+            break;
+        }
+    }
+    return ok;
 }
 
 } // namespace
 
-int sc_main(int, char *[]) {
+// Options: accelerator parameters as name=value (see parse_accelerator_option),
+// import=<dir> for the CiM/quantizer exports (default import), csv=<path>
+// to append a summary row per dataset and jobs=N to simulate up to N datasets
+// in parallel processes (default 1: all datasets in this kernel, in order).
+int sc_main(int argc, char *argv[]) {
+    AcceleratorConfig accelerator_config;
+    std::string import_dir = "import";
+    const char *csv_path = 0;
+    long jobs = 1;
+    for (int arg = 1; arg < argc; ++arg) {
+        if (std::strncmp(argv[arg], "import=", 7) == 0) {
+            import_dir = argv[arg] + 7;
+        } else if (std::strncmp(argv[arg], "jobs=", 5) == 0) {
+            jobs = std::atol(argv[arg] + 5);
+            if (jobs <= 0) {
+                std::cerr << "tb_systemc: invalid option " << argv[arg] << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (std::strncmp(argv[arg], "csv=", 4) == 0) {
+            csv_path = argv[arg] + 4;
+        } else if (!parse_accelerator_option(accelerator_config, argv[arg])) {
+            std::cerr << "tb_systemc: unknown option " << argv[arg] << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Datasets and tables are loaded once, before any simulation starts, so
+    // forked simulations share them instead of each parsing the exports.
     FootDataset datasets[NUM_DATASETS];
-    char cim_paths[NUM_DATASETS][128];
-    char quantizer_paths[NUM_DATASETS][128];
-    Controller controller("controller");
+    std::vector<hv_t> cims[NUM_DATASETS];
+    std::vector<double> quantizer_cuts[NUM_DATASETS];
+    Controller controller("controller", accelerator_config);
 
     for (int dataset = 0; dataset < NUM_DATASETS; ++dataset) {
-        std::snprintf(cim_paths[dataset], sizeof(cim_paths[dataset]), "import/cim_dataset%02d.txt", dataset);
-        std::snprintf(quantizer_paths[dataset], sizeof(quantizer_paths[dataset]), "import/quantizer_dataset%02d.txt", dataset);
+        char name[64];
+        std::snprintf(name, sizeof(name), "/cim_dataset%02d.txt", dataset);
+        cims[dataset] = load_cim_text((import_dir + name).c_str());
+        std::snprintf(name, sizeof(name), "/quantizer_dataset%02d.txt", dataset);
+        quantizer_cuts[dataset] = load_quantizer_text((import_dir + name).c_str());
         datasets[dataset] = load_foot_dataset_by_id(dataset);
-        controller.configure(dataset, cim_paths[dataset], quantizer_paths[dataset], &datasets[dataset]);
+        controller.configure(dataset, cims[dataset].data(),
+                             quantizer_cuts[dataset].empty() ? 0 : quantizer_cuts[dataset].data(),
+                             &datasets[dataset]);
     }
 
-    sc_core::sc_start();
-    if (!controller.done()) {
-        SC_REPORT_FATAL("tb_systemc", "controller did not finish");
+    DatasetReport reports[NUM_DATASETS];
+    if (jobs > 1 && NUM_DATASETS > 1) {
+        if (!run_forked(controller, jobs, reports)) {
+            return EXIT_FAILURE;
+        }
+    } else {
+        sc_core::sc_start();
+        if (!controller.done()) {
+            SC_REPORT_FATAL("tb_systemc", "controller did not finish");
+        }
+        for (int dataset = 0; dataset < NUM_DATASETS; ++dataset) {
+            reports[dataset] = collect_report(controller, dataset);
+        }
     }
 
+    const AcceleratorConfig &config = controller.accelerator_config();
     for (int dataset = 0; dataset < NUM_DATASETS; ++dataset) {
-        const EvaluationResult &test_result = controller.test_result(dataset);
+        const sc_core::sc_time sim_time = report_sim_time(reports[dataset]);
 
         std::cout << "\nDataset " << dataset << std::endl;
-        print_eval_result("Test", test_result);
-        std::cout << "Simulation time: " << controller.dataset_sim_time(dataset) << std::endl;
-        print_memory_stats(controller.memory_stats(dataset));
-        print_accelerator_stats(controller.accelerator_stats(dataset));
+        print_eval_result("Test", reports[dataset].test_result);
+        std::cout << "Simulation time: " << sim_time << std::endl;
+        print_memory_stats(reports[dataset].memory_stats, sim_time);
+        print_accelerator_stats(reports[dataset].accelerator_stats, sim_time, config.clock_period_ns);
+        print_cost_per_sample(reports[dataset].memory_stats, reports[dataset].accelerator_stats);
+    }
+    if (csv_path != 0) {
+        append_summary_csv(csv_path, config, reports);
     }
 
     return EXIT_SUCCESS;
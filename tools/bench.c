@@ -0,0 +1,332 @@
+//Microbenchmarks of the HDC kernels for one compile-time VECTOR_DIMENSION.
+//
+//Usage:
+//  benchFoot [csv_path]
+//
+//Every benchmark is warmed up, then timed BENCH_REPETITIONS times over a batch
+//sized to run for about BENCH_TARGET_NS; the median batch gives ns/op and GB/s
+//(the vector bytes an op reads and writes, divided by its time). The suite runs
+//once per operations kernel this CPU supports (scalar, avx2, avx512-vpopcntdq),
+//so backends can be compared side by side. Rows are printed and, with a path,
+//appended to a CSV (header written when the file is empty). Inputs are random:
+//no dataset is needed, and classify sees unrelated class vectors.
+//`make bench` builds this once per dimension in BENCH_DIMENSIONS and writes
+//BENCH_CSV (default analysis/bench.csv).
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../hdc_infrastructure/assoc_mem.h"
+#include "../hdc_infrastructure/encoder.h"
+#include "../hdc_infrastructure/item_mem.h"
+#include "../hdc_infrastructure/operations.h"
+#include "../hdc_infrastructure/quantizer.h"
+#include "../hdc_infrastructure/vector.h"
+
+#if BIPOLAR_MODE || !PRECOMPUTED_ITEM_MEMORY
+#error "The benchmarks cover the binary precomputed item memory build."
+#endif
+
+#ifndef BENCH_REPETITIONS
+#define BENCH_REPETITIONS 15 // timed batches per benchmark; the median is reported
+#endif
+#ifndef BENCH_TARGET_NS
+#define BENCH_TARGET_NS 2000000.0 // approximate duration of one timed batch
+#endif
+#ifndef BENCH_QUANTIZER_SAMPLES
+#define BENCH_QUANTIZER_SAMPLES 4096 // synthetic samples the benchmark quantizer is fitted on
+#endif
+
+int output_mode = OUTPUT_NONE;
+
+static const char *const kernel_names[] = {"scalar", "avx2", "avx512-vpopcntdq"};
+
+/**
+ * @brief Shared inputs of all benchmarks; built once, reused for every kernel.
+ */
+struct bench_inputs {
+    Vector *a;
+    Vector *b;
+    Vector *out;
+    Vector **operands;              /**< NUM_FEATURES random vectors for bundle_multi. */
+    vector_element *operand_storage;
+    struct item_memory item_mem;
+    struct quantizer *quantizer;
+    struct encoder enc;
+    struct ngram_encoder_state ngram;
+    struct associative_memory assoc_mem;
+    struct associative_memory pruned_mem; /**< Classes agreeing on a quarter of the dimensions, pruned. */
+    double **samples;               /**< BENCH_QUANTIZER_SAMPLES synthetic timestamps. */
+    int *labels;
+    quantized_level levels[NUM_FEATURES];
+};
+
+struct bench_case {
+    const char *name;
+    double bytes_per_op;
+    void (*run)(struct bench_inputs *in, long iteration);
+};
+
+static volatile double bench_sink;
+
+static double now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+static uint64_t next_random(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+static void fill_random(Vector *vec, uint64_t *state) {
+    for (size_t w = 0; w < vector_storage_count(); w++) {
+        vec->data[w] = next_random(state);
+    }
+    vector_mask_tail(vec);
+}
+
+static void run_bind(struct bench_inputs *in, long iteration) {
+    (void)iteration;
+    hdc_bind(in->a, in->b, in->out);
+}
+
+static void run_permute(struct bench_inputs *in, long iteration) {
+    permute(in->a, (int)(iteration % 63) + 1, in->out);
+}
+
+static void run_bundle_multi(struct bench_inputs *in, long iteration) {
+    (void)iteration;
+    bundle_multi(in->operands, NUM_FEATURES, in->out);
+}
+
+static void run_hamming_distance(struct bench_inputs *in, long iteration) {
+    (void)iteration;
+    bench_sink += hamming_distance(in->a, in->b);
+}
+
+static void run_quantize(struct bench_inputs *in, long iteration) {
+    quantizer_quantize_sample(in->quantizer, in->samples[iteration % BENCH_QUANTIZER_SAMPLES], in->levels);
+}
+
+static void run_encode_timestamp(struct bench_inputs *in, long iteration) {
+    encode_timestamp(&in->enc, in->samples[iteration % BENCH_QUANTIZER_SAMPLES], in->out);
+}
+
+static void run_push_ngram(struct bench_inputs *in, long iteration) {
+    push_ngram_encoder_sample(&in->enc, &in->ngram, in->samples[iteration % BENCH_QUANTIZER_SAMPLES], in->out);
+}
+
+static void run_classify(struct bench_inputs *in, long iteration) {
+    (void)iteration;
+    bench_sink += classify(&in->assoc_mem, in->a);
+}
+
+static void run_classify_pruned(struct bench_inputs *in, long iteration) {
+    (void)iteration;
+    bench_sink += classify(&in->pruned_mem, in->a);
+}
+
+static void run_init_item_memory(struct bench_inputs *in, long iteration) {
+    (void)in;
+    struct item_memory item_mem;
+    init_precomp_item_memory_seeded(&item_mem, NUM_LEVELS, NUM_FEATURES, (uint32_t)iteration + 1u);
+    free_item_memory(&item_mem);
+}
+
+static void init_inputs(struct bench_inputs *in) {
+    uint64_t state = 0x9e3779b97f4a7c15ull;
+    in->a = create_vector();
+    in->b = create_vector();
+    in->out = create_vector();
+    in->operands = create_vector_slab(NUM_FEATURES, &in->operand_storage);
+    if (!in->a || !in->b || !in->out || !in->operands) {
+        fprintf(stderr, "bench: allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    fill_random(in->a, &state);
+    fill_random(in->b, &state);
+    for (int i = 0; i < NUM_FEATURES; i++) {
+        fill_random(in->operands[i], &state);
+    }
+
+    in->samples = (double **)malloc(sizeof(double *) * BENCH_QUANTIZER_SAMPLES);
+    in->labels = (int *)malloc(sizeof(int) * BENCH_QUANTIZER_SAMPLES);
+    if (!in->samples || !in->labels) {
+        fprintf(stderr, "bench: allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int s = 0; s < BENCH_QUANTIZER_SAMPLES; s++) {
+        in->samples[s] = (double *)malloc(sizeof(double) * NUM_FEATURES);
+        if (!in->samples[s]) {
+            fprintf(stderr, "bench: allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int f = 0; f < NUM_FEATURES; f++) {
+            in->samples[s][f] = (double)(next_random(&state) >> 11) * (1.0 / 9007199254740992.0);
+        }
+        in->labels[s] = s % NUM_CLASSES;
+    }
+    in->quantizer = quantizer_fit(in->samples, in->labels, BENCH_QUANTIZER_SAMPLES, NUM_FEATURES, NUM_LEVELS);
+    if (!in->quantizer) {
+        fprintf(stderr, "bench: fitting the quantizer failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    init_precomp_item_memory(&in->item_mem, NUM_LEVELS, NUM_FEATURES);
+    init_encoder(&in->enc, &in->item_mem);
+    encoder_use_quantizer(&in->enc, in->quantizer);
+    init_ngram_encoder_state(&in->ngram);
+
+    init_assoc_mem(&in->assoc_mem);
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        fill_random(in->assoc_mem.class_vectors[c], &state);
+    }
+
+    // Same random classes, but equal to class 0 wherever two random masks overlap.
+    init_assoc_mem(&in->pruned_mem);
+    for (size_t w = 0; w < vector_storage_count(); w++) {
+        uint64_t shared = next_random(&state) & next_random(&state);
+        for (int c = 0; c < NUM_CLASSES; c++) {
+            in->pruned_mem.class_vectors[c]->data[w] = (in->assoc_mem.class_vectors[c]->data[w] & ~shared) |
+                                                       (in->assoc_mem.class_vectors[0]->data[w] & shared);
+        }
+    }
+    if (prune_assoc_mem(&in->pruned_mem) < 0) {
+        fprintf(stderr, "bench: pruning failed.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void free_inputs(struct bench_inputs *in) {
+    free_assoc_mem(&in->pruned_mem);
+    free_assoc_mem(&in->assoc_mem);
+    free_ngram_encoder_state(&in->ngram);
+    free_item_memory(&in->item_mem);
+    free_quantizer(in->quantizer);
+    for (int s = 0; s < BENCH_QUANTIZER_SAMPLES; s++) {
+        free(in->samples[s]);
+    }
+    free(in->samples);
+    free(in->labels);
+    free_vector_slab(in->operands, in->operand_storage);
+    free_vector(in->a);
+    free_vector(in->b);
+    free_vector(in->out);
+}
+
+static int compare_doubles(const void *lhs, const void *rhs) {
+    double a = *(const double *)lhs;
+    double b = *(const double *)rhs;
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief Times one benchmark; returns the median and fastest ns/op of the timed batches.
+ */
+static void time_case(const struct bench_case *bench, struct bench_inputs *in, double *median_ns, double *min_ns) {
+    // Warm-up, which also sizes the batch: double it until it takes a tenth of the target.
+    long batch = 1;
+    for (;;) {
+        double start = now_ns();
+        for (long i = 0; i < batch; i++) {
+            bench->run(in, i);
+        }
+        double elapsed = now_ns() - start;
+        if (elapsed >= BENCH_TARGET_NS / 10.0 || batch >= (1L << 30)) {
+            batch = (long)((double)batch * BENCH_TARGET_NS / (elapsed > 1.0 ? elapsed : 1.0));
+            if (batch < 1) {
+                batch = 1;
+            }
+            break;
+        }
+        batch *= 2;
+    }
+
+    double per_op[BENCH_REPETITIONS];
+    for (int rep = 0; rep < BENCH_REPETITIONS; rep++) {
+        double start = now_ns();
+        for (long i = 0; i < batch; i++) {
+            bench->run(in, i);
+        }
+        per_op[rep] = (now_ns() - start) / (double)batch;
+    }
+    qsort(per_op, BENCH_REPETITIONS, sizeof(double), compare_doubles);
+    *median_ns = per_op[BENCH_REPETITIONS / 2];
+    *min_ns = per_op[0];
+}
+
+int main(int argc, char **argv) {
+    if (argc > 2) {
+        fprintf(stderr, "Usage: %s [csv_path]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    FILE *csv = NULL;
+    if (argc == 2) {
+        csv = fopen(argv[1], "a");
+        if (!csv) {
+            fprintf(stderr, "bench: failed to open %s\n", argv[1]);
+            return EXIT_FAILURE;
+        }
+        fseek(csv, 0, SEEK_END);
+        if (ftell(csv) <= 0) {
+            fprintf(csv, "vector_dimension,num_features,num_levels,num_classes,n_gram_size,kernel,benchmark,"
+                         "ns_per_op,min_ns_per_op,gb_per_s,repetitions\n");
+        }
+    }
+
+    struct bench_inputs in;
+    init_inputs(&in);
+
+    double vector_bytes = (double)vector_storage_bytes();
+    const struct bench_case cases[] = {
+        {"bind", 3.0 * vector_bytes, run_bind},
+        {"permute", 2.0 * vector_bytes, run_permute},
+        {"bundle_multi", (NUM_FEATURES + 1.0) * vector_bytes, run_bundle_multi},
+        {"hamming_distance", 2.0 * vector_bytes, run_hamming_distance},
+        {"quantize_sample", NUM_FEATURES * (sizeof(double) + sizeof(quantized_level)), run_quantize},
+        {"encode_timestamp", (NUM_FEATURES + 1.0) * vector_bytes, run_encode_timestamp},
+        {"push_ngram_encoder_sample", (NUM_FEATURES + 4.0) * vector_bytes, run_push_ngram},
+        {"classify", (NUM_CLASSES + 1.0) * vector_bytes, run_classify},
+        {"classify_pruned", (NUM_CLASSES + 1.0) * vector_bytes, run_classify_pruned},
+        {"init_precomp_item_memory", (double)NUM_LEVELS * NUM_FEATURES * vector_bytes, run_init_item_memory},
+    };
+    const char *default_kernel = operations_kernel_name();
+
+    printf("VECTOR_DIMENSION=%d (default kernel %s)\n", VECTOR_DIMENSION, default_kernel);
+    printf("  %-18s %-26s %14s %14s %10s\n", "kernel", "benchmark", "ns/op", "min ns/op", "GB/s");
+    for (size_t k = 0; k < sizeof(kernel_names) / sizeof(kernel_names[0]); k++) {
+        if (operations_use_kernel(kernel_names[k]) != 0) {
+            continue; // Not supported by this CPU or build.
+        }
+        for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+            double median_ns = 0.0;
+            double min_ns = 0.0;
+            time_case(&cases[c], &in, &median_ns, &min_ns);
+            double gb_per_s = cases[c].bytes_per_op / median_ns;
+            printf("  %-18s %-26s %14.1f %14.1f %10.2f\n", kernel_names[k], cases[c].name, median_ns, min_ns,
+                   gb_per_s);
+            if (csv) {
+                fprintf(csv, "%d,%d,%d,%d,%d,%s,%s,%.3f,%.3f,%.4f,%d\n", VECTOR_DIMENSION, NUM_FEATURES,
+                        NUM_LEVELS, NUM_CLASSES, N_GRAM_SIZE, kernel_names[k], cases[c].name, median_ns, min_ns,
+                        gb_per_s, BENCH_REPETITIONS);
+            }
+        }
+    }
+    operations_use_kernel(default_kernel);
+
+    free_inputs(&in);
+    if (csv) {
+        fclose(csv);
+    }
+    return EXIT_SUCCESS;
+}
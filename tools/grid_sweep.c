@@ -0,0 +1,330 @@
+//Runs a grid of foot model configurations in one process.
+//
+//Usage:
+//  gridSweepFoot [seeds=1,2,...] [ratios=0.3,...] [epochs=0,5,...] [datasets=0,1,2,3]
+//
+//  seeds     item memory seeds (default ITEM_MEM_SEED)
+//  ratios    validation split ratios (default VALIDATION_RATIO)
+//  epochs    retraining epochs to report, 0 = single-pass training (default 0)
+//  datasets  foot datasets (default all four)
+//
+//Every dataset split is read once (through the .hdcbin CSV cache), quantized
+//once and shared by all seeds; the seed × split jobs then run on all cores,
+//handed out one at a time so uneven jobs balance. A job encodes its training
+//n-grams and the validation/test timestamps once and reports every epoch count
+//from one retraining pass, so the epochs axis costs only the extra epochs.
+//Each finished job streams its rows into the results CSV (RESULT_CSV_PATH).
+//Compile-time dimensions (VECTOR_DIMENSION, N_GRAM_SIZE, ...) are swept with
+//`make sweep` instead; build with `make grid_sweep` and the usual overrides.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../foot/dataReaderFootEMG.h"
+#include "../hdc_infrastructure/assoc_mem.h"
+#include "../hdc_infrastructure/encoder.h"
+#include "../hdc_infrastructure/evaluator.h"
+#include "../hdc_infrastructure/item_mem.h"
+#include "../hdc_infrastructure/quantizer.h"
+#include "../hdc_infrastructure/ResultManager.h"
+#include "../hdc_infrastructure/retrainer.h"
+#include "../hdc_infrastructure/timestamp_cache.h"
+#include "../hdc_infrastructure/workspace.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if !PRECOMPUTED_ITEM_MEMORY || BIPOLAR_MODE || MODEL_VARIANT == MODEL_VARIANT_KRISCHAN
+#error "The grid sweep needs the binary precomputed item memory and a non-KRISCHAN model variant."
+#endif
+
+int output_mode = OUTPUT_NONE;
+
+#define GRID_MAX_VALUES 64 // values per grid axis
+#define GRID_NUM_DATASETS 4
+
+struct grid_axis {
+    int count;
+    double values[GRID_MAX_VALUES];
+};
+
+/**
+ * @brief One dataset with one validation ratio: read, quantized and shared read-only by every job.
+ */
+struct grid_split {
+    int dataset;
+    double validation_ratio;
+    struct quantizer *quantizer;
+    struct quantized_dataset levels[3]; /**< Training, validation, testing. */
+    int *labels[3];
+    int has_validation;
+};
+
+struct grid_result {
+    struct timeseries_eval_result validation;
+    struct timeseries_eval_result test;
+};
+
+static int parse_axis(const char *arg, const char *name, struct grid_axis *axis) {
+    size_t length = strlen(name);
+    if (strncmp(arg, name, length) != 0 || arg[length] != '=') {
+        return 0;
+    }
+    const char *p = arg + length + 1;
+    axis->count = 0;
+    while (*p) {
+        char *end = NULL;
+        double value = strtod(p, &end);
+        if (end == p || (*end != ',' && *end != '\0') || axis->count == GRID_MAX_VALUES) {
+            fprintf(stderr, "grid sweep: invalid list '%s'.\n", arg);
+            return -1;
+        }
+        axis->values[axis->count++] = value;
+        p = *end ? end + 1 : end;
+    }
+    return axis->count > 0 ? 1 : -1;
+}
+
+static void free_split(struct grid_split *split) {
+    for (int part = 0; part < 3; part++) {
+        if (split->levels[part].levels) {
+            free_quantized_dataset(&split->levels[part]);
+        }
+        freeCSVLabels(split->labels[part]);
+    }
+    if (split->quantizer) {
+        free_quantizer(split->quantizer);
+    }
+}
+
+/**
+ * @brief Reads a dataset split, fits its quantizer and keeps only the quantized levels.
+ */
+static int load_split(struct grid_split *split) {
+    double **data[3] = {NULL, NULL, NULL};
+    int samples[3] = {0, 0, 0};
+    getDataWithValSet(split->dataset, &data[0], &data[1], &data[2], &split->labels[0], &split->labels[1],
+                      &split->labels[2], &samples[0], &samples[1], &samples[2], split->validation_ratio);
+    int status = 0;
+    if (!data[0] || !data[2]) {
+        fprintf(stderr, "grid sweep: failed to read dataset %d.\n", split->dataset);
+        status = -1;
+    } else {
+        split->quantizer = quantizer_fit(data[0], split->labels[0], samples[0], NUM_FEATURES, NUM_LEVELS);
+        split->has_validation = data[1] && split->labels[1] && samples[1] > 0;
+        if (!split->quantizer) {
+            fprintf(stderr, "grid sweep: failed to fit the quantizer of dataset %d.\n", split->dataset);
+            status = -1;
+        }
+    }
+    for (int part = 0; part < 3 && status == 0; part++) {
+        if ((part != 1 || split->has_validation) &&
+            init_quantized_dataset_for(split->quantizer, &split->levels[part], data[part], samples[part], NUM_FEATURES) != 0) {
+            status = -1;
+        }
+    }
+    for (int part = 0; part < 3; part++) {
+        if (data[part]) {
+            freeData(data[part], (size_t)samples[part]);
+        }
+    }
+    return status;
+}
+
+/**
+ * @brief Trains one seed on one split and evaluates it after every requested epoch count.
+ *
+ * @param epochs Ascending epoch counts; `results` receives one entry per count.
+ */
+static int run_job(const struct grid_split *split, uint32_t seed, const struct grid_axis *epochs,
+                   struct grid_result *results) {
+    struct item_memory item_mem;
+    init_precomp_item_memory_seeded(&item_mem, NUM_LEVELS, NUM_FEATURES, seed);
+    struct encoder enc;
+    init_encoder(&enc, &item_mem);
+    encoder_use_quantizer(&enc, split->quantizer);
+
+    struct associative_memory assoc_mem;
+    init_assoc_mem(&assoc_mem);
+    struct encoded_training_set set;
+    struct timestamp_cache caches[3];
+    memset(caches, 0, sizeof(caches));
+    struct hdc_workspace ws;
+    init_hdc_workspace(&ws);
+
+    int status = encode_training_set(&split->levels[0], split->labels[0], &enc, &set);
+    for (int part = 1; part < 3 && status == 0; part++) {
+        if (part != 1 || split->has_validation) {
+            status = build_timestamp_cache(&caches[part], &enc, &split->levels[part]);
+        }
+    }
+    if (status == 0) {
+        train_model_encoded(&set, &assoc_mem);
+        int trained_epochs = 0;
+        for (int i = 0; i < epochs->count && status == 0; i++) {
+            int target = (int)epochs->values[i];
+            if (target > trained_epochs && set.count > 0) {
+                status = retrain_model(&assoc_mem, &set, target - trained_epochs, NULL) < 0 ? -1 : 0;
+                trained_epochs = target;
+            }
+            if (split->has_validation) {
+                results[i].validation = evaluate_model_timeseries_direct_cached(&enc, &assoc_mem, &ws, &split->levels[1],
+                                                                                &caches[1], split->labels[1]);
+            }
+            results[i].test = evaluate_model_timeseries_direct_cached(&enc, &assoc_mem, &ws, &split->levels[2],
+                                                                      &caches[2], split->labels[2]);
+        }
+    }
+
+    free_hdc_workspace(&ws);
+    for (int part = 1; part < 3; part++) {
+        if (caches[part].timestamps) {
+            free_timestamp_cache(&caches[part]);
+        }
+    }
+    free_encoded_training_set(&set);
+    free_assoc_mem(&assoc_mem);
+    free_item_memory(&item_mem);
+    return status;
+}
+
+static void add_mean_row(double accuracy, double validation_ratio, const char *info) {
+    struct timeseries_eval_result result = {0};
+    result.overall_accuracy = accuracy;
+    addResultWithValidationRatio(&result, validation_ratio, info);
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+    struct grid_axis seeds = {1, {ITEM_MEM_SEED}};
+    struct grid_axis ratios = {1, {VALIDATION_RATIO}};
+    struct grid_axis epochs = {1, {0}};
+    struct grid_axis datasets = {GRID_NUM_DATASETS, {0, 1, 2, 3}};
+    for (int arg = 1; arg < argc; arg++) {
+        int parsed = parse_axis(argv[arg], "seeds", &seeds);
+        parsed = parsed ? parsed : parse_axis(argv[arg], "ratios", &ratios);
+        parsed = parsed ? parsed : parse_axis(argv[arg], "epochs", &epochs);
+        parsed = parsed ? parsed : parse_axis(argv[arg], "datasets", &datasets);
+        if (parsed != 1) {
+            fprintf(stderr, "Usage: %s [seeds=1,2,...] [ratios=0.3,...] [epochs=0,5,...] [datasets=0,1,2,3]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    qsort(epochs.values, (size_t)epochs.count, sizeof(double), compare_doubles);
+    for (int i = 0; i < datasets.count; i++) {
+        if (datasets.values[i] < 0 || datasets.values[i] >= GRID_NUM_DATASETS) {
+            fprintf(stderr, "grid sweep: no dataset %g.\n", datasets.values[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (epochs.values[0] < 0) {
+        fprintf(stderr, "grid sweep: epochs must not be negative.\n");
+        return EXIT_FAILURE;
+    }
+
+    int num_splits = ratios.count * datasets.count;
+    int num_jobs = num_splits * seeds.count;
+    struct grid_split *splits = (struct grid_split *)calloc((size_t)num_splits, sizeof(*splits));
+    struct grid_result *results = (struct grid_result *)calloc((size_t)num_jobs * (size_t)epochs.count, sizeof(*results));
+    int *job_status = (int *)calloc((size_t)num_jobs, sizeof(int));
+    if (!splits || !results || !job_status) {
+        fprintf(stderr, "grid sweep: allocation failed.\n");
+        return EXIT_FAILURE;
+    }
+
+    int failures = 0;
+    for (int s = 0; s < num_splits; s++) {
+        splits[s].validation_ratio = ratios.values[s / datasets.count];
+        splits[s].dataset = (int)datasets.values[s % datasets.count];
+        if (load_split(&splits[s]) != 0) {
+            failures++;
+        }
+    }
+    if (failures) {
+        for (int s = 0; s < num_splits; s++) {
+            free_split(&splits[s]);
+        }
+        return EXIT_FAILURE;
+    }
+    printf("Grid sweep: %d splits x %d seeds = %d jobs, %d epoch counts each\n",
+           num_splits, seeds.count, num_jobs, epochs.count);
+
+    result_manager_init();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) reduction(+ : failures)
+#endif
+    for (int job = 0; job < num_jobs; job++) {
+        const struct grid_split *split = &splits[job / seeds.count];
+        uint32_t seed = (uint32_t)seeds.values[job % seeds.count];
+        struct grid_result *job_results = &results[(size_t)job * (size_t)epochs.count];
+        job_status[job] = run_job(split, seed, &epochs, job_results);
+        failures += job_status[job] != 0;
+#ifdef _OPENMP
+#pragma omp critical(grid_sweep_results)
+#endif
+        {
+            char info[160];
+            for (int i = 0; i < epochs.count && job_status[job] == 0; i++) {
+                int epoch_count = (int)epochs.values[i];
+                if (split->has_validation) {
+                    snprintf(info, sizeof(info), "model=mine,scope=dataset,dataset=%d,seed=%u,epochs=%d,phase=sweep-validation",
+                             split->dataset, seed, epoch_count);
+                    addResultWithValidationRatio(&job_results[i].validation, split->validation_ratio, info);
+                }
+                snprintf(info, sizeof(info), "model=mine,scope=dataset,dataset=%d,seed=%u,epochs=%d,phase=sweep-test",
+                         split->dataset, seed, epoch_count);
+                addResultWithValidationRatio(&job_results[i].test, split->validation_ratio, info);
+            }
+            printf("  dataset %d, ratio %.3f, seed %u: %s\n", split->dataset, split->validation_ratio, seed,
+                   job_status[job] == 0 ? "done" : "FAILED");
+            fflush(stdout);
+        }
+    }
+
+    // Means over the datasets for every ratio, seed and epoch count (complete rows only).
+    printf("\nratio,seed,epochs,validation_accuracy,test_accuracy\n");
+    for (int r = 0; r < ratios.count; r++) {
+        for (int seed = 0; seed < seeds.count; seed++) {
+            for (int i = 0; i < epochs.count; i++) {
+                double validation = 0.0;
+                double test = 0.0;
+                int complete = 1;
+                for (int d = 0; d < datasets.count; d++) {
+                    int job = (r * datasets.count + d) * seeds.count + seed;
+                    complete &= job_status[job] == 0;
+                    validation += results[(size_t)job * (size_t)epochs.count + (size_t)i].validation.overall_accuracy;
+                    test += results[(size_t)job * (size_t)epochs.count + (size_t)i].test.overall_accuracy;
+                }
+                if (!complete) {
+                    continue;
+                }
+                validation /= (double)datasets.count;
+                test /= (double)datasets.count;
+                char info[128];
+                uint32_t seed_value = (uint32_t)seeds.values[seed];
+                int epoch_count = (int)epochs.values[i];
+                snprintf(info, sizeof(info), "model=mine,scope=overall,seed=%u,epochs=%d,phase=sweep-validation",
+                         seed_value, epoch_count);
+                add_mean_row(validation, ratios.values[r], info);
+                snprintf(info, sizeof(info), "model=mine,scope=overall,seed=%u,epochs=%d,phase=sweep-test",
+                         seed_value, epoch_count);
+                add_mean_row(test, ratios.values[r], info);
+                printf("%.3f,%u,%d,%.4f,%.4f\n", ratios.values[r], seed_value, epoch_count, validation, test);
+            }
+        }
+    }
+    result_manager_close();
+
+    for (int s = 0; s < num_splits; s++) {
+        free_split(&splits[s]);
+    }
+    free(splits);
+    free(results);
+    free(job_status);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+//Rebuilds GA candidate CiMs from a compact export (cims.hdcx).
+//
+//Usage:
+//  reconstruct_cim <cims.hdcx>                                 list the recorded candidates
+//  reconstruct_cim <cims.hdcx> <generation> <candidate> [out]  write one CiM as CSV (default: stdout)
+//
+//Build with the configuration of the exporting run (`make cim_tool`, same
+//VECTOR_DIMENSION and GA_MAX_FLIPS_CIM); the rebuilt CiM is then bit-identical
+//to the one the GA evaluated and printed in the format of the CSV export.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../hdc_infrastructure/ga_cim_export.h"
+#include "../hdc_infrastructure/item_mem.h"
+
+int output_mode = OUTPUT_NONE;
+
+int main(int argc, char **argv) {
+    if (argc != 2 && argc != 4 && argc != 5) {
+        fprintf(stderr, "Usage: %s <cims.hdcx> [<generation> <candidate> [out.csv]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    struct ga_cim_export_file export_file;
+    if (open_ga_cim_export(&export_file, argv[1]) != 0) {
+        fprintf(stderr, "Failed to read CiM export %s.\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    const struct ga_cim_export_header *header = &export_file.header;
+    uint16_t *genome = (uint16_t *)malloc((size_t)(header->genome_length > 0 ? header->genome_length : 1) * sizeof(uint16_t));
+    if (!genome) {
+        fprintf(stderr, "Failed to allocate genome.\n");
+        close_ga_cim_export(&export_file);
+        return EXIT_FAILURE;
+    }
+
+    int want_generation = argc > 2 ? atoi(argv[2]) : -1;
+    int want_candidate = argc > 3 ? atoi(argv[3]) : -1;
+    if (argc == 2) {
+        printf("mode=%s, num_levels=%d, num_features=%d, dimension=%d, max_flips=%d, seed=%u\n",
+               header->mode == GA_CIM_EXPORT_PRECOMPUTED ? "precomputed" : "continuous",
+               header->num_levels,
+               header->num_features,
+               header->dimension,
+               header->max_flips,
+               header->seed);
+        printf("generation,candidate,accuracy,similarity\n");
+    }
+
+    int generation = 0;
+    int candidate = 0;
+    double accuracy = 0.0;
+    double similarity = 0.0;
+    int found = 0;
+    int status;
+    while ((status = ga_cim_export_next(&export_file, &generation, &candidate, genome, &accuracy, &similarity)) == 1) {
+        if (argc == 2) {
+            printf("%d,%d,%.10f,%.10f\n", generation, candidate, accuracy, similarity);
+        } else if (generation == want_generation && candidate == want_candidate) {
+            found = 1;
+            break;
+        }
+    }
+
+    int exit_code = EXIT_SUCCESS;
+    if (status < 0) {
+        fprintf(stderr, "Failed to read CiM export %s.\n", argv[1]);
+        exit_code = EXIT_FAILURE;
+    } else if (argc > 2 && !found) {
+        fprintf(stderr, "No candidate %d in generation %d of %s.\n", want_candidate, want_generation, argv[1]);
+        exit_code = EXIT_FAILURE;
+    } else if (argc > 2) {
+        struct item_memory item_mem;
+        if (rebuild_ga_cim(header, export_file.permutations, genome, &item_mem) != 0) {
+            fprintf(stderr, "Failed to rebuild the CiM.\n");
+            exit_code = EXIT_FAILURE;
+        } else {
+            FILE *out = argc == 5 ? fopen(argv[4], "w") : stdout;
+            if (!out) {
+                perror("Failed to open output file");
+                exit_code = EXIT_FAILURE;
+            } else {
+                write_ga_cim_csv(out, &item_mem, header, generation, candidate, accuracy, similarity);
+                if (out != stdout) {
+                    fclose(out);
+                }
+            }
+            free_item_memory(&item_mem);
+        }
+    }
+
+    free(genome);
+    close_ga_cim_export(&export_file);
+    return exit_code;
+}
@@ -0,0 +1,116 @@
+//Runs the foot model for several vector dimensions from one binary.
+//
+//Usage:
+//  sweepFoot --list                    list the compiled specializations
+//  sweepFoot                           run every specialization in turn
+//  sweepFoot <config> [<config> ...]   run the specialization matching each config
+//
+//A config uses the macro names, e.g. `VECTOR_DIMENSION=2048` or
+//`VECTOR_DIMENSION=1024,N_GRAM_SIZE=3`. `make sweep` builds the whole foot model
+//once per dimension in SWEEP_DIMENSIONS (default 1024 2048 5000 10000) with that
+//dimension as a compile-time constant, so every specialization keeps its
+//constant-folded kernels; the other settings come from the usual overrides.
+//Each run is a child process, so runs never share model state.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../hdc_infrastructure/hdc_config.h"
+
+#ifndef SWEEP_SPECIALIZATIONS
+#error "Build with `make sweep`, which defines SWEEP_SPECIALIZATIONS."
+#endif
+
+#define X(dimension)                                          \
+    int hdc_spec_main_D##dimension(void);                     \
+    void hdc_config_compiled_D##dimension(struct hdc_config *config);
+SWEEP_SPECIALIZATIONS
+#undef X
+
+struct specialization {
+    int (*run)(void);
+    void (*config)(struct hdc_config *config);
+};
+
+static const struct specialization specializations[] = {
+#define X(dimension) {hdc_spec_main_D##dimension, hdc_config_compiled_D##dimension},
+    SWEEP_SPECIALIZATIONS
+#undef X
+};
+
+#define NUM_SPECIALIZATIONS ((int)(sizeof(specializations) / sizeof(specializations[0])))
+
+static int run_specialization(const struct specialization *spec) {
+    char description[256];
+    struct hdc_config config;
+    spec->config(&config);
+    hdc_config_format(&config, description, sizeof(description));
+    printf("\n=== %s ===\n", description);
+    fflush(stdout);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("sweep: fork failed");
+        return -1;
+    }
+    if (pid == 0) {
+        int status = spec->run();
+        fflush(NULL);
+        _exit(status);
+    }
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "sweep: run %s failed.\n", description);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2 && strcmp(argv[1], "--list") == 0) {
+        for (int i = 0; i < NUM_SPECIALIZATIONS; i++) {
+            char description[256];
+            struct hdc_config config;
+            specializations[i].config(&config);
+            hdc_config_format(&config, description, sizeof(description));
+            printf("%s\n", description);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    int failures = 0;
+    if (argc == 1) {
+        for (int i = 0; i < NUM_SPECIALIZATIONS; i++) {
+            failures += run_specialization(&specializations[i]) != 0;
+        }
+        return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    for (int arg = 1; arg < argc; arg++) {
+        struct hdc_config requested;
+        hdc_config_any(&requested);
+        if (hdc_config_parse(&requested, argv[arg]) != 0) {
+            failures++;
+            continue;
+        }
+        int found = -1;
+        for (int i = 0; i < NUM_SPECIALIZATIONS && found < 0; i++) {
+            struct hdc_config config;
+            specializations[i].config(&config);
+            if (hdc_config_matches(&config, &requested)) {
+                found = i;
+            }
+        }
+        if (found < 0) {
+            fprintf(stderr, "sweep: no specialization for %s; add it to SWEEP_DIMENSIONS or build modelFoot for it.\n",
+                    argv[arg]);
+            failures++;
+            continue;
+        }
+        failures += run_specialization(&specializations[found]) != 0;
+    }
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
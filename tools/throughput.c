@@ -0,0 +1,435 @@
+//End-to-end throughput of the foot model at several thread counts.
+//
+//Usage:
+//  throughputFoot [threads=1,2,4,...] [dataset=0] [phases=train,eval,ga] [repeats=3] [csv=path]
+//
+//  threads   OpenMP thread counts to measure (default 1, 2, 4, ... up to all cores)
+//  dataset   foot dataset the inputs come from (default 0)
+//  phases    any of train, eval and ga (default all three)
+//  repeats   timed runs per measurement, the median is reported (default 3; GA runs once)
+//  csv       also append every measurement to this CSV
+//
+//Each phase reports samples/second, the peak RSS while it ran and the number of
+//heap allocations it made (counted by wrapping malloc and friends at link time).
+//
+//- **train**: `train_model_timeseries` on the training split.
+//- **eval**: `evaluate_model_timeseries_direct` on the testing split.
+//- **ga**: one `optimize_item_memory` run of GA_DEFAULT_GENERATIONS generations
+//  (`make throughput` sets 1). The initial population counts as one more
+//  generation; a generation processes population × (training + validation)
+//  samples, which is what its samples/second refers to.
+//
+//Strong scaling keeps the inputs fixed; weak scaling repeats the split once per
+//thread, so every thread keeps the same amount of work (train and eval only,
+//since the GA population is a compile-time constant). Efficiency is the speedup
+//over one thread divided by the thread count (strong) or the one-thread time
+//divided by the time (weak), both against the first thread count.
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "../foot/dataReaderFootEMG.h"
+#include "../hdc_infrastructure/assoc_mem.h"
+#include "../hdc_infrastructure/asymItemMemory.h"
+#include "../hdc_infrastructure/encoder.h"
+#include "../hdc_infrastructure/evaluator.h"
+#include "../hdc_infrastructure/item_mem.h"
+#include "../hdc_infrastructure/quantizer.h"
+#include "../hdc_infrastructure/trainer.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if !PRECOMPUTED_ITEM_MEMORY
+#error "The throughput benchmark covers the precomputed item memory build."
+#endif
+
+int output_mode = OUTPUT_NONE;
+
+#define THROUGHPUT_MAX_THREAD_COUNTS 32
+
+// Heap allocations of the whole process, counted by the --wrap symbols below.
+static atomic_ullong allocation_count;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_aligned_alloc(size_t alignment, size_t size);
+int __real_posix_memalign(void **ptr, size_t alignment, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+    return __real_realloc(ptr, size);
+}
+
+void *__wrap_aligned_alloc(size_t alignment, size_t size) {
+    atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+    return __real_aligned_alloc(alignment, size);
+}
+
+int __wrap_posix_memalign(void **ptr, size_t alignment, size_t size) {
+    atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+    return __real_posix_memalign(ptr, alignment, size);
+}
+
+enum throughput_phase {
+    PHASE_TRAIN,
+    PHASE_EVAL,
+    PHASE_GA,
+    NUM_PHASES
+};
+
+static const char *const phase_names[NUM_PHASES] = {"train", "eval", "ga"};
+
+/**
+ * @brief One dataset split as read, plus its quantizer and a model trained on it for `eval`.
+ */
+struct throughput_inputs {
+    double **data[3]; /**< Training, validation, testing. */
+    int *labels[3];
+    int samples[3];
+    struct item_memory item_mem;
+    struct encoder enc;
+    struct associative_memory trained;
+};
+
+struct measurement {
+    double seconds;
+    double samples;
+    long peak_rss_kb;
+    unsigned long long allocations;
+};
+
+static double now_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Resets the peak RSS to the current RSS (Linux); returns 0 on success.
+ */
+static int reset_peak_rss(void) {
+    FILE *file = fopen("/proc/self/clear_refs", "w");
+    if (!file) {
+        return -1;
+    }
+    int ok = fputs("5", file) >= 0;
+    return (fclose(file) == 0 && ok) ? 0 : -1;
+}
+
+/**
+ * @brief Peak RSS in KiB since the last `reset_peak_rss`, or since process start without /proc.
+ */
+static long read_peak_rss_kb(void) {
+    FILE *file = fopen("/proc/self/status", "r");
+    if (file) {
+        char line[256];
+        long kb = -1;
+        while (fgets(line, sizeof(line), file)) {
+            if (sscanf(line, "VmHWM: %ld kB", &kb) == 1) {
+                break;
+            }
+        }
+        fclose(file);
+        if (kb >= 0) {
+            return kb;
+        }
+    }
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : -1;
+}
+
+static void set_threads(int threads) {
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#else
+    (void)threads;
+#endif
+}
+
+static int max_threads(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+/**
+ * @brief Row and label arrays that repeat a split `copies` times; the rows are shared, not copied.
+ */
+static int replicate_split(double **data, int *labels, int samples, int copies,
+                           double ***data_out, int **labels_out) {
+    size_t total = (size_t)samples * (size_t)copies;
+    *data_out = (double **)malloc(total * sizeof(double *));
+    *labels_out = (int *)malloc(total * sizeof(int));
+    if (!*data_out || !*labels_out) {
+        free(*data_out);
+        free(*labels_out);
+        return -1;
+    }
+    for (int copy = 0; copy < copies; copy++) {
+        memcpy(*data_out + (size_t)copy * samples, data, (size_t)samples * sizeof(double *));
+        memcpy(*labels_out + (size_t)copy * samples, labels, (size_t)samples * sizeof(int));
+    }
+    return 0;
+}
+
+/**
+ * @brief Runs one phase once with `copies` repetitions of its split; returns its time in seconds.
+ */
+static double run_phase(enum throughput_phase phase, struct throughput_inputs *in, int copies, double *samples) {
+    double start = 0.0;
+    double elapsed = 0.0;
+    if (phase == PHASE_GA) {
+        // Every run starts from the same item memory (fixed seed), outside the timing.
+        struct item_memory item_mem;
+        init_precomp_item_memory(&item_mem, NUM_LEVELS, NUM_FEATURES);
+        int has_validation = in->samples[1] > 0;
+        start = now_seconds();
+        optimize_item_memory(&item_mem,
+                             in->data[0], in->labels[0], in->samples[0],
+                             has_validation ? in->data[1] : NULL,
+                             has_validation ? in->labels[1] : NULL,
+                             in->samples[1]);
+        elapsed = now_seconds() - start;
+        free_item_memory(&item_mem);
+        *samples = (double)GA_DEFAULT_POPULATION_SIZE * (double)(in->samples[0] + in->samples[1]) *
+                   (double)(GA_DEFAULT_GENERATIONS + 1);
+        return elapsed;
+    }
+
+    int split = phase == PHASE_TRAIN ? 0 : 2;
+    double **data = NULL;
+    int *labels = NULL;
+    if (replicate_split(in->data[split], in->labels[split], in->samples[split], copies, &data, &labels) != 0) {
+        fprintf(stderr, "throughput: allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    int total = in->samples[split] * copies;
+    if (phase == PHASE_TRAIN) {
+        struct associative_memory assoc_mem;
+        init_assoc_mem(&assoc_mem);
+        start = now_seconds();
+        train_model_timeseries(data, labels, total, &assoc_mem, &in->enc);
+        elapsed = now_seconds() - start;
+        free_assoc_mem(&assoc_mem);
+    } else {
+        start = now_seconds();
+        evaluate_model_timeseries_direct(&in->enc, &in->trained, data, labels, total);
+        elapsed = now_seconds() - start;
+    }
+    free(data);
+    free(labels);
+    *samples = (double)total;
+    return elapsed;
+}
+
+static int compare_doubles(const void *lhs, const void *rhs) {
+    double a = *(const double *)lhs;
+    double b = *(const double *)rhs;
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief Median of `repeats` runs of a phase at `threads` threads, with its peak RSS and allocations.
+ */
+static struct measurement measure(enum throughput_phase phase, struct throughput_inputs *in,
+                                  int threads, int copies, int repeats) {
+    double times[16];
+    struct measurement result = {0};
+    if (repeats > (int)(sizeof(times) / sizeof(times[0]))) {
+        repeats = (int)(sizeof(times) / sizeof(times[0]));
+    }
+    set_threads(threads);
+    int rss_reset = reset_peak_rss() == 0;
+    unsigned long long allocations = atomic_load(&allocation_count);
+    for (int run = 0; run < repeats; run++) {
+        times[run] = run_phase(phase, in, copies, &result.samples);
+    }
+    result.allocations = (atomic_load(&allocation_count) - allocations) / (unsigned long long)repeats;
+    result.peak_rss_kb = rss_reset ? read_peak_rss_kb() : -1;
+    qsort(times, (size_t)repeats, sizeof(double), compare_doubles);
+    result.seconds = times[repeats / 2];
+    return result;
+}
+
+static int parse_int_list(const char *value, int *out, int max_count) {
+    int count = 0;
+    const char *p = value;
+    while (*p) {
+        char *end = NULL;
+        long v = strtol(p, &end, 10);
+        if (end == p || v <= 0 || (*end != ',' && *end != '\0') || count == max_count) {
+            return -1;
+        }
+        out[count++] = (int)v;
+        p = *end == ',' ? end + 1 : end;
+    }
+    return count;
+}
+
+static int load_inputs(struct throughput_inputs *in, int dataset) {
+    memset(in, 0, sizeof(*in));
+    getDataWithValSet(dataset,
+                      &in->data[0], &in->data[1], &in->data[2],
+                      &in->labels[0], &in->labels[1], &in->labels[2],
+                      &in->samples[0], &in->samples[1], &in->samples[2],
+                      VALIDATION_RATIO);
+    if (!in->data[1] || !in->labels[1]) {
+        in->samples[1] = 0;
+    }
+    // The GA refines the global quantizer, so every phase shares it.
+    quantizer_clear();
+    if (quantizer_fit_from_training(in->data[0], in->labels[0], in->samples[0], NUM_FEATURES, NUM_LEVELS) != 0) {
+        fprintf(stderr, "throughput: fitting the quantizer for dataset %d failed.\n", dataset);
+        return -1;
+    }
+    init_precomp_item_memory(&in->item_mem, NUM_LEVELS, NUM_FEATURES);
+    init_encoder(&in->enc, &in->item_mem);
+    init_assoc_mem(&in->trained);
+    train_model_timeseries(in->data[0], in->labels[0], in->samples[0], &in->trained, &in->enc);
+    return 0;
+}
+
+static void free_inputs(struct throughput_inputs *in) {
+    free_assoc_mem(&in->trained);
+    free_item_memory(&in->item_mem);
+    for (int split = 0; split < 3; split++) {
+        if (in->data[split]) {
+            freeData(in->data[split], (size_t)in->samples[split]);
+        }
+        if (in->labels[split]) {
+            freeCSVLabels(in->labels[split]);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    int thread_counts[THROUGHPUT_MAX_THREAD_COUNTS];
+    int num_thread_counts = 0;
+    int dataset = 0;
+    int repeats = 3;
+    int enabled[NUM_PHASES] = {1, 1, 1};
+    const char *csv_path = NULL;
+
+    for (int t = 1; t < max_threads() && num_thread_counts < THROUGHPUT_MAX_THREAD_COUNTS - 1; t *= 2) {
+        thread_counts[num_thread_counts++] = t;
+    }
+    thread_counts[num_thread_counts++] = max_threads();
+
+    for (int arg = 1; arg < argc; arg++) {
+        const char *value = strchr(argv[arg], '=');
+        if (!value) {
+            fprintf(stderr, "throughput: expected name=value, got '%s'.\n", argv[arg]);
+            return EXIT_FAILURE;
+        }
+        value++;
+        if (strncmp(argv[arg], "threads=", 8) == 0) {
+            num_thread_counts = parse_int_list(value, thread_counts, THROUGHPUT_MAX_THREAD_COUNTS);
+            if (num_thread_counts <= 0) {
+                fprintf(stderr, "throughput: invalid thread list '%s'.\n", value);
+                return EXIT_FAILURE;
+            }
+        } else if (strncmp(argv[arg], "dataset=", 8) == 0) {
+            dataset = atoi(value);
+        } else if (strncmp(argv[arg], "repeats=", 8) == 0) {
+            repeats = atoi(value) > 0 ? atoi(value) : 1;
+        } else if (strncmp(argv[arg], "csv=", 4) == 0) {
+            csv_path = value;
+        } else if (strncmp(argv[arg], "phases=", 7) == 0) {
+            for (int phase = 0; phase < NUM_PHASES; phase++) {
+                char padded[64];
+                snprintf(padded, sizeof(padded), ",%s,", value);
+                char name[16];
+                snprintf(name, sizeof(name), ",%s,", phase_names[phase]);
+                enabled[phase] = strstr(padded, name) != NULL;
+            }
+        } else {
+            fprintf(stderr, "throughput: unknown argument '%s'.\n", argv[arg]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    FILE *csv = NULL;
+    if (csv_path) {
+        csv = fopen(csv_path, "a");
+        if (!csv) {
+            fprintf(stderr, "throughput: failed to open %s\n", csv_path);
+            return EXIT_FAILURE;
+        }
+        fseek(csv, 0, SEEK_END);
+        if (ftell(csv) <= 0) {
+            fprintf(csv, "vector_dimension,dataset,phase,scaling,threads,seconds,samples,samples_per_s,"
+                         "efficiency,peak_rss_kb,allocations\n");
+        }
+    }
+
+    struct throughput_inputs in;
+    if (load_inputs(&in, dataset) != 0) {
+        free_inputs(&in);
+        return EXIT_FAILURE;
+    }
+    printf("Throughput, dataset %d: %d training, %d validation, %d testing samples, VECTOR_DIMENSION=%d\n",
+           dataset, in.samples[0], in.samples[1], in.samples[2], VECTOR_DIMENSION);
+
+    for (int weak = 0; weak <= 1; weak++) {
+        printf("\n%s scaling\n", weak ? "Weak" : "Strong");
+        printf("  %-6s %8s %12s %14s %10s %12s %12s\n",
+               "phase", "threads", "seconds", "samples/s", "efficiency", "peak RSS MB", "allocations");
+        for (int phase = 0; phase < NUM_PHASES; phase++) {
+            if (!enabled[phase] || (weak && phase == PHASE_GA)) {
+                continue;
+            }
+            double baseline = 0.0;
+            for (int i = 0; i < num_thread_counts; i++) {
+                int threads = thread_counts[i];
+                int copies = weak ? threads : 1;
+                struct measurement m = measure((enum throughput_phase)phase, &in, threads, copies,
+                                               phase == PHASE_GA ? 1 : repeats);
+                double seconds = m.seconds;
+                if (phase == PHASE_GA) {
+                    seconds /= (double)(GA_DEFAULT_GENERATIONS + 1); // per generation
+                    m.samples /= (double)(GA_DEFAULT_GENERATIONS + 1);
+                }
+                double rate = seconds > 0.0 ? m.samples / seconds : 0.0;
+                if (i == 0) {
+                    // The first thread count is the reference, normally one thread.
+                    baseline = weak ? seconds : seconds * (double)threads;
+                }
+                double efficiency = weak ? baseline / seconds : baseline / (seconds * (double)threads);
+                printf("  %-6s %8d %12.4f %14.0f %10.2f %12.1f %12llu\n", phase_names[phase], threads, seconds,
+                       rate, efficiency, m.peak_rss_kb >= 0 ? (double)m.peak_rss_kb / 1024.0 : -1.0,
+                       m.allocations);
+                if (csv) {
+                    fprintf(csv, "%d,%d,%s,%s,%d,%.6f,%.0f,%.1f,%.4f,%ld,%llu\n", VECTOR_DIMENSION, dataset,
+                            phase_names[phase], weak ? "weak" : "strong", threads, seconds, m.samples, rate,
+                            efficiency, m.peak_rss_kb, m.allocations);
+                }
+            }
+        }
+    }
+
+    free_inputs(&in);
+    if (csv) {
+        fclose(csv);
+    }
+    return EXIT_SUCCESS;
+}